@@ -406,6 +406,15 @@ namespace AudioEngine
         std::cout << "ASIO processing stopped" << std::endl;
     }
 
+    void AsioManager::outputReady()
+    {
+        // Lets drivers that support it start output without waiting for the next switch
+        if (m_processing)
+        {
+            ASIOOutputReady();
+        }
+    }
+
     void AsioManager::cleanup()
     {
         // Stop processing if needed
@@ -539,7 +548,8 @@ namespace AudioEngine
         m_callback = callback;
     }
 
-    bool AsioManager::getBufferPointers(long doubleBufferIndex, const std::vector<long> &activeIndices, std::vector<void *> &bufferPtrs)
+    bool AsioManager::getBufferPointers(long doubleBufferIndex, bool isInput,
+                                        const std::vector<long> &activeIndices, std::vector<void *> &bufferPtrs)
     {
         if (!m_buffersCreated || !m_processing)
         {
@@ -565,7 +575,7 @@ namespace AudioEngine
             {
                 ASIOBufferInfo *info = static_cast<ASIOBufferInfo *>(m_bufferInfos[j]);
 
-                if (info->channelNum == activeIndices[i])
+                if (info->channelNum == activeIndices[i] && (info->isInput == ASIOTrue) == isInput)
                 {
                     bufferPtrs[i] = info->buffers[doubleBufferIndex];
                     found = true;
@@ -4,6 +4,8 @@
 #include <vector>
 #include <functional>
 
+#include "IAudioDriver.h"
+
 // Define ASIO types to avoid pulling in the full SDK in the header
 typedef long ASIOSampleType;
 typedef long ASIOError;
@@ -17,16 +19,9 @@ namespace AudioEngine
 	 * Handles driver loading, ASIO callbacks, buffer creation, and
 	 * provides an abstraction layer over the ASIO SDK.
 	 */
-	class AsioManager
+	class AsioManager : public IAudioDriver
 	{
 	public:
-		/**
-		 * @brief Callback type for ASIO buffer switch
-		 *
-		 * @param doubleBufferIndex The current buffer index (0 or 1)
-		 */
-		using AsioCallback = std::function<void(long /*doubleBufferIndex*/)>;
-
 		/**
 		 * @brief Construct a new AsioManager
 		 */
@@ -35,7 +30,7 @@ namespace AudioEngine
 		/**
 		 * @brief Destroy the AsioManager and clean up resources
 		 */
-		~AsioManager();
+		~AsioManager() override;
 
 		/**
 		 * @brief Load an ASIO driver by name
@@ -44,7 +39,7 @@ namespace AudioEngine
 		 * @return true if driver was loaded successfully
 		 * @return false if driver failed to load
 		 */
-		bool loadDriver(const std::string &deviceName);
+		bool loadDriver(const std::string &deviceName) override;
 
 		/**
 		 * @brief Initialize the loaded ASIO device
@@ -54,7 +49,7 @@ namespace AudioEngine
 		 * @return true if initialization succeeded
 		 * @return false if initialization failed
 		 */
-		bool initDevice(double preferredSampleRate = 0.0, long preferredBufferSize = 0);
+		bool initDevice(double preferredSampleRate = 0.0, long preferredBufferSize = 0) override;
 
 		/**
 		 * @brief Create ASIO buffers for the specified channels
@@ -64,7 +59,7 @@ namespace AudioEngine
 		 * @return true if buffer creation succeeded
 		 * @return false if buffer creation failed
 		 */
-		bool createBuffers(const std::vector<long> &inputChannels, const std::vector<long> &outputChannels);
+		bool createBuffers(const std::vector<long> &inputChannels, const std::vector<long> &outputChannels) override;
 
 		/**
 		 * @brief Start ASIO processing
@@ -72,38 +67,38 @@ namespace AudioEngine
 		 * @return true if start succeeded
 		 * @return false if start failed
 		 */
-		bool start();
+		bool start() override;
 
 		/**
 		 * @brief Stop ASIO processing
 		 */
-		void stop();
+		void stop() override;
 
 		/**
 		 * @brief Clean up all ASIO resources
 		 */
-		void cleanup();
+		void cleanup() override;
 
 		/**
 		 * @brief Get the current buffer size
 		 *
 		 * @return long Buffer size in samples
 		 */
-		long getBufferSize() const { return m_bufferSize; }
+		long getBufferSize() const override { return m_bufferSize; }
 
 		/**
 		 * @brief Get the current sample rate
 		 *
 		 * @return double Sample rate in Hz
 		 */
-		double getSampleRate() const { return m_sampleRate; }
+		double getSampleRate() const override { return m_sampleRate; }
 
 		/**
 		 * @brief Get the ASIO sample type
 		 *
 		 * @return ASIOSampleType The sample format of the ASIO buffers
 		 */
-		ASIOSampleType getSampleType() const { return m_sampleType; }
+		ASIOSampleType getSampleType() const override { return m_sampleType; }
 
 		/**
 		 * @brief Get a human-readable name for the current sample type
@@ -142,18 +137,28 @@ namespace AudioEngine
 		 *
 		 * @param callback Function to call when new buffers are available
 		 */
-		void setCallback(AsioCallback callback);
+		void setCallback(AsioCallback callback) override;
 
 		/**
 		 * @brief Get buffer pointers for the current processing block
 		 *
+		 * Input and output channels share index numbers, so the direction is
+		 * part of the lookup.
+		 *
 		 * @param doubleBufferIndex Current buffer index (0 or 1)
+		 * @param isInput true for input channels, false for outputs
 		 * @param activeIndices Channel indices to get buffers for
 		 * @param bufferPtrs Output parameter to store buffer pointers
 		 * @return true if buffers were retrieved
 		 * @return false if buffer retrieval failed
 		 */
-		bool getBufferPointers(long doubleBufferIndex, const std::vector<long> &activeIndices, std::vector<void *> &bufferPtrs);
+		bool getBufferPointers(long doubleBufferIndex, bool isInput,
+							   const std::vector<long> &activeIndices, std::vector<void *> &bufferPtrs) override;
+
+		/**
+		 * @brief Tell the driver the outputs of the current block are ready
+		 */
+		void outputReady() override;
 
 		/**
 		 * @brief Get a list of available ASIO devices
@@ -167,49 +172,49 @@ namespace AudioEngine
 		 *
 		 * @return JSON string with device information
 		 */
-		std::string getDeviceInfo() const;
+		std::string getDeviceInfo() const override;
 
 		/**
 		 * @brief Get the current ASIO device's name
 		 *
 		 * @return std::string Device name
 		 */
-		std::string getDeviceName() const;
+		std::string getDeviceName() const override;
 
 		/**
 		 * @brief Get the number of input channels
 		 *
 		 * @return long Number of input channels
 		 */
-		long getInputChannelCount() const { return m_inputChannels; }
+		long getInputChannelCount() const override { return m_inputChannels; }
 
 		/**
 		 * @brief Get the number of output channels
 		 *
 		 * @return long Number of output channels
 		 */
-		long getOutputChannelCount() const { return m_outputChannels; }
+		long getOutputChannelCount() const override { return m_outputChannels; }
 
 		/**
 		 * @brief Get the input channel names
 		 *
 		 * @return std::vector<std::string> List of input channel names
 		 */
-		std::vector<std::string> getInputChannelNames() const;
+		std::vector<std::string> getInputChannelNames() const override;
 
 		/**
 		 * @brief Get the output channel names
 		 *
 		 * @return std::vector<std::string> List of output channel names
 		 */
-		std::vector<std::string> getOutputChannelNames() const;
+		std::vector<std::string> getOutputChannelNames() const override;
 
 		/**
 		 * @brief Get the driver's preferred buffer size
 		 *
 		 * @return long Preferred buffer size
 		 */
-		long getPreferredBufferSize() const { return m_preferredBufferSize; }
+		long getPreferredBufferSize() const override { return m_preferredBufferSize; }
 
 		/**
 		 * @brief Get the minimum supported buffer size
@@ -242,11 +247,11 @@ namespace AudioEngine
 		// Get optimal/default device configuration
 		long getOptimalBufferSize() const;
 		double getOptimalSampleRate() const;
-		bool getDefaultDeviceConfiguration(long &bufferSize, double &sampleRate) const;
+		bool getDefaultDeviceConfiguration(long &bufferSize, double &sampleRate) const override;
 
 		// Device configuration state
 		bool isDriverLoaded() const { return m_driverLoaded; }
-		bool isInitialized() const { return m_asioInitialized; }
+		bool isInitialized() const override { return m_asioInitialized; }
 		bool isChannelSetupComplete() const { return m_channelSetupComplete; }
 		bool isBufferCreated() const { return m_bufferCreated; }
 		bool isStreaming() const { return m_streaming; }
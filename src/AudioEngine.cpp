@@ -1,11 +1,17 @@
 #include "AudioEngine.h"
 #include "AsioManager.h"
+#include "AsioDeviceInterface.h"
+#include "VirtualAudioDriver.h"
 #include "OscController.h"
 #include "DeviceStateManager.h"
 #include "AudioBuffer.h"
-#include "AsioNodes.h"
-#include "FileNodes.h"
+#include "AsioSourceNode.h"
+#include "AsioSinkNode.h"
+#include "FileSourceNode.h"
+#include "FileSinkNode.h"
+#include "PlaylistSourceNode.h"
 #include "FfmpegProcessorNode.h"
+#include "DspNodes.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
@@ -35,18 +41,20 @@ namespace AudioEngine
         cleanup();
     }
 
-    bool AudioEngine::initialize(Configuration config)
+    bool AudioEngine::initialize(Configuration config, std::shared_ptr<IExternalControl> externalControl)
     {
         m_config = std::move(config);
+        m_externalControl = std::move(externalControl);
 
-        // Create appropriate hardware interfaces
-        if (!m_config.getAsioDeviceName().empty())
+        // Create appropriate hardware interfaces; the virtual device has no device state to manage
+        if (usesAudioDriver() && !m_config.usesVirtualDevice())
         {
-            m_asioManager = std::make_unique<AsioManager>();
+            auto asioManager = std::make_unique<AsioManager>();
 
             // Create the device interface
-            auto deviceInterface = std::make_unique<AsioDeviceInterface>(*m_asioManager);
+            auto deviceInterface = std::make_unique<AsioDeviceInterface>(asioManager.get());
             m_deviceStateManager = std::make_unique<DeviceStateManager>(std::move(deviceInterface));
+            m_audioDriver = std::move(asioManager);
         }
 
         if (!m_config.getTargetIp().empty())
@@ -85,13 +93,16 @@ namespace AudioEngine
         }
 
         // Continue with node creation and connection setup
-        // Initialize the ASIO manager if we're using ASIO
-        if (!m_config.getAsioDeviceName().empty())
+        // Initialize the audio driver if we're using ASIO or the virtual device
+        if (usesAudioDriver())
         {
-            m_asioManager = std::make_unique<AsioManager>();
+            if (!m_audioDriver)
+            {
+                m_audioDriver = createAudioDriver();
+            }
 
             // Load the driver
-            if (!m_asioManager->loadDriver(m_config.getAsioDeviceName()))
+            if (!m_audioDriver->loadDriver(m_config.getAsioDeviceName()))
             {
                 reportStatus("Error", "Failed to load ASIO driver: " + m_config.getAsioDeviceName());
                 return false;
@@ -100,7 +111,7 @@ namespace AudioEngine
             // Initialize with explicitly configured values or auto-configure
             if (m_config.useAsioAutoConfig())
             {
-                if (!m_asioManager->initDevice(0, 0))
+                if (!m_audioDriver->initDevice(0, 0))
                 {
                     reportStatus("Error", "Failed to initialize ASIO device with default settings");
                     return false;
@@ -109,7 +120,7 @@ namespace AudioEngine
                 // Update configuration with actual device capabilities
                 long bufferSize;
                 double sampleRate;
-                if (m_asioManager->getDefaultDeviceConfiguration(bufferSize, sampleRate))
+                if (m_audioDriver->getDefaultDeviceConfiguration(bufferSize, sampleRate))
                 {
                     m_config.setBufferSize(bufferSize);
                     m_config.setSampleRate(sampleRate);
@@ -126,7 +137,7 @@ namespace AudioEngine
             else
             {
                 // Use explicit configuration
-                if (!m_asioManager->initDevice(m_config.getSampleRate(), m_config.getBufferSize()))
+                if (!m_audioDriver->initDevice(m_config.getSampleRate(), m_config.getBufferSize()))
                 {
                     reportStatus("Error", "Failed to initialize ASIO device with explicit settings");
                     return false;
@@ -136,7 +147,7 @@ namespace AudioEngine
             // Auto-generate a default graph if needed
             if (m_config.getNodes().empty())
             {
-                ConfigurationParser::autoConfigureAsio(m_config, m_asioManager.get());
+                ConfigurationParser::autoConfigureAsio(m_config, m_audioDriver.get());
                 reportStatus("Info", "Generated default audio processing graph");
             }
         }
@@ -163,35 +174,17 @@ namespace AudioEngine
         }
 
         // Set up ASIO buffers if needed
-        if (m_asioManager)
+        if (m_audioDriver)
         {
-            std::vector<long> inputChannels;
-            std::vector<long> outputChannels;
-
-            // Collect channel indices from nodes
-            for (auto &node : m_nodes)
-            {
-                if (auto *source = dynamic_cast<AsioSourceNode *>(node.get()))
-                {
-                    auto indices = source->getAsioChannelIndices();
-                    inputChannels.insert(inputChannels.end(), indices.begin(), indices.end());
-                }
-                else if (auto *sink = dynamic_cast<AsioSinkNode *>(node.get()))
-                {
-                    auto indices = sink->getAsioChannelIndices();
-                    outputChannels.insert(outputChannels.end(), indices.begin(), indices.end());
-                }
-            }
-
-            // Create the ASIO buffers
-            if (!m_asioManager->createBuffers(inputChannels, outputChannels))
+            // Create the ASIO buffers for the channels resolved by the execution plan
+            if (!m_audioDriver->createBuffers(m_plan.getAsioInputChannels(), m_plan.getAsioOutputChannels()))
             {
                 reportStatus("Error", "Failed to create ASIO buffers");
                 return false;
             }
 
             // Set up the ASIO callback
-            m_asioManager->setCallback([this](long doubleBufferIndex)
+            m_audioDriver->setCallback([this](long doubleBufferIndex)
                                        { this->processAsioBlock(doubleBufferIndex, true); });
         }
 
@@ -216,13 +209,21 @@ namespace AudioEngine
             }
         }
 
+        // All per-block scratch lives in the execution plan; status from the audio
+        // thread is queued and delivered by the reporter thread
+        if (m_config.isRealtimeSafe())
+        {
+            startReporter();
+            reportStatus("Info", "Real-time safe mode enabled");
+        }
+
         reportStatus("Info", "Audio engine initialized successfully");
         return true;
     }
 
     bool AudioEngine::autoConfigureAsio()
     {
-        if (!m_asioManager)
+        if (!m_audioDriver)
         {
             reportStatus("Error", "ASIO manager not created");
             return false;
@@ -230,7 +231,7 @@ namespace AudioEngine
 
         // Get the device name from config
         std::string deviceName = m_config.getAsioDeviceName();
-        if (deviceName.empty())
+        if (deviceName.empty() && !m_config.usesVirtualDevice())
         {
             // Get available ASIO devices
             auto devices = AsioManager::getDeviceList();
@@ -246,14 +247,14 @@ namespace AudioEngine
         }
 
         // Load the driver
-        if (!m_asioManager->loadDriver(deviceName))
+        if (!m_audioDriver->loadDriver(deviceName))
         {
             reportStatus("Error", "Failed to load ASIO driver: " + deviceName);
             return false;
         }
 
         // Initialize with default settings (passing 0 for sample rate and buffer size)
-        if (!m_asioManager->initDevice(0, 0))
+        if (!m_audioDriver->initDevice(0, 0))
         {
             reportStatus("Error", "Failed to initialize ASIO device");
             return false;
@@ -262,7 +263,7 @@ namespace AudioEngine
         // Get optimal settings from the driver
         long bufferSize;
         double sampleRate;
-        if (!m_asioManager->getDefaultDeviceConfiguration(bufferSize, sampleRate))
+        if (!m_audioDriver->getDefaultDeviceConfiguration(bufferSize, sampleRate))
         {
             reportStatus("Error", "Failed to get default ASIO configuration");
             return false;
@@ -275,8 +276,8 @@ namespace AudioEngine
                                  " Hz, buffer size: " + std::to_string(bufferSize));
 
         // Get available channels
-        long inputChannelCount = m_asioManager->getInputChannelCount();
-        long outputChannelCount = m_asioManager->getOutputChannelCount();
+        long inputChannelCount = m_audioDriver->getInputChannelCount();
+        long outputChannelCount = m_audioDriver->getOutputChannelCount();
 
         // Prepare default channel configuration:
         // Use first two input channels and first two output channels if available
@@ -296,7 +297,7 @@ namespace AudioEngine
         }
 
         // Create buffers for the selected channels
-        if (!m_asioManager->createBuffers(inputChannels, outputChannels))
+        if (!m_audioDriver->createBuffers(inputChannels, outputChannels))
         {
             reportStatus("Error", "Failed to create ASIO buffers");
             return false;
@@ -326,20 +327,44 @@ namespace AudioEngine
         }
 
         // Set up the ASIO callback
-        m_asioManager->setCallback([this](long doubleBufferIndex)
+        m_audioDriver->setCallback([this](long doubleBufferIndex)
                                    { processAsioBlock(doubleBufferIndex, true); });
 
         return true;
     }
 
+    bool AudioEngine::usesAudioDriver() const
+    {
+        if (m_config.usesNoDevice())
+        {
+            return false;
+        }
+        return m_config.usesVirtualDevice() || !m_config.getAsioDeviceName().empty();
+    }
+
+    std::unique_ptr<IAudioDriver> AudioEngine::createAudioDriver() const
+    {
+        if (m_config.usesVirtualDevice())
+        {
+            VirtualAudioDriver::Options options;
+            options.inputChannels = m_config.getVirtualInputs();
+            options.outputChannels = m_config.getVirtualOutputs();
+            options.loopback = m_config.isVirtualLoopback();
+            options.realtimePriority = m_config.getVirtualPriority();
+            return std::make_unique<VirtualAudioDriver>(options);
+        }
+
+        return std::make_unique<AsioManager>();
+    }
+
     void AudioEngine::createDefaultAsioNodes(const std::vector<long> &inputChannels, const std::vector<long> &outputChannels)
     {
-        if (!m_asioManager)
+        if (!m_audioDriver)
             return;
 
         // Get channel names for better node labeling
-        auto inputChannelNames = m_asioManager->getInputChannelNames();
-        auto outputChannelNames = m_asioManager->getOutputChannelNames();
+        auto inputChannelNames = m_audioDriver->getInputChannelNames();
+        auto outputChannelNames = m_audioDriver->getOutputChannelNames();
 
         // Create an ASIO source node if we have input channels
         if (!inputChannels.empty())
@@ -357,7 +382,7 @@ namespace AudioEngine
             }
 
             sourceParams["channels"] = channelIndices;
-            sourceParams["device"] = m_asioManager->getDeviceName();
+            sourceParams["device"] = m_audioDriver->getDeviceName();
 
             // Create a node config
             NodeConfig nodeConfig;
@@ -387,7 +412,7 @@ namespace AudioEngine
             }
 
             sinkParams["channels"] = channelIndices;
-            sinkParams["device"] = m_asioManager->getDeviceName();
+            sinkParams["device"] = m_audioDriver->getDeviceName();
 
             // Create a node config
             NodeConfig nodeConfig;
@@ -412,6 +437,19 @@ namespace AudioEngine
             return true;
         }
 
+        // Without a device clock, file graphs may render faster than real time
+        const bool offline = !m_audioDriver && m_config.isOfflineRender();
+        for (auto &node : m_nodes)
+        {
+            node->setOfflineMode(offline);
+        }
+
+        {
+            std::lock_guard<std::mutex> renderLock(m_renderMutex);
+            m_renderStats = RenderStats{};
+            m_renderFinished = !offline; // Nothing to wait for in real time
+        }
+
         // Start all nodes
         for (auto &node : m_nodes)
         {
@@ -431,9 +469,9 @@ namespace AudioEngine
         }
 
         // Start ASIO if it's being used
-        if (m_asioManager)
+        if (m_audioDriver)
         {
-            if (!m_asioManager->start())
+            if (!m_audioDriver->start())
             {
                 reportStatus("Error", "Failed to start ASIO");
                 // Stop all nodes
@@ -456,6 +494,7 @@ namespace AudioEngine
         }
 
         m_running.store(true);
+        startStatsPublisher();
         reportStatus("Info", "AudioEngine started");
         return true;
     }
@@ -469,10 +508,24 @@ namespace AudioEngine
             return;
         }
 
+        stopStatsPublisher();
+
         // Stop ASIO if it's being used
-        if (m_asioManager)
+        if (m_audioDriver)
         {
-            m_asioManager->stop();
+            m_audioDriver->stop();
+
+            if (m_config.usesVirtualDevice())
+            {
+                const auto stats = static_cast<VirtualAudioDriver *>(m_audioDriver.get())->getTimingStats();
+                std::ostringstream summary;
+                summary << "Virtual device timing: " << stats.callbacks << " callbacks, "
+                        << stats.overruns << " overruns, " << stats.missedPeriods << " missed periods, "
+                        << "wake latency " << stats.wakeLatencyMeanUs << "/" << stats.wakeLatencyMaxUs << " us (mean/max), "
+                        << "callback " << stats.callbackMeanUs << "/" << stats.callbackMaxUs << " us of "
+                        << stats.periodUs << " us period";
+                reportStatus("Info", summary.str());
+            }
         }
         else
         {
@@ -515,16 +568,21 @@ namespace AudioEngine
             m_processingThread.join();
         }
 
+        // Flush queued events while the nodes they refer to are still alive
+        stopReporter();
+
         // Clear all nodes and connections
         m_nodes.clear();
         m_nodeMap.clear();
         m_connections.clear();
         m_processOrder.clear();
+        m_scheduler.stop();
+        m_plan.clear();
 
         // Clean up ASIO and OSC controllers
-        if (m_asioManager)
+        if (m_audioDriver)
         {
-            m_asioManager.reset();
+            m_audioDriver.reset();
         }
 
         if (m_oscController)
@@ -538,159 +596,132 @@ namespace AudioEngine
     bool AudioEngine::processAsioBlock(long doubleBufferIndex, bool directProcess)
     {
         // This is called from the ASIO thread, so be careful about thread safety
-        if (!m_running.load())
+        if (!m_running.load() || !m_plan.isValid())
         {
             return false;
         }
 
-        try
+        // Real-time safe mode: no exception frames, string building or locks on this thread
+        if (m_config.isRealtimeSafe())
         {
-            // Get all AsioSourceNodes and AsioSinkNodes
-            std::vector<AsioSourceNode *> asioSources;
-            std::vector<AsioSinkNode *> asioSinks;
-
-            for (const auto &node : m_nodes)
-            {
-                if (node->getType() == NodeType::ASIO_SOURCE)
-                {
-                    asioSources.push_back(static_cast<AsioSourceNode *>(node.get()));
-                }
-                else if (node->getType() == NodeType::ASIO_SINK)
-                {
-                    asioSinks.push_back(static_cast<AsioSinkNode *>(node.get()));
-                }
-            }
-
-            // Get ASIO buffers for all active input channels
-            std::vector<long> inputChannelIndices;
-            std::vector<void *> inputBuffers;
-
-            // Collect all input channel indices from source nodes
-            for (AsioSourceNode *node : asioSources)
-            {
-                // Implementation needed for getting channel indices from node
-                // This is a placeholder - actual implementation needs to access private members
-                // which should be done through a better interface
-
-                // For now, assume we have a getter for channel indices
-                // std::vector<long> indices = node->getChannelIndices();
-                // inputChannelIndices.insert(inputChannelIndices.end(), indices.begin(), indices.end());
-            }
-
-            // Get the input buffer pointers from ASIO
-            if (!inputChannelIndices.empty())
-            {
-                if (!m_asioManager->getBufferPointers(doubleBufferIndex, inputChannelIndices, inputBuffers))
-                {
-                    reportStatus("Error", "Failed to get ASIO input buffer pointers");
-                    return false;
-                }
-            }
-
-            // Deliver input buffers to source nodes
-            // This is a simplified approach - in reality, we might need a more sophisticated
-            // way to map buffer pointers to nodes
+            return runAsioBlock(doubleBufferIndex);
+        }
 
-            int bufferIndex = 0;
-            for (AsioSourceNode *node : asioSources)
-            {
-                // Again, this is a simplified approach
-                // Would need to get the channel count and slice the buffer array accordingly
-                // node->receiveAsioData(doubleBufferIndex, std::vector<void*>(inputBuffers.begin() + bufferIndex, ...));
-                // bufferIndex += node->getChannelCount();
-            }
+        try
+        {
+            return runAsioBlock(doubleBufferIndex);
+        }
+        catch (const std::exception &e)
+        {
+            reportStatus("Error", "Exception in processAsioBlock: " + std::string(e.what()));
+            return false;
+        }
+        catch (...)
+        {
+            reportStatus("Error", "Unknown exception in processAsioBlock");
+            return false;
+        }
+    }
 
-            // Process all nodes in the calculated order
-            for (auto node : m_processOrder)
-            {
-                // Skip ASIO nodes - they're handled separately
-                if (node->getType() == NodeType::ASIO_SOURCE || node->getType() == NodeType::ASIO_SINK)
-                {
-                    continue;
-                }
+    bool AudioEngine::runAsioBlock(long doubleBufferIndex)
+    {
+        const auto blockStart = PerformanceMonitor::now();
 
-                // Process the node
-                if (!node->process())
-                {
-                    reportStatus("Warning", "Node processing failed: " + node->getName());
-                    // Continue with other nodes
-                }
-            }
+        // Resolve this block's hardware buffers into the preallocated tables
+        if (!m_plan.getAsioInputChannels().empty() &&
+            !m_audioDriver->getBufferPointers(doubleBufferIndex, true, m_plan.getAsioInputChannels(), m_plan.getAsioInputPointers()))
+        {
+            postEvent("Error", "Failed to get ASIO input buffer pointers", nullptr, doubleBufferIndex);
+            return false;
+        }
 
-            // Transfer data between connected nodes
-            for (const auto &connection : m_connections)
-            {
-                // Get output buffer from source node
-                auto sourceNode = connection.getSourceNode();
-                auto sinkNode = connection.getSinkNode();
+        if (!m_plan.getAsioOutputChannels().empty() &&
+            !m_audioDriver->getBufferPointers(doubleBufferIndex, false, m_plan.getAsioOutputChannels(), m_plan.getAsioOutputPointers()))
+        {
+            postEvent("Error", "Failed to get ASIO output buffer pointers", nullptr, doubleBufferIndex);
+            return false;
+        }
 
-                if (!sourceNode || !sinkNode)
-                {
-                    continue;
-                }
+        m_plan.scatterAsioPointers();
 
-                int sourcePad = connection.getSourcePad();
-                int sinkPad = connection.getSinkPad();
+        // Run the graph; returns once every node of the block has been processed
+        runPlan(doubleBufferIndex);
+        m_performance.recordBlock(PerformanceMonitor::elapsedNs(blockStart));
 
-                // Get output buffer from source node
-                auto buffer = sourceNode->getOutputBuffer(sourcePad);
+        // Signal the driver that we're done with this buffer
+        m_audioDriver->outputReady();
 
-                // Set input buffer on sink node
-                if (buffer)
-                {
-                    if (!sinkNode->setInputBuffer(buffer, sinkPad))
-                    {
-                        reportStatus("Warning", "Failed to transfer buffer from " +
-                                                    sourceNode->getName() + " to " + sinkNode->getName());
-                    }
-                }
-            }
+        return true;
+    }
 
-            // Get ASIO buffers for all active output channels
-            std::vector<long> outputChannelIndices;
-            std::vector<void *> outputBuffers;
+    void AudioEngine::runPlan(long doubleBufferIndex)
+    {
+        if (m_scheduler.runBlock(doubleBufferIndex) == 0)
+        {
+            return;
+        }
 
-            // Collect all output channel indices from sink nodes
-            for (AsioSinkNode *node : asioSinks)
+        // Failures are collected per step so worker threads never touch the event ring
+        const auto &steps = m_plan.getSteps();
+        for (size_t i = 0; i < steps.size(); i++)
+        {
+            if (m_scheduler.stepFailed(i))
             {
-                // Implementation needed for getting channel indices from node
-                // Similar to the source nodes above
+                postEvent("Warning", "Node processing failed", steps[i].node);
             }
+        }
+    }
 
-            // Get the output buffer pointers from ASIO
-            if (!outputChannelIndices.empty())
-            {
-                if (!m_asioManager->getBufferPointers(doubleBufferIndex, outputChannelIndices, outputBuffers))
-                {
-                    reportStatus("Error", "Failed to get ASIO output buffer pointers");
-                    return false;
-                }
-            }
+    bool AudioEngine::runPlanStep(const ExecutionPlan::Step &step, long doubleBufferIndex)
+    {
+        const auto stepStart = PerformanceMonitor::now();
+        AudioNode *node = step.node;
+        const auto &inputEdges = m_plan.getInputEdges();
+        const auto &outputEdges = m_plan.getOutputEdges();
 
-            // Get output data from sink nodes and copy to ASIO buffers
-            bufferIndex = 0;
-            for (AsioSinkNode *node : asioSinks)
+        // Deliver upstream buffers published earlier in this block
+        for (uint32_t i = step.inputBegin; i < step.inputEnd; i++)
+        {
+            const auto &buffer = m_plan.slot(inputEdges[i].slot);
+            if (buffer)
             {
-                // Again, this is a simplified approach
-                // node->provideAsioData(doubleBufferIndex, std::vector<void*>(outputBuffers.begin() + bufferIndex, ...));
-                // bufferIndex += node->getChannelCount();
+                node->setInputBuffer(buffer, inputEdges[i].pad);
             }
+        }
 
-            // Signal ASIO that we're done with this buffer
-            ASIOOutputReady();
-
-            return true;
+        // Drop last block's outputs so the node can recycle its buffers in place
+        for (uint32_t i = step.outputBegin; i < step.outputEnd; i++)
+        {
+            m_plan.slot(outputEdges[i].slot).reset();
         }
-        catch (const std::exception &e)
+
+        bool result = true;
+        switch (step.kind)
         {
-            reportStatus("Error", "Exception in processAsioBlock: " + std::string(e.what()));
-            return false;
+        case ExecutionPlan::StepKind::ASIO_SOURCE:
+            result = static_cast<AsioSourceNode *>(node)->receiveAsioData(doubleBufferIndex, m_plan.getAsioInputTable().data()) &&
+                     node->process();
+            break;
+
+        case ExecutionPlan::StepKind::ASIO_SINK:
+            result = node->process() &&
+                     static_cast<AsioSinkNode *>(node)->provideAsioData(doubleBufferIndex, m_plan.getAsioOutputTable().data());
+            break;
+
+        default:
+            result = node->process();
+            break;
         }
-        catch (...)
+
+        // Publish outputs; fan-out consumers share the same slot
+        for (uint32_t i = step.outputBegin; i < step.outputEnd; i++)
         {
-            reportStatus("Error", "Unknown exception in processAsioBlock");
-            return false;
+            m_plan.slot(outputEdges[i].slot) = node->getOutputBuffer(outputEdges[i].pad);
         }
+
+        m_performance.recordStep(static_cast<size_t>(&step - m_plan.getSteps().data()),
+                                 PerformanceMonitor::elapsedNs(stepStart));
+        return result;
     }
 
     AudioNode *AudioEngine::getNodeByName(const std::string &name)
@@ -728,21 +759,21 @@ namespace AudioEngine
             // Create the appropriate type of node
             if (nodeConfig.type == "asio_source")
             {
-                if (!m_asioManager)
+                if (!m_audioDriver)
                 {
                     reportStatus("Error", "ASIO manager not available for asio_source node: " + nodeConfig.name);
                     return false;
                 }
-                node = std::make_unique<AsioSourceNode>(nodeConfig.name, this, m_asioManager.get());
+                node = std::make_unique<AsioSourceNode>(nodeConfig.name, this, m_audioDriver.get());
             }
             else if (nodeConfig.type == "asio_sink")
             {
-                if (!m_asioManager)
+                if (!m_audioDriver)
                 {
                     reportStatus("Error", "ASIO manager not available for asio_sink node: " + nodeConfig.name);
                     return false;
                 }
-                node = std::make_unique<AsioSinkNode>(nodeConfig.name, this, m_asioManager.get());
+                node = std::make_unique<AsioSinkNode>(nodeConfig.name, this, m_audioDriver.get());
             }
             else if (nodeConfig.type == "file_source")
             {
@@ -752,10 +783,19 @@ namespace AudioEngine
             {
                 node = std::make_unique<FileSinkNode>(nodeConfig.name, this);
             }
+            else if (nodeConfig.type == "playlist_source")
+            {
+                node = std::make_unique<PlaylistSourceNode>(nodeConfig.name, this);
+            }
             else if (nodeConfig.type == "ffmpeg_processor")
             {
                 node = std::make_unique<FfmpegProcessorNode>(nodeConfig.name, this);
             }
+            else if (auto dspNode = createDspNode(nodeConfig.type, nodeConfig.name, nodeConfig.params, this))
+            {
+                // Native DSP, mixing, metering and resampling nodes (see createDspNode)
+                node = std::move(dspNode);
+            }
             else
             {
                 reportStatus("Error", "Unknown node type: " + nodeConfig.type);
@@ -857,55 +897,215 @@ namespace AudioEngine
         }
     }
 
-    bool AudioEngine::calculateProcessOrder()
+    namespace
     {
-        // This is a simple implementation that just ensures sources come before
-        // processors, which come before sinks. A more sophisticated approach would
-        // use a topological sort based on the connections.
-
-        m_processOrder.clear();
-
-        // First add all source nodes
-        for (const auto &node : m_nodes)
+        std::string formatEvent(const char *message, const AudioNode *node, long value)
         {
-            if (node->getType() == NodeType::ASIO_SOURCE ||
-                node->getType() == NodeType::FILE_SOURCE)
+            std::string text = node ? node->getName() + ": " + message : std::string(message);
+            if (value >= 0)
             {
-                m_processOrder.push_back(node.get());
+                text += " (" + std::to_string(value) + ")";
             }
+            return text;
         }
+    } // namespace
 
-        // Then add all processor nodes
-        for (const auto &node : m_nodes)
+    void AudioEngine::postEvent(const char *category, const char *message, const AudioNode *node, long value)
+    {
+        if (!m_config.isRealtimeSafe())
         {
-            if (node->getType() == NodeType::FFMPEG_PROCESSOR)
-            {
-                m_processOrder.push_back(node.get());
-            }
+            reportStatus(category, formatEvent(message, node, value));
+            return;
+        }
+
+        if (!m_eventRing.tryPush(EngineEvent{category, message, node, value}))
+        {
+            m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
         }
+    }
 
-        // Finally add all sink nodes
-        for (const auto &node : m_nodes)
+    void AudioEngine::drainEvents()
+    {
+        EngineEvent event;
+        while (m_eventRing.tryPop(event))
         {
-            if (node->getType() == NodeType::ASIO_SINK ||
-                node->getType() == NodeType::FILE_SINK)
+            reportStatus(event.category, formatEvent(event.message, event.node, event.value));
+        }
+
+        uint64_t dropped = m_droppedEvents.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0)
+        {
+            reportStatus("Warning", "Event ring full, dropped " + std::to_string(dropped) + " status events");
+        }
+    }
+
+    void AudioEngine::runReporterLoop()
+    {
+        while (!m_stopReporter.load(std::memory_order_acquire))
+        {
+            drainEvents();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        // Deliver whatever the audio thread queued before shutdown
+        drainEvents();
+    }
+
+    void AudioEngine::startReporter()
+    {
+        if (m_reporterThread.joinable())
+        {
+            return;
+        }
+
+        m_eventRing.clear();
+        m_droppedEvents.store(0);
+        m_stopReporter.store(false);
+        m_reporterThread = std::thread(&AudioEngine::runReporterLoop, this);
+    }
+
+    void AudioEngine::stopReporter()
+    {
+        if (m_reporterThread.joinable())
+        {
+            m_stopReporter.store(true, std::memory_order_release);
+            m_reporterThread.join();
+        }
+    }
+
+    void AudioEngine::runStatsPublisher()
+    {
+        const auto interval = std::chrono::milliseconds(m_config.getStatsInterval());
+        auto next = std::chrono::steady_clock::now() + interval;
+
+        while (!m_stopStats.load(std::memory_order_acquire))
+        {
+            // Short sleeps keep stop() responsive with long intervals
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            if (std::chrono::steady_clock::now() < next)
             {
-                m_processOrder.push_back(node.get());
+                continue;
             }
+
+            publishPerformanceStats();
+            next += interval;
+        }
+    }
+
+    void AudioEngine::publishPerformanceStats()
+    {
+        const PerformanceStats stats = m_performance.getStats();
+
+        // OSC has no 64-bit integer here; counters wrap at 2^31
+        sendExternalCommand("/engine/stats/blocks", {static_cast<int>(stats.blocks)});
+        sendExternalCommand("/engine/stats/xruns", {static_cast<int>(stats.xruns)});
+        sendExternalCommand("/engine/stats/budget_us", {static_cast<float>(stats.budgetUs)});
+        sendExternalCommand("/engine/stats/block", {static_cast<float>(stats.blockMeanUs),
+                                                     static_cast<float>(stats.blockMaxUs),
+                                                     static_cast<float>(stats.lastBlockUs)});
+        sendExternalCommand("/engine/stats/load", {static_cast<float>(stats.loadPercent),
+                                                    static_cast<float>(stats.peakLoadPercent)});
+
+        // Node names may hold characters that are not valid in an OSC address, so the name is an argument
+        for (const auto &node : stats.nodes)
+        {
+            sendExternalCommand("/engine/stats/node", {node.name, static_cast<float>(node.meanUs),
+                                                       static_cast<float>(node.maxUs), static_cast<float>(node.lastUs)});
+        }
+
+        if (!stats.worstBlocks.empty())
+        {
+            const auto &worst = stats.worstBlocks.front();
+            sendExternalCommand("/engine/stats/worst", {static_cast<int>(worst.block), static_cast<float>(worst.durationUs),
+                                                         worst.slowestNode, static_cast<float>(worst.slowestNodeUs)});
+        }
+    }
+
+    void AudioEngine::startStatsPublisher()
+    {
+        if (m_statsThread.joinable() || !m_externalControl || m_config.getStatsInterval() <= 0)
+        {
+            return;
         }
 
-        // Verify that all nodes are in the processing order
-        if (m_processOrder.size() != m_nodes.size())
+        m_stopStats.store(false);
+        m_statsThread = std::thread(&AudioEngine::runStatsPublisher, this);
+    }
+
+    void AudioEngine::stopStatsPublisher()
+    {
+        if (m_statsThread.joinable())
+        {
+            m_stopStats.store(true, std::memory_order_release);
+            m_statsThread.join();
+        }
+    }
+
+    bool AudioEngine::setExternalControl(std::shared_ptr<IExternalControl> externalControl)
+    {
+        if (m_running.load())
         {
-            reportStatus("Error", "Not all nodes were added to the processing order");
+            reportStatus("Warning", "Cannot replace external control while running");
             return false;
         }
 
+        m_externalControl = std::move(externalControl);
+        return true;
+    }
+
+    bool AudioEngine::sendExternalCommand(const std::string &address, const std::vector<std::any> &args)
+    {
+        if (!m_externalControl)
+        {
+            return true;
+        }
+
+        return m_externalControl->sendCommand(address, args);
+    }
+
+    bool AudioEngine::calculateProcessOrder()
+    {
+        // Compile the graph once; the processing paths only walk the flat plan
+        std::string error;
+        m_scheduler.stop();
+        if (!ExecutionPlan::build(m_nodes, m_connections, m_plan, error))
+        {
+            m_plan.clear();
+            m_processOrder.clear();
+            reportStatus("Error", "Failed to build execution plan: " + error);
+            return false;
+        }
+
+        m_processOrder = m_plan.getOrder();
+
+        std::vector<std::string> stepNames;
+        for (const auto &step : m_plan.getSteps())
+        {
+            stepNames.push_back(step.node->getName());
+        }
+        m_performance.configure(stepNames, m_config.getSampleRate(), m_config.getBufferSize());
+
+        // Independent branches run on the worker pool; small graphs stay on the calling thread
+        m_scheduler.start(m_plan,
+                          static_cast<size_t>(std::max(0, m_config.getWorkerThreads())),
+                          static_cast<size_t>(std::max(0, m_config.getParallelMinNodes())),
+                          [this](const ExecutionPlan::Step &step, long doubleBufferIndex)
+                          { return runPlanStep(step, doubleBufferIndex); });
+
+        reportStatus("Info", "Execution plan built: " + std::to_string(m_plan.getSteps().size()) + " nodes, " +
+                                 std::to_string(m_plan.getSlotCount()) + " buffer slots, " +
+                                 std::to_string(m_scheduler.getThreadCount()) + " processing thread(s)");
         return true;
     }
 
     void AudioEngine::runFileProcessingLoop()
     {
+        if (m_config.isOfflineRender())
+        {
+            runOfflineRender();
+            return;
+        }
+
         reportStatus("Info", "Non-ASIO processing loop started");
 
         // Calculate processing interval based on buffer size and sample rate
@@ -917,13 +1117,13 @@ namespace AudioEngine
 
         auto nextProcessingTime = std::chrono::high_resolution_clock::now();
 
-        // Get list of file source nodes
-        std::vector<FileSourceNode *> fileSourceNodes;
-        for (const auto &node : m_nodes)
+        // Get list of file and playlist source nodes
+        std::vector<AudioNode *> fileSourceNodes;
+        for (const auto &step : m_plan.getSteps())
         {
-            if (node->getType() == NodeType::FILE_SOURCE)
+            if (step.node->getType() == NodeType::FILE_SOURCE || step.node->getType() == NodeType::PLAYLIST_SOURCE)
             {
-                fileSourceNodes.push_back(static_cast<FileSourceNode *>(node.get()));
+                fileSourceNodes.push_back(step.node);
             }
         }
 
@@ -934,55 +1134,16 @@ namespace AudioEngine
 
             try
             {
-                // Process all nodes in the calculated order
-                for (auto node : m_processOrder)
-                {
-                    // Skip file source nodes, as they're handled separately
-                    if (node->getType() == NodeType::FILE_SOURCE)
-                        continue;
-
-                    // Process the node
-                    if (!node->process())
-                    {
-                        reportStatus("Warning", "Node processing failed: " + node->getName());
-                        // Continue with other nodes
-                    }
-                }
-
-                // Transfer data between connected nodes
-                for (const auto &connection : m_connections)
-                {
-                    // Get output buffer from source node
-                    auto sourceNode = connection.getSourceNode();
-                    auto sinkNode = connection.getSinkNode();
-
-                    if (!sourceNode || !sinkNode)
-                    {
-                        continue;
-                    }
-
-                    int sourcePad = connection.getSourcePad();
-                    int sinkPad = connection.getSinkPad();
-
-                    // Get output buffer from source node
-                    auto buffer = sourceNode->getOutputBuffer(sourcePad);
-
-                    // Set input buffer on sink node
-                    if (buffer)
-                    {
-                        if (!sinkNode->setInputBuffer(buffer, sinkPad))
-                        {
-                            reportStatus("Warning", "Failed to transfer buffer from " +
-                                                        sourceNode->getName() + " to " + sinkNode->getName());
-                        }
-                    }
-                }
+                // Run the graph for this block
+                const auto blockStart = PerformanceMonitor::now();
+                runPlan(0);
+                m_performance.recordBlock(PerformanceMonitor::elapsedNs(blockStart));
 
                 // Check if any file source is at end of file
                 bool allDone = !fileSourceNodes.empty();
                 for (auto fileSource : fileSourceNodes)
                 {
-                    if (!fileSource->isEndOfFile())
+                    if (!fileSource->isDrained())
                     {
                         allDone = false;
                         break;
@@ -1021,8 +1182,8 @@ namespace AudioEngine
             else
             {
                 // We're behind schedule, log a warning and adjust the next processing time
-                reportStatus("Warning", "Processing took longer than interval: " +
-                                            std::to_string(elapsedTime.count()) + " microseconds");
+                postEvent("Warning", "Processing took longer than interval (microseconds)", nullptr,
+                          static_cast<long>(elapsedTime.count()));
                 nextProcessingTime = endTime + processingInterval;
             }
         }
@@ -1030,6 +1191,137 @@ namespace AudioEngine
         reportStatus("Info", "Non-ASIO processing loop ended");
     }
 
+    void AudioEngine::runOfflineRender()
+    {
+        reportStatus("Info", "Offline render started");
+
+        const auto &steps = m_plan.getSteps();
+        const auto &successors = m_plan.getSuccessors();
+        const auto &outputEdges = m_plan.getOutputEdges();
+
+        // Upstream steps still running, and the block count when the last of them finished
+        std::vector<uint32_t> pendingInputs(steps.size());
+        std::vector<uint64_t> inputsEndedAt(steps.size(), 0);
+        std::vector<bool> finished(steps.size(), false);
+        for (size_t i = 0; i < steps.size(); i++)
+        {
+            pendingInputs[i] = steps[i].dependencyCount;
+        }
+
+        RenderStats stats{};
+        size_t remaining = steps.size();
+        const auto renderStart = PerformanceMonitor::now();
+
+        while (!m_stopProcessingThread && remaining > 0)
+        {
+            try
+            {
+                // Sources wait for their readers, so every block carries real data
+                const auto blockStart = PerformanceMonitor::now();
+                runPlan(0);
+                m_performance.recordBlock(PerformanceMonitor::elapsedNs(blockStart));
+            }
+            catch (const std::exception &e)
+            {
+                reportStatus("Error", "Exception in offline render: " + std::string(e.what()));
+                break;
+            }
+            catch (...)
+            {
+                reportStatus("Error", "Unknown exception in offline render");
+                break;
+            }
+            stats.blocks++;
+
+            // Audio time advances by the longest buffer any source delivered
+            long blockFrames = 0;
+            for (const auto &step : steps)
+            {
+                if (step.dependencyCount != 0)
+                {
+                    continue;
+                }
+                for (uint32_t e = step.outputBegin; e < step.outputEnd; e++)
+                {
+                    const auto &buffer = m_plan.slot(outputEdges[e].slot);
+                    if (buffer)
+                    {
+                        blockFrames = std::max(blockFrames, buffer->getFrameCount());
+                    }
+                }
+            }
+            stats.frames += blockFrames;
+
+            // Propagate end of stream; a notified step gets at least one more block to drain
+            for (size_t i = 0; i < steps.size(); i++)
+            {
+                if (finished[i] || pendingInputs[i] > 0 || inputsEndedAt[i] >= stats.blocks)
+                {
+                    continue;
+                }
+
+                bool produced = false;
+                for (uint32_t e = steps[i].outputBegin; e < steps[i].outputEnd && !produced; e++)
+                {
+                    produced = m_plan.slot(outputEdges[e].slot) != nullptr;
+                }
+                if (produced || !steps[i].node->isDrained())
+                {
+                    continue;
+                }
+
+                finished[i] = true;
+                remaining--;
+                for (uint32_t s = steps[i].successorBegin; s < steps[i].successorEnd; s++)
+                {
+                    const uint32_t successor = successors[s];
+                    if (--pendingInputs[successor] == 0)
+                    {
+                        inputsEndedAt[successor] = stats.blocks;
+                        steps[successor].node->endOfStream();
+                    }
+                }
+            }
+        }
+
+        stats.wallSeconds = PerformanceMonitor::elapsedNs(renderStart) / 1e9;
+        stats.audioSeconds = m_config.getSampleRate() > 0 ? stats.frames / m_config.getSampleRate() : 0.0;
+        stats.realtimeFactor = stats.wallSeconds > 0.0 ? stats.audioSeconds / stats.wallSeconds : 0.0;
+        stats.complete = remaining == 0;
+
+        std::ostringstream summary;
+        summary << "Offline render " << (stats.complete ? "complete" : "stopped") << ": "
+                << stats.audioSeconds << " s of audio in " << stats.wallSeconds << " s ("
+                << stats.realtimeFactor << "x real time, " << stats.blocks << " blocks)";
+        reportStatus("Info", summary.str());
+
+        {
+            std::lock_guard<std::mutex> lock(m_renderMutex);
+            m_renderStats = stats;
+            m_renderFinished = true;
+        }
+        m_renderCondVar.notify_all();
+    }
+
+    bool AudioEngine::waitForRender(int timeoutMs)
+    {
+        std::unique_lock<std::mutex> lock(m_renderMutex);
+        if (timeoutMs < 0)
+        {
+            m_renderCondVar.wait(lock, [this]
+                                 { return m_renderFinished; });
+            return true;
+        }
+        return m_renderCondVar.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]
+                                        { return m_renderFinished; });
+    }
+
+    RenderStats AudioEngine::getRenderStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_renderMutex);
+        return m_renderStats;
+    }
+
     /**
      * @brief Configure ASIO using the device's default settings
      *
@@ -1042,13 +1334,13 @@ namespace AudioEngine
      */
     bool AudioEngine::configureAsioDefaults(const std::string &deviceName)
     {
-        if (!m_asioManager)
+        if (!m_audioDriver)
         {
-            m_asioManager = std::make_unique<AsioManager>();
+            m_audioDriver = createAudioDriver();
         }
 
         // Load the selected driver
-        if (!m_asioManager->loadDriver(deviceName))
+        if (!m_audioDriver->loadDriver(deviceName))
         {
             reportStatus("Error", "Failed to load ASIO driver: " + deviceName);
             return false;
@@ -1056,19 +1348,19 @@ namespace AudioEngine
 
         // Initialize the device with its default settings
         // Pass 0 for preferredSampleRate and preferredBufferSize to use the device defaults
-        if (!m_asioManager->initDevice(0, 0))
+        if (!m_audioDriver->initDevice(0, 0))
         {
             reportStatus("Error", "Failed to initialize ASIO device");
             return false;
         }
 
         // Get the device's default configuration
-        double sampleRate = m_asioManager->getSampleRate();
-        long bufferSize = m_asioManager->getPreferredBufferSize();
+        double sampleRate = m_audioDriver->getSampleRate();
+        long bufferSize = m_audioDriver->getPreferredBufferSize();
 
         // Get available channels
-        long inputChannelCount = m_asioManager->getInputChannelCount();
-        long outputChannelCount = m_asioManager->getOutputChannelCount();
+        long inputChannelCount = m_audioDriver->getInputChannelCount();
+        long outputChannelCount = m_audioDriver->getOutputChannelCount();
 
         // Prepare default channel configuration:
         // Use first two input channels and first two output channels if available
@@ -1088,7 +1380,7 @@ namespace AudioEngine
         }
 
         // Create buffers for the selected channels
-        if (!m_asioManager->createBuffers(inputChannels, outputChannels))
+        if (!m_audioDriver->createBuffers(inputChannels, outputChannels))
         {
             reportStatus("Error", "Failed to create ASIO buffers");
             return false;
@@ -1103,7 +1395,7 @@ namespace AudioEngine
         }
 
         // Set up the ASIO callback
-        m_asioManager->setCallback([this](long doubleBufferIndex)
+        m_audioDriver->setCallback([this](long doubleBufferIndex)
                                    { processAsioBlock(doubleBufferIndex, true); });
 
         // Create default ASIO nodes based on the configured channels
@@ -1127,8 +1419,8 @@ namespace AudioEngine
     void AudioEngine::createDefaultAsioNodes(const std::vector<long> &inputChannels, const std::vector<long> &outputChannels)
     {
         // Get channel names for better node labeling
-        auto inputChannelNames = m_asioManager->getInputChannelNames();
-        auto outputChannelNames = m_asioManager->getOutputChannelNames();
+        auto inputChannelNames = m_audioDriver->getInputChannelNames();
+        auto outputChannelNames = m_audioDriver->getOutputChannelNames();
 
         // Create an ASIO source node if we have input channels
         if (!inputChannels.empty())
@@ -1155,7 +1447,7 @@ namespace AudioEngine
             sourceParams["channels"] = channelIndices;
 
             // Create the node
-            auto sourceNode = std::make_shared<AsioSourceNode>(nodeName, this, m_asioManager.get());
+            auto sourceNode = std::make_shared<AsioSourceNode>(nodeName, this, m_audioDriver.get());
 
             // Configure the node and add it to the engine
             if (sourceNode->configure(sourceParams, m_sampleRate, m_bufferSize, m_sampleFormat, m_channelLayout))
@@ -1194,7 +1486,7 @@ namespace AudioEngine
             sinkParams["channels"] = channelIndices;
 
             // Create the node
-            auto sinkNode = std::make_shared<AsioSinkNode>(nodeName, this, m_asioManager.get());
+            auto sinkNode = std::make_shared<AsioSinkNode>(nodeName, this, m_audioDriver.get());
 
             // Configure the node and add it to the engine
             if (sinkNode->configure(sinkParams, m_sampleRate, m_bufferSize, m_sampleFormat, m_channelLayout))
@@ -7,11 +7,16 @@
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <functional>
 #include <any>
 
 #include "Configuration.h"
 #include "IExternalControl.h"
+#include "ExecutionPlan.h"
+#include "GraphScheduler.h"
+#include "PerformanceMonitor.h"
+#include "SpscRing.h"
 
 // Forward declarations
 extern "C"
@@ -23,11 +28,24 @@ extern "C"
 namespace AudioEngine
 {
 	// Forward declarations
-	class AsioManager;
+	class IAudioDriver;
 	class AudioNode;
 	class Connection;
 	class DeviceStateManager;
 
+	/**
+	 * @brief Outcome of an offline render
+	 */
+	struct RenderStats
+	{
+		uint64_t blocks;	   // Blocks processed
+		int64_t frames;		   // Frames delivered by the sources
+		double audioSeconds;   // frames / sample rate
+		double wallSeconds;	   // Time the render took
+		double realtimeFactor; // audioSeconds / wallSeconds
+		bool complete;		   // End of stream reached every node (false if stopped early)
+	};
+
 	/**
 	 * @brief Core audio engine class
 	 *
@@ -90,6 +108,42 @@ namespace AudioEngine
 		 */
 		bool processAsioBlock(long doubleBufferIndex, bool directProcess = false);
 
+		/**
+		 * @brief Get block and node timing statistics
+		 *
+		 * Safe to call from any thread while the engine runs.
+		 *
+		 * @return Snapshot of the performance counters
+		 */
+		PerformanceStats getPerformanceStats() const { return m_performance.getStats(); }
+
+		/**
+		 * @brief Reset block and node timing statistics
+		 *
+		 * Safe to call from any thread; the counters are cleared after the next
+		 * processed block.
+		 */
+		void resetPerformanceStats() { m_performance.reset(); }
+
+		/**
+		 * @brief Wait for an offline render to finish
+		 *
+		 * Returns once end of stream has propagated through the whole graph (or
+		 * the render stopped). The engine keeps running until stop() is called,
+		 * which finalizes the sinks.
+		 *
+		 * @param timeoutMs Maximum time to wait in milliseconds (negative = forever)
+		 * @return true if the render has finished
+		 */
+		bool waitForRender(int timeoutMs = -1);
+
+		/**
+		 * @brief Get the result of the last offline render
+		 *
+		 * @return Render statistics (zeroed while a render is in progress)
+		 */
+		RenderStats getRenderStats() const;
+
 		/**
 		 * @brief Get a node by name
 		 *
@@ -164,10 +218,25 @@ namespace AudioEngine
 		 */
 		bool applyConfiguration(const Configuration &config, std::function<void(bool)> callback);
 
+		/**
+		 * @brief Raise a status event from the processing thread
+		 *
+		 * Also used by nodes from their process() and ASIO callbacks, which run
+		 * on that thread. In real-time safe mode the event is queued to the
+		 * reporter thread (and counted as dropped if the ring is full);
+		 * otherwise it is reported directly through reportStatus().
+		 *
+		 * @param category Static category string
+		 * @param message Static message string
+		 * @param node Node the event refers to (may be nullptr)
+		 * @param value Optional numeric detail
+		 */
+		void postEvent(const char *category, const char *message, const AudioNode *node = nullptr, long value = -1);
+
 	private:
 		// Configuration
 		Configuration m_config;
-		std::unique_ptr<AsioManager> m_asioManager;
+		std::unique_ptr<IAudioDriver> m_audioDriver; // ASIO hardware or virtual device
 		std::shared_ptr<IExternalControl> m_externalControl; // Optional external control
 
 		// Node management
@@ -189,10 +258,102 @@ namespace AudioEngine
 		bool sendExternalCommands(); // Changed from sendOscCommands
 		void reportStatus(const std::string &category, const std::string &message);
 
+		/**
+		 * @brief Status event raised on the audio thread
+		 *
+		 * Holds only static strings and a node pointer so it can be queued without
+		 * allocating; the reporter thread formats it into a status message.
+		 */
+		struct EngineEvent
+		{
+			const char *category;	// Static string ("Error", "Warning", ...)
+			const char *message;	// Static string
+			const AudioNode *node;	// Node the event refers to (may be nullptr)
+			long value;				// Optional numeric detail (e.g. buffer index)
+		};
+
+		static constexpr size_t EVENT_RING_CAPACITY = 1024;
+
+		// Real-time safe event path
+		SpscRing<EngineEvent> m_eventRing{EVENT_RING_CAPACITY};
+		std::atomic<uint64_t> m_droppedEvents{0};
+		std::thread m_reporterThread;
+		std::atomic<bool> m_stopReporter{false};
+
+		/**
+		 * @brief Drain queued events into the status callbacks
+		 */
+		void drainEvents();
+
+		/**
+		 * @brief Reporter thread body; drains the event ring until stopped
+		 */
+		void runReporterLoop();
+
+		/**
+		 * @brief Start and stop the reporter thread
+		 */
+		void startReporter();
+		void stopReporter();
+
+		/**
+		 * @brief Run one block of the execution plan against the ASIO buffers
+		 *
+		 * Touches only memory preallocated at initialize() and raises problems
+		 * through postEvent(). Exceptions are not caught here; the caller decides
+		 * whether to guard the block.
+		 *
+		 * @param doubleBufferIndex ASIO double buffer index
+		 * @return true if hardware buffers were resolved and the block was processed
+		 */
+		bool runAsioBlock(long doubleBufferIndex);
+
+		// Callback deadline instrumentation
+		PerformanceMonitor m_performance;
+		std::thread m_statsThread;
+		std::atomic<bool> m_stopStats{false};
+
+		/**
+		 * @brief Stats thread body; publishes the counters every stats interval
+		 */
+		void runStatsPublisher();
+
+		/**
+		 * @brief Send the current counters as /engine/stats/... messages
+		 */
+		void publishPerformanceStats();
+
+		/**
+		 * @brief Start and stop the stats thread
+		 */
+		void startStatsPublisher();
+		void stopStatsPublisher();
+
 		// Process graph traversal
 		std::vector<AudioNode *> m_processOrder;
+		ExecutionPlan m_plan;		  // Compiled once by calculateProcessOrder()
+		GraphScheduler m_scheduler;	  // Runs m_plan serially or on the worker pool
 		bool calculateProcessOrder();
 
+		/**
+		 * @brief Run every step of the plan once and report failed steps
+		 *
+		 * @param doubleBufferIndex ASIO double buffer index (0 for non-ASIO operation)
+		 */
+		void runPlan(long doubleBufferIndex);
+
+		/**
+		 * @brief Run one step of the execution plan
+		 *
+		 * Delivers the step's fan-in slots, handles hardware I/O for ASIO steps,
+		 * processes the node and publishes its outputs into the fan-out slots.
+		 *
+		 * @param step Step to run
+		 * @param doubleBufferIndex ASIO double buffer index (ignored for non-ASIO steps)
+		 * @return true if the node processed successfully
+		 */
+		bool runPlanStep(const ExecutionPlan::Step &step, long doubleBufferIndex);
+
 		// Non-ASIO processing thread
 		std::thread m_processingThread;
 		std::atomic<bool> m_stopProcessingThread;
@@ -202,6 +363,22 @@ namespace AudioEngine
 		 */
 		void runFileProcessingLoop();
 
+		// Offline render result
+		mutable std::mutex m_renderMutex;
+		std::condition_variable m_renderCondVar;
+		RenderStats m_renderStats{};
+		bool m_renderFinished = false;
+
+		/**
+		 * @brief Pull the graph as fast as possible until end of stream has reached every node
+		 *
+		 * A step finishes once all of its upstream steps have finished, it has
+		 * run at least one block since, it produced no output and its node
+		 * reports isDrained(). Each finished step notifies its successors with
+		 * endOfStream().
+		 */
+		void runOfflineRender();
+
 		/**
 		 * @brief Configure ASIO automatically using driver information
 		 *
@@ -209,6 +386,20 @@ namespace AudioEngine
 		 */
 		bool autoConfigureAsio();
 
+		/**
+		 * @brief Check whether the configuration asks for a clocked audio driver
+		 *
+		 * @return true for an ASIO device name or the virtual device, never for the "none" driver
+		 */
+		bool usesAudioDriver() const;
+
+		/**
+		 * @brief Create the driver backend selected by the configuration
+		 *
+		 * @return AsioManager or VirtualAudioDriver instance
+		 */
+		std::unique_ptr<IAudioDriver> createAudioDriver() const;
+
 		/**
 		 * @brief Send a control command through the external control interface if available
 		 *
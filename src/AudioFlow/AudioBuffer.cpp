@@ -1,14 +1,17 @@
 #include "AudioBuffer.h"
+#include "AudioBufferPool.h"
 #include <algorithm>
 #include <iostream>
 #include <tbb/parallel_for.h>
 #include <tbb/blocked_range.h>
 #include <ipp.h>
 #include <cstring>
+#include <new>
 
 // Update to use local FFmpeg source headers
 extern "C"
 {
+#include <libavutil/buffer.h>
 #include <libavutil/frame.h>
 #include <libavutil/mem.h>
 #include <libavutil/samplefmt.h>
@@ -19,435 +22,320 @@ namespace AudioEngine
 {
 
 	AudioBuffer::AudioBuffer()
-		: frames(0), sampleRate(0), format(AV_SAMPLE_FMT_NONE), m_refCount(1)
+		: m_frames(0), m_sampleRate(0), m_format(AV_SAMPLE_FMT_NONE), m_planar(false),
+		  m_bytesPerSample(0), m_planeSize(0), m_slab(nullptr), m_frameRef(nullptr), m_published(false)
 	{
 		// Initialize an empty channel layout
-		av_channel_layout_default(&channelLayout, 0);
+		av_channel_layout_default(&m_channelLayout, 0);
 	}
 
 	AudioBuffer::AudioBuffer(long numFrames, double sRate, AVSampleFormat fmt, const AVChannelLayout &layout)
-		: frames(0), sampleRate(0), format(AV_SAMPLE_FMT_NONE), m_refCount(1)
+		: m_frames(0), m_sampleRate(0), m_format(AV_SAMPLE_FMT_NONE), m_planar(false),
+		  m_bytesPerSample(0), m_planeSize(0), m_slab(nullptr), m_frameRef(nullptr), m_published(false)
 	{
-		// Initialize an empty channel layout
-		av_channel_layout_default(&channelLayout, 0);
-		// Call allocate to set up the buffer
-		allocate(numFrames, sRate, fmt, layout);
+		av_channel_layout_default(&m_channelLayout, 0);
+		initMetadata(numFrames, sRate, fmt, layout);
+		allocateStorage();
 	}
 
 	AudioBuffer::~AudioBuffer()
 	{
-		free();
-		av_channel_layout_uninit(&channelLayout);
+		freeSlab(m_slab);
+		av_frame_free(&m_frameRef);
+		m_planes.clear();
+		av_channel_layout_uninit(&m_channelLayout);
 	}
 
-	bool AudioBuffer::allocate(long numFrames, double sRate, AVSampleFormat fmt, const AVChannelLayout &layout)
+	uint8_t *AudioBuffer::allocateSlab(size_t size)
 	{
-		// Protect against concurrent access during allocation
-		std::lock_guard<std::mutex> lock(m_mutex);
-
-		// Clean up any existing data first
-		free();
+		return static_cast<uint8_t *>(::operator new(size, std::align_val_t(SLAB_ALIGNMENT), std::nothrow));
+	}
 
-		if (numFrames <= 0)
+	void AudioBuffer::freeSlab(uint8_t *slab)
+	{
+		if (slab)
 		{
-			std::cerr << "Error: Cannot allocate audio buffer with " << numFrames << " frames" << std::endl;
-			return false;
+			::operator delete(slab, std::align_val_t(SLAB_ALIGNMENT));
 		}
+	}
 
-		// Copy properties
-		frames = numFrames;
-		sampleRate = sRate;
-		format = fmt;
+	size_t AudioBuffer::getPlaneStride() const
+	{
+		return (static_cast<size_t>(m_planeSize) + SLAB_ALIGNMENT - 1) & ~(SLAB_ALIGNMENT - 1);
+	}
 
-		// Copy channel layout
-		av_channel_layout_uninit(&channelLayout);
-		if (av_channel_layout_copy(&channelLayout, &layout) < 0)
+	size_t AudioBuffer::getSlabSize() const
+	{
+		size_t planes = m_planar ? static_cast<size_t>(m_channelLayout.nb_channels) : 1;
+		return getPlaneStride() * planes;
+	}
+
+	void AudioBuffer::attachSlab(uint8_t *slab)
+	{
+		size_t planes = m_planar ? static_cast<size_t>(m_channelLayout.nb_channels) : 1;
+		size_t stride = getPlaneStride();
+
+		m_planes.resize(planes);
+		for (size_t i = 0; i < planes; i++)
 		{
-			std::cerr << "Error: Failed to copy channel layout" << std::endl;
-			return false;
+			m_planes[i] = slab + i * stride;
 		}
+	}
 
-		// Calculate number of channels and buffer sizes
-		int numChannels = channelLayout.nb_channels;
-		if (numChannels <= 0)
+	void AudioBuffer::initMetadata(long numFrames, double sRate, AVSampleFormat fmt, const AVChannelLayout &layout)
+	{
+		av_channel_layout_uninit(&m_channelLayout);
+		if (av_channel_layout_copy(&m_channelLayout, &layout) < 0)
 		{
-			std::cerr << "Error: Invalid channel count: " << numChannels << std::endl;
-			free();
-			return false;
+			std::cerr << "Error: Failed to copy channel layout" << std::endl;
+			av_channel_layout_default(&m_channelLayout, 0);
+			return;
 		}
 
-		// Determine if format is planar or interleaved
-		bool isPlanar = av_sample_fmt_is_planar(format);
-		int bytesPerSample = av_get_bytes_per_sample(format);
+		m_sampleRate = sRate;
+		m_format = fmt;
+		m_planar = av_sample_fmt_is_planar(fmt) != 0;
+		m_bytesPerSample = av_get_bytes_per_sample(fmt);
+		setFrameCount(numFrames);
+	}
 
-		// Resize data and linesize vectors
-		data.resize(isPlanar ? numChannels : 1);
-		linesize.resize(isPlanar ? numChannels : 1);
+	void AudioBuffer::setFrameCount(long numFrames)
+	{
+		m_frames = numFrames;
+		m_planeSize = static_cast<int>(m_planar ? numFrames * m_bytesPerSample
+												: numFrames * m_bytesPerSample * m_channelLayout.nb_channels);
+	}
 
-		// Allocate memory for each channel or interleaved buffer
-		for (int i = 0; i < (isPlanar ? numChannels : 1); i++)
+	bool AudioBuffer::allocateStorage()
+	{
+		if (m_frames <= 0)
 		{
-			int bufferSize = isPlanar ? frames * bytesPerSample : frames * bytesPerSample * numChannels;
-
-			data[i] = static_cast<uint8_t *>(av_malloc(bufferSize));
-			if (!data[i])
-			{
-				std::cerr << "Error: Failed to allocate audio buffer memory" << std::endl;
-				free();
-				return false;
-			}
+			std::cerr << "Error: Cannot allocate audio buffer with " << m_frames << " frames" << std::endl;
+			m_frames = 0;
+			return false;
+		}
 
-			// Zero the buffer - replace std::memset with IPP
-			ippSetZero_8u(data[i], bufferSize);
+		int numChannels = m_channelLayout.nb_channels;
+		if (numChannels <= 0 || m_bytesPerSample <= 0)
+		{
+			std::cerr << "Error: Invalid channel count or sample format" << std::endl;
+			m_frames = 0;
+			return false;
+		}
 
-			// Store linesize for this plane/channel
-			linesize[i] = isPlanar ? bytesPerSample : bytesPerSample * numChannels;
+		m_slab = allocateSlab(getSlabSize());
+		if (!m_slab)
+		{
+			std::cerr << "Error: Failed to allocate audio buffer memory" << std::endl;
+			m_frames = 0;
+			return false;
 		}
 
+		// Zero the whole slab using IPP
+		ippsZero_8u(m_slab, static_cast<int>(getSlabSize()));
+		attachSlab(m_slab);
+
 		return true;
 	}
 
-	void AudioBuffer::free()
+	bool AudioBuffer::hasSameShape(const AudioBuffer &other) const
 	{
-		// Avoid locking again if called from within allocate (which already holds the lock)
-		std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
-		if (!lock.owns_lock())
-		{
-			lock.lock();
-		}
-
-		cleanupData();
-		frames = 0;
-		sampleRate = 0.0;
-		format = AV_SAMPLE_FMT_NONE;
+		return m_frames == other.m_frames &&
+			   m_format == other.m_format &&
+			   m_channelLayout.nb_channels == other.m_channelLayout.nb_channels;
 	}
 
-	void AudioBuffer::cleanupData()
+	bool AudioBuffer::prepareForWrite(std::shared_ptr<AudioBuffer> &buffer)
 	{
-		// Free all allocated data pointers using IPP
-		for (uint8_t *ptr : data)
+		if (!buffer || !buffer->isValid())
 		{
-			if (ptr)
-			{
-				ippsFree(ptr);
-			}
+			return false;
 		}
-		data.clear();
-		linesize.clear();
-	}
 
-	bool AudioBuffer::copyFrom(const AudioBuffer &other)
-	{
-		// Lock both buffers to prevent concurrent modification
-		// Use std::lock to avoid potential deadlock
-		std::unique_lock<std::mutex> lockThis(m_mutex, std::defer_lock);
-		std::unique_lock<std::mutex> lockOther(other.m_mutex, std::defer_lock);
-		std::lock(lockThis, lockOther);
-
-		if (!other.isValid())
+		// Views and wrapped memory belong to someone else (and may be mapped read-only)
+		const bool ownsStorage = !buffer->m_sourceBuffer && !buffer->m_frameRef && !buffer->m_externalOwner;
+		if (buffer.use_count() == 1 && ownsStorage)
 		{
-			return false;
+			// Nobody else can observe the old payload
+			buffer->recycle();
+			return true;
 		}
 
-		// Allocate this buffer if needed
-		if (!isValid() ||
-			frames != other.frames ||
-			format != other.format ||
-			av_channel_layout_compare(&channelLayout, &other.channelLayout) != 0)
+		// Consumers still hold the previous payload; leave it untouched
+		auto fresh = AudioBufferPool::shared().acquire(buffer->m_frames, buffer->m_sampleRate,
+													   buffer->m_format, buffer->m_channelLayout);
+		if (!fresh)
 		{
-			// We already hold the lock, so use internal allocate method
-			if (!allocateInternal(other.frames, other.sampleRate, other.format, other.channelLayout))
-			{
-				return false;
-			}
+			return false;
 		}
-		else
+
+		buffer = std::move(fresh);
+		return true;
+	}
+
+	bool AudioBuffer::copyFrom(const AudioBuffer &other)
+	{
+		if (isPublished() || !isValid() || !other.isValid() || !hasSameShape(other))
 		{
-			// If already allocated with same properties, just update sample rate
-			sampleRate = other.sampleRate;
+			return false;
 		}
 
 		// Use TBB for parallel copy of large buffers
-		if (data.size() > 1 && data.size() == other.data.size() && frames > 1000)
+		if (m_planes.size() > 1 && m_frames > 1000)
 		{
-			tbb::parallel_for(tbb::blocked_range<size_t>(0, data.size()),
+			tbb::parallel_for(tbb::blocked_range<size_t>(0, m_planes.size()),
 							  [&](const tbb::blocked_range<size_t> &r)
 							  {
 								  for (size_t i = r.begin(); i < r.end(); ++i)
 								  {
-									  if (data[i] && other.data[i])
-									  {
-										  size_t bufferSize = frames * linesize[i];
-										  // For copying - replace std::memcpy with IPP
-										  ippsCopy_8u(other.data[i], data[i], bufferSize);
-									  }
+									  ippsCopy_8u(other.m_planes[i], m_planes[i], m_planeSize);
 								  }
 							  });
 		}
 		else
 		{
-			// Original sequential copy for small buffers
-			for (size_t i = 0; i < data.size(); i++)
+			for (size_t i = 0; i < m_planes.size(); i++)
 			{
-				if (i < other.data.size() && data[i] && other.data[i])
-				{
-					size_t bufferSize = frames * linesize[i];
-					// For copying - replace std::memcpy with IPP
-					ippsCopy_8u(other.data[i], data[i], bufferSize);
-				}
+				ippsCopy_8u(other.m_planes[i], m_planes[i], m_planeSize);
 			}
 		}
 
 		return true;
 	}
 
-	// Internal version of allocate that doesn't lock (assumes lock is already held)
-	bool AudioBuffer::allocateInternal(long numFrames, double sRate, AVSampleFormat fmt, const AVChannelLayout &layout)
+	bool AudioBuffer::fromAVFrame(const AVFrame *frame)
 	{
-		// Clean up any existing data first
-		cleanupData();
-
-		if (numFrames <= 0)
-		{
-			std::cerr << "Error: Cannot allocate audio buffer with " << numFrames << " frames" << std::endl;
-			return false;
-		}
-
-		// Copy properties
-		frames = numFrames;
-		sampleRate = sRate;
-		format = fmt;
-
-		// Copy channel layout
-		av_channel_layout_uninit(&channelLayout);
-		if (av_channel_layout_copy(&channelLayout, &layout) < 0)
+		if (!frame || isPublished() || !isValid())
 		{
-			std::cerr << "Error: Failed to copy channel layout" << std::endl;
 			return false;
 		}
 
-		// Calculate number of channels and buffer sizes
-		int numChannels = channelLayout.nb_channels;
-		if (numChannels <= 0)
+		if (frame->nb_samples != m_frames ||
+			frame->format != m_format ||
+			frame->ch_layout.nb_channels != m_channelLayout.nb_channels)
 		{
-			std::cerr << "Error: Invalid channel count: " << numChannels << std::endl;
-			cleanupData();
 			return false;
 		}
 
-		// Determine if format is planar or interleaved
-		bool isPlanar = av_sample_fmt_is_planar(format);
-		int bytesPerSample = av_get_bytes_per_sample(format);
-
-		// Resize data and linesize vectors
-		data.resize(isPlanar ? numChannels : 1);
-		linesize.resize(isPlanar ? numChannels : 1);
-
-		// Use IPP for memory allocation and initialization
-		for (int i = 0; i < (isPlanar ? numChannels : 1); i++)
+		for (size_t i = 0; i < m_planes.size(); i++)
 		{
-			int bufferSize = isPlanar ? frames * bytesPerSample : frames * bytesPerSample * numChannels;
-
-			// Use IPP's aligned memory allocation
-			data[i] = ippsMalloc_8u(bufferSize);
-			if (!data[i])
+			if (!frame->extended_data[i])
 			{
-				std::cerr << "Error: Failed to allocate audio buffer memory" << std::endl;
-				cleanupData();
 				return false;
 			}
-
-			// Zero the buffer using IPP
-			ippsZero_8u(data[i], bufferSize);
-
-			linesize[i] = isPlanar ? bytesPerSample : bytesPerSample * numChannels;
+			std::memcpy(m_planes[i], frame->extended_data[i], m_planeSize);
 		}
 
 		return true;
 	}
 
-	AudioBuffer::AudioBuffer(AudioBuffer &&other) noexcept
-		: data(std::move(other.data)),
-		  linesize(std::move(other.linesize)),
-		  frames(other.frames),
-		  sampleRate(other.sampleRate),
-		  format(other.format),
-		  m_refCount(1)
-	{
-		// Copy channel layout
-		av_channel_layout_default(&channelLayout, 0);
-		av_channel_layout_copy(&channelLayout, &other.channelLayout);
-
-		// Clear the moved-from instance
-		av_channel_layout_uninit(&other.channelLayout);
-		av_channel_layout_default(&other.channelLayout, 0);
-		other.frames = 0;
-		other.sampleRate = 0.0;
-		other.format = AV_SAMPLE_FMT_NONE;
-	}
-
-	AudioBuffer &AudioBuffer::operator=(AudioBuffer &&other) noexcept
+	bool AudioBuffer::clear()
 	{
-		if (this != &other)
+		if (isPublished())
 		{
-			// Lock both buffers to prevent concurrent modification
-			std::lock_guard<std::mutex> lockThis(m_mutex);
-			std::lock_guard<std::mutex> lockOther(other.m_mutex);
-
-			// Free existing resources
-			free();
-			av_channel_layout_uninit(&channelLayout);
-
-			// Move resources from other
-			data = std::move(other.data);
-			linesize = std::move(other.linesize);
-			frames = other.frames;
-			sampleRate = other.sampleRate;
-			format = other.format;
-
-			// Keep our reference count (don't take the other buffer's count)
-
-			// Copy channel layout
-			av_channel_layout_default(&channelLayout, 0);
-			av_channel_layout_copy(&channelLayout, &other.channelLayout);
+			return false;
+		}
 
-			// Clear the moved-from instance
-			av_channel_layout_uninit(&other.channelLayout);
-			av_channel_layout_default(&other.channelLayout, 0);
-			other.frames = 0;
-			other.sampleRate = 0.0;
-			other.format = AV_SAMPLE_FMT_NONE;
+		for (uint8_t *plane : m_planes)
+		{
+			ippsZero_8u(plane, m_planeSize);
 		}
 
-		return *this;
+		return true;
 	}
 
 	uint8_t *AudioBuffer::getChannelData(int channel) const
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-
-		// Check if buffer is valid
-		if (!isValid())
+		if (!isValid() || channel < 0 || channel >= m_channelLayout.nb_channels)
 		{
 			return nullptr;
 		}
 
-		// Check if channel is in range
-		bool isPlanar = av_sample_fmt_is_planar(format);
-		if (isPlanar)
+		if (m_planar)
 		{
-			if (channel < 0 || static_cast<size_t>(channel) >= data.size())
-			{
-				return nullptr;
-			}
-			return data[channel];
-		}
-		else
-		{
-			// For interleaved, there's only one buffer
-			if (channel < 0 || channel >= channelLayout.nb_channels)
-			{
-				return nullptr;
-			}
-			return data[0] + channel * av_get_bytes_per_sample(format);
+			return m_planes[channel];
 		}
+
+		// For interleaved, there's only one buffer
+		return m_planes[0] + channel * m_bytesPerSample;
 	}
 
 	uint8_t *AudioBuffer::getPlaneData(int plane) const
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-
-		if (!isValid() || plane < 0 || static_cast<size_t>(plane) >= data.size())
+		if (plane < 0 || static_cast<size_t>(plane) >= m_planes.size())
 		{
 			return nullptr;
 		}
 
-		return data[plane];
+		return m_planes[plane];
 	}
 
 	int AudioBuffer::getPlaneSamples(int plane) const
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-
-		if (!isValid() || plane < 0 || static_cast<size_t>(plane) >= data.size())
+		if (!isValid() || plane < 0 || static_cast<size_t>(plane) >= m_planes.size())
 		{
 			return 0;
 		}
 
-		bool isPlanar = av_sample_fmt_is_planar(format);
-		if (isPlanar)
-		{
-			return frames;
-		}
-		else
-		{
-			// For interleaved format, all samples are in the first plane
-			return frames * channelLayout.nb_channels;
-		}
-	}
-
-	int AudioBuffer::getChannelCount() const
-	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-		return channelLayout.nb_channels;
-	}
-
-	int AudioBuffer::getBytesPerSample() const
-	{
-		// No need to lock for this
-		return av_get_bytes_per_sample(format);
-	}
-
-	int AudioBuffer::getPlaneCount() const
-	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-		return data.size();
+		// For interleaved format, all samples are in the first plane
+		return static_cast<int>(m_planar ? m_frames : m_frames * m_channelLayout.nb_channels);
 	}
 
-	bool AudioBuffer::isValid() const
+	void AudioBuffer::getChannelPointers(uint8_t **outPointers) const
 	{
-		// No need to lock since this is a quick check
-		return (frames > 0 && !data.empty() && data[0] != nullptr);
+		for (int ch = 0; ch < m_channelLayout.nb_channels; ++ch)
+		{
+			outPointers[ch] = getChannelData(ch);
+		}
 	}
 
-	bool AudioBuffer::isPlanar() const
+	bool AudioBuffer::describeFrame(AVFrame *frame) const
 	{
-		// No need to lock for this
-		return av_sample_fmt_is_planar(format);
-	}
+		if (!isValid())
+		{
+			return false;
+		}
 
-	AVSampleFormat AudioBuffer::getFormat() const
-	{
-		// No need to lock for this constant value
-		return format;
-	}
+		frame->nb_samples = static_cast<int>(m_frames);
+		frame->format = m_format;
+		frame->sample_rate = static_cast<int>(m_sampleRate);
+		if (av_channel_layout_copy(&frame->ch_layout, &m_channelLayout) < 0)
+		{
+			std::cerr << "Failed to copy channel layout to AVFrame" << std::endl;
+			return false;
+		}
 
-	AVChannelLayout AudioBuffer::getChannelLayout() const
-	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-		AVChannelLayout layout;
-		av_channel_layout_default(&layout, 0); // Initialize with empty layout
-		av_channel_layout_copy(&layout, &channelLayout);
-		return layout;
-	}
+		// More planes than AVFrame::data can hold go through extended_data only
+		size_t planes = m_planes.size();
+		if (planes > AV_NUM_DATA_POINTERS)
+		{
+			frame->extended_data = static_cast<uint8_t **>(av_calloc(planes, sizeof(uint8_t *)));
+			if (!frame->extended_data)
+			{
+				frame->extended_data = frame->data;
+				return false;
+			}
+		}
+		else
+		{
+			frame->extended_data = frame->data;
+		}
 
-	long AudioBuffer::getFrames() const
-	{
-		// No need to lock for this constant value
-		return frames;
-	}
+		for (size_t i = 0; i < planes; i++)
+		{
+			frame->extended_data[i] = m_planes[i];
+			if (i < AV_NUM_DATA_POINTERS)
+			{
+				frame->data[i] = m_planes[i];
+			}
+		}
+		frame->linesize[0] = m_planeSize;
 
-	double AudioBuffer::getSampleRate() const
-	{
-		// No need to lock for this constant value
-		return sampleRate;
+		return true;
 	}
 
-	// Convert this buffer to an AVFrame (useful for FFmpeg processing)
 	AVFrame *AudioBuffer::toAVFrame() const
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-
 		if (!isValid())
 		{
 			return nullptr;
@@ -460,449 +348,261 @@ namespace AudioEngine
 			return nullptr;
 		}
 
-		// Set frame parameters
-		frame->nb_samples = frames;
-		frame->format = format;
-		if (av_channel_layout_copy(&frame->ch_layout, &channelLayout) < 0)
+		// Point at our planes without taking ownership (frame->buf stays empty)
+		if (!describeFrame(frame))
 		{
-			std::cerr << "Failed to copy channel layout to AVFrame" << std::endl;
 			av_frame_free(&frame);
 			return nullptr;
 		}
 
-		frame->sample_rate = static_cast<int>(sampleRate);
+		return frame;
+	}
 
-		// Set data pointers and linesize
-		for (size_t i = 0; i < data.size(); i++)
+	namespace
+	{
+		void releaseBufferReference(void *opaque, uint8_t *)
 		{
-			frame->data[i] = data[i];
-			frame->linesize[i] = linesize[i] * frames;
+			delete static_cast<std::shared_ptr<AudioBuffer> *>(opaque);
 		}
-
-		// AVFrame needs to be cleaned up by the caller
-		frame->buf[0] = nullptr; // Indicate that we don't own the memory
-
-		return frame;
 	}
 
-	// Create a new buffer from an AVFrame
-	bool AudioBuffer::fromAVFrame(const AVFrame *frame)
+	bool AudioBuffer::attachToAVFrame(const std::shared_ptr<AudioBuffer> &buffer, AVFrame *frame)
 	{
-		if (!frame)
+		if (!buffer || !frame || !buffer->isPublished())
 		{
 			return false;
 		}
 
-		std::lock_guard<std::mutex> lock(m_mutex);
+		// A wrapped frame already has its own references; share them
+		if (buffer->m_frameRef)
+		{
+			return av_frame_ref(frame, buffer->m_frameRef) >= 0;
+		}
 
-		// Allocate buffer with frame parameters
-		if (!allocateInternal(frame->nb_samples, frame->sample_rate,
-							  static_cast<AVSampleFormat>(frame->format), frame->ch_layout))
+		if (!buffer->describeFrame(frame))
 		{
+			av_frame_unref(frame);
 			return false;
 		}
 
-		// Copy data from frame
-		for (size_t i = 0; i < data.size(); i++)
+		// One AVBufferRef per plane, each holding its own reference to the buffer;
+		// planes beyond AVFrame::buf go into extended_buf
+		const size_t planes = buffer->m_planes.size();
+		if (planes > AV_NUM_DATA_POINTERS)
 		{
-			if (frame->data[i])
+			const size_t extended = planes - AV_NUM_DATA_POINTERS;
+			frame->extended_buf = static_cast<AVBufferRef **>(av_calloc(extended, sizeof(AVBufferRef *)));
+			if (!frame->extended_buf)
 			{
-				int bytesPerSample = av_get_bytes_per_sample(format);
-				bool isPlanar = av_sample_fmt_is_planar(format);
-				int copySize = isPlanar ? frames * bytesPerSample : frames * bytesPerSample * channelLayout.nb_channels;
-
-				std::memcpy(data[i], frame->data[i], copySize);
+				av_frame_unref(frame);
+				return false;
 			}
+			frame->nb_extended_buf = static_cast<int>(extended);
 		}
 
-		return true;
-	}
-
-	// Reference counting support
-	std::shared_ptr<AudioBuffer> AudioBuffer::createReference()
-	{
-		// Increment the reference counter atomically
-		m_refCount++;
-
-		// Create a shared_ptr with a custom deleter that decrements the reference count
-		return std::shared_ptr<AudioBuffer>(this, [](AudioBuffer *buffer)
-											{
-			if (buffer->m_refCount.fetch_sub(1) == 1)
+		for (size_t i = 0; i < planes; i++)
+		{
+			auto *owner = new (std::nothrow) std::shared_ptr<AudioBuffer>(buffer);
+			AVBufferRef *ref = owner ? av_buffer_create(buffer->m_planes[i], static_cast<size_t>(buffer->m_planeSize),
+														releaseBufferReference, owner, AV_BUFFER_FLAG_READONLY)
+									 : nullptr;
+			if (!ref)
 			{
-				// Last reference is gone, delete the object
-				delete buffer;
-			} });
-	}
+				delete owner;
+				av_frame_unref(frame);
+				return false;
+			}
 
-	// Static method to create a shared buffer
-	std::shared_ptr<AudioBuffer> AudioBuffer::createBuffer(
-		long numFrames, double sRate, AVSampleFormat fmt, const AVChannelLayout &layout)
-	{
-		// Create a new buffer and return it as a shared_ptr with reference counting
-		AudioBuffer *buffer = new AudioBuffer();
-		if (!buffer->allocate(numFrames, sRate, fmt, layout))
-		{
-			delete buffer;
-			return nullptr;
+			if (i < AV_NUM_DATA_POINTERS)
+			{
+				frame->buf[i] = ref;
+			}
+			else
+			{
+				frame->extended_buf[i - AV_NUM_DATA_POINTERS] = ref;
+			}
 		}
 
-		// Return as a reference-counted shared_ptr
-		return buffer->createReference();
+		return true;
 	}
 
-	// Create a copy of this buffer
-	std::shared_ptr<AudioBuffer> AudioBuffer::clone() const
+	std::shared_ptr<AudioBuffer> AudioBuffer::wrapAVFrame(AVFrame *frame)
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-
-		if (!isValid())
+		if (!frame || frame->nb_samples <= 0 || !frame->extended_data)
 		{
 			return nullptr;
 		}
 
-		// Create a new buffer with the same parameters
-		std::shared_ptr<AudioBuffer> newBuffer = createBuffer(frames, sampleRate, format, channelLayout);
-		if (!newBuffer)
+		AVSampleFormat format = static_cast<AVSampleFormat>(frame->format);
+		if (!frame->buf[0])
 		{
-			return nullptr;
-		}
-
-		// Copy the data
-		for (size_t i = 0; i < data.size() && i < newBuffer->data.size(); i++)
-		{
-			if (data[i] && newBuffer->data[i])
+			// Not reference counted: the data may not outlive the frame, so copy it
+			auto copy = AudioBufferPool::shared().acquire(frame->nb_samples, frame->sample_rate,
+														  format, frame->ch_layout);
+			if (!copy || !copy->fromAVFrame(frame))
 			{
-				size_t bufferSize = frames * linesize[i];
-				std::memcpy(newBuffer->data[i], data[i], bufferSize);
+				return nullptr;
 			}
+			av_frame_unref(frame);
+			copy->publish();
+			return copy;
 		}
 
-		return newBuffer;
-	}
-
-	// Static creation methods
-	std::shared_ptr<AudioBuffer> AudioBuffer::create(int numSamples, AVSampleFormat format, AVChannelLayout channelLayout)
-	{
-		return std::shared_ptr<AudioBuffer>(new AudioBuffer(numSamples, format, channelLayout));
-	}
+		auto buffer = std::make_shared<AudioBuffer>();
+		buffer->initMetadata(frame->nb_samples, frame->sample_rate, format, frame->ch_layout);
+		if (buffer->m_bytesPerSample <= 0 || buffer->m_channelLayout.nb_channels <= 0)
+		{
+			return nullptr;
+		}
 
-	std::shared_ptr<AudioBuffer> AudioBuffer::createView(std::shared_ptr<AudioBuffer> sourceBuffer, int startSample, int numSamples)
-	{
-		if (!sourceBuffer || startSample < 0 || numSamples <= 0 ||
-			startSample + numSamples > sourceBuffer->getNumSamples())
+		buffer->m_frameRef = av_frame_alloc();
+		if (!buffer->m_frameRef)
 		{
 			return nullptr;
 		}
+		av_frame_move_ref(buffer->m_frameRef, frame);
+
+		size_t planes = buffer->m_planar ? static_cast<size_t>(buffer->m_channelLayout.nb_channels) : 1;
+		uint8_t **data = buffer->m_frameRef->extended_data;
+		buffer->m_planes.assign(data, data + planes);
 
-		return std::shared_ptr<AudioBuffer>(new AudioBuffer(sourceBuffer, startSample, numSamples));
+		// Holding a reference keeps other owners from writing to the frame's data
+		buffer->publish();
+		return buffer;
 	}
 
-	std::shared_ptr<AudioBuffer> AudioBuffer::createCopy(std::shared_ptr<AudioBuffer> sourceBuffer, int startSample, int numSamples)
+	std::shared_ptr<AudioBuffer> AudioBuffer::wrapExternal(long numFrames, double sRate, AVSampleFormat fmt,
+														   const AVChannelLayout &layout, const uint8_t *const *planes,
+														   std::shared_ptr<const void> owner)
 	{
-		if (!sourceBuffer || startSample < 0 || numSamples <= 0 ||
-			startSample + numSamples > sourceBuffer->getNumSamples())
+		if (!planes || !owner || numFrames <= 0)
 		{
 			return nullptr;
 		}
 
-		// Create a new buffer with the same format and layout
-		auto result = create(numSamples, sourceBuffer->getFormat(), sourceBuffer->getChannelLayout());
-		if (!result)
+		auto buffer = std::make_shared<AudioBuffer>();
+		buffer->initMetadata(numFrames, sRate, fmt, layout);
+		if (buffer->m_bytesPerSample <= 0 || buffer->m_channelLayout.nb_channels <= 0)
 		{
 			return nullptr;
 		}
 
-		// Get the source buffer's data pointers
-		const int numChannels = sourceBuffer->getNumChannels();
-		std::vector<const void *> sourceData(numChannels);
-		for (int ch = 0; ch < numChannels; ++ch)
-		{
-			sourceData[ch] = sourceBuffer->getChannelData(ch);
-			if (!sourceData[ch] && ch < numChannels)
-			{
-				return nullptr; // Source data missing
-			}
-		}
-
-		// Get the destination buffer's data pointers
-		std::vector<void *> destData(numChannels);
-		for (int ch = 0; ch < numChannels; ++ch)
+		// The planes are never written: prepareForWrite() refuses to recycle external memory
+		size_t count = buffer->m_planar ? static_cast<size_t>(buffer->m_channelLayout.nb_channels) : 1;
+		buffer->m_planes.resize(count);
+		for (size_t i = 0; i < count; i++)
 		{
-			destData[ch] = result->getChannelData(ch);
-			if (!destData[ch] && ch < numChannels)
-			{
-				return nullptr; // Dest data missing
-			}
+			buffer->m_planes[i] = const_cast<uint8_t *>(planes[i]);
 		}
+		buffer->m_externalOwner = std::move(owner);
 
-		// Copy the data
-		const int sampleSize = result->getSampleSize();
-		const bool isPlanar = av_sample_fmt_is_planar(sourceBuffer->getFormat());
-
-		if (isPlanar)
-		{
-			// For planar format, copy each channel separately
-			for (int ch = 0; ch < numChannels; ++ch)
-			{
-				const uint8_t *src = static_cast<const uint8_t *>(sourceData[ch]) + startSample * sampleSize;
-				uint8_t *dst = static_cast<uint8_t *>(destData[ch]);
-				std::memcpy(dst, src, numSamples * sampleSize);
-			}
-		}
-		else
-		{
-			// For interleaved format, copy the interleaved data
-			const uint8_t *src = static_cast<const uint8_t *>(sourceData[0]) +
-								 sourceBuffer->calculateInterleavedOffset(startSample, 0);
-			uint8_t *dst = static_cast<uint8_t *>(destData[0]);
-			std::memcpy(dst, src, numSamples * numChannels * sampleSize);
-		}
-
-		return result;
+		buffer->publish();
+		return buffer;
 	}
 
-	std::shared_ptr<AudioBuffer> AudioBuffer::createConverted(std::shared_ptr<AudioBuffer> sourceBuffer,
-															  AVSampleFormat format, AVChannelLayout channelLayout)
-	{
-		// This is a placeholder implementation
-		// In a real implementation, we would use libswresample to convert the audio data
-		// from the source format/layout to the target format/layout
-
-		// For simplicity, we'll just create a new buffer and assume the conversion is done
-		auto result = create(sourceBuffer->getNumSamples(), format, channelLayout);
-
-		// TODO: Implement actual conversion using libswresample
-
-		return result;
-	}
-
-	// Constructor for new buffer
-	AudioBuffer::AudioBuffer(int numSamples, AVSampleFormat format, AVChannelLayout channelLayout)
-		: m_numSamples(numSamples),
-		  m_format(format),
-		  m_isView(false),
-		  m_startSample(0),
-		  m_sourceBuffer(nullptr)
-	{
-		// Copy the channel layout
-		av_channel_layout_copy(&m_channelLayout, &channelLayout);
-
-		// Calculate the number of channels
-		m_numChannels = m_channelLayout.nb_channels;
-
-		// Allocate memory for the buffer
-		allocateMemory();
-	}
-
-	// Constructor for view buffer
-	AudioBuffer::AudioBuffer(std::shared_ptr<AudioBuffer> sourceBuffer, int startSample, int numSamples)
-		: m_numSamples(numSamples),
-		  m_format(sourceBuffer->getFormat()),
-		  m_isView(true),
-		  m_startSample(startSample),
-		  m_sourceBuffer(sourceBuffer)
+	std::shared_ptr<AudioBuffer> AudioBuffer::createBuffer(
+		long numFrames, double sRate, AVSampleFormat fmt, const AVChannelLayout &layout)
 	{
-		// Copy the channel layout
-		av_channel_layout_copy(&m_channelLayout, &sourceBuffer->getChannelLayout());
-
-		// Calculate the number of channels
-		m_numChannels = m_channelLayout.nb_channels;
-
-		// For a view, we don't allocate memory but point to the source buffer's data
-		const bool isPlanar = av_sample_fmt_is_planar(m_format);
-		const int sampleSize = getSampleSize();
-
-		if (isPlanar)
+		auto buffer = std::make_shared<AudioBuffer>(numFrames, sRate, fmt, layout);
+		if (!buffer->isValid())
 		{
-			// For planar format, set up pointers to each channel in the source buffer
-			m_dataPointers.resize(m_numChannels);
-			for (int ch = 0; ch < m_numChannels; ++ch)
-			{
-				uint8_t *sourceData = static_cast<uint8_t *>(const_cast<void *>(sourceBuffer->getChannelData(ch)));
-				m_dataPointers[ch] = sourceData + startSample * sampleSize;
-			}
-		}
-		else
-		{
-			// For interleaved format, set up a pointer to the interleaved data in the source buffer
-			m_dataPointers.resize(1);
-			uint8_t *sourceData = static_cast<uint8_t *>(const_cast<void *>(sourceBuffer->getChannelData(0)));
-			m_dataPointers[0] = sourceData + sourceBuffer->calculateInterleavedOffset(startSample, 0);
+			return nullptr;
 		}
+		return buffer;
 	}
 
-	AudioBuffer::~AudioBuffer()
+	std::shared_ptr<AudioBuffer> AudioBuffer::create(int numSamples, AVSampleFormat format, const AVChannelLayout &channelLayout)
 	{
-		// If this is not a view, free the allocated memory
-		if (!m_isView)
-		{
-			// Free the data
-			if (!m_data.empty())
-			{
-				m_data.clear();
-			}
-			else
-			{
-				for (auto ptr : m_dataPointers)
-				{
-					av_free(ptr);
-				}
-			}
-		}
-
-		// Uninitialize the channel layout
-		av_channel_layout_uninit(&m_channelLayout);
+		return createBuffer(numSamples, 0.0, format, channelLayout);
 	}
 
-	void AudioBuffer::allocateMemory()
+	std::shared_ptr<AudioBuffer> AudioBuffer::clone() const
 	{
-		// Check if this is a view (views don't allocate their own memory)
-		if (m_isView)
+		if (!isValid())
 		{
-			return;
+			return nullptr;
 		}
 
-		// Determine if the format is planar or interleaved
-		const bool isPlanar = av_sample_fmt_is_planar(m_format);
-		const int sampleSize = getSampleSize();
-
-		if (isPlanar)
+		auto newBuffer = AudioBufferPool::shared().acquire(m_frames, m_sampleRate, m_format, m_channelLayout);
+		if (!newBuffer)
 		{
-			// For planar format, allocate separate buffer for each channel
-			m_dataPointers.resize(m_numChannels);
-			for (int ch = 0; ch < m_numChannels; ++ch)
-			{
-				m_dataPointers[ch] = static_cast<uint8_t *>(av_malloc(m_numSamples * sampleSize));
-				if (m_dataPointers[ch])
-				{
-					std::memset(m_dataPointers[ch], 0, m_numSamples * sampleSize);
-				}
-			}
+			return nullptr;
 		}
-		else
-		{
-			// For interleaved format, allocate a single buffer
-			const size_t totalSize = m_numSamples * m_numChannels * sampleSize;
-			m_data.resize(totalSize, 0);
 
-			// Set up a pointer to the interleaved data
-			m_dataPointers.resize(1);
-			m_dataPointers[0] = m_data.data();
+		for (size_t i = 0; i < m_planes.size(); i++)
+		{
+			std::memcpy(newBuffer->m_planes[i], m_planes[i], m_planeSize);
 		}
+
+		newBuffer->publish();
+		return newBuffer;
 	}
 
-	void *AudioBuffer::getChannelData(int channel)
+	std::shared_ptr<AudioBuffer> AudioBuffer::createView(std::shared_ptr<AudioBuffer> sourceBuffer, int startSample, int numSamples)
 	{
-		if (channel < 0 || channel >= m_numChannels)
+		if (!sourceBuffer || !sourceBuffer->isValid() || startSample < 0 || numSamples <= 0 ||
+			startSample + numSamples > sourceBuffer->getNumSamples())
 		{
 			return nullptr;
 		}
 
-		const bool isPlanar = av_sample_fmt_is_planar(m_format);
+		auto view = std::make_shared<AudioBuffer>();
+		view->initMetadata(numSamples, sourceBuffer->m_sampleRate, sourceBuffer->m_format, sourceBuffer->m_channelLayout);
 
-		if (isPlanar)
+		// Planes point into the source; interleaved data advances by whole frames
+		const int frameStride = sourceBuffer->m_planar ? sourceBuffer->m_bytesPerSample
+													   : sourceBuffer->m_bytesPerSample * sourceBuffer->m_channelLayout.nb_channels;
+		view->m_planes.resize(sourceBuffer->m_planes.size());
+		for (size_t i = 0; i < sourceBuffer->m_planes.size(); i++)
 		{
-			// For planar format, return the pointer to the specific channel
-			return m_dataPointers[channel];
+			view->m_planes[i] = sourceBuffer->m_planes[i] + static_cast<size_t>(startSample) * frameStride;
 		}
-		else
+
+		if (sourceBuffer->isPublished())
 		{
-			// For interleaved format, only channel 0 is valid, and it points to the start of the interleaved data
-			if (channel == 0)
-			{
-				return m_dataPointers[0];
-			}
-			else
-			{
-				return nullptr;
-			}
+			view->publish();
 		}
+		view->m_sourceBuffer = std::move(sourceBuffer);
+		return view;
 	}
 
-	const void *AudioBuffer::getChannelData(int channel) const
+	std::shared_ptr<AudioBuffer> AudioBuffer::createCopy(std::shared_ptr<AudioBuffer> sourceBuffer, int startSample, int numSamples)
 	{
-		if (channel < 0 || channel >= m_numChannels)
+		auto view = createView(std::move(sourceBuffer), startSample, numSamples);
+		if (!view)
 		{
 			return nullptr;
 		}
 
-		const bool isPlanar = av_sample_fmt_is_planar(m_format);
-
-		if (isPlanar)
-		{
-			// For planar format, return the pointer to the specific channel
-			return m_dataPointers[channel];
-		}
-		else
+		auto result = AudioBufferPool::shared().acquire(numSamples, view->m_sampleRate, view->m_format, view->m_channelLayout);
+		if (!result)
 		{
-			// For interleaved format, only channel 0 is valid, and it points to the start of the interleaved data
-			if (channel == 0)
-			{
-				return m_dataPointers[0];
-			}
-			else
-			{
-				return nullptr;
-			}
+			return nullptr;
 		}
-	}
-
-	void AudioBuffer::getChannelPointers(void **outPointers)
-	{
-		const bool isPlanar = av_sample_fmt_is_planar(m_format);
 
-		if (isPlanar)
-		{
-			// For planar format, copy all channel pointers
-			for (int ch = 0; ch < m_numChannels; ++ch)
-			{
-				outPointers[ch] = m_dataPointers[ch];
-			}
-		}
-		else
+		for (size_t i = 0; i < view->m_planes.size(); i++)
 		{
-			// For interleaved format, set all pointers to the interleaved data
-			for (int ch = 0; ch < m_numChannels; ++ch)
-			{
-				outPointers[ch] = m_dataPointers[0] + calculateInterleavedOffset(0, ch);
-			}
+			std::memcpy(result->m_planes[i], view->m_planes[i], result->m_planeSize);
 		}
-	}
-
-	int AudioBuffer::calculateInterleavedOffset(int sample, int channel) const
-	{
-		return (sample * m_numChannels + channel) * getSampleSize();
-	}
 
-	int AudioBuffer::getSampleSize() const
-	{
-		return av_get_bytes_per_sample(m_format);
+		result->publish();
+		return result;
 	}
 
-	void AudioBuffer::clear()
+	std::shared_ptr<AudioBuffer> AudioBuffer::createConverted(std::shared_ptr<AudioBuffer> sourceBuffer,
+															  AVSampleFormat format, const AVChannelLayout &channelLayout)
 	{
-		const bool isPlanar = av_sample_fmt_is_planar(m_format);
-		const int sampleSize = getSampleSize();
-
-		if (isPlanar)
-		{
-			// For planar format, clear each channel separately
-			for (int ch = 0; ch < m_numChannels; ++ch)
-			{
-				if (m_dataPointers[ch])
-				{
-					std::memset(m_dataPointers[ch], 0, m_numSamples * sampleSize);
-				}
-			}
-		}
-		else
+		if (!sourceBuffer)
 		{
-			// For interleaved format, clear the interleaved data
-			if (m_dataPointers[0])
-			{
-				std::memset(m_dataPointers[0], 0, m_numSamples * m_numChannels * sampleSize);
-			}
+			return nullptr;
 		}
+
+		// This is a placeholder implementation
+		// In a real implementation, we would use libswresample to convert the audio data
+		// from the source format/layout to the target format/layout
+
+		// TODO: Implement actual conversion using libswresample
+		return createBuffer(sourceBuffer->m_frames, sourceBuffer->m_sampleRate, format, channelLayout);
 	}
 
 } // namespace AudioEngine
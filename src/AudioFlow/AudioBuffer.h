@@ -2,7 +2,6 @@
 
 #include <vector>
 #include <memory>
-#include <mutex>
 #include <atomic>
 
 // FFmpeg includes
@@ -12,25 +11,34 @@ extern "C"
 #include <libavutil/channel_layout.h>
 }
 
+struct AVFrame;
+
 namespace AudioEngine
 {
 
 	/**
-	 * @brief Thread-safe audio buffer with reference counting
+	 * @brief Immutable-after-publish audio buffer
+	 *
+	 * Format metadata (frame count, sample rate, sample format and channel layout)
+	 * is fixed at construction. The producer writes the payload once through the
+	 * plane/channel pointers and then calls publish(). From that point the buffer
+	 * is read-only and can be handed to any number of consumers on any thread
+	 * through std::shared_ptr; none of the accessors take a lock.
 	 *
-	 * Manages audio data with format information and reference counting
-	 * to optimize buffer transfers between AudioNodes
+	 * Ownership is tracked by std::shared_ptr alone. All planes live in one
+	 * contiguous, 64-byte aligned slab; AudioBufferPool recycles whole buffers
+	 * including their slab.
 	 */
 	class AudioBuffer
 	{
 	public:
 		/**
-		 * @brief Create a new empty audio buffer
+		 * @brief Create a new empty (invalid) audio buffer
 		 */
 		AudioBuffer();
 
 		/**
-		 * @brief Create a new audio buffer with specified parameters
+		 * @brief Create a new zeroed audio buffer with specified parameters
 		 *
 		 * @param numFrames Number of audio frames
 		 * @param sRate Sample rate in Hz
@@ -44,48 +52,78 @@ namespace AudioEngine
 		 */
 		~AudioBuffer();
 
+		// Buffers are shared by reference, never copied or moved
+		AudioBuffer(const AudioBuffer &) = delete;
+		AudioBuffer &operator=(const AudioBuffer &) = delete;
+		AudioBuffer(AudioBuffer &&) = delete;
+		AudioBuffer &operator=(AudioBuffer &&) = delete;
+
 		/**
-		 * @brief Move constructor
+		 * @brief Make the payload visible to consumers
+		 *
+		 * Release-publishes everything the producer wrote; after this call the
+		 * buffer must not be modified until recycle().
 		 */
-		AudioBuffer(AudioBuffer &&other) noexcept;
+		void publish() { m_published.store(true, std::memory_order_release); }
 
 		/**
-		 * @brief Move assignment operator
+		 * @brief Check whether the producer has published the payload
+		 *
+		 * Acquires the producer's writes when it returns true.
+		 *
+		 * @return true if published
 		 */
-		AudioBuffer &operator=(AudioBuffer &&other) noexcept;
-
-		// Disable copy constructor and copy assignment (use copyFrom method instead)
-		AudioBuffer(const AudioBuffer &) = delete;
-		AudioBuffer &operator=(const AudioBuffer &) = delete;
+		bool isPublished() const { return m_published.load(std::memory_order_acquire); }
 
 		/**
-		 * @brief Allocate memory for the buffer
+		 * @brief Return a published buffer to the writable state
 		 *
-		 * @param numFrames Number of audio frames
-		 * @param sRate Sample rate in Hz
-		 * @param fmt Sample format
-		 * @param layout Channel layout
-		 * @return true if allocation was successful
+		 * Only the producer may call this, and only when no consumer can still
+		 * read the previous payload. See prepareForWrite().
 		 */
-		bool allocate(long numFrames, double sRate, AVSampleFormat fmt, const AVChannelLayout &layout);
+		void recycle() { m_published.store(false, std::memory_order_relaxed); }
 
 		/**
-		 * @brief Free the buffer memory
+		 * @brief Get a writable buffer of the same shape
+		 *
+		 * If the caller holds the only reference to a buffer that owns its
+		 * storage, the buffer is recycled in place; otherwise a new buffer is
+		 * allocated so that consumers still holding the previous payload, and
+		 * the memory behind views and wrapped frames, are unaffected.
+		 *
+		 * @param buffer Producer's buffer reference (may be replaced)
+		 * @return true if buffer is valid and writable
 		 */
-		void free();
+		static bool prepareForWrite(std::shared_ptr<AudioBuffer> &buffer);
 
 		/**
-		 * @brief Copy data from another buffer
+		 * @brief Copy data from another buffer of the same shape
 		 *
 		 * @param other Source buffer to copy from
-		 * @return true if copy was successful
+		 * @return false if this buffer is published or the shapes differ
 		 */
 		bool copyFrom(const AudioBuffer &other);
 
+		/**
+		 * @brief Copy the payload of an AVFrame of the same shape
+		 *
+		 * @param frame AVFrame to copy from
+		 * @return false if this buffer is published or the shapes differ
+		 */
+		bool fromAVFrame(const AVFrame *frame);
+
+		/**
+		 * @brief Fill the buffer with silence
+		 *
+		 * @return false if this buffer is published
+		 */
+		bool clear();
+
 		/**
 		 * @brief Get a data pointer for a specific channel
 		 *
-		 * Handles both planar and interleaved formats correctly
+		 * Handles both planar and interleaved formats correctly. Writing through
+		 * the pointer is only allowed before publish().
 		 *
 		 * @param channel Channel index
 		 * @return Pointer to the channel data, or nullptr if channel is invalid
@@ -109,143 +147,139 @@ namespace AudioEngine
 		int getPlaneSamples(int plane) const;
 
 		/**
-		 * @brief Get the number of channels
-		 *
-		 * @return Channel count
-		 */
-		int getChannelCount() const;
-
-		/**
-		 * @brief Get the bytes per sample for this format
+		 * @brief Get the size of one plane in bytes
 		 *
-		 * @return Bytes per sample
+		 * @return Plane size in bytes
 		 */
-		int getBytesPerSample() const;
+		int getPlaneSize() const { return m_planeSize; }
 
 		/**
-		 * @brief Get the number of planes (channels for planar, 1 for interleaved)
+		 * @brief Get pointers to all channels
 		 *
-		 * @return Number of planes
-		 */
-		int getPlaneCount() const;
-
-		/**
-		 * @brief Check if the buffer is valid (allocated and has data)
+		 * For interleaved formats the pointers address the first sample of each
+		 * channel inside the interleaved data.
 		 *
-		 * @return true if buffer is valid
+		 * @param outPointers Array with at least getChannelCount() entries
 		 */
-		bool isValid() const;
+		void getChannelPointers(uint8_t **outPointers) const;
 
-		/**
-		 * @brief Check if the buffer format is planar
-		 *
-		 * @return true if format is planar, false if interleaved
-		 */
-		bool isPlanar() const;
+		int getChannelCount() const { return m_channelLayout.nb_channels; }
+		int getNumChannels() const { return m_channelLayout.nb_channels; }
+		int getBytesPerSample() const { return m_bytesPerSample; }
+		int getPlaneCount() const { return static_cast<int>(m_planes.size()); }
+		bool isPlanar() const { return m_planar; }
+		bool isValid() const { return m_frames > 0 && !m_planes.empty() && m_planes[0] != nullptr; }
+		AVSampleFormat getFormat() const { return m_format; }
+		const AVChannelLayout &getChannelLayout() const { return m_channelLayout; }
+		long getFrames() const { return m_frames; }
+		long getFrameCount() const { return m_frames; }
+		int getNumSamples() const { return static_cast<int>(m_frames); }
+		double getSampleRate() const { return m_sampleRate; }
 
 		/**
-		 * @brief Get the buffer's sample format
+		 * @brief Wrap the buffer in an AVFrame for FFmpeg processing
 		 *
-		 * @return AVSampleFormat
-		 */
-		AVSampleFormat getFormat() const;
-
-		/**
-		 * @brief Get the buffer's channel layout
+		 * The returned AVFrame points to this buffer's data without owning it;
+		 * the caller must free the frame and keep the buffer alive while it is used.
 		 *
-		 * @return Copy of the AVChannelLayout
+		 * @return AVFrame pointer, or nullptr on error
 		 */
-		AVChannelLayout getChannelLayout() const;
+		AVFrame *toAVFrame() const;
 
 		/**
-		 * @brief Get the buffer's frame count
+		 * @brief Attach a published buffer to an AVFrame without copying
 		 *
-		 * @return Number of frames
-		 */
-		long getFrames() const;
-
-		/**
-		 * @brief Get the buffer's sample rate
+		 * The frame's planes point at the buffer's data. Each plane gets its own
+		 * read-only AVBufferRef (in frame->buf, then frame->extended_buf) that
+		 * keeps the buffer alive until FFmpeg drops its last reference. A buffer
+		 * that wraps an AVFrame shares that frame's references instead. Filters
+		 * and encoders that need to write make their own copy.
 		 *
-		 * @return Sample rate in Hz
+		 * @param buffer Published buffer
+		 * @param frame Unreferenced frame to fill
+		 * @return true on success
 		 */
-		double getSampleRate() const;
+		static bool attachToAVFrame(const std::shared_ptr<AudioBuffer> &buffer, AVFrame *frame);
 
 		/**
-		 * @brief Convert buffer to an AVFrame for FFmpeg processing
+		 * @brief Wrap a reference-counted AVFrame without copying
 		 *
-		 * Note: The returned AVFrame points to this buffer's data and must be
-		 * freed by the caller (but the caller should not free the data buffers).
-		 *
-		 * @return AVFrame pointer, or nullptr on error
-		 */
-		AVFrame *toAVFrame() const;
-
-		/**
-		 * @brief Initialize buffer from an AVFrame
+		 * Takes over the frame's references (the frame is left empty) and returns
+		 * a published buffer whose planes point into the frame's data. Frames that
+		 * are not reference counted are copied into a pooled buffer instead.
 		 *
-		 * @param frame AVFrame to copy from
-		 * @return true if successful
+		 * @param frame Decoded or filtered audio frame
+		 * @return Published buffer, or nullptr on error
 		 */
-		bool fromAVFrame(const AVFrame *frame);
+		static std::shared_ptr<AudioBuffer> wrapAVFrame(AVFrame *frame);
 
 		/**
-		 * @brief Create a reference to this buffer (reference counting)
+		 * @brief Wrap read-only memory owned by another object without copying
 		 *
-		 * Use this instead of creating copies to improve efficiency.
+		 * The buffer keeps owner alive for as long as it exists and is
+		 * published on return. Used for memory-mapped files.
 		 *
-		 * @return Shared pointer to this buffer
+		 * @param numFrames Number of frames
+		 * @param sRate Sample rate
+		 * @param fmt Sample format
+		 * @param layout Channel layout
+		 * @param planes One pointer per plane (one in total for interleaved formats)
+		 * @param owner Object that keeps the memory valid
+		 * @return Published buffer, or nullptr on error
 		 */
-		std::shared_ptr<AudioBuffer> createReference();
+		static std::shared_ptr<AudioBuffer> wrapExternal(long numFrames, double sRate, AVSampleFormat fmt,
+														 const AVChannelLayout &layout, const uint8_t *const *planes,
+														 std::shared_ptr<const void> owner);
 
 		/**
 		 * @brief Create a new shared buffer
 		 *
-		 * Static factory method for creating reference-counted buffers
-		 *
 		 * @param numFrames Number of frames
 		 * @param sRate Sample rate
 		 * @param fmt Format
 		 * @param layout Channel layout
-		 * @return Shared pointer to new buffer
+		 * @return Shared pointer to new buffer, or nullptr on allocation failure
 		 */
 		static std::shared_ptr<AudioBuffer> createBuffer(
 			long numFrames, double sRate, AVSampleFormat fmt, const AVChannelLayout &layout);
 
 		/**
-		 * @brief Create a deep copy of this buffer
+		 * @brief Create a new audio buffer without sample rate information
 		 *
-		 * @return Shared pointer to the new buffer
+		 * @param numSamples Number of samples per channel
+		 * @param format Sample format (e.g., AV_SAMPLE_FMT_FLTP)
+		 * @param channelLayout Channel layout
+		 * @return Shared pointer to the new buffer, or nullptr on allocation failure
 		 */
-		std::shared_ptr<AudioBuffer> clone() const;
+		static std::shared_ptr<AudioBuffer> create(int numSamples, AVSampleFormat format, const AVChannelLayout &channelLayout);
 
 		/**
-		 * @brief Create a new audio buffer
+		 * @brief Create a published deep copy of this buffer
 		 *
-		 * @param numSamples Number of samples per channel
-		 * @param format Sample format (e.g., AV_SAMPLE_FMT_FLTP)
-		 * @param channelLayout Channel layout
-		 * @return std::shared_ptr<AudioBuffer> Shared pointer to the new buffer
+		 * @return Shared pointer to the new buffer
 		 */
-		static std::shared_ptr<AudioBuffer> create(int numSamples, AVSampleFormat format, AVChannelLayout channelLayout);
+		std::shared_ptr<AudioBuffer> clone() const;
 
 		/**
-		 * @brief Create a new audio buffer as a view into another buffer
+		 * @brief Create a read-only view into another buffer
+		 *
+		 * The view keeps the source alive and shares its memory; it is published
+		 * if the source is.
 		 *
 		 * @param sourceBuffer Source buffer to create view from
 		 * @param startSample Starting sample index
 		 * @param numSamples Number of samples to include in the view
-		 * @return std::shared_ptr<AudioBuffer> Shared pointer to the new buffer view
+		 * @return Shared pointer to the new buffer view
 		 */
 		static std::shared_ptr<AudioBuffer> createView(std::shared_ptr<AudioBuffer> sourceBuffer, int startSample, int numSamples);
 
 		/**
-		 * @brief Create a new audio buffer as a copy of another buffer
+		 * @brief Create a published copy of a range of another buffer
 		 *
 		 * @param sourceBuffer Source buffer to copy
 		 * @param startSample Starting sample index
 		 * @param numSamples Number of samples to copy
-		 * @return std::shared_ptr<AudioBuffer> Shared pointer to the new buffer copy
+		 * @return Shared pointer to the new buffer copy
 		 */
 		static std::shared_ptr<AudioBuffer> createCopy(std::shared_ptr<AudioBuffer> sourceBuffer, int startSample, int numSamples);
 
@@ -255,158 +289,98 @@ namespace AudioEngine
 		 * @param sourceBuffer Source buffer to convert
 		 * @param format Target sample format
 		 * @param channelLayout Target channel layout
-		 * @return std::shared_ptr<AudioBuffer> Shared pointer to the new buffer
+		 * @return Shared pointer to the new buffer
 		 */
 		static std::shared_ptr<AudioBuffer> createConverted(std::shared_ptr<AudioBuffer> sourceBuffer,
-															AVSampleFormat format, AVChannelLayout channelLayout);
+															AVSampleFormat format, const AVChannelLayout &channelLayout);
 
 		/**
-		 * @brief Get the number of samples per channel
-		 *
-		 * @return int Number of samples
-		 */
-		int getNumSamples() const { return m_numSamples; }
-
-		/**
-		 * @brief Get the number of channels
+		 * @brief Check if this buffer is a view of another buffer
 		 *
-		 * @return int Number of channels
+		 * @return bool True if this is a view
 		 */
-		int getNumChannels() const { return m_numChannels; }
+		bool isView() const { return m_sourceBuffer != nullptr; }
 
 		/**
-		 * @brief Get the sample format
+		 * @brief Get the source buffer if this is a view
 		 *
-		 * @return AVSampleFormat Sample format
+		 * @return Source buffer, or nullptr if this is not a view
 		 */
-		AVSampleFormat getFormat() const { return m_format; }
+		std::shared_ptr<AudioBuffer> getSourceBuffer() const { return m_sourceBuffer; }
 
-		/**
-		 * @brief Get the channel layout
-		 *
-		 * @return const AVChannelLayout& Channel layout
-		 */
-		const AVChannelLayout &getChannelLayout() const { return m_channelLayout; }
+	private:
+		friend class AudioBufferPool;
 
-		/**
-		 * @brief Get a pointer to the data for a specific channel
-		 *
-		 * For planar formats, this returns a pointer to the specific channel's data.
-		 * For interleaved formats, this returns a pointer to the start of the interleaved data
-		 * (only valid for channel 0).
-		 *
-		 * @param channel Channel index
-		 * @return void* Pointer to the channel data, or nullptr if invalid channel
-		 */
-		void *getChannelData(int channel);
+		// Alignment of the storage slab and of every plane inside it
+		static constexpr size_t SLAB_ALIGNMENT = 64;
 
 		/**
-		 * @brief Get a const pointer to the data for a specific channel
-		 *
-		 * @param channel Channel index
-		 * @return const void* Pointer to the channel data, or nullptr if invalid channel
+		 * @brief Distance between planes in a slab (plane size rounded up to SLAB_ALIGNMENT)
 		 */
-		const void *getChannelData(int channel) const;
+		size_t getPlaneStride() const;
 
 		/**
-		 * @brief Get pointers to all channel data
-		 *
-		 * @param outPointers Array to fill with pointers (must be at least getNumChannels() in size)
+		 * @brief Total slab size needed for this buffer's shape
 		 */
-		void getChannelPointers(void **outPointers);
+		size_t getSlabSize() const;
 
 		/**
-		 * @brief Clear the buffer (fill with zeros)
+		 * @brief Point the planes at an externally owned slab of getSlabSize() bytes
 		 */
-		void clear();
+		void attachSlab(uint8_t *slab);
 
 		/**
-		 * @brief Check if this buffer is a view of another buffer
-		 *
-		 * @return bool True if this is a view
+		 * @brief Allocate and free a SLAB_ALIGNMENT-aligned slab
 		 */
-		bool isView() const { return m_isView; }
+		static uint8_t *allocateSlab(size_t size);
+		static void freeSlab(uint8_t *slab);
 
 		/**
-		 * @brief Get the source buffer if this is a view
-		 *
-		 * @return std::shared_ptr<AudioBuffer> Source buffer, or nullptr if this is not a view
+		 * @brief Set up the immutable metadata fields
 		 */
-		std::shared_ptr<AudioBuffer> getSourceBuffer() const { return m_sourceBuffer; }
-
-	private:
-		// Buffer properties
-		long frames;				   // Number of frames
-		double sampleRate;			   // Sample rate in Hz
-		AVSampleFormat format;		   // Sample format
-		AVChannelLayout channelLayout; // Channel layout
-
-		// Buffer data storage
-		std::vector<uint8_t *> data; // Data pointers (one per plane)
-		std::vector<int> linesize;	 // Bytes per sample or bytes per frame (for interleaved)
-
-		// Reference counting
-		std::atomic<int> m_refCount; // Reference counter
-
-		// Thread safety
-		mutable std::mutex m_mutex; // Mutex for thread safety
-
-		// Helper methods
-		void cleanupData(); // Free data buffers
-
-		// Internal version of allocate that doesn't lock
-		bool allocateInternal(long numFrames, double sRate, AVSampleFormat fmt, const AVChannelLayout &layout);
+		void initMetadata(long numFrames, double sRate, AVSampleFormat fmt, const AVChannelLayout &layout);
 
 		/**
-		 * @brief Constructor for creating a new buffer
+		 * @brief Set the frame count and plane size, leaving the planes where they are
 		 *
-		 * @param numSamples Number of samples per channel
-		 * @param format Sample format
-		 * @param channelLayout Channel layout
+		 * Lets the pool hand out a slab sized for a larger frame count.
 		 */
-		AudioBuffer(int numSamples, AVSampleFormat format, AVChannelLayout channelLayout);
+		void setFrameCount(long numFrames);
 
 		/**
-		 * @brief Constructor for creating a view into another buffer
+		 * @brief Allocate one zeroed, aligned slab holding every plane
 		 *
-		 * @param sourceBuffer Source buffer
-		 * @param startSample Starting sample
-		 * @param numSamples Number of samples
+		 * @return true if allocation was successful
 		 */
-		AudioBuffer(std::shared_ptr<AudioBuffer> sourceBuffer, int startSample, int numSamples);
+		bool allocateStorage();
 
 		/**
-		 * @brief Allocate memory for the buffer
+		 * @brief Fill an unreferenced AVFrame's format fields and plane pointers
 		 */
-		void allocateMemory();
+		bool describeFrame(AVFrame *frame) const;
 
 		/**
-		 * @brief Calculate the offset for a channel in an interleaved buffer
-		 *
-		 * @param sample Sample index
-		 * @param channel Channel index
-		 * @return int Offset in bytes
+		 * @brief Check whether another buffer has the same frames, format and channels
 		 */
-		int calculateInterleavedOffset(int sample, int channel) const;
+		bool hasSameShape(const AudioBuffer &other) const;
 
-		/**
-		 * @brief Get the size of a single sample in bytes
-		 *
-		 * @return int Sample size in bytes
-		 */
-		int getSampleSize() const;
+		// Metadata, fixed at construction
+		long m_frames;					 // Number of frames
+		double m_sampleRate;			 // Sample rate in Hz
+		AVSampleFormat m_format;		 // Sample format
+		AVChannelLayout m_channelLayout; // Channel layout
+		bool m_planar;					 // One plane per channel
+		int m_bytesPerSample;			 // Bytes per single sample
+		int m_planeSize;				 // Bytes per plane
 
-		int m_numSamples;							 // Number of samples per channel
-		int m_numChannels;							 // Number of channels
-		AVSampleFormat m_format;					 // Sample format
-		AVChannelLayout m_channelLayout;			 // Channel layout
-		bool m_isView;								 // Whether this is a view into another buffer
-		int m_startSample;							 // Starting sample for views
-		std::shared_ptr<AudioBuffer> m_sourceBuffer; // Source buffer for views
+		// Payload
+		std::vector<uint8_t *> m_planes;			 // Data pointers (one per plane)
+		uint8_t *m_slab;							 // Owned storage (nullptr for views and pooled buffers)
+		std::shared_ptr<AudioBuffer> m_sourceBuffer; // Keeps the source of a view alive
+		AVFrame *m_frameRef;						 // Keeps the data of a wrapped AVFrame alive
+		std::shared_ptr<const void> m_externalOwner; // Keeps wrapped external memory alive
 
-		// Data storage - use either data pointers (planar) or a single buffer (interleaved)
-		std::vector<uint8_t *> m_dataPointers; // For planar formats, pointers to each channel
-		std::vector<uint8_t> m_data;		   // For interleaved formats, a single buffer
+		std::atomic<bool> m_published; // Set once the producer has finished writing
 	};
 
 } // namespace AudioEngine
@@ -0,0 +1,394 @@
+#include "AudioBufferPool.h"
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace AudioEngine
+{
+
+	namespace
+	{
+		// Room for a shared_ptr control block with an empty deleter and our allocator
+		constexpr size_t CONTROL_BLOCK_STORAGE = 128;
+
+		// Smallest size class in frames
+		constexpr long MIN_CLASS_FRAMES = 64;
+
+		/**
+		 * @brief Round a frame count up to its size class (a power of two)
+		 *
+		 * Callers that ask for arbitrary sizes (decoded frames, resampler
+		 * output) then share a few classes instead of using up the format
+		 * slots with one class per size.
+		 */
+		long classFrames(long numFrames)
+		{
+			if (numFrames <= 0 || numFrames > (std::numeric_limits<long>::max() >> 1))
+			{
+				return numFrames; // Not poolable, or too large to round
+			}
+
+			long frames = MIN_CLASS_FRAMES;
+			while (frames < numFrames)
+			{
+				frames <<= 1;
+			}
+			return frames;
+		}
+	}
+
+	/**
+	 * @brief One pooled buffer: the AudioBuffer object, its slab and its control block storage
+	 */
+	struct AudioBufferPool::Entry
+	{
+		alignas(std::max_align_t) unsigned char controlBlock[CONTROL_BLOCK_STORAGE];
+		AudioBuffer buffer;
+		uint8_t *slab = nullptr;
+		FormatClass *owner = nullptr;
+	};
+
+	/**
+	 * @brief Buffers of one (size class, format, layout) key with a bounded lock-free free list
+	 *
+	 * The free list is a bounded MPMC queue (Vyukov); its capacity covers every
+	 * entry the class can ever own, so returning an entry never fails.
+	 */
+	class AudioBufferPool::FormatClass
+	{
+	public:
+		FormatClass(long numFrames, AVSampleFormat fmt, const AVChannelLayout &channelLayout, size_t maxEntries)
+			: frames(numFrames), format(fmt), capacity(maxEntries)
+		{
+			av_channel_layout_copy(&layout, &channelLayout);
+
+			size_t size = 2;
+			while (size < maxEntries)
+			{
+				size <<= 1;
+			}
+			m_cells.reset(new Cell[size]);
+			for (size_t i = 0; i < size; i++)
+			{
+				m_cells[i].sequence.store(i, std::memory_order_relaxed);
+				m_cells[i].entry = nullptr;
+			}
+			m_mask = size - 1;
+			entries.reserve(maxEntries);
+		}
+
+		~FormatClass()
+		{
+			av_channel_layout_uninit(&layout);
+		}
+
+		bool matches(long numFrames, AVSampleFormat fmt, const AVChannelLayout &channelLayout) const
+		{
+			return frames == numFrames && format == fmt && av_channel_layout_compare(&layout, &channelLayout) == 0;
+		}
+
+		void push(Entry *entry)
+		{
+			size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+			Cell *cell;
+			while (true)
+			{
+				cell = &m_cells[pos & m_mask];
+				size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+				if (diff == 0)
+				{
+					if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else
+				{
+					pos = m_enqueuePos.load(std::memory_order_relaxed);
+				}
+			}
+
+			cell->entry = entry;
+			cell->sequence.store(pos + 1, std::memory_order_release);
+		}
+
+		bool tryPop(Entry *&entry)
+		{
+			size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+			Cell *cell;
+			while (true)
+			{
+				cell = &m_cells[pos & m_mask];
+				size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+				if (diff == 0)
+				{
+					if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else if (diff < 0)
+				{
+					return false; // Empty
+				}
+				else
+				{
+					pos = m_dequeuePos.load(std::memory_order_relaxed);
+				}
+			}
+
+			entry = cell->entry;
+			cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * @brief Number of entries on the free list (a snapshot under concurrent use)
+		 */
+		size_t idle() const
+		{
+			// Every dequeue follows its enqueue, so reading the dequeue side first never underflows
+			size_t dequeued = m_dequeuePos.load(std::memory_order_acquire);
+			size_t enqueued = m_enqueuePos.load(std::memory_order_acquire);
+			return enqueued - dequeued;
+		}
+
+		const long frames; // Slab capacity of every entry
+		const AVSampleFormat format;
+		AVChannelLayout layout;
+		const size_t capacity;
+		std::vector<std::unique_ptr<Entry>> entries; // Owned entries (guarded by the pool's grow mutex)
+
+	private:
+		struct Cell
+		{
+			std::atomic<size_t> sequence;
+			Entry *entry;
+		};
+
+		std::unique_ptr<Cell[]> m_cells;
+		size_t m_mask;
+		alignas(64) std::atomic<size_t> m_enqueuePos{0};
+		alignas(64) std::atomic<size_t> m_dequeuePos{0};
+	};
+
+	/**
+	 * @brief Allocator that places a pooled buffer's control block inside its entry
+	 *
+	 * deallocate() runs after the control block is destroyed, which is the point
+	 * where the entry is no longer referenced and can go back to its free list.
+	 */
+	template <typename T>
+	class PoolEntryAllocator
+	{
+	public:
+		using value_type = T;
+
+		explicit PoolEntryAllocator(AudioBufferPool::Entry *entry) noexcept : m_entry(entry) {}
+
+		template <typename U>
+		PoolEntryAllocator(const PoolEntryAllocator<U> &other) noexcept : m_entry(other.m_entry) {}
+
+		T *allocate(size_t n)
+		{
+			static_assert(sizeof(T) <= CONTROL_BLOCK_STORAGE, "Control block does not fit the pool entry");
+			static_assert(alignof(T) <= alignof(std::max_align_t), "Control block alignment not supported");
+			(void)n;
+			return reinterpret_cast<T *>(m_entry->controlBlock);
+		}
+
+		void deallocate(T *, size_t) noexcept
+		{
+			m_entry->owner->push(m_entry);
+		}
+
+		template <typename U>
+		bool operator==(const PoolEntryAllocator<U> &other) const noexcept { return m_entry == other.m_entry; }
+
+		template <typename U>
+		bool operator!=(const PoolEntryAllocator<U> &other) const noexcept { return m_entry != other.m_entry; }
+
+	private:
+		template <typename U>
+		friend class PoolEntryAllocator;
+
+		AudioBufferPool::Entry *m_entry;
+	};
+
+	AudioBufferPool::AudioBufferPool(size_t maxBuffersPerFormat)
+		: m_maxBuffersPerFormat(maxBuffersPerFormat > 0 ? maxBuffersPerFormat : 1)
+	{
+		for (auto &formatClass : m_classes)
+		{
+			formatClass.store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	AudioBufferPool::~AudioBufferPool()
+	{
+		size_t count = m_classCount.load(std::memory_order_acquire);
+		for (size_t i = 0; i < count; i++)
+		{
+			FormatClass *formatClass = m_classes[i].load(std::memory_order_acquire);
+			for (auto &entry : formatClass->entries)
+			{
+				AudioBuffer::freeSlab(entry->slab);
+			}
+			delete formatClass;
+		}
+	}
+
+	AudioBufferPool &AudioBufferPool::shared()
+	{
+		// Intentionally leaked: buffers held by static objects may be released after main()
+		static AudioBufferPool *pool = new AudioBufferPool();
+		return *pool;
+	}
+
+	AudioBufferPool::FormatClass *AudioBufferPool::findClass(long numFrames, AVSampleFormat format,
+															 const AVChannelLayout &layout) const
+	{
+		size_t count = m_classCount.load(std::memory_order_acquire);
+		for (size_t i = 0; i < count; i++)
+		{
+			FormatClass *formatClass = m_classes[i].load(std::memory_order_acquire);
+			if (formatClass->matches(numFrames, format, layout))
+			{
+				return formatClass;
+			}
+		}
+		return nullptr;
+	}
+
+	AudioBufferPool::FormatClass *AudioBufferPool::findOrCreateClass(long numFrames, AVSampleFormat format,
+																	 const AVChannelLayout &layout)
+	{
+		// Caller holds m_growMutex
+		if (FormatClass *existing = findClass(numFrames, format, layout))
+		{
+			return existing;
+		}
+
+		size_t count = m_classCount.load(std::memory_order_relaxed);
+		if (count >= MAX_FORMATS || numFrames <= 0 || layout.nb_channels <= 0 || av_get_bytes_per_sample(format) <= 0)
+		{
+			return nullptr;
+		}
+
+		auto *formatClass = new FormatClass(numFrames, format, layout, m_maxBuffersPerFormat);
+		m_classes[count].store(formatClass, std::memory_order_release);
+		m_classCount.store(count + 1, std::memory_order_release);
+		return formatClass;
+	}
+
+	AudioBufferPool::Entry *AudioBufferPool::createEntry(FormatClass *formatClass)
+	{
+		// Caller holds m_growMutex
+		if (formatClass->entries.size() >= formatClass->capacity)
+		{
+			return nullptr;
+		}
+
+		auto entry = std::make_unique<Entry>();
+		entry->owner = formatClass;
+		entry->buffer.initMetadata(formatClass->frames, 0.0, formatClass->format, formatClass->layout);
+
+		size_t slabSize = entry->buffer.getSlabSize();
+		entry->slab = AudioBuffer::allocateSlab(slabSize);
+		if (!entry->slab)
+		{
+			return nullptr;
+		}
+		std::memset(entry->slab, 0, slabSize);
+		entry->buffer.attachSlab(entry->slab);
+
+		Entry *raw = entry.get();
+		formatClass->entries.push_back(std::move(entry));
+		m_allocated.fetch_add(1, std::memory_order_relaxed);
+		return raw;
+	}
+
+	std::shared_ptr<AudioBuffer> AudioBufferPool::lease(Entry *entry, long numFrames, double sampleRate)
+	{
+		// The entry is exclusively ours until the control block is released
+		entry->buffer.setFrameCount(numFrames);
+		entry->buffer.m_sampleRate = sampleRate;
+		entry->buffer.recycle();
+
+		return std::shared_ptr<AudioBuffer>(&entry->buffer, [](AudioBuffer *) {},
+											PoolEntryAllocator<AudioBuffer>(entry));
+	}
+
+	std::shared_ptr<AudioBuffer> AudioBufferPool::acquire(long numFrames, double sampleRate,
+														  AVSampleFormat format, const AVChannelLayout &layout)
+	{
+		const long frames = classFrames(numFrames);
+		FormatClass *formatClass = findClass(frames, format, layout);
+		Entry *entry = nullptr;
+		if (formatClass && formatClass->tryPop(entry))
+		{
+			m_hits.fetch_add(1, std::memory_order_relaxed);
+			return lease(entry, numFrames, sampleRate);
+		}
+
+		m_misses.fetch_add(1, std::memory_order_relaxed);
+
+		{
+			std::lock_guard<std::mutex> lock(m_growMutex);
+			formatClass = findOrCreateClass(frames, format, layout);
+			if (formatClass && (entry = createEntry(formatClass)) != nullptr)
+			{
+				return lease(entry, numFrames, sampleRate);
+			}
+		}
+
+		// Pool exhausted for this key (or key not poolable): plain heap buffer
+		return AudioBuffer::createBuffer(numFrames, sampleRate, format, layout);
+	}
+
+	bool AudioBufferPool::reserve(long numFrames, double sampleRate, AVSampleFormat format,
+								  const AVChannelLayout &layout, size_t count)
+	{
+		(void)sampleRate; // Set per lease
+
+		std::lock_guard<std::mutex> lock(m_growMutex);
+		FormatClass *formatClass = findOrCreateClass(classFrames(numFrames), format, layout);
+		if (!formatClass)
+		{
+			return false;
+		}
+
+		// Buffers checked out right now do not count
+		while (formatClass->idle() < count)
+		{
+			Entry *entry = createEntry(formatClass);
+			if (!entry)
+			{
+				return false;
+			}
+			formatClass->push(entry);
+		}
+
+		return true;
+	}
+
+	AudioBufferPool::Stats AudioBufferPool::getStats() const
+	{
+		Stats stats;
+		stats.hits = m_hits.load(std::memory_order_relaxed);
+		stats.misses = m_misses.load(std::memory_order_relaxed);
+		stats.allocated = m_allocated.load(std::memory_order_relaxed);
+		stats.formats = m_classCount.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void AudioBufferPool::resetStats()
+	{
+		m_hits.store(0, std::memory_order_relaxed);
+		m_misses.store(0, std::memory_order_relaxed);
+	}
+
+} // namespace AudioEngine
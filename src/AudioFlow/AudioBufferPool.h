@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "AudioBuffer.h"
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief Recycling allocator for AudioBuffer
+	 *
+	 * Buffers are grouped by (size class, sample format, channel layout), where
+	 * the size class is the frame count rounded up to a power of two; a leased
+	 * buffer reports the frame count that was asked for. Each pooled
+	 * buffer owns one contiguous, 64-byte aligned slab for all of its planes and
+	 * inline storage for its shared_ptr control block, so handing one out does
+	 * not touch the heap. When the last shared_ptr drops, the buffer returns to
+	 * its format's lock-free free list.
+	 *
+	 * acquire() is lock-free on a hit. A miss allocates (under a mutex) a new
+	 * pooled buffer until the per-format limit is reached, then falls back to a
+	 * plain heap-allocated buffer. Call reserve() at configuration time so that
+	 * steady-state streaming only ever hits.
+	 *
+	 * The pool must outlive every buffer it has handed out.
+	 */
+	class AudioBufferPool
+	{
+	public:
+		/**
+		 * @brief Pool usage counters
+		 */
+		struct Stats
+		{
+			uint64_t hits;		// acquire() served from a free list
+			uint64_t misses;	// acquire() that had to allocate
+			uint64_t allocated; // Pooled buffers created so far
+			uint64_t formats;	// Distinct (size class, format, layout) keys
+		};
+
+		/**
+		 * @brief Create a pool
+		 *
+		 * @param maxBuffersPerFormat Upper bound of pooled buffers per key
+		 */
+		explicit AudioBufferPool(size_t maxBuffersPerFormat = 64);
+		~AudioBufferPool();
+
+		AudioBufferPool(const AudioBufferPool &) = delete;
+		AudioBufferPool &operator=(const AudioBufferPool &) = delete;
+
+		/**
+		 * @brief Get the process-wide pool
+		 *
+		 * Never destroyed, so buffers may safely outlive static destruction.
+		 *
+		 * @return Shared pool instance
+		 */
+		static AudioBufferPool &shared();
+
+		/**
+		 * @brief Get a writable buffer
+		 *
+		 * The payload of a recycled buffer is not cleared; producers are expected
+		 * to overwrite it (or call clear()).
+		 *
+		 * @param numFrames Number of frames
+		 * @param sampleRate Sample rate in Hz
+		 * @param format Sample format
+		 * @param layout Channel layout
+		 * @return Unpublished buffer, or nullptr on allocation failure
+		 */
+		std::shared_ptr<AudioBuffer> acquire(long numFrames, double sampleRate,
+											 AVSampleFormat format, const AVChannelLayout &layout);
+
+		/**
+		 * @brief Preallocate buffers for a key
+		 *
+		 * @param numFrames Number of frames
+		 * @param sampleRate Sample rate in Hz
+		 * @param format Sample format
+		 * @param layout Channel layout
+		 * @param count Number of idle buffers to make available, not counting
+		 *              buffers checked out (capped by the per-format limit)
+		 * @return true if the requested number of buffers is available
+		 */
+		bool reserve(long numFrames, double sampleRate, AVSampleFormat format,
+					 const AVChannelLayout &layout, size_t count);
+
+		/**
+		 * @brief Get the usage counters
+		 *
+		 * @return Snapshot of the counters
+		 */
+		Stats getStats() const;
+
+		/**
+		 * @brief Reset hit and miss counters
+		 */
+		void resetStats();
+
+	private:
+		struct Entry;
+		class FormatClass;
+		template <typename T>
+		friend class PoolEntryAllocator;
+
+		static constexpr size_t MAX_FORMATS = 64;
+
+		FormatClass *findClass(long numFrames, AVSampleFormat format, const AVChannelLayout &layout) const;
+		FormatClass *findOrCreateClass(long numFrames, AVSampleFormat format, const AVChannelLayout &layout);
+		Entry *createEntry(FormatClass *formatClass);
+		std::shared_ptr<AudioBuffer> lease(Entry *entry, long numFrames, double sampleRate);
+
+		size_t m_maxBuffersPerFormat;
+
+		// Format classes are only ever appended; readers scan without locking
+		std::array<std::atomic<FormatClass *>, MAX_FORMATS> m_classes;
+		std::atomic<size_t> m_classCount{0};
+		std::mutex m_growMutex; // Serializes class and entry creation
+
+		std::atomic<uint64_t> m_hits{0};
+		std::atomic<uint64_t> m_misses{0};
+		std::atomic<uint64_t> m_allocated{0};
+	};
+
+} // namespace AudioEngine
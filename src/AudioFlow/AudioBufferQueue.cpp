@@ -0,0 +1,154 @@
+#include "AudioBufferQueue.h"
+#include "AudioBuffer.h"
+
+namespace AudioEngine
+{
+
+	AudioBufferQueue::AudioBufferQueue(size_t capacity, QueuePolicy policy)
+		: m_ring(2 * (capacity > 0 ? capacity : 1)),
+		  m_capacity(capacity > 0 ? capacity : 1),
+		  m_policy(policy)
+	{
+	}
+
+	size_t AudioBufferQueue::depth() const
+	{
+		const size_t queued = m_ring.size();
+		const uint64_t pending = m_discardRequests.load(std::memory_order_acquire) -
+								 m_discardHandled.load(std::memory_order_acquire);
+		return queued > pending ? queued - static_cast<size_t>(pending) : 0;
+	}
+
+	bool AudioBufferQueue::push(const std::shared_ptr<AudioBuffer> &buffer)
+	{
+		if (depth() >= m_capacity)
+		{
+			m_overruns.fetch_add(1, std::memory_order_relaxed);
+
+			// Enqueue into the headroom and let the consumer drop the front
+			if (m_policy == QueuePolicy::DROP_OLDEST && m_ring.tryPush(buffer))
+			{
+				m_discardRequests.fetch_add(1, std::memory_order_release);
+				m_pushed.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+
+			m_droppedNewest.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		if (!m_ring.tryPush(buffer))
+		{
+			// Headroom still occupied by buffers awaiting discard
+			m_overruns.fetch_add(1, std::memory_order_relaxed);
+			m_droppedNewest.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		m_pushed.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	void AudioBufferQueue::discardRequested()
+	{
+		uint64_t handled = m_discardHandled.load(std::memory_order_relaxed);
+		const uint64_t requested = m_discardRequests.load(std::memory_order_acquire);
+		std::shared_ptr<AudioBuffer> discarded;
+		while (handled < requested && m_ring.tryPop(discarded))
+		{
+			handled++;
+			m_discarded.fetch_add(1, std::memory_order_relaxed);
+		}
+		m_discardHandled.store(handled, std::memory_order_release);
+	}
+
+	bool AudioBufferQueue::tryPop(std::shared_ptr<AudioBuffer> &buffer)
+	{
+		discardRequested();
+		if (!m_ring.tryPop(buffer))
+		{
+			return false;
+		}
+		m_popped.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	std::shared_ptr<AudioBuffer> AudioBufferQueue::pop()
+	{
+		std::shared_ptr<AudioBuffer> buffer;
+		if (!tryPop(buffer))
+		{
+			m_underruns.fetch_add(1, std::memory_order_relaxed);
+		}
+		return buffer;
+	}
+
+	void AudioBufferQueue::clear()
+	{
+		// Pop rather than reset the indices so the slots release their buffers
+		std::shared_ptr<AudioBuffer> buffer;
+		while (m_ring.tryPop(buffer))
+		{
+		}
+		m_discardHandled.store(m_discardRequests.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+	AudioBufferQueue::Stats AudioBufferQueue::getStats() const
+	{
+		Stats stats{};
+		stats.pushed = m_pushed.load(std::memory_order_relaxed);
+		stats.popped = m_popped.load(std::memory_order_relaxed);
+		stats.overruns = m_overruns.load(std::memory_order_relaxed);
+		stats.underruns = m_underruns.load(std::memory_order_relaxed);
+		stats.dropped = m_droppedNewest.load(std::memory_order_relaxed) + m_discarded.load(std::memory_order_relaxed);
+		stats.depth = depth();
+		stats.capacity = m_capacity;
+		return stats;
+	}
+
+	void AudioBufferQueue::resetStats()
+	{
+		m_pushed.store(0, std::memory_order_relaxed);
+		m_popped.store(0, std::memory_order_relaxed);
+		m_overruns.store(0, std::memory_order_relaxed);
+		m_underruns.store(0, std::memory_order_relaxed);
+		m_droppedNewest.store(0, std::memory_order_relaxed);
+		m_discarded.store(0, std::memory_order_relaxed);
+	}
+
+	bool AudioBufferQueue::parsePolicy(const std::string &name, QueuePolicy &policy)
+	{
+		if (name == "drop_newest")
+		{
+			policy = QueuePolicy::DROP_NEWEST;
+		}
+		else if (name == "drop_oldest")
+		{
+			policy = QueuePolicy::DROP_OLDEST;
+		}
+		else if (name == "silence" || name == "silence_fill")
+		{
+			policy = QueuePolicy::SILENCE_FILL;
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+
+	const char *AudioBufferQueue::getPolicyName(QueuePolicy policy)
+	{
+		switch (policy)
+		{
+		case QueuePolicy::DROP_OLDEST:
+			return "drop_oldest";
+		case QueuePolicy::SILENCE_FILL:
+			return "silence";
+		case QueuePolicy::DROP_NEWEST:
+		default:
+			return "drop_newest";
+		}
+	}
+
+} // namespace AudioEngine
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "SpscRing.h"
+
+namespace AudioEngine
+{
+
+	class AudioBuffer;
+
+	/**
+	 * @brief What a queue does when its producer or consumer outruns the other
+	 */
+	enum class QueuePolicy
+	{
+		DROP_NEWEST, // Full: the incoming buffer is discarded
+		DROP_OLDEST, // Full: the oldest queued buffer is discarded to make room
+		SILENCE_FILL // Empty: the real-time consumer substitutes silence (full behaves like DROP_NEWEST)
+	};
+
+	/**
+	 * @brief Bounded wait-free buffer handoff between a real-time and a worker thread
+	 *
+	 * Wraps an SpscRing of preallocated shared_ptr slots. Neither side ever
+	 * blocks: a full queue counts an overrun and applies the policy, an empty
+	 * pop counts an underrun and returns nullptr so the caller can apply
+	 * SILENCE_FILL.
+	 *
+	 * DROP_OLDEST cannot move the consumer's index from the producer side, so
+	 * the ring has as much headroom again as the nominal capacity: an overrun
+	 * still enqueues the new buffer and asks the consumer to discard one buffer
+	 * from the front on its next pop. Only when the headroom is exhausted too
+	 * (the consumer has stalled) is the new buffer dropped.
+	 *
+	 * Buffers discarded by DROP_OLDEST are released on the consumer thread.
+	 */
+	class AudioBufferQueue
+	{
+	public:
+		/**
+		 * @brief Queue counters
+		 */
+		struct Stats
+		{
+			uint64_t pushed;	// Buffers accepted
+			uint64_t popped;	// Buffers delivered
+			uint64_t overruns;	// Pushes that found the queue full
+			uint64_t underruns; // Pops that found the queue empty
+			uint64_t dropped;	// Buffers discarded by the policy
+			size_t depth;		// Buffers currently queued
+			size_t capacity;	// Nominal capacity
+		};
+
+		/**
+		 * @brief Create a queue
+		 *
+		 * @param capacity Nominal number of queued buffers
+		 * @param policy Overrun/underrun policy
+		 */
+		explicit AudioBufferQueue(size_t capacity, QueuePolicy policy = QueuePolicy::DROP_NEWEST);
+
+		AudioBufferQueue(const AudioBufferQueue &) = delete;
+		AudioBufferQueue &operator=(const AudioBufferQueue &) = delete;
+
+		/**
+		 * @brief Enqueue a buffer (producer thread only)
+		 *
+		 * @param buffer Buffer to enqueue
+		 * @return false if the buffer was dropped
+		 */
+		bool push(const std::shared_ptr<AudioBuffer> &buffer);
+
+		/**
+		 * @brief Dequeue the oldest buffer (consumer thread only)
+		 *
+		 * An empty queue counts as an underrun.
+		 *
+		 * @return Buffer, or nullptr if the queue is empty
+		 */
+		std::shared_ptr<AudioBuffer> pop();
+
+		/**
+		 * @brief Dequeue without counting an empty queue (consumer thread only)
+		 *
+		 * For worker threads that poll an idle queue.
+		 *
+		 * @param buffer Receives the oldest buffer
+		 * @return false if the queue is empty
+		 */
+		bool tryPop(std::shared_ptr<AudioBuffer> &buffer);
+
+		/**
+		 * @brief Check whether the queue holds its nominal capacity
+		 *
+		 * Producers that may wait (such as a file reader) use this for
+		 * back-pressure instead of overrunning.
+		 */
+		bool isFull() const { return depth() >= m_capacity; }
+
+		/**
+		 * @brief Number of queued buffers, excluding ones pending discard
+		 */
+		size_t depth() const;
+
+		/**
+		 * @brief Drop all queued buffers (consumer thread only, or while the producer is idle)
+		 */
+		void clear();
+
+		/**
+		 * @brief Get the counters
+		 */
+		Stats getStats() const;
+
+		/**
+		 * @brief Zero the counters
+		 */
+		void resetStats();
+
+		QueuePolicy getPolicy() const { return m_policy; }
+		void setPolicy(QueuePolicy policy) { m_policy = policy; }
+		size_t getCapacity() const { return m_capacity; }
+
+		/**
+		 * @brief Parse a policy name ("drop_newest", "drop_oldest" or "silence")
+		 *
+		 * @return false if the name is unknown
+		 */
+		static bool parsePolicy(const std::string &name, QueuePolicy &policy);
+
+		/**
+		 * @brief Get the name of a policy
+		 */
+		static const char *getPolicyName(QueuePolicy policy);
+
+	private:
+		/**
+		 * @brief Honor discard requests from the producer (consumer thread only)
+		 */
+		void discardRequested();
+
+		SpscRing<std::shared_ptr<AudioBuffer>> m_ring;
+		size_t m_capacity;
+		QueuePolicy m_policy;
+
+		// Producer-owned counters
+		alignas(64) std::atomic<uint64_t> m_pushed{0};
+		std::atomic<uint64_t> m_overruns{0};
+		std::atomic<uint64_t> m_droppedNewest{0};
+		std::atomic<uint64_t> m_discardRequests{0};
+
+		// Consumer-owned counters
+		alignas(64) std::atomic<uint64_t> m_popped{0};
+		std::atomic<uint64_t> m_underruns{0};
+		std::atomic<uint64_t> m_discarded{0};
+		std::atomic<uint64_t> m_discardHandled{0}; // Discard requests honored or cleared
+	};
+
+} // namespace AudioEngine
@@ -0,0 +1,213 @@
+#include "BlockConverter.h"
+#include "AudioBufferPool.h"
+#include <algorithm>
+
+extern "C"
+{
+#include <libavutil/samplefmt.h>
+}
+
+namespace AudioEngine
+{
+
+	namespace
+	{
+		// A non-null input without samples collects buffered output without flushing the filter
+		const uint8_t *const NO_INPUT[AV_NUM_DATA_POINTERS] = {};
+	}
+
+	BlockConverter::BlockConverter()
+		: m_sampleRate(0),
+		  m_blockSize(0),
+		  m_format(AV_SAMPLE_FMT_NONE),
+		  m_frameBytes(0),
+		  m_pendingFrames(0)
+	{
+		av_channel_layout_default(&m_layout, 0);
+	}
+
+	BlockConverter::~BlockConverter()
+	{
+		av_channel_layout_uninit(&m_layout);
+	}
+
+	bool BlockConverter::configure(double sampleRate, long blockSize, AVSampleFormat format,
+								   const AVChannelLayout &layout, BlockHandler handler)
+	{
+		reset();
+
+		const int bytes = av_get_bytes_per_sample(format);
+		if (sampleRate <= 0 || blockSize <= 0 || bytes <= 0 || layout.nb_channels <= 0)
+		{
+			return false;
+		}
+
+		av_channel_layout_uninit(&m_layout);
+		if (av_channel_layout_copy(&m_layout, &layout) < 0)
+		{
+			return false;
+		}
+
+		m_sampleRate = sampleRate;
+		m_blockSize = blockSize;
+		m_format = format;
+		const bool planar = av_sample_fmt_is_planar(format) != 0;
+		m_frameBytes = planar ? bytes : bytes * layout.nb_channels;
+		m_outputPlanes.assign(planar ? layout.nb_channels : 1, nullptr);
+		m_inputPlanes.assign(m_outputPlanes.size(), nullptr);
+		m_handler = std::move(handler);
+		return true;
+	}
+
+	SwrContext *BlockConverter::createResampler(const AVCodecContext *codec, std::string &error) const
+	{
+		SwrContext *swr = nullptr;
+		int ret = swr_alloc_set_opts2(&swr, &m_layout, m_format, static_cast<int>(m_sampleRate),
+									  &codec->ch_layout, codec->sample_fmt, codec->sample_rate,
+									  0, nullptr);
+		if (ret >= 0)
+		{
+			ret = swr_init(swr);
+		}
+		if (ret < 0)
+		{
+			char errbuf[AV_ERROR_MAX_STRING_SIZE];
+			av_strerror(ret, errbuf, sizeof(errbuf));
+			error = errbuf;
+			swr_free(&swr);
+			return nullptr;
+		}
+		return swr;
+	}
+
+	bool BlockConverter::startBlock()
+	{
+		if (m_block)
+		{
+			return true;
+		}
+
+		m_block = AudioBufferPool::shared().acquire(m_blockSize, m_sampleRate, m_format, m_layout);
+		if (!m_block || !m_block->isValid())
+		{
+			m_block.reset();
+			return false;
+		}
+		m_pendingFrames = 0;
+		return true;
+	}
+
+	bool BlockConverter::emitBlock()
+	{
+		auto block = std::move(m_block);
+		const long frames = m_pendingFrames;
+		m_pendingFrames = 0;
+		if (!block || frames == 0)
+		{
+			return true;
+		}
+
+		block->publish();
+		if (frames < m_blockSize)
+		{
+			return m_handler(AudioBuffer::createView(block, 0, frames));
+		}
+		return m_handler(block);
+	}
+
+	int64_t BlockConverter::convert(SwrContext *swr, const uint8_t *const *input, int samples, int64_t limit)
+	{
+		const bool draining = input == nullptr;
+		int64_t produced = 0;
+
+		while (limit < 0 || produced < limit)
+		{
+			if (!startBlock())
+			{
+				return AVERROR(ENOMEM);
+			}
+
+			int space = static_cast<int>(m_blockSize - m_pendingFrames);
+			if (limit >= 0)
+			{
+				space = static_cast<int>(std::min<int64_t>(space, limit - produced));
+			}
+			for (size_t i = 0; i < m_outputPlanes.size(); i++)
+			{
+				m_outputPlanes[i] = m_block->getPlaneData(static_cast<int>(i)) + static_cast<size_t>(m_pendingFrames) * m_frameBytes;
+			}
+
+			const int ret = swr_convert(swr, m_outputPlanes.data(), space, input, samples);
+			if (ret < 0)
+			{
+				return ret;
+			}
+			m_pendingFrames += ret;
+			produced += ret;
+
+			if (m_pendingFrames == m_blockSize && !emitBlock())
+			{
+				return AVERROR_EXIT;
+			}
+			if (ret < space)
+			{
+				break; // The resampler holds nothing more
+			}
+
+			// The input is taken; later rounds collect what did not fit
+			if (!draining)
+			{
+				input = NO_INPUT;
+				samples = 0;
+			}
+		}
+		return produced;
+	}
+
+	bool BlockConverter::append(const AudioBuffer &buffer)
+	{
+		for (size_t i = 0; i < m_inputPlanes.size(); i++)
+		{
+			m_inputPlanes[i] = buffer.getPlaneData(static_cast<int>(i));
+		}
+
+		const long frames = buffer.getFrameCount();
+		long offset = 0;
+		while (offset < frames)
+		{
+			if (!startBlock())
+			{
+				return false;
+			}
+			for (size_t i = 0; i < m_outputPlanes.size(); i++)
+			{
+				m_outputPlanes[i] = m_block->getPlaneData(static_cast<int>(i));
+			}
+
+			const long count = std::min(frames - offset, m_blockSize - m_pendingFrames);
+			av_samples_copy(m_outputPlanes.data(), m_inputPlanes.data(),
+							static_cast<int>(m_pendingFrames), static_cast<int>(offset), static_cast<int>(count),
+							m_layout.nb_channels, m_format);
+			m_pendingFrames += count;
+			offset += count;
+
+			if (m_pendingFrames == m_blockSize && !emitBlock())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool BlockConverter::flush()
+	{
+		return emitBlock();
+	}
+
+	void BlockConverter::reset()
+	{
+		m_block.reset();
+		m_pendingFrames = 0;
+	}
+
+} // namespace AudioEngine
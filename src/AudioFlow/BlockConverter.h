@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AudioBuffer.h"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libswresample/swresample.h>
+}
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief Converts decoded audio to the engine format in engine-sized blocks
+	 *
+	 * The last stage of the decoding source nodes. swr_convert() writes
+	 * straight into pooled blocks of exactly the engine buffer size, so no
+	 * scratch buffer sized for a decoded frame is ever needed; audio already
+	 * in the engine format is copied in with append(). Each completed block
+	 * is published and passed to the block handler, and flush() hands over
+	 * the last, short block of a stream.
+	 *
+	 * The SwrContext belongs to the caller, so one converter can run across
+	 * several decoders in a row (a playlist's items) with a block spanning
+	 * the splice. A converter is used by one thread at a time.
+	 */
+	class BlockConverter
+	{
+	public:
+		/**
+		 * @brief Receives each completed block
+		 *
+		 * @return false to stop the conversion in progress (e.g. on shutdown)
+		 */
+		using BlockHandler = std::function<bool(const std::shared_ptr<AudioBuffer> &)>;
+
+		BlockConverter();
+		~BlockConverter();
+
+		BlockConverter(const BlockConverter &) = delete;
+		BlockConverter &operator=(const BlockConverter &) = delete;
+
+		/**
+		 * @brief Set the engine format and the block handler
+		 *
+		 * Drops a partially filled block.
+		 *
+		 * @param sampleRate Engine sample rate in Hz
+		 * @param blockSize Frames per block
+		 * @param format Engine sample format
+		 * @param layout Engine channel layout
+		 * @param handler Receives every completed block
+		 * @return true if the format is usable
+		 */
+		bool configure(double sampleRate, long blockSize, AVSampleFormat format,
+					   const AVChannelLayout &layout, BlockHandler handler);
+
+		/**
+		 * @brief Create a resampler from a decoder's output to the engine format
+		 *
+		 * @param codec Opened decoder
+		 * @param error Set to the reason on failure
+		 * @return Initialized context owned by the caller, or nullptr
+		 */
+		SwrContext *createResampler(const AVCodecContext *codec, std::string &error) const;
+
+		/**
+		 * @brief Convert samples into blocks
+		 *
+		 * Output the current block has no room for stays in the resampler
+		 * and is collected into the next block within the same call.
+		 *
+		 * @param swr Initialized resampler to the engine format
+		 * @param input Input planes, or nullptr to drain the resampler's filter
+		 * @param samples Input samples per channel
+		 * @param limit Most frames to produce, or -1 for all; what is over the
+		 *              limit is left in the resampler
+		 * @return Frames produced, or a negative AVERROR (AVERROR_EXIT if the
+		 *         block handler declined a block)
+		 */
+		int64_t convert(SwrContext *swr, const uint8_t *const *input, int samples, int64_t limit = -1);
+
+		/**
+		 * @brief Copy audio already in the engine format into blocks
+		 *
+		 * @param buffer Audio in the engine format
+		 * @return false if a block could not be allocated or the handler declined one
+		 */
+		bool append(const AudioBuffer &buffer);
+
+		/**
+		 * @brief Hand over the partially filled block, if any
+		 *
+		 * @return false if the handler declined it
+		 */
+		bool flush();
+
+		/**
+		 * @brief Drop the partially filled block (e.g. after a seek)
+		 */
+		void reset();
+
+		/**
+		 * @brief Get the number of frames in the partially filled block
+		 */
+		long getPendingFrames() const { return m_pendingFrames; }
+
+	private:
+		double m_sampleRate;
+		long m_blockSize;
+		AVSampleFormat m_format;
+		AVChannelLayout m_layout;
+		int m_frameBytes; // Bytes per frame in one plane
+		BlockHandler m_handler;
+
+		std::shared_ptr<AudioBuffer> m_block; // Block being filled
+		long m_pendingFrames;
+		std::vector<uint8_t *> m_outputPlanes;
+		std::vector<uint8_t *> m_inputPlanes;
+
+		bool startBlock();
+		bool emitBlock();
+	};
+
+} // namespace AudioEngine
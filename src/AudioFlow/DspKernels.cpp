@@ -0,0 +1,471 @@
+#include "DspKernels.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DSP_KERNELS_X86 1
+#include <immintrin.h>
+#else
+#define DSP_KERNELS_X86 0
+#endif
+
+// GCC and Clang need per-function ISA targets; MSVC always accepts the intrinsics
+#if defined(_MSC_VER) && !defined(__clang__)
+#define DSP_KERNELS_TARGET(isa)
+#else
+#define DSP_KERNELS_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace AudioEngine
+{
+
+	namespace
+	{
+		// Filter state below this is flushed so decaying tails don't go denormal
+		constexpr float DENORMAL_LIMIT = 1e-20f;
+
+		constexpr int TAPS = DspKernels::TRUE_PEAK_TAPS;
+
+		// ITU-R BS.1770-4 annex 2 interpolator, laid out [tap][phase]
+		alignas(32) constexpr float TRUE_PEAK_COEFFICIENTS[TAPS][4] = {
+			{0.0017089843750f, -0.0291748046875f, -0.0189208984375f, -0.0083007812500f},
+			{0.0109863281250f, 0.0292968750000f, 0.0330810546875f, 0.0148925781250f},
+			{-0.0196533203125f, -0.0517578125000f, -0.0582275390625f, -0.0266113281250f},
+			{0.0332031250000f, 0.0891113281250f, 0.1015625000000f, 0.0476074218750f},
+			{-0.0594482421875f, -0.1665039062500f, -0.2003173828125f, -0.1022949218750f},
+			{0.1373291015625f, 0.4650878906250f, 0.7797851562500f, 0.9721679687500f},
+			{0.9721679687500f, 0.7797851562500f, 0.4650878906250f, 0.1373291015625f},
+			{-0.1022949218750f, -0.2003173828125f, -0.1665039062500f, -0.0594482421875f},
+			{0.0476074218750f, 0.1015625000000f, 0.0891113281250f, 0.0332031250000f},
+			{-0.0266113281250f, -0.0582275390625f, -0.0517578125000f, -0.0196533203125f},
+			{0.0148925781250f, 0.0330810546875f, 0.0292968750000f, 0.0109863281250f},
+			{-0.0083007812500f, -0.0189208984375f, -0.0291748046875f, 0.0017089843750f}};
+
+		//--------------------------------------------------------------------------
+		// Scalar
+		//--------------------------------------------------------------------------
+
+		void gainScalar(const float *in, float *out, long frames, float gain, float step)
+		{
+			for (long i = 0; i < frames; i++)
+			{
+				out[i] = in[i] * (gain + step * static_cast<float>(i));
+			}
+		}
+
+		void mixScalar(const float *in, float *out, long frames, float gain, float step)
+		{
+			for (long i = 0; i < frames; i++)
+			{
+				out[i] += in[i] * (gain + step * static_cast<float>(i));
+			}
+		}
+
+		// Channels [begin, end) of a biquad call
+		void biquadScalarRange(const float *const *in, float *const *out, int begin, int end, int channels, long frames,
+							   const BiquadCoefficients &k, float *state)
+		{
+			for (int c = begin; c < end; c++)
+			{
+				const float *x = in[c];
+				float *y = out[c];
+				float z1 = state[c];
+				float z2 = state[channels + c];
+				for (long i = 0; i < frames; i++)
+				{
+					const float input = x[i];
+					const float output = k.b0 * input + z1;
+					z1 = k.b1 * input - k.a1 * output + z2;
+					z2 = k.b2 * input - k.a2 * output;
+					y[i] = output;
+				}
+				state[c] = std::fabs(z1) < DENORMAL_LIMIT ? 0.0f : z1;
+				state[channels + c] = std::fabs(z2) < DENORMAL_LIMIT ? 0.0f : z2;
+			}
+		}
+
+		void biquadScalar(const float *const *in, float *const *out, int channels, long frames,
+						  const BiquadCoefficients &k, float *state)
+		{
+			biquadScalarRange(in, out, 0, channels, channels, frames, k, state);
+		}
+
+		void levelScalar(const float *in, long frames, float &peak, float &sumSquares)
+		{
+			float maximum = 0.0f;
+			float sum = 0.0f;
+			for (long i = 0; i < frames; i++)
+			{
+				maximum = std::max(maximum, std::fabs(in[i]));
+				sum += in[i] * in[i];
+			}
+			peak = maximum;
+			sumSquares = sum;
+		}
+
+		float truePeakScalar(const float *in, long frames)
+		{
+			float maximum = 0.0f;
+			for (long i = 0; i < frames; i++)
+			{
+				for (int phase = 0; phase < 4; phase++)
+				{
+					float sum = 0.0f;
+					for (int k = 0; k < TAPS; k++)
+					{
+						sum += TRUE_PEAK_COEFFICIENTS[k][phase] * in[i - k];
+					}
+					maximum = std::max(maximum, std::fabs(sum));
+				}
+			}
+			return maximum;
+		}
+
+#if DSP_KERNELS_X86
+
+		//--------------------------------------------------------------------------
+		// SSE2
+		//--------------------------------------------------------------------------
+
+		DSP_KERNELS_TARGET("sse2")
+		void gainSse2(const float *in, float *out, long frames, float gain, float step)
+		{
+			__m128 g = _mm_add_ps(_mm_set1_ps(gain), _mm_mul_ps(_mm_set1_ps(step), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)));
+			const __m128 advance = _mm_set1_ps(step * 4.0f);
+
+			long i = 0;
+			for (; i + 4 <= frames; i += 4)
+			{
+				_mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(in + i), g));
+				g = _mm_add_ps(g, advance);
+			}
+			for (; i < frames; i++)
+			{
+				out[i] = in[i] * (gain + step * static_cast<float>(i));
+			}
+		}
+
+		DSP_KERNELS_TARGET("sse2")
+		void mixSse2(const float *in, float *out, long frames, float gain, float step)
+		{
+			__m128 g = _mm_add_ps(_mm_set1_ps(gain), _mm_mul_ps(_mm_set1_ps(step), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)));
+			const __m128 advance = _mm_set1_ps(step * 4.0f);
+
+			long i = 0;
+			for (; i + 4 <= frames; i += 4)
+			{
+				_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(in + i), g)));
+				g = _mm_add_ps(g, advance);
+			}
+			for (; i < frames; i++)
+			{
+				out[i] += in[i] * (gain + step * static_cast<float>(i));
+			}
+		}
+
+		DSP_KERNELS_TARGET("sse2")
+		inline __m128 flushDenormals4(__m128 v)
+		{
+			const __m128 magnitude = _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+			return _mm_and_ps(v, _mm_cmpge_ps(magnitude, _mm_set1_ps(DENORMAL_LIMIT)));
+		}
+
+		// Channels [begin, end), four at a time; the rest go scalar
+		DSP_KERNELS_TARGET("sse2")
+		void biquadSse2Range(const float *const *in, float *const *out, int begin, int end, int channels, long frames,
+							 const BiquadCoefficients &k, float *state)
+		{
+			const __m128 b0 = _mm_set1_ps(k.b0);
+			const __m128 b1 = _mm_set1_ps(k.b1);
+			const __m128 b2 = _mm_set1_ps(k.b2);
+			const __m128 a1 = _mm_set1_ps(k.a1);
+			const __m128 a2 = _mm_set1_ps(k.a2);
+
+			int c = begin;
+			for (; c + 4 <= end; c += 4)
+			{
+				const float *x0 = in[c], *x1 = in[c + 1], *x2 = in[c + 2], *x3 = in[c + 3];
+				float *y0 = out[c], *y1 = out[c + 1], *y2 = out[c + 2], *y3 = out[c + 3];
+				__m128 z1 = _mm_loadu_ps(state + c);
+				__m128 z2 = _mm_loadu_ps(state + channels + c);
+				alignas(16) float lanes[4];
+
+				for (long i = 0; i < frames; i++)
+				{
+					const __m128 x = _mm_setr_ps(x0[i], x1[i], x2[i], x3[i]);
+					const __m128 y = _mm_add_ps(_mm_mul_ps(b0, x), z1);
+					z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), z2);
+					z2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+
+					_mm_store_ps(lanes, y);
+					y0[i] = lanes[0];
+					y1[i] = lanes[1];
+					y2[i] = lanes[2];
+					y3[i] = lanes[3];
+				}
+
+				_mm_storeu_ps(state + c, flushDenormals4(z1));
+				_mm_storeu_ps(state + channels + c, flushDenormals4(z2));
+			}
+
+			biquadScalarRange(in, out, c, end, channels, frames, k, state);
+		}
+
+		void biquadSse2(const float *const *in, float *const *out, int channels, long frames,
+						const BiquadCoefficients &k, float *state)
+		{
+			biquadSse2Range(in, out, 0, channels, channels, frames, k, state);
+		}
+
+		DSP_KERNELS_TARGET("sse2")
+		float horizontalMax4(__m128 v)
+		{
+			v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+			v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtss_f32(v);
+		}
+
+		DSP_KERNELS_TARGET("sse2")
+		void levelSse2(const float *in, long frames, float &peak, float &sumSquares)
+		{
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+			__m128 maximum = _mm_setzero_ps();
+			__m128 sum = _mm_setzero_ps();
+
+			long i = 0;
+			for (; i + 4 <= frames; i += 4)
+			{
+				const __m128 x = _mm_loadu_ps(in + i);
+				maximum = _mm_max_ps(maximum, _mm_andnot_ps(signMask, x));
+				sum = _mm_add_ps(sum, _mm_mul_ps(x, x));
+			}
+
+			alignas(16) float lanes[4];
+			_mm_store_ps(lanes, sum);
+			float total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+			float scalarMax = horizontalMax4(maximum);
+			for (; i < frames; i++)
+			{
+				scalarMax = std::max(scalarMax, std::fabs(in[i]));
+				total += in[i] * in[i];
+			}
+			peak = scalarMax;
+			sumSquares = total;
+		}
+
+		// All four phases of one output sample per vector
+		DSP_KERNELS_TARGET("sse2")
+		float truePeakSse2(const float *in, long frames)
+		{
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+			__m128 maximum = _mm_setzero_ps();
+			for (long i = 0; i < frames; i++)
+			{
+				__m128 sum = _mm_setzero_ps();
+				for (int k = 0; k < TAPS; k++)
+				{
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(TRUE_PEAK_COEFFICIENTS[k]), _mm_set1_ps(in[i - k])));
+				}
+				maximum = _mm_max_ps(maximum, _mm_andnot_ps(signMask, sum));
+			}
+			return horizontalMax4(maximum);
+		}
+
+		//--------------------------------------------------------------------------
+		// AVX2
+		//--------------------------------------------------------------------------
+
+		DSP_KERNELS_TARGET("avx2")
+		void gainAvx2(const float *in, float *out, long frames, float gain, float step)
+		{
+			__m256 g = _mm256_add_ps(_mm256_set1_ps(gain),
+									 _mm256_mul_ps(_mm256_set1_ps(step),
+												   _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f)));
+			const __m256 advance = _mm256_set1_ps(step * 8.0f);
+
+			long i = 0;
+			for (; i + 8 <= frames; i += 8)
+			{
+				_mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(in + i), g));
+				g = _mm256_add_ps(g, advance);
+			}
+			for (; i < frames; i++)
+			{
+				out[i] = in[i] * (gain + step * static_cast<float>(i));
+			}
+		}
+
+		DSP_KERNELS_TARGET("avx2")
+		void mixAvx2(const float *in, float *out, long frames, float gain, float step)
+		{
+			__m256 g = _mm256_add_ps(_mm256_set1_ps(gain),
+									 _mm256_mul_ps(_mm256_set1_ps(step),
+												   _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f)));
+			const __m256 advance = _mm256_set1_ps(step * 8.0f);
+
+			long i = 0;
+			for (; i + 8 <= frames; i += 8)
+			{
+				_mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_mul_ps(_mm256_loadu_ps(in + i), g)));
+				g = _mm256_add_ps(g, advance);
+			}
+			for (; i < frames; i++)
+			{
+				out[i] += in[i] * (gain + step * static_cast<float>(i));
+			}
+		}
+
+		DSP_KERNELS_TARGET("avx2")
+		inline __m256 flushDenormals8(__m256 v)
+		{
+			const __m256 magnitude = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+			return _mm256_and_ps(v, _mm256_cmp_ps(magnitude, _mm256_set1_ps(DENORMAL_LIMIT), _CMP_GE_OQ));
+		}
+
+		DSP_KERNELS_TARGET("avx2")
+		void biquadAvx2(const float *const *in, float *const *out, int channels, long frames,
+						const BiquadCoefficients &k, float *state)
+		{
+			const __m256 b0 = _mm256_set1_ps(k.b0);
+			const __m256 b1 = _mm256_set1_ps(k.b1);
+			const __m256 b2 = _mm256_set1_ps(k.b2);
+			const __m256 a1 = _mm256_set1_ps(k.a1);
+			const __m256 a2 = _mm256_set1_ps(k.a2);
+
+			int c = 0;
+			for (; c + 8 <= channels; c += 8)
+			{
+				const float *const *x = in + c;
+				float *const *y = out + c;
+				__m256 z1 = _mm256_loadu_ps(state + c);
+				__m256 z2 = _mm256_loadu_ps(state + channels + c);
+				alignas(32) float lanes[8];
+
+				for (long i = 0; i < frames; i++)
+				{
+					const __m256 input = _mm256_setr_ps(x[0][i], x[1][i], x[2][i], x[3][i],
+														x[4][i], x[5][i], x[6][i], x[7][i]);
+					const __m256 output = _mm256_add_ps(_mm256_mul_ps(b0, input), z1);
+					z1 = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(b1, input), _mm256_mul_ps(a1, output)), z2);
+					z2 = _mm256_sub_ps(_mm256_mul_ps(b2, input), _mm256_mul_ps(a2, output));
+
+					_mm256_store_ps(lanes, output);
+					for (int lane = 0; lane < 8; lane++)
+					{
+						y[lane][i] = lanes[lane];
+					}
+				}
+
+				_mm256_storeu_ps(state + c, flushDenormals8(z1));
+				_mm256_storeu_ps(state + channels + c, flushDenormals8(z2));
+			}
+
+			biquadSse2Range(in, out, c, channels, channels, frames, k, state);
+		}
+
+		DSP_KERNELS_TARGET("avx2")
+		void levelAvx2(const float *in, long frames, float &peak, float &sumSquares)
+		{
+			const __m256 signMask = _mm256_set1_ps(-0.0f);
+			__m256 maximum = _mm256_setzero_ps();
+			__m256 sum = _mm256_setzero_ps();
+
+			long i = 0;
+			for (; i + 8 <= frames; i += 8)
+			{
+				const __m256 x = _mm256_loadu_ps(in + i);
+				maximum = _mm256_max_ps(maximum, _mm256_andnot_ps(signMask, x));
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(x, x));
+			}
+
+			const __m128 maximum4 = _mm_max_ps(_mm256_castps256_ps128(maximum), _mm256_extractf128_ps(maximum, 1));
+			const __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+			alignas(16) float lanes[4];
+			_mm_store_ps(lanes, sum4);
+			float total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+			float scalarMax = horizontalMax4(maximum4);
+			for (; i < frames; i++)
+			{
+				scalarMax = std::max(scalarMax, std::fabs(in[i]));
+				total += in[i] * in[i];
+			}
+			peak = scalarMax;
+			sumSquares = total;
+		}
+
+		// Two output samples (eight phases) per vector
+		DSP_KERNELS_TARGET("avx2")
+		float truePeakAvx2(const float *in, long frames)
+		{
+			const __m256 signMask = _mm256_set1_ps(-0.0f);
+			__m256 maximum = _mm256_setzero_ps();
+
+			long i = 0;
+			for (; i + 2 <= frames; i += 2)
+			{
+				__m256 sum = _mm256_setzero_ps();
+				for (int k = 0; k < TAPS; k++)
+				{
+					const __m128 coefficients = _mm_load_ps(TRUE_PEAK_COEFFICIENTS[k]);
+					const __m256 taps = _mm256_insertf128_ps(_mm256_castps128_ps256(coefficients), coefficients, 1);
+					const __m256 samples = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(in[i - k])),
+																_mm_set1_ps(in[i + 1 - k]), 1);
+					sum = _mm256_add_ps(sum, _mm256_mul_ps(taps, samples));
+				}
+				maximum = _mm256_max_ps(maximum, _mm256_andnot_ps(signMask, sum));
+			}
+
+			float result = horizontalMax4(_mm_max_ps(_mm256_castps256_ps128(maximum), _mm256_extractf128_ps(maximum, 1)));
+			if (i < frames)
+			{
+				result = std::max(result, truePeakSse2(in + i, frames - i));
+			}
+			return result;
+		}
+
+#endif // DSP_KERNELS_X86
+
+	} // namespace
+
+	DspKernels DspKernels::select(SimdLevel level)
+	{
+		DspKernels kernels;
+		kernels.gain = gainScalar;
+		kernels.mix = mixScalar;
+		kernels.biquad = biquadScalar;
+		kernels.level = levelScalar;
+		kernels.truePeak = truePeakScalar;
+		kernels.simdLevel = SimdLevel::SCALAR;
+
+#if DSP_KERNELS_X86
+		const SimdLevel available = std::min(level, SampleConverter::detectSimdLevel());
+		if (available == SimdLevel::AVX2)
+		{
+			kernels.gain = gainAvx2;
+			kernels.mix = mixAvx2;
+			kernels.biquad = biquadAvx2;
+			kernels.level = levelAvx2;
+			kernels.truePeak = truePeakAvx2;
+			kernels.simdLevel = SimdLevel::AVX2;
+		}
+		else if (available == SimdLevel::SSE2)
+		{
+			kernels.gain = gainSse2;
+			kernels.mix = mixSse2;
+			kernels.biquad = biquadSse2;
+			kernels.level = levelSse2;
+			kernels.truePeak = truePeakSse2;
+			kernels.simdLevel = SimdLevel::SSE2;
+		}
+#endif
+
+		return kernels;
+	}
+
+	const DspKernels &DspKernels::get()
+	{
+		static const DspKernels kernels = select(SampleConverter::detectSimdLevel());
+		return kernels;
+	}
+
+} // namespace AudioEngine
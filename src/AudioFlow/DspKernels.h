@@ -0,0 +1,97 @@
+#pragma once
+
+#include "SampleConverter.h"
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief Normalized biquad coefficients (a0 = 1)
+	 */
+	struct BiquadCoefficients
+	{
+		float b0 = 1.0f;
+		float b1 = 0.0f;
+		float b2 = 0.0f;
+		float a1 = 0.0f;
+		float a2 = 0.0f;
+	};
+
+	/**
+	 * @brief Vectorized planar float loops for the native DSP nodes
+	 *
+	 * A table of kernels picked once for the SIMD level of the CPU (see
+	 * SampleConverter::detectSimdLevel()). Kernels never allocate and accept
+	 * unaligned pointers; in and out may be the same plane.
+	 *
+	 * Gains are linear ramps: sample i is scaled by gain + i * step, so a
+	 * parameter change spreads over one block instead of stepping. A constant
+	 * gain is step = 0.
+	 *
+	 * The biquad recursion can't be vectorized along time, so the SIMD kernels
+	 * run 4 (SSE2) or 8 (AVX2) channels side by side in direct form II
+	 * transposed. The remaining channels take the scalar path. State holds z1
+	 * for every channel followed by z2 for every channel; denormal state is
+	 * flushed to zero at the end of each call.
+	 *
+	 * True peak uses the 4x polyphase interpolator of ITU-R BS.1770-4 annex 2
+	 * (12 taps per phase); the SIMD kernels compute all four phases of a
+	 * sample in one vector.
+	 */
+	struct DspKernels
+	{
+		using SimdLevel = SampleConverter::SimdLevel;
+
+		/**
+		 * @brief out[i] = in[i] * (gain + i * step)
+		 */
+		using GainKernel = void (*)(const float *in, float *out, long frames, float gain, float step);
+
+		/**
+		 * @brief out[i] += in[i] * (gain + i * step)
+		 */
+		using MixKernel = void (*)(const float *in, float *out, long frames, float gain, float step);
+
+		/**
+		 * @brief Filter every channel with the same coefficients
+		 *
+		 * @param state 2 * channels floats: all z1, then all z2
+		 */
+		using BiquadKernel = void (*)(const float *const *in, float *const *out, int channels, long frames,
+									  const BiquadCoefficients &coefficients, float *state);
+
+		/**
+		 * @brief Block peak (max |x|) and sum of squares
+		 */
+		using LevelKernel = void (*)(const float *in, long frames, float &peak, float &sumSquares);
+
+		/**
+		 * @brief Peak of the 4x oversampled signal
+		 *
+		 * @param in First sample of the block; in[-(TRUE_PEAK_TAPS - 1)] to in[-1]
+		 *           must hold the samples that preceded it
+		 * @return Largest interpolated magnitude
+		 */
+		using TruePeakKernel = float (*)(const float *in, long frames);
+
+		static constexpr int TRUE_PEAK_TAPS = 12;
+
+		GainKernel gain = nullptr;
+		MixKernel mix = nullptr;
+		BiquadKernel biquad = nullptr;
+		LevelKernel level = nullptr;
+		TruePeakKernel truePeak = nullptr;
+		SimdLevel simdLevel = SimdLevel::SCALAR;
+
+		/**
+		 * @brief Get the kernels for the best SIMD level of this CPU
+		 */
+		static const DspKernels &get();
+
+		/**
+		 * @brief Get the kernels for a SIMD level (capped at what the CPU supports)
+		 */
+		static DspKernels select(SimdLevel level);
+	};
+
+} // namespace AudioEngine
@@ -0,0 +1,238 @@
+#include "ExecutionPlan.h"
+#include "AudioNode.h"
+#include "AsioSourceNode.h"
+#include "AsioSinkNode.h"
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+namespace AudioEngine
+{
+
+	bool ExecutionPlan::build(const std::vector<std::shared_ptr<AudioNode>> &nodes,
+							  const std::vector<Connection> &connections,
+							  ExecutionPlan &plan,
+							  std::string &error)
+	{
+		ExecutionPlan result;
+		const size_t nodeCount = nodes.size();
+
+		// Map node pointers to their index in the engine's node list
+		std::unordered_map<const AudioNode *, size_t> indexOf;
+		indexOf.reserve(nodeCount);
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			indexOf[nodes[i].get()] = i;
+		}
+
+		// Build adjacency and assign one slot per distinct (source, pad) pair
+		std::vector<std::vector<size_t>> successors(nodeCount);
+		std::vector<size_t> inDegree(nodeCount, 0);
+		std::vector<std::vector<Edge>> fanIn(nodeCount);
+		std::vector<std::vector<Edge>> fanOut(nodeCount);
+		std::map<std::pair<size_t, int>, uint32_t> slotOf;
+
+		for (const auto &connection : connections)
+		{
+			auto sourceIt = indexOf.find(connection.getSourceNode());
+			auto sinkIt = indexOf.find(connection.getSinkNode());
+			if (sourceIt == indexOf.end() || sinkIt == indexOf.end())
+			{
+				error = "Connection references a node that is not part of the graph";
+				return false;
+			}
+
+			size_t source = sourceIt->second;
+			size_t sink = sinkIt->second;
+			if (source == sink)
+			{
+				error = "Node '" + nodes[source]->getName() + "' is connected to itself";
+				return false;
+			}
+
+			auto key = std::make_pair(source, connection.getSourcePad());
+			auto slotIt = slotOf.find(key);
+			uint32_t slot;
+			if (slotIt == slotOf.end())
+			{
+				slot = static_cast<uint32_t>(slotOf.size());
+				slotOf.emplace(key, slot);
+				fanOut[source].push_back({slot, connection.getSourcePad()});
+			}
+			else
+			{
+				slot = slotIt->second;
+			}
+
+			fanIn[sink].push_back({slot, connection.getSinkPad()});
+			successors[source].push_back(sink);
+			inDegree[sink]++;
+		}
+
+		// Kahn's algorithm; always pick the lowest ready index for a stable order
+		std::vector<size_t> ready;
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			if (inDegree[i] == 0)
+			{
+				ready.push_back(i);
+			}
+		}
+
+		std::vector<size_t> order;
+		order.reserve(nodeCount);
+		while (!ready.empty())
+		{
+			auto lowest = std::min_element(ready.begin(), ready.end());
+			size_t current = *lowest;
+			ready.erase(lowest);
+			order.push_back(current);
+
+			for (size_t next : successors[current])
+			{
+				if (--inDegree[next] == 0)
+				{
+					ready.push_back(next);
+				}
+			}
+		}
+
+		if (order.size() != nodeCount)
+		{
+			error = "Cycle detected in node graph involving:";
+			for (size_t i = 0; i < nodeCount; i++)
+			{
+				if (inDegree[i] > 0)
+				{
+					error += " " + nodes[i]->getName();
+				}
+			}
+			return false;
+		}
+
+		// Flatten into the immutable tables
+		result.m_steps.reserve(nodeCount);
+		result.m_order.reserve(nodeCount);
+		for (size_t index : order)
+		{
+			AudioNode *node = nodes[index].get();
+
+			Step step;
+			step.node = node;
+			step.kind = StepKind::GENERIC;
+			step.successorBegin = step.successorEnd = 0;
+			step.dependencyCount = 0;
+			step.inputBegin = static_cast<uint32_t>(result.m_inputEdges.size());
+			result.m_inputEdges.insert(result.m_inputEdges.end(), fanIn[index].begin(), fanIn[index].end());
+			step.inputEnd = static_cast<uint32_t>(result.m_inputEdges.size());
+			step.outputBegin = static_cast<uint32_t>(result.m_outputEdges.size());
+			result.m_outputEdges.insert(result.m_outputEdges.end(), fanOut[index].begin(), fanOut[index].end());
+			step.outputEnd = static_cast<uint32_t>(result.m_outputEdges.size());
+
+			// Resolve hardware nodes once so the callback never inspects types
+			if (node->getType() == AudioNode::NodeType::ASIO_SOURCE)
+			{
+				step.kind = StepKind::ASIO_SOURCE;
+				const auto &indices = static_cast<AsioSourceNode *>(node)->getAsioChannelIndices();
+				result.m_asioInputChannels.insert(result.m_asioInputChannels.end(), indices.begin(), indices.end());
+			}
+			else if (node->getType() == AudioNode::NodeType::ASIO_SINK)
+			{
+				step.kind = StepKind::ASIO_SINK;
+				const auto &indices = static_cast<AsioSinkNode *>(node)->getAsioChannelIndices();
+				result.m_asioOutputChannels.insert(result.m_asioOutputChannels.end(), indices.begin(), indices.end());
+			}
+
+			result.m_steps.push_back(step);
+			result.m_order.push_back(node);
+		}
+
+		// Dependency tables in step positions, one entry per distinct edge
+		std::vector<uint32_t> positionOf(nodeCount);
+		for (size_t position = 0; position < order.size(); position++)
+		{
+			positionOf[order[position]] = static_cast<uint32_t>(position);
+		}
+
+		for (size_t position = 0; position < order.size(); position++)
+		{
+			std::vector<uint32_t> targets;
+			for (size_t next : successors[order[position]])
+			{
+				targets.push_back(positionOf[next]);
+			}
+			std::sort(targets.begin(), targets.end());
+			targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+
+			Step &step = result.m_steps[position];
+			step.successorBegin = static_cast<uint32_t>(result.m_successors.size());
+			result.m_successors.insert(result.m_successors.end(), targets.begin(), targets.end());
+			step.successorEnd = static_cast<uint32_t>(result.m_successors.size());
+
+			for (uint32_t target : targets)
+			{
+				result.m_steps[target].dependencyCount++;
+			}
+		}
+
+		result.m_slots.resize(slotOf.size());
+
+		// Size the hardware pointer scratch so the callback never grows it
+		auto tableSize = [](const std::vector<long> &channels) -> size_t
+		{
+			long maxChannel = -1;
+			for (long channel : channels)
+			{
+				maxChannel = std::max(maxChannel, channel);
+			}
+			return static_cast<size_t>(maxChannel + 1);
+		};
+
+		result.m_asioInputPointers.assign(result.m_asioInputChannels.size(), nullptr);
+		result.m_asioOutputPointers.assign(result.m_asioOutputChannels.size(), nullptr);
+		result.m_asioInputTable.assign(tableSize(result.m_asioInputChannels), nullptr);
+		result.m_asioOutputTable.assign(tableSize(result.m_asioOutputChannels), nullptr);
+
+		plan = std::move(result);
+		return true;
+	}
+
+	void ExecutionPlan::clear()
+	{
+		m_steps.clear();
+		m_order.clear();
+		m_inputEdges.clear();
+		m_outputEdges.clear();
+		m_successors.clear();
+		m_slots.clear();
+		m_asioInputChannels.clear();
+		m_asioOutputChannels.clear();
+		m_asioInputPointers.clear();
+		m_asioOutputPointers.clear();
+		m_asioInputTable.clear();
+		m_asioOutputTable.clear();
+	}
+
+	void ExecutionPlan::resetSlots()
+	{
+		for (auto &buffer : m_slots)
+		{
+			buffer.reset();
+		}
+	}
+
+	void ExecutionPlan::scatterAsioPointers()
+	{
+		for (size_t i = 0; i < m_asioInputChannels.size(); i++)
+		{
+			m_asioInputTable[m_asioInputChannels[i]] = m_asioInputPointers[i];
+		}
+
+		for (size_t i = 0; i < m_asioOutputChannels.size(); i++)
+		{
+			m_asioOutputTable[m_asioOutputChannels[i]] = m_asioOutputPointers[i];
+		}
+	}
+
+} // namespace AudioEngine
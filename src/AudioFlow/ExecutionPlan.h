@@ -0,0 +1,189 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+namespace AudioEngine
+{
+
+	// Forward declarations
+	class AudioBuffer;
+	class AudioNode;
+	class Connection;
+
+	/**
+	 * @brief Precompiled, flat execution plan for a node graph
+	 *
+	 * The plan is compiled once from the engine's nodes and connections using a
+	 * topological sort. It stores the node order, one buffer slot per distinct
+	 * (source node, output pad) pair and fan-in/fan-out tables, so the audio
+	 * callback can walk the graph without casts, type scans or allocations.
+	 *
+	 * The structure is immutable after build(); only the slot contents change
+	 * from block to block.
+	 */
+	class ExecutionPlan
+	{
+	public:
+		/**
+		 * @brief What the engine has to do for a step besides calling process()
+		 */
+		enum class StepKind
+		{
+			GENERIC,	 // Plain process() call
+			ASIO_SOURCE, // Receives hardware input before process()
+			ASIO_SINK	 // Delivers hardware output after process()
+		};
+
+		/**
+		 * @brief A pad-to-slot binding
+		 *
+		 * For fan-in tables, the slot is read and delivered to the node's input pad.
+		 * For fan-out tables, the node's output pad is published into the slot.
+		 */
+		struct Edge
+		{
+			uint32_t slot; // Index into the slot table
+			int pad;	   // Node pad index
+		};
+
+		/**
+		 * @brief One entry of the execution order
+		 */
+		struct Step
+		{
+			AudioNode *node;		 // Node to run
+			StepKind kind;			 // Resolved once at build time
+			uint32_t inputBegin;	 // Fan-in range in getInputEdges()
+			uint32_t inputEnd;
+			uint32_t outputBegin;	 // Fan-out range in getOutputEdges()
+			uint32_t outputEnd;
+			uint32_t successorBegin; // Dependent steps in getSuccessors()
+			uint32_t successorEnd;
+			uint32_t dependencyCount; // Number of distinct upstream steps
+		};
+
+		ExecutionPlan() = default;
+
+		/**
+		 * @brief Compile a graph into an execution plan
+		 *
+		 * Uses Kahn's algorithm; ties are broken by the original node order so the
+		 * result is deterministic. Fails if the graph contains a cycle or a
+		 * connection references a node that is not part of the graph.
+		 *
+		 * @param nodes Nodes owned by the engine
+		 * @param connections Connections between the nodes
+		 * @param plan Plan to fill (replaced on success)
+		 * @param error Filled with a description of the problem on failure
+		 * @return true if the plan was built
+		 */
+		static bool build(const std::vector<std::shared_ptr<AudioNode>> &nodes,
+						  const std::vector<Connection> &connections,
+						  ExecutionPlan &plan,
+						  std::string &error);
+
+		/**
+		 * @brief Release all nodes, tables and slot contents
+		 */
+		void clear();
+
+		/**
+		 * @brief Check if the plan has been built
+		 *
+		 * @return true if the plan contains at least one step
+		 */
+		bool isValid() const { return !m_steps.empty(); }
+
+		const std::vector<Step> &getSteps() const { return m_steps; }
+		const std::vector<Edge> &getInputEdges() const { return m_inputEdges; }
+		const std::vector<Edge> &getOutputEdges() const { return m_outputEdges; }
+
+		/**
+		 * @brief Get the dependency table
+		 *
+		 * Holds step indices (positions in getSteps()); each step's downstream
+		 * steps are listed once in its successor range.
+		 *
+		 * @return Flattened successor table
+		 */
+		const std::vector<uint32_t> &getSuccessors() const { return m_successors; }
+
+		/**
+		 * @brief Get the node order (same order as getSteps())
+		 *
+		 * @return Topologically sorted nodes
+		 */
+		const std::vector<AudioNode *> &getOrder() const { return m_order; }
+
+		/**
+		 * @brief Get the buffer currently published into a slot
+		 *
+		 * @param slot Slot index
+		 * @return Buffer reference (may be empty)
+		 */
+		std::shared_ptr<AudioBuffer> &slot(uint32_t slot) { return m_slots[slot]; }
+
+		/**
+		 * @brief Get the number of buffer slots
+		 *
+		 * @return Slot count
+		 */
+		size_t getSlotCount() const { return m_slots.size(); }
+
+		/**
+		 * @brief Drop all buffer references held in the slots
+		 *
+		 * Does not change the size of the slot table.
+		 */
+		void resetSlots();
+
+		/**
+		 * @brief ASIO channels used by source steps, in request order
+		 */
+		const std::vector<long> &getAsioInputChannels() const { return m_asioInputChannels; }
+
+		/**
+		 * @brief ASIO channels used by sink steps, in request order
+		 */
+		const std::vector<long> &getAsioOutputChannels() const { return m_asioOutputChannels; }
+
+		/**
+		 * @brief Scratch for the driver's per-block buffer pointers (sized at build time)
+		 */
+		std::vector<void *> &getAsioInputPointers() { return m_asioInputPointers; }
+		std::vector<void *> &getAsioOutputPointers() { return m_asioOutputPointers; }
+
+		/**
+		 * @brief Channel-indexed pointer tables handed to the ASIO nodes
+		 *
+		 * Entry N holds the buffer of hardware channel N for the current block.
+		 */
+		std::vector<void *> &getAsioInputTable() { return m_asioInputTable; }
+		std::vector<void *> &getAsioOutputTable() { return m_asioOutputTable; }
+
+		/**
+		 * @brief Scatter the per-block pointer scratch into the channel tables
+		 */
+		void scatterAsioPointers();
+
+	private:
+		std::vector<Step> m_steps;
+		std::vector<AudioNode *> m_order;
+		std::vector<Edge> m_inputEdges;
+		std::vector<Edge> m_outputEdges;
+		std::vector<uint32_t> m_successors;
+		std::vector<std::shared_ptr<AudioBuffer>> m_slots;
+
+		// Hardware channel tables, resolved once
+		std::vector<long> m_asioInputChannels;
+		std::vector<long> m_asioOutputChannels;
+		std::vector<void *> m_asioInputPointers;
+		std::vector<void *> m_asioOutputPointers;
+		std::vector<void *> m_asioInputTable;
+		std::vector<void *> m_asioOutputTable;
+	};
+
+} // namespace AudioEngine
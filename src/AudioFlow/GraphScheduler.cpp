@@ -0,0 +1,323 @@
+#include "GraphScheduler.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#include <immintrin.h>
+#define GRAPH_SCHEDULER_PAUSE() _mm_pause()
+#else
+#define GRAPH_SCHEDULER_PAUSE() std::this_thread::yield()
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace AudioEngine
+{
+
+	namespace
+	{
+		// Spin iterations before an idle pool thread goes to sleep (tens of microseconds)
+		constexpr int IDLE_SPIN_LIMIT = 20000;
+	}
+
+	void GraphScheduler::WorkQueue::push(uint32_t step)
+	{
+		while (lock.test_and_set(std::memory_order_acquire))
+		{
+			GRAPH_SCHEDULER_PAUSE();
+		}
+		items[bottom & mask] = step;
+		bottom++;
+		lock.clear(std::memory_order_release);
+	}
+
+	bool GraphScheduler::WorkQueue::pop(uint32_t &step)
+	{
+		while (lock.test_and_set(std::memory_order_acquire))
+		{
+			GRAPH_SCHEDULER_PAUSE();
+		}
+		bool found = bottom != top;
+		if (found)
+		{
+			bottom--;
+			step = items[bottom & mask];
+		}
+		lock.clear(std::memory_order_release);
+		return found;
+	}
+
+	bool GraphScheduler::WorkQueue::steal(uint32_t &step)
+	{
+		while (lock.test_and_set(std::memory_order_acquire))
+		{
+			GRAPH_SCHEDULER_PAUSE();
+		}
+		bool found = bottom != top;
+		if (found)
+		{
+			step = items[top & mask];
+			top++;
+		}
+		lock.clear(std::memory_order_release);
+		return found;
+	}
+
+	GraphScheduler::~GraphScheduler()
+	{
+		stop();
+	}
+
+	bool GraphScheduler::start(const ExecutionPlan &plan, size_t threadCount, size_t minParallelSteps, StepFunction stepFunction)
+	{
+		stop();
+
+		m_plan = &plan;
+		m_stepFunction = std::move(stepFunction);
+
+		const auto &steps = plan.getSteps();
+		const size_t stepCount = steps.size();
+
+		m_failed.assign(stepCount, 0);
+		m_roots.clear();
+		for (size_t i = 0; i < stepCount; i++)
+		{
+			if (steps[i].dependencyCount == 0)
+			{
+				m_roots.push_back(static_cast<uint32_t>(i));
+			}
+		}
+
+		if (threadCount == 0)
+		{
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		// No point in more threads than steps; small graphs stay serial
+		threadCount = std::min(threadCount, stepCount);
+		if (threadCount <= 1 || stepCount < minParallelSteps)
+		{
+			return true;
+		}
+
+		m_remaining.reset(new std::atomic<uint32_t>[stepCount]);
+		for (size_t i = 0; i < stepCount; i++)
+		{
+			m_remaining[i].store(0, std::memory_order_relaxed);
+		}
+
+		size_t capacity = 2;
+		while (capacity < stepCount)
+		{
+			capacity <<= 1;
+		}
+
+		m_queueCount = threadCount;
+		m_queues.reset(new WorkQueue[threadCount]);
+		for (size_t i = 0; i < threadCount; i++)
+		{
+			m_queues[i].items.assign(capacity, 0);
+			m_queues[i].mask = capacity - 1;
+		}
+
+		m_stop.store(false);
+		m_pending.store(0);
+
+		// Thread 0 is the caller of runBlock(); pin the pool to the remaining cores
+		const size_t cpuCount = std::max(1u, std::thread::hardware_concurrency());
+		for (size_t i = 1; i < threadCount; i++)
+		{
+			m_threads.emplace_back(&GraphScheduler::workerMain, this, i);
+			pinThread(m_threads.back(), i % cpuCount);
+		}
+
+		return true;
+	}
+
+	void GraphScheduler::stop()
+	{
+		if (!m_threads.empty())
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_wakeMutex);
+				m_stop.store(true);
+			}
+			m_wakeCondition.notify_all();
+
+			for (auto &thread : m_threads)
+			{
+				if (thread.joinable())
+				{
+					thread.join();
+				}
+			}
+			m_threads.clear();
+		}
+
+		m_queues.reset();
+		m_queueCount = 0;
+		m_remaining.reset();
+	}
+
+	size_t GraphScheduler::runBlock(long context)
+	{
+		if (!m_plan)
+		{
+			return 0;
+		}
+
+		const auto &steps = m_plan->getSteps();
+
+		// Serial fallback: plan order already satisfies every dependency
+		if (m_threads.empty())
+		{
+			size_t failures = 0;
+			for (size_t i = 0; i < steps.size(); i++)
+			{
+				bool ok = m_stepFunction(steps[i], context);
+				m_failed[i] = ok ? 0 : 1;
+				failures += ok ? 0 : 1;
+			}
+			return failures;
+		}
+
+		m_context = context;
+		m_failCount.store(0, std::memory_order_relaxed);
+		for (size_t i = 0; i < steps.size(); i++)
+		{
+			m_remaining[i].store(steps[i].dependencyCount, std::memory_order_relaxed);
+			m_failed[i] = 0;
+		}
+		m_pending.store(steps.size(), std::memory_order_relaxed);
+
+		for (uint32_t root : m_roots)
+		{
+			m_queues[0].push(root);
+		}
+
+		// Publish the block; only take the wake mutex if someone is asleep
+		m_epoch.fetch_add(1, std::memory_order_seq_cst);
+		if (m_sleepers.load(std::memory_order_seq_cst) > 0)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_wakeMutex);
+			}
+			m_wakeCondition.notify_all();
+		}
+
+		// Participate until the barrier is reached
+		workLoop(0);
+
+		return m_failCount.load(std::memory_order_acquire);
+	}
+
+	void GraphScheduler::workerMain(size_t self)
+	{
+		uint64_t seen = m_epoch.load(std::memory_order_acquire);
+
+		while (true)
+		{
+			uint64_t epoch;
+			int spins = 0;
+			while ((epoch = m_epoch.load(std::memory_order_acquire)) == seen && !m_stop.load(std::memory_order_acquire))
+			{
+				if (++spins < IDLE_SPIN_LIMIT)
+				{
+					GRAPH_SCHEDULER_PAUSE();
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(m_wakeMutex);
+				m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+				m_wakeCondition.wait(lock, [&]
+									 { return m_epoch.load(std::memory_order_seq_cst) != seen || m_stop.load(); });
+				m_sleepers.fetch_sub(1, std::memory_order_seq_cst);
+				spins = 0;
+			}
+
+			if (m_stop.load(std::memory_order_acquire))
+			{
+				return;
+			}
+
+			seen = epoch;
+			workLoop(self);
+		}
+	}
+
+	void GraphScheduler::workLoop(size_t self)
+	{
+		while (m_pending.load(std::memory_order_acquire) > 0)
+		{
+			uint32_t step;
+			if (m_queues[self].pop(step) || trySteal(self, step))
+			{
+				execute(self, step);
+			}
+			else
+			{
+				GRAPH_SCHEDULER_PAUSE();
+			}
+		}
+	}
+
+	void GraphScheduler::execute(size_t self, uint32_t stepIndex)
+	{
+		const auto &step = m_plan->getSteps()[stepIndex];
+
+		if (!m_stepFunction(step, m_context))
+		{
+			m_failed[stepIndex] = 1;
+			m_failCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// Release successors; the last dependency to finish schedules the step locally
+		const auto &successors = m_plan->getSuccessors();
+		for (uint32_t i = step.successorBegin; i < step.successorEnd; i++)
+		{
+			uint32_t next = successors[i];
+			if (m_remaining[next].fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				m_queues[self].push(next);
+			}
+		}
+
+		// Count the step as done only after its successors have been queued
+		m_pending.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	bool GraphScheduler::trySteal(size_t self, uint32_t &step)
+	{
+		for (size_t offset = 1; offset < m_queueCount; offset++)
+		{
+			if (m_queues[(self + offset) % m_queueCount].steal(step))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void GraphScheduler::pinThread(std::thread &thread, size_t cpu)
+	{
+#ifdef _WIN32
+		SetThreadAffinityMask(thread.native_handle(), static_cast<DWORD_PTR>(1) << cpu);
+#elif defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+		(void)thread;
+		(void)cpu;
+#endif
+	}
+
+} // namespace AudioEngine
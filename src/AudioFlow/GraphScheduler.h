@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ExecutionPlan.h"
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief Dependency-counting parallel executor for an ExecutionPlan
+	 *
+	 * Each block, every step starts with its static dependency count. Steps whose
+	 * count reaches zero are pushed onto the deque of the thread that completed
+	 * the last dependency; idle threads steal from the other end of their peers'
+	 * deques. The calling thread participates as worker 0 and returns once every
+	 * step of the block has run (the per-block barrier).
+	 *
+	 * All per-block state is allocated in start(). Pool threads spin briefly
+	 * between blocks and then sleep; the caller only touches the wake mutex when
+	 * a worker is actually asleep.
+	 *
+	 * Graphs smaller than the configured threshold, or a pool size of one,
+	 * run serially on the calling thread in plan order.
+	 */
+	class GraphScheduler
+	{
+	public:
+		/**
+		 * @brief Function that runs one step
+		 *
+		 * The second argument is the per-block context passed to runBlock()
+		 * (the ASIO double buffer index).
+		 */
+		using StepFunction = std::function<bool(const ExecutionPlan::Step &, long)>;
+
+		GraphScheduler() = default;
+		~GraphScheduler();
+
+		GraphScheduler(const GraphScheduler &) = delete;
+		GraphScheduler &operator=(const GraphScheduler &) = delete;
+
+		/**
+		 * @brief Prepare the scheduler for a plan and start the worker pool
+		 *
+		 * The plan must stay unchanged until stop() is called.
+		 *
+		 * @param plan Plan to execute
+		 * @param threadCount Total threads including the caller (0 = hardware concurrency)
+		 * @param minParallelSteps Plans with fewer steps run serially
+		 * @param stepFunction Function that runs one step
+		 * @return true if the scheduler is ready (serially or in parallel)
+		 */
+		bool start(const ExecutionPlan &plan, size_t threadCount, size_t minParallelSteps, StepFunction stepFunction);
+
+		/**
+		 * @brief Stop and join the worker pool
+		 */
+		void stop();
+
+		/**
+		 * @brief Run every step of the plan once and wait for completion
+		 *
+		 * Must only be called from one thread at a time.
+		 *
+		 * @param context Value forwarded to the step function
+		 * @return Number of steps that reported failure
+		 */
+		size_t runBlock(long context);
+
+		/**
+		 * @brief Check whether a step failed in the last block
+		 *
+		 * @param stepIndex Position in the plan's step list
+		 * @return true if the step function returned false
+		 */
+		bool stepFailed(size_t stepIndex) const { return m_failed[stepIndex] != 0; }
+
+		/**
+		 * @brief Check whether blocks are executed by the worker pool
+		 *
+		 * @return true if running in parallel
+		 */
+		bool isParallel() const { return !m_threads.empty(); }
+
+		/**
+		 * @brief Get the number of threads taking part in a block
+		 *
+		 * @return Pool size including the calling thread (1 when serial)
+		 */
+		size_t getThreadCount() const { return m_threads.size() + 1; }
+
+	private:
+		/**
+		 * @brief Per-thread deque of ready steps
+		 *
+		 * The owner pushes and pops at the bottom, thieves take from the top. A
+		 * spinlock guards the few instructions of each operation; the ring has room
+		 * for every step so it never grows.
+		 */
+		struct alignas(64) WorkQueue
+		{
+			std::atomic_flag lock = ATOMIC_FLAG_INIT;
+			std::vector<uint32_t> items;
+			size_t mask = 0;
+			size_t top = 0;
+			size_t bottom = 0;
+
+			void push(uint32_t step);
+			bool pop(uint32_t &step);
+			bool steal(uint32_t &step);
+		};
+
+		void workerMain(size_t self);
+		void workLoop(size_t self);
+		void execute(size_t self, uint32_t step);
+		bool trySteal(size_t self, uint32_t &step);
+		static void pinThread(std::thread &thread, size_t cpu);
+
+		const ExecutionPlan *m_plan = nullptr;
+		StepFunction m_stepFunction;
+		std::vector<uint32_t> m_roots;
+		std::vector<uint8_t> m_failed;
+		std::unique_ptr<std::atomic<uint32_t>[]> m_remaining;
+		std::unique_ptr<WorkQueue[]> m_queues;
+		size_t m_queueCount = 0;
+		std::vector<std::thread> m_threads;
+
+		long m_context = 0;
+		std::atomic<size_t> m_failCount{0};
+		alignas(64) std::atomic<size_t> m_pending{0};
+		alignas(64) std::atomic<uint64_t> m_epoch{0};
+		std::atomic<bool> m_stop{false};
+
+		// Sleep/wake for idle pool threads
+		std::atomic<int> m_sleepers{0};
+		std::mutex m_wakeMutex;
+		std::condition_variable m_wakeCondition;
+	};
+
+} // namespace AudioEngine
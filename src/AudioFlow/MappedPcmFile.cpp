@@ -0,0 +1,492 @@
+#include "MappedPcmFile.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AudioEngine
+{
+
+	namespace
+	{
+		// Header fields are little-endian, like the hosts we run on
+		uint16_t read16(const uint8_t *p)
+		{
+			uint16_t value;
+			std::memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		uint32_t read32(const uint8_t *p)
+		{
+			uint32_t value;
+			std::memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		uint64_t read64(const uint8_t *p)
+		{
+			uint64_t value;
+			std::memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		// Sony Wave64 chunk GUIDs
+		const uint8_t W64_RIFF[16] = {'r', 'i', 'f', 'f', 0x2E, 0x91, 0xCF, 0x11, 0xA5, 0xD6, 0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00};
+		const uint8_t W64_WAVE[16] = {'w', 'a', 'v', 'e', 0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+		const uint8_t W64_FMT[16] = {'f', 'm', 't', ' ', 0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+		const uint8_t W64_DATA[16] = {'d', 'a', 't', 'a', 0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+
+		constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+		constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+		constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+		size_t queryPageSize()
+		{
+#ifdef _WIN32
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			return info.dwPageSize;
+#else
+			return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+		}
+
+		size_t pageSize()
+		{
+			static const size_t size = queryPageSize();
+			return size;
+		}
+	}
+
+	MappedPcmFile::~MappedPcmFile()
+	{
+		close();
+	}
+
+	bool MappedPcmFile::open(const std::string &path, std::string &error)
+	{
+		close();
+		if (!map(path, error))
+		{
+			return false;
+		}
+
+		const bool parsed = m_size >= 40 && std::memcmp(m_data, W64_RIFF, 16) == 0 ? parseWave64(error) : parseRiff(error);
+		if (!parsed)
+		{
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void MappedPcmFile::close()
+	{
+#ifdef _WIN32
+		if (m_data)
+		{
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mappingHandle)
+		{
+			CloseHandle(m_mappingHandle);
+			m_mappingHandle = nullptr;
+		}
+		if (m_fileHandle)
+		{
+			CloseHandle(m_fileHandle);
+			m_fileHandle = nullptr;
+		}
+#else
+		if (m_data)
+		{
+			munmap(m_data, m_size);
+		}
+#endif
+		m_data = nullptr;
+		m_size = 0;
+		m_samples = nullptr;
+		m_frames = 0;
+	}
+
+	bool MappedPcmFile::map(const std::string &path, std::string &error)
+	{
+#ifdef _WIN32
+		// Share writes so files that are still being recorded can be played
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+								  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			error = "Cannot open file";
+			return false;
+		}
+		m_fileHandle = file;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+		{
+			error = "Empty or unreadable file";
+			return false;
+		}
+
+		m_mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!m_mappingHandle)
+		{
+			error = "Cannot map file";
+			return false;
+		}
+
+		m_data = static_cast<uint8_t *>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (!m_data)
+		{
+			error = "Cannot map file";
+			return false;
+		}
+		m_size = static_cast<size_t>(size.QuadPart);
+#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			error = "Cannot open file";
+			return false;
+		}
+
+		struct stat info;
+		if (fstat(fd, &info) != 0 || info.st_size <= 0)
+		{
+			::close(fd);
+			error = "Empty or unreadable file";
+			return false;
+		}
+
+		void *data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd); // The mapping keeps the file open
+		if (data == MAP_FAILED)
+		{
+			error = "Cannot map file";
+			return false;
+		}
+
+		m_data = static_cast<uint8_t *>(data);
+		m_size = static_cast<size_t>(info.st_size);
+		madvise(m_data, m_size, MADV_SEQUENTIAL);
+#endif
+		return true;
+	}
+
+	bool MappedPcmFile::parseRiff(std::string &error)
+	{
+		if (m_size < 12 || std::memcmp(m_data + 8, "WAVE", 4) != 0)
+		{
+			error = "Not a WAV file";
+			return false;
+		}
+
+		if (std::memcmp(m_data, "RIFF", 4) == 0)
+		{
+			m_container = Container::WAV;
+		}
+		else if (std::memcmp(m_data, "RF64", 4) == 0 || std::memcmp(m_data, "BW64", 4) == 0)
+		{
+			m_container = Container::RF64;
+		}
+		else
+		{
+			error = "Not a WAV file";
+			return false;
+		}
+
+		uint64_t ds64DataSize = 0;
+		bool haveFormat = false;
+		size_t position = 12;
+		while (position + 8 <= m_size)
+		{
+			const uint8_t *chunk = m_data + position;
+			const uint32_t chunkSize = read32(chunk + 4);
+			const size_t body = position + 8;
+			const uint64_t available = m_size - body;
+
+			if (std::memcmp(chunk, "ds64", 4) == 0 && chunkSize >= 24 && available >= 24)
+			{
+				// RF64: 64-bit RIFF size, data size and sample count
+				ds64DataSize = read64(m_data + body + 8);
+			}
+			else if (std::memcmp(chunk, "fmt ", 4) == 0)
+			{
+				if (!parseFormat(m_data + body, std::min<uint64_t>(chunkSize, available), error))
+				{
+					return false;
+				}
+				haveFormat = true;
+			}
+			else if (std::memcmp(chunk, "data", 4) == 0)
+			{
+				if (!haveFormat)
+				{
+					error = "Data chunk before format chunk";
+					return false;
+				}
+				const uint64_t dataSize = chunkSize == 0xFFFFFFFF && m_container == Container::RF64 ? ds64DataSize : chunkSize;
+				return setData(body, dataSize, error);
+			}
+
+			// Chunks are padded to an even size
+			position = body + chunkSize + (chunkSize & 1);
+		}
+
+		error = "No data chunk";
+		return false;
+	}
+
+	bool MappedPcmFile::parseWave64(std::string &error)
+	{
+		if (std::memcmp(m_data + 24, W64_WAVE, 16) != 0)
+		{
+			error = "Not a Wave64 file";
+			return false;
+		}
+		m_container = Container::W64;
+
+		bool haveFormat = false;
+		size_t position = 40;
+		while (position + 24 <= m_size)
+		{
+			const uint8_t *chunk = m_data + position;
+			const uint64_t chunkSize = read64(chunk + 16); // Includes the 24-byte header
+			if (chunkSize < 24)
+			{
+				error = "Corrupt Wave64 chunk";
+				return false;
+			}
+
+			const size_t body = position + 24;
+			const uint64_t bodySize = chunkSize - 24;
+			if (std::memcmp(chunk, W64_FMT, 16) == 0)
+			{
+				if (!parseFormat(m_data + body, std::min<uint64_t>(bodySize, m_size - body), error))
+				{
+					return false;
+				}
+				haveFormat = true;
+			}
+			else if (std::memcmp(chunk, W64_DATA, 16) == 0)
+			{
+				if (!haveFormat)
+				{
+					error = "Data chunk before format chunk";
+					return false;
+				}
+				return setData(body, bodySize, error);
+			}
+
+			// Chunks are aligned to 8 bytes
+			const uint64_t next = position + ((chunkSize + 7) & ~uint64_t(7));
+			if (next <= position || next > m_size)
+			{
+				break;
+			}
+			position = static_cast<size_t>(next);
+		}
+
+		error = "No data chunk";
+		return false;
+	}
+
+	bool MappedPcmFile::parseFormat(const uint8_t *chunk, uint64_t size, std::string &error)
+	{
+		if (size < 16)
+		{
+			error = "Truncated format chunk";
+			return false;
+		}
+
+		uint16_t tag = read16(chunk);
+		m_channels = read16(chunk + 2);
+		m_sampleRate = static_cast<int>(read32(chunk + 4));
+		const uint16_t blockAlign = read16(chunk + 12);
+		m_bitsPerSample = read16(chunk + 14);
+		m_channelMask = 0;
+
+		if (tag == WAVE_FORMAT_EXTENSIBLE)
+		{
+			if (size < 40)
+			{
+				error = "Truncated extensible format chunk";
+				return false;
+			}
+			m_channelMask = read32(chunk + 20);
+			tag = read16(chunk + 24); // First field of the sub-format GUID
+		}
+
+		if (tag == WAVE_FORMAT_PCM)
+		{
+			m_float = false;
+			if (m_bitsPerSample != 16 && m_bitsPerSample != 24 && m_bitsPerSample != 32)
+			{
+				error = "Unsupported PCM sample size: " + std::to_string(m_bitsPerSample);
+				return false;
+			}
+		}
+		else if (tag == WAVE_FORMAT_IEEE_FLOAT)
+		{
+			m_float = true;
+			if (m_bitsPerSample != 32 && m_bitsPerSample != 64)
+			{
+				error = "Unsupported float sample size: " + std::to_string(m_bitsPerSample);
+				return false;
+			}
+		}
+		else
+		{
+			error = "Not uncompressed PCM (format tag " + std::to_string(tag) + ")";
+			return false;
+		}
+
+		m_frameSize = m_channels * (m_bitsPerSample / 8);
+		if (m_channels <= 0 || m_sampleRate <= 0 || blockAlign != m_frameSize)
+		{
+			error = "Invalid format chunk";
+			return false;
+		}
+		return true;
+	}
+
+	bool MappedPcmFile::setData(uint64_t offset, uint64_t size, std::string &error)
+	{
+		if (offset > m_size)
+		{
+			error = "Data chunk outside the file";
+			return false;
+		}
+
+		// An interrupted recording leaves a header that promises more than the file holds
+		size = std::min<uint64_t>(size, m_size - offset);
+		m_samples = m_data + offset;
+		m_frames = static_cast<int64_t>(size / static_cast<uint64_t>(m_frameSize));
+		return true;
+	}
+
+	AVSampleFormat MappedPcmFile::getSampleFormat() const
+	{
+		if (m_float)
+		{
+			return m_bitsPerSample == 64 ? AV_SAMPLE_FMT_DBL : AV_SAMPLE_FMT_FLT;
+		}
+		switch (m_bitsPerSample)
+		{
+		case 16:
+			return AV_SAMPLE_FMT_S16;
+		case 32:
+			return AV_SAMPLE_FMT_S32;
+		default:
+			return AV_SAMPLE_FMT_NONE;
+		}
+	}
+
+	void MappedPcmFile::readPlanar(int64_t frame, long frames, float *const *planes) const
+	{
+		const uint8_t *in = frameData(frame);
+		const int channels = m_channels;
+		const int sampleSize = m_bitsPerSample / 8;
+
+		// Frame by frame: the source is read once, in order
+		for (long i = 0; i < frames; i++)
+		{
+			for (int c = 0; c < channels; c++, in += sampleSize)
+			{
+				float value;
+				if (m_float)
+				{
+					if (sampleSize == 4)
+					{
+						std::memcpy(&value, in, sizeof(value));
+					}
+					else
+					{
+						double sample;
+						std::memcpy(&sample, in, sizeof(sample));
+						value = static_cast<float>(sample);
+					}
+				}
+				else if (sampleSize == 2)
+				{
+					value = static_cast<int16_t>(read16(in)) * (1.0f / 32768.0f);
+				}
+				else if (sampleSize == 3)
+				{
+					// Sign-extend from the top byte
+					const int32_t sample = static_cast<int32_t>((uint32_t(in[0]) << 8) | (uint32_t(in[1]) << 16) | (uint32_t(in[2]) << 24)) >> 8;
+					value = sample * (1.0f / 8388608.0f);
+				}
+				else
+				{
+					value = static_cast<float>(static_cast<int32_t>(read32(in)) * (1.0 / 2147483648.0));
+				}
+				planes[c][i] = value;
+			}
+		}
+	}
+
+	void MappedPcmFile::pageRange(int64_t frame, int64_t frames, uint8_t *&begin, size_t &length) const
+	{
+		const size_t page = pageSize();
+		const uint8_t *first = frameData(frame);
+		const uint8_t *last = frameData(std::min(frame + frames, m_frames));
+		const uintptr_t start = reinterpret_cast<uintptr_t>(first) & ~(uintptr_t(page) - 1);
+		begin = reinterpret_cast<uint8_t *>(start);
+		length = static_cast<size_t>(reinterpret_cast<uintptr_t>(last) - start);
+	}
+
+	void MappedPcmFile::prefetch(int64_t frame, int64_t frames) const
+	{
+		if (!m_data || frame >= m_frames || frames <= 0)
+		{
+			return;
+		}
+
+		uint8_t *begin = nullptr;
+		size_t length = 0;
+		pageRange(frame, frames, begin, length);
+#ifdef _WIN32
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+		WIN32_MEMORY_RANGE_ENTRY range{begin, length};
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+		madvise(begin, length, MADV_WILLNEED);
+#endif
+	}
+
+	void MappedPcmFile::touch(int64_t frame, int64_t frames) const
+	{
+		if (!m_data || frame >= m_frames || frames <= 0)
+		{
+			return;
+		}
+
+		uint8_t *begin = nullptr;
+		size_t length = 0;
+		pageRange(frame, frames, begin, length);
+
+		// One read per page is enough to fault it in
+		const size_t page = pageSize();
+		volatile uint8_t sink = 0;
+		for (size_t offset = 0; offset < length; offset += page)
+		{
+			sink = sink + begin[offset];
+		}
+		(void)sink;
+	}
+
+} // namespace AudioEngine
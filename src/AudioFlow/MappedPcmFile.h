@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+extern "C"
+{
+#include <libavutil/samplefmt.h>
+}
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief Read-only memory mapping of an uncompressed PCM file
+	 *
+	 * Parses the header of a RIFF WAVE, RF64 or Sony Wave64 file with integer
+	 * PCM (16, 24 or 32 bit) or IEEE float (32 or 64 bit) samples, including
+	 * WAVE_FORMAT_EXTENSIBLE, and maps the whole file. Samples are then read
+	 * in place: frameData() points straight at a frame, and readPlanar()
+	 * converts a range into float planes.
+	 *
+	 * A data chunk that runs past the end of the file (an interrupted
+	 * recording) is cut at the last whole frame.
+	 *
+	 * Page-cache hints: the mapping is advised as sequential, prefetch()
+	 * starts asynchronous read-ahead of a range and touch() faults a range in
+	 * on the calling thread, so that a real-time reader never waits on disk.
+	 *
+	 * The mapping is immutable once open() returns; any number of threads may
+	 * read it.
+	 */
+	class MappedPcmFile
+	{
+	public:
+		/**
+		 * @brief File container
+		 */
+		enum class Container
+		{
+			WAV,
+			RF64,
+			W64
+		};
+
+		MappedPcmFile() = default;
+		~MappedPcmFile();
+
+		MappedPcmFile(const MappedPcmFile &) = delete;
+		MappedPcmFile &operator=(const MappedPcmFile &) = delete;
+
+		/**
+		 * @brief Map a file
+		 *
+		 * @param path File to map
+		 * @param error Receives the reason on failure (not a PCM file, unsupported
+		 *              encoding, I/O error)
+		 * @return true if the file is mapped and its format is supported
+		 */
+		bool open(const std::string &path, std::string &error);
+
+		/**
+		 * @brief Unmap the file
+		 */
+		void close();
+
+		bool isOpen() const { return m_data != nullptr; }
+
+		Container getContainer() const { return m_container; }
+		int getChannels() const { return m_channels; }
+		int getSampleRate() const { return m_sampleRate; }
+		int getBitsPerSample() const { return m_bitsPerSample; }
+		bool isFloat() const { return m_float; }
+		uint64_t getChannelMask() const { return m_channelMask; }
+
+		/**
+		 * @brief Get the number of whole frames in the data chunk
+		 */
+		int64_t getFrameCount() const { return m_frames; }
+
+		/**
+		 * @brief Get the bytes per frame (all channels)
+		 */
+		int getFrameSize() const { return m_frameSize; }
+
+		/**
+		 * @brief Get the interleaved FFmpeg format matching the samples
+		 *
+		 * @return Packed sample format, or AV_SAMPLE_FMT_NONE for 24-bit PCM
+		 */
+		AVSampleFormat getSampleFormat() const;
+
+		/**
+		 * @brief Get a pointer to an interleaved frame
+		 *
+		 * @param frame Frame index (less than getFrameCount())
+		 */
+		const uint8_t *frameData(int64_t frame) const
+		{
+			return m_samples + static_cast<size_t>(frame) * static_cast<size_t>(m_frameSize);
+		}
+
+		/**
+		 * @brief Convert frames to float planes
+		 *
+		 * @param frame First frame
+		 * @param frames Number of frames (must lie inside the file)
+		 * @param planes One destination per channel
+		 */
+		void readPlanar(int64_t frame, long frames, float *const *planes) const;
+
+		/**
+		 * @brief Ask the OS to start reading a range in the background
+		 */
+		void prefetch(int64_t frame, int64_t frames) const;
+
+		/**
+		 * @brief Fault a range into memory on the calling thread
+		 */
+		void touch(int64_t frame, int64_t frames) const;
+
+	private:
+		// Mapping
+		uint8_t *m_data = nullptr;
+		size_t m_size = 0;
+#ifdef _WIN32
+		void *m_fileHandle = nullptr;
+		void *m_mappingHandle = nullptr;
+#endif
+
+		// Format
+		Container m_container = Container::WAV;
+		int m_channels = 0;
+		int m_sampleRate = 0;
+		int m_bitsPerSample = 0;
+		bool m_float = false;
+		uint64_t m_channelMask = 0;
+		int m_frameSize = 0;
+
+		// Samples
+		const uint8_t *m_samples = nullptr;
+		int64_t m_frames = 0;
+
+		bool map(const std::string &path, std::string &error);
+		bool parseRiff(std::string &error);
+		bool parseWave64(std::string &error);
+		bool parseFormat(const uint8_t *chunk, uint64_t size, std::string &error);
+		bool setData(uint64_t offset, uint64_t size, std::string &error);
+		void pageRange(int64_t frame, int64_t frames, uint8_t *&begin, size_t &length) const;
+	};
+
+} // namespace AudioEngine
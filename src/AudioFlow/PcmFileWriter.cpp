@@ -0,0 +1,812 @@
+#include "PcmFileWriter.h"
+#include "AudioBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AudioEngine
+{
+
+	namespace
+	{
+		// Header fields are little-endian, like the hosts we run on
+		void put16(uint8_t *p, uint16_t value) { std::memcpy(p, &value, sizeof(value)); }
+		void put32(uint8_t *p, uint32_t value) { std::memcpy(p, &value, sizeof(value)); }
+		void put64(uint8_t *p, uint64_t value) { std::memcpy(p, &value, sizeof(value)); }
+		void putTag(uint8_t *p, const char *tag) { std::memcpy(p, tag, 4); }
+
+		// RIFF, JUNK/ds64 (28 bytes), extensible fmt (40 bytes), data
+		constexpr size_t DS64_OFFSET = 12;
+		constexpr size_t FMT_OFFSET = 48;
+		constexpr size_t FMT_END = 96;
+		constexpr size_t COMPACT_HEADER_SIZE = FMT_END + 8;
+
+		constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+		constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+		constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+		constexpr uint64_t RIFF_LIMIT = 0xFFFFFFFFull;
+
+		template <typename Read, typename Store>
+		void convertLoop(const uint8_t *src, ptrdiff_t srcStride, uint8_t *dst, ptrdiff_t dstStride, long frames,
+						 Read read, Store store)
+		{
+			for (long i = 0; i < frames; i++)
+			{
+				store(dst, read(src));
+				src += srcStride;
+				dst += dstStride;
+			}
+		}
+
+		// Reads any engine sample as a double; integer samples convert back exactly
+		template <typename Store>
+		bool convertFrom(AVSampleFormat format, const uint8_t *src, ptrdiff_t srcStride, uint8_t *dst,
+						 ptrdiff_t dstStride, long frames, Store store)
+		{
+			switch (av_get_packed_sample_fmt(format))
+			{
+			case AV_SAMPLE_FMT_U8:
+				convertLoop(src, srcStride, dst, dstStride, frames, [](const uint8_t *p)
+							{ return (*p - 128) / 128.0; }, store);
+				return true;
+			case AV_SAMPLE_FMT_S16:
+				convertLoop(src, srcStride, dst, dstStride, frames, [](const uint8_t *p)
+							{ int16_t v; std::memcpy(&v, p, sizeof(v)); return v / 32768.0; }, store);
+				return true;
+			case AV_SAMPLE_FMT_S32:
+				convertLoop(src, srcStride, dst, dstStride, frames, [](const uint8_t *p)
+							{ int32_t v; std::memcpy(&v, p, sizeof(v)); return v / 2147483648.0; }, store);
+				return true;
+			case AV_SAMPLE_FMT_FLT:
+				convertLoop(src, srcStride, dst, dstStride, frames, [](const uint8_t *p)
+							{ float v; std::memcpy(&v, p, sizeof(v)); return static_cast<double>(v); }, store);
+				return true;
+			case AV_SAMPLE_FMT_DBL:
+				convertLoop(src, srcStride, dst, dstStride, frames, [](const uint8_t *p)
+							{ double v; std::memcpy(&v, p, sizeof(v)); return v; }, store);
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		int64_t toInteger(double value, double scale)
+		{
+			const double scaled = std::nearbyint(value * scale);
+			return static_cast<int64_t>(std::max(-scale, std::min(scale - 1.0, scaled)));
+		}
+
+		bool convertChannel(AVSampleFormat format, PcmFileWriter::Encoding encoding, const uint8_t *src,
+							ptrdiff_t srcStride, uint8_t *dst, ptrdiff_t dstStride, long frames)
+		{
+			switch (encoding)
+			{
+			case PcmFileWriter::Encoding::PCM16:
+				return convertFrom(format, src, srcStride, dst, dstStride, frames, [](uint8_t *p, double v)
+								   { put16(p, static_cast<uint16_t>(toInteger(v, 32768.0))); });
+			case PcmFileWriter::Encoding::PCM24:
+				return convertFrom(format, src, srcStride, dst, dstStride, frames, [](uint8_t *p, double v)
+								   {
+									   const uint32_t s = static_cast<uint32_t>(toInteger(v, 8388608.0));
+									   p[0] = static_cast<uint8_t>(s);
+									   p[1] = static_cast<uint8_t>(s >> 8);
+									   p[2] = static_cast<uint8_t>(s >> 16); });
+			case PcmFileWriter::Encoding::PCM32:
+				return convertFrom(format, src, srcStride, dst, dstStride, frames, [](uint8_t *p, double v)
+								   { put32(p, static_cast<uint32_t>(toInteger(v, 2147483648.0))); });
+			case PcmFileWriter::Encoding::FLOAT32:
+				return convertFrom(format, src, srcStride, dst, dstStride, frames, [](uint8_t *p, double v)
+								   { const float f = static_cast<float>(v); std::memcpy(p, &f, sizeof(f)); });
+			case PcmFileWriter::Encoding::FLOAT64:
+				return convertFrom(format, src, srcStride, dst, dstStride, frames, [](uint8_t *p, double v)
+								   { std::memcpy(p, &v, sizeof(v)); });
+			}
+			return false;
+		}
+
+#ifndef _WIN32
+		std::string errorText()
+		{
+			return std::strerror(errno);
+		}
+#endif
+	}
+
+	PcmWriteService::PcmWriteService(size_t bufferBytes, size_t bufferCount)
+		: m_bufferBytes(std::max(IO_ALIGNMENT, (bufferBytes + IO_ALIGNMENT - 1) / IO_ALIGNMENT * IO_ALIGNMENT))
+	{
+		for (size_t i = 0; i < bufferCount; i++)
+		{
+			addBuffer();
+		}
+		m_thread = std::thread(&PcmWriteService::threadFunc, this);
+	}
+
+	PcmWriteService::~PcmWriteService()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_queuedCondition.notify_one();
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+	}
+
+	void PcmWriteService::retire(std::unique_ptr<PcmFileWriter> writer, CloseCallback callback)
+	{
+		if (!writer)
+		{
+			return;
+		}
+		if (!writer->isOpen() || writer->m_service != this)
+		{
+			// Not ours to finalize (and it may own the thread that would destroy it)
+			std::string error;
+			const bool success = writer->close(error);
+			if (callback)
+			{
+				callback(writer->getPath(), success, error);
+			}
+			return;
+		}
+
+		writer->flushPartial();
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			Job job;
+			job.writer = writer.get();
+			job.closing = std::move(writer);
+			job.callback = std::move(callback);
+			m_jobs.push_back(std::move(job));
+		}
+		m_queuedCondition.notify_one();
+	}
+
+	void PcmWriteService::addBuffer()
+	{
+		auto buffer = std::make_unique<WriteBuffer>();
+		buffer->storage.assign(m_bufferBytes + IO_ALIGNMENT, 0);
+		const uintptr_t base = reinterpret_cast<uintptr_t>(buffer->storage.data());
+		buffer->data = buffer->storage.data() + ((IO_ALIGNMENT - base % IO_ALIGNMENT) % IO_ALIGNMENT);
+		m_free.push_back(buffer.get());
+		m_buffers.push_back(std::move(buffer));
+	}
+
+	PcmWriteService::WriteBuffer *PcmWriteService::acquire()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (m_free.empty() && m_writing == 0)
+		{
+			// Every buffer is being filled; nothing will come back, so grow
+			addBuffer();
+		}
+		m_doneCondition.wait(lock, [this]()
+							 { return !m_free.empty(); });
+		WriteBuffer *buffer = m_free.back();
+		m_free.pop_back();
+		buffer->used = 0;
+		return buffer;
+	}
+
+	void PcmWriteService::submit(PcmFileWriter *writer, WriteBuffer *buffer, bool last)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			Job job;
+			job.writer = writer;
+			job.buffer = buffer;
+			job.last = last;
+			m_jobs.push_back(std::move(job));
+			m_writing++;
+			writer->m_pending++;
+		}
+		m_queuedCondition.notify_one();
+	}
+
+	void PcmWriteService::waitIdle(const PcmFileWriter *writer)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_doneCondition.wait(lock, [writer]()
+							 { return writer->m_pending == 0; });
+	}
+
+	void PcmWriteService::threadFunc()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true)
+		{
+			m_queuedCondition.wait(lock, [this]()
+								   { return !m_jobs.empty() || m_stop; });
+			if (m_jobs.empty())
+			{
+				break;
+			}
+
+			// Jobs run in submission order, which keeps each file's buffers in sequence
+			Job job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+			lock.unlock();
+
+			if (job.buffer)
+			{
+				job.writer->writeBuffer(*job.buffer, job.last);
+			}
+			else if (job.closing)
+			{
+				std::string error;
+				const bool success = job.closing->finalize(error);
+				if (job.callback)
+				{
+					job.callback(job.closing->getPath(), success, error);
+				}
+				job.closing.reset();
+			}
+
+			lock.lock();
+			if (job.buffer)
+			{
+				m_free.push_back(job.buffer);
+				m_writing--;
+				job.writer->m_pending--;
+			}
+			m_doneCondition.notify_all();
+		}
+	}
+
+	PcmFileWriter::~PcmFileWriter()
+	{
+		std::string error;
+		close(error);
+	}
+
+	bool PcmFileWriter::parseCodec(const std::string &codec, Encoding &encoding)
+	{
+		if (codec == "pcm_s16le")
+		{
+			encoding = Encoding::PCM16;
+		}
+		else if (codec == "pcm_s24le")
+		{
+			encoding = Encoding::PCM24;
+		}
+		else if (codec == "pcm_s32le")
+		{
+			encoding = Encoding::PCM32;
+		}
+		else if (codec == "pcm_f32le")
+		{
+			encoding = Encoding::FLOAT32;
+		}
+		else if (codec == "pcm_f64le")
+		{
+			encoding = Encoding::FLOAT64;
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+
+	bool PcmFileWriter::open(const std::string &path, int sampleRate, int channels, uint32_t channelMask,
+							 Encoding encoding, const Options &options, std::string &error,
+							 PcmWriteService *service)
+	{
+		if (isOpen())
+		{
+			error = "Writer is already open";
+			return false;
+		}
+		if (sampleRate <= 0 || channels <= 0 || channels > 0xFFFF)
+		{
+			error = "Invalid sample rate or channel count";
+			return false;
+		}
+
+		m_path = path;
+		m_encoding = encoding;
+		m_sampleRate = sampleRate;
+		m_channels = channels;
+		m_options = options;
+		switch (encoding)
+		{
+		case Encoding::PCM16:
+			m_sampleSize = 2;
+			break;
+		case Encoding::PCM24:
+			m_sampleSize = 3;
+			break;
+		case Encoding::PCM32:
+		case Encoding::FLOAT32:
+			m_sampleSize = 4;
+			break;
+		case Encoding::FLOAT64:
+			m_sampleSize = 8;
+			break;
+		}
+		m_frameSize = m_sampleSize * channels;
+
+		if (!createFile(path, error))
+		{
+			closeHandles();
+			return false;
+		}
+
+		// Direct I/O needs the audio to start on an aligned offset
+		m_headerSize = m_directIo ? static_cast<int64_t>(PcmWriteService::IO_ALIGNMENT)
+								  : static_cast<int64_t>(COMPACT_HEADER_SIZE);
+		buildHeader(channelMask);
+		if (!writeAt(m_headerFd, m_header.data(), m_header.size(), 0))
+		{
+			error = "Failed to write header";
+			closeHandles();
+			return false;
+		}
+
+		m_service = service;
+		if (!m_service)
+		{
+			try
+			{
+				m_ownService = std::make_unique<PcmWriteService>(m_options.bufferBytes, BUFFER_COUNT);
+			}
+			catch (const std::exception &e)
+			{
+				error = std::string("Failed to start I/O thread: ") + e.what();
+				closeHandles();
+				return false;
+			}
+			m_service = m_ownService.get();
+		}
+
+		m_current = nullptr;
+		m_pending = 0;
+		m_error.clear();
+		m_failed = false;
+		m_frames = 0;
+		m_diskBytes = 0;
+		m_allocatedUntil = m_headerSize;
+		m_lastPatch = std::chrono::steady_clock::now();
+		return true;
+	}
+
+	bool PcmFileWriter::write(const AudioBuffer &buffer, int firstChannel)
+	{
+		if (!isOpen() || m_failed.load(std::memory_order_relaxed))
+		{
+			return false;
+		}
+
+		const long frames = buffer.getFrameCount();
+		if (firstChannel < 0 || buffer.getChannelCount() < firstChannel + m_channels)
+		{
+			return false;
+		}
+		if (frames <= 0)
+		{
+			return true;
+		}
+
+		// Interleave into the scratch block, then copy across write buffer boundaries
+		m_scratch.resize(static_cast<size_t>(frames) * static_cast<size_t>(m_frameSize));
+		const bool planar = buffer.isPlanar();
+		const int bytesPerSample = buffer.getBytesPerSample();
+		const ptrdiff_t srcStride = planar ? bytesPerSample : bytesPerSample * buffer.getChannelCount();
+		for (int c = 0; c < m_channels; c++)
+		{
+			const int channel = firstChannel + c;
+			const uint8_t *src = planar ? buffer.getPlaneData(channel) : buffer.getPlaneData(0) + channel * bytesPerSample;
+			if (!src || !convertChannel(buffer.getFormat(), m_encoding, src, srcStride,
+										m_scratch.data() + c * m_sampleSize, m_frameSize, frames))
+			{
+				return false;
+			}
+		}
+
+		append(m_scratch.data(), m_scratch.size());
+		m_frames.fetch_add(frames, std::memory_order_relaxed);
+		return true;
+	}
+
+	bool PcmFileWriter::close(std::string &error)
+	{
+		if (!isOpen())
+		{
+			return true;
+		}
+
+		// Hand over the partial buffer and wait for this file's writes
+		flushPartial();
+		m_service->waitIdle(this);
+
+		const bool success = finalize(error);
+		m_service = nullptr;
+		m_ownService.reset();
+		return success;
+	}
+
+	bool PcmFileWriter::finalize(std::string &error)
+	{
+		// RIFF chunks are padded to an even size
+		const int64_t dataBytes = m_diskBytes.load();
+		const int64_t fileEnd = m_headerSize + dataBytes + (dataBytes & 1);
+		if ((dataBytes & 1) && !m_directIo)
+		{
+			const uint8_t pad = 0;
+			if (!writeAt(m_fd, &pad, 1, m_headerSize + dataBytes))
+			{
+				fail("Failed to write pad byte");
+			}
+		}
+
+		// Drops the direct I/O padding and any unused preallocation
+		if (!truncate(fileEnd))
+		{
+			fail("Failed to set file size");
+		}
+		if (!patchHeader(dataBytes, dataBytes / m_frameSize) || !sync())
+		{
+			fail("Failed to finalize header");
+		}
+
+		closeHandles();
+		std::lock_guard<std::mutex> lock(m_errorMutex);
+		error = m_error;
+		return !m_failed;
+	}
+
+	bool PcmFileWriter::createFile(const std::string &path, std::string &error)
+	{
+		m_directIo = false;
+#ifdef _WIN32
+		const DWORD share = FILE_SHARE_READ | FILE_SHARE_WRITE;
+		const DWORD flags = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN;
+		HANDLE file = INVALID_HANDLE_VALUE;
+		if (m_options.directIo)
+		{
+			file = CreateFileA(path.c_str(), GENERIC_WRITE, share, nullptr, CREATE_ALWAYS,
+							   flags | FILE_FLAG_NO_BUFFERING, nullptr);
+			m_directIo = file != INVALID_HANDLE_VALUE;
+		}
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			file = CreateFileA(path.c_str(), GENERIC_WRITE, share, nullptr, CREATE_ALWAYS, flags, nullptr);
+		}
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			error = "Cannot create file";
+			return false;
+		}
+		m_fd = file;
+
+		HANDLE header = CreateFileA(path.c_str(), GENERIC_WRITE, share, nullptr, OPEN_EXISTING,
+									FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (header == INVALID_HANDLE_VALUE)
+		{
+			error = "Cannot open file for header updates";
+			return false;
+		}
+		m_headerFd = header;
+#else
+		const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+		int fd = -1;
+#ifdef O_DIRECT
+		if (m_options.directIo)
+		{
+			// tmpfs and some network filesystems refuse O_DIRECT
+			fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+			m_directIo = fd >= 0;
+		}
+#endif
+		if (fd < 0)
+		{
+			fd = ::open(path.c_str(), flags, 0644);
+		}
+		if (fd < 0)
+		{
+			error = "Cannot create file: " + errorText();
+			return false;
+		}
+		m_fd = fd;
+#ifdef __APPLE__
+		if (m_options.directIo && fcntl(fd, F_NOCACHE, 1) == 0)
+		{
+			m_directIo = true;
+		}
+#endif
+
+		m_headerFd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+		if (m_headerFd < 0)
+		{
+			error = "Cannot open file for header updates: " + errorText();
+			return false;
+		}
+#endif
+		return true;
+	}
+
+	void PcmFileWriter::closeHandles()
+	{
+#ifdef _WIN32
+		if (m_fd)
+		{
+			CloseHandle(m_fd);
+		}
+		if (m_headerFd)
+		{
+			CloseHandle(m_headerFd);
+		}
+#else
+		if (m_fd >= 0)
+		{
+			::close(m_fd);
+		}
+		if (m_headerFd >= 0)
+		{
+			::close(m_headerFd);
+		}
+#endif
+		m_fd = INVALID_FD;
+		m_headerFd = INVALID_FD;
+	}
+
+	void PcmFileWriter::buildHeader(uint32_t channelMask)
+	{
+		m_header.assign(static_cast<size_t>(m_headerSize), 0);
+		uint8_t *h = m_header.data();
+
+		putTag(h + 8, "WAVE");
+
+		// Extensible format chunk; float and integer only differ in the sub-format GUID
+		const uint16_t tag = m_encoding == Encoding::FLOAT32 || m_encoding == Encoding::FLOAT64
+								 ? WAVE_FORMAT_IEEE_FLOAT
+								 : WAVE_FORMAT_PCM;
+		uint8_t *fmt = h + FMT_OFFSET;
+		putTag(fmt, "fmt ");
+		put32(fmt + 4, 40);
+		put16(fmt + 8, WAVE_FORMAT_EXTENSIBLE);
+		put16(fmt + 10, static_cast<uint16_t>(m_channels));
+		put32(fmt + 12, static_cast<uint32_t>(m_sampleRate));
+		put32(fmt + 16, static_cast<uint32_t>(m_sampleRate) * static_cast<uint32_t>(m_frameSize));
+		put16(fmt + 20, static_cast<uint16_t>(m_frameSize));
+		put16(fmt + 22, static_cast<uint16_t>(m_sampleSize * 8));
+		put16(fmt + 24, 22);
+		put16(fmt + 26, static_cast<uint16_t>(m_sampleSize * 8));
+		put32(fmt + 28, channelMask);
+		static const uint8_t GUID_TAIL[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+		put16(fmt + 32, tag);
+		std::memcpy(fmt + 34, GUID_TAIL, sizeof(GUID_TAIL));
+
+		// Padding up to the aligned data offset
+		if (m_headerSize > static_cast<int64_t>(COMPACT_HEADER_SIZE))
+		{
+			putTag(h + FMT_END, "JUNK");
+			put32(h + FMT_END + 4, static_cast<uint32_t>(m_headerSize - COMPACT_HEADER_SIZE - 8));
+		}
+		putTag(h + m_headerSize - 8, "data");
+
+		updateHeader(0, 0);
+	}
+
+	void PcmFileWriter::updateHeader(int64_t dataBytes, int64_t frames)
+	{
+		uint8_t *h = m_header.data();
+		const uint64_t riffSize = static_cast<uint64_t>(m_headerSize - 8 + dataBytes + (dataBytes & 1));
+		const bool rf64 = m_options.rf64 || riffSize > RIFF_LIMIT;
+
+		if (rf64)
+		{
+			// The reserved JUNK chunk becomes ds64 and carries the real sizes
+			putTag(h, "RF64");
+			put32(h + 4, 0xFFFFFFFF);
+			putTag(h + DS64_OFFSET, "ds64");
+			put32(h + DS64_OFFSET + 4, 28);
+			put64(h + DS64_OFFSET + 8, riffSize);
+			put64(h + DS64_OFFSET + 16, static_cast<uint64_t>(dataBytes));
+			put64(h + DS64_OFFSET + 24, static_cast<uint64_t>(frames));
+			put32(h + DS64_OFFSET + 32, 0);
+			put32(h + m_headerSize - 4, 0xFFFFFFFF);
+		}
+		else
+		{
+			putTag(h, "RIFF");
+			put32(h + 4, static_cast<uint32_t>(riffSize));
+			putTag(h + DS64_OFFSET, "JUNK");
+			put32(h + DS64_OFFSET + 4, 28);
+			std::memset(h + DS64_OFFSET + 8, 0, 28);
+			put32(h + m_headerSize - 4, static_cast<uint32_t>(dataBytes));
+		}
+	}
+
+	bool PcmFileWriter::patchHeader(int64_t dataBytes, int64_t frames)
+	{
+		updateHeader(dataBytes, frames);
+		return writeAt(m_headerFd, m_header.data(), m_header.size(), 0);
+	}
+
+	void PcmFileWriter::append(const uint8_t *data, size_t bytes)
+	{
+		const size_t capacity = m_service->getBufferBytes();
+		while (bytes > 0)
+		{
+			if (!m_current)
+			{
+				m_current = m_service->acquire();
+			}
+
+			const size_t count = std::min(bytes, capacity - m_current->used);
+			std::memcpy(m_current->data + m_current->used, data, count);
+			m_current->used += count;
+			data += count;
+			bytes -= count;
+
+			if (m_current->used == capacity)
+			{
+				m_service->submit(this, m_current, false);
+				m_current = nullptr;
+			}
+		}
+	}
+
+	void PcmFileWriter::flushPartial()
+	{
+		if (m_current)
+		{
+			m_service->submit(this, m_current, true);
+			m_current = nullptr;
+		}
+	}
+
+	void PcmFileWriter::writeBuffer(PcmWriteService::WriteBuffer &buffer, bool last)
+	{
+		using Clock = std::chrono::steady_clock;
+		constexpr size_t ALIGNMENT = PcmWriteService::IO_ALIGNMENT;
+
+		if (!m_failed.load(std::memory_order_relaxed) && buffer.used > 0)
+		{
+			// The final buffer is zero-padded to the alignment and truncated on close
+			size_t bytes = buffer.used;
+			if (m_directIo && last)
+			{
+				bytes = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+				std::memset(buffer.data + buffer.used, 0, bytes - buffer.used);
+			}
+
+			const int64_t offset = m_headerSize + m_diskBytes.load(std::memory_order_relaxed);
+			preallocate(offset + static_cast<int64_t>(bytes));
+			if (writeAt(m_fd, buffer.data, bytes, offset))
+			{
+				m_diskBytes.fetch_add(static_cast<int64_t>(buffer.used), std::memory_order_relaxed);
+			}
+			else
+			{
+				fail("Write failed at offset " + std::to_string(offset));
+			}
+		}
+
+		// Sizes in the header only ever cover audio that has been synced
+		if (m_options.headerIntervalSeconds > 0.0 && !m_failed.load(std::memory_order_relaxed) &&
+			Clock::now() - m_lastPatch >= std::chrono::duration<double>(m_options.headerIntervalSeconds))
+		{
+			const int64_t dataBytes = m_diskBytes.load(std::memory_order_relaxed);
+			if (!sync() || !patchHeader(dataBytes, dataBytes / m_frameSize))
+			{
+				fail("Header update failed");
+			}
+			m_lastPatch = Clock::now();
+		}
+	}
+
+	bool PcmFileWriter::writeAt(Handle fd, const uint8_t *data, size_t bytes, int64_t offset)
+	{
+#ifdef _WIN32
+		// Chunks stay aligned for unbuffered handles
+		constexpr size_t MAX_CHUNK = 1u << 30;
+		while (bytes > 0)
+		{
+			OVERLAPPED position = {};
+			position.Offset = static_cast<DWORD>(offset);
+			position.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+			DWORD written = 0;
+			if (!WriteFile(fd, data, static_cast<DWORD>(std::min(bytes, MAX_CHUNK)), &written, &position) || written == 0)
+			{
+				return false;
+			}
+			data += written;
+			bytes -= written;
+			offset += written;
+		}
+#else
+		while (bytes > 0)
+		{
+			const ssize_t written = ::pwrite(fd, data, bytes, static_cast<off_t>(offset));
+			if (written < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (written <= 0)
+			{
+				return false;
+			}
+			data += written;
+			bytes -= static_cast<size_t>(written);
+			offset += written;
+		}
+#endif
+		return true;
+	}
+
+	void PcmFileWriter::preallocate(int64_t end)
+	{
+		if (m_options.preallocateBytes <= 0 || end <= m_allocatedUntil)
+		{
+			return;
+		}
+
+		// Reserve well ahead so the filesystem allocates in large extents; the file size is unchanged
+		const int64_t target = end + m_options.preallocateBytes;
+#if defined(_WIN32)
+		FILE_ALLOCATION_INFO info = {};
+		info.AllocationSize.QuadPart = target;
+		SetFileInformationByHandle(m_fd, FileAllocationInfo, &info, sizeof(info));
+#elif defined(__linux__)
+		if (fallocate(m_fd, FALLOC_FL_KEEP_SIZE, m_allocatedUntil, target - m_allocatedUntil) != 0 &&
+			errno == EOPNOTSUPP)
+		{
+			// Not supported by this filesystem; stop asking
+			m_options.preallocateBytes = 0;
+		}
+#endif
+		m_allocatedUntil = target;
+	}
+
+	bool PcmFileWriter::sync()
+	{
+#if defined(_WIN32)
+		return FlushFileBuffers(m_fd) != 0;
+#elif defined(__linux__)
+		return fdatasync(m_fd) == 0;
+#else
+		return fsync(m_fd) == 0;
+#endif
+	}
+
+	bool PcmFileWriter::truncate(int64_t size)
+	{
+#ifdef _WIN32
+		FILE_END_OF_FILE_INFO info = {};
+		info.EndOfFile.QuadPart = size;
+		return SetFileInformationByHandle(m_fd, FileEndOfFileInfo, &info, sizeof(info)) != 0;
+#else
+		return ::ftruncate(m_fd, static_cast<off_t>(size)) == 0;
+#endif
+	}
+
+	void PcmFileWriter::fail(const std::string &message)
+	{
+		std::lock_guard<std::mutex> lock(m_errorMutex);
+		if (m_error.empty())
+		{
+			m_error = message;
+		}
+		m_failed = true;
+	}
+
+} // namespace AudioEngine
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace AudioEngine
+{
+
+	class AudioBuffer;	 // Forward declaration
+	class PcmFileWriter; // Forward declaration
+
+	/**
+	 * @brief I/O thread and write buffer pool shared by PcmFileWriters
+	 *
+	 * Writers fill buffers from the pool and queue them; the single I/O
+	 * thread writes them in submission order, so any number of files
+	 * recorded together (one per track, say) cost one thread and one pool
+	 * and the disk sees their writes one large buffer at a time.
+	 *
+	 * The pool grows only when every buffer is held by a writer that is
+	 * still filling it; otherwise a writer waits for the I/O thread to
+	 * return one. Size it at about two buffers per writer.
+	 *
+	 * The service must outlive the writers opened on it. Its destructor
+	 * finishes every queued write and close first.
+	 */
+	class PcmWriteService
+	{
+	public:
+		/**
+		 * @brief Called on the I/O thread when a retired writer has closed
+		 */
+		using CloseCallback = std::function<void(const std::string &path, bool success, const std::string &error)>;
+
+		// Direct I/O offset, size and memory alignment (covers 4K-sector drives)
+		static constexpr size_t IO_ALIGNMENT = 4096;
+
+		/**
+		 * @brief Start the I/O thread
+		 *
+		 * @param bufferBytes Size of each write buffer (rounded up to IO_ALIGNMENT)
+		 * @param bufferCount Buffers allocated up front
+		 * @throws std::system_error if the thread cannot be started
+		 */
+		PcmWriteService(size_t bufferBytes, size_t bufferCount);
+		~PcmWriteService();
+
+		PcmWriteService(const PcmWriteService &) = delete;
+		PcmWriteService &operator=(const PcmWriteService &) = delete;
+
+		size_t getBufferBytes() const { return m_bufferBytes; }
+
+		/**
+		 * @brief Close a writer without waiting for the disk
+		 *
+		 * The writer's remaining audio is queued, and the I/O thread
+		 * finalizes the file and destroys the writer after writing it. Used
+		 * for gapless file rotation: the next file is written to while the
+		 * previous one closes.
+		 *
+		 * @param writer Writer opened on this service
+		 * @param callback Optional completion callback
+		 */
+		void retire(std::unique_ptr<PcmFileWriter> writer, CloseCallback callback = nullptr);
+
+	private:
+		friend class PcmFileWriter;
+
+		struct WriteBuffer
+		{
+			std::vector<uint8_t> storage;
+			uint8_t *data = nullptr; // Aligned start of storage
+			size_t used = 0;
+		};
+
+		struct Job
+		{
+			PcmFileWriter *writer = nullptr;
+			WriteBuffer *buffer = nullptr;		   // Audio to write, or null to close the writer
+			bool last = false;					   // Final, possibly partial buffer of the file
+			std::unique_ptr<PcmFileWriter> closing; // Owned writer to finalize and destroy
+			CloseCallback callback;
+		};
+
+		size_t m_bufferBytes;
+		std::vector<std::unique_ptr<WriteBuffer>> m_buffers;
+		std::vector<WriteBuffer *> m_free;
+
+		std::deque<Job> m_jobs;
+		size_t m_writing = 0; // Buffers queued or being written
+		std::mutex m_mutex;
+		std::condition_variable m_queuedCondition;
+		std::condition_variable m_doneCondition;
+		bool m_stop = false;
+		std::thread m_thread;
+
+		WriteBuffer *acquire();
+		void addBuffer();
+		void submit(PcmFileWriter *writer, WriteBuffer *buffer, bool last);
+		void waitIdle(const PcmFileWriter *writer);
+		void threadFunc();
+	};
+
+	/**
+	 * @brief Streaming writer for uncompressed WAV and RF64 files
+	 *
+	 * The counterpart of MappedPcmFile for recording. write() converts each
+	 * buffer to interleaved little-endian samples and appends them to a
+	 * large, page-aligned write buffer; a full buffer is handed to the I/O
+	 * thread of a PcmWriteService while the caller fills the next, so the
+	 * disk sees a few large sequential writes instead of one small write per
+	 * block. A writer opened without a service gets a private one with two
+	 * buffers.
+	 *
+	 * Options:
+	 * - Direct I/O (O_DIRECT on Linux, F_NOCACHE on macOS,
+	 *   FILE_FLAG_NO_BUFFERING on Windows) keeps long recordings out of the
+	 *   page cache. The header is then padded to a whole alignment unit so
+	 *   every data write starts and ends on an aligned offset; the final
+	 *   partial buffer is zero-padded and the file truncated afterwards.
+	 *   Filesystems that refuse direct I/O fall back to buffered writes.
+	 * - File space is preallocated ahead of the write position (fallocate
+	 *   on Linux, the allocation size on Windows), so the filesystem doesn't
+	 *   fragment the file or allocate on every write.
+	 * - The header is rewritten every "header interval" with the sizes of
+	 *   the audio already on disk (after a data sync), so a crash or power
+	 *   loss leaves a playable file missing at most the last interval.
+	 *
+	 * WAV files switch to RF64 (EBU Tech 3306) when they outgrow 4 GiB: the
+	 * header reserves a JUNK chunk that becomes the ds64 chunk. All files
+	 * use WAVE_FORMAT_EXTENSIBLE.
+	 *
+	 * One thread calls open(), write() and close(); the I/O thread belongs
+	 * to the service.
+	 */
+	class PcmFileWriter
+	{
+	public:
+		/**
+		 * @brief Sample encoding in the file
+		 */
+		enum class Encoding
+		{
+			PCM16,
+			PCM24,
+			PCM32,
+			FLOAT32,
+			FLOAT64
+		};
+
+		/**
+		 * @brief Writer settings
+		 */
+		struct Options
+		{
+			bool rf64 = false;						 // Write RF64 from the start instead of on demand
+			bool directIo = false;					 // Bypass the page cache
+			size_t bufferBytes = 4 << 20;			 // Size of each write buffer (private service only)
+			int64_t preallocateBytes = 64ll << 20;	 // Space reserved ahead of the write position (0 = off)
+			double headerIntervalSeconds = 1.0;		 // Header patch interval (0 = only on close)
+		};
+
+		PcmFileWriter() = default;
+		~PcmFileWriter();
+
+		PcmFileWriter(const PcmFileWriter &) = delete;
+		PcmFileWriter &operator=(const PcmFileWriter &) = delete;
+
+		/**
+		 * @brief Map an FFmpeg PCM encoder name to an encoding
+		 *
+		 * @param codec "pcm_s16le", "pcm_s24le", "pcm_s32le", "pcm_f32le" or "pcm_f64le"
+		 * @param encoding Receives the encoding
+		 * @return true if the codec is one the writer handles
+		 */
+		static bool parseCodec(const std::string &codec, Encoding &encoding);
+
+		/**
+		 * @brief Create the file
+		 *
+		 * @param path File to create (truncated if it exists)
+		 * @param sampleRate Sample rate in Hz
+		 * @param channels Channel count
+		 * @param channelMask WAVE_FORMAT_EXTENSIBLE speaker mask (0 = unassigned)
+		 * @param encoding Sample encoding
+		 * @param options Writer settings
+		 * @param error Receives the reason on failure
+		 * @param service Shared I/O thread, or null for a private one
+		 * @return true if the file is open for writing
+		 */
+		bool open(const std::string &path, int sampleRate, int channels, uint32_t channelMask,
+				  Encoding encoding, const Options &options, std::string &error,
+				  PcmWriteService *service = nullptr);
+
+		/**
+		 * @brief Append a buffer
+		 *
+		 * Accepts planar or interleaved U8, S16, S32, float and double buffers.
+		 * The file's channels are taken from the buffer starting at
+		 * firstChannel, so a mono writer can record one track of a
+		 * multichannel stream. Waits only when every pooled buffer is still
+		 * queued for the disk.
+		 *
+		 * @param buffer Audio to append
+		 * @param firstChannel Buffer channel written as the file's first channel
+		 * @return false if the buffer has too few channels or a write failed
+		 */
+		bool write(const AudioBuffer &buffer, int firstChannel = 0);
+
+		/**
+		 * @brief Write the remaining audio, finalize the header and close the file
+		 *
+		 * @param error Receives the first write error, if any
+		 * @return true if everything was written
+		 */
+		bool close(std::string &error);
+
+		bool isOpen() const { return m_fd != INVALID_FD; }
+		bool isDirectIo() const { return m_directIo; }
+		const std::string &getPath() const { return m_path; }
+
+		/**
+		 * @brief Get the bytes per frame in the file (all channels)
+		 */
+		int getFrameSize() const { return m_frameSize; }
+
+		/**
+		 * @brief Get the number of frames accepted by write()
+		 */
+		int64_t getFramesWritten() const { return m_frames.load(std::memory_order_relaxed); }
+
+		/**
+		 * @brief Get the number of bytes on disk (header and written audio)
+		 */
+		int64_t getFileSize() const { return m_headerSize + m_diskBytes.load(std::memory_order_relaxed); }
+
+	private:
+		friend class PcmWriteService;
+
+#ifdef _WIN32
+		using Handle = void *;
+		static constexpr Handle INVALID_FD = nullptr;
+#else
+		using Handle = int;
+		static constexpr Handle INVALID_FD = -1;
+#endif
+
+		// Write buffers of a private service
+		static constexpr size_t BUFFER_COUNT = 2;
+
+		// File
+		std::string m_path;
+		Handle m_fd = INVALID_FD;		// Audio data (direct I/O when enabled)
+		Handle m_headerFd = INVALID_FD; // Header patches, always buffered
+		bool m_directIo = false;
+		Options m_options;
+
+		// Format
+		Encoding m_encoding = Encoding::PCM16;
+		int m_channels = 0;
+		int m_sampleRate = 0;
+		int m_sampleSize = 0;
+		int m_frameSize = 0;
+		std::vector<uint8_t> m_header;
+		int64_t m_headerSize = 0;
+
+		// Buffering
+		PcmWriteService *m_service = nullptr;
+		std::unique_ptr<PcmWriteService> m_ownService;
+		PcmWriteService::WriteBuffer *m_current = nullptr; // Buffer being filled
+		size_t m_pending = 0;							   // Queued jobs (guarded by the service mutex)
+		std::vector<uint8_t> m_scratch;					   // One converted input buffer
+
+		// Errors (first one wins)
+		std::mutex m_errorMutex;
+		std::string m_error;
+		std::atomic<bool> m_failed{false};
+
+		// Progress
+		std::atomic<int64_t> m_frames{0};
+		std::atomic<int64_t> m_diskBytes{0}; // Audio bytes written by the I/O thread
+		int64_t m_allocatedUntil = 0;					 // I/O thread
+		std::chrono::steady_clock::time_point m_lastPatch; // I/O thread
+
+		bool createFile(const std::string &path, std::string &error);
+		void closeHandles();
+		void buildHeader(uint32_t channelMask);
+		void updateHeader(int64_t dataBytes, int64_t frames);
+		bool patchHeader(int64_t dataBytes, int64_t frames);
+		void append(const uint8_t *data, size_t bytes);
+		void flushPartial();
+		void writeBuffer(PcmWriteService::WriteBuffer &buffer, bool last);
+		bool finalize(std::string &error);
+		bool writeAt(Handle fd, const uint8_t *data, size_t bytes, int64_t offset);
+		void preallocate(int64_t end);
+		bool sync();
+		bool truncate(int64_t size);
+		void fail(const std::string &message);
+	};
+
+} // namespace AudioEngine
@@ -0,0 +1,241 @@
+#include "PerformanceMonitor.h"
+#include <algorithm>
+#include <limits>
+
+namespace AudioEngine
+{
+
+	void PerformanceMonitor::configure(const std::vector<std::string> &stepNames, double sampleRate, long bufferSize)
+	{
+		m_stepNames = stepNames;
+		m_stepCount = stepNames.size();
+		m_steps.reset(m_stepCount > 0 ? new StepCounters[m_stepCount] : nullptr);
+		m_budgetNs = sampleRate > 0.0 ? static_cast<int64_t>(bufferSize * 1e9 / sampleRate) : 0;
+		m_resetRequested.store(false, std::memory_order_relaxed);
+		clear();
+	}
+
+	void PerformanceMonitor::clear()
+	{
+		for (size_t i = 0; i < m_stepCount; i++)
+		{
+			StepCounters &step = m_steps[i];
+			step.calls.store(0, std::memory_order_relaxed);
+			step.sumNs.store(0, std::memory_order_relaxed);
+			step.maxNs.store(0, std::memory_order_relaxed);
+			step.lastNs.store(0, std::memory_order_relaxed);
+			step.lastBlock.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+			for (auto &bin : step.histogram)
+			{
+				bin.store(0, std::memory_order_relaxed);
+			}
+		}
+
+		m_blocks.store(0, std::memory_order_relaxed);
+		m_xruns.store(0, std::memory_order_relaxed);
+		m_blockSumNs.store(0, std::memory_order_relaxed);
+		m_blockMinNs.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+		m_blockMaxNs.store(0, std::memory_order_relaxed);
+		m_lastBlockNs.store(0, std::memory_order_relaxed);
+		for (auto &bin : m_blockHistogram)
+		{
+			bin.store(0, std::memory_order_relaxed);
+		}
+
+		for (auto &slot : m_trace)
+		{
+			slot.sequence.store(0, std::memory_order_relaxed);
+		}
+		m_traceWrite.store(0, std::memory_order_release);
+	}
+
+	size_t PerformanceMonitor::histogramBin(int64_t durationNs)
+	{
+		uint64_t us = durationNs > 0 ? static_cast<uint64_t>(durationNs / 1000) : 0;
+		size_t bin = 0;
+		while (us != 0 && bin < PerformanceStats::HISTOGRAM_BINS - 1)
+		{
+			us >>= 1;
+			bin++;
+		}
+		return bin;
+	}
+
+	void PerformanceMonitor::recordStep(size_t stepIndex, int64_t durationNs)
+	{
+		if (stepIndex >= m_stepCount)
+		{
+			return;
+		}
+
+		StepCounters &step = m_steps[stepIndex];
+		increment(step.calls);
+		increment(step.sumNs, static_cast<uint64_t>(durationNs));
+		if (durationNs > step.maxNs.load(std::memory_order_relaxed))
+		{
+			step.maxNs.store(durationNs, std::memory_order_relaxed);
+		}
+		step.lastNs.store(durationNs, std::memory_order_relaxed);
+		step.lastBlock.store(m_blocks.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		increment(step.histogram[histogramBin(durationNs)]);
+	}
+
+	void PerformanceMonitor::recordBlock(int64_t durationNs)
+	{
+		const uint64_t block = m_blocks.load(std::memory_order_relaxed);
+		const bool xrun = m_budgetNs > 0 && durationNs > m_budgetNs;
+		const bool worst = durationNs > m_blockMaxNs.load(std::memory_order_relaxed);
+
+		increment(m_blockSumNs, static_cast<uint64_t>(durationNs));
+		if (durationNs < m_blockMinNs.load(std::memory_order_relaxed))
+		{
+			m_blockMinNs.store(durationNs, std::memory_order_relaxed);
+		}
+		if (worst)
+		{
+			m_blockMaxNs.store(durationNs, std::memory_order_relaxed);
+		}
+		m_lastBlockNs.store(durationNs, std::memory_order_relaxed);
+		increment(m_blockHistogram[histogramBin(durationNs)]);
+
+		if (xrun)
+		{
+			increment(m_xruns);
+		}
+
+		if (xrun || worst)
+		{
+			writeTrace(block, durationNs);
+		}
+
+		// Publishing the count last starts the next block for recordStep()
+		m_blocks.store(block + 1, std::memory_order_relaxed);
+
+		// A requested reset is applied here, between blocks, by the only writer
+		if (m_resetRequested.load(std::memory_order_relaxed) && m_resetRequested.exchange(false, std::memory_order_acquire))
+		{
+			clear();
+		}
+	}
+
+	void PerformanceMonitor::writeTrace(uint64_t block, int64_t durationNs)
+	{
+		// Find the node that dominated this block
+		uint32_t slowest = 0;
+		int64_t slowestNs = -1;
+		for (size_t i = 0; i < m_stepCount; i++)
+		{
+			const StepCounters &step = m_steps[i];
+			if (step.lastBlock.load(std::memory_order_relaxed) != block)
+			{
+				continue;
+			}
+			const int64_t ns = step.lastNs.load(std::memory_order_relaxed);
+			if (ns > slowestNs)
+			{
+				slowestNs = ns;
+				slowest = static_cast<uint32_t>(i);
+			}
+		}
+
+		const uint64_t index = m_traceWrite.load(std::memory_order_relaxed);
+		TraceSlot &slot = m_trace[index % TRACE_CAPACITY];
+
+		// Seqlock write: odd while the fields are inconsistent
+		const uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+		slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.block.store(block, std::memory_order_relaxed);
+		slot.durationNs.store(durationNs, std::memory_order_relaxed);
+		slot.slowestStep.store(slowestNs >= 0 ? slowest : std::numeric_limits<uint32_t>::max(), std::memory_order_relaxed);
+		slot.slowestStepNs.store(std::max<int64_t>(slowestNs, 0), std::memory_order_relaxed);
+		slot.sequence.store(sequence + 2, std::memory_order_release);
+
+		m_traceWrite.store(index + 1, std::memory_order_release);
+	}
+
+	PerformanceStats PerformanceMonitor::getStats() const
+	{
+		PerformanceStats stats{};
+		stats.budgetUs = m_budgetNs / 1000.0;
+		stats.blocks = m_blocks.load(std::memory_order_relaxed);
+		stats.xruns = m_xruns.load(std::memory_order_relaxed);
+		stats.lastBlockUs = m_lastBlockNs.load(std::memory_order_relaxed) / 1000.0;
+
+		if (stats.blocks > 0)
+		{
+			stats.blockMinUs = m_blockMinNs.load(std::memory_order_relaxed) / 1000.0;
+			stats.blockMaxUs = m_blockMaxNs.load(std::memory_order_relaxed) / 1000.0;
+			stats.blockMeanUs = m_blockSumNs.load(std::memory_order_relaxed) / 1000.0 / static_cast<double>(stats.blocks);
+		}
+
+		if (stats.budgetUs > 0.0)
+		{
+			stats.loadPercent = 100.0 * stats.blockMeanUs / stats.budgetUs;
+			stats.peakLoadPercent = 100.0 * stats.blockMaxUs / stats.budgetUs;
+		}
+
+		for (size_t i = 0; i < PerformanceStats::HISTOGRAM_BINS; i++)
+		{
+			stats.blockHistogram[i] = m_blockHistogram[i].load(std::memory_order_relaxed);
+		}
+
+		stats.nodes.reserve(m_stepCount);
+		for (size_t i = 0; i < m_stepCount; i++)
+		{
+			const StepCounters &step = m_steps[i];
+			PerformanceStats::NodeStats node{};
+			node.name = m_stepNames[i];
+			node.calls = step.calls.load(std::memory_order_relaxed);
+			node.maxUs = step.maxNs.load(std::memory_order_relaxed) / 1000.0;
+			node.lastUs = step.lastNs.load(std::memory_order_relaxed) / 1000.0;
+			if (node.calls > 0)
+			{
+				node.meanUs = step.sumNs.load(std::memory_order_relaxed) / 1000.0 / static_cast<double>(node.calls);
+			}
+			for (size_t b = 0; b < PerformanceStats::HISTOGRAM_BINS; b++)
+			{
+				node.histogram[b] = step.histogram[b].load(std::memory_order_relaxed);
+			}
+			stats.nodes.push_back(std::move(node));
+		}
+
+		// Copy every consistent trace entry; entries being rewritten are skipped
+		for (const auto &slot : m_trace)
+		{
+			const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+			if (before == 0 || (before & 1) != 0)
+			{
+				continue;
+			}
+
+			PerformanceStats::BlockTrace trace{};
+			trace.block = slot.block.load(std::memory_order_relaxed);
+			const int64_t durationNs = slot.durationNs.load(std::memory_order_relaxed);
+			const uint32_t slowestStep = slot.slowestStep.load(std::memory_order_relaxed);
+			const int64_t slowestStepNs = slot.slowestStepNs.load(std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) != before)
+			{
+				continue;
+			}
+
+			trace.durationUs = durationNs / 1000.0;
+			trace.xrun = m_budgetNs > 0 && durationNs > m_budgetNs;
+			if (slowestStep < m_stepCount)
+			{
+				trace.slowestNode = m_stepNames[slowestStep];
+				trace.slowestNodeUs = slowestStepNs / 1000.0;
+			}
+			stats.worstBlocks.push_back(std::move(trace));
+		}
+
+		std::sort(stats.worstBlocks.begin(), stats.worstBlocks.end(),
+				  [](const PerformanceStats::BlockTrace &a, const PerformanceStats::BlockTrace &b)
+				  { return a.durationUs > b.durationUs; });
+
+		return stats;
+	}
+
+} // namespace AudioEngine
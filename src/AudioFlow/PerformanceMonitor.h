@@ -0,0 +1,206 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief Snapshot of the engine's processing-time counters
+	 *
+	 * Histograms use log2 microsecond bins: bin 0 counts durations under 1 us,
+	 * bin i counts [2^(i-1), 2^i) us and the last bin everything above.
+	 */
+	struct PerformanceStats
+	{
+		static constexpr size_t HISTOGRAM_BINS = 20;
+		using Histogram = std::array<uint64_t, HISTOGRAM_BINS>;
+
+		/**
+		 * @brief Processing time of one node
+		 */
+		struct NodeStats
+		{
+			std::string name;
+			uint64_t calls;
+			double meanUs;
+			double maxUs;
+			double lastUs;
+			Histogram histogram;
+		};
+
+		/**
+		 * @brief A block kept by the worst-case trace
+		 */
+		struct BlockTrace
+		{
+			uint64_t block;			 // Block number since the counters were reset
+			double durationUs;		 // Wall time of the whole block
+			bool xrun;				 // Block exceeded its budget
+			std::string slowestNode; // Node with the longest process time in the block
+			double slowestNodeUs;
+		};
+
+		double budgetUs;		// bufferSize / sampleRate
+		uint64_t blocks;		// Blocks processed
+		uint64_t xruns;			// Blocks that took longer than the budget
+		double blockMinUs;
+		double blockMeanUs;
+		double blockMaxUs;
+		double lastBlockUs;
+		double loadPercent;		// Mean block time relative to the budget
+		double peakLoadPercent; // Worst block time relative to the budget
+		Histogram blockHistogram;
+		std::vector<NodeStats> nodes;		 // In execution plan order
+		std::vector<BlockTrace> worstBlocks; // Slowest traced blocks first
+	};
+
+	/**
+	 * @brief Lock-free block and node timing for the audio callback
+	 *
+	 * The audio thread (and graph workers) record durations with relaxed atomic
+	 * stores; every counter has a single writer at a time because each step runs
+	 * on one thread per block and blocks are serialized by the scheduler's
+	 * barrier. Readers take snapshots without blocking the writers.
+	 *
+	 * Blocks that miss their deadline or set a new maximum are written to a
+	 * small trace ring together with the slowest node of that block, so the
+	 * cause of a worst case survives after the counters have moved on.
+	 */
+	class PerformanceMonitor
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		static constexpr size_t TRACE_CAPACITY = 32;
+
+		PerformanceMonitor() = default;
+
+		PerformanceMonitor(const PerformanceMonitor &) = delete;
+		PerformanceMonitor &operator=(const PerformanceMonitor &) = delete;
+
+		/**
+		 * @brief Size the counters for a plan and reset them
+		 *
+		 * Not real-time safe; call while no block is running.
+		 *
+		 * @param stepNames Node name of each plan step, in plan order
+		 * @param sampleRate Sample rate in Hz
+		 * @param bufferSize Frames per block
+		 */
+		void configure(const std::vector<std::string> &stepNames, double sampleRate, long bufferSize);
+
+		/**
+		 * @brief Request that all counters and the trace be zeroed
+		 *
+		 * May be called from any thread. The counters have a single writer, so
+		 * the writer clears them itself at the end of the next recordBlock();
+		 * until then snapshots still show the old values.
+		 */
+		void reset() { m_resetRequested.store(true, std::memory_order_release); }
+
+		/**
+		 * @brief Read the monotonic clock
+		 */
+		static Clock::time_point now() { return Clock::now(); }
+
+		/**
+		 * @brief Elapsed nanoseconds since a time point
+		 */
+		static int64_t elapsedNs(Clock::time_point start)
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+		}
+
+		/**
+		 * @brief Record the process time of one step
+		 *
+		 * @param stepIndex Position in the plan's step list
+		 * @param durationNs Process time in nanoseconds
+		 */
+		void recordStep(size_t stepIndex, int64_t durationNs);
+
+		/**
+		 * @brief Record the duration of a whole block
+		 *
+		 * Call after every step of the block has been recorded.
+		 *
+		 * @param durationNs Block time in nanoseconds
+		 */
+		void recordBlock(int64_t durationNs);
+
+		/**
+		 * @brief Get a snapshot of the counters
+		 *
+		 * @return Current statistics
+		 */
+		PerformanceStats getStats() const;
+
+		/**
+		 * @brief Get the per-block time budget in nanoseconds
+		 */
+		int64_t getBudgetNs() const { return m_budgetNs; }
+
+	private:
+		using AtomicHistogram = std::array<std::atomic<uint64_t>, PerformanceStats::HISTOGRAM_BINS>;
+
+		struct alignas(64) StepCounters
+		{
+			std::atomic<uint64_t> calls{0};
+			std::atomic<uint64_t> sumNs{0};
+			std::atomic<int64_t> maxNs{0};
+			std::atomic<int64_t> lastNs{0};
+			std::atomic<uint64_t> lastBlock{0}; // Block the last sample belongs to
+			AtomicHistogram histogram{};
+		};
+
+		/**
+		 * @brief Trace ring entry guarded by a sequence counter
+		 *
+		 * Odd sequence values mark an entry being written; readers retry or skip.
+		 */
+		struct TraceSlot
+		{
+			std::atomic<uint64_t> sequence{0};
+			std::atomic<uint64_t> block{0};
+			std::atomic<int64_t> durationNs{0};
+			std::atomic<uint32_t> slowestStep{0};
+			std::atomic<int64_t> slowestStepNs{0};
+		};
+
+		static size_t histogramBin(int64_t durationNs);
+		static void increment(std::atomic<uint64_t> &counter, uint64_t value = 1)
+		{
+			counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		}
+
+		void writeTrace(uint64_t block, int64_t durationNs);
+		void clear();
+
+		std::vector<std::string> m_stepNames;
+		std::unique_ptr<StepCounters[]> m_steps;
+		size_t m_stepCount = 0;
+		int64_t m_budgetNs = 0;
+
+		// Written by the thread running the block
+		std::atomic<uint64_t> m_blocks{0};
+		std::atomic<uint64_t> m_xruns{0};
+		std::atomic<uint64_t> m_blockSumNs{0};
+		std::atomic<int64_t> m_blockMinNs{0};
+		std::atomic<int64_t> m_blockMaxNs{0};
+		std::atomic<int64_t> m_lastBlockNs{0};
+		AtomicHistogram m_blockHistogram{};
+
+		std::array<TraceSlot, TRACE_CAPACITY> m_trace;
+		std::atomic<uint64_t> m_traceWrite{0};
+
+		std::atomic<bool> m_resetRequested{false};
+	};
+
+} // namespace AudioEngine
@@ -0,0 +1,977 @@
+#include "SampleConverter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SAMPLE_CONVERTER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define SAMPLE_CONVERTER_X86 0
+#endif
+
+// GCC and Clang need per-function ISA targets; MSVC always accepts the intrinsics
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SAMPLE_CONVERTER_TARGET(isa)
+#else
+#define SAMPLE_CONVERTER_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace AudioEngine
+{
+
+	namespace
+	{
+		// ASIO sample types (see asio.h)
+		constexpr long ASIO_ST_INT16_LSB = 16;
+		constexpr long ASIO_ST_INT24_LSB = 17;
+		constexpr long ASIO_ST_INT32_LSB = 18;
+		constexpr long ASIO_ST_FLOAT32_LSB = 19;
+		constexpr long ASIO_ST_FLOAT64_LSB = 20;
+
+		// Table indices
+		enum AsioIndex
+		{
+			ASIO_I16,
+			ASIO_I24,
+			ASIO_I32,
+			ASIO_F32,
+			ASIO_F64,
+			ASIO_TYPE_COUNT
+		};
+
+		enum EngineIndex
+		{
+			ENGINE_FLT,
+			ENGINE_DBL,
+			ENGINE_S32,
+			ENGINE_S16,
+			ENGINE_TYPE_COUNT
+		};
+
+		constexpr int ASIO_SAMPLE_SIZE[ASIO_TYPE_COUNT] = {2, 3, 4, 4, 8};
+		constexpr int ENGINE_SAMPLE_SIZE[ENGINE_TYPE_COUNT] = {4, 8, 4, 2};
+
+		int asioIndex(long asioType)
+		{
+			switch (asioType)
+			{
+			case ASIO_ST_INT16_LSB:
+				return ASIO_I16;
+			case ASIO_ST_INT24_LSB:
+				return ASIO_I24;
+			case ASIO_ST_INT32_LSB:
+				return ASIO_I32;
+			case ASIO_ST_FLOAT32_LSB:
+				return ASIO_F32;
+			case ASIO_ST_FLOAT64_LSB:
+				return ASIO_F64;
+			default:
+				return -1;
+			}
+		}
+
+		int engineIndex(AVSampleFormat format)
+		{
+			switch (format)
+			{
+			case AV_SAMPLE_FMT_FLT:
+			case AV_SAMPLE_FMT_FLTP:
+				return ENGINE_FLT;
+			case AV_SAMPLE_FMT_DBL:
+			case AV_SAMPLE_FMT_DBLP:
+				return ENGINE_DBL;
+			case AV_SAMPLE_FMT_S32:
+			case AV_SAMPLE_FMT_S32P:
+				return ENGINE_S32;
+			case AV_SAMPLE_FMT_S16:
+			case AV_SAMPLE_FMT_S16P:
+				return ENGINE_S16;
+			default:
+				return -1;
+			}
+		}
+
+		//--------------------------------------------------------------------------
+		// Scalar reference kernels: every sample goes through a normalized double,
+		// which is exact for all supported integer widths
+		//--------------------------------------------------------------------------
+
+		inline double quantize(double scaled, double lo, double hi)
+		{
+			return std::nearbyint(std::min(std::max(scaled, lo), hi));
+		}
+
+		inline uint32_t nextRandom(uint32_t &state)
+		{
+			// xorshift32
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		}
+
+		inline double tpdfNoise(uint32_t &state)
+		{
+			// Difference of two uniforms: triangular in (-1, 1) LSB
+			const double scale = 1.0 / 4294967296.0;
+			double a = nextRandom(state) * scale;
+			double b = nextRandom(state) * scale;
+			return a - b;
+		}
+
+		template <int A>
+		inline double readAsio(const uint8_t *p)
+		{
+			if constexpr (A == ASIO_I16)
+			{
+				int16_t v;
+				std::memcpy(&v, p, sizeof(v));
+				return v / 32768.0;
+			}
+			else if constexpr (A == ASIO_I24)
+			{
+				int32_t v = static_cast<int32_t>(static_cast<uint32_t>(p[0]) << 8 |
+												 static_cast<uint32_t>(p[1]) << 16 |
+												 static_cast<uint32_t>(p[2]) << 24) >>
+							8;
+				return v / 8388608.0;
+			}
+			else if constexpr (A == ASIO_I32)
+			{
+				int32_t v;
+				std::memcpy(&v, p, sizeof(v));
+				return v / 2147483648.0;
+			}
+			else if constexpr (A == ASIO_F32)
+			{
+				float v;
+				std::memcpy(&v, p, sizeof(v));
+				return v;
+			}
+			else
+			{
+				double v;
+				std::memcpy(&v, p, sizeof(v));
+				return v;
+			}
+		}
+
+		template <int A>
+		inline void writeAsio(uint8_t *p, double x, bool clip, double noise)
+		{
+			if constexpr (A == ASIO_I16)
+			{
+				int16_t v = static_cast<int16_t>(quantize(x * 32768.0 + noise, -32768.0, 32767.0));
+				std::memcpy(p, &v, sizeof(v));
+			}
+			else if constexpr (A == ASIO_I24)
+			{
+				int32_t v = static_cast<int32_t>(quantize(x * 8388608.0 + noise, -8388608.0, 8388607.0));
+				p[0] = static_cast<uint8_t>(v);
+				p[1] = static_cast<uint8_t>(v >> 8);
+				p[2] = static_cast<uint8_t>(v >> 16);
+			}
+			else if constexpr (A == ASIO_I32)
+			{
+				int32_t v = static_cast<int32_t>(quantize(x * 2147483648.0, -2147483648.0, 2147483647.0));
+				std::memcpy(p, &v, sizeof(v));
+			}
+			else if constexpr (A == ASIO_F32)
+			{
+				float v = static_cast<float>(clip ? std::min(std::max(x, -1.0), 1.0) : x);
+				std::memcpy(p, &v, sizeof(v));
+			}
+			else
+			{
+				double v = clip ? std::min(std::max(x, -1.0), 1.0) : x;
+				std::memcpy(p, &v, sizeof(v));
+			}
+		}
+
+		template <int E>
+		inline double readEngine(const uint8_t *p)
+		{
+			if constexpr (E == ENGINE_FLT)
+			{
+				float v;
+				std::memcpy(&v, p, sizeof(v));
+				return v;
+			}
+			else if constexpr (E == ENGINE_DBL)
+			{
+				double v;
+				std::memcpy(&v, p, sizeof(v));
+				return v;
+			}
+			else if constexpr (E == ENGINE_S32)
+			{
+				int32_t v;
+				std::memcpy(&v, p, sizeof(v));
+				return v / 2147483648.0;
+			}
+			else
+			{
+				int16_t v;
+				std::memcpy(&v, p, sizeof(v));
+				return v / 32768.0;
+			}
+		}
+
+		template <int E>
+		inline void writeEngine(uint8_t *p, double x)
+		{
+			if constexpr (E == ENGINE_FLT)
+			{
+				float v = static_cast<float>(x);
+				std::memcpy(p, &v, sizeof(v));
+			}
+			else if constexpr (E == ENGINE_DBL)
+			{
+				std::memcpy(p, &x, sizeof(x));
+			}
+			else if constexpr (E == ENGINE_S32)
+			{
+				int32_t v = static_cast<int32_t>(quantize(x * 2147483648.0, -2147483648.0, 2147483647.0));
+				std::memcpy(p, &v, sizeof(v));
+			}
+			else
+			{
+				int16_t v = static_cast<int16_t>(quantize(x * 32768.0, -32768.0, 32767.0));
+				std::memcpy(p, &v, sizeof(v));
+			}
+		}
+
+		template <int A, int E>
+		void inputScalar(const void *asio, uint8_t *dest, long frames, ptrdiff_t destStride)
+		{
+			const uint8_t *src = static_cast<const uint8_t *>(asio);
+			const ptrdiff_t step = destStride * ENGINE_SAMPLE_SIZE[E];
+			for (long i = 0; i < frames; i++)
+			{
+				writeEngine<E>(dest + i * step, readAsio<A>(src + i * ASIO_SAMPLE_SIZE[A]));
+			}
+		}
+
+		template <int A, int E>
+		void outputScalar(const uint8_t *src, ptrdiff_t srcStride, void *asio, long frames,
+						  const SampleConverter::Options &options, uint32_t &ditherState)
+		{
+			constexpr bool canDither = (E == ENGINE_FLT || E == ENGINE_DBL) && (A == ASIO_I16 || A == ASIO_I24);
+			const bool dither = canDither && options.dither;
+
+			uint8_t *dest = static_cast<uint8_t *>(asio);
+			const ptrdiff_t step = srcStride * ENGINE_SAMPLE_SIZE[E];
+			for (long i = 0; i < frames; i++)
+			{
+				double noise = dither ? tpdfNoise(ditherState) : 0.0;
+				writeAsio<A>(dest + i * ASIO_SAMPLE_SIZE[A], readEngine<E>(src + i * step), options.clip, noise);
+			}
+		}
+
+#define SAMPLE_CONVERTER_ROW(kernel, A) \
+	{kernel<A, ENGINE_FLT>, kernel<A, ENGINE_DBL>, kernel<A, ENGINE_S32>, kernel<A, ENGINE_S16>}
+
+		const SampleConverter::InputKernel INPUT_SCALAR[ASIO_TYPE_COUNT][ENGINE_TYPE_COUNT] = {
+			SAMPLE_CONVERTER_ROW(inputScalar, ASIO_I16),
+			SAMPLE_CONVERTER_ROW(inputScalar, ASIO_I24),
+			SAMPLE_CONVERTER_ROW(inputScalar, ASIO_I32),
+			SAMPLE_CONVERTER_ROW(inputScalar, ASIO_F32),
+			SAMPLE_CONVERTER_ROW(inputScalar, ASIO_F64)};
+
+		const SampleConverter::OutputKernel OUTPUT_SCALAR[ASIO_TYPE_COUNT][ENGINE_TYPE_COUNT] = {
+			SAMPLE_CONVERTER_ROW(outputScalar, ASIO_I16),
+			SAMPLE_CONVERTER_ROW(outputScalar, ASIO_I24),
+			SAMPLE_CONVERTER_ROW(outputScalar, ASIO_I32),
+			SAMPLE_CONVERTER_ROW(outputScalar, ASIO_F32),
+			SAMPLE_CONVERTER_ROW(outputScalar, ASIO_F64)};
+
+#undef SAMPLE_CONVERTER_ROW
+
+		// Same-format float paths are plain copies at every SIMD level
+		void inputCopyFloat(const void *asio, uint8_t *dest, long frames, ptrdiff_t destStride)
+		{
+			if (destStride != 1)
+			{
+				inputScalar<ASIO_F32, ENGINE_FLT>(asio, dest, frames, destStride);
+				return;
+			}
+			std::memcpy(dest, asio, static_cast<size_t>(frames) * sizeof(float));
+		}
+
+		/**
+		 * @brief Vectorized kernels for float engine data (the engine's native format)
+		 *
+		 * Entries left null fall back to the scalar table.
+		 */
+		struct SimdKernels
+		{
+			SampleConverter::InputKernel input[ASIO_TYPE_COUNT];
+			SampleConverter::OutputKernel output[ASIO_TYPE_COUNT];
+		};
+
+#if SAMPLE_CONVERTER_X86
+
+		//--------------------------------------------------------------------------
+		// SSE2 (Int24 packing/unpacking uses SSSE3 pshufb)
+		//--------------------------------------------------------------------------
+
+		SAMPLE_CONVERTER_TARGET("sse2")
+		inline __m128i nextRandom4(__m128i &state)
+		{
+			state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+			state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+			state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+			return state;
+		}
+
+		SAMPLE_CONVERTER_TARGET("sse2")
+		inline __m128 tpdfNoise4(__m128i &state)
+		{
+			// Top 23 bits as mantissa of a float in [1, 2)
+			const __m128i one = _mm_set1_epi32(0x3F800000);
+			__m128 a = _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(nextRandom4(state), 9), one));
+			__m128 b = _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(nextRandom4(state), 9), one));
+			return _mm_sub_ps(a, b);
+		}
+
+		inline void seedLanes(uint32_t &state, uint32_t *lanes, int count)
+		{
+			if (state == 0)
+			{
+				state = 0x9E3779B9u;
+			}
+			for (int i = 0; i < count; i++)
+			{
+				lanes[i] = nextRandom(state);
+			}
+		}
+
+		SAMPLE_CONVERTER_TARGET("sse2")
+		void inputI16ToFloatSse2(const void *asio, uint8_t *dest, long frames, ptrdiff_t destStride)
+		{
+			if (destStride != 1)
+			{
+				inputScalar<ASIO_I16, ENGINE_FLT>(asio, dest, frames, destStride);
+				return;
+			}
+
+			const int16_t *src = static_cast<const int16_t *>(asio);
+			float *out = reinterpret_cast<float *>(dest);
+			const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+			const __m128i zero = _mm_setzero_si128();
+
+			long i = 0;
+			for (; i + 8 <= frames; i += 8)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+				// Interleaving with zero puts each sample in the top half of an int32
+				_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(zero, v)), scale));
+				_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(zero, v)), scale));
+			}
+			inputScalar<ASIO_I16, ENGINE_FLT>(src + i, dest + i * sizeof(float), frames - i, 1);
+		}
+
+		SAMPLE_CONVERTER_TARGET("ssse3")
+		void inputI24ToFloatSsse3(const void *asio, uint8_t *dest, long frames, ptrdiff_t destStride)
+		{
+			if (destStride != 1)
+			{
+				inputScalar<ASIO_I24, ENGINE_FLT>(asio, dest, frames, destStride);
+				return;
+			}
+
+			const uint8_t *src = static_cast<const uint8_t *>(asio);
+			float *out = reinterpret_cast<float *>(dest);
+			const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+			// Move each 3-byte sample into the top three bytes of an int32
+			const __m128i unpack = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+
+			long i = 0;
+			// A 16-byte load covers 4 samples plus 4 bytes of the next ones
+			for (; i + 6 <= frames; i += 4)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 3));
+				_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_shuffle_epi8(v, unpack)), scale));
+			}
+			inputScalar<ASIO_I24, ENGINE_FLT>(src + i * 3, dest + i * sizeof(float), frames - i, 1);
+		}
+
+		SAMPLE_CONVERTER_TARGET("sse2")
+		void inputI32ToFloatSse2(const void *asio, uint8_t *dest, long frames, ptrdiff_t destStride)
+		{
+			if (destStride != 1)
+			{
+				inputScalar<ASIO_I32, ENGINE_FLT>(asio, dest, frames, destStride);
+				return;
+			}
+
+			const int32_t *src = static_cast<const int32_t *>(asio);
+			float *out = reinterpret_cast<float *>(dest);
+			const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+
+			long i = 0;
+			for (; i + 8 <= frames; i += 8)
+			{
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 4));
+				_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(a), scale));
+				_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), scale));
+			}
+			inputScalar<ASIO_I32, ENGINE_FLT>(src + i, dest + i * sizeof(float), frames - i, 1);
+		}
+
+		SAMPLE_CONVERTER_TARGET("sse2")
+		void outputFloatToI16Sse2(const uint8_t *src, ptrdiff_t srcStride, void *asio, long frames,
+								  const SampleConverter::Options &options, uint32_t &ditherState)
+		{
+			if (srcStride != 1)
+			{
+				outputScalar<ASIO_I16, ENGINE_FLT>(src, srcStride, asio, frames, options, ditherState);
+				return;
+			}
+
+			const float *in = reinterpret_cast<const float *>(src);
+			int16_t *out = static_cast<int16_t *>(asio);
+			const __m128 scale = _mm_set1_ps(32768.0f);
+			const __m128 lo = _mm_set1_ps(-32768.0f);
+			const __m128 hi = _mm_set1_ps(32767.0f);
+
+			alignas(16) uint32_t lanes[4];
+			seedLanes(ditherState, lanes, 4);
+			__m128i random = _mm_load_si128(reinterpret_cast<const __m128i *>(lanes));
+
+			long i = 0;
+			for (; i + 8 <= frames; i += 8)
+			{
+				__m128 a = _mm_mul_ps(_mm_loadu_ps(in + i), scale);
+				__m128 b = _mm_mul_ps(_mm_loadu_ps(in + i + 4), scale);
+				if (options.dither)
+				{
+					a = _mm_add_ps(a, tpdfNoise4(random));
+					b = _mm_add_ps(b, tpdfNoise4(random));
+				}
+				a = _mm_min_ps(_mm_max_ps(a, lo), hi);
+				b = _mm_min_ps(_mm_max_ps(b, lo), hi);
+				__m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), packed);
+			}
+
+			ditherState = static_cast<uint32_t>(_mm_cvtsi128_si32(random)) | 1u;
+			outputScalar<ASIO_I16, ENGINE_FLT>(src + i * sizeof(float), 1, out + i, frames - i, options, ditherState);
+		}
+
+		SAMPLE_CONVERTER_TARGET("ssse3")
+		inline void storeInt24x4(uint8_t *dest, __m128i samples)
+		{
+			const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+			__m128i packed = _mm_shuffle_epi8(samples, pack);
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(dest), packed);
+			int32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+			std::memcpy(dest + 8, &tail, sizeof(tail));
+		}
+
+		SAMPLE_CONVERTER_TARGET("ssse3")
+		void outputFloatToI24Ssse3(const uint8_t *src, ptrdiff_t srcStride, void *asio, long frames,
+								   const SampleConverter::Options &options, uint32_t &ditherState)
+		{
+			if (srcStride != 1)
+			{
+				outputScalar<ASIO_I24, ENGINE_FLT>(src, srcStride, asio, frames, options, ditherState);
+				return;
+			}
+
+			const float *in = reinterpret_cast<const float *>(src);
+			uint8_t *out = static_cast<uint8_t *>(asio);
+			const __m128 scale = _mm_set1_ps(8388608.0f);
+			const __m128 lo = _mm_set1_ps(-8388608.0f);
+			const __m128 hi = _mm_set1_ps(8388607.0f);
+
+			alignas(16) uint32_t lanes[4];
+			seedLanes(ditherState, lanes, 4);
+			__m128i random = _mm_load_si128(reinterpret_cast<const __m128i *>(lanes));
+
+			long i = 0;
+			for (; i + 4 <= frames; i += 4)
+			{
+				__m128 x = _mm_mul_ps(_mm_loadu_ps(in + i), scale);
+				if (options.dither)
+				{
+					x = _mm_add_ps(x, tpdfNoise4(random));
+				}
+				x = _mm_min_ps(_mm_max_ps(x, lo), hi);
+				storeInt24x4(out + i * 3, _mm_cvtps_epi32(x));
+			}
+
+			ditherState = static_cast<uint32_t>(_mm_cvtsi128_si32(random)) | 1u;
+			outputScalar<ASIO_I24, ENGINE_FLT>(src + i * sizeof(float), 1, out + i * 3, frames - i, options, ditherState);
+		}
+
+		SAMPLE_CONVERTER_TARGET("sse2")
+		void outputFloatToI32Sse2(const uint8_t *src, ptrdiff_t srcStride, void *asio, long frames,
+								  const SampleConverter::Options &options, uint32_t &ditherState)
+		{
+			if (srcStride != 1)
+			{
+				outputScalar<ASIO_I32, ENGINE_FLT>(src, srcStride, asio, frames, options, ditherState);
+				return;
+			}
+
+			const float *in = reinterpret_cast<const float *>(src);
+			int32_t *out = static_cast<int32_t *>(asio);
+			const __m128 scale = _mm_set1_ps(2147483648.0f);
+
+			long i = 0;
+			for (; i + 4 <= frames; i += 4)
+			{
+				__m128 x = _mm_mul_ps(_mm_loadu_ps(in + i), scale);
+				// cvtps yields 0x80000000 on positive overflow; flip those lanes to INT32_MAX
+				__m128i overflow = _mm_castps_si128(_mm_cmpge_ps(x, scale));
+				__m128i v = _mm_xor_si128(_mm_cvtps_epi32(x), overflow);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), v);
+			}
+			outputScalar<ASIO_I32, ENGINE_FLT>(src + i * sizeof(float), 1, out + i, frames - i, options, ditherState);
+		}
+
+		SAMPLE_CONVERTER_TARGET("sse2")
+		void outputFloatToF32Sse2(const uint8_t *src, ptrdiff_t srcStride, void *asio, long frames,
+								  const SampleConverter::Options &options, uint32_t &ditherState)
+		{
+			if (srcStride != 1)
+			{
+				outputScalar<ASIO_F32, ENGINE_FLT>(src, srcStride, asio, frames, options, ditherState);
+				return;
+			}
+
+			if (!options.clip)
+			{
+				std::memcpy(asio, src, static_cast<size_t>(frames) * sizeof(float));
+				return;
+			}
+
+			const float *in = reinterpret_cast<const float *>(src);
+			float *out = static_cast<float *>(asio);
+			const __m128 lo = _mm_set1_ps(-1.0f);
+			const __m128 hi = _mm_set1_ps(1.0f);
+
+			long i = 0;
+			for (; i + 4 <= frames; i += 4)
+			{
+				_mm_storeu_ps(out + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), lo), hi));
+			}
+			outputScalar<ASIO_F32, ENGINE_FLT>(src + i * sizeof(float), 1, out + i, frames - i, options, ditherState);
+		}
+
+		const SimdKernels SSE2_KERNELS = {
+			{inputI16ToFloatSse2, inputI24ToFloatSsse3, inputI32ToFloatSse2, inputCopyFloat, nullptr},
+			{outputFloatToI16Sse2, outputFloatToI24Ssse3, outputFloatToI32Sse2, outputFloatToF32Sse2, nullptr}};
+
+		//--------------------------------------------------------------------------
+		// AVX2
+		//--------------------------------------------------------------------------
+
+		SAMPLE_CONVERTER_TARGET("avx2")
+		inline __m256i nextRandom8(__m256i &state)
+		{
+			state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 13));
+			state = _mm256_xor_si256(state, _mm256_srli_epi32(state, 17));
+			state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 5));
+			return state;
+		}
+
+		SAMPLE_CONVERTER_TARGET("avx2")
+		inline __m256 tpdfNoise8(__m256i &state)
+		{
+			const __m256i one = _mm256_set1_epi32(0x3F800000);
+			__m256 a = _mm256_castsi256_ps(_mm256_or_si256(_mm256_srli_epi32(nextRandom8(state), 9), one));
+			__m256 b = _mm256_castsi256_ps(_mm256_or_si256(_mm256_srli_epi32(nextRandom8(state), 9), one));
+			return _mm256_sub_ps(a, b);
+		}
+
+		SAMPLE_CONVERTER_TARGET("avx2")
+		void inputI16ToFloatAvx2(const void *asio, uint8_t *dest, long frames, ptrdiff_t destStride)
+		{
+			if (destStride != 1)
+			{
+				inputScalar<ASIO_I16, ENGINE_FLT>(asio, dest, frames, destStride);
+				return;
+			}
+
+			const int16_t *src = static_cast<const int16_t *>(asio);
+			float *out = reinterpret_cast<float *>(dest);
+			const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+
+			long i = 0;
+			for (; i + 16 <= frames; i += 16)
+			{
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 8));
+				_mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a)), scale));
+				_mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b)), scale));
+			}
+			inputScalar<ASIO_I16, ENGINE_FLT>(src + i, dest + i * sizeof(float), frames - i, 1);
+		}
+
+		SAMPLE_CONVERTER_TARGET("avx2")
+		void inputI24ToFloatAvx2(const void *asio, uint8_t *dest, long frames, ptrdiff_t destStride)
+		{
+			if (destStride != 1)
+			{
+				inputScalar<ASIO_I24, ENGINE_FLT>(asio, dest, frames, destStride);
+				return;
+			}
+
+			const uint8_t *src = static_cast<const uint8_t *>(asio);
+			float *out = reinterpret_cast<float *>(dest);
+			const __m256 scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+			const __m256i unpack = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+													-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+
+			long i = 0;
+			// Two 16-byte loads 12 bytes apart; the second reads 4 bytes past sample 8
+			for (; i + 10 <= frames; i += 8)
+			{
+				const uint8_t *p = src + i * 3;
+				__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+				__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 12));
+				__m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+				_mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_shuffle_epi8(v, unpack)), scale));
+			}
+			inputScalar<ASIO_I24, ENGINE_FLT>(src + i * 3, dest + i * sizeof(float), frames - i, 1);
+		}
+
+		SAMPLE_CONVERTER_TARGET("avx2")
+		void inputI32ToFloatAvx2(const void *asio, uint8_t *dest, long frames, ptrdiff_t destStride)
+		{
+			if (destStride != 1)
+			{
+				inputScalar<ASIO_I32, ENGINE_FLT>(asio, dest, frames, destStride);
+				return;
+			}
+
+			const int32_t *src = static_cast<const int32_t *>(asio);
+			float *out = reinterpret_cast<float *>(dest);
+			const __m256 scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+
+			long i = 0;
+			for (; i + 8 <= frames; i += 8)
+			{
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+				_mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+			}
+			inputScalar<ASIO_I32, ENGINE_FLT>(src + i, dest + i * sizeof(float), frames - i, 1);
+		}
+
+		SAMPLE_CONVERTER_TARGET("avx2")
+		void outputFloatToI16Avx2(const uint8_t *src, ptrdiff_t srcStride, void *asio, long frames,
+								  const SampleConverter::Options &options, uint32_t &ditherState)
+		{
+			if (srcStride != 1)
+			{
+				outputScalar<ASIO_I16, ENGINE_FLT>(src, srcStride, asio, frames, options, ditherState);
+				return;
+			}
+
+			const float *in = reinterpret_cast<const float *>(src);
+			int16_t *out = static_cast<int16_t *>(asio);
+			const __m256 scale = _mm256_set1_ps(32768.0f);
+			const __m256 lo = _mm256_set1_ps(-32768.0f);
+			const __m256 hi = _mm256_set1_ps(32767.0f);
+
+			alignas(32) uint32_t lanes[8];
+			seedLanes(ditherState, lanes, 8);
+			__m256i random = _mm256_load_si256(reinterpret_cast<const __m256i *>(lanes));
+
+			long i = 0;
+			for (; i + 8 <= frames; i += 8)
+			{
+				__m256 x = _mm256_mul_ps(_mm256_loadu_ps(in + i), scale);
+				if (options.dither)
+				{
+					x = _mm256_add_ps(x, tpdfNoise8(random));
+				}
+				x = _mm256_min_ps(_mm256_max_ps(x, lo), hi);
+				__m256i v = _mm256_cvtps_epi32(x);
+				__m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), packed);
+			}
+
+			ditherState = static_cast<uint32_t>(_mm256_cvtsi256_si32(random)) | 1u;
+			outputScalar<ASIO_I16, ENGINE_FLT>(src + i * sizeof(float), 1, out + i, frames - i, options, ditherState);
+		}
+
+		SAMPLE_CONVERTER_TARGET("avx2")
+		void outputFloatToI24Avx2(const uint8_t *src, ptrdiff_t srcStride, void *asio, long frames,
+								  const SampleConverter::Options &options, uint32_t &ditherState)
+		{
+			if (srcStride != 1)
+			{
+				outputScalar<ASIO_I24, ENGINE_FLT>(src, srcStride, asio, frames, options, ditherState);
+				return;
+			}
+
+			const float *in = reinterpret_cast<const float *>(src);
+			uint8_t *out = static_cast<uint8_t *>(asio);
+			const __m256 scale = _mm256_set1_ps(8388608.0f);
+			const __m256 lo = _mm256_set1_ps(-8388608.0f);
+			const __m256 hi = _mm256_set1_ps(8388607.0f);
+			const __m256i pack = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+												  0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+			alignas(32) uint32_t lanes[8];
+			seedLanes(ditherState, lanes, 8);
+			__m256i random = _mm256_load_si256(reinterpret_cast<const __m256i *>(lanes));
+
+			long i = 0;
+			// The 16-byte store of the upper half writes 4 bytes past sample 8
+			for (; i + 10 <= frames; i += 8)
+			{
+				__m256 x = _mm256_mul_ps(_mm256_loadu_ps(in + i), scale);
+				if (options.dither)
+				{
+					x = _mm256_add_ps(x, tpdfNoise8(random));
+				}
+				x = _mm256_min_ps(_mm256_max_ps(x, lo), hi);
+				__m256i packed = _mm256_shuffle_epi8(_mm256_cvtps_epi32(x), pack);
+				uint8_t *p = out + i * 3;
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm256_castsi256_si128(packed));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(p + 12), _mm256_extracti128_si256(packed, 1));
+			}
+
+			ditherState = static_cast<uint32_t>(_mm256_cvtsi256_si32(random)) | 1u;
+			outputScalar<ASIO_I24, ENGINE_FLT>(src + i * sizeof(float), 1, out + i * 3, frames - i, options, ditherState);
+		}
+
+		SAMPLE_CONVERTER_TARGET("avx2")
+		void outputFloatToI32Avx2(const uint8_t *src, ptrdiff_t srcStride, void *asio, long frames,
+								  const SampleConverter::Options &options, uint32_t &ditherState)
+		{
+			if (srcStride != 1)
+			{
+				outputScalar<ASIO_I32, ENGINE_FLT>(src, srcStride, asio, frames, options, ditherState);
+				return;
+			}
+
+			const float *in = reinterpret_cast<const float *>(src);
+			int32_t *out = static_cast<int32_t *>(asio);
+			const __m256 scale = _mm256_set1_ps(2147483648.0f);
+
+			long i = 0;
+			for (; i + 8 <= frames; i += 8)
+			{
+				__m256 x = _mm256_mul_ps(_mm256_loadu_ps(in + i), scale);
+				__m256i overflow = _mm256_castps_si256(_mm256_cmp_ps(x, scale, _CMP_GE_OQ));
+				__m256i v = _mm256_xor_si256(_mm256_cvtps_epi32(x), overflow);
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), v);
+			}
+			outputScalar<ASIO_I32, ENGINE_FLT>(src + i * sizeof(float), 1, out + i, frames - i, options, ditherState);
+		}
+
+		SAMPLE_CONVERTER_TARGET("avx2")
+		void outputFloatToF32Avx2(const uint8_t *src, ptrdiff_t srcStride, void *asio, long frames,
+								  const SampleConverter::Options &options, uint32_t &ditherState)
+		{
+			if (srcStride != 1)
+			{
+				outputScalar<ASIO_F32, ENGINE_FLT>(src, srcStride, asio, frames, options, ditherState);
+				return;
+			}
+
+			if (!options.clip)
+			{
+				std::memcpy(asio, src, static_cast<size_t>(frames) * sizeof(float));
+				return;
+			}
+
+			const float *in = reinterpret_cast<const float *>(src);
+			float *out = static_cast<float *>(asio);
+			const __m256 lo = _mm256_set1_ps(-1.0f);
+			const __m256 hi = _mm256_set1_ps(1.0f);
+
+			long i = 0;
+			for (; i + 8 <= frames; i += 8)
+			{
+				_mm256_storeu_ps(out + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i), lo), hi));
+			}
+			outputScalar<ASIO_F32, ENGINE_FLT>(src + i * sizeof(float), 1, out + i, frames - i, options, ditherState);
+		}
+
+		const SimdKernels AVX2_KERNELS = {
+			{inputI16ToFloatAvx2, inputI24ToFloatAvx2, inputI32ToFloatAvx2, inputCopyFloat, nullptr},
+			{outputFloatToI16Avx2, outputFloatToI24Avx2, outputFloatToI32Avx2, outputFloatToF32Avx2, nullptr}};
+
+		struct CpuFeatures
+		{
+			bool sse2 = false;
+			bool ssse3 = false;
+			bool avx2 = false;
+		};
+
+		CpuFeatures queryCpuFeatures()
+		{
+			CpuFeatures features;
+#if defined(_MSC_VER) && !defined(__clang__)
+			int info[4];
+			__cpuid(info, 0);
+			int maxLeaf = info[0];
+
+			__cpuid(info, 1);
+			features.sse2 = (info[3] & (1 << 26)) != 0;
+			features.ssse3 = (info[2] & (1 << 9)) != 0;
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			bool avx = (info[2] & (1 << 28)) != 0;
+
+			// AVX2 also needs the OS to save YMM state
+			if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6)
+			{
+				__cpuidex(info, 7, 0);
+				features.avx2 = (info[1] & (1 << 5)) != 0;
+			}
+#else
+			__builtin_cpu_init();
+			features.sse2 = __builtin_cpu_supports("sse2");
+			features.ssse3 = __builtin_cpu_supports("ssse3");
+			features.avx2 = __builtin_cpu_supports("avx2");
+#endif
+			return features;
+		}
+
+		const CpuFeatures &cpuFeatures()
+		{
+			static const CpuFeatures features = queryCpuFeatures();
+			return features;
+		}
+
+#endif // SAMPLE_CONVERTER_X86
+
+	} // namespace
+
+	SampleConverter::SimdLevel SampleConverter::detectSimdLevel()
+	{
+#if SAMPLE_CONVERTER_X86
+		const CpuFeatures &features = cpuFeatures();
+		if (features.avx2)
+		{
+			return SimdLevel::AVX2;
+		}
+		if (features.sse2)
+		{
+			return SimdLevel::SSE2;
+		}
+#endif
+		return SimdLevel::SCALAR;
+	}
+
+	const char *SampleConverter::getSimdLevelName(SimdLevel level)
+	{
+		switch (level)
+		{
+		case SimdLevel::AVX2:
+			return "AVX2";
+		case SimdLevel::SSE2:
+			return "SSE2";
+		default:
+			return "scalar";
+		}
+	}
+
+	int SampleConverter::getAsioSampleSize(long asioType)
+	{
+		int index = asioIndex(asioType);
+		return index < 0 ? 0 : ASIO_SAMPLE_SIZE[index];
+	}
+
+	bool SampleConverter::selectInput(long asioType, AVSampleFormat format, SimdLevel level)
+	{
+		m_input = nullptr;
+
+		int a = asioIndex(asioType);
+		int e = engineIndex(format);
+		if (a < 0 || e < 0)
+		{
+			return false;
+		}
+
+		InputKernel kernel = nullptr;
+		SimdLevel used = SimdLevel::SCALAR;
+#if SAMPLE_CONVERTER_X86
+		SimdLevel available = std::min(level, detectSimdLevel());
+		if (e == ENGINE_FLT)
+		{
+			if (available == SimdLevel::AVX2 && AVX2_KERNELS.input[a])
+			{
+				kernel = AVX2_KERNELS.input[a];
+				used = SimdLevel::AVX2;
+			}
+			else if (available >= SimdLevel::SSE2 && SSE2_KERNELS.input[a] &&
+					 (a != ASIO_I24 || cpuFeatures().ssse3))
+			{
+				kernel = SSE2_KERNELS.input[a];
+				used = SimdLevel::SSE2;
+			}
+		}
+#else
+		(void)level;
+#endif
+		if (!kernel)
+		{
+			kernel = INPUT_SCALAR[a][e];
+		}
+
+		m_input = kernel;
+		m_asioType = asioType;
+		m_format = format;
+		m_level = used;
+		return true;
+	}
+
+	bool SampleConverter::selectOutput(long asioType, AVSampleFormat format, const Options &options,
+									   SimdLevel level)
+	{
+		m_output = nullptr;
+
+		int a = asioIndex(asioType);
+		int e = engineIndex(format);
+		if (a < 0 || e < 0)
+		{
+			return false;
+		}
+
+		OutputKernel kernel = nullptr;
+		SimdLevel used = SimdLevel::SCALAR;
+#if SAMPLE_CONVERTER_X86
+		SimdLevel available = std::min(level, detectSimdLevel());
+		if (e == ENGINE_FLT)
+		{
+			if (available == SimdLevel::AVX2 && AVX2_KERNELS.output[a])
+			{
+				kernel = AVX2_KERNELS.output[a];
+				used = SimdLevel::AVX2;
+			}
+			else if (available >= SimdLevel::SSE2 && SSE2_KERNELS.output[a] &&
+					 (a != ASIO_I24 || cpuFeatures().ssse3))
+			{
+				kernel = SSE2_KERNELS.output[a];
+				used = SimdLevel::SSE2;
+			}
+		}
+#else
+		(void)level;
+#endif
+		if (!kernel)
+		{
+			kernel = OUTPUT_SCALAR[a][e];
+		}
+
+		m_output = kernel;
+		m_options = options;
+		m_asioType = asioType;
+		m_format = format;
+		m_level = used;
+		return true;
+	}
+
+} // namespace AudioEngine
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+extern "C"
+{
+#include <libavutil/samplefmt.h>
+}
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief Vectorized sample conversion between ASIO buffers and AudioBuffer planes
+	 *
+	 * Holds one kernel picked from a table indexed by ASIO sample type, engine
+	 * sample format and SIMD level. Selection happens once (at configure or
+	 * start time); convert calls are branch-free dispatches that never allocate.
+	 *
+	 * Supported ASIO types are Int16/Int24 (packed)/Int32/Float32/Float64 LSB.
+	 * Supported engine formats are float, double, s32 and s16, planar or
+	 * interleaved. Interleaved channels are addressed with a stride and take the
+	 * scalar path; planar data uses SSE2 or AVX2 kernels where available.
+	 *
+	 * Integer outputs always saturate. The clip option additionally clamps
+	 * floating-point outputs to [-1, 1]. TPDF dither applies to Int16 and Int24
+	 * outputs fed from floating-point formats.
+	 */
+	class SampleConverter
+	{
+	public:
+		/**
+		 * @brief Instruction set used by a kernel
+		 */
+		enum class SimdLevel
+		{
+			SCALAR,
+			SSE2,
+			AVX2
+		};
+
+		/**
+		 * @brief Output conversion options
+		 */
+		struct Options
+		{
+			bool clip = true;	 // Clamp floating-point outputs to full scale
+			bool dither = false; // TPDF dither when reducing to Int16/Int24
+		};
+
+		/**
+		 * @brief ASIO buffer to engine plane (destStride in samples)
+		 */
+		using InputKernel = void (*)(const void *asio, uint8_t *dest, long frames, ptrdiff_t destStride);
+
+		/**
+		 * @brief Engine plane to ASIO buffer (srcStride in samples)
+		 */
+		using OutputKernel = void (*)(const uint8_t *src, ptrdiff_t srcStride, void *asio, long frames,
+									  const Options &options, uint32_t &ditherState);
+
+		SampleConverter() = default;
+
+		/**
+		 * @brief Select the kernel converting ASIO input into an engine format
+		 *
+		 * @param asioType ASIO sample type (ASIOSampleType value)
+		 * @param format Engine sample format
+		 * @param level Highest SIMD level to use
+		 * @return false if the combination is not supported
+		 */
+		bool selectInput(long asioType, AVSampleFormat format, SimdLevel level = detectSimdLevel());
+
+		/**
+		 * @brief Select the kernel converting an engine format into ASIO output
+		 *
+		 * @param asioType ASIO sample type (ASIOSampleType value)
+		 * @param format Engine sample format
+		 * @param options Clip and dither options
+		 * @param level Highest SIMD level to use
+		 * @return false if the combination is not supported
+		 */
+		bool selectOutput(long asioType, AVSampleFormat format, const Options &options,
+						  SimdLevel level = detectSimdLevel());
+
+		/**
+		 * @brief Convert one channel from an ASIO buffer
+		 */
+		void toEngine(const void *asio, uint8_t *dest, long frames, ptrdiff_t destStride) const
+		{
+			m_input(asio, dest, frames, destStride);
+		}
+
+		/**
+		 * @brief Convert one channel into an ASIO buffer
+		 *
+		 * @param ditherState Per-channel dither generator state (any non-zero seed)
+		 */
+		void toAsio(const uint8_t *src, ptrdiff_t srcStride, void *asio, long frames, uint32_t &ditherState) const
+		{
+			m_output(src, srcStride, asio, frames, m_options, ditherState);
+		}
+
+		bool isInputValid() const { return m_input != nullptr; }
+		bool isOutputValid() const { return m_output != nullptr; }
+		long getAsioType() const { return m_asioType; }
+		AVSampleFormat getFormat() const { return m_format; }
+		SimdLevel getSimdLevel() const { return m_level; }
+
+		/**
+		 * @brief Get the best SIMD level supported by this CPU
+		 */
+		static SimdLevel detectSimdLevel();
+
+		/**
+		 * @brief Get a printable name for a SIMD level
+		 */
+		static const char *getSimdLevelName(SimdLevel level);
+
+		/**
+		 * @brief Get the size of one ASIO sample in bytes
+		 *
+		 * @return Sample size, or 0 for unsupported types
+		 */
+		static int getAsioSampleSize(long asioType);
+
+	private:
+		InputKernel m_input = nullptr;
+		OutputKernel m_output = nullptr;
+		Options m_options;
+		long m_asioType = -1;
+		AVSampleFormat m_format = AV_SAMPLE_FMT_NONE;
+		SimdLevel m_level = SimdLevel::SCALAR;
+	};
+
+} // namespace AudioEngine
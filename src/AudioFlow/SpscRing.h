@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief Bounded lock-free single-producer/single-consumer ring
+	 *
+	 * Storage is allocated once in the constructor; tryPush() and tryPop() never
+	 * allocate, lock or block, so the ring can be used from the audio thread.
+	 * Exactly one thread may push and exactly one thread may pop.
+	 *
+	 * @tparam T Element type (should be cheap to copy or move)
+	 */
+	template <typename T>
+	class SpscRing
+	{
+	public:
+		/**
+		 * @brief Create a ring
+		 *
+		 * @param capacity Minimum number of elements (rounded up to a power of two)
+		 */
+		explicit SpscRing(size_t capacity)
+		{
+			size_t size = 2;
+			while (size < capacity)
+			{
+				size <<= 1;
+			}
+			m_buffer.resize(size);
+			m_mask = size - 1;
+		}
+
+		SpscRing(const SpscRing &) = delete;
+		SpscRing &operator=(const SpscRing &) = delete;
+
+		/**
+		 * @brief Push an element (producer thread only)
+		 *
+		 * @param value Element to copy into the ring
+		 * @return false if the ring is full
+		 */
+		bool tryPush(const T &value)
+		{
+			const size_t head = m_head.load(std::memory_order_relaxed);
+			if (head - m_cachedTail > m_mask)
+			{
+				m_cachedTail = m_tail.load(std::memory_order_acquire);
+				if (head - m_cachedTail > m_mask)
+				{
+					return false;
+				}
+			}
+
+			m_buffer[head & m_mask] = value;
+			m_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * @brief Pop an element (consumer thread only)
+		 *
+		 * @param value Receives the oldest element
+		 * @return false if the ring is empty
+		 */
+		bool tryPop(T &value)
+		{
+			const size_t tail = m_tail.load(std::memory_order_relaxed);
+			if (tail == m_cachedHead)
+			{
+				m_cachedHead = m_head.load(std::memory_order_acquire);
+				if (tail == m_cachedHead)
+				{
+					return false;
+				}
+			}
+
+			value = std::move(m_buffer[tail & m_mask]);
+			m_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * @brief Drop all queued elements (consumer thread only)
+		 */
+		void clear()
+		{
+			// tryPop() compares against the cached head, so it has to move too
+			m_cachedHead = m_head.load(std::memory_order_acquire);
+			m_tail.store(m_cachedHead, std::memory_order_release);
+		}
+
+		/**
+		 * @brief Approximate number of queued elements
+		 *
+		 * Exact only when called from the producer or consumer thread while the
+		 * other side is idle.
+		 */
+		size_t size() const
+		{
+			return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+		}
+
+		bool empty() const { return size() == 0; }
+		size_t capacity() const { return m_mask + 1; }
+
+	private:
+		std::vector<T> m_buffer;
+		size_t m_mask;
+
+		// Producer and consumer indices live on separate cache lines
+		alignas(64) std::atomic<size_t> m_head{0};
+		size_t m_cachedTail = 0; // Producer's view of m_tail
+		alignas(64) std::atomic<size_t> m_tail{0};
+		size_t m_cachedHead = 0; // Consumer's view of m_head
+	};
+
+} // namespace AudioEngine
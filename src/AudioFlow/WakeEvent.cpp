@@ -0,0 +1,69 @@
+#include "WakeEvent.h"
+#include <algorithm>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+#if defined(_WIN32) && defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+#define WAKE_EVENT_WAIT_ON_ADDRESS 1
+#ifdef _MSC_VER
+#pragma comment(lib, "Synchronization.lib")
+#endif
+#elif defined(__linux__)
+#define WAKE_EVENT_FUTEX 1
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace AudioEngine
+{
+
+	static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "the OS waits on the sequence's address");
+
+	void WakeEvent::sleep(uint32_t sequence, std::chrono::steady_clock::time_point deadline)
+	{
+		const bool forever = deadline == std::chrono::steady_clock::time_point::max();
+		const auto remaining = forever ? std::chrono::nanoseconds::zero()
+									   : std::max(std::chrono::nanoseconds::zero(), deadline - std::chrono::steady_clock::now());
+#if defined(WAKE_EVENT_WAIT_ON_ADDRESS)
+		// Rounded up, so a timed wait doesn't return just short of its deadline
+		const DWORD milliseconds = forever ? INFINITE
+										   : static_cast<DWORD>(std::chrono::ceil<std::chrono::milliseconds>(remaining).count());
+		WaitOnAddress(&m_sequence, &sequence, sizeof(sequence), milliseconds);
+#elif defined(WAKE_EVENT_FUTEX)
+		// Returns at once if the sequence has already moved on; spurious returns are fine
+		struct timespec timeout;
+		timeout.tv_sec = static_cast<time_t>(remaining.count() / 1000000000);
+		timeout.tv_nsec = static_cast<long>(remaining.count() % 1000000000);
+		syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_sequence), FUTEX_WAIT_PRIVATE, sequence,
+				forever ? nullptr : &timeout, nullptr, 0);
+#else
+		// notify() doesn't lock, so a wake can slip in before the wait; the slice bounds it
+		const auto slice = forever ? FALLBACK_SLICE
+								   : std::min<std::chrono::nanoseconds>(FALLBACK_SLICE, remaining);
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait_for(lock, slice, [this, sequence]
+							 { return m_sequence.load(std::memory_order_acquire) != sequence; });
+#endif
+	}
+
+	void WakeEvent::wake()
+	{
+#if defined(WAKE_EVENT_WAIT_ON_ADDRESS)
+		WakeByAddressAll(&m_sequence);
+#elif defined(WAKE_EVENT_FUTEX)
+		syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_sequence), FUTEX_WAKE_PRIVATE, INT_MAX,
+				nullptr, nullptr, 0);
+#else
+		m_condition.notify_all();
+#endif
+	}
+
+} // namespace AudioEngine
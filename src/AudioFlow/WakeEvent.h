@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief Wakes a thread waiting for a lock-free handoff (e.g. an SpscRing)
+	 *
+	 * The waiter spins briefly, then sleeps on the event's sequence number
+	 * until its condition holds. The other side calls notify() after a change
+	 * that can make the condition true. notify() never takes a lock: it bumps
+	 * the sequence and, only if a thread is asleep, issues the OS wake-by-address
+	 * call (futex on Linux, WakeByAddressAll on Windows). That call does not
+	 * block, so the audio thread may notify, but it is still a system call;
+	 * audio-thread callers should notify at a watermark rather than per block.
+	 * Where the OS has no address wait, the waiter sleeps on a condition
+	 * variable in slices of FALLBACK_SLICE and the wake may be late by one
+	 * slice.
+	 *
+	 * The condition is evaluated without any lock held. It must read state
+	 * that is published before notify() is called, and a flag that ends the
+	 * wait (a stop request) needs a notify() of its own.
+	 */
+	class WakeEvent
+	{
+	public:
+		WakeEvent() = default;
+
+		WakeEvent(const WakeEvent &) = delete;
+		WakeEvent &operator=(const WakeEvent &) = delete;
+
+		/**
+		 * @brief Block until ready() returns true
+		 *
+		 * ready() may have side effects such as popping an element; it is
+		 * called until it first returns true.
+		 *
+		 * @param ready Condition to wait for
+		 */
+		template <typename Predicate>
+		void waitUntil(Predicate ready)
+		{
+			waitUntil(ready, std::chrono::steady_clock::time_point::max());
+		}
+
+		/**
+		 * @brief Block until ready() returns true or the deadline passes
+		 *
+		 * @param ready Condition to wait for
+		 * @param deadline Time to give up at
+		 * @return Whether ready() returned true
+		 */
+		template <typename Predicate>
+		bool waitUntil(Predicate ready, std::chrono::steady_clock::time_point deadline)
+		{
+			for (int spins = 0; spins < SPIN_LIMIT; spins++)
+			{
+				if (ready())
+				{
+					return true;
+				}
+				std::this_thread::yield();
+			}
+
+			while (true)
+			{
+				// A notify() after this load changes the sequence, so sleep() returns at once
+				const uint32_t sequence = m_sequence.load(std::memory_order_acquire);
+				m_sleepers.fetch_add(1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (ready())
+				{
+					m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
+				if (std::chrono::steady_clock::now() >= deadline)
+				{
+					m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+					return false;
+				}
+				sleep(sequence, deadline);
+				m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+			}
+		}
+
+		/**
+		 * @brief Wake the waiting thread, if any
+		 *
+		 * Lock-free; makes a system call only when a thread is asleep.
+		 */
+		void notify()
+		{
+			m_sequence.fetch_add(1, std::memory_order_release);
+
+			// Pairs with the waiter's fence: either it sees the new state or we see it asleep
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (m_sleepers.load(std::memory_order_relaxed) > 0)
+			{
+				wake();
+			}
+		}
+
+	private:
+		// Polls before sleeping; a busy pipeline stage rarely gets this far
+		static constexpr int SPIN_LIMIT = 64;
+
+		// Longest sleep between checks where the OS has no address wait
+		static constexpr std::chrono::milliseconds FALLBACK_SLICE{1};
+
+		std::atomic<uint32_t> m_sequence{0};
+		std::atomic<int> m_sleepers{0};
+
+		// Only used where the OS has no address wait
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+
+		void sleep(uint32_t sequence, std::chrono::steady_clock::time_point deadline);
+		void wake();
+	};
+
+} // namespace AudioEngine
@@ -1,5 +1,5 @@
 #include "AsioSinkNode.h"
-#include "AsioManager.h"
+#include "IAudioDriver.h"
 #include "AudioEngine.h"
 #include <iostream>
 #include <sstream>
@@ -9,7 +9,7 @@
 namespace AudioEngine
 {
 
-	AsioSinkNode::AsioSinkNode(const std::string &name, AudioEngine *engine, AsioManager *asioManager)
+	AsioSinkNode::AsioSinkNode(const std::string &name, AudioEngine *engine, IAudioDriver *asioManager)
 		: AudioNode(name, NodeType::ASIO_SINK, engine),
 		  m_asioManager(asioManager),
 		  m_doubleBufferSwitch(false),
@@ -20,7 +20,7 @@ namespace AudioEngine
 	{
 		if (!m_asioManager)
 		{
-			logMessage("Invalid AsioManager pointer", true);
+			logMessage("Invalid audio driver pointer", true);
 		}
 	}
 
@@ -87,6 +87,34 @@ namespace AudioEngine
 			return false;
 		}
 
+		// Output conversion options
+		m_convertOptions = SampleConverter::Options();
+		it = params.find("clip");
+		if (it != params.end())
+		{
+			m_convertOptions.clip = (it->second == "true" || it->second == "1");
+		}
+		it = params.find("dither");
+		if (it != params.end())
+		{
+			if (it->second == "tpdf")
+			{
+				m_convertOptions.dither = true;
+			}
+			else if (it->second != "none")
+			{
+				logMessage("Unknown dither mode: " + it->second + " (expected 'none' or 'tpdf')", true);
+				return false;
+			}
+		}
+
+		// Independent dither noise per channel
+		m_ditherState.resize(m_asioChannelIndices.size());
+		for (size_t i = 0; i < m_ditherState.size(); i++)
+		{
+			m_ditherState[i] = 0x9E3779B9u * static_cast<uint32_t>(i + 1);
+		}
+
 		// Create buffers
 		if (!createBuffers())
 		{
@@ -151,9 +179,17 @@ namespace AudioEngine
 			return true;
 		}
 
+		// The ASIO sample type is known once the driver buffers exist
+		if (!selectConverter())
+		{
+			return false;
+		}
+
 		// Reset state
 		m_doubleBufferSwitch = false;
 		m_inputBuffer = m_inputBufferA;
+		m_nullAsioBufferReports = 0;
+		m_nullChannelBufferReports = 0;
 
 		m_running = true;
 		logMessage("Started", false);
@@ -234,6 +270,12 @@ namespace AudioEngine
 	{
 		std::lock_guard<std::mutex> lock(m_bufferMutex);
 
+		// Reselect only if the driver changed its sample type since start()
+		if (m_converter.getAsioType() != m_asioManager->getSampleType() && !selectConverter())
+		{
+			return false;
+		}
+
 		if (!m_running)
 		{
 			// Fill with silence when not running
@@ -247,8 +289,8 @@ namespace AudioEngine
 					uint8_t *silenceData = m_silenceBuffer->getChannelData(i);
 					if (silenceData)
 					{
-						convertAudioBufferToAsio(silenceData, asioBuffers[channelIndex], m_bufferSize,
-												 m_silenceBuffer->getFormat(), m_asioManager->getSampleType());
+						const ptrdiff_t stride = m_silenceBuffer->isPlanar() ? 1 : m_silenceBuffer->getChannelCount();
+						m_converter.toAsio(silenceData, stride, asioBuffers[channelIndex], m_bufferSize, m_ditherState[i]);
 					}
 				}
 			}
@@ -260,6 +302,9 @@ namespace AudioEngine
 		std::shared_ptr<AudioBuffer> currentBuffer =
 			m_doubleBufferSwitch ? m_inputBufferA : m_inputBufferB;
 
+		// Interleaved formats address each channel with a stride
+		const ptrdiff_t stride = currentBuffer->isPlanar() ? 1 : currentBuffer->getChannelCount();
+
 		// For each ASIO channel this node handles
 		for (size_t i = 0; i < m_asioChannelIndices.size(); i++)
 		{
@@ -269,7 +314,10 @@ namespace AudioEngine
 
 			if (!asioBuffer)
 			{
-				logMessage("Null ASIO buffer for channel " + std::to_string(channelIndex), true);
+				if (m_nullAsioBufferReports++ % CALLBACK_ERROR_REPORT_INTERVAL == 0)
+				{
+					m_engine->postEvent("Error", "Null ASIO buffer for channel", this, channelIndex);
+				}
 				continue;
 			}
 
@@ -278,217 +326,35 @@ namespace AudioEngine
 
 			if (!sourceBuffer)
 			{
-				logMessage("Null source buffer for channel " + std::to_string(i), true);
+				if (m_nullChannelBufferReports++ % CALLBACK_ERROR_REPORT_INTERVAL == 0)
+				{
+					m_engine->postEvent("Error", "Null source buffer for channel", this, static_cast<long>(i));
+				}
 				continue;
 			}
 
 			// Convert from AudioBuffer's format to ASIO format
-			convertAudioBufferToAsio(sourceBuffer, asioBuffer, m_bufferSize,
-									 currentBuffer->getFormat(), m_asioManager->getSampleType());
+			m_converter.toAsio(sourceBuffer, stride, asioBuffer, m_bufferSize, m_ditherState[i]);
 		}
 
 		return true;
 	}
 
-	void AsioSinkNode::convertAudioBufferToAsio(uint8_t *sourceBuffer, void *asioBuffer, long frames,
-												AVSampleFormat format, int asioType)
+	bool AsioSinkNode::selectConverter()
 	{
-		// This function handles converting from FFmpeg's format to ASIO's sample format
-
-		// Handle different ASIO sample types
-		switch (asioType)
-		{
-		case 0: // Int16 LSB
-		{
-			int16_t *dest = static_cast<int16_t *>(asioBuffer);
-
-			// Convert based on source format
-			if (format == AV_SAMPLE_FMT_S16)
-			{
-				// Direct copy for same format
-				memcpy(dest, sourceBuffer, frames * sizeof(int16_t));
-			}
-			else if (format == AV_SAMPLE_FMT_FLT)
-			{
-				// Convert float to int16
-				float *src = reinterpret_cast<float *>(sourceBuffer);
-				for (long i = 0; i < frames; i++)
-				{
-					float sample = std::max(-1.0f, std::min(1.0f, src[i]));
-					dest[i] = static_cast<int16_t>(sample * 32767.0f);
-				}
-			}
-			else if (format == AV_SAMPLE_FMT_DBL)
-			{
-				// Convert double to int16
-				double *src = reinterpret_cast<double *>(sourceBuffer);
-				for (long i = 0; i < frames; i++)
-				{
-					double sample = std::max(-1.0, std::min(1.0, src[i]));
-					dest[i] = static_cast<int16_t>(sample * 32767.0);
-				}
-			}
-			else if (format == AV_SAMPLE_FMT_S32)
-			{
-				// Convert int32 to int16
-				int32_t *src = reinterpret_cast<int32_t *>(sourceBuffer);
-				for (long i = 0; i < frames; i++)
-				{
-					dest[i] = static_cast<int16_t>(src[i] >> 16);
-				}
-			}
-			else
-			{
-				// Just fill with silence if unsupported
-				memset(dest, 0, frames * sizeof(int16_t));
-				logMessage("Unsupported conversion from format " + std::to_string(format) +
-							   " to Int16",
-						   true);
-			}
-			break;
-		}
-
-		case 1: // Int24 LSB
-		{
-			int32_t *dest = static_cast<int32_t *>(asioBuffer); // Actually int24 in low 3 bytes
-
-			if (format == AV_SAMPLE_FMT_S32)
-			{
-				// Convert int32 to int24 by shifting right 8 bits
-				int32_t *src = reinterpret_cast<int32_t *>(sourceBuffer);
-				for (long i = 0; i < frames; i++)
-				{
-					dest[i] = src[i] >> 8;
-				}
-			}
-			else if (format == AV_SAMPLE_FMT_FLT)
-			{
-				// Convert float to int24
-				float *src = reinterpret_cast<float *>(sourceBuffer);
-				const float scale = 8388607.0f; // 2^23 - 1
-				for (long i = 0; i < frames; i++)
-				{
-					float sample = std::max(-1.0f, std::min(1.0f, src[i]));
-					dest[i] = static_cast<int32_t>(sample * scale);
-				}
-			}
-			else if (format == AV_SAMPLE_FMT_DBL)
-			{
-				// Convert double to int24
-				double *src = reinterpret_cast<double *>(sourceBuffer);
-				const double scale = 8388607.0; // 2^23 - 1
-				for (long i = 0; i < frames; i++)
-				{
-					double sample = std::max(-1.0, std::min(1.0, src[i]));
-					dest[i] = static_cast<int32_t>(sample * scale);
-				}
-			}
-			else
-			{
-				// Fill with silence if unsupported
-				memset(dest, 0, frames * sizeof(int32_t));
-				logMessage("Unsupported conversion from format " + std::to_string(format) +
-							   " to Int24",
-						   true);
-			}
-			break;
-		}
-
-		case 2: // Int32 LSB
-		{
-			int32_t *dest = static_cast<int32_t *>(asioBuffer);
-
-			if (format == AV_SAMPLE_FMT_S32)
-			{
-				// Direct copy for same format
-				memcpy(dest, sourceBuffer, frames * sizeof(int32_t));
-			}
-			else if (format == AV_SAMPLE_FMT_FLT)
-			{
-				// Convert float to int32
-				float *src = reinterpret_cast<float *>(sourceBuffer);
-				const float scale = 2147483647.0f; // 2^31 - 1
-				for (long i = 0; i < frames; i++)
-				{
-					float sample = std::max(-1.0f, std::min(1.0f, src[i]));
-					dest[i] = static_cast<int32_t>(sample * scale);
-				}
-			}
-			else if (format == AV_SAMPLE_FMT_DBL)
-			{
-				// Convert double to int32
-				double *src = reinterpret_cast<double *>(sourceBuffer);
-				const double scale = 2147483647.0; // 2^31 - 1
-				for (long i = 0; i < frames; i++)
-				{
-					double sample = std::max(-1.0, std::min(1.0, src[i]));
-					dest[i] = static_cast<int32_t>(sample * scale);
-				}
-			}
-			else
-			{
-				// Fill with silence if unsupported
-				memset(dest, 0, frames * sizeof(int32_t));
-				logMessage("Unsupported conversion from format " + std::to_string(format) +
-							   " to Int32",
-						   true);
-			}
-			break;
-		}
-
-		case 3: // Float32 LSB
+		long asioType = m_asioManager ? m_asioManager->getSampleType() : 0;
+		if (!m_converter.selectOutput(asioType, m_format, m_convertOptions))
 		{
-			float *dest = static_cast<float *>(asioBuffer);
-
-			if (format == AV_SAMPLE_FMT_FLT)
-			{
-				// Direct copy for same format
-				memcpy(dest, sourceBuffer, frames * sizeof(float));
-			}
-			else if (format == AV_SAMPLE_FMT_DBL)
-			{
-				// Convert double to float
-				double *src = reinterpret_cast<double *>(sourceBuffer);
-				for (long i = 0; i < frames; i++)
-				{
-					dest[i] = static_cast<float>(src[i]);
-				}
-			}
-			else if (format == AV_SAMPLE_FMT_S32)
-			{
-				// Convert int32 to float
-				int32_t *src = reinterpret_cast<int32_t *>(sourceBuffer);
-				const float scale = 1.0f / 2147483648.0f; // 1/2^31
-				for (long i = 0; i < frames; i++)
-				{
-					dest[i] = src[i] * scale;
-				}
-			}
-			else if (format == AV_SAMPLE_FMT_S16)
-			{
-				// Convert int16 to float
-				int16_t *src = reinterpret_cast<int16_t *>(sourceBuffer);
-				const float scale = 1.0f / 32768.0f; // 1/2^15
-				for (long i = 0; i < frames; i++)
-				{
-					dest[i] = src[i] * scale;
-				}
-			}
-			else
-			{
-				// Fill with silence if unsupported
-				memset(dest, 0, frames * sizeof(float));
-				logMessage("Unsupported conversion from format " + std::to_string(format) +
-							   " to Float32",
-						   true);
-			}
-			break;
+			logMessage("Unsupported conversion from format " + std::to_string(m_format) +
+						   " to ASIO sample type " + std::to_string(asioType),
+					   true);
+			return false;
 		}
 
-		default:
-			logMessage("Unsupported ASIO sample type: " + std::to_string(asioType), true);
-			break;
-		}
+		logMessage(std::string("Using ") + SampleConverter::getSimdLevelName(m_converter.getSimdLevel()) +
+					   " output conversion for ASIO sample type " + std::to_string(asioType),
+				   false);
+		return true;
 	}
 
 } // namespace AudioEngine
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "AudioNode.h"
+#include "SampleConverter.h"
 #include <vector>
 #include <mutex>
 
@@ -8,10 +9,14 @@ namespace AudioEngine
 {
 
 	// Forward declaration
-	class AsioManager;
+	class IAudioDriver;
 
 	/**
 	 * @brief Node for sending audio to ASIO outputs
+	 *
+	 * Parameters: "channels" (comma-separated ASIO output indices), optional
+	 * "clip" (true/false, clamp float outputs to full scale, default true) and
+	 * "dither" (none/tpdf, applied when reducing to Int16/Int24, default none).
 	 */
 	class AsioSinkNode : public AudioNode
 	{
@@ -21,9 +26,9 @@ namespace AudioEngine
 		 *
 		 * @param name Node name
 		 * @param engine Reference to the audio engine
-		 * @param asioManager Reference to the ASIO manager
+		 * @param asioManager Audio driver (ASIO or virtual device)
 		 */
-		AsioSinkNode(const std::string &name, AudioEngine *engine, AsioManager *asioManager);
+		AsioSinkNode(const std::string &name, AudioEngine *engine, IAudioDriver *asioManager);
 
 		/**
 		 * @brief Destroy the ASIO sink node
@@ -50,7 +55,7 @@ namespace AudioEngine
 		/**
 		 * @brief Provide data for ASIO callbacks
 		 *
-		 * Called by AsioManager during bufferSwitch callback
+		 * Called by the audio driver during its bufferSwitch callback
 		 *
 		 * @param doubleBufferIndex ASIO double buffer index
 		 * @param asioBuffers ASIO buffer pointers
@@ -67,7 +72,7 @@ namespace AudioEngine
 
 	private:
 		// ASIO manager
-		AsioManager *m_asioManager;
+		IAudioDriver *m_asioManager;
 
 		// ASIO channel configuration
 		std::vector<long> m_asioChannelIndices;
@@ -84,10 +89,19 @@ namespace AudioEngine
 		// Buffer for silence when no input is available
 		std::shared_ptr<AudioBuffer> m_silenceBuffer;
 
+		// Callback errors are reported on the first occurrence, then every CALLBACK_ERROR_REPORT_INTERVAL-th
+		uint32_t m_nullAsioBufferReports = 0;
+		uint32_t m_nullChannelBufferReports = 0;
+		static constexpr uint32_t CALLBACK_ERROR_REPORT_INTERVAL = 1000;
+
 		// Helper methods
 		bool createBuffers();
-		void convertAudioBufferToAsio(uint8_t *sourceBuffer, void *asioBuffer, long frames,
-									  AVSampleFormat format, int asioType);
+		bool selectConverter();
+
+		// Engine to ASIO sample conversion, selected at start()
+		SampleConverter m_converter;
+		SampleConverter::Options m_convertOptions;
+		std::vector<uint32_t> m_ditherState; // One dither generator per channel
 	};
 
 } // namespace AudioEngine
@@ -1,5 +1,6 @@
 #include "AsioSourceNode.h"
-#include "AsioManager.h"
+#include "IAudioDriver.h"
+#include "AudioBufferPool.h"
 #include "AudioEngine.h"
 #include <iostream>
 #include <sstream>
@@ -15,7 +16,7 @@ extern "C"
 namespace AudioEngine
 {
 
-	AsioSourceNode::AsioSourceNode(const std::string &name, AudioEngine *engine, AsioManager *asioManager)
+	AsioSourceNode::AsioSourceNode(const std::string &name, AudioEngine *engine, IAudioDriver *asioManager)
 		: AudioNode(name, NodeType::ASIO_SOURCE, engine),
 		  m_asioManager(asioManager),
 		  m_doubleBufferSwitch(false),
@@ -25,7 +26,7 @@ namespace AudioEngine
 	{
 		if (!m_asioManager)
 		{
-			logMessage("Invalid AsioManager pointer", true);
+			logMessage("Invalid audio driver pointer", true);
 		}
 	}
 
@@ -111,13 +112,14 @@ namespace AudioEngine
 		// Create two buffers for double-buffering
 		try
 		{
-			m_outputBufferA = std::make_shared<AudioBuffer>(m_bufferSize, m_sampleRate,
-															m_format, m_channelLayout);
-
-			m_outputBufferB = std::make_shared<AudioBuffer>(m_bufferSize, m_sampleRate,
-															m_format, m_channelLayout);
-
-			if (!m_outputBufferA->isValid() || !m_outputBufferB->isValid())
+			// Two pooled buffers plus spares for blocks still held downstream
+			AudioBufferPool &pool = AudioBufferPool::shared();
+			pool.reserve(m_bufferSize, m_sampleRate, m_format, m_channelLayout, 4);
+			m_outputBufferA = pool.acquire(m_bufferSize, m_sampleRate, m_format, m_channelLayout);
+			m_outputBufferB = pool.acquire(m_bufferSize, m_sampleRate, m_format, m_channelLayout);
+
+			if (!m_outputBufferA || !m_outputBufferB ||
+				!m_outputBufferA->isValid() || !m_outputBufferB->isValid())
 			{
 				logMessage("Failed to create valid output buffers", true);
 				return false;
@@ -152,9 +154,17 @@ namespace AudioEngine
 			return true;
 		}
 
+		// The ASIO sample type is known once the driver buffers exist
+		if (!selectConverter())
+		{
+			return false;
+		}
+
 		// Reset state
 		m_doubleBufferSwitch = false;
 		m_outputBuffer = m_outputBufferA;
+		m_nullAsioBufferReports = 0;
+		m_nullChannelBufferReports = 0;
 
 		m_running = true;
 		logMessage("Started", false);
@@ -214,8 +224,22 @@ namespace AudioEngine
 			return false;
 		}
 
-		// Get the current buffer to fill based on double-buffering
-		std::shared_ptr<AudioBuffer> currentBuffer = m_doubleBufferSwitch ? m_outputBufferB : m_outputBufferA;
+		// Get the current buffer to fill based on double-buffering; it is replaced
+		// if a downstream consumer still holds the payload from two blocks ago
+		std::shared_ptr<AudioBuffer> &currentBuffer = m_doubleBufferSwitch ? m_outputBufferB : m_outputBufferA;
+		if (!AudioBuffer::prepareForWrite(currentBuffer))
+		{
+			return false;
+		}
+
+		// Reselect only if the driver changed its sample type since start()
+		if (m_converter.getAsioType() != m_asioManager->getSampleType() && !selectConverter())
+		{
+			return false;
+		}
+
+		// Interleaved formats address each channel with a stride
+		const ptrdiff_t stride = currentBuffer->isPlanar() ? 1 : currentBuffer->getChannelCount();
 
 		// For each ASIO channel this node handles
 		for (size_t i = 0; i < m_asioChannelIndices.size(); i++)
@@ -226,7 +250,10 @@ namespace AudioEngine
 
 			if (!asioBuffer)
 			{
-				logMessage("Null ASIO buffer for channel " + std::to_string(channelIndex), true);
+				if (m_nullAsioBufferReports++ % CALLBACK_ERROR_REPORT_INTERVAL == 0)
+				{
+					m_engine->postEvent("Error", "Null ASIO buffer for channel", this, channelIndex);
+				}
 				continue;
 			}
 
@@ -235,198 +262,40 @@ namespace AudioEngine
 
 			if (!destBuffer)
 			{
-				logMessage("Null destination buffer for channel " + std::to_string(i), true);
+				if (m_nullChannelBufferReports++ % CALLBACK_ERROR_REPORT_INTERVAL == 0)
+				{
+					m_engine->postEvent("Error", "Null destination buffer for channel", this, static_cast<long>(i));
+				}
 				continue;
 			}
 
 			// Convert from ASIO format to AudioBuffer's format
-			convertAsioToAudioBuffer(asioBuffer, destBuffer, m_bufferSize,
-									 m_asioManager->getSampleType(), currentBuffer->getFormat());
+			m_converter.toEngine(asioBuffer, destBuffer, m_bufferSize, stride);
 		}
 
-		// Toggle double buffer for next time and set current output buffer
+		// Publish, toggle double buffer for next time and set current output buffer
+		currentBuffer->publish();
 		m_doubleBufferSwitch = !m_doubleBufferSwitch;
 		m_outputBuffer = currentBuffer;
 
 		return true;
 	}
 
-	void AsioSourceNode::convertAsioToAudioBuffer(void *asioBuffer, uint8_t *destBuffer, long frames,
-												  int asioType, AVSampleFormat format)
+	bool AsioSourceNode::selectConverter()
 	{
-		// This function handles converting from ASIO's sample format to FFmpeg's format
-
-		// Handle different ASIO sample types
-		switch (asioType)
-		{
-		case 0: // Int16 LSB
-		{
-			int16_t *src = static_cast<int16_t *>(asioBuffer);
-
-			// Convert based on destination format
-			if (format == AV_SAMPLE_FMT_S16)
-			{
-				// Direct copy for same format
-				memcpy(destBuffer, src, frames * sizeof(int16_t));
-			}
-			else if (format == AV_SAMPLE_FMT_FLT)
-			{
-				// Convert int16 to float
-				float *dest = reinterpret_cast<float *>(destBuffer);
-				for (long i = 0; i < frames; i++)
-				{
-					dest[i] = src[i] / 32768.0f;
-				}
-			}
-			else if (format == AV_SAMPLE_FMT_DBL)
-			{
-				// Convert int16 to double
-				double *dest = reinterpret_cast<double *>(destBuffer);
-				for (long i = 0; i < frames; i++)
-				{
-					dest[i] = src[i] / 32768.0;
-				}
-			}
-			else
-			{
-				logMessage("Unsupported conversion from Int16 to format " +
-							   std::to_string(format),
-						   true);
-			}
-			break;
-		}
-
-		case 1: // Int24 LSB
-		{
-			int32_t *src = static_cast<int32_t *>(asioBuffer); // Actually int24 in low 3 bytes
-
-			if (format == AV_SAMPLE_FMT_S32)
-			{
-				// Convert int24 to int32 by shifting left 8 bits
-				int32_t *dest = reinterpret_cast<int32_t *>(destBuffer);
-				for (long i = 0; i < frames; i++)
-				{
-					dest[i] = src[i] << 8;
-				}
-			}
-			else if (format == AV_SAMPLE_FMT_FLT)
-			{
-				// Convert int24 to float
-				float *dest = reinterpret_cast<float *>(destBuffer);
-				const float scale = 1.0f / 8388608.0f; // 2^23
-				for (long i = 0; i < frames; i++)
-				{
-					dest[i] = src[i] * scale;
-				}
-			}
-			else if (format == AV_SAMPLE_FMT_DBL)
-			{
-				// Convert int24 to double
-				double *dest = reinterpret_cast<double *>(destBuffer);
-				const double scale = 1.0 / 8388608.0; // 2^23
-				for (long i = 0; i < frames; i++)
-				{
-					dest[i] = src[i] * scale;
-				}
-			}
-			else
-			{
-				logMessage("Unsupported conversion from Int24 to format " +
-							   std::to_string(format),
-						   true);
-			}
-			break;
-		}
-
-		case 2: // Int32 LSB
-		{
-			int32_t *src = static_cast<int32_t *>(asioBuffer);
-
-			if (format == AV_SAMPLE_FMT_S32)
-			{
-				// Direct copy for same format
-				memcpy(destBuffer, src, frames * sizeof(int32_t));
-			}
-			else if (format == AV_SAMPLE_FMT_FLT)
-			{
-				// Convert int32 to float
-				float *dest = reinterpret_cast<float *>(destBuffer);
-				const float scale = 1.0f / 2147483648.0f; // 2^31
-				for (long i = 0; i < frames; i++)
-				{
-					dest[i] = src[i] * scale;
-				}
-			}
-			else if (format == AV_SAMPLE_FMT_DBL)
-			{
-				// Convert int32 to double
-				double *dest = reinterpret_cast<double *>(destBuffer);
-				const double scale = 1.0 / 2147483648.0; // 2^31
-				for (long i = 0; i < frames; i++)
-				{
-					dest[i] = src[i] * scale;
-				}
-			}
-			else
-			{
-				logMessage("Unsupported conversion from Int32 to format " +
-							   std::to_string(format),
-						   true);
-			}
-			break;
-		}
-
-		case 3: // Float32 LSB
+		long asioType = m_asioManager ? m_asioManager->getSampleType() : 0;
+		if (!m_converter.selectInput(asioType, m_format))
 		{
-			float *src = static_cast<float *>(asioBuffer);
-
-			if (format == AV_SAMPLE_FMT_FLT)
-			{
-				// Direct copy for same format
-				memcpy(destBuffer, src, frames * sizeof(float));
-			}
-			else if (format == AV_SAMPLE_FMT_DBL)
-			{
-				// Convert float to double
-				double *dest = reinterpret_cast<double *>(destBuffer);
-				for (long i = 0; i < frames; i++)
-				{
-					dest[i] = src[i];
-				}
-			}
-			else if (format == AV_SAMPLE_FMT_S32)
-			{
-				// Convert float to int32
-				int32_t *dest = reinterpret_cast<int32_t *>(destBuffer);
-				for (long i = 0; i < frames; i++)
-				{
-					float sample = std::max(-1.0f, std::min(1.0f, src[i]));
-					dest[i] = static_cast<int32_t>(sample * 2147483647.0f);
-				}
-			}
-			else if (format == AV_SAMPLE_FMT_S16)
-			{
-				// Convert float to int16
-				int16_t *dest = reinterpret_cast<int16_t *>(destBuffer);
-				for (long i = 0; i < frames; i++)
-				{
-					float sample = std::max(-1.0f, std::min(1.0f, src[i]));
-					dest[i] = static_cast<int16_t>(sample * 32767.0f);
-				}
-			}
-			else
-			{
-				logMessage("Unsupported conversion from Float32 to format " +
-							   std::to_string(format),
-						   true);
-			}
-			break;
+			logMessage("Unsupported conversion from ASIO sample type " + std::to_string(asioType) +
+						   " to format " + std::to_string(m_format),
+					   true);
+			return false;
 		}
 
-		default:
-			logMessage("Unsupported ASIO sample type: " + std::to_string(asioType), true);
-			break;
-		}
+		logMessage(std::string("Using ") + SampleConverter::getSimdLevelName(m_converter.getSimdLevel()) +
+					   " input conversion for ASIO sample type " + std::to_string(asioType),
+				   false);
+		return true;
 	}
 
 } // namespace AudioEngine
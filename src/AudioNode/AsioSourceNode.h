@@ -1,6 +1,7 @@
 #pragma once
 
 #include "AudioNode.h"
+#include "SampleConverter.h"
 #include <vector>
 #include <mutex>
 
@@ -8,7 +9,7 @@ namespace AudioEngine
 {
 
 	// Forward declaration
-	class AsioManager;
+	class IAudioDriver;
 
 	/**
 	 * @brief Node for receiving audio from ASIO inputs
@@ -21,9 +22,9 @@ namespace AudioEngine
 		 *
 		 * @param name Node name
 		 * @param engine Reference to the audio engine
-		 * @param asioManager Reference to the ASIO manager
+		 * @param asioManager Audio driver (ASIO or virtual device)
 		 */
-		AsioSourceNode(const std::string &name, AudioEngine *engine, AsioManager *asioManager);
+		AsioSourceNode(const std::string &name, AudioEngine *engine, IAudioDriver *asioManager);
 
 		/**
 		 * @brief Destroy the ASIO source node
@@ -50,7 +51,7 @@ namespace AudioEngine
 		/**
 		 * @brief Receive data from ASIO callbacks
 		 *
-		 * Called by AsioManager during bufferSwitch callback
+		 * Called by the audio driver during its bufferSwitch callback
 		 *
 		 * @param doubleBufferIndex ASIO double buffer index
 		 * @param asioBuffers ASIO buffer pointers
@@ -67,7 +68,7 @@ namespace AudioEngine
 
 	private:
 		// ASIO manager
-		AsioManager *m_asioManager;
+		IAudioDriver *m_asioManager;
 
 		// ASIO channel configuration
 		std::vector<long> m_asioChannelIndices;
@@ -81,10 +82,17 @@ namespace AudioEngine
 		std::shared_ptr<AudioBuffer> m_outputBufferA;
 		std::shared_ptr<AudioBuffer> m_outputBufferB;
 
+		// Callback errors are reported on the first occurrence, then every CALLBACK_ERROR_REPORT_INTERVAL-th
+		uint32_t m_nullAsioBufferReports = 0;
+		uint32_t m_nullChannelBufferReports = 0;
+		static constexpr uint32_t CALLBACK_ERROR_REPORT_INTERVAL = 1000;
+
 		// Helper methods
 		bool createBuffers();
-		void convertAsioToAudioBuffer(void *asioBuffer, uint8_t *destBuffer, long frames,
-									  int asioType, AVSampleFormat format);
+		bool selectConverter();
+
+		// ASIO to engine sample conversion, selected at start()
+		SampleConverter m_converter;
 	};
 
 } // namespace AudioEngine
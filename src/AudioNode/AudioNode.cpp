@@ -77,6 +77,8 @@ namespace AudioEngine
 			return "file_source";
 		case AudioNode::NodeType::FILE_SINK:
 			return "file_sink";
+		case AudioNode::NodeType::PLAYLIST_SOURCE:
+			return "playlist_source";
 		case AudioNode::NodeType::FFMPEG_PROCESSOR:
 			return "ffmpeg_processor";
 		case AudioNode::NodeType::CUSTOM:
@@ -97,6 +99,8 @@ namespace AudioEngine
 			return AudioNode::NodeType::FILE_SOURCE;
 		else if (typeStr == "file_sink")
 			return AudioNode::NodeType::FILE_SINK;
+		else if (typeStr == "playlist_source")
+			return AudioNode::NodeType::PLAYLIST_SOURCE;
 		else if (typeStr == "ffmpeg_processor")
 			return AudioNode::NodeType::FFMPEG_PROCESSOR;
 		else if (typeStr == "custom")
@@ -37,6 +37,7 @@ namespace AudioEngine
 			ASIO_SINK,
 			FILE_SOURCE,
 			FILE_SINK,
+			PLAYLIST_SOURCE,
 			FFMPEG_PROCESSOR,
 			CUSTOM
 		};
@@ -171,6 +172,35 @@ namespace AudioEngine
 		 */
 		virtual bool sendControlMessage(const std::string &messageType, const std::map<std::string, std::string> &params);
 
+		/**
+		 * @brief Switch between real-time and offline rendering
+		 *
+		 * Called before start(). Offline, there is no deadline: nodes with worker
+		 * threads wait for each other instead of dropping or substituting data.
+		 *
+		 * @param offline true for offline rendering
+		 */
+		virtual void setOfflineMode(bool /*offline*/) {}
+
+		/**
+		 * @brief Notify the node that all of its inputs have ended
+		 *
+		 * Called once during offline rendering. Nodes with internal delay emit
+		 * the audio they still hold from the following process() calls.
+		 */
+		virtual void endOfStream() {}
+
+		/**
+		 * @brief Check whether the node has no more output to produce
+		 *
+		 * The offline renderer treats a node as finished once its inputs have
+		 * ended, it produced no output in a block and this returns true. Sources
+		 * return true at the end of their media.
+		 *
+		 * @return bool True if nothing is left to emit
+		 */
+		virtual bool isDrained() const { return true; }
+
 	protected:
 		std::string m_name;				 // Node name
 		AudioEngine *m_engine;			 // Pointer to the engine
@@ -0,0 +1,1181 @@
+#include "DspNodes.h"
+#include "AudioBufferPool.h"
+#include "MatrixMixerNode.h"
+#include "MeterNode.h"
+#include "ResamplerNode.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <nlohmann/json.hpp>
+
+namespace AudioEngine
+{
+
+	namespace
+	{
+		constexpr double PI = 3.14159265358979323846;
+
+		// Upper bound for the mixer's pad count
+		constexpr int MAX_MIX_INPUTS = 64;
+
+		// JSON scalars and arrays as the comma separated strings the nodes parse
+		std::string paramToString(const nlohmann::json &value)
+		{
+			if (value.is_string())
+			{
+				return value.get<std::string>();
+			}
+			if (value.is_array())
+			{
+				std::string text;
+				for (const auto &element : value)
+				{
+					if (!text.empty())
+					{
+						text += ",";
+					}
+					text += paramToString(element);
+				}
+				return text;
+			}
+			return value.dump();
+		}
+	}
+
+	//--------------------------------------------------------------------------
+	// DspNode
+	//--------------------------------------------------------------------------
+
+	DspNode::DspNode(const std::string &name, AudioEngine *engine, int inputPads)
+		: AudioNode(name, engine),
+		  m_kernels(DspKernels::get()),
+		  m_channels(0),
+		  m_inputs(static_cast<size_t>(std::max(1, inputPads))),
+		  m_outputLayout{}
+	{
+	}
+
+	DspNode::~DspNode()
+	{
+		// The base destructor can't reach our stop() any more
+		if (m_running)
+		{
+			stop();
+		}
+		av_channel_layout_uninit(&m_outputLayout);
+	}
+
+	bool DspNode::configure(const std::string &params, double sampleRate, long bufferSize,
+							AVSampleFormat format, AVChannelLayout channelLayout)
+	{
+		if (m_running)
+		{
+			reportStatus("Error", "Cannot configure while running");
+			return false;
+		}
+
+		if (format != AV_SAMPLE_FMT_FLTP)
+		{
+			reportStatus("Error", "Only planar float audio is supported");
+			return false;
+		}
+
+		if (channelLayout.nb_channels <= 0 || sampleRate <= 0 || bufferSize <= 0)
+		{
+			reportStatus("Error", "Invalid stream parameters");
+			return false;
+		}
+
+		std::map<std::string, std::string> paramMap;
+		if (!params.empty())
+		{
+			try
+			{
+				const nlohmann::json json = nlohmann::json::parse(params);
+				if (!json.is_object())
+				{
+					reportStatus("Error", "Parameters must be a JSON object");
+					return false;
+				}
+				for (const auto &item : json.items())
+				{
+					paramMap[item.key()] = paramToString(item.value());
+				}
+			}
+			catch (const nlohmann::json::exception &e)
+			{
+				reportStatus("Error", std::string("Invalid parameters: ") + e.what());
+				return false;
+			}
+		}
+
+		m_sampleRate = sampleRate;
+		m_bufferSize = bufferSize;
+		m_format = format;
+		av_channel_layout_uninit(&m_channelLayout);
+		if (av_channel_layout_copy(&m_channelLayout, &channelLayout) < 0)
+		{
+			reportStatus("Error", "Failed to copy channel layout");
+			return false;
+		}
+		m_channels = m_channelLayout.nb_channels;
+		av_channel_layout_uninit(&m_outputLayout);
+		av_channel_layout_copy(&m_outputLayout, &m_channelLayout);
+
+		m_configured = false;
+		if (!configureParameters(paramMap))
+		{
+			return false;
+		}
+
+		releaseInputs();
+		m_outputBuffer.reset();
+		m_bypassed = false;
+		resetState();
+
+		m_configured = true;
+		return true;
+	}
+
+	bool DspNode::start()
+	{
+		if (!m_configured)
+		{
+			reportStatus("Error", "Cannot start - not configured");
+			return false;
+		}
+
+		m_running = true;
+		return true;
+	}
+
+	void DspNode::stop()
+	{
+		m_running = false;
+		releaseInputs();
+		m_outputBuffer.reset();
+	}
+
+	void DspNode::reset()
+	{
+		releaseInputs();
+		m_outputBuffer.reset();
+		m_bypassed = false;
+		resetState();
+	}
+
+	bool DspNode::process()
+	{
+		if (!m_running)
+		{
+			return false;
+		}
+
+		applyPendingReset();
+
+		// Keep last block's buffer for in-place reuse; consumers already dropped theirs
+		std::shared_ptr<AudioBuffer> previous = std::move(m_outputBuffer);
+		m_outputBuffer.reset();
+
+		long frames = 0;
+		for (size_t pad = 0; pad < m_inputs.size(); pad++)
+		{
+			frames = std::max(frames, inputFrames(static_cast<int>(pad)));
+		}
+
+		if (frames == 0)
+		{
+			if (!hasTail())
+			{
+				return true;
+			}
+			frames = m_bufferSize;
+		}
+
+		if (m_inputs.size() == 1 && m_inputs[0] && canBypass())
+		{
+			m_outputBuffer = std::move(m_inputs[0]);
+			m_bypassed = true;
+			return true;
+		}
+
+		if (!previous || previous->getFrameCount() != frames || !AudioBuffer::prepareForWrite(previous))
+		{
+			previous = AudioBufferPool::shared().acquire(frames, m_sampleRate, m_format, m_outputLayout);
+		}
+		if (!previous)
+		{
+			releaseInputs();
+			reportStatus("Error", "Failed to allocate output buffer");
+			return false;
+		}
+
+		const bool rendered = render(*previous, frames);
+		releaseInputs();
+		m_bypassed = false;
+		if (!rendered)
+		{
+			return false;
+		}
+
+		previous->publish();
+		m_outputBuffer = std::move(previous);
+		return true;
+	}
+
+	void DspNode::applyPendingReset()
+	{
+		if (m_resetRequested.exchange(false, std::memory_order_acq_rel))
+		{
+			resetState();
+		}
+	}
+
+	bool DspNode::setInputBuffer(std::shared_ptr<AudioBuffer> buffer, int padIndex)
+	{
+		if (padIndex < 0 || padIndex >= getInputPadCount())
+		{
+			reportStatus("Error", "Invalid input pad index: " + std::to_string(padIndex));
+			return false;
+		}
+
+		if (!m_running)
+		{
+			return false;
+		}
+
+		if (buffer && !validateInput(buffer, padIndex))
+		{
+			return false;
+		}
+
+		m_inputs[padIndex] = std::move(buffer);
+		return true;
+	}
+
+	std::shared_ptr<AudioBuffer> DspNode::getOutputBuffer(int padIndex)
+	{
+		if (padIndex != 0 || !m_running)
+		{
+			return nullptr;
+		}
+		return m_outputBuffer;
+	}
+
+	bool DspNode::sendControlMessage(const std::string &messageType, const std::map<std::string, std::string> &params)
+	{
+		if (messageType == "set_parameter")
+		{
+			auto param = params.find("param");
+			auto value = params.find("value");
+			if (param == params.end() || value == params.end())
+			{
+				reportStatus("Error", "set_parameter requires 'param' and 'value'");
+				return false;
+			}
+			return setParameter(param->second, value->second);
+		}
+
+		if (messageType == "reset")
+		{
+			// Applied by the processing thread before the next block
+			m_resetRequested.store(true, std::memory_order_release);
+			return true;
+		}
+
+		return AudioNode::sendControlMessage(messageType, params);
+	}
+
+	bool DspNode::parseNumber(const std::string &param, const std::string &text, double &value)
+	{
+		const char *begin = text.c_str();
+		char *end = nullptr;
+		const double parsed = std::strtod(begin, &end);
+		while (end && (*end == ' ' || *end == '\t'))
+		{
+			end++;
+		}
+		if (end == begin || !end || *end != '\0' || !std::isfinite(parsed))
+		{
+			reportStatus("Error", "Invalid value for '" + param + "': " + text);
+			return false;
+		}
+
+		value = parsed;
+		return true;
+	}
+
+	std::vector<std::string> DspNode::splitList(const std::string &text)
+	{
+		std::vector<std::string> items;
+		std::string item;
+		for (char c : text)
+		{
+			if (c == ',' || c == ' ' || c == '\t' || c == '[' || c == ']' || c == '"')
+			{
+				if (!item.empty())
+				{
+					items.push_back(item);
+					item.clear();
+				}
+			}
+			else
+			{
+				item += c;
+			}
+		}
+		if (!item.empty())
+		{
+			items.push_back(item);
+		}
+		return items;
+	}
+
+	float DspNode::dbToGain(double db)
+	{
+		return static_cast<float>(std::pow(10.0, db / 20.0));
+	}
+
+	bool DspNode::validateInput(const std::shared_ptr<AudioBuffer> &buffer, int padIndex)
+	{
+		if (buffer->getFormat() != AV_SAMPLE_FMT_FLTP || buffer->getChannelCount() != m_channels)
+		{
+			reportStatus("Error", "Input " + std::to_string(padIndex) + " must be planar float with " +
+									  std::to_string(m_channels) + " channels");
+			return false;
+		}
+		return true;
+	}
+
+	void DspNode::releaseInputs()
+	{
+		for (auto &input : m_inputs)
+		{
+			input.reset();
+		}
+	}
+
+	//--------------------------------------------------------------------------
+	// GainNode
+	//--------------------------------------------------------------------------
+
+	bool GainNode::configureParameters(const std::map<std::string, std::string> &params)
+	{
+		m_gain.store(1.0f);
+		if (params.count("gain_db"))
+		{
+			return setParameter("gain_db", params.at("gain_db"));
+		}
+		if (params.count("gain"))
+		{
+			return setParameter("gain", params.at("gain"));
+		}
+		return true;
+	}
+
+	bool GainNode::setParameter(const std::string &param, const std::string &value)
+	{
+		double parsed = 0.0;
+		if (param == "gain_db")
+		{
+			if (!parseNumber(param, value, parsed))
+			{
+				return false;
+			}
+			m_gain.store(dbToGain(parsed), std::memory_order_relaxed);
+			return true;
+		}
+		if (param == "gain")
+		{
+			if (!parseNumber(param, value, parsed))
+			{
+				return false;
+			}
+			m_gain.store(static_cast<float>(parsed), std::memory_order_relaxed);
+			return true;
+		}
+
+		reportStatus("Warning", "Unknown parameter: " + param);
+		return false;
+	}
+
+	bool GainNode::canBypass() const
+	{
+		const float target = m_gain.load(std::memory_order_relaxed);
+		return target == 1.0f && m_ramp.isSteady(target);
+	}
+
+	void GainNode::resetState()
+	{
+		m_ramp.current = m_gain.load(std::memory_order_relaxed);
+	}
+
+	bool GainNode::render(AudioBuffer &output, long frames)
+	{
+		const float start = m_ramp.begin(m_gain.load(std::memory_order_relaxed), frames);
+		for (int c = 0; c < m_channels; c++)
+		{
+			m_kernels.gain(inputChannel(0, c), outputChannel(output, c), frames, start, m_ramp.step);
+		}
+		return true;
+	}
+
+	//--------------------------------------------------------------------------
+	// PolarityNode
+	//--------------------------------------------------------------------------
+
+	bool PolarityNode::configureParameters(const std::map<std::string, std::string> &params)
+	{
+		auto channels = params.find("channels");
+		return setParameter("channels", channels != params.end() ? channels->second : "all");
+	}
+
+	bool PolarityNode::setParameter(const std::string &param, const std::string &value)
+	{
+		if (param != "channels")
+		{
+			reportStatus("Warning", "Unknown parameter: " + param);
+			return false;
+		}
+
+		if (value == "all")
+		{
+			m_invertAll.store(true, std::memory_order_relaxed);
+			m_invertMask.store(0, std::memory_order_relaxed);
+			return true;
+		}
+
+		uint64_t mask = 0;
+		if (value != "none")
+		{
+			for (const auto &item : splitList(value))
+			{
+				double index = 0.0;
+				if (!parseNumber(param, item, index))
+				{
+					return false;
+				}
+				if (index < 0 || index >= std::min(m_channels, MAX_CHANNELS) || index != std::floor(index))
+				{
+					reportStatus("Error", "Invalid polarity channel: " + item);
+					return false;
+				}
+				mask |= uint64_t(1) << static_cast<int>(index);
+			}
+		}
+
+		m_invertAll.store(false, std::memory_order_relaxed);
+		m_invertMask.store(mask, std::memory_order_relaxed);
+		return true;
+	}
+
+	float PolarityNode::targetSign(int channel) const
+	{
+		if (m_invertAll.load(std::memory_order_relaxed))
+		{
+			return -1.0f;
+		}
+		const bool inverted = channel < MAX_CHANNELS &&
+							  (m_invertMask.load(std::memory_order_relaxed) >> channel) & 1;
+		return inverted ? -1.0f : 1.0f;
+	}
+
+	bool PolarityNode::canBypass() const
+	{
+		for (int c = 0; c < m_channels; c++)
+		{
+			if (targetSign(c) != 1.0f || !m_signs[c].isSteady(1.0f))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void PolarityNode::resetState()
+	{
+		m_signs.assign(static_cast<size_t>(m_channels), Ramp{});
+		for (int c = 0; c < m_channels; c++)
+		{
+			m_signs[c].current = targetSign(c);
+		}
+	}
+
+	bool PolarityNode::render(AudioBuffer &output, long frames)
+	{
+		for (int c = 0; c < m_channels; c++)
+		{
+			Ramp &sign = m_signs[c];
+			const float start = sign.begin(targetSign(c), frames);
+			m_kernels.gain(inputChannel(0, c), outputChannel(output, c), frames, start, sign.step);
+		}
+		return true;
+	}
+
+	//--------------------------------------------------------------------------
+	// PanNode
+	//--------------------------------------------------------------------------
+
+	bool PanNode::configureParameters(const std::map<std::string, std::string> &params)
+	{
+		m_pan.store(0.0f);
+		m_equalPower.store(false);
+
+		if (params.count("law") && !setParameter("law", params.at("law")))
+		{
+			return false;
+		}
+		if (params.count("pan") && !setParameter("pan", params.at("pan")))
+		{
+			return false;
+		}
+		return true;
+	}
+
+	bool PanNode::setParameter(const std::string &param, const std::string &value)
+	{
+		if (param == "pan")
+		{
+			double pan = 0.0;
+			if (!parseNumber(param, value, pan))
+			{
+				return false;
+			}
+			if (pan < -1.0 || pan > 1.0)
+			{
+				reportStatus("Error", "Pan must be between -1 and 1: " + value);
+				return false;
+			}
+			m_pan.store(static_cast<float>(pan), std::memory_order_relaxed);
+			return true;
+		}
+		if (param == "law")
+		{
+			if (value != "balance" && value != "equal_power")
+			{
+				reportStatus("Error", "Unknown pan law: " + value);
+				return false;
+			}
+			m_equalPower.store(value == "equal_power", std::memory_order_relaxed);
+			return true;
+		}
+
+		reportStatus("Warning", "Unknown parameter: " + param);
+		return false;
+	}
+
+	void PanNode::targetGains(float &left, float &right) const
+	{
+		const float pan = m_pan.load(std::memory_order_relaxed);
+		if (m_equalPower.load(std::memory_order_relaxed))
+		{
+			// Unity at the center, sin/cos law towards the sides
+			const double angle = (pan + 1.0) * PI / 4.0;
+			left = static_cast<float>(std::sqrt(2.0) * std::cos(angle));
+			right = static_cast<float>(std::sqrt(2.0) * std::sin(angle));
+		}
+		else
+		{
+			left = pan > 0.0f ? 1.0f - pan : 1.0f;
+			right = pan < 0.0f ? 1.0f + pan : 1.0f;
+		}
+	}
+
+	bool PanNode::canBypass() const
+	{
+		float left = 1.0f;
+		float right = 1.0f;
+		targetGains(left, right);
+		return left == 1.0f && right == 1.0f && m_left.isSteady(left) && m_right.isSteady(right);
+	}
+
+	void PanNode::resetState()
+	{
+		targetGains(m_left.current, m_right.current);
+	}
+
+	bool PanNode::render(AudioBuffer &output, long frames)
+	{
+		float left = 1.0f;
+		float right = 1.0f;
+		targetGains(left, right);
+		const float leftStart = m_left.begin(left, frames);
+		const float rightStart = m_right.begin(right, frames);
+
+		int c = 0;
+		for (; c + 1 < m_channels; c += 2)
+		{
+			m_kernels.gain(inputChannel(0, c), outputChannel(output, c), frames, leftStart, m_left.step);
+			m_kernels.gain(inputChannel(0, c + 1), outputChannel(output, c + 1), frames, rightStart, m_right.step);
+		}
+		if (c < m_channels)
+		{
+			std::memcpy(outputChannel(output, c), inputChannel(0, c), static_cast<size_t>(frames) * sizeof(float));
+		}
+		return true;
+	}
+
+	//--------------------------------------------------------------------------
+	// MixNode
+	//--------------------------------------------------------------------------
+
+	MixNode::MixNode(const std::string &name, AudioEngine *engine, int inputs)
+		: DspNode(name, engine, std::min(std::max(inputs, 1), MAX_MIX_INPUTS)),
+		  m_gains(new std::atomic<float>[static_cast<size_t>(getInputPadCount())]),
+		  m_ramps(static_cast<size_t>(getInputPadCount()))
+	{
+		for (int i = 0; i < getInputPadCount(); i++)
+		{
+			m_gains[i].store(1.0f);
+		}
+	}
+
+	bool MixNode::configureParameters(const std::map<std::string, std::string> &params)
+	{
+		const int inputs = getInputPadCount();
+		for (int i = 0; i < inputs; i++)
+		{
+			m_gains[i].store(1.0f);
+		}
+
+		if (params.count("gains_db") && !setParameter("gains_db", params.at("gains_db")))
+		{
+			return false;
+		}
+
+		for (const auto &[key, value] : params)
+		{
+			if (key.compare(0, 5, "gain_") == 0 && !setParameter(key, value))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool MixNode::setParameter(const std::string &param, const std::string &value)
+	{
+		if (param == "gains_db")
+		{
+			const auto items = splitList(value);
+			if (items.size() > static_cast<size_t>(getInputPadCount()))
+			{
+				reportStatus("Error", "More gains than inputs: " + value);
+				return false;
+			}
+			for (size_t i = 0; i < items.size(); i++)
+			{
+				if (!setInputGain(static_cast<int>(i), items[i]))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// gain_<n>_db
+		const std::string suffix = "_db";
+		if (param.size() > 5 + suffix.size() && param.compare(0, 5, "gain_") == 0 &&
+			param.compare(param.size() - suffix.size(), suffix.size(), suffix) == 0)
+		{
+			const std::string index = param.substr(5, param.size() - 5 - suffix.size());
+			char *end = nullptr;
+			const long input = std::strtol(index.c_str(), &end, 10);
+			if (*end == '\0' && input >= 0 && input < getInputPadCount())
+			{
+				return setInputGain(static_cast<int>(input), value);
+			}
+			reportStatus("Error", "Invalid mixer input in '" + param + "'");
+			return false;
+		}
+
+		reportStatus("Warning", "Unknown parameter: " + param);
+		return false;
+	}
+
+	bool MixNode::setInputGain(int input, const std::string &value)
+	{
+		double db = 0.0;
+		if (!parseNumber("gain_" + std::to_string(input) + "_db", value, db))
+		{
+			return false;
+		}
+		m_gains[input].store(dbToGain(db), std::memory_order_relaxed);
+		return true;
+	}
+
+	void MixNode::resetState()
+	{
+		for (int i = 0; i < getInputPadCount(); i++)
+		{
+			m_ramps[i].current = m_gains[i].load(std::memory_order_relaxed);
+		}
+	}
+
+	bool MixNode::render(AudioBuffer &output, long frames)
+	{
+		bool first = true;
+		for (int pad = 0; pad < getInputPadCount(); pad++)
+		{
+			Ramp &ramp = m_ramps[pad];
+			const float start = ramp.begin(m_gains[pad].load(std::memory_order_relaxed), frames);
+			const long available = std::min(frames, inputFrames(pad));
+			if (available == 0)
+			{
+				continue;
+			}
+
+			for (int c = 0; c < m_channels; c++)
+			{
+				float *out = outputChannel(output, c);
+				if (first)
+				{
+					m_kernels.gain(inputChannel(pad, c), out, available, start, ramp.step);
+					std::fill(out + available, out + frames, 0.0f);
+				}
+				else
+				{
+					m_kernels.mix(inputChannel(pad, c), out, available, start, ramp.step);
+				}
+			}
+			first = false;
+		}
+
+		if (first)
+		{
+			output.clear();
+		}
+		return true;
+	}
+
+	//--------------------------------------------------------------------------
+	// DelayNode
+	//--------------------------------------------------------------------------
+
+	bool DelayNode::configureParameters(const std::map<std::string, std::string> &params)
+	{
+		double maxDelayMs = 1000.0;
+		if (params.count("max_delay_ms") && !parseNumber("max_delay_ms", params.at("max_delay_ms"), maxDelayMs))
+		{
+			return false;
+		}
+		if (maxDelayMs < 0.0)
+		{
+			reportStatus("Error", "max_delay_ms must not be negative");
+			return false;
+		}
+
+		// The initial delay may raise the limit; later changes may not
+		m_maxDelay = std::numeric_limits<long>::max() / 2;
+		m_delay.store(0);
+		if (params.count("delay_samples") && !setDelay("delay_samples", params.at("delay_samples")))
+		{
+			return false;
+		}
+		if (params.count("delay_ms") && !setDelay("delay_ms", params.at("delay_ms")))
+		{
+			return false;
+		}
+		m_maxDelay = std::max(static_cast<long>(std::lround(maxDelayMs * m_sampleRate / 1000.0)), m_delay.load());
+
+		// Room for the longest tap plus a few blocks of any size the graph delivers
+		m_lineSize = m_maxDelay + 4 * m_bufferSize;
+		m_lines.assign(static_cast<size_t>(m_channels), std::vector<float>(static_cast<size_t>(m_lineSize), 0.0f));
+		return true;
+	}
+
+	bool DelayNode::setParameter(const std::string &param, const std::string &value)
+	{
+		if (param == "delay_ms" || param == "delay_samples")
+		{
+			return setDelay(param, value);
+		}
+
+		reportStatus("Warning", "Unknown parameter: " + param);
+		return false;
+	}
+
+	bool DelayNode::setDelay(const std::string &param, const std::string &value)
+	{
+		double delay = 0.0;
+		if (!parseNumber(param, value, delay))
+		{
+			return false;
+		}
+		if (param == "delay_ms")
+		{
+			delay = delay * m_sampleRate / 1000.0;
+		}
+
+		const long frames = std::lround(delay);
+		if (frames < 0 || frames > m_maxDelay)
+		{
+			reportStatus("Error", "Delay out of range (0.." + std::to_string(m_maxDelay) + " samples): " + value);
+			return false;
+		}
+
+		m_delay.store(frames, std::memory_order_relaxed);
+		return true;
+	}
+
+	void DelayNode::endOfStream()
+	{
+		m_endOfStream = true;
+		m_tailFrames = std::max(m_currentDelay, m_delay.load(std::memory_order_relaxed));
+	}
+
+	bool DelayNode::canBypass() const
+	{
+		return m_currentDelay == 0 && m_delay.load(std::memory_order_relaxed) == 0 && !m_endOfStream;
+	}
+
+	void DelayNode::resetState()
+	{
+		for (auto &line : m_lines)
+		{
+			std::fill(line.begin(), line.end(), 0.0f);
+		}
+		m_writePosition = 0;
+		m_currentDelay = m_delay.load(std::memory_order_relaxed);
+		m_endOfStream = false;
+		m_tailFrames = 0;
+	}
+
+	void DelayNode::readTap(int channel, long delay, long frames, float *out, float gain, float step, bool accumulate) const
+	{
+		const float *line = m_lines[channel].data();
+		const long start = (m_writePosition - delay + m_lineSize) % m_lineSize;
+		const long first = std::min(frames, m_lineSize - start);
+		const DspKernels::GainKernel kernel = accumulate ? m_kernels.mix : m_kernels.gain;
+
+		kernel(line + start, out, first, gain, step);
+		if (first < frames)
+		{
+			kernel(line, out + first, frames - first, gain + step * static_cast<float>(first), step);
+		}
+	}
+
+	bool DelayNode::render(AudioBuffer &output, long frames)
+	{
+		if (frames > m_lineSize - m_maxDelay)
+		{
+			reportStatus("Error", "Block of " + std::to_string(frames) + " frames exceeds the delay line");
+			return false;
+		}
+
+		// Forwarded blocks were never written to the line
+		if (m_bypassed)
+		{
+			for (auto &line : m_lines)
+			{
+				std::fill(line.begin(), line.end(), 0.0f);
+			}
+		}
+
+		// Write the block first so a zero-sample tap reads the current input
+		const long first = std::min(frames, m_lineSize - m_writePosition);
+		for (int c = 0; c < m_channels; c++)
+		{
+			float *line = m_lines[c].data();
+			const float *in = inputChannel(0, c);
+			const long available = std::min(frames, inputFrames(0));
+			for (long i = 0; i < frames; i++)
+			{
+				line[(i < first ? m_writePosition : m_writePosition - m_lineSize) + i] = i < available ? in[i] : 0.0f;
+			}
+		}
+		m_writePosition = (m_writePosition + frames) % m_lineSize;
+
+		// Reads are relative to the end of the block just written
+		const long target = m_delay.load(std::memory_order_relaxed);
+		for (int c = 0; c < m_channels; c++)
+		{
+			float *out = outputChannel(output, c);
+			if (target == m_currentDelay)
+			{
+				readTap(c, target + frames, frames, out, 1.0f, 0.0f, false);
+			}
+			else
+			{
+				const float step = 1.0f / static_cast<float>(frames);
+				readTap(c, m_currentDelay + frames, frames, out, 1.0f, -step, false);
+				readTap(c, target + frames, frames, out, 0.0f, step, true);
+			}
+		}
+		m_currentDelay = target;
+
+		if (m_endOfStream)
+		{
+			m_tailFrames -= frames;
+		}
+		return true;
+	}
+
+	//--------------------------------------------------------------------------
+	// BiquadNode
+	//--------------------------------------------------------------------------
+
+	bool BiquadNode::parseFilterType(const std::string &text, FilterType &type)
+	{
+		static const std::map<std::string, FilterType> types = {
+			{"lowpass", FilterType::LOWPASS},
+			{"highpass", FilterType::HIGHPASS},
+			{"bandpass", FilterType::BANDPASS},
+			{"notch", FilterType::NOTCH},
+			{"peaking", FilterType::PEAKING},
+			{"lowshelf", FilterType::LOWSHELF},
+			{"highshelf", FilterType::HIGHSHELF},
+			{"allpass", FilterType::ALLPASS}};
+
+		auto it = types.find(text);
+		if (it == types.end())
+		{
+			return false;
+		}
+		type = it->second;
+		return true;
+	}
+
+	bool BiquadNode::configureParameters(const std::map<std::string, std::string> &params)
+	{
+		m_filterType.store(static_cast<int>(FilterType::PEAKING));
+		m_frequency.store(1000.0f);
+		m_q.store(0.707f);
+		m_gainDb.store(0.0f);
+
+		for (const char *param : {"type", "freq", "q", "gain_db"})
+		{
+			if (params.count(param) && !setParameter(param, params.at(param)))
+			{
+				return false;
+			}
+		}
+
+		m_state.assign(static_cast<size_t>(2 * m_channels), 0.0f);
+		m_inputPlanes.resize(static_cast<size_t>(m_channels));
+		m_outputPlanes.resize(static_cast<size_t>(m_channels));
+		m_version.fetch_add(1);
+		return true;
+	}
+
+	bool BiquadNode::setParameter(const std::string &param, const std::string &value)
+	{
+		if (param == "type")
+		{
+			FilterType type;
+			if (!parseFilterType(value, type))
+			{
+				reportStatus("Error", "Unknown filter type: " + value);
+				return false;
+			}
+			m_filterType.store(static_cast<int>(type), std::memory_order_relaxed);
+		}
+		else if (param == "freq" || param == "q" || param == "gain_db")
+		{
+			double parsed = 0.0;
+			if (!parseNumber(param, value, parsed))
+			{
+				return false;
+			}
+
+			if (param == "freq")
+			{
+				if (parsed <= 0.0 || parsed >= m_sampleRate / 2.0)
+				{
+					reportStatus("Error", "Frequency must be between 0 and Nyquist: " + value);
+					return false;
+				}
+				m_frequency.store(static_cast<float>(parsed), std::memory_order_relaxed);
+			}
+			else if (param == "q")
+			{
+				if (parsed <= 0.0)
+				{
+					reportStatus("Error", "Q must be positive: " + value);
+					return false;
+				}
+				m_q.store(static_cast<float>(parsed), std::memory_order_relaxed);
+			}
+			else
+			{
+				m_gainDb.store(static_cast<float>(parsed), std::memory_order_relaxed);
+			}
+		}
+		else
+		{
+			reportStatus("Warning", "Unknown parameter: " + param);
+			return false;
+		}
+
+		m_version.fetch_add(1, std::memory_order_release);
+		return true;
+	}
+
+	BiquadCoefficients BiquadNode::designFilter(FilterType type, double sampleRate, double frequency, double q, double gainDb)
+	{
+		// Robert Bristow-Johnson, "Cookbook formulae for audio EQ biquad filter coefficients"
+		const double a = std::pow(10.0, gainDb / 40.0);
+		const double w0 = 2.0 * PI * std::min(frequency, sampleRate * 0.499) / sampleRate;
+		const double cosw = std::cos(w0);
+		const double alpha = std::sin(w0) / (2.0 * q);
+		const double shelf = 2.0 * std::sqrt(a) * alpha;
+
+		double b0 = 1.0, b1 = 0.0, b2 = 0.0, a0 = 1.0, a1 = 0.0, a2 = 0.0;
+		switch (type)
+		{
+		case FilterType::LOWPASS:
+			b0 = (1.0 - cosw) / 2.0;
+			b1 = 1.0 - cosw;
+			b2 = b0;
+			a0 = 1.0 + alpha;
+			a1 = -2.0 * cosw;
+			a2 = 1.0 - alpha;
+			break;
+		case FilterType::HIGHPASS:
+			b0 = (1.0 + cosw) / 2.0;
+			b1 = -(1.0 + cosw);
+			b2 = b0;
+			a0 = 1.0 + alpha;
+			a1 = -2.0 * cosw;
+			a2 = 1.0 - alpha;
+			break;
+		case FilterType::BANDPASS:
+			b0 = alpha;
+			b1 = 0.0;
+			b2 = -alpha;
+			a0 = 1.0 + alpha;
+			a1 = -2.0 * cosw;
+			a2 = 1.0 - alpha;
+			break;
+		case FilterType::NOTCH:
+			b0 = 1.0;
+			b1 = -2.0 * cosw;
+			b2 = 1.0;
+			a0 = 1.0 + alpha;
+			a1 = -2.0 * cosw;
+			a2 = 1.0 - alpha;
+			break;
+		case FilterType::PEAKING:
+			b0 = 1.0 + alpha * a;
+			b1 = -2.0 * cosw;
+			b2 = 1.0 - alpha * a;
+			a0 = 1.0 + alpha / a;
+			a1 = -2.0 * cosw;
+			a2 = 1.0 - alpha / a;
+			break;
+		case FilterType::LOWSHELF:
+			b0 = a * ((a + 1.0) - (a - 1.0) * cosw + shelf);
+			b1 = 2.0 * a * ((a - 1.0) - (a + 1.0) * cosw);
+			b2 = a * ((a + 1.0) - (a - 1.0) * cosw - shelf);
+			a0 = (a + 1.0) + (a - 1.0) * cosw + shelf;
+			a1 = -2.0 * ((a - 1.0) + (a + 1.0) * cosw);
+			a2 = (a + 1.0) + (a - 1.0) * cosw - shelf;
+			break;
+		case FilterType::HIGHSHELF:
+			b0 = a * ((a + 1.0) + (a - 1.0) * cosw + shelf);
+			b1 = -2.0 * a * ((a - 1.0) + (a + 1.0) * cosw);
+			b2 = a * ((a + 1.0) + (a - 1.0) * cosw - shelf);
+			a0 = (a + 1.0) - (a - 1.0) * cosw + shelf;
+			a1 = 2.0 * ((a - 1.0) - (a + 1.0) * cosw);
+			a2 = (a + 1.0) - (a - 1.0) * cosw - shelf;
+			break;
+		case FilterType::ALLPASS:
+			b0 = 1.0 - alpha;
+			b1 = -2.0 * cosw;
+			b2 = 1.0 + alpha;
+			a0 = 1.0 + alpha;
+			a1 = -2.0 * cosw;
+			a2 = 1.0 - alpha;
+			break;
+		}
+
+		BiquadCoefficients coefficients;
+		coefficients.b0 = static_cast<float>(b0 / a0);
+		coefficients.b1 = static_cast<float>(b1 / a0);
+		coefficients.b2 = static_cast<float>(b2 / a0);
+		coefficients.a1 = static_cast<float>(a1 / a0);
+		coefficients.a2 = static_cast<float>(a2 / a0);
+		return coefficients;
+	}
+
+	void BiquadNode::resetState()
+	{
+		std::fill(m_state.begin(), m_state.end(), 0.0f);
+	}
+
+	bool BiquadNode::render(AudioBuffer &output, long frames)
+	{
+		// Coefficients switch at block boundaries; the transposed form keeps that smooth
+		const uint32_t version = m_version.load(std::memory_order_acquire);
+		if (version != m_appliedVersion)
+		{
+			m_coefficients = designFilter(static_cast<FilterType>(m_filterType.load(std::memory_order_relaxed)),
+										  m_sampleRate, m_frequency.load(std::memory_order_relaxed),
+										  m_q.load(std::memory_order_relaxed), m_gainDb.load(std::memory_order_relaxed));
+			m_appliedVersion = version;
+		}
+
+		const long available = inputFrames(0);
+		for (int c = 0; c < m_channels; c++)
+		{
+			m_inputPlanes[c] = inputChannel(0, c);
+			m_outputPlanes[c] = outputChannel(output, c);
+		}
+		m_kernels.biquad(m_inputPlanes.data(), m_outputPlanes.data(), m_channels, std::min(frames, available),
+						 m_coefficients, m_state.data());
+		return true;
+	}
+
+	//--------------------------------------------------------------------------
+	// Factory
+	//--------------------------------------------------------------------------
+
+	std::unique_ptr<AudioNode> createDspNode(const std::string &type, const std::string &name,
+											 const std::map<std::string, std::string> &params, AudioEngine *engine)
+	{
+		if (type == "gain")
+		{
+			return std::make_unique<GainNode>(name, engine);
+		}
+		if (type == "polarity")
+		{
+			return std::make_unique<PolarityNode>(name, engine);
+		}
+		if (type == "pan")
+		{
+			return std::make_unique<PanNode>(name, engine);
+		}
+		if (type == "mix")
+		{
+			auto inputs = params.find("inputs");
+			const int count = inputs != params.end() ? std::atoi(inputs->second.c_str()) : 2;
+			return std::make_unique<MixNode>(name, engine, count);
+		}
+		if (type == "delay")
+		{
+			return std::make_unique<DelayNode>(name, engine);
+		}
+		if (type == "biquad")
+		{
+			return std::make_unique<BiquadNode>(name, engine);
+		}
+		if (type == "meter")
+		{
+			return std::make_unique<MeterNode>(name, engine);
+		}
+		if (type == "resampler")
+		{
+			return std::make_unique<ResamplerNode>(name, engine);
+		}
+		if (type == "matrix_mixer")
+		{
+			auto pads = params.find("input_pads");
+			const int count = pads != params.end() ? std::atoi(pads->second.c_str()) : 1;
+			return std::make_unique<MatrixMixerNode>(name, engine, std::min(std::max(count, 1), MAX_MIX_INPUTS));
+		}
+		return nullptr;
+	}
+
+} // namespace AudioEngine
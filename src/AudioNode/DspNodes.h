@@ -0,0 +1,420 @@
+#pragma once
+
+#include "AudioNode.h"
+#include "DspKernels.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief Base class for the native DSP nodes
+	 *
+	 * Native nodes handle simple operations (gain, pan, mix, polarity, delay,
+	 * biquad EQ) on planar float buffers directly, so they skip the frame
+	 * wrapping, format negotiation and locking of an FfmpegProcessorNode. They
+	 * are NodeType::CUSTOM and take their settings from the node's "params".
+	 *
+	 * The execution plan orders every call on a node, so block processing takes
+	 * no locks. Parameters are atomics: sendControlMessage("set_parameter",
+	 * {"param", "value"}) may be called from any thread and the change is
+	 * ramped over the next block. Nodes whose settings have no effect forward
+	 * their input instead of copying it.
+	 *
+	 * Only AV_SAMPLE_FMT_FLTP is supported; the channel count comes from the
+	 * configured channel layout.
+	 */
+	class DspNode : public AudioNode
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * @param name Node name
+		 * @param engine Pointer to the engine this node belongs to
+		 * @param inputPads Number of input pads
+		 */
+		DspNode(const std::string &name, AudioEngine *engine, int inputPads = 1);
+
+		/**
+		 * @brief Destructor
+		 */
+		~DspNode() override;
+
+		NodeType getType() const override { return NodeType::CUSTOM; }
+
+		/**
+		 * @brief Get the node type name used in the configuration (e.g. "gain")
+		 */
+		virtual std::string getDspType() const = 0;
+
+		bool configure(const std::string &params, double sampleRate, long bufferSize,
+					   AVSampleFormat format, AVChannelLayout channelLayout) override;
+		bool start() override;
+		void stop() override;
+		bool process() override;
+		bool isRunning() const override { return m_running; }
+		bool setInputBuffer(std::shared_ptr<AudioBuffer> buffer, int padIndex = 0) override;
+		std::shared_ptr<AudioBuffer> getOutputBuffer(int padIndex = 0) override;
+		int getInputPadCount() const override { return static_cast<int>(m_inputs.size()); }
+		int getOutputPadCount() const override { return 1; }
+		void reset() override;
+
+		/**
+		 * @brief Handle a control message
+		 *
+		 * "set_parameter" takes "param" and "value"; "reset" clears the
+		 * processing state.
+		 */
+		bool sendControlMessage(const std::string &messageType, const std::map<std::string, std::string> &params) override;
+
+		/**
+		 * @brief Change a parameter
+		 *
+		 * Thread-safe; the new value takes effect from the next block.
+		 *
+		 * @param param Parameter name as in the configuration
+		 * @param value New value
+		 * @return true if the parameter exists and the value is valid
+		 */
+		virtual bool setParameter(const std::string &param, const std::string &value) = 0;
+
+	protected:
+		/**
+		 * @brief Linear per-block parameter smoothing
+		 *
+		 * Owned by the processing thread. Each block ramps from the value
+		 * reached at the end of the previous block to the current target.
+		 */
+		struct Ramp
+		{
+			float current = 0.0f;
+			float step = 0.0f;
+
+			/**
+			 * @brief Start a block that ends at target
+			 *
+			 * @return Gain of the first sample; sample i is at start + i * step
+			 */
+			float begin(float target, long frames)
+			{
+				const float start = current;
+				step = frames > 0 ? (target - start) / static_cast<float>(frames) : 0.0f;
+				current = target;
+				return start;
+			}
+
+			bool isSteady(float target) const { return current == target; }
+		};
+
+		const DspKernels &m_kernels;
+		int m_channels;
+		std::vector<std::shared_ptr<AudioBuffer>> m_inputs; // Per pad, consumed by process()
+		std::shared_ptr<AudioBuffer> m_outputBuffer;
+		AVChannelLayout m_outputLayout; // The input layout unless configureParameters() changes it
+		bool m_bypassed = false; // The previous block forwarded its input
+
+		/**
+		 * @brief Apply the node's parameters
+		 *
+		 * Called from configure() with the channel count and rates set.
+		 *
+		 * @param params Parameter map (list values are comma separated)
+		 * @return true if the parameters are valid
+		 */
+		virtual bool configureParameters(const std::map<std::string, std::string> &params) = 0;
+
+		/**
+		 * @brief Produce one block
+		 *
+		 * Missing inputs (nullptr in m_inputs) are silence.
+		 *
+		 * @param output Unpublished output with m_outputLayout
+		 * @param frames Frames to produce
+		 * @return true on success
+		 */
+		virtual bool render(AudioBuffer &output, long frames) = 0;
+
+		/**
+		 * @brief Check whether the current block can forward input 0 unchanged
+		 */
+		virtual bool canBypass() const { return false; }
+
+		/**
+		 * @brief Check whether the node still produces output without input
+		 */
+		virtual bool hasTail() const { return false; }
+
+		/**
+		 * @brief Clear filter and delay state
+		 */
+		virtual void resetState() {}
+
+		/**
+		 * @brief Get an input channel, or nullptr if the pad has no input
+		 */
+		const float *inputChannel(int pad, int channel) const
+		{
+			return m_inputs[pad] ? reinterpret_cast<const float *>(m_inputs[pad]->getPlaneData(channel)) : nullptr;
+		}
+
+		/**
+		 * @brief Get the frame count of an input, or 0 if the pad has no input
+		 */
+		long inputFrames(int pad) const { return m_inputs[pad] ? m_inputs[pad]->getFrameCount() : 0; }
+
+		static float *outputChannel(AudioBuffer &output, int channel)
+		{
+			return reinterpret_cast<float *>(output.getPlaneData(channel));
+		}
+
+		/**
+		 * @brief Apply a "reset" control message, if one is pending
+		 *
+		 * Called by process() before each block; nodes that replace
+		 * process() call it themselves.
+		 */
+		void applyPendingReset();
+
+		// Parameter parsing helpers; they report invalid values and leave the target unchanged
+		bool parseNumber(const std::string &param, const std::string &text, double &value);
+		static std::vector<std::string> splitList(const std::string &text);
+		static float dbToGain(double db);
+
+	private:
+		std::atomic<bool> m_resetRequested{false};
+
+		bool validateInput(const std::shared_ptr<AudioBuffer> &buffer, int padIndex);
+		void releaseInputs();
+	};
+
+	/**
+	 * @brief Gain ("gain")
+	 *
+	 * Params: "gain_db" (default 0) or linear "gain".
+	 */
+	class GainNode : public DspNode
+	{
+	public:
+		GainNode(const std::string &name, AudioEngine *engine) : DspNode(name, engine) {}
+
+		std::string getDspType() const override { return "gain"; }
+		bool setParameter(const std::string &param, const std::string &value) override;
+
+	protected:
+		bool configureParameters(const std::map<std::string, std::string> &params) override;
+		bool render(AudioBuffer &output, long frames) override;
+		bool canBypass() const override;
+		void resetState() override;
+
+	private:
+		std::atomic<float> m_gain{1.0f};
+		Ramp m_ramp;
+	};
+
+	/**
+	 * @brief Polarity inversion ("polarity")
+	 *
+	 * Params: "channels" = "all" (default) or a list of channel indices to
+	 * invert; "none" inverts nothing. Flips are ramped over one block.
+	 */
+	class PolarityNode : public DspNode
+	{
+	public:
+		PolarityNode(const std::string &name, AudioEngine *engine) : DspNode(name, engine) {}
+
+		std::string getDspType() const override { return "polarity"; }
+		bool setParameter(const std::string &param, const std::string &value) override;
+
+	protected:
+		bool configureParameters(const std::map<std::string, std::string> &params) override;
+		bool render(AudioBuffer &output, long frames) override;
+		bool canBypass() const override;
+		void resetState() override;
+
+	private:
+		static constexpr int MAX_CHANNELS = 64;
+
+		std::atomic<bool> m_invertAll{true};
+		std::atomic<uint64_t> m_invertMask{0}; // Bit n inverts channel n
+		std::vector<Ramp> m_signs;
+
+		float targetSign(int channel) const;
+	};
+
+	/**
+	 * @brief Stereo balance ("pan")
+	 *
+	 * Applied to channel pairs (0/1, 2/3, ...); an odd last channel passes
+	 * through. Params: "pan" from -1 (left) to 1 (right), "law" = "balance"
+	 * (attenuate the far side, default) or "equal_power" (constant power,
+	 * +3 dB on the near side at the extremes).
+	 */
+	class PanNode : public DspNode
+	{
+	public:
+		PanNode(const std::string &name, AudioEngine *engine) : DspNode(name, engine) {}
+
+		std::string getDspType() const override { return "pan"; }
+		bool setParameter(const std::string &param, const std::string &value) override;
+
+	protected:
+		bool configureParameters(const std::map<std::string, std::string> &params) override;
+		bool render(AudioBuffer &output, long frames) override;
+		bool canBypass() const override;
+		void resetState() override;
+
+	private:
+		std::atomic<float> m_pan{0.0f};
+		std::atomic<bool> m_equalPower{false};
+		Ramp m_left;
+		Ramp m_right;
+
+		void targetGains(float &left, float &right) const;
+	};
+
+	/**
+	 * @brief Summing mixer ("mix")
+	 *
+	 * Sums its input pads channel by channel. Params: "inputs" (pad count,
+	 * default 2), "gains_db" (list, one per input) or "gain_<n>_db". Missing
+	 * inputs count as silence.
+	 */
+	class MixNode : public DspNode
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * @param inputs Number of input pads (fixed for the life of the node)
+		 */
+		MixNode(const std::string &name, AudioEngine *engine, int inputs);
+
+		std::string getDspType() const override { return "mix"; }
+		bool setParameter(const std::string &param, const std::string &value) override;
+
+	protected:
+		bool configureParameters(const std::map<std::string, std::string> &params) override;
+		bool render(AudioBuffer &output, long frames) override;
+		void resetState() override;
+
+	private:
+		std::unique_ptr<std::atomic<float>[]> m_gains;
+		std::vector<Ramp> m_ramps;
+
+		bool setInputGain(int input, const std::string &value);
+	};
+
+	/**
+	 * @brief Delay line ("delay")
+	 *
+	 * Params: "delay_ms" or "delay_samples" (default 0), "max_delay_ms"
+	 * (memory to reserve, default 1000 or the initial delay). Delay changes
+	 * crossfade from the old to the new tap over one block. At end of stream
+	 * the delayed tail is emitted.
+	 */
+	class DelayNode : public DspNode
+	{
+	public:
+		DelayNode(const std::string &name, AudioEngine *engine) : DspNode(name, engine) {}
+
+		std::string getDspType() const override { return "delay"; }
+		bool setParameter(const std::string &param, const std::string &value) override;
+
+		void endOfStream() override;
+		bool isDrained() const override { return m_tailFrames <= 0; }
+
+	protected:
+		bool configureParameters(const std::map<std::string, std::string> &params) override;
+		bool render(AudioBuffer &output, long frames) override;
+		bool canBypass() const override;
+		bool hasTail() const override { return m_endOfStream && m_tailFrames > 0; }
+		void resetState() override;
+
+	private:
+		std::atomic<long> m_delay{0}; // Target delay in frames
+		long m_currentDelay = 0;
+		long m_maxDelay = 0;
+		std::vector<std::vector<float>> m_lines; // Per-channel ring
+		long m_lineSize = 0;
+		long m_writePosition = 0;
+		bool m_endOfStream = false;
+		long m_tailFrames = 0;
+
+		bool setDelay(const std::string &param, const std::string &value);
+		void readTap(int channel, long delay, long frames, float *out, float gain, float step, bool accumulate) const;
+	};
+
+	/**
+	 * @brief Biquad filter ("biquad")
+	 *
+	 * RBJ cookbook filters, the same for every channel. Params: "type" =
+	 * lowpass, highpass, bandpass, notch, peaking, lowshelf, highshelf or
+	 * allpass (default peaking); "freq" in Hz (default 1000); "q" (default
+	 * 0.707); "gain_db" for peaking and shelves (default 0). Coefficients are
+	 * recomputed on the processing thread when a parameter changes.
+	 */
+	class BiquadNode : public DspNode
+	{
+	public:
+		enum class FilterType
+		{
+			LOWPASS,
+			HIGHPASS,
+			BANDPASS,
+			NOTCH,
+			PEAKING,
+			LOWSHELF,
+			HIGHSHELF,
+			ALLPASS
+		};
+
+		BiquadNode(const std::string &name, AudioEngine *engine) : DspNode(name, engine) {}
+
+		std::string getDspType() const override { return "biquad"; }
+		bool setParameter(const std::string &param, const std::string &value) override;
+
+		/**
+		 * @brief Compute normalized RBJ coefficients
+		 */
+		static BiquadCoefficients designFilter(FilterType type, double sampleRate, double frequency, double q, double gainDb);
+
+	protected:
+		bool configureParameters(const std::map<std::string, std::string> &params) override;
+		bool render(AudioBuffer &output, long frames) override;
+		void resetState() override;
+
+	private:
+		std::atomic<int> m_filterType{static_cast<int>(FilterType::PEAKING)};
+		std::atomic<float> m_frequency{1000.0f};
+		std::atomic<float> m_q{0.707f};
+		std::atomic<float> m_gainDb{0.0f};
+		std::atomic<uint32_t> m_version{1}; // Bumped by every parameter change
+		uint32_t m_appliedVersion = 0;
+		BiquadCoefficients m_coefficients;
+		std::vector<float> m_state;
+		std::vector<const float *> m_inputPlanes;
+		std::vector<float *> m_outputPlanes;
+
+		static bool parseFilterType(const std::string &text, FilterType &type);
+	};
+
+	/**
+	 * @brief Create a native DSP node for a configuration type name
+	 *
+	 * @param type Node type from the configuration ("gain", "polarity", "pan",
+	 *             "mix", "delay", "biquad", "matrix_mixer", "meter" or "resampler")
+	 * @param name Node name
+	 * @param params Node parameters (the mixers' pad counts are fixed at creation)
+	 * @param engine Pointer to the engine
+	 * @return The node, or nullptr if the type is not a native DSP node
+	 */
+	std::unique_ptr<AudioNode> createDspNode(const std::string &type, const std::string &name,
+											 const std::map<std::string, std::string> &params, AudioEngine *engine);
+
+} // namespace AudioEngine
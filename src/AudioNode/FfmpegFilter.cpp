@@ -7,6 +7,7 @@ extern "C"
 #include <libavfilter/avfilter.h>
 #include <libavfilter/buffersink.h>
 #include <libavfilter/buffersrc.h>
+#include <libavutil/audio_fifo.h>
 #include <libavutil/opt.h>
 #include <libavutil/channel_layout.h>
 #include <libavutil/dict.h>
@@ -23,7 +24,12 @@ namespace AudioEngine
 		  m_sampleRate(0),
 		  m_format(AV_SAMPLE_FMT_NONE),
 		  m_bufferSize(0),
-		  m_valid(false)
+		  m_fifo(nullptr),
+		  m_pullFrame(nullptr),
+		  m_framesFed(0),
+		  m_framesRead(0),
+		  m_valid(false),
+		  m_inputClosed(false)
 	{
 		// Initialize channel layout to empty
 		av_channel_layout_default(&m_channelLayout, 0);
@@ -32,12 +38,19 @@ namespace AudioEngine
 	FfmpegFilter::~FfmpegFilter()
 	{
 		cleanup();
+		av_frame_free(&m_pullFrame);
+		av_channel_layout_uninit(&m_channelLayout);
 	}
 
 	void FfmpegFilter::cleanup()
 	{
 		std::lock_guard<std::mutex> lock(m_mutex);
+		releaseGraph();
+	}
 
+	void FfmpegFilter::releaseGraph()
+	{
+		// Caller holds m_mutex
 		m_namedFilters.clear();
 
 		// Free the filter graph
@@ -47,6 +60,12 @@ namespace AudioEngine
 			m_graph = nullptr;
 		}
 
+		if (m_fifo)
+		{
+			av_audio_fifo_free(m_fifo);
+			m_fifo = nullptr;
+		}
+
 		m_srcContext = nullptr;
 		m_sinkContext = nullptr;
 		m_valid = false;
@@ -69,6 +88,15 @@ namespace AudioEngine
 
 		m_namedFilters.clear();
 		m_valid = false;
+		m_inputClosed = false;
+
+		if (m_fifo)
+		{
+			av_audio_fifo_free(m_fifo);
+			m_fifo = nullptr;
+		}
+		m_framesFed = 0;
+		m_framesRead = 0;
 
 		// Store the configuration
 		m_filterDescription = filterDescription;
@@ -95,7 +123,7 @@ namespace AudioEngine
 		if (!abuffer || !abuffersink)
 		{
 			std::cerr << "Failed to get filters" << std::endl;
-			cleanup();
+			releaseGraph();
 			return false;
 		}
 
@@ -116,79 +144,84 @@ namespace AudioEngine
 		if (ret < 0)
 		{
 			std::cerr << "Failed to create abuffer filter: " << ret << std::endl;
-			cleanup();
+			releaseGraph();
 			return false;
 		}
 
-		// Create sink filter (abuffersink)
-		ret = avfilter_graph_create_filter(&m_sinkContext, abuffersink, "sink",
-										   nullptr, nullptr, m_graph);
-		if (ret < 0)
+		// Create sink filter (abuffersink); its output constraints have to be set before init
+		m_sinkContext = avfilter_graph_alloc_filter(m_graph, abuffersink, "sink");
+		if (!m_sinkContext)
 		{
-			std::cerr << "Failed to create abuffersink filter: " << ret << std::endl;
-			cleanup();
+			std::cerr << "Failed to create abuffersink filter" << std::endl;
+			releaseGraph();
 			return false;
 		}
 
-		// Set output properties on the sink
-		ret = av_opt_set_bin(m_sinkContext, "sample_fmts",
-							 (uint8_t *)&m_format, sizeof(m_format),
-							 AV_OPT_SEARCH_CHILDREN);
+		ret = av_opt_set(m_sinkContext, "sample_formats", av_get_sample_fmt_name(m_format),
+						 AV_OPT_SEARCH_CHILDREN);
 		if (ret < 0)
 		{
 			std::cerr << "Failed to set output sample format" << std::endl;
-			cleanup();
+			releaseGraph();
 			return false;
 		}
 
-		ret = av_opt_set_bin(m_sinkContext, "ch_layouts",
-							 (uint8_t *)&m_channelLayout, sizeof(m_channelLayout),
-							 AV_OPT_SEARCH_CHILDREN);
+		ret = av_opt_set(m_sinkContext, "channel_layouts", ch_layout, AV_OPT_SEARCH_CHILDREN);
 		if (ret < 0)
 		{
 			std::cerr << "Failed to set output channel layout" << std::endl;
-			cleanup();
+			releaseGraph();
 			return false;
 		}
 
-		ret = av_opt_set_bin(m_sinkContext, "sample_rates",
-							 (uint8_t *)&m_sampleRate, sizeof(m_sampleRate),
-							 AV_OPT_SEARCH_CHILDREN);
+		ret = av_opt_set(m_sinkContext, "samplerates", std::to_string(static_cast<int>(m_sampleRate)).c_str(),
+						 AV_OPT_SEARCH_CHILDREN);
 		if (ret < 0)
 		{
 			std::cerr << "Failed to set output sample rate" << std::endl;
-			cleanup();
+			releaseGraph();
 			return false;
 		}
 
-		// Parse the filter graph description
-		AVFilterInOut *inputs = nullptr, *outputs = nullptr;
-
-		ret = avfilter_graph_parse2(m_graph, m_filterDescription.c_str(), &inputs, &outputs);
+		ret = avfilter_init_str(m_sinkContext, nullptr);
 		if (ret < 0)
 		{
-			std::cerr << "Failed to parse filter graph: " << ret << std::endl;
-			cleanup();
-			avfilter_inout_free(&inputs);
-			avfilter_inout_free(&outputs);
+			std::cerr << "Failed to initialize abuffersink filter: " << ret << std::endl;
+			releaseGraph();
 			return false;
 		}
 
-		// Link the inputs/outputs to our source/sink
-		if (inputs)
+		// The description's open input is fed by our source, its open output feeds our sink
+		AVFilterInOut *outputs = avfilter_inout_alloc();
+		AVFilterInOut *inputs = avfilter_inout_alloc();
+		if (!outputs || !inputs)
 		{
-			inputs->name = av_strdup("in");
-			inputs->filter_ctx = m_srcContext;
-			inputs->pad_idx = 0;
-			inputs->next = nullptr;
+			std::cerr << "Failed to allocate filter graph endpoints" << std::endl;
+			releaseGraph();
+			avfilter_inout_free(&inputs);
+			avfilter_inout_free(&outputs);
+			return false;
 		}
 
-		if (outputs)
+		outputs->name = av_strdup("in");
+		outputs->filter_ctx = m_srcContext;
+		outputs->pad_idx = 0;
+		outputs->next = nullptr;
+
+		inputs->name = av_strdup("out");
+		inputs->filter_ctx = m_sinkContext;
+		inputs->pad_idx = 0;
+		inputs->next = nullptr;
+
+		// Parse the filter graph description
+		ret = avfilter_graph_parse_ptr(m_graph, m_filterDescription.c_str(), &inputs, &outputs, nullptr);
+		if (ret < 0)
 		{
-			outputs->name = av_strdup("out");
-			outputs->filter_ctx = m_sinkContext;
-			outputs->pad_idx = 0;
-			outputs->next = nullptr;
+			std::cerr << "Failed to parse filter graph: " << ret << std::endl;
+			releaseGraph();
+			avfilter_inout_free(&inputs);
+			avfilter_inout_free(&outputs);
+			return false;
 		}
 
 		// Configure the filter graph
@@ -196,7 +229,7 @@ namespace AudioEngine
 		if (ret < 0)
 		{
 			std::cerr << "Failed to configure filter graph: " << ret << std::endl;
-			cleanup();
+			releaseGraph();
 			avfilter_inout_free(&inputs);
 			avfilter_inout_free(&outputs);
 			return false;
@@ -205,6 +238,19 @@ namespace AudioEngine
 		avfilter_inout_free(&inputs);
 		avfilter_inout_free(&outputs);
 
+		// Output FIFO for the streaming path, sized so that steady streaming never grows it
+		m_fifo = av_audio_fifo_alloc(m_format, m_channelLayout.nb_channels, static_cast<int>(m_bufferSize * 8));
+		if (!m_pullFrame)
+		{
+			m_pullFrame = av_frame_alloc();
+		}
+		if (!m_fifo || !m_pullFrame)
+		{
+			std::cerr << "Failed to allocate the filter output FIFO" << std::endl;
+			releaseGraph();
+			return false;
+		}
+
 		// Build a map of named filters
 		for (unsigned int i = 0; i < m_graph->nb_filters; i++)
 		{
@@ -255,6 +301,195 @@ namespace AudioEngine
 		return true;
 	}
 
+	bool FfmpegFilter::drain(AVFrame *outputFrame)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_valid || !m_graph || !m_srcContext || !m_sinkContext)
+		{
+			return false;
+		}
+
+		// Closing the input makes filters with delay flush what they hold
+		if (!m_inputClosed)
+		{
+			int ret = av_buffersrc_add_frame_flags(m_srcContext, nullptr, 0);
+			if (ret < 0)
+			{
+				std::cerr << "Error closing the filter graph input: " << ret << std::endl;
+				return false;
+			}
+			m_inputClosed = true;
+		}
+
+		return av_buffersink_get_frame(m_sinkContext, outputFrame) >= 0;
+	}
+
+	bool FfmpegFilter::push(AVFrame *inputFrame)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_valid || !m_graph || !m_srcContext || !m_sinkContext)
+		{
+			return false;
+		}
+
+		int ret = av_buffersrc_add_frame_flags(m_srcContext, inputFrame,
+											   AV_BUFFERSRC_FLAG_KEEP_REF | AV_BUFFERSRC_FLAG_PUSH);
+		if (ret < 0)
+		{
+			std::cerr << "Error feeding the filter graph: " << ret << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	bool FfmpegFilter::pull(AVFrame *outputFrame)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_valid || !m_graph || !m_sinkContext)
+		{
+			return false;
+		}
+
+		int ret = av_buffersink_get_frame(m_sinkContext, outputFrame);
+		if (ret < 0)
+		{
+			if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+			{
+				std::cerr << "Error getting frame from the filter graph: " << ret << std::endl;
+			}
+			return false;
+		}
+
+		return true;
+	}
+
+	bool FfmpegFilter::feed(AVFrame *inputFrame)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_valid || !m_graph || !m_srcContext || !m_sinkContext)
+		{
+			return false;
+		}
+
+		if (inputFrame)
+		{
+			int ret = av_buffersrc_add_frame_flags(m_srcContext, inputFrame,
+												   AV_BUFFERSRC_FLAG_KEEP_REF | AV_BUFFERSRC_FLAG_PUSH);
+			if (ret < 0)
+			{
+				std::cerr << "Error feeding the filter graph: " << ret << std::endl;
+				return false;
+			}
+			m_framesFed += inputFrame->nb_samples;
+		}
+		else if (!m_inputClosed)
+		{
+			// Closing the input makes filters with delay flush what they hold
+			int ret = av_buffersrc_add_frame_flags(m_srcContext, nullptr, 0);
+			if (ret < 0)
+			{
+				std::cerr << "Error closing the filter graph input: " << ret << std::endl;
+				return false;
+			}
+			m_inputClosed = true;
+		}
+
+		return collectOutput();
+	}
+
+	bool FfmpegFilter::collectOutput()
+	{
+		// Caller holds m_mutex
+		while (true)
+		{
+			int ret = av_buffersink_get_frame(m_sinkContext, m_pullFrame);
+			if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+			{
+				return true;
+			}
+			if (ret < 0)
+			{
+				std::cerr << "Error getting frame from the filter graph: " << ret << std::endl;
+				return false;
+			}
+
+			int written = av_audio_fifo_write(m_fifo, reinterpret_cast<void **>(m_pullFrame->extended_data),
+											  m_pullFrame->nb_samples);
+			av_frame_unref(m_pullFrame);
+			if (written < 0)
+			{
+				std::cerr << "Failed to queue filter output" << std::endl;
+				return false;
+			}
+		}
+	}
+
+	int FfmpegFilter::read(uint8_t *const *planes, int frames)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_fifo)
+		{
+			return 0;
+		}
+
+		int read = av_audio_fifo_read(m_fifo, reinterpret_cast<void *const *>(planes), frames);
+		if (read < 0)
+		{
+			return 0;
+		}
+		m_framesRead += read;
+		return read;
+	}
+
+	int FfmpegFilter::getBufferedFrames() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_fifo ? av_audio_fifo_size(m_fifo) : 0;
+	}
+
+	int64_t FfmpegFilter::getLatency() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_framesFed - m_framesRead;
+	}
+
+	int FfmpegFilter::sendCommand(const char *filterName, const char *paramName, const char *value)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_valid || !m_graph)
+		{
+			return AVERROR(EINVAL);
+		}
+
+		return avfilter_graph_send_command(m_graph, filterName, paramName, value, nullptr, 0, 0);
+	}
+
+	bool FfmpegFilter::getOptionValue(const char *filterName, const char *paramName, double &value)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_valid || !m_graph)
+		{
+			return false;
+		}
+
+		AVFilterContext *filterCtx = avfilter_graph_get_filter(m_graph, filterName);
+		if (!filterCtx)
+		{
+			return false;
+		}
+
+		// Only succeeds for numeric options; expressions stored as strings fail
+		return av_opt_get_double(filterCtx, paramName, AV_OPT_SEARCH_CHILDREN, &value) >= 0;
+	}
+
 	bool FfmpegFilter::updateParameter(const std::string &filterName,
 									   const std::string &paramName,
 									   const std::string &value)
@@ -294,16 +529,35 @@ namespace AudioEngine
 
 	bool FfmpegFilter::reset()
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-
-		if (!m_valid)
+		// initGraph() takes the lock itself and overwrites the members, so work on copies
+		std::string description;
+		double sampleRate;
+		AVSampleFormat format;
+		AVChannelLayout layout = {};
+		long bufferSize;
 		{
-			std::cerr << "Filter graph not initialized" << std::endl;
-			return false;
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (!m_valid)
+			{
+				std::cerr << "Filter graph not initialized" << std::endl;
+				return false;
+			}
+
+			description = m_filterDescription;
+			sampleRate = m_sampleRate;
+			format = m_format;
+			bufferSize = m_bufferSize;
+			if (av_channel_layout_copy(&layout, &m_channelLayout) < 0)
+			{
+				return false;
+			}
 		}
 
 		// Reinitialize with the same parameters
-		return initGraph(m_filterDescription, m_sampleRate, m_format, m_channelLayout, m_bufferSize);
+		bool result = initGraph(description, sampleRate, format, layout, bufferSize);
+		av_channel_layout_uninit(&layout);
+		return result;
 	}
 
 	AVFilterContext *FfmpegFilter::findFilterByName(const std::string &name) const
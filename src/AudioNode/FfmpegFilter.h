@@ -11,6 +11,7 @@ extern "C"
 #include <libavfilter/avfilter.h>
 #include <libavfilter/buffersink.h>
 #include <libavfilter/buffersrc.h>
+#include <libavutil/audio_fifo.h>
 #include <libavutil/opt.h>
 #include <libavutil/samplefmt.h>
 #include <libavutil/channel_layout.h>
@@ -26,6 +27,13 @@ namespace AudioEngine
 	 *
 	 * This class handles creating, connecting, and executing
 	 * FFmpeg audio filter graphs for real-time processing.
+	 *
+	 * process() is the one-frame-in, one-frame-out path for filters that
+	 * keep the framing of their input. Filters with internal latency or their
+	 * own framing (loudnorm, atempo, ...) use the streaming path instead:
+	 * feed() pushes any number of samples and moves everything the graph
+	 * produces into an output FIFO, and read() takes blocks of any size back
+	 * out of it.
 	 */
 	class FfmpegFilter
 	{
@@ -65,9 +73,99 @@ namespace AudioEngine
 		 */
 		bool process(AVFrame *inputFrame, AVFrame *outputFrame);
 
+		/**
+		 * @brief Signal end of stream and pull the audio still held by the graph
+		 *
+		 * The first call closes the graph's input; every call returns at most
+		 * one frame. reset() reopens the input.
+		 *
+		 * @param outputFrame Output AVFrame
+		 * @return true if a frame was returned, false once the graph is empty
+		 */
+		bool drain(AVFrame *outputFrame);
+
+		/**
+		 * @brief Feed one frame into the graph and run it
+		 *
+		 * The frame is pushed through every filter before the call returns, so a
+		 * command sent afterwards only affects later frames.
+		 *
+		 * @param inputFrame Input AVFrame (kept by reference, not consumed)
+		 * @return true if the frame was accepted
+		 */
+		bool push(AVFrame *inputFrame);
+
+		/**
+		 * @brief Take the next frame the graph has produced
+		 *
+		 * @param outputFrame Output AVFrame
+		 * @return true if a frame was returned, false if none is ready
+		 */
+		bool pull(AVFrame *outputFrame);
+
+		/**
+		 * @brief Streaming: push a frame and collect every frame the graph produces
+		 *
+		 * Output accumulates in the FIFO until read(). A null frame closes the
+		 * graph's input and collects everything it still holds.
+		 *
+		 * @param inputFrame Input AVFrame of any length (kept by reference), or nullptr at end of stream
+		 * @return true on success
+		 */
+		bool feed(AVFrame *inputFrame);
+
+		/**
+		 * @brief Streaming: take frames from the output FIFO
+		 *
+		 * @param planes Destination plane pointers (one per plane of the sample format)
+		 * @param frames Number of frames to read
+		 * @return Frames read (fewer if the FIFO holds fewer)
+		 */
+		int read(uint8_t *const *planes, int frames);
+
+		/**
+		 * @brief Streaming: number of frames waiting in the output FIFO
+		 */
+		int getBufferedFrames() const;
+
+		/**
+		 * @brief Streaming: frames fed but not yet read back
+		 *
+		 * The graph's delay plus whatever waits in the FIFO. Only meaningful
+		 * for filters that keep the tempo of their input.
+		 */
+		int64_t getLatency() const;
+
+		/**
+		 * @brief Send a command to a filter from the processing thread
+		 *
+		 * Unlike updateParameter() this does not log, so it can be called per
+		 * block.
+		 *
+		 * @param filterName Name of the filter instance
+		 * @param paramName Command (usually the option name)
+		 * @param value Command argument
+		 * @return 0 on success, a negative AVERROR code otherwise
+		 */
+		int sendCommand(const char *filterName, const char *paramName, const char *value);
+
+		/**
+		 * @brief Read the current value of a numeric filter option
+		 *
+		 * @param filterName Name of the filter instance
+		 * @param paramName Option name
+		 * @param value Receives the value
+		 * @return false if the filter or a numeric option of that name doesn't exist
+		 */
+		bool getOptionValue(const char *filterName, const char *paramName, double &value);
+
 		/**
 		 * @brief Update a filter parameter
 		 *
+		 * Takes the same lock as process(); callers on control threads should
+		 * queue changes to the processing thread instead (see
+		 * FfmpegProcessorNode::scheduleParameter()).
+		 *
 		 * @param filterName Name of the filter to update
 		 * @param paramName Name of the parameter to update
 		 * @param value New value for the parameter
@@ -109,12 +207,21 @@ namespace AudioEngine
 		AVChannelLayout m_channelLayout;
 		long m_bufferSize;
 
+		// Streaming output
+		AVAudioFifo *m_fifo;
+		AVFrame *m_pullFrame;
+		int64_t m_framesFed;
+		int64_t m_framesRead;
+
 		// State
 		bool m_valid;
-		std::mutex m_mutex;
+		bool m_inputClosed; // End of stream sent to the source
+		mutable std::mutex m_mutex;
 
 		// Helper methods
 		void cleanup();
+		void releaseGraph();
+		bool collectOutput();
 		AVFilterContext *findFilterByName(const std::string &name) const;
 	};
 
@@ -1,6 +1,13 @@
 #include "FfmpegProcessorNode.h"
 #include "FfmpegFilter.h"
+#include "AudioBufferPool.h"
 #include "AudioEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <memory>
 
@@ -17,19 +24,131 @@ extern "C"
 namespace AudioEngine
 {
 
+	namespace
+	{
+		// Default ramp length for updateParameter() on gain-like parameters
+		constexpr double DEFAULT_RAMP_MS = 5.0;
+
+		// Default crossfade when the filter chain is replaced while running
+		constexpr double DEFAULT_CROSSFADE_MS = 20.0;
+
+		// Input blocks per graph call when streaming offline
+		constexpr long DEFAULT_BATCH_BLOCKS = 4;
+
+		// How often the graph thread looks for retired graphs when idle
+		constexpr int GRAPH_THREAD_POLL_MS = 50;
+
+		// Read an optional non-negative duration parameter in milliseconds
+		bool readMilliseconds(const std::map<std::string, std::string> &params, const char *key, double &value)
+		{
+			auto it = params.find(key);
+			if (it == params.end())
+			{
+				return true;
+			}
+			try
+			{
+				value = std::stod(it->second);
+			}
+			catch (const std::exception &)
+			{
+				return false;
+			}
+			return value >= 0.0;
+		}
+
+		// Parameters that updateParameter() ramps instead of stepping
+		bool isGainLikeParameter(const std::string &paramName)
+		{
+			static const char *const names[] = {"volume", "gain", "level_in", "level_out", "makeup", "mix", "wet", "dry"};
+			for (const char *name : names)
+			{
+				if (paramName == name)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Copy a string into a fixed field; false if it doesn't fit
+		template <size_t N>
+		bool copyField(char (&field)[N], const std::string &text)
+		{
+			if (text.size() >= N)
+			{
+				return false;
+			}
+			std::memcpy(field, text.c_str(), text.size() + 1);
+			return true;
+		}
+
+		// Split "-6.5dB" into -6.5 and "dB"; false for expressions and other non-numeric values
+		template <size_t N>
+		bool parseNumericValue(const char *text, double &value, char (&unit)[N])
+		{
+			char *end = nullptr;
+			value = std::strtod(text, &end);
+			if (end == text || std::strlen(end) >= N)
+			{
+				return false;
+			}
+			for (const char *c = end; *c; c++)
+			{
+				if (!((*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z')))
+				{
+					return false;
+				}
+			}
+			std::strcpy(unit, end);
+			return true;
+		}
+	}
+
 	FfmpegProcessorNode::FfmpegProcessorNode(const std::string &name, AudioEngine *engine)
 		: AudioNode(name, NodeType::FFMPEG_PROCESSOR, engine),
 		  m_ffmpegFilter(std::make_unique<FfmpegFilter>()),
 		  m_inputFrame(nullptr),
 		  m_outputFrame(nullptr),
 		  m_inputBuffer(nullptr),
-		  m_outputBuffer(nullptr)
+		  m_outputBuffer(nullptr),
+		  m_endOfStream(false),
+		  m_pendingCount(0),
+		  m_activeRamps(0),
+		  m_defaultRampFrames(0),
+		  m_samplePosition(0),
+		  m_commandsApplied(0),
+		  m_commandsLate(0),
+		  m_commandsFailed(0),
+		  m_commandsDropped(0),
+		  m_segmentFrame(nullptr),
+		  m_pendingGraph(nullptr),
+		  m_fadingGraph(nullptr),
+		  m_fadeFrame(nullptr),
+		  m_fadePosition(0),
+		  m_fadeLength(0),
+		  m_graphRequested(false),
+		  m_graphThreadStop(false),
+		  m_historyNext(0),
+		  m_defaultCrossfadeFrames(0),
+		  m_defaultPrimeFrames(0),
+		  m_streamingSetting(StreamingSetting::AUTO),
+		  m_streaming(false),
+		  m_offlineMode(false),
+		  m_batchBlocks(DEFAULT_BATCH_BLOCKS),
+		  m_batchFrames(0),
+		  m_batchStart(0),
+		  m_latencyReported(false),
+		  m_latencyFrames(0),
+		  m_streamUnderruns(0)
 	{
+		m_parameterStates.fill(ParameterState{});
 	}
 
 	FfmpegProcessorNode::~FfmpegProcessorNode()
 	{
 		stop();
+		releaseGraphs();
 		cleanupFrames();
 	}
 
@@ -56,7 +175,78 @@ namespace AudioEngine
 			logMessage("Missing required 'filter_description' parameter", true);
 			return false;
 		}
-		m_filterDescription = it->second;
+		{
+			std::lock_guard<std::mutex> graphLock(m_graphMutex);
+			m_filterDescription = it->second;
+		}
+
+		// Optional timing parameters: parameter ramps, chain crossfade, and the
+		// input history kept for priming replacement chains
+		double rampMs = DEFAULT_RAMP_MS;
+		double crossfadeMs = DEFAULT_CROSSFADE_MS;
+		double historyMs = 0.0;
+		if (!readMilliseconds(params, "ramp_ms", rampMs) ||
+			!readMilliseconds(params, "crossfade_ms", crossfadeMs) ||
+			!readMilliseconds(params, "history_ms", historyMs))
+		{
+			logMessage("Invalid 'ramp_ms', 'crossfade_ms' or 'history_ms' parameter", true);
+			return false;
+		}
+		double primeMs = historyMs;
+		if (!readMilliseconds(params, "prime_ms", primeMs))
+		{
+			logMessage("Invalid 'prime_ms' parameter", true);
+			return false;
+		}
+
+		m_defaultRampFrames = static_cast<long>(rampMs * m_sampleRate / 1000.0);
+		m_defaultCrossfadeFrames = static_cast<long>(crossfadeMs * m_sampleRate / 1000.0);
+		m_defaultPrimeFrames = static_cast<long>(primeMs * m_sampleRate / 1000.0);
+
+		// Streaming through an output FIFO: "auto" streams offline, and in real time
+		// when the graph doesn't return each block as one block of the same size
+		m_streamingSetting = StreamingSetting::AUTO;
+		it = params.find("streaming");
+		if (it != params.end())
+		{
+			if (it->second == "true")
+			{
+				m_streamingSetting = StreamingSetting::ON;
+			}
+			else if (it->second == "false")
+			{
+				m_streamingSetting = StreamingSetting::OFF;
+			}
+			else if (it->second != "auto")
+			{
+				logMessage("Invalid 'streaming' parameter (use 'auto', 'true' or 'false'): " + it->second, true);
+				return false;
+			}
+		}
+
+		// Input blocks fed to the graph at once when streaming offline
+		m_batchBlocks = DEFAULT_BATCH_BLOCKS;
+		it = params.find("batch_blocks");
+		if (it != params.end())
+		{
+			try
+			{
+				m_batchBlocks = std::stol(it->second);
+			}
+			catch (const std::exception &)
+			{
+				m_batchBlocks = 0;
+			}
+			if (m_batchBlocks < 1)
+			{
+				logMessage("Invalid 'batch_blocks' parameter: " + it->second, true);
+				return false;
+			}
+		}
+
+		const long historyFrames = static_cast<long>(historyMs * m_sampleRate / 1000.0);
+		m_history.assign(static_cast<size_t>((historyFrames + m_bufferSize - 1) / m_bufferSize), nullptr);
+		m_historyNext = 0;
 
 		// Initialize the FFmpeg filter
 		if (!m_ffmpegFilter->initGraph(m_filterDescription, m_sampleRate, m_format,
@@ -73,15 +263,26 @@ namespace AudioEngine
 			return false;
 		}
 
-		// Create output buffer (input buffer is set by upstream node)
-		m_outputBuffer = std::make_shared<AudioBuffer>(m_bufferSize, m_sampleRate,
-													   m_format, m_channelLayout);
-		if (!m_outputBuffer->isValid())
+		m_planePointers.assign(av_sample_fmt_is_planar(m_format) ? m_channelLayout.nb_channels : 1, nullptr);
+
+		// Create output buffer (input buffer is set by upstream node); replaced by
+		// the filter's output frames once processing starts
+		m_outputBuffer = AudioBufferPool::shared().acquire(m_bufferSize, m_sampleRate, m_format, m_channelLayout);
+		if (!m_outputBuffer || !m_outputBuffer->isValid())
 		{
 			logMessage("Failed to create valid output buffer", true);
 			return false;
 		}
 
+		// Played while a streaming graph fills its first block and fed to graphs primed with silence
+		m_silenceBuffer = AudioBufferPool::shared().acquire(m_bufferSize, m_sampleRate, m_format, m_channelLayout);
+		if (!m_silenceBuffer || !m_silenceBuffer->clear())
+		{
+			logMessage("Failed to create silence buffer", true);
+			return false;
+		}
+		m_silenceBuffer->publish();
+
 		m_configured = true;
 		logMessage("Configured with filter: " + m_filterDescription, false);
 
@@ -111,6 +312,16 @@ namespace AudioEngine
 			return false;
 		}
 
+		// Scratch frames for split blocks and crossfades
+		m_segmentFrame = av_frame_alloc();
+		m_fadeFrame = av_frame_alloc();
+		if (!m_segmentFrame || !m_fadeFrame)
+		{
+			logMessage("Failed to allocate scratch AVFrames", true);
+			cleanupFrames();
+			return false;
+		}
+
 		// Set up input frame properties
 		m_inputFrame->format = m_format;
 		if (av_channel_layout_copy(&m_inputFrame->ch_layout, &m_channelLayout) < 0)
@@ -138,6 +349,18 @@ namespace AudioEngine
 			av_frame_free(&m_outputFrame);
 			m_outputFrame = nullptr;
 		}
+
+		if (m_segmentFrame)
+		{
+			av_frame_free(&m_segmentFrame);
+			m_segmentFrame = nullptr;
+		}
+
+		if (m_fadeFrame)
+		{
+			av_frame_free(&m_fadeFrame);
+			m_fadeFrame = nullptr;
+		}
 	}
 
 	bool FfmpegProcessorNode::start()
@@ -156,14 +379,82 @@ namespace AudioEngine
 			return true;
 		}
 
-		// Reset the filter graph to clear any state
-		if (!m_ffmpegFilter->reset())
+		// A chain requested while stopped is built now; otherwise reset the
+		// filter graph to clear any state
+		GraphRequest request;
+		bool requested = false;
+		{
+			std::lock_guard<std::mutex> graphLock(m_graphMutex);
+			if (m_graphRequested)
+			{
+				request = std::move(m_graphRequest);
+				m_graphRequested = false;
+				requested = true;
+			}
+		}
+
+		bool rebuilt = false;
+		if (requested)
+		{
+			auto filter = std::make_unique<FfmpegFilter>();
+			if (filter->initGraph(request.description, m_sampleRate, m_format, m_channelLayout, m_bufferSize))
+			{
+				m_ffmpegFilter = std::move(filter);
+				std::lock_guard<std::mutex> graphLock(m_graphMutex);
+				m_filterDescription = request.description;
+				rebuilt = true;
+			}
+			else
+			{
+				logMessage("Failed to build filter chain '" + request.description + "', keeping the current one", true);
+			}
+		}
+
+		if (!rebuilt && !m_ffmpegFilter->reset())
 		{
 			logMessage("Failed to reset filter graph", true);
 			return false;
 		}
 
+		// The fresh graph starts from its configured values at position 0;
+		// commands queued since stay queued
+		m_pendingCount = 0;
+		m_parameterStates.fill(ParameterState{});
+		m_activeRamps = 0;
+		m_samplePosition.store(0, std::memory_order_release);
+
+		m_streaming = m_streamingSetting == StreamingSetting::ON ||
+					  (m_streamingSetting == StreamingSetting::AUTO && m_offlineMode);
+		if (m_streamingSetting == StreamingSetting::AUTO && !m_offlineMode)
+		{
+			// In real time stream only a graph that doesn't hand each block straight back;
+			// the probe leaves samples in the graph, so it is reset again
+			m_streaming = !keepsFraming();
+			if (!m_ffmpegFilter->reset())
+			{
+				logMessage("Failed to reset filter graph", true);
+				return false;
+			}
+			if (m_streaming)
+			{
+				logMessage("Filter graph changes the block framing - streaming through the output FIFO", false);
+			}
+		}
+		m_batchBuffer.reset();
+		m_batchFrames = 0;
+		m_latencyReported = false;
+		m_latencyFrames.store(0, std::memory_order_relaxed);
+
+		m_endOfStream = false;
 		m_running = true;
+
+		// Chain replacements are built on their own thread from now on
+		{
+			std::lock_guard<std::mutex> graphLock(m_graphMutex);
+			m_graphThreadStop = false;
+		}
+		m_graphThread = std::thread(&FfmpegProcessorNode::runGraphThread, this);
+
 		logMessage("Started", false);
 		return true;
 	}
@@ -179,6 +470,31 @@ namespace AudioEngine
 
 		m_running = false;
 		m_inputBuffer = nullptr;
+		m_batchBuffer.reset();
+
+		{
+			std::lock_guard<std::mutex> graphLock(m_graphMutex);
+			m_graphThreadStop = true;
+		}
+		m_graphCondition.notify_one();
+		if (m_graphThread.joinable())
+		{
+			m_graphThread.join();
+		}
+
+		// Finish a crossfade in progress and take over a graph that is ready,
+		// so the next start() uses the newest chain
+		if (m_fadingGraph)
+		{
+			retireGraph(m_fadingGraph);
+			m_fadingGraph = nullptr;
+		}
+		if (PendingGraph *graph = m_pendingGraph.exchange(nullptr, std::memory_order_acq_rel))
+		{
+			std::swap(m_ffmpegFilter, graph->filter);
+			delete graph;
+		}
+		releaseGraphs();
 
 		logMessage("Stopped", false);
 	}
@@ -187,134 +503,1149 @@ namespace AudioEngine
 	{
 		std::lock_guard<std::mutex> lock(m_processMutex);
 
-		if (!m_running || !m_inputBuffer)
+		if (!m_running)
 		{
 			return false;
 		}
 
-		if (!m_inputBuffer->isValid() || !m_outputBuffer->isValid())
+		const int64_t blockStart = m_samplePosition.load(std::memory_order_relaxed);
+		drainCommandQueue(blockStart);
+		beginPendingSwap();
+
+		if (!m_inputBuffer)
+		{
+			// Nothing new this block; don't publish the previous output again
+			m_outputBuffer.reset();
+			applyDueCommands(blockStart);
+
+			// No input to crossfade with: cut over to the new graph
+			if (m_fadingGraph)
+			{
+				retireGraph(m_fadingGraph);
+				m_fadingGraph = nullptr;
+			}
+
+			if (!m_endOfStream)
+			{
+				return false;
+			}
+
+			// Inputs have ended: emit what the filter graph still holds, any size
+			if (m_streaming)
+			{
+				if (!flushBatch() || !m_ffmpegFilter->feed(nullptr))
+				{
+					logMessage("Failed to drain the filter graph", true);
+					return false;
+				}
+				m_outputBuffer = readBlock(*m_ffmpegFilter, true);
+				return true;
+			}
+
+			av_frame_unref(m_outputFrame);
+			if (!m_ffmpegFilter->drain(m_outputFrame))
+			{
+				return true;
+			}
+			return takeOutputFrame();
+		}
+
+		if (!m_inputBuffer->isValid())
 		{
 			logMessage("Invalid buffers for processing", true);
+			m_inputBuffer.reset();
 			return false;
 		}
 
-		// Convert AudioBuffer to AVFrame
-		// Set up data pointers in the input frame
-		for (int i = 0; i < m_inputBuffer->getPlaneCount() && i < AV_NUM_DATA_POINTERS; i++)
+		// Hand the input to FFmpeg by reference; the filter keeps the buffer alive as long as it needs it
+		av_frame_unref(m_inputFrame);
+		if (!AudioBuffer::attachToAVFrame(m_inputBuffer, m_inputFrame))
 		{
-			m_inputFrame->data[i] = m_inputBuffer->getPlaneData(i);
-			m_inputFrame->linesize[i] = m_inputBuffer->isPlanar() ? m_inputBuffer->getBytesPerSample() : m_inputBuffer->getBytesPerSample() * m_inputBuffer->getChannelCount();
+			logMessage("Failed to reference input buffer as AVFrame", true);
+			m_inputBuffer.reset();
+			return false;
 		}
+		m_inputFrame->sample_rate = static_cast<int>(m_sampleRate);
+		m_inputFrame->pts = blockStart;
 
-		// Process through the filter graph
-		// First reset output frame
-		av_frame_unref(m_outputFrame);
+		// Each input is processed once
+		const long inputFrames = m_inputBuffer->getFrameCount();
+		if (!m_history.empty())
+		{
+			recordHistory(m_inputBuffer);
+		}
+		m_inputBuffer.reset();
+		m_samplePosition.store(blockStart + inputFrames, std::memory_order_release);
+
+		// The outgoing graph keeps running on the same input while it fades out
+		std::shared_ptr<AudioBuffer> fadeBlock;
+		if (m_fadingGraph)
+		{
+			if (m_streaming)
+			{
+				if (m_fadingGraph->filter->feed(m_inputFrame))
+				{
+					fadeBlock = readBlock(*m_fadingGraph->filter, false);
+				}
+			}
+			else
+			{
+				av_frame_unref(m_fadeFrame);
+				if (m_fadingGraph->filter->process(m_inputFrame, m_fadeFrame))
+				{
+					fadeBlock = AudioBuffer::wrapAVFrame(m_fadeFrame);
+				}
+			}
+		}
+
+		bool processed = true;
+		if (m_activeRamps > 0 ||
+			(m_pendingCount > 0 && m_pendingCommands[0].sampleTime < blockStart + inputFrames))
+		{
+			// Commands or ramps inside this block: feed it in pieces between them,
+			// after any batched input so the graph sees the samples in order
+			processed = flushBatch() && processSegments(inputFrames, blockStart);
+		}
+		else if (m_streaming)
+		{
+			processed = m_offlineMode && m_batchBlocks > 1 ? appendToBatch(inputFrames, blockStart)
+														   : m_ffmpegFilter->feed(m_inputFrame);
+		}
+		else
+		{
+			av_frame_unref(m_outputFrame);
+			processed = m_ffmpegFilter->process(m_inputFrame, m_outputFrame);
+			av_frame_unref(m_inputFrame);
+			if (!processed)
+			{
+				m_outputBuffer.reset();
+				logMessage("FFmpeg filter processing failed", true);
+				return false;
+			}
+
+			// Full blocks stay full; only a short final block of a stream may come back short
+			if (m_outputFrame->nb_samples > m_bufferSize ||
+				(m_outputFrame->nb_samples < m_bufferSize && inputFrames >= m_bufferSize))
+			{
+				m_outputBuffer.reset();
+				logMessage("Unexpected output frame size from filter", true);
+				return false;
+			}
+
+			if (!takeOutputFrame())
+			{
+				return false;
+			}
+			return crossfadeOutput(fadeBlock);
+		}
 
-		if (!m_ffmpegFilter->process(m_inputFrame, m_outputFrame))
+		av_frame_unref(m_inputFrame);
+		if (!processed)
 		{
+			m_outputBuffer.reset();
 			logMessage("FFmpeg filter processing failed", true);
 			return false;
 		}
 
-		// Convert output AVFrame back to AudioBuffer
-		if (m_outputFrame->nb_samples != m_bufferSize ||
-			m_outputFrame->format != m_format ||
-			av_channel_layout_compare(&m_outputFrame->ch_layout, &m_channelLayout) != 0)
+		if (m_streaming)
 		{
+			emitStreamingBlock();
+		}
+		return crossfadeOutput(fadeBlock);
+	}
 
-			logMessage("Unexpected output frame format from filter", true);
+	bool FfmpegProcessorNode::keepsFraming()
+	{
+		// One block of silence in: exactly one block of the same size must come straight out
+		av_frame_unref(m_inputFrame);
+		av_frame_unref(m_outputFrame);
+		if (!AudioBuffer::attachToAVFrame(m_silenceBuffer, m_inputFrame))
+		{
 			return false;
 		}
+		m_inputFrame->sample_rate = static_cast<int>(m_sampleRate);
+		m_inputFrame->pts = 0;
+
+		bool keeps = m_ffmpegFilter->process(m_inputFrame, m_outputFrame) && m_outputFrame->nb_samples == m_bufferSize;
+		av_frame_unref(m_inputFrame);
+		av_frame_unref(m_outputFrame);
+		if (keeps && m_ffmpegFilter->pull(m_outputFrame))
+		{
+			keeps = false;
+			av_frame_unref(m_outputFrame);
+		}
+		return keeps;
+	}
 
-		// Copy data from output frame to output buffer
-		for (int i = 0; i < m_outputBuffer->getPlaneCount() && i < AV_NUM_DATA_POINTERS; i++)
+	void FfmpegProcessorNode::emitStreamingBlock()
+	{
+		m_outputBuffer = readBlock(*m_ffmpegFilter, false);
+		if (m_outputBuffer)
 		{
-			if (m_outputFrame->data[i] && m_outputBuffer->getPlaneData(i))
+			m_latencyFrames.store(m_ffmpegFilter->getLatency(), std::memory_order_relaxed);
+			if (!m_latencyReported)
 			{
-				int bytesPerSample = m_outputBuffer->getBytesPerSample();
-				int numChannels = m_outputBuffer->getChannelCount();
-				int copySize = m_outputBuffer->isPlanar() ? m_bufferSize * bytesPerSample : m_bufferSize * bytesPerSample * numChannels;
-
-				memcpy(m_outputBuffer->getPlaneData(i), m_outputFrame->data[i], copySize);
+				m_latencyReported = true;
+				const int64_t latency = m_latencyFrames.load(std::memory_order_relaxed);
+				logMessage("Filter graph latency: " + std::to_string(latency) + " frames (" +
+							   std::to_string(latency * 1000.0 / m_sampleRate) + " ms)",
+						   false);
 			}
+			return;
 		}
 
-		return true;
+		// Offline there's no deadline: emit nothing until a whole block is ready.
+		// Real time, a graph that is still filling its delay plays silence.
+		if (m_offlineMode)
+		{
+			return;
+		}
+
+		m_streamUnderruns.fetch_add(1, std::memory_order_relaxed);
+		m_outputBuffer = m_silenceBuffer;
 	}
 
-	std::shared_ptr<AudioBuffer> FfmpegProcessorNode::getOutputBuffer(int padIndex)
+	std::shared_ptr<AudioBuffer> FfmpegProcessorNode::readBlock(FfmpegFilter &filter, bool partial)
 	{
-		if (padIndex != 0)
+		const long frames = std::min<long>(filter.getBufferedFrames(), m_bufferSize);
+		if (frames == 0 || (frames < m_bufferSize && !partial))
 		{
-			logMessage("Invalid output pad index: " + std::to_string(padIndex), true);
 			return nullptr;
 		}
 
-		std::lock_guard<std::mutex> lock(m_processMutex);
+		auto block = AudioBufferPool::shared().acquire(frames, m_sampleRate, m_format, m_channelLayout);
+		if (!block)
+		{
+			return nullptr;
+		}
+		for (size_t p = 0; p < m_planePointers.size(); p++)
+		{
+			m_planePointers[p] = block->getPlaneData(static_cast<int>(p));
+		}
 
-		if (!m_running || !m_outputBuffer)
+		if (filter.read(m_planePointers.data(), static_cast<int>(frames)) != frames)
 		{
 			return nullptr;
 		}
 
-		return m_outputBuffer;
+		block->publish();
+		return block;
 	}
 
-	bool FfmpegProcessorNode::setInputBuffer(std::shared_ptr<AudioBuffer> buffer, int padIndex)
+	bool FfmpegProcessorNode::appendToBatch(long inputFrames, int64_t blockStart)
 	{
-		if (padIndex != 0)
+		if (!m_batchBuffer)
 		{
-			logMessage("Invalid input pad index: " + std::to_string(padIndex), true);
-			return false;
+			m_batchBuffer = AudioBufferPool::shared().acquire(m_batchBlocks * m_bufferSize, m_sampleRate,
+															  m_format, m_channelLayout);
+			if (!m_batchBuffer)
+			{
+				return false;
+			}
+			m_batchFrames = 0;
+			m_batchStart = blockStart;
 		}
 
-		std::lock_guard<std::mutex> lock(m_processMutex);
+		for (size_t p = 0; p < m_planePointers.size(); p++)
+		{
+			m_planePointers[p] = m_batchBuffer->getPlaneData(static_cast<int>(p));
+		}
+		av_samples_copy(m_planePointers.data(), m_inputFrame->extended_data, static_cast<int>(m_batchFrames), 0,
+						static_cast<int>(inputFrames), m_channelLayout.nb_channels, m_format);
+		m_batchFrames += inputFrames;
 
-		if (!m_running)
+		// Feed once the next block wouldn't fit, or after a short (final) block
+		if (m_batchFrames + m_bufferSize > m_batchBuffer->getFrameCount() || inputFrames < m_bufferSize)
 		{
-			return false;
+			return flushBatch();
 		}
+		return true;
+	}
 
-		// Use the new buffer format compatibility checker from AudioNode base class
-		if (!isBufferFormatCompatible(buffer))
+	bool FfmpegProcessorNode::flushBatch()
+	{
+		if (!m_batchBuffer)
+		{
+			return true;
+		}
+
+		std::shared_ptr<AudioBuffer> batch = std::move(m_batchBuffer);
+		batch->publish();
+		if (m_batchFrames < batch->getFrameCount())
+		{
+			batch = AudioBuffer::createView(batch, 0, static_cast<int>(m_batchFrames));
+		}
+
+		av_frame_unref(m_segmentFrame);
+		if (!batch || !AudioBuffer::attachToAVFrame(batch, m_segmentFrame))
 		{
-			logMessage("Input buffer format incompatible", true);
 			return false;
 		}
+		m_segmentFrame->sample_rate = static_cast<int>(m_sampleRate);
+		m_segmentFrame->pts = m_batchStart;
 
-		// Store input buffer (we don't need to copy it since we just read from it)
-		m_inputBuffer = buffer;
+		bool fed = m_ffmpegFilter->feed(m_segmentFrame);
+		av_frame_unref(m_segmentFrame);
+		return fed;
+	}
 
-		return true;
+	void FfmpegProcessorNode::setOfflineMode(bool offline)
+	{
+		m_offlineMode = offline;
 	}
 
-	bool FfmpegProcessorNode::updateParameter(const std::string &filterName,
-											  const std::string &paramName,
-											  const std::string &value)
+	bool FfmpegProcessorNode::isDrained() const
 	{
-		std::lock_guard<std::mutex> lock(m_processMutex);
+		// The direct path holds nothing between blocks once drain() comes back empty
+		return !m_streaming || (!m_batchBuffer && m_ffmpegFilter->getBufferedFrames() == 0);
+	}
 
+	bool FfmpegProcessorNode::replaceFilterChain(const std::string &description, double crossfadeMs, double primeMs,
+												 PrimeSource prime)
+	{
 		if (!m_configured)
 		{
-			logMessage("Cannot update parameter - not configured", true);
+			logMessage("Cannot replace filter chain - not configured", true);
 			return false;
 		}
 
-		if (!m_ffmpegFilter->updateParameter(filterName, paramName, value))
+		GraphRequest request;
+		request.description = description;
+		request.crossfadeFrames = crossfadeMs < 0.0 ? m_defaultCrossfadeFrames
+													: static_cast<long>(crossfadeMs * m_sampleRate / 1000.0);
+		request.primeFrames = primeMs < 0.0 ? m_defaultPrimeFrames
+											: static_cast<long>(primeMs * m_sampleRate / 1000.0);
+		request.prime = prime;
+
+		// Crossfades mix float samples only; other formats switch at the block boundary
+		if (m_format != AV_SAMPLE_FMT_FLT && m_format != AV_SAMPLE_FMT_FLTP)
+		{
+			request.crossfadeFrames = 0;
+		}
+
 		{
-			logMessage("Failed to update parameter '" + paramName + "' on filter '" + filterName + "'", true);
-			return false;
+			std::lock_guard<std::mutex> lock(m_graphMutex);
+			m_graphRequest = std::move(request);
+			m_graphRequested = true;
 		}
+		m_graphCondition.notify_one();
 
-		logMessage("Updated parameter '" + paramName + "' on filter '" + filterName + "' to '" + value + "'", false);
+		logMessage("Building filter chain: " + description, false);
 		return true;
 	}
 
-	bool FfmpegProcessorNode::updateParameter(const std::string &paramName, const std::string &paramValue)
+	std::string FfmpegProcessorNode::getFilterDescription() const
 	{
-		// For this processor node, simple parameter updates are not supported
-		// We need filter-specific parameter updates using the three-parameter version
-		// However, we could parse parameter names in format "filtername.parametername"
+		std::lock_guard<std::mutex> lock(m_graphMutex);
+		return m_filterDescription;
+	}
+
+	void FfmpegProcessorNode::runGraphThread()
+	{
+		std::unique_lock<std::mutex> lock(m_graphMutex);
+		while (true)
+		{
+			m_graphCondition.wait_for(lock, std::chrono::milliseconds(GRAPH_THREAD_POLL_MS),
+									  [this]()
+									  { return m_graphRequested || m_graphThreadStop; });
+
+			// Free graphs the audio thread has swapped out
+			lock.unlock();
+			PendingGraph *retired = nullptr;
+			while (m_retiredGraphs.tryPop(retired))
+			{
+				delete retired;
+			}
+			lock.lock();
+
+			if (m_graphThreadStop)
+			{
+				break;
+			}
+
+			if (m_graphRequested)
+			{
+				GraphRequest request = std::move(m_graphRequest);
+				m_graphRequested = false;
+
+				lock.unlock();
+				buildGraph(request);
+				lock.lock();
+			}
+		}
+	}
+
+	void FfmpegProcessorNode::buildGraph(const GraphRequest &request)
+	{
+		auto filter = std::make_unique<FfmpegFilter>();
+		if (!filter->initGraph(request.description, m_sampleRate, m_format, m_channelLayout, m_bufferSize))
+		{
+			logMessage("Failed to build filter chain '" + request.description + "', keeping the current one", true);
+			return;
+		}
+
+		if (request.primeFrames > 0)
+		{
+			primeGraph(*filter, request.primeFrames, request.prime);
+		}
+
+		// Publish; a graph built earlier that hasn't gone live yet is superseded
+		auto *graph = new PendingGraph{std::move(filter), request.crossfadeFrames};
+		PendingGraph *superseded = m_pendingGraph.exchange(graph, std::memory_order_acq_rel);
+		delete superseded;
+
+		{
+			std::lock_guard<std::mutex> lock(m_graphMutex);
+			m_filterDescription = request.description;
+		}
+		logMessage("Filter chain ready: " + request.description, false);
+	}
+
+	void FfmpegProcessorNode::primeGraph(FfmpegFilter &filter, long primeFrames, PrimeSource prime)
+	{
+		// Snapshot the recorded input, oldest first
+		std::vector<std::shared_ptr<AudioBuffer>> blocks;
+		if (prime == PrimeSource::HISTORY && !m_history.empty())
+		{
+			std::lock_guard<std::mutex> lock(m_historyMutex);
+			for (size_t i = 0; i < m_history.size(); i++)
+			{
+				const auto &block = m_history[(m_historyNext + i) % m_history.size()];
+				if (block)
+				{
+					blocks.push_back(block);
+				}
+			}
+		}
+
+		// Keep the newest blocks that cover primeFrames
+		long frames = 0;
+		size_t first = blocks.size();
+		while (first > 0 && frames < primeFrames)
+		{
+			first--;
+			frames += blocks[first]->getFrameCount();
+		}
+		blocks.erase(blocks.begin(), blocks.begin() + first);
+
+		if (blocks.empty())
+		{
+			for (frames = 0; frames < primeFrames; frames += m_bufferSize)
+			{
+				blocks.push_back(m_silenceBuffer);
+			}
+		}
+
+		AVFrame *frame = av_frame_alloc();
+		AVFrame *discard = av_frame_alloc();
+		if (frame && discard)
+		{
+			// Timestamps lead up to the position the graph will take over at
+			int64_t pts = m_samplePosition.load(std::memory_order_acquire) - frames;
+			for (const auto &block : blocks)
+			{
+				if (!AudioBuffer::attachToAVFrame(block, frame))
+				{
+					break;
+				}
+				frame->sample_rate = static_cast<int>(m_sampleRate);
+				frame->pts = pts;
+				pts += block->getFrameCount();
+
+				bool pushed = filter.push(frame);
+				av_frame_unref(frame);
+				if (!pushed)
+				{
+					break;
+				}
+
+				while (filter.pull(discard))
+				{
+					av_frame_unref(discard);
+				}
+			}
+		}
+		av_frame_free(&frame);
+		av_frame_free(&discard);
+	}
+
+	void FfmpegProcessorNode::beginPendingSwap()
+	{
+		// One swap at a time; a graph that is ready waits for the crossfade to end
+		if (m_fadingGraph || !m_pendingGraph.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		// Leave it pending until the old graph can be handed back for deletion
+		if (m_retiredGraphs.size() >= m_retiredGraphs.capacity())
+		{
+			return;
+		}
+
+		PendingGraph *graph = m_pendingGraph.exchange(nullptr, std::memory_order_acq_rel);
+		if (!graph)
+		{
+			return;
+		}
+
+		// The graph now carries the outgoing filter
+		std::swap(m_ffmpegFilter, graph->filter);
+
+		// Known values and ramps belonged to the old graph
+		m_parameterStates.fill(ParameterState{});
+		m_activeRamps = 0;
+
+		if (graph->crossfadeFrames > 0 && m_inputBuffer)
+		{
+			m_fadingGraph = graph;
+			m_fadePosition = 0;
+			m_fadeLength = graph->crossfadeFrames;
+		}
+		else
+		{
+			retireGraph(graph);
+		}
+	}
+
+	bool FfmpegProcessorNode::crossfadeOutput(const std::shared_ptr<AudioBuffer> &fadeBlock)
+	{
+		if (!m_fadingGraph)
+		{
+			return true;
+		}
+
+		// Linear (equal-gain) fade: both graphs process the same, correlated input
+		bool faded = false;
+		if (fadeBlock && m_outputBuffer &&
+			fadeBlock->getFrameCount() == m_outputBuffer->getFrameCount() &&
+			fadeBlock->getFormat() == m_format &&
+			av_channel_layout_compare(&fadeBlock->getChannelLayout(), &m_channelLayout) == 0)
+		{
+			const long frames = m_outputBuffer->getFrameCount();
+			auto mixed = AudioBufferPool::shared().acquire(frames, m_sampleRate, m_format, m_channelLayout);
+			if (mixed)
+			{
+				const int channels = m_channelLayout.nb_channels;
+				const float step = 1.0f / static_cast<float>(m_fadeLength);
+				if (m_format == AV_SAMPLE_FMT_FLTP)
+				{
+					for (int c = 0; c < channels; c++)
+					{
+						const float *incoming = reinterpret_cast<const float *>(m_outputBuffer->getPlaneData(c));
+						const float *outgoing = reinterpret_cast<const float *>(fadeBlock->getPlaneData(c));
+						float *out = reinterpret_cast<float *>(mixed->getPlaneData(c));
+						for (long i = 0; i < frames; i++)
+						{
+							const float gain = std::min(1.0f, static_cast<float>(m_fadePosition + i) * step);
+							out[i] = outgoing[i] + (incoming[i] - outgoing[i]) * gain;
+						}
+					}
+				}
+				else
+				{
+					const float *incoming = reinterpret_cast<const float *>(m_outputBuffer->getPlaneData(0));
+					const float *outgoing = reinterpret_cast<const float *>(fadeBlock->getPlaneData(0));
+					float *out = reinterpret_cast<float *>(mixed->getPlaneData(0));
+					for (long i = 0; i < frames; i++)
+					{
+						const float gain = std::min(1.0f, static_cast<float>(m_fadePosition + i) * step);
+						for (int c = 0; c < channels; c++)
+						{
+							const long index = i * channels + c;
+							out[index] = outgoing[index] + (incoming[index] - outgoing[index]) * gain;
+						}
+					}
+				}
+
+				mixed->publish();
+				m_outputBuffer = std::move(mixed);
+				m_fadePosition += frames;
+				faded = true;
+			}
+		}
+
+		// Done, or the old graph can't keep up: the new graph continues alone
+		if (!faded || m_fadePosition >= m_fadeLength)
+		{
+			retireGraph(m_fadingGraph);
+			m_fadingGraph = nullptr;
+		}
+		return true;
+	}
+
+	void FfmpegProcessorNode::retireGraph(PendingGraph *graph)
+	{
+		if (!m_retiredGraphs.tryPush(graph))
+		{
+			// beginPendingSwap() checks for room, so this means the graph thread is gone
+			delete graph;
+		}
+	}
+
+	void FfmpegProcessorNode::recordHistory(const std::shared_ptr<AudioBuffer> &buffer)
+	{
+		// Skip the block rather than wait while the graph thread takes a snapshot
+		std::unique_lock<std::mutex> lock(m_historyMutex, std::try_to_lock);
+		if (!lock.owns_lock())
+		{
+			return;
+		}
+
+		m_history[m_historyNext] = buffer;
+		m_historyNext = (m_historyNext + 1) % m_history.size();
+	}
+
+	void FfmpegProcessorNode::releaseGraphs()
+	{
+		// Only called while neither the audio thread nor the graph thread runs
+		delete m_pendingGraph.exchange(nullptr, std::memory_order_acq_rel);
+
+		PendingGraph *retired = nullptr;
+		while (m_retiredGraphs.tryPop(retired))
+		{
+			delete retired;
+		}
+
+		delete m_fadingGraph;
+		m_fadingGraph = nullptr;
+
+		std::lock_guard<std::mutex> lock(m_historyMutex);
+		std::fill(m_history.begin(), m_history.end(), nullptr);
+		m_historyNext = 0;
+	}
+
+	bool FfmpegProcessorNode::processSegments(long frameCount, int64_t blockStart)
+	{
+		const bool planar = av_sample_fmt_is_planar(m_format) != 0;
+		const int channels = m_channelLayout.nb_channels;
+		const int planes = planar ? channels : 1;
+		const size_t frameBytes = static_cast<size_t>(av_get_bytes_per_sample(m_format)) * (planar ? 1 : channels);
+
+		long position = 0;
+		while (position < frameCount)
+		{
+			const int64_t now = blockStart + position;
+			applyDueCommands(now);
+
+			// The segment ends at the next command or ramp step
+			long end = frameCount;
+			if (m_pendingCount > 0 && m_pendingCommands[0].sampleTime < blockStart + frameCount)
+			{
+				end = static_cast<long>(m_pendingCommands[0].sampleTime - blockStart);
+			}
+			const long step = advanceRamps(now);
+			if (step > 0)
+			{
+				end = std::min(end, position + step);
+			}
+
+			// Reference the segment's range of the input without copying
+			av_frame_unref(m_segmentFrame);
+			if (av_frame_ref(m_segmentFrame, m_inputFrame) < 0)
+			{
+				return false;
+			}
+			const size_t offset = static_cast<size_t>(position) * frameBytes;
+			for (int p = 0; p < planes; p++)
+			{
+				m_segmentFrame->extended_data[p] += offset;
+				if (p < AV_NUM_DATA_POINTERS && m_segmentFrame->extended_data != m_segmentFrame->data)
+				{
+					m_segmentFrame->data[p] += offset;
+				}
+			}
+			m_segmentFrame->nb_samples = static_cast<int>(end - position);
+			m_segmentFrame->pts = now;
+
+			// The segment passes through the whole graph before the next command
+			bool pushed = m_streaming ? m_ffmpegFilter->feed(m_segmentFrame) : m_ffmpegFilter->push(m_segmentFrame);
+			av_frame_unref(m_segmentFrame);
+			if (!pushed)
+			{
+				return false;
+			}
+
+			position = end;
+		}
+
+		// Streaming output is collected in the filter's FIFO instead
+		return m_streaming || collectSegmentOutput(frameCount);
+	}
+
+	bool FfmpegProcessorNode::collectSegmentOutput(long frameCount)
+	{
+		auto output = AudioBufferPool::shared().acquire(frameCount, m_sampleRate, m_format, m_channelLayout);
+		if (!output)
+		{
+			return false;
+		}
+		for (size_t p = 0; p < m_planePointers.size(); p++)
+		{
+			m_planePointers[p] = output->getPlaneData(static_cast<int>(p));
+		}
+
+		// Reassemble the segments' output into one block
+		long filled = 0;
+		av_frame_unref(m_outputFrame);
+		while (m_ffmpegFilter->pull(m_outputFrame))
+		{
+			if (m_outputFrame->format != m_format ||
+				av_channel_layout_compare(&m_outputFrame->ch_layout, &m_channelLayout) != 0 ||
+				m_outputFrame->nb_samples > frameCount - filled)
+			{
+				av_frame_unref(m_outputFrame);
+				return false;
+			}
+
+			av_samples_copy(m_planePointers.data(), m_outputFrame->extended_data, static_cast<int>(filled), 0,
+							m_outputFrame->nb_samples, m_channelLayout.nb_channels, m_format);
+			filled += m_outputFrame->nb_samples;
+			av_frame_unref(m_outputFrame);
+		}
+
+		if (filled != frameCount)
+		{
+			return false;
+		}
+
+		output->publish();
+		m_outputBuffer = std::move(output);
+		return true;
+	}
+
+	void FfmpegProcessorNode::drainCommandQueue(int64_t blockStart)
+	{
+		ParameterCommand command;
+		while (m_pendingCount < MAX_PENDING_COMMANDS && m_commandQueue.tryPop(command))
+		{
+			if (command.sampleTime < 0)
+			{
+				command.sampleTime = blockStart;
+			}
+			else if (command.sampleTime < blockStart)
+			{
+				m_commandsLate.fetch_add(1, std::memory_order_relaxed);
+				command.sampleTime = blockStart;
+			}
+
+			// Insert after commands for the same sample so arrival order is kept
+			size_t i = m_pendingCount;
+			while (i > 0 && m_pendingCommands[i - 1].sampleTime > command.sampleTime)
+			{
+				m_pendingCommands[i] = m_pendingCommands[i - 1];
+				i--;
+			}
+			m_pendingCommands[i] = command;
+			m_pendingCount++;
+		}
+	}
+
+	void FfmpegProcessorNode::applyDueCommands(int64_t now)
+	{
+		size_t due = 0;
+		while (due < m_pendingCount && m_pendingCommands[due].sampleTime <= now)
+		{
+			applyCommand(m_pendingCommands[due]);
+			due++;
+		}
+
+		if (due > 0)
+		{
+			std::copy(m_pendingCommands.begin() + due, m_pendingCommands.begin() + m_pendingCount, m_pendingCommands.begin());
+			m_pendingCount -= due;
+		}
+	}
+
+	void FfmpegProcessorNode::applyCommand(const ParameterCommand &command)
+	{
+		double target = 0.0;
+		char unit[sizeof(ParameterState::unit)];
+		if (!parseNumericValue(command.value, target, unit))
+		{
+			// Not a plain number: pass it through and forget what we knew about the value
+			ParameterState *state = findParameterState(command.filterName, command.paramName, false);
+			if (state)
+			{
+				if (state->ramping)
+				{
+					m_activeRamps--;
+				}
+				*state = ParameterState{};
+			}
+
+			if (m_ffmpegFilter->sendCommand(command.filterName, command.paramName, command.value) >= 0)
+			{
+				m_commandsApplied.fetch_add(1, std::memory_order_relaxed);
+			}
+			else
+			{
+				m_commandsFailed.fetch_add(1, std::memory_order_relaxed);
+			}
+			return;
+		}
+
+		ParameterState *state = findParameterState(command.filterName, command.paramName, false);
+		bool known = state && std::strcmp(state->unit, unit) == 0;
+		if (!state)
+		{
+			state = findParameterState(command.filterName, command.paramName, true);
+		}
+
+		if (state && command.rampFrames > 0)
+		{
+			// Ramp from the value last sent, or from the filter's current option value
+			double start = known ? state->value : 0.0;
+			if (!known && unit[0] == '\0')
+			{
+				known = m_ffmpegFilter->getOptionValue(command.filterName, command.paramName, start);
+			}
+
+			if (known)
+			{
+				std::strcpy(state->unit, unit);
+				state->value = start;
+				state->start = start;
+				state->target = target;
+				state->startTime = command.sampleTime;
+				state->length = command.rampFrames;
+				if (!state->ramping)
+				{
+					state->ramping = true;
+					m_activeRamps++;
+				}
+				return;
+			}
+		}
+
+		// Step change (also the fallback when the starting value is unknown)
+		if (state && state->ramping)
+		{
+			state->ramping = false;
+			m_activeRamps--;
+		}
+
+		if (m_ffmpegFilter->sendCommand(command.filterName, command.paramName, command.value) < 0)
+		{
+			m_commandsFailed.fetch_add(1, std::memory_order_relaxed);
+			if (state)
+			{
+				*state = ParameterState{};
+			}
+			return;
+		}
+
+		m_commandsApplied.fetch_add(1, std::memory_order_relaxed);
+		if (state)
+		{
+			std::strcpy(state->unit, unit);
+			state->value = target;
+		}
+	}
+
+	long FfmpegProcessorNode::advanceRamps(int64_t now)
+	{
+		if (m_activeRamps == 0)
+		{
+			return 0;
+		}
+
+		long next = LONG_MAX;
+		for (auto &state : m_parameterStates)
+		{
+			if (!state.used || !state.ramping)
+			{
+				continue;
+			}
+
+			// Each step holds the value the ramp reaches at the step's end
+			const long elapsed = static_cast<long>(now - state.startTime);
+			const long toNextStep = RAMP_STEP_FRAMES - elapsed % RAMP_STEP_FRAMES;
+			if (elapsed + toNextStep >= state.length)
+			{
+				state.ramping = false;
+				m_activeRamps--;
+				sendParameterValue(state, state.target);
+				continue;
+			}
+
+			const double fraction = static_cast<double>(elapsed + toNextStep) / static_cast<double>(state.length);
+			sendParameterValue(state, state.start + (state.target - state.start) * fraction);
+			next = std::min(next, toNextStep);
+		}
+
+		return next == LONG_MAX ? 0 : next;
+	}
+
+	bool FfmpegProcessorNode::sendParameterValue(ParameterState &state, double value)
+	{
+		char text[sizeof(ParameterCommand::value)];
+		std::snprintf(text, sizeof(text), "%.9g%s", value, state.unit);
+		if (m_ffmpegFilter->sendCommand(state.filterName, state.paramName, text) < 0)
+		{
+			m_commandsFailed.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		m_commandsApplied.fetch_add(1, std::memory_order_relaxed);
+		state.value = value;
+		return true;
+	}
+
+	FfmpegProcessorNode::ParameterState *FfmpegProcessorNode::findParameterState(const char *filterName,
+																				   const char *paramName, bool create)
+	{
+		ParameterState *unused = nullptr;
+		for (auto &state : m_parameterStates)
+		{
+			if (!state.used)
+			{
+				if (!unused)
+				{
+					unused = &state;
+				}
+				continue;
+			}
+			if (std::strcmp(state.filterName, filterName) == 0 && std::strcmp(state.paramName, paramName) == 0)
+			{
+				return &state;
+			}
+		}
+
+		if (!create || !unused)
+		{
+			return nullptr;
+		}
+
+		// Names were length-checked when the command was queued
+		*unused = ParameterState{};
+		unused->used = true;
+		std::strcpy(unused->filterName, filterName);
+		std::strcpy(unused->paramName, paramName);
+		return unused;
+	}
+
+	bool FfmpegProcessorNode::takeOutputFrame()
+	{
+		// Convert output AVFrame back to AudioBuffer
+		if (m_outputFrame->format != m_format ||
+			av_channel_layout_compare(&m_outputFrame->ch_layout, &m_channelLayout) != 0)
+		{
+			m_outputBuffer.reset();
+			logMessage("Unexpected output frame format from filter", true);
+			return false;
+		}
+
+		// Take over the filter's output frame instead of copying it; consumers
+		// still holding the previous output keep their own reference
+		auto output = AudioBuffer::wrapAVFrame(m_outputFrame);
+		if (!output)
+		{
+			m_outputBuffer.reset();
+			logMessage("Failed to wrap filter output frame", true);
+			return false;
+		}
+
+		m_outputBuffer = std::move(output);
+		return true;
+	}
+
+	void FfmpegProcessorNode::endOfStream()
+	{
+		std::lock_guard<std::mutex> lock(m_processMutex);
+		m_endOfStream = true;
+	}
+
+	std::shared_ptr<AudioBuffer> FfmpegProcessorNode::getOutputBuffer(int padIndex)
+	{
+		if (padIndex != 0)
+		{
+			logMessage("Invalid output pad index: " + std::to_string(padIndex), true);
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(m_processMutex);
+
+		if (!m_running || !m_outputBuffer)
+		{
+			return nullptr;
+		}
+
+		return m_outputBuffer;
+	}
+
+	bool FfmpegProcessorNode::setInputBuffer(std::shared_ptr<AudioBuffer> buffer, int padIndex)
+	{
+		if (padIndex != 0)
+		{
+			logMessage("Invalid input pad index: " + std::to_string(padIndex), true);
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(m_processMutex);
+
+		if (!m_running)
+		{
+			return false;
+		}
+
+		// Use the new buffer format compatibility checker from AudioNode base class
+		if (!isBufferFormatCompatible(buffer))
+		{
+			logMessage("Input buffer format incompatible", true);
+			return false;
+		}
+
+		// Store input buffer (we don't need to copy it since we just read from it)
+		m_inputBuffer = buffer;
+
+		return true;
+	}
+
+	bool FfmpegProcessorNode::updateParameter(const std::string &filterName,
+											  const std::string &paramName,
+											  const std::string &value)
+	{
+		// Gain-like parameters glide to the new value instead of stepping
+		const long rampFrames = isGainLikeParameter(paramName) ? m_defaultRampFrames : 0;
+		return scheduleParameter(filterName, paramName, value, -1, rampFrames);
+	}
+
+	bool FfmpegProcessorNode::scheduleParameter(const std::string &filterName, const std::string &paramName,
+												const std::string &value, int64_t sampleTime, long rampFrames)
+	{
+		if (!m_configured)
+		{
+			logMessage("Cannot update parameter - not configured", true);
+			return false;
+		}
+
+		ParameterCommand command{};
+		if (!copyField(command.filterName, filterName) || !copyField(command.paramName, paramName) ||
+			!copyField(command.value, value))
+		{
+			logMessage("Parameter update too long for '" + filterName + "." + paramName + "'", true);
+			return false;
+		}
+		command.sampleTime = sampleTime;
+		command.rampFrames = std::max(0L, rampFrames);
+
+		{
+			// Serializes control threads only; the audio thread pops without locking
+			std::lock_guard<std::mutex> lock(m_commandMutex);
+			if (!m_commandQueue.tryPush(command))
+			{
+				m_commandsDropped.fetch_add(1, std::memory_order_relaxed);
+				logMessage("Parameter queue full, dropped update of '" + filterName + "." + paramName + "'", true);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool FfmpegProcessorNode::sendControlMessage(const std::string &messageType,
+												 const std::map<std::string, std::string> &params)
+	{
+		if (messageType == "set_chain")
+		{
+			auto chainIt = params.find("filter_description");
+			if (chainIt == params.end())
+			{
+				chainIt = params.find("chain");
+			}
+			if (chainIt == params.end())
+			{
+				logMessage("set_chain needs 'filter_description'", true);
+				return false;
+			}
+
+			double crossfadeMs = -1.0;
+			double primeMs = -1.0;
+			if (!readMilliseconds(params, "crossfade_ms", crossfadeMs) || !readMilliseconds(params, "prime_ms", primeMs))
+			{
+				logMessage("Invalid 'crossfade_ms' or 'prime_ms' in set_chain", true);
+				return false;
+			}
+
+			PrimeSource prime = PrimeSource::HISTORY;
+			auto primeIt = params.find("prime");
+			if (primeIt != params.end())
+			{
+				if (primeIt->second == "silence")
+				{
+					prime = PrimeSource::SILENCE;
+				}
+				else if (primeIt->second != "history")
+				{
+					logMessage("Unknown prime source '" + primeIt->second + "' (use 'silence' or 'history')", true);
+					return false;
+				}
+			}
+
+			return replaceFilterChain(chainIt->second, crossfadeMs, primeMs, prime);
+		}
+
+		if (messageType != "set_parameter")
+		{
+			return AudioNode::sendControlMessage(messageType, params);
+		}
+
+		auto filterIt = params.find("filter");
+		auto paramIt = params.find("param");
+		auto valueIt = params.find("value");
+		if (filterIt == params.end() || paramIt == params.end() || valueIt == params.end())
+		{
+			logMessage("set_parameter needs 'filter', 'param' and 'value'", true);
+			return false;
+		}
+
+		int64_t sampleTime = -1;
+		long rampFrames = isGainLikeParameter(paramIt->second) ? m_defaultRampFrames : 0;
+		try
+		{
+			auto it = params.find("time");
+			if (it != params.end())
+			{
+				sampleTime = std::stoll(it->second);
+			}
+
+			it = params.find("ramp_ms");
+			if (it != params.end())
+			{
+				rampFrames = static_cast<long>(std::stod(it->second) * m_sampleRate / 1000.0);
+			}
+		}
+		catch (const std::exception &)
+		{
+			logMessage("Invalid 'time' or 'ramp_ms' in set_parameter", true);
+			return false;
+		}
+
+		return scheduleParameter(filterIt->second, paramIt->second, valueIt->second, sampleTime, rampFrames);
+	}
+
+	FfmpegProcessorNode::AutomationStats FfmpegProcessorNode::getAutomationStats() const
+	{
+		AutomationStats stats;
+		stats.applied = m_commandsApplied.load(std::memory_order_relaxed);
+		stats.late = m_commandsLate.load(std::memory_order_relaxed);
+		stats.failed = m_commandsFailed.load(std::memory_order_relaxed);
+		stats.dropped = m_commandsDropped.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	bool FfmpegProcessorNode::updateParameter(const std::string &paramName, const std::string &paramValue)
+	{
+		// For this processor node, simple parameter updates are not supported
+		// We need filter-specific parameter updates using the three-parameter version
+		// However, we could parse parameter names in format "filtername.parametername"
+
+		// The chain itself is swapped in the background
+		if (paramName == "filter_description")
+		{
+			return replaceFilterChain(paramValue);
+		}
 
 		// Check if the parameter name has a filter prefix (contains a dot)
 		size_t dotPos = paramName.find('.');
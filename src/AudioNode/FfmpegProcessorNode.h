@@ -1,8 +1,15 @@
 #pragma once
 
 #include "AudioNode.h"
+#include "SpscRing.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 extern "C"
 {
@@ -21,10 +28,61 @@ namespace AudioEngine
 
 	/**
 	 * @brief Node for processing audio using FFmpeg filter chains
+	 *
+	 * Parameter changes from control threads (OSC, API) never touch the filter
+	 * graph directly: they are queued on a lock-free ring that process() drains
+	 * at the start of each block. A command stamped with a stream position
+	 * splits the block so that it takes effect on exactly that sample. Numeric
+	 * changes can ramp linearly over a number of frames; the ramp advances in
+	 * RAMP_STEP_FRAMES sub-blocks, which removes zipper noise from gain-like
+	 * parameters without a command per sample.
+	 *
+	 * The filter chain itself can be replaced while running. The new graph is
+	 * built and primed on the node's graph thread, handed to process() through
+	 * an atomic pointer and swapped in at the next block boundary, optionally
+	 * crossfading from the old graph's output. The old graph is deleted on the
+	 * graph thread, never on the audio thread.
+	 *
+	 * Without streaming each block goes through the graph as one frame and
+	 * must come back as one frame of the same size. Filters with internal
+	 * latency or their own framing need streaming: all output is collected in
+	 * a FIFO and re-blocked to the engine's buffer size. Offline, streaming
+	 * also batches "batch_blocks" input blocks per graph call; in real time a
+	 * graph that hasn't produced a whole block yet plays silence, which sets
+	 * the node's latency (see getLatencyFrames()). The "streaming" parameter:
+	 * - "auto" (default): always offline; in real time only if start() finds
+	 *   that a block of silence doesn't come straight back as one block of
+	 *   the same size. A chain swapped in later keeps the mode chosen at
+	 *   start(), so set "true" if a replacement may change the framing
+	 * - "true": always
+	 * - "false": never; a graph that changes the framing fails in process()
 	 */
 	class FfmpegProcessorNode : public AudioNode
 	{
 	public:
+		/**
+		 * @brief Parameter automation counters
+		 */
+		struct AutomationStats
+		{
+			uint64_t applied; // Commands (and ramp steps) accepted by the filter graph
+			uint64_t late;	  // Timed commands applied after their sample position had passed
+			uint64_t failed;  // Commands the filter graph rejected
+			uint64_t dropped; // Commands lost because the queue was full
+		};
+
+		/**
+		 * @brief What a replacement graph is fed before it goes live
+		 */
+		enum class PrimeSource
+		{
+			SILENCE, // Zeros, to settle start-up transients
+			HISTORY	 // The node's most recent input (see "history_ms"), so filter state matches the old graph
+		};
+
+		// Frames between value updates while a ramp is running
+		static constexpr long RAMP_STEP_FRAMES = 32;
+
 		/**
 		 * @brief Create a new FFmpeg processor node
 		 *
@@ -55,6 +113,36 @@ namespace AudioEngine
 		int getInputPadCount() const override { return 1; }	 // One input
 		int getOutputPadCount() const override { return 1; } // One output
 
+		/**
+		 * @brief Drain the filter graph on the following process() calls
+		 */
+		void endOfStream() override;
+
+		/**
+		 * @brief Select offline rendering; "streaming": "auto" always streams offline
+		 */
+		void setOfflineMode(bool offline) override;
+
+		/**
+		 * @brief Check whether the streaming FIFO and input batch are empty
+		 */
+		bool isDrained() const override;
+
+		/**
+		 * @brief Get the frames between an input sample and its output when streaming
+		 *
+		 * Measured from the samples fed to and read back from the graph, so it is
+		 * only meaningful for filters that keep the tempo of their input.
+		 *
+		 * @return Latency in frames (0 until the first streamed block)
+		 */
+		int64_t getLatencyFrames() const { return m_latencyFrames.load(std::memory_order_relaxed); }
+
+		/**
+		 * @brief Get the number of real-time blocks streamed as silence while the graph filled
+		 */
+		uint64_t getStreamingUnderruns() const { return m_streamUnderruns.load(std::memory_order_relaxed); }
+
 		/**
 		 * @brief Update a node parameter
 		 *
@@ -79,12 +167,63 @@ namespace AudioEngine
 		 */
 		bool updateParameter(const std::string &filterName, const std::string &paramName, const std::string &value);
 
+		/**
+		 * @brief Queue a filter parameter change for the processing thread
+		 *
+		 * Safe to call from any control thread; never blocks the audio path.
+		 *
+		 * @param filterName Name of the filter instance in the chain
+		 * @param paramName Command/option name
+		 * @param value New value (a number with an optional unit suffix such as "dB" can be ramped)
+		 * @param sampleTime Stream position (see getSamplePosition()) to apply it at; negative for the next block
+		 * @param rampFrames Frames to ramp over from the current value (0 = step)
+		 * @return false if the node isn't configured, a name is too long or the queue is full
+		 */
+		bool scheduleParameter(const std::string &filterName, const std::string &paramName, const std::string &value,
+							   int64_t sampleTime = -1, long rampFrames = 0);
+
+		/**
+		 * @brief Handle "set_parameter" messages
+		 *
+		 * Parameters: "filter", "param", "value", and optionally "time" (stream
+		 * position in samples) and "ramp_ms".
+		 */
+		bool sendControlMessage(const std::string &messageType, const std::map<std::string, std::string> &params) override;
+
+		/**
+		 * @brief Get the stream position of the next block, in samples since start()
+		 */
+		int64_t getSamplePosition() const { return m_samplePosition.load(std::memory_order_acquire); }
+
+		/**
+		 * @brief Get the automation counters
+		 */
+		AutomationStats getAutomationStats() const;
+
+		/**
+		 * @brief Replace the filter chain without interrupting the audio
+		 *
+		 * Returns immediately; the graph is built on the node's graph thread and
+		 * goes live at a later block boundary. A newer request supersedes one
+		 * that hasn't gone live yet. Build failures are reported through the
+		 * engine's status callback and leave the current chain in place. When
+		 * the node isn't running the chain is rebuilt directly.
+		 *
+		 * @param description FFmpeg filter graph description
+		 * @param crossfadeMs Crossfade from the old graph (negative = node's "crossfade_ms")
+		 * @param primeMs Audio fed to the new graph before the swap (negative = node's "prime_ms")
+		 * @param prime What to prime the new graph with (HISTORY falls back to silence when none is recorded)
+		 * @return false if the request could not be queued
+		 */
+		bool replaceFilterChain(const std::string &description, double crossfadeMs = -1.0, double primeMs = -1.0,
+								PrimeSource prime = PrimeSource::HISTORY);
+
 		/**
 		 * @brief Get the filter description
 		 *
-		 * @return FFmpeg filter description string
+		 * @return Description of the newest chain that was built successfully
 		 */
-		std::string getFilterDescription() const { return m_filterDescription; }
+		std::string getFilterDescription() const;
 
 	private:
 		// FFmpeg filter
@@ -100,11 +239,163 @@ namespace AudioEngine
 		// Input/output buffers
 		std::shared_ptr<AudioBuffer> m_inputBuffer;
 		std::shared_ptr<AudioBuffer> m_outputBuffer;
+		std::shared_ptr<AudioBuffer> m_silenceBuffer; // Published zeros, allocated at configure()
+
+		// Inputs have ended; process() drains the filter graph
+		bool m_endOfStream;
 
 		// Thread safety
 		std::mutex m_processMutex;
 
+		// Fixed-size parameter change, so queueing never allocates on the audio thread
+		struct ParameterCommand
+		{
+			char filterName[64];
+			char paramName[64];
+			char value[64];
+			int64_t sampleTime; // Stream position; negative = next block
+			long rampFrames;
+		};
+
+		// Last value and running ramp of one automated parameter
+		struct ParameterState
+		{
+			bool used;
+			bool ramping;
+			char filterName[64];
+			char paramName[64];
+			char unit[16]; // Suffix of the value, e.g. "dB"
+			double value;  // Last value sent to the filter
+			double start;
+			double target;
+			int64_t startTime;
+			long length;
+		};
+
+		static constexpr size_t COMMAND_QUEUE_SIZE = 256;
+		static constexpr size_t MAX_PENDING_COMMANDS = 64;
+		static constexpr size_t MAX_AUTOMATED_PARAMETERS = 32;
+
+		// Control threads serialize on m_commandMutex; the audio thread only pops
+		SpscRing<ParameterCommand> m_commandQueue{COMMAND_QUEUE_SIZE};
+		std::mutex m_commandMutex;
+
+		// Audio thread state: commands waiting for their sample, sorted by time
+		std::array<ParameterCommand, MAX_PENDING_COMMANDS> m_pendingCommands;
+		size_t m_pendingCount;
+		std::array<ParameterState, MAX_AUTOMATED_PARAMETERS> m_parameterStates;
+		size_t m_activeRamps;
+
+		// Default ramp for updateParameter() on gain-like parameters
+		long m_defaultRampFrames;
+
+		std::atomic<int64_t> m_samplePosition;
+		std::atomic<uint64_t> m_commandsApplied;
+		std::atomic<uint64_t> m_commandsLate;
+		std::atomic<uint64_t> m_commandsFailed;
+		std::atomic<uint64_t> m_commandsDropped;
+
+		// Split-block scratch
+		AVFrame *m_segmentFrame;
+		std::vector<uint8_t *> m_planePointers;
+
+		// A built graph on its way in (or, once swapped, the old graph on its way out)
+		struct PendingGraph
+		{
+			std::unique_ptr<FfmpegFilter> filter;
+			long crossfadeFrames;
+		};
+
+		// Chain change requested from a control thread
+		struct GraphRequest
+		{
+			std::string description;
+			long crossfadeFrames;
+			long primeFrames;
+			PrimeSource prime;
+		};
+
+		static constexpr size_t RETIRE_QUEUE_SIZE = 8;
+
+		// Graph thread -> audio thread: the newest built graph
+		std::atomic<PendingGraph *> m_pendingGraph;
+
+		// Audio thread -> graph thread: graphs to delete
+		SpscRing<PendingGraph *> m_retiredGraphs{RETIRE_QUEUE_SIZE};
+
+		// Crossfade state (audio thread)
+		PendingGraph *m_fadingGraph;
+		AVFrame *m_fadeFrame;
+		long m_fadePosition;
+		long m_fadeLength;
+
+		// Graph thread
+		std::thread m_graphThread;
+		mutable std::mutex m_graphMutex; // Guards the request, the stop flag and m_filterDescription
+		std::condition_variable m_graphCondition;
+		GraphRequest m_graphRequest;
+		bool m_graphRequested;
+		bool m_graphThreadStop;
+
+		// Recent input blocks for priming; the audio thread only ever try-locks
+		std::vector<std::shared_ptr<AudioBuffer>> m_history;
+		size_t m_historyNext;
+		std::mutex m_historyMutex;
+
+		// Defaults for replaceFilterChain()
+		long m_defaultCrossfadeFrames;
+		long m_defaultPrimeFrames;
+
+		// Streaming through the filter's output FIFO
+		enum class StreamingSetting
+		{
+			AUTO,
+			ON,
+			OFF
+		};
+		StreamingSetting m_streamingSetting;
+		bool m_streaming; // Effective mode, fixed at start()
+		bool m_offlineMode;
+
+		// Offline input batching (streaming only)
+		long m_batchBlocks;
+		std::shared_ptr<AudioBuffer> m_batchBuffer;
+		long m_batchFrames;
+		int64_t m_batchStart;
+
+		bool m_latencyReported;
+		std::atomic<int64_t> m_latencyFrames;
+		std::atomic<uint64_t> m_streamUnderruns;
+
+		// Streaming helpers (audio thread)
+		void emitStreamingBlock();
+		std::shared_ptr<AudioBuffer> readBlock(FfmpegFilter &filter, bool partial);
+		bool appendToBatch(long inputFrames, int64_t blockStart);
+		bool flushBatch();
+
+		// Hot-swap helpers
+		void runGraphThread();
+		void buildGraph(const GraphRequest &request);
+		void primeGraph(FfmpegFilter &filter, long primeFrames, PrimeSource prime);
+		void beginPendingSwap();
+		bool crossfadeOutput(const std::shared_ptr<AudioBuffer> &fadeBlock);
+		void retireGraph(PendingGraph *graph);
+		void recordHistory(const std::shared_ptr<AudioBuffer> &buffer);
+		void releaseGraphs();
+
+		// Automation helpers (audio thread)
+		void drainCommandQueue(int64_t blockStart);
+		void applyDueCommands(int64_t now);
+		void applyCommand(const ParameterCommand &command);
+		long advanceRamps(int64_t now);
+		bool sendParameterValue(ParameterState &state, double value);
+		ParameterState *findParameterState(const char *filterName, const char *paramName, bool create);
+		bool processSegments(long frameCount, int64_t blockStart);
+		bool collectSegmentOutput(long frameCount);
+
 		// Helper methods
+		bool keepsFraming();
+		bool takeOutputFrame();
 		bool initializeFrames();
 		void cleanupFrames();
 	};
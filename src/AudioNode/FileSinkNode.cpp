@@ -1,7 +1,10 @@
 #include "FileSinkNode.h"
 #include "AudioEngine.h"
+#include "OscController.h"
 #include <iostream>
 #include <iomanip>
+#include <cstdio>
+#include <algorithm>
 
 extern "C"
 {
@@ -15,6 +18,13 @@ extern "C"
 namespace AudioEngine
 {
 
+	namespace
+	{
+		// Recorder states as numbered by oscmix's DUREC_STATUS_NAMES
+		constexpr int DUREC_STOPPED = 5;
+		constexpr int DUREC_RECORDING = 6;
+	}
+
 	FileSinkNode::FileSinkNode(const std::string &name, AudioEngine *engine)
 		: AudioNode(name, NodeType::FILE_SINK, engine),
 		  m_formatContext(nullptr),
@@ -22,8 +32,25 @@ namespace AudioEngine
 		  m_swrContext(nullptr),
 		  m_stream(nullptr),
 		  m_frame(nullptr),
+		  m_refFrame(nullptr),
 		  m_packet(nullptr),
+		  m_pcmEncoding(PcmFileWriter::Encoding::PCM24),
+		  m_pcmWriterEnabled(true),
+		  m_bufferSizeSet(false),
+		  m_pcmFrameBytes(0),
+		  m_split(false),
+		  m_rotateSeconds(0.0),
+		  m_rotateBytes(0),
+		  m_take(0),
+		  m_takeFrames(0),
+		  m_targetIp("127.0.0.1"),
+		  m_targetPort(0),
+		  m_oscAddress("/durec/" + name),
+		  m_statusRateHz(4.0),
 		  m_stopThread(false),
+		  m_queueSize(DEFAULT_QUEUE_SIZE),
+		  m_queuePolicy(QueuePolicy::DROP_NEWEST),
+		  m_offline(false),
 		  m_frameCount(0),
 		  m_duration(0.0),
 		  m_startPts(0),
@@ -73,6 +100,35 @@ namespace AudioEngine
 		}
 		m_filePath = it->second;
 
+		// Write queue
+		it = params.find("queue_size");
+		if (it != params.end())
+		{
+			try
+			{
+				int size = std::stoi(it->second);
+				if (size < 1)
+				{
+					throw std::out_of_range("queue_size");
+				}
+				m_queueSize = static_cast<size_t>(size);
+			}
+			catch (const std::exception &e)
+			{
+				logMessage("Invalid queue_size: " + it->second, true);
+				return false;
+			}
+		}
+
+		it = params.find("queue_policy");
+		if (it != params.end() && !AudioBufferQueue::parsePolicy(it->second, m_queuePolicy))
+		{
+			logMessage("Invalid queue_policy: " + it->second, true);
+			return false;
+		}
+
+		m_inputQueue = std::make_unique<AudioBufferQueue>(m_queueSize, m_queuePolicy);
+
 		// Get optional format
 		it = params.find("format");
 		if (it != params.end())
@@ -124,6 +180,118 @@ namespace AudioEngine
 			m_useCompression = (it->second == "true" || it->second == "1" || it->second == "yes");
 		}
 
+		// Direct PCM writer
+		it = params.find("pcm_writer");
+		m_pcmWriterEnabled = it == params.end() || it->second != "false";
+
+		it = params.find("direct_io");
+		m_pcmOptions.directIo = it != params.end() && (it->second == "true" || it->second == "1" || it->second == "yes");
+
+		try
+		{
+			it = params.find("write_buffer_kb");
+			if (it != params.end())
+			{
+				int kb = std::stoi(it->second);
+				if (kb < 4)
+				{
+					throw std::out_of_range("write_buffer_kb");
+				}
+				m_pcmOptions.bufferBytes = static_cast<size_t>(kb) * 1024;
+				m_bufferSizeSet = true;
+			}
+
+			it = params.find("preallocate_mb");
+			if (it != params.end())
+			{
+				int mb = std::stoi(it->second);
+				if (mb < 0)
+				{
+					throw std::out_of_range("preallocate_mb");
+				}
+				m_pcmOptions.preallocateBytes = static_cast<int64_t>(mb) << 20;
+			}
+
+			it = params.find("header_interval");
+			if (it != params.end())
+			{
+				double seconds = std::stod(it->second);
+				if (seconds < 0.0)
+				{
+					throw std::out_of_range("header_interval");
+				}
+				m_pcmOptions.headerIntervalSeconds = seconds;
+			}
+
+			it = params.find("rotate_seconds");
+			if (it != params.end())
+			{
+				m_rotateSeconds = std::stod(it->second);
+				if (m_rotateSeconds < 0.0)
+				{
+					throw std::out_of_range("rotate_seconds");
+				}
+			}
+
+			it = params.find("rotate_mb");
+			if (it != params.end())
+			{
+				int mb = std::stoi(it->second);
+				if (mb < 0)
+				{
+					throw std::out_of_range("rotate_mb");
+				}
+				m_rotateBytes = static_cast<int64_t>(mb) << 20;
+			}
+
+			it = params.find("target_port");
+			if (it != params.end())
+			{
+				m_targetPort = std::stoi(it->second);
+				if (m_targetPort < 0 || m_targetPort > 65535)
+				{
+					throw std::out_of_range("target_port");
+				}
+			}
+
+			it = params.find("status_rate_hz");
+			if (it != params.end())
+			{
+				m_statusRateHz = std::stod(it->second);
+				if (m_statusRateHz < 0.0)
+				{
+					throw std::out_of_range("status_rate_hz");
+				}
+			}
+		}
+		catch (const std::exception &e)
+		{
+			logMessage("Invalid value for " + it->first + ": " + it->second, true);
+			return false;
+		}
+
+		// Multitrack recording
+		it = params.find("split");
+		m_split = it != params.end() && (it->second == "true" || it->second == "1" || it->second == "yes");
+
+		// Status publishing
+		it = params.find("target_ip");
+		if (it != params.end())
+		{
+			m_targetIp = it->second;
+		}
+		it = params.find("osc_address");
+		if (it != params.end())
+		{
+			m_oscAddress = it->second;
+		}
+
+		if ((m_split || m_rotateSeconds > 0.0 || m_rotateBytes > 0) && !usePcmWriter())
+		{
+			logMessage("split and rotation need WAV/RF64 output with a pcm_* codec", true);
+			return false;
+		}
+
 		// File will be opened when start() is called
 		m_configured = true;
 		logMessage("Configured for file: " + m_filePath + " (Format: " + m_format +
@@ -133,11 +301,184 @@ namespace AudioEngine
 		return true;
 	}
 
+	bool FileSinkNode::usePcmWriter() const
+	{
+		PcmFileWriter::Encoding encoding;
+		return m_pcmWriterEnabled && (m_format == "wav" || m_format == "rf64") &&
+			   PcmFileWriter::parseCodec(m_codec, encoding);
+	}
+
+	bool FileSinkNode::openPcmWriter()
+	{
+		PcmFileWriter::parseCodec(m_codec, m_pcmEncoding);
+		m_pcmOptions.rf64 = m_format == "rf64";
+
+		// Two buffers per file: one being filled, one on its way to the disk
+		const int files = m_split ? m_channelLayout.nb_channels : 1;
+		const size_t bufferBytes = m_split && !m_bufferSizeSet ? SPLIT_BUFFER_BYTES : m_pcmOptions.bufferBytes;
+		try
+		{
+			m_pcmService = std::make_unique<PcmWriteService>(bufferBytes, 2 * static_cast<size_t>(files));
+		}
+		catch (const std::exception &e)
+		{
+			logMessage("Failed to start I/O thread: " + std::string(e.what()), true);
+			return false;
+		}
+
+		m_take = 0;
+		if (!openTake(m_pcmWriters))
+		{
+			m_pcmService.reset();
+			return false;
+		}
+		if (m_pcmOptions.directIo && !m_pcmWriters[0]->isDirectIo())
+		{
+			logMessage("Direct I/O not supported here - using buffered writes", false);
+		}
+		m_pcmFrameBytes = m_pcmWriters[0]->getFrameSize() * files;
+
+		m_frameCount = 0;
+		m_startPts = 0;
+		m_lastPts = 0;
+
+		logMessage("File opened successfully: " + getCurrentFile() + " (direct PCM writer" +
+					   (m_split ? ", " + std::to_string(files) + " mono files" : "") + ")",
+				   false);
+		return true;
+	}
+
+	std::string FileSinkNode::makeTakePath(int take, int channel) const
+	{
+		const size_t slash = m_filePath.find_last_of("/\\");
+		size_t dot = m_filePath.find_last_of('.');
+		if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+		{
+			dot = m_filePath.size();
+		}
+
+		std::string path = m_filePath.substr(0, dot);
+		char suffix[16];
+		if (m_rotateSeconds > 0.0 || m_rotateBytes > 0)
+		{
+			std::snprintf(suffix, sizeof(suffix), "_%03d", take + 1);
+			path += suffix;
+		}
+		if (channel >= 0)
+		{
+			std::snprintf(suffix, sizeof(suffix), "_%02d", channel + 1);
+			path += suffix;
+		}
+		return path + m_filePath.substr(dot);
+	}
+
+	bool FileSinkNode::openTake(std::vector<std::unique_ptr<PcmFileWriter>> &writers)
+	{
+		const int take = m_take.load();
+		const int files = m_split ? m_channelLayout.nb_channels : 1;
+
+		// FFmpeg's native channel masks use the WAVE_FORMAT_EXTENSIBLE bit order
+		const uint32_t channelMask = !m_split && m_channelLayout.order == AV_CHANNEL_ORDER_NATIVE
+										 ? static_cast<uint32_t>(m_channelLayout.u.mask & 0x3FFFF)
+										 : 0;
+
+		std::vector<std::unique_ptr<PcmFileWriter>> opened;
+		opened.reserve(static_cast<size_t>(files));
+		for (int i = 0; i < files; i++)
+		{
+			const std::string path = makeTakePath(take, m_split ? i : -1);
+			auto writer = std::make_unique<PcmFileWriter>();
+			std::string error;
+			if (!writer->open(path, static_cast<int>(m_sampleRate), m_split ? 1 : m_channelLayout.nb_channels,
+							  channelMask, m_pcmEncoding, m_pcmOptions, error, m_pcmService.get()))
+			{
+				logMessage("Failed to open output file " + path + ": " + error, true);
+				for (auto &file : opened)
+				{
+					file->close(error);
+				}
+				return false;
+			}
+			opened.push_back(std::move(writer));
+		}
+
+		writers = std::move(opened);
+		m_takeFrames = 0;
+		std::lock_guard<std::mutex> lock(m_currentFileMutex);
+		m_currentFile = writers[0]->getPath();
+		return true;
+	}
+
+	bool FileSinkNode::rotateTake()
+	{
+		// The next take is open before the current one is handed off, so no block is lost
+		std::vector<std::unique_ptr<PcmFileWriter>> next;
+		m_take++;
+		if (!openTake(next))
+		{
+			m_take--;
+			return false;
+		}
+
+		for (auto &writer : m_pcmWriters)
+		{
+			m_pcmService->retire(std::move(writer), [this](const std::string &path, bool success, const std::string &error)
+								 {
+									 if (!success)
+									 {
+										 logMessage("Error finalizing " + path + ": " + error, true);
+									 } });
+		}
+		m_pcmWriters = std::move(next);
+
+		logMessage("Recording take " + std::to_string(m_take.load() + 1) + ": " + getCurrentFile(), false);
+		publishStatus(true);
+		return true;
+	}
+
+	void FileSinkNode::publishStatus(bool recording)
+	{
+		if (!m_oscController)
+		{
+			return;
+		}
+		m_lastStatus = std::chrono::steady_clock::now();
+
+		const double rate = m_sampleRate > 0 ? m_sampleRate : 1.0;
+		const int64_t position = m_pcmService ? m_takeFrames.load() : m_frameCount.load();
+		const int take = m_take.load();
+
+		std::vector<std::pair<std::string, std::vector<std::any>>> messages;
+		messages.emplace_back(m_oscAddress + "/status", std::vector<std::any>{recording ? DUREC_RECORDING : DUREC_STOPPED});
+		messages.emplace_back(m_oscAddress + "/time", std::vector<std::any>{static_cast<int>(m_frameCount.load() / rate)});
+		messages.emplace_back(m_oscAddress + "/position", std::vector<std::any>{static_cast<float>(position / rate)});
+		messages.emplace_back(m_oscAddress + "/name", std::vector<std::any>{take, getCurrentFile()});
+		messages.emplace_back(m_oscAddress + "/numfiles", std::vector<std::any>{take + 1});
+		m_oscController->sendBundle(messages);
+	}
+
+	std::string FileSinkNode::getCurrentFile() const
+	{
+		std::lock_guard<std::mutex> lock(m_currentFileMutex);
+		return m_currentFile;
+	}
+
 	bool FileSinkNode::openFile()
 	{
 		// Close any previously opened file
 		closeFile();
 
+		if (usePcmWriter())
+		{
+			return openPcmWriter();
+		}
+
+		m_take = 0;
+		{
+			std::lock_guard<std::mutex> lock(m_currentFileMutex);
+			m_currentFile = m_filePath;
+		}
+
 		// Allocate format context
 		int ret = avformat_alloc_output_context2(&m_formatContext, NULL,
 												 m_format.c_str(), m_filePath.c_str());
@@ -257,11 +598,12 @@ namespace AudioEngine
 			return false;
 		}
 
-		// Allocate frame and packet
+		// Allocate frames and packet
 		m_frame = av_frame_alloc();
+		m_refFrame = av_frame_alloc();
 		m_packet = av_packet_alloc();
 
-		if (!m_frame || !m_packet)
+		if (!m_frame || !m_refFrame || !m_packet)
 		{
 			logMessage("Failed to allocate frame or packet", true);
 			closeFile();
@@ -305,6 +647,22 @@ namespace AudioEngine
 
 	void FileSinkNode::closeFile()
 	{
+		if (m_pcmService)
+		{
+			for (auto &writer : m_pcmWriters)
+			{
+				std::string error;
+				if (!writer->close(error))
+				{
+					logMessage("Error finalizing " + writer->getPath() + ": " + error, true);
+				}
+			}
+			m_pcmWriters.clear();
+
+			// Waits for takes still closing on the I/O thread
+			m_pcmService.reset();
+		}
+
 		// Write trailer if format context exists
 		if (m_formatContext)
 		{
@@ -345,6 +703,12 @@ namespace AudioEngine
 			m_frame = nullptr;
 		}
 
+		if (m_refFrame)
+		{
+			av_frame_free(&m_refFrame);
+			m_refFrame = nullptr;
+		}
+
 		// Free codec context
 		if (m_codecContext)
 		{
@@ -383,17 +747,23 @@ namespace AudioEngine
 			return false;
 		}
 
-		// Clear the input queue
+		// Nothing else touches the queue until the writer thread starts
+		m_inputQueue->clear();
+		m_inputQueue->resetStats();
+
+		// Reset state
+		m_stopThread = false;
+
+		if (m_targetPort > 0)
 		{
-			std::lock_guard<std::mutex> lock(m_queueMutex);
-			while (!m_inputQueue.empty())
+			m_oscController = std::make_unique<OscController>();
+			if (!m_oscController->configure(m_targetIp, m_targetPort, 0))
 			{
-				m_inputQueue.pop();
+				logMessage("Failed to configure status OSC target - not publishing", false);
+				m_oscController.reset();
 			}
 		}
-
-		// Reset state
-		m_stopThread = false;
+		publishStatus(true);
 
 		// Start the writer thread
 		try
@@ -417,27 +787,29 @@ namespace AudioEngine
 			return;
 		}
 
-		// Signal the writer thread to stop
+		// Signal the writer thread to stop; it drains the queue first
 		m_stopThread = true;
-
-		// Notify thread if it's waiting
-		{
-			std::lock_guard<std::mutex> lock(m_queueMutex);
-			m_queueCondVar.notify_all();
-		}
+		m_writerWake.notify();
+		m_spaceWake.notify();
 
 		// Wait for the writer thread to finish
 		if (m_writerThread.joinable())
 		{
 			m_writerThread.join();
 		}
+		publishStatus(false);
+		m_oscController.reset();
 
 		// Finalize the file
 		flush();
 		closeFile();
 
 		m_running = false;
-		logMessage("Stopped", false);
+
+		AudioBufferQueue::Stats stats = m_inputQueue->getStats();
+		logMessage("Stopped (queue overruns: " + std::to_string(stats.overruns) +
+					   ", dropped: " + std::to_string(stats.dropped) + ")",
+				   false);
 	}
 
 	bool FileSinkNode::process()
@@ -472,78 +844,135 @@ namespace AudioEngine
 			return false;
 		}
 
-		// Add buffer to the queue
+		// Offline nothing may be lost, so wait for the writer to make room
+		if (m_offline)
 		{
-			std::unique_lock<std::mutex> lock(m_queueMutex);
-
-			// Wait if queue is full
-			if (m_inputQueue.size() >= MAX_QUEUE_SIZE)
-			{
-				m_queueCondVar.wait(lock, [this]
-									{ return m_inputQueue.size() < MAX_QUEUE_SIZE || m_stopThread; });
-
-				if (m_stopThread)
-				{
-					return false;
-				}
-			}
-
-			m_inputQueue.push(buffer);
+			m_spaceWake.waitUntil([this]
+								  { return m_stopThread || !m_inputQueue->isFull(); });
+			const bool pushed = m_inputQueue->push(buffer);
+			m_writerWake.notify();
+			return pushed;
 		}
 
-		// Notify writer thread
-		m_queueCondVar.notify_one();
-
-		return true;
+		// In real time never wait; a full queue is counted and handled by the policy. The writer
+		// drains in batches, so wake it once the queue is half full rather than after every block
+		const bool pushed = m_inputQueue->push(buffer);
+		if (m_inputQueue->depth() >= writerWatermark())
+		{
+			m_writerWake.notify();
+		}
+		return pushed;
 	}
 
 	void FileSinkNode::writerThreadFunc()
 	{
-		while (!m_stopThread)
+		const auto statusPeriod = std::chrono::duration<double>(m_statusRateHz > 0.0 ? 1.0 / m_statusRateHz : 0.0);
+		std::shared_ptr<AudioBuffer> buffer;
+		while (true)
 		{
-			// Get buffer from the queue
-			std::shared_ptr<AudioBuffer> buffer = nullptr;
+			if (m_oscController && m_statusRateHz > 0.0 &&
+				std::chrono::steady_clock::now() - m_lastStatus >= statusPeriod)
 			{
-				std::unique_lock<std::mutex> lock(m_queueMutex);
-
-				if (m_inputQueue.empty())
-				{
-					// Wait for data
-					m_queueCondVar.wait_for(lock, std::chrono::milliseconds(100), [this]
-											{ return !m_inputQueue.empty() || m_stopThread; });
-				}
+				publishStatus(true);
+			}
 
-				if (m_stopThread)
+			// Read the flag first so buffers queued before stop() are still written
+			const bool stopping = m_stopThread;
+			if (!m_inputQueue->tryPop(buffer))
+			{
+				if (stopping)
 				{
 					break;
 				}
 
-				if (!m_inputQueue.empty())
+				// A queue below the watermark is picked up on the timeout or at the next status
+				auto deadline = std::chrono::steady_clock::now() + WRITER_IDLE_WAIT;
+				if (m_oscController && m_statusRateHz > 0.0)
 				{
-					buffer = m_inputQueue.front();
-					m_inputQueue.pop();
-					m_queueCondVar.notify_one();
+					deadline = std::min(deadline, m_lastStatus + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+																	 statusPeriod));
 				}
+				const size_t watermark = writerWatermark();
+				m_writerWake.waitUntil([this, watermark]
+									   { return m_stopThread || m_inputQueue->depth() >= watermark; },
+									   deadline);
+				continue;
 			}
+			m_spaceWake.notify();
 
-			if (buffer)
+			// Process the buffer
+			if (!processBuffer(buffer))
 			{
-				// Process the buffer
-				if (!processBuffer(buffer))
-				{
-					logMessage("Error processing buffer", true);
-				}
+				logMessage("Error processing buffer", true);
 			}
+			buffer.reset();
 		}
 	}
 
+	size_t FileSinkNode::writerWatermark() const
+	{
+		// Offline the producer is waiting on the writer, so any block is worth waking for
+		return m_offline ? 1 : std::max<size_t>(1, m_inputQueue->getCapacity() / 2);
+	}
+
 	bool FileSinkNode::processBuffer(std::shared_ptr<AudioBuffer> buffer)
 	{
+		if (m_pcmService)
+		{
+			if (!buffer)
+			{
+				return false;
+			}
+
+			// Takes switch between blocks, so joining them back is sample-exact
+			const long frames = buffer->getFrameCount();
+			const int64_t takeFrames = m_takeFrames.load(std::memory_order_relaxed) + frames;
+			const bool takeFull = (m_rotateSeconds > 0.0 && takeFrames > m_rotateSeconds * m_sampleRate) ||
+								  (m_rotateBytes > 0 && takeFrames * m_pcmFrameBytes > m_rotateBytes);
+			if (takeFull && takeFrames > frames && !rotateTake())
+			{
+				logMessage("Rotation failed - continuing in " + getCurrentFile(), true);
+				m_rotateSeconds = 0.0;
+				m_rotateBytes = 0;
+			}
+
+			bool written = true;
+			for (size_t i = 0; i < m_pcmWriters.size(); i++)
+			{
+				written = m_pcmWriters[i]->write(*buffer, m_split ? static_cast<int>(i) : 0) && written;
+			}
+			m_takeFrames += frames;
+			m_lastPts = m_frameCount;
+			m_frameCount += frames;
+			return written;
+		}
+
 		if (!m_running || !m_formatContext || !m_codecContext || !m_frame || !m_packet)
 		{
 			return false;
 		}
 
+		// Buffers already in the encoder's format go to the encoder by reference
+		if (buffer && m_refFrame &&
+			buffer->getFormat() == m_codecContext->sample_fmt &&
+			buffer->getFrameCount() == m_frame->nb_samples &&
+			av_channel_layout_compare(&buffer->getChannelLayout(), &m_codecContext->ch_layout) == 0)
+		{
+			av_frame_unref(m_refFrame);
+			if (AudioBuffer::attachToAVFrame(buffer, m_refFrame))
+			{
+				m_refFrame->sample_rate = m_sampleRate;
+				m_refFrame->pts = m_frameCount;
+				m_lastPts = m_frameCount;
+				m_frameCount += m_refFrame->nb_samples;
+
+				// The encoder takes its own reference if it needs to keep the data
+				bool encoded = encodeFrame(m_refFrame);
+				av_frame_unref(m_refFrame);
+				return encoded;
+			}
+		}
+
 		// Make sure the frame is writeable
 		int ret = av_frame_make_writable(m_frame);
 		if (ret < 0)
@@ -711,6 +1140,12 @@ namespace AudioEngine
 
 	bool FileSinkNode::flush()
 	{
+		// The PCM writers keep their partial buffers until close so writes stay aligned
+		if (m_pcmService)
+		{
+			return true;
+		}
+
 		if (!m_running || !m_formatContext || !m_codecContext)
 		{
 			return false;
@@ -722,6 +1157,12 @@ namespace AudioEngine
 
 	int64_t FileSinkNode::getFileSize() const
 	{
+		if (m_pcmService)
+		{
+			// Audio accepted for the current take, across all of its files
+			return m_takeFrames.load(std::memory_order_relaxed) * m_pcmFrameBytes;
+		}
+
 		if (!m_formatContext || !m_formatContext->pb)
 		{
 			return 0;
@@ -730,6 +1171,25 @@ namespace AudioEngine
 		return avio_size(m_formatContext->pb);
 	}
 
+	void FileSinkNode::setOfflineMode(bool offline)
+	{
+		if (m_running)
+		{
+			logMessage("Cannot change rendering mode while running", true);
+			return;
+		}
+		m_offline = offline;
+	}
+
+	AudioBufferQueue::Stats FileSinkNode::getQueueStats() const
+	{
+		if (!m_inputQueue)
+		{
+			return AudioBufferQueue::Stats{};
+		}
+		return m_inputQueue->getStats();
+	}
+
 	double FileSinkNode::getDuration() const
 	{
 		if (m_sampleRate <= 0)
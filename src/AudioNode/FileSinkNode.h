@@ -1,12 +1,16 @@
 #pragma once
 
 #include "AudioNode.h"
+#include "AudioBufferQueue.h"
+#include "PcmFileWriter.h"
+#include "WakeEvent.h"
 #include <string>
-#include <mutex>
 #include <thread>
-#include <queue>
-#include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 extern "C"
 {
@@ -18,8 +22,48 @@ extern "C"
 namespace AudioEngine
 {
 
+	class OscController; // Forward declaration
+
 	/**
 	 * @brief Node for writing audio to a file
+	 *
+	 * setInputBuffer() hands buffers to a writer thread through a lock-free
+	 * ring and, in real time, never blocks; it wakes the writer once the ring
+	 * is half full. Offline it waits for space instead of dropping. Queue
+	 * parameters:
+	 * - queue_size: Buffers the writer may fall behind by (default 32)
+	 * - queue_policy: "drop_newest" (default) or "drop_oldest" when the writer
+	 *   cannot keep up
+	 *
+	 * WAV and RF64 output with a PCM codec (pcm_s16le, pcm_s24le, pcm_s32le,
+	 * pcm_f32le, pcm_f64le) bypasses libavformat and goes through a
+	 * PcmFileWriter, which coalesces blocks into large aligned writes on its
+	 * own I/O thread. Its parameters:
+	 * - direct_io: "true" to bypass the page cache (default false)
+	 * - write_buffer_kb: Size of each write buffer (default 4096)
+	 * - preallocate_mb: File space reserved ahead of the audio (default 64,
+	 *   0 = off)
+	 * - header_interval: Seconds between header updates, so a crash leaves a
+	 *   playable file (default 1, 0 = only when closing)
+	 * - pcm_writer: "false" to use libavformat anyway
+	 *
+	 * Multitrack recording (PCM writer only):
+	 * - split: "true" writes one mono file per channel, <name>_01.wav,
+	 *   <name>_02.wav, ... All files share one I/O thread and buffer pool
+	 *   (write_buffer_kb then defaults to 512 per file).
+	 * - rotate_seconds / rotate_mb: Start a new take when the current files
+	 *   would exceed this duration or audio size (default 0 = never). Takes are
+	 *   numbered into the names (<name>_001.wav or <name>_001_01.wav) and
+	 *   switch at a block boundary, so consecutive takes join without a gap;
+	 *   the previous take closes on the I/O thread.
+	 *
+	 * Recorder state is published over OSC like the interface's DURec state
+	 * in oscmix, as one bundle under osc_address (default "/durec/<name>"):
+	 * status (5 = stopped, 6 = recording, as oscmix's DUREC_STATUS_NAMES),
+	 * time (seconds recorded), position (seconds into the take), name (take
+	 * number and file) and numfiles (takes so far).
+	 * - target_ip / target_port: Receiver (default 127.0.0.1, port 0 = off)
+	 * - status_rate_hz: Updates per second while recording (default 4)
 	 */
 	class FileSinkNode : public AudioNode
 	{
@@ -54,6 +98,14 @@ namespace AudioEngine
 		int getInputPadCount() const override { return 1; }	 // One input
 		int getOutputPadCount() const override { return 0; } // No outputs
 
+		/**
+		 * @brief Select offline rendering
+		 *
+		 * Offline, setInputBuffer() waits for the writer instead of dropping
+		 * buffers when the queue is full.
+		 */
+		void setOfflineMode(bool offline) override;
+
 		/**
 		 * @brief Flush any remaining audio data to the file and finalize
 		 */
@@ -80,6 +132,27 @@ namespace AudioEngine
 		 */
 		double getDuration() const;
 
+		/**
+		 * @brief Get the write queue counters
+		 *
+		 * Overruns count buffers that arrived while the writer was behind.
+		 *
+		 * @return Queue statistics
+		 */
+		AudioBufferQueue::Stats getQueueStats() const;
+
+		/**
+		 * @brief Get the file being written
+		 *
+		 * @return First file of the current take (the output file unless split or rotating)
+		 */
+		std::string getCurrentFile() const;
+
+		/**
+		 * @brief Get the current take number (0 for the first)
+		 */
+		int getTake() const { return m_take.load(std::memory_order_relaxed); }
+
 	private:
 		// File information
 		std::string m_filePath;
@@ -94,17 +167,48 @@ namespace AudioEngine
 		AVStream *m_stream;
 
 		// Encoder state
-		AVFrame *m_frame;
+		AVFrame *m_frame;	 // Writable frame for buffers that need copying
+		AVFrame *m_refFrame; // References buffers already in the encoder's format
 		AVPacket *m_packet;
 
+		// Direct PCM writers (replace the FFmpeg objects for WAV/RF64 PCM);
+		// one per channel when splitting, declared after the service they use
+		std::unique_ptr<PcmWriteService> m_pcmService;
+		std::vector<std::unique_ptr<PcmFileWriter>> m_pcmWriters;
+		PcmFileWriter::Options m_pcmOptions;
+		PcmFileWriter::Encoding m_pcmEncoding;
+		bool m_pcmWriterEnabled;
+		bool m_bufferSizeSet;
+		int m_pcmFrameBytes; // Bytes per frame across a take's files
+
+		// Multitrack and rotation
+		bool m_split;
+		double m_rotateSeconds;
+		int64_t m_rotateBytes;
+		std::atomic<int> m_take;
+		std::atomic<int64_t> m_takeFrames;
+		std::string m_currentFile;
+		mutable std::mutex m_currentFileMutex;
+
+		// Status publishing (writer thread)
+		std::unique_ptr<OscController> m_oscController;
+		std::string m_targetIp;
+		int m_targetPort;
+		std::string m_oscAddress;
+		double m_statusRateHz;
+		std::chrono::steady_clock::time_point m_lastStatus;
+
 		// Writer thread
 		std::thread m_writerThread;
 		std::atomic<bool> m_stopThread;
+		WakeEvent m_writerWake; // Queue half full, or a stop request
+		WakeEvent m_spaceWake;	// Offline setInputBuffer(): queue space or a stop request
 
-		// Input buffer queue
-		std::queue<std::shared_ptr<AudioBuffer>> m_inputQueue;
-		std::mutex m_queueMutex;
-		std::condition_variable m_queueCondVar;
+		// Write queue (setInputBuffer() -> writer thread)
+		std::unique_ptr<AudioBufferQueue> m_inputQueue;
+		size_t m_queueSize;
+		QueuePolicy m_queuePolicy;
+		bool m_offline;
 
 		// Duration tracking
 		std::atomic<int64_t> m_frameCount;
@@ -112,12 +216,25 @@ namespace AudioEngine
 		int64_t m_startPts;
 		int64_t m_lastPts;
 
-		// Maximum buffer queue size
-		const int MAX_QUEUE_SIZE = 4;
+		// Default write queue depth
+		static constexpr size_t DEFAULT_QUEUE_SIZE = 32;
+
+		// Longest the writer sleeps on a queue below its watermark
+		static constexpr std::chrono::milliseconds WRITER_IDLE_WAIT{100};
+
+		// Default write buffer per file when splitting into mono files
+		static constexpr size_t SPLIT_BUFFER_BYTES = 512 * 1024;
 
 		// Helper methods
 		void writerThreadFunc();
+		size_t writerWatermark() const;
 		bool openFile();
+		bool usePcmWriter() const;
+		bool openPcmWriter();
+		bool openTake(std::vector<std::unique_ptr<PcmFileWriter>> &writers);
+		bool rotateTake();
+		std::string makeTakePath(int take, int channel) const;
+		void publishStatus(bool recording);
 		void closeFile();
 		bool processBuffer(std::shared_ptr<AudioBuffer> buffer);
 		bool encodeFrame(AVFrame *frame);
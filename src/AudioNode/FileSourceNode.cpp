@@ -1,7 +1,12 @@
 #include "FileSourceNode.h"
+#include "AudioBufferPool.h"
 #include "AudioEngine.h"
+#include "MappedPcmFile.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 
 extern "C"
 {
@@ -17,16 +22,42 @@ namespace AudioEngine
 
 	FileSourceNode::FileSourceNode(const std::string &name, AudioEngine *engine)
 		: AudioNode(name, NodeType::FILE_SOURCE, engine),
+		  m_duration(0.0),
 		  m_formatContext(nullptr),
 		  m_codecContext(nullptr),
 		  m_swrContext(nullptr),
 		  m_audioStreamIndex(-1),
-		  m_packet(nullptr),
-		  m_decodedFrame(nullptr),
-		  m_convertedFrame(nullptr),
+		  m_passthrough(false),
+		  m_decoderThreads(0),
+		  m_mmapEnabled(true),
+		  m_mappedZeroCopy(false),
+		  m_mappedPosition(0),
+		  m_prefetchedUntil(0),
+		  m_spareFrame(nullptr),
+		  m_seekGeneration(0),
 		  m_stopThread(false),
+		  m_queueSize(0),
+		  m_queuePolicy(QueuePolicy::SILENCE_FILL),
+		  m_seekRequested(false),
+		  m_seekTarget(0.0),
+		  m_seekSerial(0),
+		  m_lastSeekSerial(0),
+		  m_flushRequest(0),
+		  m_flushDone(0),
+		  m_trimPending(false),
+		  m_trimPosition(0.0),
+		  m_cueClock(0),
+		  m_cueCacheBytes(0),
+		  m_cueCacheLimit(DEFAULT_CUE_CACHE_MB << 20),
+		  m_cueFrames(0),
+		  m_pendingCue(nullptr),
+		  m_activeCue(nullptr),
+		  m_cueHits(0),
+		  m_cueMisses(0),
+		  m_cueEvictions(0),
+		  m_cueUnderruns(0),
 		  m_currentPosition(0.0),
-		  m_duration(0.0),
+		  m_offline(false),
 		  m_endOfFile(false),
 		  m_startTime(0.0)
 	{
@@ -57,6 +88,14 @@ namespace AudioEngine
 			return false;
 		}
 
+		if (!m_converter.configure(m_sampleRate, m_bufferSize, m_format, m_channelLayout,
+								   [this](const std::shared_ptr<AudioBuffer> &block)
+								   { return enqueueBuffer(block); }))
+		{
+			logMessage("Unsupported engine format", true);
+			return false;
+		}
+
 		// Get file path
 		auto it = params.find("file_path");
 		if (it == params.end())
@@ -66,12 +105,127 @@ namespace AudioEngine
 		}
 		m_filePath = it->second;
 
+		// Read-ahead queue
+		it = params.find("queue_size");
+		if (it != params.end())
+		{
+			try
+			{
+				int size = std::stoi(it->second);
+				if (size < 1)
+				{
+					throw std::out_of_range("queue_size");
+				}
+				m_queueSize = static_cast<size_t>(size);
+			}
+			catch (const std::exception &)
+			{
+				logMessage("Invalid queue_size: " + it->second, true);
+				return false;
+			}
+		}
+
+		it = params.find("queue_policy");
+		if (it != params.end() && !AudioBufferQueue::parsePolicy(it->second, m_queuePolicy))
+		{
+			logMessage("Invalid queue_policy: " + it->second, true);
+			return false;
+		}
+
+		// Uncompressed WAV/W64/RF64 is read straight from a memory mapping unless disabled
+		it = params.find("mmap");
+		m_mmapEnabled = it == params.end() || it->second != "false";
+
+		// Decoder threads; applied when the codec is opened
+		it = params.find("decoder_threads");
+		if (it != params.end())
+		{
+			try
+			{
+				int threads = std::stoi(it->second);
+				if (threads < 0)
+				{
+					throw std::out_of_range("decoder_threads");
+				}
+				m_decoderThreads = threads;
+			}
+			catch (const std::exception &)
+			{
+				logMessage("Invalid decoder_threads: " + it->second, true);
+				return false;
+			}
+		}
+
+		// Cue cache
+		int cueLengthMs = DEFAULT_CUE_LENGTH_MS;
+		it = params.find("cue_length_ms");
+		if (it != params.end())
+		{
+			try
+			{
+				cueLengthMs = std::stoi(it->second);
+				if (cueLengthMs < 1)
+				{
+					throw std::out_of_range("cue_length_ms");
+				}
+			}
+			catch (const std::exception &)
+			{
+				logMessage("Invalid cue_length_ms: " + it->second, true);
+				return false;
+			}
+		}
+		m_cueFrames = static_cast<int64_t>(cueLengthMs) * static_cast<int64_t>(sampleRate) / 1000;
+
+		it = params.find("cue_cache_mb");
+		if (it != params.end())
+		{
+			try
+			{
+				int megabytes = std::stoi(it->second);
+				if (megabytes < 1)
+				{
+					throw std::out_of_range("cue_cache_mb");
+				}
+				m_cueCacheLimit = static_cast<size_t>(megabytes) << 20;
+			}
+			catch (const std::exception &)
+			{
+				logMessage("Invalid cue_cache_mb: " + it->second, true);
+				return false;
+			}
+		}
+
 		// Open the file and prepare decoder
 		if (!openFile())
 		{
 			return false;
 		}
 
+		// Cues of a previous file point at different audio
+		clearCues();
+		it = params.find("cues");
+		if (it != params.end())
+		{
+			std::stringstream list(it->second);
+			std::string item;
+			while (std::getline(list, item, ','))
+			{
+				try
+				{
+					if (!addCue(std::stod(item)))
+					{
+						throw std::out_of_range("cues");
+					}
+				}
+				catch (const std::exception &)
+				{
+					logMessage("Invalid cue position: " + item, true);
+					return false;
+				}
+			}
+		}
+
 		m_configured = true;
 		logMessage("Configured for file: " + m_filePath + " (Duration: " +
 					   std::to_string(m_duration) + "s)",
@@ -85,6 +239,11 @@ namespace AudioEngine
 		// Close any previously opened file
 		closeFile();
 
+		if (m_mmapEnabled && openMapped())
+		{
+			return true;
+		}
+
 		// Open the input file
 		int ret = avformat_open_input(&m_formatContext, m_filePath.c_str(), nullptr, nullptr);
 		if (ret < 0)
@@ -154,6 +313,13 @@ namespace AudioEngine
 			return false;
 		}
 
+		// Frame and slice threading where the decoder supports it (FLAC, ALAC, ...)
+		if (codec->capabilities & (AV_CODEC_CAP_FRAME_THREADS | AV_CODEC_CAP_SLICE_THREADS))
+		{
+			m_codecContext->thread_count = m_decoderThreads;
+			m_codecContext->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+		}
+
 		// Open codec
 		ret = avcodec_open2(m_codecContext, codec, nullptr);
 		if (ret < 0)
@@ -167,71 +333,46 @@ namespace AudioEngine
 			return false;
 		}
 
-		// Create packet and frames
-		m_packet = av_packet_alloc();
-		m_decodedFrame = av_frame_alloc();
-		m_convertedFrame = av_frame_alloc();
-
-		if (!m_packet || !m_decodedFrame || !m_convertedFrame)
+		if (m_codecContext->active_thread_type != 0)
 		{
-			logMessage("Failed to allocate packet or frames", true);
-			if (m_packet)
-				av_packet_free(&m_packet);
-			if (m_decodedFrame)
-				av_frame_free(&m_decodedFrame);
-			if (m_convertedFrame)
-				av_frame_free(&m_convertedFrame);
-			avcodec_free_context(&m_codecContext);
-			avformat_close_input(&m_formatContext);
-			m_formatContext = nullptr;
-			m_packet = nullptr;
-			m_decodedFrame = nullptr;
-			m_convertedFrame = nullptr;
-			return false;
+			logMessage("Decoding with " + std::to_string(m_codecContext->thread_count) + " threads", false);
 		}
 
-		// Prepare the converted frame
-		m_convertedFrame->format = m_format;
-		m_convertedFrame->nb_samples = m_bufferSize;
-		m_convertedFrame->channel_layout = 0; // deprecated, use ch_layout instead
-		m_convertedFrame->sample_rate = m_sampleRate;
-		ret = av_channel_layout_copy(&m_convertedFrame->ch_layout, &m_channelLayout);
-		if (ret < 0)
+		// Packets and frames that circulate through the pipeline
+		m_packetPool.assign(PACKET_POOL_SIZE, nullptr);
+		m_framePool.assign(FRAME_POOL_SIZE, nullptr);
+		bool allocated = true;
+		for (auto &packet : m_packetPool)
 		{
-			logMessage("Failed to copy channel layout", true);
-			closeFile();
-			return false;
+			packet = av_packet_alloc();
+			allocated = allocated && packet;
+		}
+		for (auto &frame : m_framePool)
+		{
+			frame = av_frame_alloc();
+			allocated = allocated && frame;
 		}
 
-		// Init resampler
-		m_swrContext = swr_alloc();
-		if (!m_swrContext)
+		if (!allocated)
 		{
-			logMessage("Failed to allocate resampler context", true);
+			logMessage("Failed to allocate packet or frames", true);
 			closeFile();
 			return false;
 		}
 
-		// Set resampler options
-		av_opt_set_int(m_swrContext, "in_channel_count", m_codecContext->ch_layout.nb_channels, 0);
-		av_opt_set_int(m_swrContext, "out_channel_count", m_channelLayout.nb_channels, 0);
-
-		av_opt_set_int(m_swrContext, "in_channel_layout", m_codecContext->ch_layout.u.mask, 0);
-		av_opt_set_int(m_swrContext, "out_channel_layout", m_channelLayout.u.mask, 0);
-
-		av_opt_set_int(m_swrContext, "in_sample_rate", m_codecContext->sample_rate, 0);
-		av_opt_set_int(m_swrContext, "out_sample_rate", m_sampleRate, 0);
-
-		av_opt_set_sample_fmt(m_swrContext, "in_sample_fmt", m_codecContext->sample_fmt, 0);
-		av_opt_set_sample_fmt(m_swrContext, "out_sample_fmt", m_format, 0);
+		// Decoded frames that already match the engine format are passed on by reference
+		m_passthrough = m_codecContext->sample_fmt == m_format &&
+						m_codecContext->sample_rate == static_cast<int>(m_sampleRate) &&
+						av_channel_layout_compare(&m_codecContext->ch_layout, &m_channelLayout) == 0;
+		m_trimPlanes.assign(av_sample_fmt_is_planar(m_codecContext->sample_fmt) ? m_codecContext->ch_layout.nb_channels : 1,
+							nullptr);
 
-		// Initialize resampler
-		ret = swr_init(m_swrContext);
-		if (ret < 0)
+		// Init resampler
+		std::string error;
+		m_swrContext = m_converter.createResampler(m_codecContext, error);
+		if (!m_swrContext)
 		{
-			char errbuf[AV_ERROR_MAX_STRING_SIZE];
-			av_strerror(ret, errbuf, sizeof(errbuf));
-			logMessage("Failed to initialize resampler: " + std::string(errbuf), true);
+			logMessage("Failed to initialize resampler: " + error, true);
 			closeFile();
 			return false;
 		}
@@ -276,8 +417,55 @@ namespace AudioEngine
 		return true;
 	}
 
+	bool FileSourceNode::openMapped()
+	{
+		auto file = std::make_shared<MappedPcmFile>();
+		std::string reason;
+		if (!file->open(m_filePath, reason))
+		{
+			// Compressed and other containers take the FFmpeg path
+			return false;
+		}
+
+		const AVSampleFormat fileFormat = file->getSampleFormat();
+		const bool shapeMatches = file->getSampleRate() == static_cast<int>(m_sampleRate) &&
+								  file->getChannels() == m_channelLayout.nb_channels;
+
+		// Zero-copy needs the engine's layout in the file (interleaved, or mono) and aligned samples
+		const bool sameLayout = fileFormat != AV_SAMPLE_FMT_NONE &&
+								(fileFormat == m_format ||
+								 (file->getChannels() == 1 && av_get_planar_sample_fmt(fileFormat) == m_format));
+		const bool aligned = file->getFrameCount() == 0 ||
+							 reinterpret_cast<uintptr_t>(file->frameData(0)) % (file->getBitsPerSample() / 8) == 0;
+		m_mappedZeroCopy = shapeMatches && sameLayout && aligned;
+
+		if (!m_mappedZeroCopy && (!shapeMatches || m_format != AV_SAMPLE_FMT_FLTP))
+		{
+			// Resampling, remixing and other engine formats take the FFmpeg path
+			logMessage("Mapped PCM file doesn't match the engine format - decoding with FFmpeg", false);
+			return false;
+		}
+
+		m_mappedFile = std::move(file);
+		m_passthrough = m_mappedZeroCopy;
+		m_duration = static_cast<double>(m_mappedFile->getFrameCount()) / m_sampleRate;
+		m_startTime = 0.0;
+		m_currentPosition = 0.0;
+		m_endOfFile = false;
+
+		logMessage("Memory-mapped PCM file: " + std::to_string(m_mappedFile->getChannels()) + " channels, " +
+					   std::to_string(m_mappedFile->getBitsPerSample()) + " bit" +
+					   (m_mappedFile->isFloat() ? " float" : "") + ", " +
+					   (m_mappedZeroCopy ? "zero-copy" : "converted"),
+				   false);
+		return true;
+	}
+
 	void FileSourceNode::closeFile()
 	{
+		// Buffers still handed out keep their own reference to the mapping
+		m_mappedFile.reset();
+
 		// Cleanup resources
 		if (m_swrContext)
 		{
@@ -285,23 +473,23 @@ namespace AudioEngine
 			m_swrContext = nullptr;
 		}
 
-		if (m_convertedFrame)
-		{
-			av_frame_free(&m_convertedFrame);
-			m_convertedFrame = nullptr;
-		}
+		// The rings only point into the pools
+		m_packetRing.reset();
+		m_freePackets.reset();
+		m_frameRing.reset();
+		m_freeFrames.reset();
 
-		if (m_decodedFrame)
+		for (auto &frame : m_framePool)
 		{
-			av_frame_free(&m_decodedFrame);
-			m_decodedFrame = nullptr;
+			av_frame_free(&frame);
 		}
+		m_framePool.clear();
 
-		if (m_packet)
+		for (auto &packet : m_packetPool)
 		{
-			av_packet_free(&m_packet);
-			m_packet = nullptr;
+			av_packet_free(&packet);
 		}
+		m_packetPool.clear();
 
 		if (m_codecContext)
 		{
@@ -332,30 +520,85 @@ namespace AudioEngine
 			return true;
 		}
 
-		// Clear the output queue
+		// Sized here because the depth depends on the rendering mode
+		size_t queueSize = m_queueSize > 0 ? m_queueSize : (m_offline ? OFFLINE_QUEUE_SIZE : DEFAULT_QUEUE_SIZE);
+		m_outputQueue = std::make_unique<AudioBufferQueue>(queueSize, m_queuePolicy);
+		m_outputBuffer.reset();
+		m_converter.reset();
+		m_flushDone.store(m_flushRequest.load());
+
+		// Allocated here so an underrun costs nothing on the audio thread
+		m_silenceBuffer.reset();
+		if (!m_offline && m_queuePolicy == QueuePolicy::SILENCE_FILL)
 		{
-			std::lock_guard<std::mutex> lock(m_queueMutex);
-			while (!m_outputQueue.empty())
+			m_silenceBuffer = AudioBufferPool::shared().acquire(m_bufferSize, m_sampleRate, m_format, m_channelLayout);
+			if (!m_silenceBuffer || !m_silenceBuffer->clear())
 			{
-				m_outputQueue.pop();
+				logMessage("Failed to allocate silence buffer", true);
+				return false;
 			}
+			m_silenceBuffer->publish();
+		}
+
+		// Every pooled packet and frame starts out free; leftovers of a previous run are dropped.
+		// A mapped file has no pools and leaves the rings empty.
+		m_packetRing = std::make_unique<SpscRing<PacketItem>>(2 * PACKET_POOL_SIZE);
+		m_freePackets = std::make_unique<SpscRing<AVPacket *>>(PACKET_POOL_SIZE);
+		m_frameRing = std::make_unique<SpscRing<FrameItem>>(2 * FRAME_POOL_SIZE);
+		m_freeFrames = std::make_unique<SpscRing<AVFrame *>>(FRAME_POOL_SIZE);
+		for (AVPacket *packet : m_packetPool)
+		{
+			av_packet_unref(packet);
+			m_freePackets->tryPush(packet);
+		}
+		for (AVFrame *frame : m_framePool)
+		{
+			av_frame_unref(frame);
+			m_freeFrames->tryPush(frame);
 		}
+		m_spareFrame = nullptr;
 
 		// Reset state
 		m_endOfFile = false;
 		m_stopThread = false;
+		m_seekRequested = false;
+		m_lastSeekSerial = m_seekSerial.load();
+		m_trimPending = false;
+		m_activeCue = nullptr;
 
-		// Start the reader thread
+		// Start the pipeline, last stage first; a mapped file needs one reader only
 		try
 		{
-			m_readerThread = std::thread(&FileSourceNode::readerThreadFunc, this);
+			if (m_mappedFile)
+			{
+				m_mappedPosition = 0;
+				m_prefetchedUntil = 0;
+				m_demuxThread = std::thread(&FileSourceNode::mappedReaderThreadFunc, this);
+			}
+			else
+			{
+				m_convertThread = std::thread(&FileSourceNode::convertThreadFunc, this);
+				m_decodeThread = std::thread(&FileSourceNode::decodeThreadFunc, this);
+				m_demuxThread = std::thread(&FileSourceNode::demuxThreadFunc, this);
+			}
+			m_cueThread = std::thread(&FileSourceNode::cueThreadFunc, this);
 			m_running = true;
 			logMessage("Started", false);
 			return true;
 		}
 		catch (const std::exception &e)
 		{
-			logMessage("Failed to start reader thread: " + std::string(e.what()), true);
+			logMessage("Failed to start reader threads: " + std::string(e.what()), true);
+			m_stopThread = true;
+			m_cueCondition.notify_all();
+			notifyStages();
+			for (std::thread *thread : {&m_demuxThread, &m_decodeThread, &m_convertThread, &m_cueThread})
+			{
+				if (thread->joinable())
+				{
+					thread->join();
+				}
+			}
 			return false;
 		}
 	}
@@ -367,81 +610,170 @@ namespace AudioEngine
 			return;
 		}
 
-		// Signal the reader thread to stop
-		m_stopThread = true;
-
-		// Notify consumer that we're stopping
+		// Signal the pipeline to stop; every wait in it checks the flag
 		{
-			std::lock_guard<std::mutex> lock(m_queueMutex);
-			m_queueCondVar.notify_all();
+			std::lock_guard<std::mutex> lock(m_cueMutex);
+			m_stopThread = true;
 		}
+		m_cueCondition.notify_all();
+		notifyStages();
 
-		// Wait for the reader thread to finish
-		if (m_readerThread.joinable())
+		// Wait for the stages to finish
+		for (std::thread *thread : {&m_demuxThread, &m_decodeThread, &m_convertThread, &m_cueThread})
 		{
-			m_readerThread.join();
+			if (thread->joinable())
+			{
+				thread->join();
+			}
 		}
 
 		m_running = false;
-		logMessage("Stopped", false);
-	}
+		m_outputBuffer.reset();
+		m_converter.reset();
+		releaseCues();
 
-	bool FileSourceNode::process()
-	{
-		// This node doesn't need explicit processing since reading happens in the reader thread
-		return true;
+		AudioBufferQueue::Stats stats = m_outputQueue->getStats();
+		logMessage("Stopped (queue underruns: " + std::to_string(stats.underruns) +
+					   ", dropped: " + std::to_string(stats.dropped) + ")",
+				   false);
 	}
 
-	std::shared_ptr<AudioBuffer> FileSourceNode::getOutputBuffer(int padIndex)
+	bool FileSourceNode::process()
 	{
-		if (padIndex != 0)
+		if (!m_running)
 		{
-			logMessage("Invalid output pad index: " + std::to_string(padIndex), true);
-			return nullptr;
+			m_outputBuffer.reset();
+			return true;
 		}
 
-		if (!m_running)
+		// A seek happened; everything queued so far predates it
+		const uint64_t flushRequest = m_flushRequest.load(std::memory_order_acquire);
+		if (flushRequest != m_flushDone.load(std::memory_order_relaxed))
 		{
-			return nullptr;
+			m_outputQueue->clear();
+			m_flushDone.store(flushRequest, std::memory_order_release);
+			m_convertWake.notify();
+
+			// A later seek ends cue playback
+			if (m_activeCue && flushRequest > m_activeCue->seekSerial)
+			{
+				retireCue();
+			}
 		}
 
-		// Get the next buffer from the queue
-		std::unique_lock<std::mutex> lock(m_queueMutex);
+		// A cache hit plays from memory while the reader seeks to where the cache ends
+		if (CuePlayback *cue = m_pendingCue.exchange(nullptr, std::memory_order_acq_rel))
+		{
+			retireCue();
+			m_activeCue = cue;
 
-		// If queue is empty and we've reached EOF, return null
-		if (m_outputQueue.empty() && m_endOfFile)
+			// Until the reader has flushed for this seek, the queue holds audio from before it
+			if (m_flushDone.load(std::memory_order_relaxed) < cue->seekSerial)
+			{
+				m_outputQueue->clear();
+				m_convertWake.notify();
+			}
+		}
+		if (m_activeCue && playCue())
 		{
-			return nullptr;
+			return true;
 		}
 
-		// Wait for data if queue is empty (but not at EOF yet)
-		if (m_outputQueue.empty())
+		// Offline there is no deadline; wait for the reader instead of underrunning
+		if (m_offline)
 		{
-			// Wait with timeout
-			auto waitResult = m_queueCondVar.wait_for(
-				lock, std::chrono::milliseconds(500),
-				[this]
-				{ return !m_outputQueue.empty() || m_stopThread; });
+			m_outputBuffer.reset();
+			m_outputWake.waitUntil([this]
+								   { return m_outputQueue->tryPop(m_outputBuffer) ||
+											m_endOfFile.load(std::memory_order_acquire) || m_stopThread; });
 
-			if (m_stopThread || !waitResult)
+			// The reader queues everything it has before raising the EOF flag
+			if (!m_outputBuffer && m_endOfFile.load(std::memory_order_acquire))
 			{
-				return nullptr;
+				m_outputQueue->tryPop(m_outputBuffer);
 			}
+			m_convertWake.notify();
+			return true;
 		}
 
-		if (m_outputQueue.empty())
+		// An empty queue after EOF is the end of the stream, not an underrun
+		if (m_endOfFile.load(std::memory_order_acquire))
 		{
-			return nullptr;
+			m_outputBuffer.reset();
+			m_outputQueue->tryPop(m_outputBuffer);
+			return true;
 		}
 
-		// Get buffer from the front of the queue
-		auto buffer = m_outputQueue.front();
-		m_outputQueue.pop();
+		m_outputBuffer = m_outputQueue->pop();
 
-		// Notify producer thread if it was waiting
-		m_queueCondVar.notify_one();
+		// The converter refills in batches: wake it once the queue is half empty, not after every block
+		if (m_outputBuffer && m_outputQueue->depth() <= m_outputQueue->getCapacity() / 2)
+		{
+			m_convertWake.notify();
+		}
+		if (!m_outputBuffer && m_queuePolicy == QueuePolicy::SILENCE_FILL)
+		{
+			m_outputBuffer = m_silenceBuffer;
+		}
+		return true;
+	}
 
-		return buffer;
+	bool FileSourceNode::playCue()
+	{
+		const auto &blocks = m_activeCue->cache->blocks;
+		if (m_activeCue->next < blocks.size())
+		{
+			m_outputBuffer = blocks[m_activeCue->next++];
+			return true;
+		}
+
+		// Played out; the queue carries on from the end of the cache once the seek is flushed
+		const uint64_t serial = m_activeCue->seekSerial;
+		if (m_flushDone.load(std::memory_order_relaxed) < serial)
+		{
+			if (!m_offline)
+			{
+				// The reader is late: the cue was too short for this file's seek time
+				m_cueUnderruns.fetch_add(1, std::memory_order_relaxed);
+				m_outputBuffer = m_queuePolicy == QueuePolicy::SILENCE_FILL ? m_silenceBuffer : nullptr;
+				return true;
+			}
+
+			m_outputWake.waitUntil([this, serial]
+								   { return m_stopThread || m_flushRequest.load(std::memory_order_acquire) >= serial; });
+			m_outputQueue->clear();
+			m_flushDone.store(m_flushRequest.load(std::memory_order_acquire), std::memory_order_release);
+			m_convertWake.notify();
+		}
+
+		retireCue();
+		return false;
+	}
+
+	void FileSourceNode::retireCue()
+	{
+		if (!m_activeCue)
+		{
+			return;
+		}
+		if (!m_retiredCues.tryPush(m_activeCue))
+		{
+			// The cue thread sweeps the ring every few milliseconds, so this means it is gone
+			delete m_activeCue;
+		}
+		m_activeCue = nullptr;
+	}
+
+	std::shared_ptr<AudioBuffer> FileSourceNode::getOutputBuffer(int padIndex)
+	{
+		if (padIndex != 0)
+		{
+			logMessage("Invalid output pad index: " + std::to_string(padIndex), true);
+			return nullptr;
+		}
+
+		// Taken from the queue by process(); every consumer of this block shares it
+		return m_outputBuffer;
 	}
 
 	bool FileSourceNode::setInputBuffer(std::shared_ptr<AudioBuffer> buffer, int padIndex)
@@ -450,93 +782,161 @@ namespace AudioEngine
 		return false;
 	}
 
-	void FileSourceNode::readerThreadFunc()
+	void FileSourceNode::notifyStages()
+	{
+		m_demuxWake.notify();
+		m_decodeWake.notify();
+		m_convertWake.notify();
+		m_outputWake.notify();
+	}
+
+	template <typename T>
+	bool FileSourceNode::pushWhenFree(SpscRing<T> &ring, const T &item, WakeEvent &producer, WakeEvent &consumer)
+	{
+		// The consumer wakes the producer after every pop
+		bool pushed = false;
+		producer.waitUntil([&]
+						   { return m_stopThread || (pushed = ring.tryPush(item)); });
+		if (pushed)
+		{
+			consumer.notify();
+		}
+		return pushed;
+	}
+
+	void FileSourceNode::demuxThreadFunc()
 	{
+		AVPacket *packet = nullptr; // Taken from the free ring, not yet filled
+		bool ended = false;
+
 		while (!m_stopThread)
 		{
-			// Check if output queue is full
+			double position = 0.0;
+			uint64_t serial = 0;
+			if (takeSeekRequest(position, serial))
 			{
-				std::unique_lock<std::mutex> lock(m_queueMutex);
-				if (m_outputQueue.size() >= MAX_QUEUE_SIZE)
+				if (performSeek(position, serial))
 				{
-					// Queue is full, wait for some buffers to be consumed
-					m_queueCondVar.wait(lock, [this]
-										{ return m_outputQueue.size() < MAX_QUEUE_SIZE || m_stopThread; });
+					ended = false;
 				}
+				continue;
+			}
 
-				if (m_stopThread)
-				{
-					break;
-				}
+			if (ended)
+			{
+				// Nothing left to read until a seek
+				m_demuxWake.waitUntil([this]
+									  { return m_stopThread || m_seekRequested.load(std::memory_order_acquire); });
+				continue;
+			}
+
+			// Every pooled packet is in flight: the decoder is behind
+			if (!packet)
+			{
+				m_demuxWake.waitUntil([this, &packet]
+									  { return m_stopThread || m_seekRequested.load(std::memory_order_acquire) ||
+											   m_freePackets->tryPop(packet); });
+				continue;
 			}
 
-			// Read and decode the next frame
-			if (!readNextFrame())
+			const uint64_t generation = m_seekGeneration.load(std::memory_order_relaxed);
+			if (!readNextPacket(packet))
 			{
-				if (!m_endOfFile)
+				// Errors end the stream too; the decoder drains what it has
+				if (pushWhenFree(*m_packetRing, PacketItem{nullptr, StageEvent::END_OF_FILE, generation},
+								 m_demuxWake, m_decodeWake))
 				{
-					// Mark that we've reached EOF
-					m_endOfFile = true;
-					logMessage("End of file reached", false);
+					ended = true;
 				}
-
-				// Sleep a bit to avoid spinning if we've reached EOF
-				std::this_thread::sleep_for(std::chrono::milliseconds(100));
 				continue;
 			}
 
-			// Process the read frame
-			if (!decodePacket())
+			if (pushWhenFree(*m_packetRing, PacketItem{packet, StageEvent::DATA, generation}, m_demuxWake, m_decodeWake))
 			{
-				continue;
+				packet = nullptr;
 			}
 		}
 	}
 
-	bool FileSourceNode::readNextFrame()
+	bool FileSourceNode::readNextPacket(AVPacket *packet)
 	{
-		if (!m_formatContext || !m_packet)
+		while (true)
 		{
-			return false;
-		}
-
-		// Free the previous packet
-		av_packet_unref(m_packet);
+			av_packet_unref(packet);
 
-		// Read a packet
-		int ret = av_read_frame(m_formatContext, m_packet);
-		if (ret < 0)
-		{
-			if (ret == AVERROR_EOF)
+			int ret = av_read_frame(m_formatContext, packet);
+			if (ret < 0)
 			{
-				return false; // End of file
+				if (ret != AVERROR_EOF)
+				{
+					char errbuf[AV_ERROR_MAX_STRING_SIZE];
+					av_strerror(ret, errbuf, sizeof(errbuf));
+					logMessage("Error reading frame: " + std::string(errbuf), true);
+				}
+				av_packet_unref(packet);
+				return false;
 			}
 
-			char errbuf[AV_ERROR_MAX_STRING_SIZE];
-			av_strerror(ret, errbuf, sizeof(errbuf));
-			logMessage("Error reading frame: " + std::string(errbuf), true);
-			return false;
-		}
-
-		// Check if packet is from audio stream
-		if (m_packet->stream_index != m_audioStreamIndex)
-		{
 			// Skip non-audio packets
-			return readNextFrame();
+			if (packet->stream_index == m_audioStreamIndex)
+			{
+				return true;
+			}
 		}
-
-		return true;
 	}
 
-	bool FileSourceNode::decodePacket()
+	void FileSourceNode::decodeThreadFunc()
 	{
-		if (!m_codecContext || !m_packet || !m_decodedFrame)
+		while (!m_stopThread)
 		{
-			return false;
+			PacketItem item;
+			m_decodeWake.waitUntil([this, &item]
+								   { return m_stopThread || m_packetRing->tryPop(item); });
+			if (m_stopThread)
+			{
+				break;
+			}
+			m_demuxWake.notify(); // Room in the packet ring
+
+			switch (item.event)
+			{
+			case StageEvent::DATA:
+				// Packets read before a later seek are skipped
+				if (item.generation == m_seekGeneration.load(std::memory_order_acquire))
+				{
+					decodePacket(item.data, item.generation);
+				}
+				av_packet_unref(item.data);
+				m_freePackets->tryPush(item.data); // Sized for the whole pool
+				m_demuxWake.notify();
+				break;
+
+			case StageEvent::END_OF_FILE:
+				if (item.generation == m_seekGeneration.load(std::memory_order_acquire))
+				{
+					// An empty packet collects the frames the decoder still holds
+					decodePacket(nullptr, item.generation);
+				}
+				// Back out of draining mode so a later seek can decode again
+				avcodec_flush_buffers(m_codecContext);
+				pushWhenFree(*m_frameRing, FrameItem{nullptr, StageEvent::END_OF_FILE, item.generation},
+							 m_decodeWake, m_convertWake);
+				break;
+
+			case StageEvent::SEEK:
+				avcodec_flush_buffers(m_codecContext);
+				pushWhenFree(*m_frameRing, FrameItem{nullptr, StageEvent::SEEK, item.generation,
+													 item.seekSerial, item.seekPosition},
+							 m_decodeWake, m_convertWake);
+				break;
+			}
 		}
+	}
 
+	bool FileSourceNode::decodePacket(const AVPacket *packet, uint64_t generation)
+	{
 		// Send packet to decoder
-		int ret = avcodec_send_packet(m_codecContext, m_packet);
+		int ret = avcodec_send_packet(m_codecContext, packet);
 		if (ret < 0)
 		{
 			char errbuf[AV_ERROR_MAX_STRING_SIZE];
@@ -547,136 +947,345 @@ namespace AudioEngine
 
 		// Receive frames from decoder
 		bool success = false;
-		while (ret >= 0)
+		while (!m_stopThread)
 		{
-			// Reset the frame
-			av_frame_unref(m_decodedFrame);
-
-			ret = avcodec_receive_frame(m_codecContext, m_decodedFrame);
-			if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+			AVFrame *frame = m_spareFrame;
+			m_spareFrame = nullptr;
+			if (!frame)
 			{
-				break;
+				// Every pooled frame may be queued: the converter is behind
+				m_decodeWake.waitUntil([this, &frame]
+									   { return m_stopThread || m_freeFrames->tryPop(frame); });
+				if (!frame)
+				{
+					break;
+				}
 			}
-			else if (ret < 0)
+
+			ret = avcodec_receive_frame(m_codecContext, frame);
+			if (ret < 0)
 			{
-				char errbuf[AV_ERROR_MAX_STRING_SIZE];
-				av_strerror(ret, errbuf, sizeof(errbuf));
-				logMessage("Error receiving frame from decoder: " + std::string(errbuf), true);
+				if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+				{
+					char errbuf[AV_ERROR_MAX_STRING_SIZE];
+					av_strerror(ret, errbuf, sizeof(errbuf));
+					logMessage("Error receiving frame from decoder: " + std::string(errbuf), true);
+				}
+				// Nothing was received; keep the frame for the next packet
+				m_spareFrame = frame;
 				break;
 			}
 
 			// Update current position
-			if (m_decodedFrame->pts != AV_NOPTS_VALUE)
+			if (frame->pts != AV_NOPTS_VALUE)
 			{
-				m_currentPosition = m_decodedFrame->pts * av_q2d(m_timeBase);
+				m_currentPosition = frame->pts * av_q2d(m_timeBase);
 			}
 
-			// Resample the frame
-			if (resampleFrame())
+			if (!pushWhenFree(*m_frameRing, FrameItem{frame, StageEvent::DATA, generation}, m_decodeWake, m_convertWake))
 			{
-				auto buffer = createBufferFromFrame();
-				if (buffer)
-				{
-					// Add buffer to the queue
-					std::lock_guard<std::mutex> lock(m_queueMutex);
-					m_outputQueue.push(buffer);
-					m_queueCondVar.notify_one();
-					success = true;
-				}
+				break;
 			}
+			success = true;
 		}
 
 		return success;
 	}
 
-	bool FileSourceNode::resampleFrame()
+	void FileSourceNode::convertThreadFunc()
 	{
-		if (!m_swrContext || !m_decodedFrame || !m_convertedFrame)
+		while (!m_stopThread)
 		{
-			return false;
+			FrameItem item;
+			m_convertWake.waitUntil([this, &item]
+									{ return m_stopThread || m_frameRing->tryPop(item); });
+			if (m_stopThread)
+			{
+				break;
+			}
+			m_decodeWake.notify(); // Room in the frame ring
+
+			const bool current = item.generation == m_seekGeneration.load(std::memory_order_acquire);
+			switch (item.event)
+			{
+			case StageEvent::DATA:
+				if (current)
+				{
+					// Wrap or resample the frame
+					convertFrame(item.data);
+				}
+				av_frame_unref(item.data);
+				m_freeFrames->tryPush(item.data); // Sized for the whole pool
+				m_decodeWake.notify();
+				break;
+
+			case StageEvent::END_OF_FILE:
+				if (current && !m_endOfFile)
+				{
+					// Queue what the resampler still holds, then mark EOF
+					drainResampler();
+					m_converter.flush();
+					m_endOfFile = true;
+					m_outputWake.notify();
+					logMessage("End of file reached", false);
+				}
+				break;
+
+			case StageEvent::SEEK:
+				// Only the latest of several quick seeks needs to settle
+				if (current)
+				{
+					finishSeek(item.seekPosition, item.seekSerial);
+				}
+				break;
+			}
 		}
+	}
 
-		// Allocate frame data if needed
-		int ret = av_frame_get_buffer(m_convertedFrame, 0);
-		if (ret < 0)
+	bool FileSourceNode::enqueueBuffer(const std::shared_ptr<AudioBuffer> &buffer)
+	{
+		// A packet can decode to several frames; wait for room rather than drop
+		m_convertWake.waitUntil([this]
+								{ return m_stopThread || !m_outputQueue->isFull(); });
+		if (m_stopThread)
 		{
-			char errbuf[AV_ERROR_MAX_STRING_SIZE];
-			av_strerror(ret, errbuf, sizeof(errbuf));
-			logMessage("Error allocating frame data: " + std::string(errbuf), true);
 			return false;
 		}
+		m_outputQueue->push(buffer);
+		m_outputWake.notify();
+		return true;
+	}
 
-		// Make sure the frame data is writable
-		ret = av_frame_make_writable(m_convertedFrame);
-		if (ret < 0)
+	void FileSourceNode::queueBuffer(const std::shared_ptr<AudioBuffer> &buffer)
+	{
+		// Offline, every block but the last holds exactly m_bufferSize frames
+		if (m_offline)
 		{
-			char errbuf[AV_ERROR_MAX_STRING_SIZE];
-			av_strerror(ret, errbuf, sizeof(errbuf));
-			logMessage("Error making frame writable: " + std::string(errbuf), true);
-			return false;
+			m_converter.append(*buffer);
+			return;
 		}
+		enqueueBuffer(buffer);
+	}
 
-		// Convert
-		ret = swr_convert(m_swrContext,
-						  m_convertedFrame->data, m_convertedFrame->nb_samples,
-						  const_cast<const uint8_t **>(m_decodedFrame->data), m_decodedFrame->nb_samples);
-		if (ret < 0)
+	void FileSourceNode::drainResampler()
+	{
+		if (m_passthrough || !m_swrContext)
+		{
+			return;
+		}
+
+		// A null input hands out the samples still inside the resampler's filter
+		resample(nullptr, 0);
+	}
+
+	void FileSourceNode::resample(const uint8_t *const *input, int inputSamples)
+	{
+		const int64_t produced = m_converter.convert(m_swrContext, input, inputSamples);
+		if (produced < 0 && produced != AVERROR_EXIT)
 		{
 			char errbuf[AV_ERROR_MAX_STRING_SIZE];
-			av_strerror(ret, errbuf, sizeof(errbuf));
+			av_strerror(static_cast<int>(produced), errbuf, sizeof(errbuf));
 			logMessage("Error resampling audio: " + std::string(errbuf), true);
+		}
+	}
+
+	void FileSourceNode::convertFrame(AVFrame *frame)
+	{
+		if (!frame)
+		{
+			return;
+		}
+
+		// Seeks land on the packet before the target; cut the first frame at the exact sample
+		int skip = 0;
+		if (m_trimPending)
+		{
+			if (frame->pts == AV_NOPTS_VALUE || frame->sample_rate <= 0)
+			{
+				m_trimPending = false;
+			}
+			else
+			{
+				const int64_t first = std::llround(frame->pts * av_q2d(m_timeBase) * frame->sample_rate);
+				const int64_t target = std::llround(m_trimPosition * frame->sample_rate);
+				if (target >= first + frame->nb_samples)
+				{
+					// Entirely before the target
+					return;
+				}
+				skip = static_cast<int>(std::max<int64_t>(0, target - first));
+				m_trimPending = false;
+			}
+		}
+
+		if (m_passthrough)
+		{
+			// Takes over the decoder's reference; no samples are copied
+			auto buffer = AudioBuffer::wrapAVFrame(frame);
+			if (!buffer)
+			{
+				logMessage("Failed to wrap decoded frame", true);
+				return;
+			}
+			queueBuffer(skip > 0 ? AudioBuffer::createView(buffer, skip, buffer->getNumSamples() - skip) : buffer);
+			return;
+		}
+
+		if (skip > 0)
+		{
+			const AVSampleFormat format = static_cast<AVSampleFormat>(frame->format);
+			const int bytes = av_get_bytes_per_sample(format);
+			const int stride = av_sample_fmt_is_planar(format) ? bytes : bytes * frame->ch_layout.nb_channels;
+			for (size_t i = 0; i < m_trimPlanes.size(); i++)
+			{
+				m_trimPlanes[i] = frame->extended_data[i] + static_cast<size_t>(skip) * stride;
+			}
+			resample(m_trimPlanes.data(), frame->nb_samples - skip);
+			return;
+		}
+
+		resample(frame->extended_data, frame->nb_samples);
+	}
+
+	bool FileSourceNode::seekTo(double position)
+	{
+		if (!m_running || (!m_formatContext && !m_mappedFile))
+		{
 			return false;
 		}
 
-		// Set properties
-		m_convertedFrame->pts = m_decodedFrame->pts;
-		m_convertedFrame->best_effort_timestamp = m_decodedFrame->best_effort_timestamp;
-		m_convertedFrame->pkt_pos = m_decodedFrame->pkt_pos;
-		m_convertedFrame->pkt_duration = m_decodedFrame->pkt_duration;
-		m_convertedFrame->time_base = m_decodedFrame->time_base;
+		// A cached cue plays from memory at once; the reader only has to catch up behind it
+		std::shared_ptr<const CueCache> cache = findCue(position);
+		double target = position;
+		if (cache)
+		{
+			target = (std::llround(position * m_sampleRate) + cache->frames) / m_sampleRate;
+		}
+
+		// The format context and the mapped read position belong to the demux thread
+		m_seekTarget.store(target, std::memory_order_relaxed);
+		const uint64_t serial = m_seekSerial.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+		// Replaces a hit that process() hasn't picked up yet; a miss cancels it
+		CuePlayback *playback = cache ? new CuePlayback{cache, serial} : nullptr;
+		delete m_pendingCue.exchange(playback, std::memory_order_acq_rel);
+		(cache ? m_cueHits : m_cueMisses).fetch_add(1, std::memory_order_relaxed);
 
+		m_seekRequested.store(true, std::memory_order_release);
+		m_demuxWake.notify();
 		return true;
 	}
 
-	std::shared_ptr<AudioBuffer> FileSourceNode::createBufferFromFrame()
+	bool FileSourceNode::takeSeekRequest(double &position, uint64_t &serial)
 	{
-		if (!m_convertedFrame)
+		if (!m_seekRequested.exchange(false, std::memory_order_acq_rel))
 		{
-			return nullptr;
+			return false;
 		}
 
-		// Create a new buffer
-		auto buffer = std::make_shared<AudioBuffer>(m_convertedFrame->nb_samples, m_sampleRate,
-													m_format, m_channelLayout);
+		// seekTo() stores the target before the serial, so the target is at least this new
+		serial = m_seekSerial.load(std::memory_order_acquire);
+		position = m_seekTarget.load(std::memory_order_relaxed);
 
-		if (!buffer->isValid())
+		// A request racing the previous one may raise the flag again for a seek already done
+		if (serial == m_lastSeekSerial)
 		{
-			logMessage("Failed to create valid buffer", true);
-			return nullptr;
+			return false;
 		}
+		m_lastSeekSerial = serial;
+		return true;
+	}
 
-		// Copy data from frame to buffer
-		for (int i = 0; i < buffer->getPlaneCount() && i < AV_NUM_DATA_POINTERS; i++)
+	std::shared_ptr<AudioBuffer> FileSourceNode::readMappedBlock(int64_t position, long frames, std::vector<float *> &planes)
+	{
+		const MappedPcmFile &file = *m_mappedFile;
+
+		// Faulted in here, not on the audio thread
+		file.touch(position, frames);
+
+		if (m_mappedZeroCopy)
 		{
-			if (m_convertedFrame->data[i] && buffer->getPlaneData(i))
-			{
-				int linesize = buffer->isPlanar() ? buffer->getBytesPerSample() : buffer->getBytesPerSample() * buffer->getChannelCount();
+			const uint8_t *data = file.frameData(position);
+			return AudioBuffer::wrapExternal(frames, m_sampleRate, m_format, m_channelLayout, &data, m_mappedFile);
+		}
 
-				int size = m_convertedFrame->nb_samples * linesize;
-				memcpy(buffer->getPlaneData(i), m_convertedFrame->data[i], size);
+		auto buffer = AudioBufferPool::shared().acquire(frames, m_sampleRate, m_format, m_channelLayout);
+		if (buffer)
+		{
+			for (size_t c = 0; c < planes.size(); c++)
+			{
+				planes[c] = reinterpret_cast<float *>(buffer->getPlaneData(static_cast<int>(c)));
 			}
+			file.readPlanar(position, frames, planes.data());
+			buffer->publish();
 		}
-
 		return buffer;
 	}
 
-	bool FileSourceNode::seekTo(double position)
+	void FileSourceNode::mappedReaderThreadFunc()
 	{
-		if (!m_running || !m_formatContext)
+		const MappedPcmFile &file = *m_mappedFile;
+		const int64_t total = file.getFrameCount();
+		const int64_t readAhead = static_cast<int64_t>(MAPPED_READAHEAD_SECONDS * m_sampleRate);
+		std::vector<float *> planes(static_cast<size_t>(m_channelLayout.nb_channels));
+		bool ended = false;
+
+		while (!m_stopThread)
 		{
-			return false;
+			double target = 0.0;
+			uint64_t serial = 0;
+			if (takeSeekRequest(target, serial))
+			{
+				// Sample-accurate and O(1): the read position is all the state there is
+				m_mappedPosition = std::min(total, std::max<int64_t>(0, std::llround(target * m_sampleRate)));
+				m_prefetchedUntil = m_mappedPosition;
+				finishSeek(target, serial);
+				ended = false;
+				continue;
+			}
+
+			if (ended)
+			{
+				// Nothing left to read until a seek
+				m_demuxWake.waitUntil([this]
+									  { return m_stopThread || m_seekRequested.load(std::memory_order_acquire); });
+				continue;
+			}
+
+			const long frames = static_cast<long>(std::min<int64_t>(m_bufferSize, total - m_mappedPosition));
+			if (frames <= 0)
+			{
+				m_endOfFile = true;
+				m_outputWake.notify();
+				ended = true;
+				logMessage("End of file reached", false);
+				continue;
+			}
+
+			// Keep the OS reading ahead of the play position
+			if (m_mappedPosition + frames > m_prefetchedUntil)
+			{
+				file.prefetch(m_mappedPosition, readAhead);
+				m_prefetchedUntil = m_mappedPosition + readAhead;
+			}
+
+			std::shared_ptr<AudioBuffer> buffer = readMappedBlock(m_mappedPosition, frames, planes);
+			if (!buffer)
+			{
+				logMessage("Failed to create buffer for mapped audio", true);
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+
+			// Blocks are already engine-sized, so offline needs no re-blocking
+			enqueueBuffer(buffer);
+			m_mappedPosition += frames;
+			m_currentPosition = m_mappedPosition / m_sampleRate;
 		}
+	}
 
+	bool FileSourceNode::performSeek(double position, uint64_t serial)
+	{
 		// Calculate timestamp in stream timebase
 		int64_t timestamp = static_cast<int64_t>(position / av_q2d(m_timeBase));
 
@@ -692,27 +1301,384 @@ namespace AudioEngine
 			return false;
 		}
 
-		// Flush codec buffers
-		avcodec_flush_buffers(m_codecContext);
+		// Everything in flight is stale from here; the marker resets the later stages
+		const uint64_t generation = m_seekGeneration.load(std::memory_order_relaxed) + 1;
+		m_seekGeneration.store(generation, std::memory_order_release);
+		pushWhenFree(*m_packetRing, PacketItem{nullptr, StageEvent::SEEK, generation, serial, position},
+					 m_demuxWake, m_decodeWake);
+		return true;
+	}
 
-		// Clear the output queue
+	void FileSourceNode::finishSeek(double position, uint64_t serial)
+	{
+		// The decoder was flushed by the marker; drop the resampler history and the partial block
+		if (m_swrContext)
 		{
-			std::lock_guard<std::mutex> lock(m_queueMutex);
-			while (!m_outputQueue.empty())
-			{
-				m_outputQueue.pop();
-			}
+			swr_init(m_swrContext);
 		}
+		m_converter.reset();
+
+		// Decoding resumes at the packet before the target
+		m_trimPending = !m_mappedFile;
+		m_trimPosition = position;
+
+		// Cleared before the flush so process() doesn't take the old EOF for the new position's
+		m_endOfFile = false;
+
+		// Only the consumer may empty the ring; wait until process() has done so
+		m_flushRequest.store(serial, std::memory_order_release);
+		m_outputWake.notify();
+		m_convertWake.waitUntil([this, serial]
+								{ return m_stopThread || m_flushDone.load(std::memory_order_acquire) == serial; });
 
 		// Update position
 		m_currentPosition = position;
-		m_endOfFile = false;
 
 		logMessage("Seeked to position: " + std::to_string(position) + "s", false);
+	}
 
+	bool FileSourceNode::addCue(double position)
+	{
+		// Needs the engine rate and an open file
+		if (m_sampleRate <= 0 || (!m_formatContext && !m_mappedFile) || position < 0.0 ||
+			(m_duration > 0.0 && position >= m_duration))
+		{
+			return false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_cueMutex);
+			m_cues.emplace(std::llround(position * m_sampleRate), Cue{});
+		}
+		m_cueCondition.notify_all();
 		return true;
 	}
 
+	bool FileSourceNode::removeCue(double position)
+	{
+		std::lock_guard<std::mutex> lock(m_cueMutex);
+		auto it = m_cues.find(std::llround(position * m_sampleRate));
+		if (it == m_cues.end())
+		{
+			return false;
+		}
+
+		// A playback still holding the cache keeps it alive until it retires
+		if (it->second.cache)
+		{
+			m_cueCacheBytes -= it->second.cache->bytes;
+		}
+		m_cues.erase(it);
+		return true;
+	}
+
+	void FileSourceNode::clearCues()
+	{
+		std::lock_guard<std::mutex> lock(m_cueMutex);
+		m_cues.clear();
+		m_cueCacheBytes = 0;
+	}
+
+	FileSourceNode::CueStats FileSourceNode::getCueStats() const
+	{
+		CueStats stats;
+		{
+			std::lock_guard<std::mutex> lock(m_cueMutex);
+			stats.cues = m_cues.size();
+			for (const auto &entry : m_cues)
+			{
+				stats.cached += entry.second.cache ? 1 : 0;
+			}
+			stats.bytes = m_cueCacheBytes;
+			stats.limit = m_cueCacheLimit;
+		}
+		stats.hits = m_cueHits.load(std::memory_order_relaxed);
+		stats.misses = m_cueMisses.load(std::memory_order_relaxed);
+		stats.evictions = m_cueEvictions.load(std::memory_order_relaxed);
+		stats.underruns = m_cueUnderruns.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	std::shared_ptr<const FileSourceNode::CueCache> FileSourceNode::findCue(double position)
+	{
+		std::lock_guard<std::mutex> lock(m_cueMutex);
+		auto it = m_cues.find(std::llround(position * m_sampleRate));
+		if (it == m_cues.end() || !it->second.cache)
+		{
+			return nullptr;
+		}
+		it->second.lastUsed = ++m_cueClock;
+		return it->second.cache;
+	}
+
+	void FileSourceNode::evictCues(int64_t keep)
+	{
+		// Least recently added or hit first; called with m_cueMutex held
+		while (m_cueCacheBytes > m_cueCacheLimit)
+		{
+			auto victim = m_cues.end();
+			for (auto it = m_cues.begin(); it != m_cues.end(); ++it)
+			{
+				if (it->first != keep && it->second.cache &&
+					(victim == m_cues.end() || it->second.lastUsed < victim->second.lastUsed))
+				{
+					victim = it;
+				}
+			}
+			if (victim == m_cues.end())
+			{
+				return;
+			}
+
+			// Stays registered; a seek to it is an ordinary seek from now on
+			m_cueCacheBytes -= victim->second.cache->bytes;
+			victim->second.cache.reset();
+			m_cueEvictions.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	void FileSourceNode::cueThreadFunc()
+	{
+		std::unique_lock<std::mutex> lock(m_cueMutex);
+		while (!m_stopThread)
+		{
+			// Free playbacks the audio thread is done with
+			lock.unlock();
+			CuePlayback *retired = nullptr;
+			while (m_retiredCues.tryPop(retired))
+			{
+				delete retired;
+			}
+			lock.lock();
+
+			auto next = std::find_if(m_cues.begin(), m_cues.end(),
+									 [](const std::pair<const int64_t, Cue> &entry)
+									 { return !entry.second.loaded; });
+			if (next == m_cues.end())
+			{
+				m_cueCondition.wait_for(lock, std::chrono::milliseconds(CUE_THREAD_POLL_MS));
+				continue;
+			}
+			const int64_t start = next->first;
+			next->second.loaded = true;
+
+			// Loading reads the file on its own; the pipeline keeps playing meanwhile
+			lock.unlock();
+			std::shared_ptr<const CueCache> cache = m_mappedFile ? readMappedCue(start) : decodeCue(start);
+			lock.lock();
+
+			// The cue may have been removed (or removed and added again) while it loaded
+			auto it = m_cues.find(start);
+			if (!cache || it == m_cues.end() || !it->second.loaded || it->second.cache)
+			{
+				continue;
+			}
+			if (cache->bytes > m_cueCacheLimit)
+			{
+				logMessage("Cue at " + std::to_string(start / m_sampleRate) + "s is larger than the cue cache", true);
+				continue;
+			}
+
+			it->second.cache = std::move(cache);
+			it->second.lastUsed = ++m_cueClock;
+			m_cueCacheBytes += it->second.cache->bytes;
+			evictCues(start);
+		}
+	}
+
+	std::shared_ptr<const FileSourceNode::CueCache> FileSourceNode::readMappedCue(int64_t start)
+	{
+		auto cache = std::make_shared<CueCache>();
+		std::vector<float *> planes(static_cast<size_t>(m_channelLayout.nb_channels));
+		const int64_t end = std::min(m_mappedFile->getFrameCount(), start + m_cueFrames);
+
+		for (int64_t position = start; position < end && !m_stopThread; position += m_bufferSize)
+		{
+			const long frames = static_cast<long>(std::min<int64_t>(m_bufferSize, end - position));
+			auto block = readMappedBlock(position, frames, planes);
+			if (!block)
+			{
+				logMessage("Failed to create buffer for cue", true);
+				return nullptr;
+			}
+			cache->blocks.push_back(std::move(block));
+			cache->frames += frames;
+		}
+
+		cache->bytes = static_cast<size_t>(cache->frames) * m_channelLayout.nb_channels * av_get_bytes_per_sample(m_format);
+		return cache;
+	}
+
+	namespace
+	{
+		// FFmpeg objects of one cue load, freed however the load ends
+		struct CueDecoder
+		{
+			AVFormatContext *format = nullptr;
+			AVCodecContext *codec = nullptr;
+			SwrContext *swr = nullptr;
+			AVPacket *packet = nullptr;
+			AVFrame *frame = nullptr;
+
+			~CueDecoder()
+			{
+				av_frame_free(&frame);
+				av_packet_free(&packet);
+				swr_free(&swr);
+				avcodec_free_context(&codec);
+				avformat_close_input(&format);
+			}
+		};
+	}
+
+	std::shared_ptr<const FileSourceNode::CueCache> FileSourceNode::decodeCue(int64_t start)
+	{
+		// A decoder of its own, so loading never disturbs the pipeline's position
+		CueDecoder decoder;
+		if (avformat_open_input(&decoder.format, m_filePath.c_str(), nullptr, nullptr) < 0 ||
+			avformat_find_stream_info(decoder.format, nullptr) < 0 ||
+			m_audioStreamIndex >= static_cast<int>(decoder.format->nb_streams))
+		{
+			logMessage("Failed to open file for cue", true);
+			return nullptr;
+		}
+
+		AVStream *stream = decoder.format->streams[m_audioStreamIndex];
+		const AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+		decoder.codec = codec ? avcodec_alloc_context3(codec) : nullptr;
+		if (!decoder.codec ||
+			avcodec_parameters_to_context(decoder.codec, stream->codecpar) < 0 ||
+			avcodec_open2(decoder.codec, codec, nullptr) < 0)
+		{
+			logMessage("Failed to open decoder for cue", true);
+			return nullptr;
+		}
+
+		// Same conversion as the pipeline's, collecting the blocks into the cache
+		auto cache = std::make_shared<CueCache>();
+		BlockConverter converter;
+		converter.configure(m_sampleRate, m_bufferSize, m_format, m_channelLayout,
+							[&cache](const std::shared_ptr<AudioBuffer> &block)
+							{
+								cache->blocks.push_back(block);
+								cache->frames += block->getFrameCount();
+								return true;
+							});
+
+		std::string error;
+		decoder.swr = converter.createResampler(decoder.codec, error);
+		if (!decoder.swr)
+		{
+			logMessage("Failed to initialize resampler for cue: " + error, true);
+			return nullptr;
+		}
+
+		decoder.packet = av_packet_alloc();
+		decoder.frame = av_frame_alloc();
+		if (!decoder.packet || !decoder.frame)
+		{
+			logMessage("Failed to allocate packet or frame for cue", true);
+			return nullptr;
+		}
+
+		// Same seek as the pipeline's; the first frame is then trimmed to the cue
+		const double position = start / m_sampleRate;
+		if (start > 0 && av_seek_frame(decoder.format, m_audioStreamIndex,
+									   static_cast<int64_t>(position / av_q2d(stream->time_base)),
+									   AVSEEK_FLAG_BACKWARD) < 0)
+		{
+			logMessage("Error seeking to cue at " + std::to_string(position) + "s", true);
+			return nullptr;
+		}
+
+		std::vector<const uint8_t *> inPlanes(av_sample_fmt_is_planar(decoder.codec->sample_fmt)
+												  ? decoder.codec->ch_layout.nb_channels
+												  : 1);
+		int64_t produced = 0;
+
+		// Converts until the cue is full; the rest stays in the resampler
+		auto convert = [&](const uint8_t *const *input, int samples) -> bool
+		{
+			const int64_t ret = converter.convert(decoder.swr, input, samples, m_cueFrames - produced);
+			if (ret < 0)
+			{
+				return false;
+			}
+			produced += ret;
+			return true;
+		};
+
+		bool trimming = true;
+		bool ended = false;
+		bool failed = false;
+		while (!ended && !failed && !m_stopThread && produced < m_cueFrames)
+		{
+			int ret = av_read_frame(decoder.format, decoder.packet);
+			if (ret >= 0 && decoder.packet->stream_index != m_audioStreamIndex)
+			{
+				av_packet_unref(decoder.packet);
+				continue;
+			}
+			ended = ret < 0;
+			avcodec_send_packet(decoder.codec, ended ? nullptr : decoder.packet);
+			av_packet_unref(decoder.packet);
+
+			while (!failed && avcodec_receive_frame(decoder.codec, decoder.frame) >= 0)
+			{
+				AVFrame *frame = decoder.frame;
+				int skip = 0;
+				if (trimming && frame->pts != AV_NOPTS_VALUE)
+				{
+					const int64_t first = std::llround(frame->pts * av_q2d(stream->time_base) * frame->sample_rate);
+					const int64_t target = std::llround(position * frame->sample_rate);
+					skip = static_cast<int>(std::min<int64_t>(frame->nb_samples, std::max<int64_t>(0, target - first)));
+				}
+				if (skip < frame->nb_samples)
+				{
+					trimming = false;
+					const int bytes = av_get_bytes_per_sample(static_cast<AVSampleFormat>(frame->format));
+					const int stride = inPlanes.size() > 1 ? bytes : bytes * frame->ch_layout.nb_channels;
+					for (size_t i = 0; i < inPlanes.size(); i++)
+					{
+						inPlanes[i] = frame->extended_data[i] + static_cast<size_t>(skip) * stride;
+					}
+					failed = !convert(inPlanes.data(), frame->nb_samples - skip);
+				}
+				av_frame_unref(frame);
+			}
+		}
+
+		// The file ended inside the cue: collect what the resampler still holds
+		if (ended && !failed)
+		{
+			failed = !convert(nullptr, 0);
+		}
+		if (failed)
+		{
+			logMessage("Failed to decode cue at " + std::to_string(position) + "s", true);
+			return nullptr;
+		}
+		converter.flush();
+
+		cache->bytes = static_cast<size_t>(cache->frames) * m_channelLayout.nb_channels * av_get_bytes_per_sample(m_format);
+		return cache;
+	}
+
+	void FileSourceNode::releaseCues()
+	{
+		// Only called while neither the audio thread nor the cue thread runs
+		delete m_pendingCue.exchange(nullptr, std::memory_order_acq_rel);
+
+		CuePlayback *retired = nullptr;
+		while (m_retiredCues.tryPop(retired))
+		{
+			delete retired;
+		}
+
+		delete m_activeCue;
+		m_activeCue = nullptr;
+	}
+
 	double FileSourceNode::getCurrentPosition() const
 	{
 		return m_currentPosition;
@@ -723,4 +1689,29 @@ namespace AudioEngine
 		return m_duration;
 	}
 
+	void FileSourceNode::setOfflineMode(bool offline)
+	{
+		if (m_running)
+		{
+			logMessage("Cannot change rendering mode while running", true);
+			return;
+		}
+		m_offline = offline;
+	}
+
+	bool FileSourceNode::isDrained() const
+	{
+		return m_endOfFile.load(std::memory_order_acquire) && !m_outputBuffer &&
+			   (!m_outputQueue || m_outputQueue->depth() == 0);
+	}
+
+	AudioBufferQueue::Stats FileSourceNode::getQueueStats() const
+	{
+		if (!m_outputQueue)
+		{
+			return AudioBufferQueue::Stats{};
+		}
+		return m_outputQueue->getStats();
+	}
+
 } // namespace AudioEngine
@@ -1,12 +1,18 @@
 #pragma once
 
 #include "AudioNode.h"
+#include "AudioBufferQueue.h"
+#include "BlockConverter.h"
+#include "SpscRing.h"
+#include "WakeEvent.h"
 #include <string>
-#include <mutex>
 #include <thread>
-#include <queue>
-#include <condition_variable>
+#include <vector>
 #include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
 
 extern "C"
 {
@@ -18,8 +24,55 @@ extern "C"
 namespace AudioEngine
 {
 
+	class MappedPcmFile; // Forward declaration
+
 	/**
 	 * @brief Node for reading audio from a file
+	 *
+	 * Reading is a three-stage pipeline, one thread per stage, so demuxing,
+	 * decoding and conversion of one file run on separate cores:
+	 * - demux: av_read_frame() into a fixed pool of packets
+	 * - decode: packets to frames, with FFmpeg's own frame/slice threads when
+	 *   the codec supports them
+	 * - convert: frames to engine buffers (wrapped or resampled, re-blocked
+	 *   offline) into the read-ahead queue
+	 *
+	 * Stages hand pooled packets and frames on through bounded SPSC rings and
+	 * return them through a second ring, so the pipeline allocates nothing
+	 * per packet. A full ring makes its producer back off. End of file and
+	 * seeks travel down the rings as markers; work items carry the seek
+	 * generation they were read in, so stages skip stale ones after a seek.
+	 *
+	 * process() takes one buffer per block from the read-ahead queue without
+	 * blocking. Parameters:
+	 * - file_path: File to read (required)
+	 * - queue_size: Decoded buffers to read ahead (default 4, 64 offline)
+	 * - queue_policy: "silence" (default) outputs silence when the reader falls
+	 *   behind, "drop_newest"/"drop_oldest" output nothing
+	 * - decoder_threads: FFmpeg decoder threads (default 0 = one per core,
+	 *   1 = none)
+	 * - mmap: "false" turns off the mapped PCM path below (default on)
+	 *
+	 * Uncompressed WAV, RF64 and Wave64 files at the engine's rate and
+	 * channel count skip FFmpeg altogether: the file is memory-mapped and a
+	 * single reader hands out engine-sized blocks. If the file already holds
+	 * the engine's sample layout (e.g. mono float for planar float), blocks
+	 * are zero-copy views of the mapping; otherwise they are converted to
+	 * planar float in one pass. The reader keeps the OS prefetching ahead of
+	 * the play position and faults each block in before queuing it. Seeks
+	 * are sample-accurate and O(1).
+	 *
+	 * Cue points: addCue() (or the "cues" parameter) registers positions
+	 * that will be seeked to, and a background thread pre-decodes the first
+	 * cue_length_ms of each into memory. seekTo() a cached cue starts
+	 * output from the cache on the next block while the reader seeks to
+	 * where the cache ends and fills the queue behind it; the join is
+	 * gapless because seeks trim the first decoded frame to the exact
+	 * sample. Parameters:
+	 * - cues: Comma-separated cue positions in seconds
+	 * - cue_length_ms: Audio pre-decoded per cue (default 500)
+	 * - cue_cache_mb: Cache limit; the least recently used cues are evicted
+	 *   beyond it (default 64)
 	 */
 	class FileSourceNode : public AudioNode
 	{
@@ -54,14 +107,77 @@ namespace AudioEngine
 		int getInputPadCount() const override { return 0; }	 // No inputs
 		int getOutputPadCount() const override { return 1; } // One output
 
+		/**
+		 * @brief Select offline rendering
+		 *
+		 * Offline, process() waits for the reader instead of underrunning, the
+		 * decoded audio is re-blocked to exactly bufferSize frames per block
+		 * (the last block may be shorter) and the default read-ahead is deeper.
+		 */
+		void setOfflineMode(bool offline) override;
+
+		/**
+		 * @brief Check whether the end of the file has been delivered
+		 */
+		bool isDrained() const override;
+
 		/**
 		 * @brief Seek to a specific position in the file
 		 *
+		 * The demux thread performs the seek; buffers decoded before it are
+		 * discarded on the next process() call once the seek has passed
+		 * through the pipeline. A position with a cached cue plays from the
+		 * cache on the next block instead.
+		 *
 		 * @param position Position in seconds
-		 * @return true if seek was successful
+		 * @return true if the seek was requested
 		 */
 		bool seekTo(double position);
 
+		/**
+		 * @brief Cue cache counters
+		 */
+		struct CueStats
+		{
+			size_t cues = 0;		// Registered cue points
+			size_t cached = 0;		// Cue points held in memory
+			size_t bytes = 0;		// Memory held by the cache
+			size_t limit = 0;		// Cache limit in bytes
+			uint64_t hits = 0;		// Seeks served from the cache
+			uint64_t misses = 0;	// Seeks that waited for the reader
+			uint64_t evictions = 0; // Cues dropped to stay under the limit
+			uint64_t underruns = 0; // Blocks of a hit the reader was too late for
+		};
+
+		/**
+		 * @brief Register a cue point to pre-decode
+		 *
+		 * The cue thread loads it in the background once the node runs; a
+		 * later seekTo() the same position is a cache hit.
+		 *
+		 * @param position Position in seconds
+		 * @return true if the position lies inside the file
+		 */
+		bool addCue(double position);
+
+		/**
+		 * @brief Forget a cue point and free its cached audio
+		 *
+		 * @param position Position passed to addCue()
+		 * @return true if the cue was registered
+		 */
+		bool removeCue(double position);
+
+		/**
+		 * @brief Forget all cue points
+		 */
+		void clearCues();
+
+		/**
+		 * @brief Get the cue cache counters
+		 */
+		CueStats getCueStats() const;
+
 		/**
 		 * @brief Get the current playback position
 		 *
@@ -83,6 +199,15 @@ namespace AudioEngine
 		 */
 		std::string getFilePath() const { return m_filePath; }
 
+		/**
+		 * @brief Get the read-ahead queue counters
+		 *
+		 * Underruns count blocks the reader could not supply in time.
+		 *
+		 * @return Queue statistics
+		 */
+		AudioBufferQueue::Stats getQueueStats() const;
+
 	private:
 		// File information
 		std::string m_filePath;
@@ -95,36 +220,198 @@ namespace AudioEngine
 		int m_audioStreamIndex;
 
 		// Decoder state
-		AVPacket *m_packet;
-		AVFrame *m_decodedFrame;
-		AVFrame *m_convertedFrame;
+		bool m_passthrough;	  // Decoder output already in engine format
+		int m_decoderThreads; // 0 = FFmpeg's choice
 
-		// Reader thread
-		std::thread m_readerThread;
+		// Mapped PCM path (no FFmpeg objects are open when m_mappedFile is set)
+		std::shared_ptr<MappedPcmFile> m_mappedFile;
+		bool m_mmapEnabled;
+		bool m_mappedZeroCopy;	   // Blocks are views of the mapping
+		int64_t m_mappedPosition;  // Next frame to read (reader thread)
+		int64_t m_prefetchedUntil; // End of the range already handed to prefetch()
+
+		/**
+		 * @brief What a pipeline item carries
+		 */
+		enum class StageEvent : uint8_t
+		{
+			DATA,		 // A pooled packet or frame
+			END_OF_FILE, // The demuxer reached the end; drain
+			SEEK		 // The demuxer moved; reset stage state
+		};
+
+		/**
+		 * @brief Item passed from one pipeline stage to the next
+		 */
+		template <typename T>
+		struct StageItem
+		{
+			T *data = nullptr; // Only for DATA
+			StageEvent event = StageEvent::DATA;
+			uint64_t generation = 0; // Seek generation the item belongs to
+			uint64_t seekSerial = 0; // SEEK: seekTo() request being answered
+			double seekPosition = 0.0; // SEEK: target in seconds
+		};
+
+		using PacketItem = StageItem<AVPacket>;
+		using FrameItem = StageItem<AVFrame>;
+
+		// Pooled packets and frames; each is owned by one ring or stage at a time
+		std::vector<AVPacket *> m_packetPool;
+		std::vector<AVFrame *> m_framePool;
+		std::unique_ptr<SpscRing<PacketItem>> m_packetRing; // demux -> decode
+		std::unique_ptr<SpscRing<AVPacket *>> m_freePackets; // decode -> demux
+		std::unique_ptr<SpscRing<FrameItem>> m_frameRing;	 // decode -> convert
+		std::unique_ptr<SpscRing<AVFrame *>> m_freeFrames;	 // convert -> decode
+		AVFrame *m_spareFrame;								 // Taken by the decoder but not filled
+		std::atomic<uint64_t> m_seekGeneration;
+
+		// Each stage sleeps on its own event when its input is empty or its output full
+		WakeEvent m_demuxWake;	 // Free packet, packet ring space or a seek request
+		WakeEvent m_decodeWake;	 // Packet, free frame or frame ring space
+		WakeEvent m_convertWake; // Frame, output queue space or a finished flush
+		WakeEvent m_outputWake;	 // Offline process(): a block, EOF or a flush request
+
+		// Pipeline threads
+		std::thread m_demuxThread;
+		std::thread m_decodeThread;
+		std::thread m_convertThread;
 		std::atomic<bool> m_stopThread;
 
-		// Output buffer queue
-		std::queue<std::shared_ptr<AudioBuffer>> m_outputQueue;
-		std::mutex m_queueMutex;
-		std::condition_variable m_queueCondVar;
+		// Read-ahead queue (reader thread -> process())
+		std::unique_ptr<AudioBufferQueue> m_outputQueue;
+		size_t m_queueSize; // 0 = default for the mode
+		QueuePolicy m_queuePolicy;
+		std::shared_ptr<AudioBuffer> m_outputBuffer;  // Buffer for the current block
+		std::shared_ptr<AudioBuffer> m_silenceBuffer; // Substituted on underrun
+
+		// Seek handoff: the reader seeks, process() drops the stale queue.
+		// Flushes are numbered with the serial of the seekTo() they answer.
+		std::atomic<bool> m_seekRequested;
+		std::atomic<double> m_seekTarget;
+		std::atomic<uint64_t> m_seekSerial; // Bumped by every seekTo()
+		uint64_t m_lastSeekSerial;			// Reader thread
+		std::atomic<uint64_t> m_flushRequest;
+		std::atomic<uint64_t> m_flushDone;
+
+		// First decoded frame after a seek is trimmed to the target (convert thread)
+		bool m_trimPending;
+		double m_trimPosition;
+		std::vector<const uint8_t *> m_trimPlanes;
+
+		/**
+		 * @brief Pre-decoded start of a cue; immutable once published
+		 */
+		struct CueCache
+		{
+			std::vector<std::shared_ptr<AudioBuffer>> blocks; // bufferSize frames each but the last
+			int64_t frames = 0;
+			size_t bytes = 0;
+		};
+
+		/**
+		 * @brief Registered cue point
+		 */
+		struct Cue
+		{
+			std::shared_ptr<const CueCache> cache; // Null until loaded or once evicted
+			uint64_t lastUsed = 0;				   // LRU stamp
+			bool loaded = false;				   // Load attempted
+		};
+
+		/**
+		 * @brief Cache hit handed from seekTo() to process()
+		 */
+		struct CuePlayback
+		{
+			std::shared_ptr<const CueCache> cache;
+			uint64_t seekSerial = 0; // The queue is valid again once this seek is flushed
+			size_t next = 0;		 // Next block to output
+		};
+
+		// Cue points by start frame (guarded by m_cueMutex)
+		std::map<int64_t, Cue> m_cues;
+		mutable std::mutex m_cueMutex;
+		std::condition_variable m_cueCondition;
+		std::thread m_cueThread;
+		uint64_t m_cueClock;
+		size_t m_cueCacheBytes;
+		size_t m_cueCacheLimit;
+		int64_t m_cueFrames; // Pre-decoded per cue
+
+		// Control thread -> audio thread: the newest cache hit
+		std::atomic<CuePlayback *> m_pendingCue;
+
+		// Audio thread -> cue thread: playbacks to delete
+		SpscRing<CuePlayback *> m_retiredCues{RETIRE_QUEUE_SIZE};
+		CuePlayback *m_activeCue; // Audio thread
+
+		std::atomic<uint64_t> m_cueHits;
+		std::atomic<uint64_t> m_cueMisses;
+		std::atomic<uint64_t> m_cueEvictions;
+		std::atomic<uint64_t> m_cueUnderruns;
 
 		// Current position tracking
 		std::atomic<double> m_currentPosition;
 
-		// Maximum buffer queue size
-		const int MAX_QUEUE_SIZE = 4;
+		// Offline rendering: wait for data and emit fixed-size blocks
+		bool m_offline;
+
+		// Convert thread: resampled (and, offline, passed-through) audio into engine-sized blocks
+		BlockConverter m_converter;
+
+		// Default read-ahead depth
+		static constexpr size_t DEFAULT_QUEUE_SIZE = 4;
+		static constexpr size_t OFFLINE_QUEUE_SIZE = 64;
+
+		// Pipeline depth between the stages
+		static constexpr size_t PACKET_POOL_SIZE = 32;
+		static constexpr size_t FRAME_POOL_SIZE = 16;
+
+		// Read-ahead requested from the OS for mapped files
+		static constexpr double MAPPED_READAHEAD_SECONDS = 2.0;
+
+		// Cue cache defaults
+		static constexpr int DEFAULT_CUE_LENGTH_MS = 500;
+		static constexpr size_t DEFAULT_CUE_CACHE_MB = 64;
+		static constexpr size_t RETIRE_QUEUE_SIZE = 8;
+		static constexpr int CUE_THREAD_POLL_MS = 10;
+
+		// Pipeline stages
+		void demuxThreadFunc();
+		void decodeThreadFunc();
+		void convertThreadFunc();
+		void mappedReaderThreadFunc();
+		void cueThreadFunc();
 
 		// Helper methods
-		void readerThreadFunc();
+		bool performSeek(double position, uint64_t serial);
+		void finishSeek(double position, uint64_t serial);
+		bool takeSeekRequest(double &position, uint64_t &serial);
 		bool openFile();
+		bool openMapped();
 		void closeFile();
-		bool readNextFrame();
-		bool decodePacket();
-		bool resampleFrame();
-		std::shared_ptr<AudioBuffer> createBufferFromFrame();
+		bool readNextPacket(AVPacket *packet);
+		bool decodePacket(const AVPacket *packet, uint64_t generation);
+		void drainResampler();
+		void queueBuffer(const std::shared_ptr<AudioBuffer> &buffer);
+		bool enqueueBuffer(const std::shared_ptr<AudioBuffer> &buffer);
+		void resample(const uint8_t *const *input, int inputSamples);
+		void convertFrame(AVFrame *frame);
+		std::shared_ptr<AudioBuffer> readMappedBlock(int64_t position, long frames, std::vector<float *> &planes);
+		std::shared_ptr<const CueCache> readMappedCue(int64_t start);
+		std::shared_ptr<const CueCache> decodeCue(int64_t start);
+		std::shared_ptr<const CueCache> findCue(double position);
+		void evictCues(int64_t keep);
+		bool playCue();
+		void retireCue();
+		void releaseCues();
+		void notifyStages();
+		template <typename T>
+		bool pushWhenFree(SpscRing<T> &ring, const T &item, WakeEvent &producer, WakeEvent &consumer);
 
 		// Tracks when we're at the end of file but still have buffers queued
-		bool m_endOfFile;
+		std::atomic<bool> m_endOfFile;
 
 		// Timing information
 		AVRational m_timeBase;
@@ -0,0 +1,350 @@
+#include "MatrixMixerNode.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace AudioEngine
+{
+
+	MatrixMixerNode::MatrixMixerNode(const std::string &name, AudioEngine *engine, int inputPads)
+		: DspNode(name, engine, inputPads)
+	{
+	}
+
+	float MatrixMixerNode::normalizedToGain(float normalized)
+	{
+		// Same scale as RmeOscCommands: 0..1 covers -65..0 dB; the bottom of the fader mutes
+		if (normalized <= 0.0f)
+		{
+			return 0.0f;
+		}
+		return dbToGain(std::min(normalized, 1.0f) * 65.0 - 65.0);
+	}
+
+	void MatrixMixerNode::buildRows(Matrix &matrix, int inputs, int outputs)
+	{
+		for (int o = 0; o < outputs; o++)
+		{
+			const float *row = matrix.gains.data() + static_cast<size_t>(o) * inputs;
+			uint32_t *active = matrix.active.data() + static_cast<size_t>(o) * inputs;
+			uint32_t count = 0;
+			for (int i = 0; i < inputs; i++)
+			{
+				if (row[i] != 0.0f)
+				{
+					active[count++] = static_cast<uint32_t>(i);
+				}
+			}
+			matrix.counts[o] = count;
+		}
+	}
+
+	bool MatrixMixerNode::configureParameters(const std::map<std::string, std::string> &params)
+	{
+		std::lock_guard<std::mutex> lock(m_writerMutex);
+
+		m_inputCount = getInputPadCount() * m_channels;
+		m_outputCount = m_channels;
+		if (params.count("outputs"))
+		{
+			double outputs = 0.0;
+			if (!parseNumber("outputs", params.at("outputs"), outputs))
+			{
+				return false;
+			}
+			if (outputs < 1 || outputs > 256 || outputs != std::floor(outputs))
+			{
+				reportStatus("Error", "Invalid output count: " + params.at("outputs"));
+				return false;
+			}
+			m_outputCount = static_cast<int>(outputs);
+		}
+
+		if (params.count("osc_prefix"))
+		{
+			m_oscPrefix = params.at("osc_prefix");
+		}
+
+		const size_t size = static_cast<size_t>(m_inputCount) * m_outputCount;
+		m_staging.assign(size, 0.0f);
+
+		auto matrix = params.find("matrix");
+		const std::string initial = matrix != params.end() ? matrix->second : "identity";
+		if (initial == "identity")
+		{
+			for (int c = 0; c < std::min(m_inputCount, m_outputCount); c++)
+			{
+				m_staging[static_cast<size_t>(c) * m_inputCount + c] = 1.0f;
+			}
+		}
+		else if (initial != "empty")
+		{
+			reportStatus("Error", "Unknown initial matrix: " + initial);
+			return false;
+		}
+
+		if (params.count("gains_db") && !applyGainList(params.at("gains_db")))
+		{
+			return false;
+		}
+
+		if (m_outputCount != m_channels)
+		{
+			av_channel_layout_uninit(&m_outputLayout);
+			av_channel_layout_default(&m_outputLayout, m_outputCount);
+		}
+
+		// Nothing reads the buffers yet: start them all from the configured matrix
+		for (Matrix &published : m_matrices)
+		{
+			published.gains = m_staging;
+			published.active.assign(size, 0);
+			published.counts.assign(static_cast<size_t>(m_outputCount), 0);
+			buildRows(published, m_inputCount, m_outputCount);
+		}
+		m_writeIndex = 0;
+		m_sharedIndex.store(1);
+		m_readIndex = 2;
+
+		m_current = m_matrices[m_readIndex];
+		m_inputPlanes.assign(static_cast<size_t>(m_inputCount), nullptr);
+		m_inputAvailable.assign(static_cast<size_t>(m_inputCount), 0);
+		return true;
+	}
+
+	bool MatrixMixerNode::applyGainList(const std::string &list)
+	{
+		// Called with the writer lock held
+		for (const auto &item : splitList(list))
+		{
+			const size_t first = item.find(':');
+			const size_t second = first == std::string::npos ? std::string::npos : item.find(':', first + 1);
+			if (second == std::string::npos)
+			{
+				reportStatus("Error", "Crosspoints are 'in:out:dB': " + item);
+				return false;
+			}
+
+			char *end = nullptr;
+			const long input = std::strtol(item.c_str(), &end, 10);
+			const bool inputValid = end == item.c_str() + first;
+			const long output = std::strtol(item.c_str() + first + 1, &end, 10);
+			const bool outputValid = end == item.c_str() + second;
+			if (!inputValid || !outputValid || input < 1 || input > m_inputCount || output < 1 || output > m_outputCount)
+			{
+				reportStatus("Error", "Invalid crosspoint: " + item);
+				return false;
+			}
+
+			const std::string level = item.substr(second + 1);
+			float gain = 0.0f;
+			if (level != "off" && level != "-inf")
+			{
+				double db = 0.0;
+				if (!parseNumber("gains_db", level, db))
+				{
+					return false;
+				}
+				gain = dbToGain(db);
+			}
+			m_staging[static_cast<size_t>(output - 1) * m_inputCount + (input - 1)] = gain;
+		}
+		return true;
+	}
+
+	void MatrixMixerNode::publishLocked()
+	{
+		Matrix &matrix = m_matrices[m_writeIndex];
+		std::copy(m_staging.begin(), m_staging.end(), matrix.gains.begin());
+		buildRows(matrix, m_inputCount, m_outputCount);
+		m_writeIndex = m_sharedIndex.exchange(m_writeIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	bool MatrixMixerNode::setGain(int input, int output, float gain)
+	{
+		std::lock_guard<std::mutex> lock(m_writerMutex);
+		if (!m_configured || input < 1 || input > m_inputCount || output < 1 || output > m_outputCount)
+		{
+			return false;
+		}
+
+		m_staging[static_cast<size_t>(output - 1) * m_inputCount + (input - 1)] = gain;
+		publishLocked();
+		return true;
+	}
+
+	bool MatrixMixerNode::setParameter(const std::string &param, const std::string &value)
+	{
+		if (param == "gains_db")
+		{
+			std::lock_guard<std::mutex> lock(m_writerMutex);
+			if (!m_configured)
+			{
+				return false;
+			}
+
+			// One publish for the whole list; a bad entry leaves the live matrix alone
+			const std::vector<float> previous = m_staging;
+			if (!applyGainList(value))
+			{
+				m_staging = previous;
+				return false;
+			}
+			publishLocked();
+			return true;
+		}
+
+		reportStatus("Warning", "Unknown parameter: " + param);
+		return false;
+	}
+
+	bool MatrixMixerNode::handleOscMessage(const std::string &address, float value)
+	{
+		if (address.compare(0, m_oscPrefix.size(), m_oscPrefix) != 0 ||
+			address.size() <= m_oscPrefix.size() || address[m_oscPrefix.size()] != '/')
+		{
+			return false;
+		}
+
+		// <prefix>/<in>/<out>
+		const char *text = address.c_str() + m_oscPrefix.size() + 1;
+		char *end = nullptr;
+		const long input = std::strtol(text, &end, 10);
+		if (end == text || *end != '/')
+		{
+			return false;
+		}
+		text = end + 1;
+		const long output = std::strtol(text, &end, 10);
+		if (end == text || *end != '\0')
+		{
+			return false;
+		}
+
+		return setGain(static_cast<int>(input), static_cast<int>(output), normalizedToGain(value));
+	}
+
+	bool MatrixMixerNode::sendControlMessage(const std::string &messageType, const std::map<std::string, std::string> &params)
+	{
+		if (messageType == "osc")
+		{
+			auto address = params.find("address");
+			auto value = params.find("value");
+			double normalized = 0.0;
+			if (address == params.end() || value == params.end() || !parseNumber("value", value->second, normalized))
+			{
+				reportStatus("Error", "osc requires 'address' and a numeric 'value'");
+				return false;
+			}
+			if (!handleOscMessage(address->second, static_cast<float>(normalized)))
+			{
+				reportStatus("Warning", "Unhandled matrix address: " + address->second);
+				return false;
+			}
+			return true;
+		}
+
+		return DspNode::sendControlMessage(messageType, params);
+	}
+
+	void MatrixMixerNode::resetState()
+	{
+		// Jump to the latest published matrix without a ramp
+		if (m_sharedIndex.load(std::memory_order_acquire) & FRESH)
+		{
+			m_readIndex = m_sharedIndex.exchange(m_readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+		}
+		const Matrix &latest = m_matrices[m_readIndex];
+		std::copy(latest.gains.begin(), latest.gains.end(), m_current.gains.begin());
+		std::copy(latest.active.begin(), latest.active.end(), m_current.active.begin());
+		std::copy(latest.counts.begin(), latest.counts.end(), m_current.counts.begin());
+	}
+
+	bool MatrixMixerNode::render(AudioBuffer &output, long frames)
+	{
+		bool changed = false;
+		if (m_sharedIndex.load(std::memory_order_acquire) & FRESH)
+		{
+			m_readIndex = m_sharedIndex.exchange(m_readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+			changed = true;
+		}
+		const Matrix &target = m_matrices[m_readIndex];
+
+		for (int i = 0; i < m_inputCount; i++)
+		{
+			const int pad = i / m_channels;
+			m_inputPlanes[i] = inputChannel(pad, i % m_channels);
+			m_inputAvailable[i] = std::min(frames, inputFrames(pad));
+		}
+
+		const float rampScale = 1.0f / static_cast<float>(frames);
+		for (int o = 0; o < m_outputCount; o++)
+		{
+			float *out = outputChannel(output, o);
+			const size_t rowStart = static_cast<size_t>(o) * m_inputCount;
+			bool written = false;
+
+			auto accumulate = [&](uint32_t input, float gain, float step)
+			{
+				const float *in = m_inputPlanes[input];
+				const long available = m_inputAvailable[input];
+				if (!in || available == 0)
+				{
+					return;
+				}
+				if (!written)
+				{
+					m_kernels.gain(in, out, available, gain, step);
+					std::fill(out + available, out + frames, 0.0f);
+					written = true;
+				}
+				else
+				{
+					m_kernels.mix(in, out, available, gain, step);
+				}
+			};
+
+			if (!changed)
+			{
+				const uint32_t *active = m_current.active.data() + rowStart;
+				for (uint32_t k = 0; k < m_current.counts[o]; k++)
+				{
+					accumulate(active[k], m_current.gains[rowStart + active[k]], 0.0f);
+				}
+			}
+			else
+			{
+				// Ramp every crosspoint that is on in the old or the new matrix
+				const uint32_t *next = target.active.data() + rowStart;
+				for (uint32_t k = 0; k < target.counts[o]; k++)
+				{
+					const float from = m_current.gains[rowStart + next[k]];
+					accumulate(next[k], from, (target.gains[rowStart + next[k]] - from) * rampScale);
+				}
+				const uint32_t *previous = m_current.active.data() + rowStart;
+				for (uint32_t k = 0; k < m_current.counts[o]; k++)
+				{
+					if (target.gains[rowStart + previous[k]] == 0.0f)
+					{
+						const float from = m_current.gains[rowStart + previous[k]];
+						accumulate(previous[k], from, -from * rampScale);
+					}
+				}
+			}
+
+			if (!written)
+			{
+				std::fill(out, out + frames, 0.0f);
+			}
+		}
+
+		if (changed)
+		{
+			std::copy(target.gains.begin(), target.gains.end(), m_current.gains.begin());
+			std::copy(target.active.begin(), target.active.end(), m_current.active.begin());
+			std::copy(target.counts.begin(), target.counts.end(), m_current.counts.begin());
+		}
+		return true;
+	}
+
+} // namespace AudioEngine
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "DspNodes.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief N x M gain matrix in software ("matrix_mixer")
+	 *
+	 * The software counterpart of the TotalMix routing matrix: every output
+	 * channel is the gain-weighted sum of the input channels. Inputs are the
+	 * channels of all input pads in order (pad 0 channels first), so a node
+	 * with two stereo pads has inputs 1-4.
+	 *
+	 * Gains are stored per output row with the row's non-zero crosspoints
+	 * listed next to it, so silent crosspoints cost nothing. Each row is
+	 * computed with the SIMD gain/multiply-accumulate kernels of DspKernels.
+	 *
+	 * Updates are wait-free for the processing thread: writers edit a staging
+	 * matrix under a mutex and publish a copy through a triple buffer; the
+	 * processing thread picks up the latest copy at the start of a block and
+	 * ramps every changed crosspoint over that block.
+	 *
+	 * Params:
+	 * - "input_pads": number of input pads (default 1)
+	 * - "outputs": output channels (default: the input channel count)
+	 * - "matrix": "identity" (default, input n to output n at 0 dB) or "empty"
+	 * - "gains_db": crosspoints "in:out:dB, ..." with 1-based channels; dB may
+	 *   be "off" to mute
+	 * - "osc_prefix": address prefix for OSC updates (default "/matrix/volA")
+	 *
+	 * Control: sendControlMessage("osc", {"address", "value"}) accepts
+	 * TotalMix-shaped addresses "<osc_prefix>/<in>/<out>" with the normalized
+	 * fader value used by RmeOscCommands::setMatrixGain (0..1 for -65..0 dB,
+	 * 0 mutes). "set_parameter" accepts "gains_db" as above.
+	 */
+	class MatrixMixerNode : public DspNode
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * @param inputPads Number of input pads (fixed for the life of the node)
+		 */
+		MatrixMixerNode(const std::string &name, AudioEngine *engine, int inputPads);
+
+		std::string getDspType() const override { return "matrix_mixer"; }
+		bool setParameter(const std::string &param, const std::string &value) override;
+		bool sendControlMessage(const std::string &messageType, const std::map<std::string, std::string> &params) override;
+
+		/**
+		 * @brief Set one crosspoint
+		 *
+		 * Thread-safe; takes effect (ramped) from the next block.
+		 *
+		 * @param input 1-based input channel
+		 * @param output 1-based output channel
+		 * @param gain Linear gain (0 mutes)
+		 * @return true if the channels exist
+		 */
+		bool setGain(int input, int output, float gain);
+
+		/**
+		 * @brief Apply a TotalMix-shaped OSC message
+		 *
+		 * @param address "<osc_prefix>/<in>/<out>"
+		 * @param value Normalized fader value (0..1)
+		 * @return true if the address belongs to this node and was applied
+		 */
+		bool handleOscMessage(const std::string &address, float value);
+
+		/**
+		 * @brief Convert a normalized TotalMix fader value to a linear gain
+		 */
+		static float normalizedToGain(float normalized);
+
+		int getInputChannelCount() const { return m_inputCount; }
+		int getOutputChannelCount() const { return m_outputCount; }
+
+	protected:
+		bool configureParameters(const std::map<std::string, std::string> &params) override;
+		bool render(AudioBuffer &output, long frames) override;
+		void resetState() override;
+
+	private:
+		/**
+		 * @brief One published matrix
+		 */
+		struct Matrix
+		{
+			std::vector<float> gains;	   // outputs x inputs, one row per output
+			std::vector<uint32_t> active; // Per row: the inputs with non-zero gain, packed at the row start
+			std::vector<uint32_t> counts; // Per row: number of active inputs
+		};
+
+		// Triple buffer state: index of the shared matrix plus a fresh flag
+		static constexpr int INDEX_MASK = 3;
+		static constexpr int FRESH = 4;
+
+		int m_inputCount = 0;
+		int m_outputCount = 0;
+		std::string m_oscPrefix = "/matrix/volA";
+
+		std::mutex m_writerMutex;
+		std::vector<float> m_staging; // Writers' copy of the gains
+		Matrix m_matrices[3];
+		int m_writeIndex = 0;				// Owned by writers
+		std::atomic<int> m_sharedIndex{1}; // Handed between writers and the processing thread
+		int m_readIndex = 2;				// Owned by the processing thread
+
+		// Processing thread: gains reached at the end of the last block
+		Matrix m_current;
+		std::vector<const float *> m_inputPlanes;
+		std::vector<long> m_inputAvailable;
+
+		bool applyGainList(const std::string &list);
+		void publishLocked();
+		static void buildRows(Matrix &matrix, int inputs, int outputs);
+	};
+
+} // namespace AudioEngine
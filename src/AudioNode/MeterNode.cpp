@@ -0,0 +1,399 @@
+#include "MeterNode.h"
+#include "OscController.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace AudioEngine
+{
+
+	namespace
+	{
+		constexpr int HISTORY = DspKernels::TRUE_PEAK_TAPS - 1;
+
+		// Reported for silence
+		constexpr float FLOOR_DB = -200.0f;
+	}
+
+	MeterNode::MeterNode(const std::string &name, AudioEngine *engine)
+		: DspNode(name, engine),
+		  m_oscAddress("/meter/" + name)
+	{
+	}
+
+	MeterNode::~MeterNode()
+	{
+		if (m_running)
+		{
+			stop();
+		}
+	}
+
+	bool MeterNode::configureParameters(const std::map<std::string, std::string> &params)
+	{
+		double value = 0.0;
+		auto number = [&](const char *param, double fallback, double minimum, double &out)
+		{
+			out = fallback;
+			if (!params.count(param))
+			{
+				return true;
+			}
+			if (!parseNumber(param, params.at(param), out))
+			{
+				return false;
+			}
+			if (out < minimum)
+			{
+				reportStatus("Error", std::string("'") + param + "' must be at least " + std::to_string(minimum));
+				return false;
+			}
+			return true;
+		};
+
+		if (!number("rate_hz", 30.0, 0.0, m_rateHz))
+		{
+			return false;
+		}
+		if (!number("rms_ms", 300.0, 0.0, value))
+		{
+			return false;
+		}
+		m_rmsMs.store(static_cast<float>(value));
+		if (!number("release_db_per_s", 20.0, 0.0, value))
+		{
+			return false;
+		}
+		m_releaseDbPerSecond.store(static_cast<float>(value));
+		if (!number("peak_hold_ms", 1000.0, 0.0, value))
+		{
+			return false;
+		}
+		m_peakHoldMs.store(static_cast<float>(value));
+		if (!number("target_port", 0.0, 0.0, value))
+		{
+			return false;
+		}
+		m_targetPort = static_cast<int>(value);
+
+		m_truePeakEnabled = !params.count("true_peak") || params.at("true_peak") != "false";
+		if (params.count("target_ip"))
+		{
+			m_targetIp = params.at("target_ip");
+		}
+		if (params.count("osc_address"))
+		{
+			m_oscAddress = params.at("osc_address");
+		}
+		if (params.count("format"))
+		{
+			const std::string &format = params.at("format");
+			if (format != "blob" && format != "bundle")
+			{
+				reportStatus("Error", "Unknown meter format: " + format);
+				return false;
+			}
+			m_bundleFormat = format == "bundle";
+		}
+
+		m_publishInterval = m_rateHz > 0.0 ? std::max(1L, std::lround(m_sampleRate / m_rateHz)) : 0;
+
+		const size_t channels = static_cast<size_t>(m_channels);
+		m_levels.assign(channels, Levels{});
+		m_holdFrames.assign(channels, 0);
+		m_truePeakHistory.assign(channels, std::vector<float>(2 * HISTORY, 0.0f));
+		for (auto &snapshot : m_snapshots)
+		{
+			snapshot.assign(channels, Levels{});
+		}
+		m_writeIndex = 0;
+		m_sharedIndex.store(1);
+		m_readIndex = 2;
+
+		std::lock_guard<std::mutex> lock(m_readingsMutex);
+		m_readings.assign(channels, MeterReading{FLOOR_DB, FLOOR_DB, FLOOR_DB, FLOOR_DB, false});
+		return true;
+	}
+
+	bool MeterNode::setParameter(const std::string &param, const std::string &value)
+	{
+		std::atomic<float> *target = nullptr;
+		if (param == "rms_ms")
+		{
+			target = &m_rmsMs;
+		}
+		else if (param == "release_db_per_s")
+		{
+			target = &m_releaseDbPerSecond;
+		}
+		else if (param == "peak_hold_ms")
+		{
+			target = &m_peakHoldMs;
+		}
+		else
+		{
+			reportStatus("Warning", "Parameter can't be changed at run time: " + param);
+			return false;
+		}
+
+		double parsed = 0.0;
+		if (!parseNumber(param, value, parsed))
+		{
+			return false;
+		}
+		if (parsed < 0.0)
+		{
+			reportStatus("Error", "'" + param + "' must not be negative");
+			return false;
+		}
+		target->store(static_cast<float>(parsed), std::memory_order_relaxed);
+		return true;
+	}
+
+	void MeterNode::setReadingCallback(ReadingCallback callback)
+	{
+		m_readingCallback = std::move(callback);
+	}
+
+	std::vector<MeterReading> MeterNode::getReadings() const
+	{
+		std::lock_guard<std::mutex> lock(m_readingsMutex);
+		return m_readings;
+	}
+
+	bool MeterNode::start()
+	{
+		if (!DspNode::start())
+		{
+			return false;
+		}
+
+		if (m_publishInterval == 0)
+		{
+			return true;
+		}
+
+		if (m_targetPort > 0)
+		{
+			m_oscController = std::make_unique<OscController>();
+			if (!m_oscController->configure(m_targetIp, m_targetPort, 0))
+			{
+				reportStatus("Warning", "Failed to configure meter OSC target - publishing locally only");
+				m_oscController.reset();
+			}
+		}
+
+		m_publisherStop = false;
+		m_publisherThread = std::thread(&MeterNode::runPublisher, this);
+		return true;
+	}
+
+	void MeterNode::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_publisherMutex);
+			m_publisherStop = true;
+		}
+		m_publisherCondition.notify_all();
+		if (m_publisherThread.joinable())
+		{
+			m_publisherThread.join();
+		}
+		m_oscController.reset();
+
+		DspNode::stop();
+	}
+
+	bool MeterNode::process()
+	{
+		if (m_running && m_inputs[0])
+		{
+			measure(*m_inputs[0]);
+		}
+
+		// Always forwards the input (canBypass)
+		return DspNode::process();
+	}
+
+	bool MeterNode::render(AudioBuffer &output, long frames)
+	{
+		for (int c = 0; c < m_channels; c++)
+		{
+			std::memcpy(outputChannel(output, c), inputChannel(0, c), static_cast<size_t>(frames) * sizeof(float));
+		}
+		return true;
+	}
+
+	void MeterNode::resetState()
+	{
+		std::fill(m_levels.begin(), m_levels.end(), Levels{});
+		std::fill(m_holdFrames.begin(), m_holdFrames.end(), 0);
+		for (auto &history : m_truePeakHistory)
+		{
+			std::fill(history.begin(), history.end(), 0.0f);
+		}
+		m_framesSincePublish = 0;
+	}
+
+	void MeterNode::measure(const AudioBuffer &input)
+	{
+		const long frames = input.getFrameCount();
+		if (frames <= 0)
+		{
+			return;
+		}
+
+		// Ballistics for this block length
+		const double seconds = frames / m_sampleRate;
+		const float release = static_cast<float>(std::pow(10.0, -m_releaseDbPerSecond.load(std::memory_order_relaxed) * seconds / 20.0));
+		const float rmsMs = m_rmsMs.load(std::memory_order_relaxed);
+		const float average = rmsMs > 0.0f ? static_cast<float>(std::exp(-seconds * 1000.0 / rmsMs)) : 0.0f;
+		const long holdLength = std::lround(m_peakHoldMs.load(std::memory_order_relaxed) * m_sampleRate / 1000.0);
+
+		for (int c = 0; c < m_channels; c++)
+		{
+			const float *in = reinterpret_cast<const float *>(input.getPlaneData(c));
+			Levels &levels = m_levels[c];
+
+			float peak = 0.0f;
+			float sumSquares = 0.0f;
+			m_kernels.level(in, frames, peak, sumSquares);
+
+			levels.peak = std::max(peak, levels.peak * release);
+			levels.rms = levels.rms * average + (sumSquares / static_cast<float>(frames)) * (1.0f - average);
+			levels.clipped = levels.clipped || peak >= 1.0f;
+
+			if (m_truePeakEnabled)
+			{
+				// The first samples need the previous block's tail; the rest read the input in place
+				float *history = m_truePeakHistory[c].data();
+				const long head = std::min<long>(frames, HISTORY);
+				std::memcpy(history + HISTORY, in, static_cast<size_t>(head) * sizeof(float));
+				float truePeak = m_kernels.truePeak(history + HISTORY, head);
+				if (frames > head)
+				{
+					truePeak = std::max(truePeak, m_kernels.truePeak(in + head, frames - head));
+					std::memcpy(history, in + frames - HISTORY, HISTORY * sizeof(float));
+				}
+				else
+				{
+					std::memmove(history, history + head, HISTORY * sizeof(float));
+				}
+				levels.truePeak = std::max(std::max(truePeak, peak), levels.truePeak * release);
+			}
+			else
+			{
+				levels.truePeak = levels.peak;
+			}
+
+			if (peak >= levels.peakHold)
+			{
+				levels.peakHold = peak;
+				m_holdFrames[c] = 0;
+			}
+			else if ((m_holdFrames[c] += frames) > holdLength)
+			{
+				levels.peakHold = levels.peak;
+				m_holdFrames[c] = 0;
+			}
+		}
+
+		// Decimate to the publish rate
+		m_framesSincePublish += frames;
+		if (m_publishInterval > 0 && m_framesSincePublish >= m_publishInterval)
+		{
+			m_framesSincePublish %= m_publishInterval;
+			std::copy(m_levels.begin(), m_levels.end(), m_snapshots[m_writeIndex].begin());
+			m_writeIndex = m_sharedIndex.exchange(m_writeIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+
+			// Clip indicators restart with every snapshot
+			for (auto &levels : m_levels)
+			{
+				levels.clipped = false;
+			}
+		}
+	}
+
+	void MeterNode::runPublisher()
+	{
+		// Polling at the publish rate keeps the processing thread free of wake-ups
+		const auto period = std::chrono::duration<double>(1.0 / m_rateHz);
+
+		std::unique_lock<std::mutex> lock(m_publisherMutex);
+		while (!m_publisherStop)
+		{
+			m_publisherCondition.wait_for(lock, period, [this]()
+										  { return m_publisherStop; });
+			if (m_publisherStop)
+			{
+				break;
+			}
+
+			if (m_sharedIndex.load(std::memory_order_acquire) & FRESH)
+			{
+				m_readIndex = m_sharedIndex.exchange(m_readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+				lock.unlock();
+				publish(m_snapshots[m_readIndex]);
+				lock.lock();
+			}
+		}
+	}
+
+	float MeterNode::toDb(float level)
+	{
+		return level > 0.0f ? std::max(FLOOR_DB, 20.0f * std::log10(level)) : FLOOR_DB;
+	}
+
+	void MeterNode::publish(const std::vector<Levels> &levels)
+	{
+		std::vector<MeterReading> readings(levels.size());
+		for (size_t c = 0; c < levels.size(); c++)
+		{
+			readings[c].peakDb = toDb(levels[c].peak);
+			readings[c].rmsDb = toDb(std::sqrt(levels[c].rms));
+			readings[c].truePeakDb = toDb(levels[c].truePeak);
+			readings[c].peakHoldDb = toDb(levels[c].peakHold);
+			readings[c].clipped = levels[c].clipped;
+		}
+
+		if (m_oscController)
+		{
+			if (m_bundleFormat)
+			{
+				std::vector<std::pair<std::string, std::vector<std::any>>> messages;
+				messages.reserve(readings.size());
+				for (size_t c = 0; c < readings.size(); c++)
+				{
+					const MeterReading &reading = readings[c];
+					messages.emplace_back(m_oscAddress + "/" + std::to_string(c + 1),
+										  std::vector<std::any>{reading.peakDb, reading.rmsDb, reading.truePeakDb,
+																reading.peakHoldDb, reading.clipped ? 1.0f : 0.0f});
+				}
+				m_oscController->sendBundle(messages);
+			}
+			else
+			{
+				constexpr int FIELDS = 5;
+				std::vector<float> payload;
+				payload.reserve(readings.size() * FIELDS);
+				for (const auto &reading : readings)
+				{
+					payload.insert(payload.end(), {reading.peakDb, reading.rmsDb, reading.truePeakDb,
+												   reading.peakHoldDb, reading.clipped ? 1.0f : 0.0f});
+				}
+				m_oscController->sendBlob(m_oscAddress, {static_cast<int>(readings.size()), FIELDS},
+										  payload.data(), payload.size() * sizeof(float));
+			}
+		}
+
+		if (m_readingCallback)
+		{
+			m_readingCallback(m_name, readings);
+		}
+
+		std::lock_guard<std::mutex> lock(m_readingsMutex);
+		m_readings = std::move(readings);
+	}
+
+} // namespace AudioEngine
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "DspNodes.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace AudioEngine
+{
+
+	class OscController; // Forward declaration
+
+	/**
+	 * @brief Published levels of one channel, in dBFS
+	 */
+	struct MeterReading
+	{
+		float peakDb;	  // Sample peak with release ballistics
+		float rmsDb;	  // Exponentially averaged RMS
+		float truePeakDb; // 4x oversampled peak with release ballistics
+		float peakHoldDb; // Highest peak within the hold time
+		bool clipped;	  // A sample reached full scale since the last publish
+	};
+
+	/**
+	 * @brief Level meter ("meter")
+	 *
+	 * Passes its input through unchanged and measures every channel: peak,
+	 * RMS and true peak (ITU-R BS.1770 4x interpolation) from the SIMD kernels
+	 * of DspKernels, with ballistics applied on the processing thread.
+	 *
+	 * Results are decimated to the publish rate and handed to a publisher
+	 * thread through a triple buffer, so the processing thread never blocks or
+	 * touches the network. The publisher sends one OSC message (or bundle) per
+	 * node and publish period and calls the reading callback.
+	 *
+	 * Params:
+	 * - "rate_hz": publish rate (default 30, 0 = no publishing)
+	 * - "rms_ms": RMS integration time (default 300)
+	 * - "release_db_per_s": peak and true-peak fall-back (default 20)
+	 * - "peak_hold_ms": peak hold time (default 1000)
+	 * - "true_peak": compute the true peak (default true)
+	 * - "target_ip", "target_port": OSC destination (default 127.0.0.1, port
+	 *   0 = no OSC)
+	 * - "osc_address": default "/meter/<node name>"
+	 * - "format": "blob" (default) or "bundle"
+	 *
+	 * "blob" sends <osc_address> with int32 channel count, int32 fields per
+	 * channel (5) and a blob of float32 [peak, rms, truePeak, peakHold, clip]
+	 * per channel, in dBFS (clip is 0 or 1). "bundle" sends one bundle of
+	 * <osc_address>/<channel> messages (1-based) with the same five values.
+	 */
+	class MeterNode : public DspNode
+	{
+	public:
+		using ReadingCallback = std::function<void(const std::string &nodeName, const std::vector<MeterReading> &readings)>;
+
+		MeterNode(const std::string &name, AudioEngine *engine);
+		~MeterNode() override;
+
+		std::string getDspType() const override { return "meter"; }
+		bool setParameter(const std::string &param, const std::string &value) override;
+
+		bool start() override;
+		void stop() override;
+		bool process() override;
+
+		/**
+		 * @brief Set a function to receive every published set of readings
+		 *
+		 * Called on the publisher thread. Set before start().
+		 */
+		void setReadingCallback(ReadingCallback callback);
+
+		/**
+		 * @brief Get the most recently published readings
+		 */
+		std::vector<MeterReading> getReadings() const;
+
+	protected:
+		bool configureParameters(const std::map<std::string, std::string> &params) override;
+		bool render(AudioBuffer &output, long frames) override;
+		bool canBypass() const override { return true; }
+		void resetState() override;
+
+	private:
+		/**
+		 * @brief Linear levels handed to the publisher
+		 */
+		struct Levels
+		{
+			float peak;
+			float rms; // Mean square until converted for publishing
+			float truePeak;
+			float peakHold;
+			bool clipped;
+		};
+
+		// Triple buffer state: index of the shared snapshot plus a fresh flag
+		static constexpr int INDEX_MASK = 3;
+		static constexpr int FRESH = 4;
+
+		// Settings
+		double m_rateHz = 30.0;
+		bool m_truePeakEnabled = true;
+		std::atomic<float> m_rmsMs{300.0f};
+		std::atomic<float> m_releaseDbPerSecond{20.0f};
+		std::atomic<float> m_peakHoldMs{1000.0f};
+		std::string m_targetIp = "127.0.0.1";
+		int m_targetPort = 0;
+		std::string m_oscAddress;
+		bool m_bundleFormat = false;
+
+		// Processing thread state
+		std::vector<Levels> m_levels;
+		std::vector<long> m_holdFrames;
+		std::vector<std::vector<float>> m_truePeakHistory; // Previous block's tail, then its continuation
+		long m_framesSincePublish = 0;
+		long m_publishInterval = 0;
+
+		// Snapshots
+		std::vector<Levels> m_snapshots[3];
+		int m_writeIndex = 0;				// Owned by the processing thread
+		std::atomic<int> m_sharedIndex{1}; // Handed between the processing and publisher threads
+		int m_readIndex = 2;				// Owned by the publisher thread
+
+		// Publisher thread
+		std::thread m_publisherThread;
+		std::mutex m_publisherMutex;
+		std::condition_variable m_publisherCondition;
+		bool m_publisherStop = false;
+		std::unique_ptr<OscController> m_oscController;
+		ReadingCallback m_readingCallback;
+		mutable std::mutex m_readingsMutex;
+		std::vector<MeterReading> m_readings;
+
+		void measure(const AudioBuffer &input);
+		void runPublisher();
+		void publish(const std::vector<Levels> &levels);
+		static float toDb(float level);
+	};
+
+} // namespace AudioEngine
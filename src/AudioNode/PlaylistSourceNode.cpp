@@ -0,0 +1,727 @@
+#include "PlaylistSourceNode.h"
+#include "AudioBufferPool.h"
+#include "AudioEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/samplefmt.h>
+#include <libswresample/swresample.h>
+}
+
+namespace AudioEngine
+{
+
+	PlaylistSourceNode::Track::~Track()
+	{
+		av_frame_free(&frame);
+		av_packet_free(&packet);
+		swr_free(&swr);
+		avcodec_free_context(&codec);
+		avformat_close_input(&format);
+	}
+
+	PlaylistSourceNode::PlaylistSourceNode(const std::string &name, AudioEngine *engine)
+		: AudioNode(name, NodeType::PLAYLIST_SOURCE, engine),
+		  m_loopPlaylist(false),
+		  m_sequenceItem(0),
+		  m_sequencePlays(0),
+		  m_sequenceEnded(false),
+		  m_stopThread(false),
+		  m_currentItem(0),
+		  m_queueSize(0),
+		  m_queuePolicy(QueuePolicy::SILENCE_FILL),
+		  m_endOfPlaylist(false),
+		  m_offline(false)
+	{
+	}
+
+	PlaylistSourceNode::~PlaylistSourceNode()
+	{
+		stop();
+	}
+
+	bool PlaylistSourceNode::configure(const std::map<std::string, std::string> &params,
+									   double sampleRate, long bufferSize,
+									   AVSampleFormat format, const AVChannelLayout &layout)
+	{
+		if (m_running)
+		{
+			logMessage("Cannot configure while running", true);
+			return false;
+		}
+
+		// Check base configuration
+		if (!checkConfigure(sampleRate, bufferSize, format, layout))
+		{
+			return false;
+		}
+
+		if (!parseItems(params))
+		{
+			return false;
+		}
+
+		auto it = params.find("loop");
+		m_loopPlaylist = it != params.end() && it->second == "true";
+
+		// Read-ahead queue
+		it = params.find("queue_size");
+		if (it != params.end())
+		{
+			try
+			{
+				int size = std::stoi(it->second);
+				if (size < 1)
+				{
+					throw std::out_of_range("queue_size");
+				}
+				m_queueSize = static_cast<size_t>(size);
+			}
+			catch (const std::exception &)
+			{
+				logMessage("Invalid queue_size: " + it->second, true);
+				return false;
+			}
+		}
+
+		it = params.find("queue_policy");
+		if (it != params.end() && !AudioBufferQueue::parsePolicy(it->second, m_queuePolicy))
+		{
+			logMessage("Invalid queue_policy: " + it->second, true);
+			return false;
+		}
+
+		if (!m_converter.configure(m_sampleRate, m_bufferSize, m_format, m_channelLayout,
+								   [this](const std::shared_ptr<AudioBuffer> &block)
+								   { return enqueueBuffer(block); }))
+		{
+			logMessage("Unsupported engine format", true);
+			return false;
+		}
+
+		m_configured = true;
+		logMessage("Configured with " + std::to_string(m_items.size()) + " items" +
+					   (m_loopPlaylist ? " (looping)" : ""),
+				   false);
+		return true;
+	}
+
+	bool PlaylistSourceNode::parseItems(const std::map<std::string, std::string> &params)
+	{
+		m_items.clear();
+		for (size_t i = 0;; i++)
+		{
+			const std::string index = std::to_string(i);
+			auto it = params.find("file_" + index);
+			if (it == params.end())
+			{
+				break;
+			}
+
+			Item item;
+			item.path = it->second;
+
+			// Region and repeat count, all optional
+			std::string key;
+			try
+			{
+				key = "start_" + index;
+				it = params.find(key);
+				if (it != params.end())
+				{
+					item.start = std::stod(it->second);
+				}
+
+				key = "end_" + index;
+				it = params.find(key);
+				if (it != params.end())
+				{
+					item.end = std::stod(it->second);
+				}
+
+				key = "loop_" + index;
+				it = params.find(key);
+				if (it != params.end())
+				{
+					item.loops = std::stoi(it->second);
+				}
+
+				if (item.start < 0.0 || item.loops < 0 || (item.end > 0.0 && item.end <= item.start))
+				{
+					throw std::out_of_range(key);
+				}
+			}
+			catch (const std::exception &)
+			{
+				logMessage("Invalid region for " + item.path + " (" + key + ")", true);
+				return false;
+			}
+
+			m_items.push_back(std::move(item));
+		}
+
+		if (m_items.empty())
+		{
+			logMessage("Missing required 'file_0' parameter", true);
+			return false;
+		}
+		return true;
+	}
+
+	bool PlaylistSourceNode::start()
+	{
+		if (!m_configured)
+		{
+			logMessage("Cannot start - not configured", true);
+			return false;
+		}
+
+		if (m_running)
+		{
+			logMessage("Already running", false);
+			return true;
+		}
+
+		// Sized here because the depth depends on the rendering mode
+		size_t queueSize = m_queueSize > 0 ? m_queueSize : (m_offline ? OFFLINE_QUEUE_SIZE : DEFAULT_QUEUE_SIZE);
+		m_outputQueue = std::make_unique<AudioBufferQueue>(queueSize, m_queuePolicy);
+		m_outputBuffer.reset();
+		m_converter.reset();
+
+		// Allocated here so an underrun costs nothing on the audio thread
+		m_silenceBuffer.reset();
+		if (!m_offline && m_queuePolicy == QueuePolicy::SILENCE_FILL)
+		{
+			m_silenceBuffer = AudioBufferPool::shared().acquire(m_bufferSize, m_sampleRate, m_format, m_channelLayout);
+			if (!m_silenceBuffer || !m_silenceBuffer->clear())
+			{
+				logMessage("Failed to allocate silence buffer", true);
+				return false;
+			}
+			m_silenceBuffer->publish();
+		}
+
+		// Every start plays the list from the top
+		m_sequenceItem = 0;
+		m_sequencePlays = 0;
+		m_sequenceEnded = false;
+		m_prepared.reset();
+		m_currentItem = 0;
+		m_endOfPlaylist = false;
+		m_stopThread = false;
+
+		try
+		{
+			m_primerThread = std::thread(&PlaylistSourceNode::primerThreadFunc, this);
+			m_readerThread = std::thread(&PlaylistSourceNode::readerThreadFunc, this);
+			m_running = true;
+			logMessage("Started", false);
+			return true;
+		}
+		catch (const std::exception &e)
+		{
+			logMessage("Failed to start playlist threads: " + std::string(e.what()), true);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stopThread = true;
+			}
+			m_condition.notify_all();
+			m_readerWake.notify();
+			m_outputWake.notify();
+			for (std::thread *thread : {&m_primerThread, &m_readerThread})
+			{
+				if (thread->joinable())
+				{
+					thread->join();
+				}
+			}
+			return false;
+		}
+	}
+
+	void PlaylistSourceNode::stop()
+	{
+		if (!m_running)
+		{
+			return;
+		}
+
+		// Signal both threads to stop; every wait checks the flag
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopThread = true;
+		}
+		m_condition.notify_all();
+		m_readerWake.notify();
+		m_outputWake.notify();
+
+		for (std::thread *thread : {&m_primerThread, &m_readerThread})
+		{
+			if (thread->joinable())
+			{
+				thread->join();
+			}
+		}
+
+		m_running = false;
+		m_outputBuffer.reset();
+		m_converter.reset();
+		m_prepared.reset();
+
+		AudioBufferQueue::Stats stats = m_outputQueue->getStats();
+		logMessage("Stopped (queue underruns: " + std::to_string(stats.underruns) +
+					   ", dropped: " + std::to_string(stats.dropped) + ")",
+				   false);
+	}
+
+	bool PlaylistSourceNode::process()
+	{
+		if (!m_running)
+		{
+			m_outputBuffer.reset();
+			return true;
+		}
+
+		// Offline there is no deadline; wait for the reader instead of underrunning
+		if (m_offline)
+		{
+			m_outputBuffer.reset();
+			m_outputWake.waitUntil([this]
+								   { return m_outputQueue->tryPop(m_outputBuffer) ||
+											m_endOfPlaylist.load(std::memory_order_acquire) || m_stopThread; });
+
+			// The reader queues everything it has before raising the end flag
+			if (!m_outputBuffer && m_endOfPlaylist.load(std::memory_order_acquire))
+			{
+				m_outputQueue->tryPop(m_outputBuffer);
+			}
+			m_readerWake.notify();
+			return true;
+		}
+
+		// An empty queue after the last item is the end of the stream, not an underrun
+		if (m_endOfPlaylist.load(std::memory_order_acquire))
+		{
+			m_outputBuffer.reset();
+			m_outputQueue->tryPop(m_outputBuffer);
+			return true;
+		}
+
+		m_outputBuffer = m_outputQueue->pop();
+
+		// The reader refills in batches: wake it once the queue is half empty, not after every block
+		if (m_outputBuffer && m_outputQueue->depth() <= m_outputQueue->getCapacity() / 2)
+		{
+			m_readerWake.notify();
+		}
+		if (!m_outputBuffer && m_queuePolicy == QueuePolicy::SILENCE_FILL)
+		{
+			m_outputBuffer = m_silenceBuffer;
+		}
+		return true;
+	}
+
+	std::shared_ptr<AudioBuffer> PlaylistSourceNode::getOutputBuffer(int padIndex)
+	{
+		if (padIndex != 0)
+		{
+			logMessage("Invalid output pad index: " + std::to_string(padIndex), true);
+			return nullptr;
+		}
+		return m_outputBuffer;
+	}
+
+	bool PlaylistSourceNode::setInputBuffer(std::shared_ptr<AudioBuffer> buffer, int padIndex)
+	{
+		logMessage("Cannot set input buffer - this is a source node", true);
+		return false;
+	}
+
+	bool PlaylistSourceNode::nextInSequence(size_t &item)
+	{
+		// Called with m_mutex held
+		if (m_sequenceItem >= m_items.size())
+		{
+			if (!m_loopPlaylist)
+			{
+				return false;
+			}
+			m_sequenceItem = 0;
+		}
+
+		item = m_sequenceItem;
+		const int loops = m_items[item].loops;
+		if (loops > 0 && ++m_sequencePlays >= loops)
+		{
+			m_sequenceItem++;
+			m_sequencePlays = 0;
+		}
+		return true;
+	}
+
+	void PlaylistSourceNode::primerThreadFunc()
+	{
+		size_t failures = 0;
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		while (!m_stopThread)
+		{
+			// One track ahead is enough: it only has to be ready when the current one ends
+			if (m_prepared || m_sequenceEnded)
+			{
+				m_condition.wait(lock);
+				continue;
+			}
+
+			size_t item = 0;
+			if (!nextInSequence(item))
+			{
+				m_sequenceEnded = true;
+				m_condition.notify_all();
+				continue;
+			}
+
+			lock.unlock();
+			auto track = std::make_unique<Track>();
+			track->item = item;
+			const bool opened = openTrack(*track);
+			lock.lock();
+
+			if (!opened)
+			{
+				// Skip the item, even one set to repeat forever
+				if (m_sequenceItem == item)
+				{
+					m_sequenceItem++;
+					m_sequencePlays = 0;
+				}
+				if (++failures >= m_items.size())
+				{
+					logMessage("No playable items left", true);
+					m_sequenceEnded = true;
+					m_condition.notify_all();
+				}
+				continue;
+			}
+
+			failures = 0;
+			m_prepared = std::move(track);
+			m_condition.notify_all();
+		}
+	}
+
+	std::unique_ptr<PlaylistSourceNode::Track> PlaylistSourceNode::takePrepared()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [this]()
+						 { return m_prepared || m_sequenceEnded || m_stopThread; });
+
+		// Taking the track sets the primer to work on the one after it
+		std::unique_ptr<Track> track = std::move(m_prepared);
+		m_condition.notify_all();
+		return track;
+	}
+
+	void PlaylistSourceNode::readerThreadFunc()
+	{
+		std::unique_ptr<Track> track;
+		while (!m_stopThread)
+		{
+			// Region done: carry on in the same block with the primed next track
+			if (!track || track->finished)
+			{
+				track = takePrepared();
+				if (!track)
+				{
+					break;
+				}
+				m_currentItem = track->item;
+				logMessage("Playing item " + std::to_string(track->item) + ": " + m_items[track->item].path, false);
+			}
+
+			readTrack(*track);
+		}
+
+		// The last item's final block is the only short one
+		if (!m_stopThread)
+		{
+			m_converter.flush();
+			m_endOfPlaylist = true;
+			m_outputWake.notify();
+			logMessage("End of playlist reached", false);
+		}
+	}
+
+	bool PlaylistSourceNode::openTrack(Track &track)
+	{
+		const Item &item = m_items[track.item];
+
+		int ret = avformat_open_input(&track.format, item.path.c_str(), nullptr, nullptr);
+		if (ret >= 0)
+		{
+			ret = avformat_find_stream_info(track.format, nullptr);
+		}
+		if (ret < 0)
+		{
+			char errbuf[AV_ERROR_MAX_STRING_SIZE];
+			av_strerror(ret, errbuf, sizeof(errbuf));
+			logMessage("Failed to open " + item.path + ": " + std::string(errbuf), true);
+			return false;
+		}
+
+		track.stream = av_find_best_stream(track.format, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+		if (track.stream < 0)
+		{
+			logMessage("No audio stream found in " + item.path, true);
+			return false;
+		}
+		AVStream *stream = track.format->streams[track.stream];
+		track.timeBase = stream->time_base;
+
+		// The decoder drops the encoder delay and padding the container declares
+		// and moves the timestamps to match, so positions below are real ones
+		const AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+		track.codec = codec ? avcodec_alloc_context3(codec) : nullptr;
+		if (!track.codec ||
+			avcodec_parameters_to_context(track.codec, stream->codecpar) < 0)
+		{
+			logMessage("Unsupported codec in " + item.path, true);
+			return false;
+		}
+		track.codec->pkt_timebase = stream->time_base;
+		ret = avcodec_open2(track.codec, codec, nullptr);
+		if (ret < 0)
+		{
+			char errbuf[AV_ERROR_MAX_STRING_SIZE];
+			av_strerror(ret, errbuf, sizeof(errbuf));
+			logMessage("Failed to open codec for " + item.path + ": " + std::string(errbuf), true);
+			return false;
+		}
+
+		std::string error;
+		track.swr = m_converter.createResampler(track.codec, error);
+		if (!track.swr)
+		{
+			logMessage("Failed to initialize resampler for " + item.path + ": " + error, true);
+			return false;
+		}
+
+		track.packet = av_packet_alloc();
+		track.frame = av_frame_alloc();
+		if (!track.packet || !track.frame)
+		{
+			logMessage("Failed to allocate packet or frame", true);
+			return false;
+		}
+		track.inputPlanes.assign(av_sample_fmt_is_planar(track.codec->sample_fmt) ? track.codec->ch_layout.nb_channels : 1,
+								 nullptr);
+
+		// Region in the file's samples and, for the exact splice, in engine frames
+		const int inputRate = track.codec->sample_rate;
+		track.startSample = std::llround(item.start * inputRate);
+		track.nextSample = track.startSample;
+		if (item.end > 0.0)
+		{
+			track.endSample = std::llround(item.end * inputRate);
+			track.outputFrames = std::llround((item.end - item.start) * m_sampleRate);
+		}
+
+		// Lands on the packet before the region; the first frame is trimmed
+		if (item.start > 0.0)
+		{
+			ret = av_seek_frame(track.format, track.stream,
+								static_cast<int64_t>(item.start / av_q2d(track.timeBase)), AVSEEK_FLAG_BACKWARD);
+			if (ret < 0)
+			{
+				char errbuf[AV_ERROR_MAX_STRING_SIZE];
+				av_strerror(ret, errbuf, sizeof(errbuf));
+				logMessage("Error seeking in " + item.path + ": " + std::string(errbuf), true);
+				return false;
+			}
+		}
+
+		// Prime: the first audio is decoded now, not when the previous track ends
+		track.frameReady = decodeFrame(track);
+		if (!track.frameReady)
+		{
+			logMessage("No audio in region of " + item.path, true);
+			return false;
+		}
+		return true;
+	}
+
+	void PlaylistSourceNode::readTrack(Track &track)
+	{
+		if (!track.frameReady)
+		{
+			track.frameReady = decodeFrame(track);
+		}
+		if (track.frameReady)
+		{
+			track.frameReady = false;
+			convert(track, track.inputPlanes.data(), track.frameSamples);
+			av_frame_unref(track.frame);
+			return;
+		}
+
+		// The region is fed in; collect what the resampler's filter still holds
+		convert(track, nullptr, 0);
+		track.finished = true;
+	}
+
+	bool PlaylistSourceNode::decodeFrame(Track &track)
+	{
+		while (!track.inputEnded && !m_stopThread)
+		{
+			int ret = avcodec_receive_frame(track.codec, track.frame);
+			if (ret >= 0)
+			{
+				if (selectRegion(track, track.frame))
+				{
+					return true;
+				}
+				av_frame_unref(track.frame);
+				continue;
+			}
+			if (ret == AVERROR_EOF)
+			{
+				track.inputEnded = true;
+				continue;
+			}
+			if (ret != AVERROR(EAGAIN))
+			{
+				char errbuf[AV_ERROR_MAX_STRING_SIZE];
+				av_strerror(ret, errbuf, sizeof(errbuf));
+				logMessage("Error decoding " + m_items[track.item].path + ": " + std::string(errbuf), true);
+				track.inputEnded = true;
+				continue;
+			}
+
+			// The decoder wants more input
+			ret = av_read_frame(track.format, track.packet);
+			if (ret < 0)
+			{
+				// An empty packet drains the decoder
+				avcodec_send_packet(track.codec, nullptr);
+				continue;
+			}
+			if (track.packet->stream_index == track.stream)
+			{
+				avcodec_send_packet(track.codec, track.packet);
+			}
+			av_packet_unref(track.packet);
+		}
+		return false;
+	}
+
+	bool PlaylistSourceNode::selectRegion(Track &track, AVFrame *frame)
+	{
+		const int64_t first = frame->pts != AV_NOPTS_VALUE
+								  ? std::llround(frame->pts * av_q2d(track.timeBase) * track.codec->sample_rate)
+								  : track.nextSample;
+		track.nextSample = first + frame->nb_samples;
+
+		// Region start: the seek lands before it
+		int skip = 0;
+		if (track.trimming)
+		{
+			skip = static_cast<int>(std::min<int64_t>(frame->nb_samples, std::max<int64_t>(0, track.startSample - first)));
+			if (skip == frame->nb_samples)
+			{
+				return false;
+			}
+			track.trimming = false;
+		}
+
+		// Region end: feed the resampler up to the last sample and stop reading
+		int count = frame->nb_samples - skip;
+		if (track.endSample >= 0 && first + skip + count >= track.endSample)
+		{
+			count = static_cast<int>(std::max<int64_t>(0, track.endSample - first - skip));
+			track.inputEnded = true;
+		}
+		if (count == 0)
+		{
+			return false;
+		}
+
+		const AVSampleFormat format = static_cast<AVSampleFormat>(frame->format);
+		const int bytes = av_get_bytes_per_sample(format);
+		const int stride = av_sample_fmt_is_planar(format) ? bytes : bytes * frame->ch_layout.nb_channels;
+		for (size_t i = 0; i < track.inputPlanes.size(); i++)
+		{
+			track.inputPlanes[i] = frame->extended_data[i] + static_cast<size_t>(skip) * stride;
+		}
+		track.frameSamples = count;
+		return true;
+	}
+
+	void PlaylistSourceNode::convert(Track &track, const uint8_t *const *input, int samples)
+	{
+		// Cut at the region's exact length; the resampler may round either way
+		const int64_t limit = track.outputFrames >= 0 ? track.outputFrames - track.produced : -1;
+		const int64_t produced = m_converter.convert(track.swr, input, samples, limit);
+		if (produced < 0)
+		{
+			if (produced != AVERROR_EXIT)
+			{
+				char errbuf[AV_ERROR_MAX_STRING_SIZE];
+				av_strerror(static_cast<int>(produced), errbuf, sizeof(errbuf));
+				logMessage("Error resampling audio: " + std::string(errbuf), true);
+			}
+			return;
+		}
+
+		track.produced += produced;
+		if (track.outputFrames >= 0 && track.produced >= track.outputFrames)
+		{
+			track.inputEnded = true;
+			track.finished = true;
+		}
+	}
+
+	bool PlaylistSourceNode::enqueueBuffer(const std::shared_ptr<AudioBuffer> &buffer)
+	{
+		// Wait for room rather than drop; the queue is the only read-ahead
+		m_readerWake.waitUntil([this]
+							   { return m_stopThread || !m_outputQueue->isFull(); });
+		if (m_stopThread)
+		{
+			return false;
+		}
+		m_outputQueue->push(buffer);
+		m_outputWake.notify();
+		return true;
+	}
+
+	void PlaylistSourceNode::setOfflineMode(bool offline)
+	{
+		if (m_running)
+		{
+			logMessage("Cannot change rendering mode while running", true);
+			return;
+		}
+		m_offline = offline;
+	}
+
+	bool PlaylistSourceNode::isDrained() const
+	{
+		return m_endOfPlaylist.load(std::memory_order_acquire) && !m_outputBuffer &&
+			   (!m_outputQueue || m_outputQueue->depth() == 0);
+	}
+
+	AudioBufferQueue::Stats PlaylistSourceNode::getQueueStats() const
+	{
+		if (!m_outputQueue)
+		{
+			return AudioBufferQueue::Stats{};
+		}
+		return m_outputQueue->getStats();
+	}
+
+} // namespace AudioEngine
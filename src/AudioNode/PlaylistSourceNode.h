@@ -0,0 +1,215 @@
+#pragma once
+
+#include "AudioNode.h"
+#include "AudioBufferQueue.h"
+#include "BlockConverter.h"
+#include "WakeEvent.h"
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswresample/swresample.h>
+}
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief Source node playing a list of files back to back without gaps
+	 *
+	 * The items play as one continuous stream: a reader thread decodes the
+	 * current item, converts it to the engine format and cuts it into
+	 * blocks of exactly bufferSize frames, so a block can end one item and
+	 * start the next. While an item plays, a primer thread opens the next
+	 * one, seeks to its region, sets up its decoder and resampler and
+	 * decodes its first audio, so the reader moves on without waiting for
+	 * the disk or a decoder to start up.
+	 *
+	 * Splices are sample-accurate: the encoder delay and end padding a
+	 * container declares (LAME/Xing headers, MP4 edit lists, Opus
+	 * pre-skip) are removed by the decoder, region starts trim the first
+	 * decoded frame to the exact sample and region ends cut the converted
+	 * audio to the region's length.
+	 *
+	 * Parameters:
+	 * - file_0, file_1, ...: Items in playing order (file_0 required)
+	 * - start_N, end_N: Region of item N in seconds (default the whole file)
+	 * - loop_N: Times region N plays in a row (default 1, 0 = forever)
+	 * - loop: "true" starts over after the last item (default false)
+	 * - queue_size: Blocks to read ahead (default 8, 64 offline)
+	 * - queue_policy: As for FileSourceNode (default "silence")
+	 *
+	 * Items that fail to open are skipped. Without looping, the node
+	 * drains after the last item.
+	 */
+	class PlaylistSourceNode : public AudioNode
+	{
+	public:
+		/**
+		 * @brief Create a new playlist source node
+		 *
+		 * @param name Node name
+		 * @param engine Reference to the audio engine
+		 */
+		PlaylistSourceNode(const std::string &name, AudioEngine *engine);
+
+		/**
+		 * @brief Destroy the playlist source node
+		 */
+		~PlaylistSourceNode();
+
+		// AudioNode interface implementations
+		bool configure(const std::map<std::string, std::string> &params,
+					   double sampleRate,
+					   long bufferSize,
+					   AVSampleFormat format,
+					   const AVChannelLayout &layout) override;
+
+		bool start() override;
+		bool process() override;
+		void stop() override;
+
+		std::shared_ptr<AudioBuffer> getOutputBuffer(int padIndex) override;
+		bool setInputBuffer(std::shared_ptr<AudioBuffer> buffer, int padIndex) override;
+
+		int getInputPadCount() const override { return 0; }	 // No inputs
+		int getOutputPadCount() const override { return 1; } // One output
+
+		/**
+		 * @brief Select offline rendering
+		 *
+		 * Offline, process() waits for the reader instead of underrunning and
+		 * the default read-ahead is deeper.
+		 */
+		void setOfflineMode(bool offline) override;
+
+		/**
+		 * @brief Check whether the last item has been delivered
+		 */
+		bool isDrained() const override;
+
+		/**
+		 * @brief Get the number of items
+		 */
+		size_t getItemCount() const { return m_items.size(); }
+
+		/**
+		 * @brief Get the item the reader is decoding
+		 *
+		 * Runs ahead of the output by the read-ahead queue.
+		 *
+		 * @return Item index
+		 */
+		size_t getCurrentItem() const { return m_currentItem.load(std::memory_order_relaxed); }
+
+		/**
+		 * @brief Get the read-ahead queue counters
+		 *
+		 * @return Queue statistics
+		 */
+		AudioBufferQueue::Stats getQueueStats() const;
+
+	private:
+		/**
+		 * @brief One playlist entry
+		 */
+		struct Item
+		{
+			std::string path;
+			double start = 0.0; // Region start in seconds
+			double end = 0.0;	// Region end in seconds (0 = end of file)
+			int loops = 1;		// Plays in a row (0 = forever)
+		};
+
+		/**
+		 * @brief Decoder of one play of an item, opened by the primer
+		 */
+		struct Track
+		{
+			size_t item = 0;
+			AVFormatContext *format = nullptr;
+			AVCodecContext *codec = nullptr;
+			SwrContext *swr = nullptr;
+			AVPacket *packet = nullptr;
+			AVFrame *frame = nullptr;
+			int stream = -1;
+			AVRational timeBase{1, 1};
+
+			int64_t startSample = 0;   // Region start at the file's rate
+			int64_t endSample = -1;	   // Region end at the file's rate (-1 = end of file)
+			int64_t nextSample = 0;	   // Position of the next frame without a timestamp
+			int64_t outputFrames = -1; // Region length at the engine rate (-1 = unknown)
+			int64_t produced = 0;	   // Engine frames handed out
+			bool trimming = true;	   // First frame still to be cut to the region start
+			bool inputEnded = false;   // Nothing more to feed the resampler
+			bool finished = false;
+
+			bool frameReady = false; // frame holds region audio not yet converted (set by the primer)
+			int frameSamples = 0;	 // Samples of frame inside the region
+			std::vector<const uint8_t *> inputPlanes; // Region start within frame
+
+			~Track();
+		};
+
+		std::vector<Item> m_items;
+		bool m_loopPlaylist;
+
+		// Order of plays, advanced by the primer (guarded by m_mutex)
+		size_t m_sequenceItem;
+		int m_sequencePlays;
+
+		// Primer -> reader: the next track, opened and primed
+		std::unique_ptr<Track> m_prepared;
+		bool m_sequenceEnded;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+
+		// Threads
+		std::thread m_readerThread;
+		std::thread m_primerThread;
+		std::atomic<bool> m_stopThread;
+		std::atomic<size_t> m_currentItem;
+
+		// Read-ahead queue (reader thread -> process())
+		std::unique_ptr<AudioBufferQueue> m_outputQueue;
+		size_t m_queueSize; // 0 = default for the mode
+		QueuePolicy m_queuePolicy;
+		std::shared_ptr<AudioBuffer> m_outputBuffer;  // Buffer for the current block
+		std::shared_ptr<AudioBuffer> m_silenceBuffer; // Substituted on underrun
+		std::atomic<bool> m_endOfPlaylist;
+		bool m_offline;
+		WakeEvent m_readerWake; // Output queue space
+		WakeEvent m_outputWake; // Offline process(): a block or the end of the playlist
+
+		// Cuts the reader's converted audio into blocks, across item boundaries
+		BlockConverter m_converter;
+
+		// Default read-ahead depth
+		static constexpr size_t DEFAULT_QUEUE_SIZE = 8;
+		static constexpr size_t OFFLINE_QUEUE_SIZE = 64;
+
+		// Threads
+		void readerThreadFunc();
+		void primerThreadFunc();
+
+		// Helper methods
+		bool parseItems(const std::map<std::string, std::string> &params);
+		bool nextInSequence(size_t &item);
+		std::unique_ptr<Track> takePrepared();
+		bool openTrack(Track &track);
+		void readTrack(Track &track);
+		bool decodeFrame(Track &track);
+		bool selectRegion(Track &track, AVFrame *frame);
+		void convert(Track &track, const uint8_t *const *input, int samples);
+		bool enqueueBuffer(const std::shared_ptr<AudioBuffer> &buffer);
+	};
+
+} // namespace AudioEngine
@@ -0,0 +1,535 @@
+#include "ResamplerNode.h"
+#include "AudioBufferPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+extern "C"
+{
+#include <libavutil/opt.h>
+}
+
+namespace AudioEngine
+{
+
+	ResamplerNode::ResamplerNode(const std::string &name, AudioEngine *engine)
+		: DspNode(name, engine)
+	{
+	}
+
+	ResamplerNode::~ResamplerNode()
+	{
+		if (m_swrContext)
+		{
+			swr_free(&m_swrContext);
+		}
+	}
+
+	bool ResamplerNode::parseQuality(const std::string &text, Quality &quality)
+	{
+		if (text == "fast")
+		{
+			quality = Quality::FAST;
+		}
+		else if (text == "balanced")
+		{
+			quality = Quality::BALANCED;
+		}
+		else if (text == "high")
+		{
+			quality = Quality::HIGH;
+		}
+		else if (text == "best")
+		{
+			quality = Quality::BEST;
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+
+	bool ResamplerNode::configureParameters(const std::map<std::string, std::string> &params)
+	{
+		m_outputRate = static_cast<int>(std::lround(m_sampleRate));
+
+		m_fixedInputRate = 0;
+		if (params.count("input_rate"))
+		{
+			double rate = 0.0;
+			if (!parseNumber("input_rate", params.at("input_rate"), rate))
+			{
+				return false;
+			}
+			if (rate < 0.0 || rate > 1536000.0 || rate != std::floor(rate))
+			{
+				reportStatus("Error", "Invalid input rate: " + params.at("input_rate"));
+				return false;
+			}
+			m_fixedInputRate = static_cast<int>(rate);
+		}
+
+		m_quality = Quality::BALANCED;
+		if (params.count("quality") && !parseQuality(params.at("quality"), m_quality))
+		{
+			reportStatus("Error", "Unknown resampler quality: " + params.at("quality"));
+			return false;
+		}
+
+		m_compensateDelay = !params.count("compensate_delay") || params.at("compensate_delay") != "false";
+
+		m_maxQueueBlocks = 4;
+		if (params.count("max_queue_blocks"))
+		{
+			double blocks = 0.0;
+			if (!parseNumber("max_queue_blocks", params.at("max_queue_blocks"), blocks))
+			{
+				return false;
+			}
+			if (blocks < 2.0)
+			{
+				reportStatus("Error", "'max_queue_blocks' must be at least 2");
+				return false;
+			}
+			m_maxQueueBlocks = static_cast<long>(blocks);
+		}
+
+		// Drop the context of a previous configuration; the next input builds it again
+		if (m_swrContext)
+		{
+			swr_free(&m_swrContext);
+		}
+		m_inputRate = 0;
+
+		// Room for the queue limit plus the largest input block; a resampler
+		// widens this for its ratio when it is initialized
+		const size_t channels = static_cast<size_t>(m_channels);
+		m_maxInputFrames = m_bufferSize * m_maxQueueBlocks;
+		m_fifo.assign(channels, std::vector<float>());
+		m_fifoCapacity = 0;
+		m_fifoStart = 0;
+		m_fifoFrames = 0;
+		sizeFifo(m_maxInputFrames);
+		m_writePlanes.assign(channels, nullptr);
+		m_readPlanes.assign(channels, nullptr);
+
+		if (m_fixedInputRate > 0 && m_fixedInputRate != m_outputRate)
+		{
+			return initResampler(m_fixedInputRate);
+		}
+		return true;
+	}
+
+	bool ResamplerNode::setParameter(const std::string &param, const std::string & /*value*/)
+	{
+		// Every setting reshapes the SwrContext, which would click mid-stream
+		reportStatus("Warning", "Parameter can't be changed at run time: " + param);
+		return false;
+	}
+
+	bool ResamplerNode::applyQuality(Quality quality)
+	{
+		int ret = 0;
+		switch (quality)
+		{
+		case Quality::FAST:
+			ret |= av_opt_set_int(m_swrContext, "filter_size", 8, 0);
+			ret |= av_opt_set_int(m_swrContext, "phase_shift", 6, 0);
+			ret |= av_opt_set_int(m_swrContext, "linear_interp", 1, 0);
+			ret |= av_opt_set_double(m_swrContext, "cutoff", 0.9, 0);
+			break;
+		case Quality::BALANCED:
+			// swresample's defaults
+			break;
+		case Quality::HIGH:
+			ret |= av_opt_set_int(m_swrContext, "filter_size", 64, 0);
+			ret |= av_opt_set_int(m_swrContext, "phase_shift", 12, 0);
+			ret |= av_opt_set_int(m_swrContext, "exact_rational", 1, 0);
+			ret |= av_opt_set_double(m_swrContext, "cutoff", 0.97, 0);
+			break;
+		case Quality::BEST:
+			ret |= av_opt_set_int(m_swrContext, "resampler", SWR_ENGINE_SOXR, 0);
+			ret |= av_opt_set_double(m_swrContext, "precision", 28.0, 0);
+			break;
+		}
+		return ret >= 0;
+	}
+
+	bool ResamplerNode::initResampler(int inputRate)
+	{
+		if (!m_swrContext)
+		{
+			m_swrContext = swr_alloc();
+			if (!m_swrContext)
+			{
+				reportStatus("Error", "Failed to allocate resampler");
+				return false;
+			}
+		}
+
+		// Planar float in, out and in between: swr_convert() copies nothing extra
+		av_opt_set_chlayout(m_swrContext, "in_chlayout", &m_channelLayout, 0);
+		av_opt_set_chlayout(m_swrContext, "out_chlayout", &m_channelLayout, 0);
+		av_opt_set_int(m_swrContext, "in_sample_rate", inputRate, 0);
+		av_opt_set_int(m_swrContext, "out_sample_rate", m_outputRate, 0);
+		av_opt_set_sample_fmt(m_swrContext, "in_sample_fmt", AV_SAMPLE_FMT_FLTP, 0);
+		av_opt_set_sample_fmt(m_swrContext, "out_sample_fmt", AV_SAMPLE_FMT_FLTP, 0);
+		av_opt_set_sample_fmt(m_swrContext, "internal_sample_fmt", AV_SAMPLE_FMT_FLTP, 0);
+
+		Quality quality = m_quality;
+		if (!applyQuality(quality))
+		{
+			reportStatus("Warning", "Resampler quality options not supported - using defaults");
+		}
+
+		int ret = swr_init(m_swrContext);
+		if (ret < 0 && quality == Quality::BEST)
+		{
+			// No soxr in this build
+			reportStatus("Warning", "soxr resampler unavailable - using 'high' quality");
+			av_opt_set_int(m_swrContext, "resampler", SWR_ENGINE_SWR, 0);
+			quality = Quality::HIGH;
+			applyQuality(quality);
+			ret = swr_init(m_swrContext);
+		}
+		if (ret < 0)
+		{
+			char errbuf[AV_ERROR_MAX_STRING_SIZE];
+			av_strerror(ret, errbuf, sizeof(errbuf));
+			reportStatus("Error", "Failed to initialize resampler: " + std::string(errbuf));
+			swr_free(&m_swrContext);
+			m_inputRate = 0;
+			return false;
+		}
+
+		// Converting the largest input block with a full filter must fit behind the queue limit
+		const int bound = swr_get_out_samples(m_swrContext, static_cast<int>(m_maxInputFrames + FILTER_HEADROOM));
+		if (bound > 0)
+		{
+			sizeFifo(bound);
+		}
+
+		m_inputRate = inputRate;
+		reportStatus("Info", "Resampling " + std::to_string(inputRate) + " Hz to " + std::to_string(m_outputRate) + " Hz");
+		return true;
+	}
+
+	void ResamplerNode::sizeFifo(long headroom)
+	{
+		// Grows only at configuration or when a new input rate needs more room
+		const long capacity = m_bufferSize * m_maxQueueBlocks + headroom;
+		if (capacity > m_fifoCapacity)
+		{
+			for (auto &plane : m_fifo)
+			{
+				plane.resize(static_cast<size_t>(capacity));
+			}
+			m_fifoCapacity = capacity;
+		}
+	}
+
+	bool ResamplerNode::makeRoom(long frames)
+	{
+		// Move the unread audio to the front first; it is short after every emitted block
+		if (m_fifoStart > 0)
+		{
+			if (m_fifoFrames > 0)
+			{
+				for (auto &plane : m_fifo)
+				{
+					std::memmove(plane.data(), plane.data() + m_fifoStart, static_cast<size_t>(m_fifoFrames) * sizeof(float));
+				}
+			}
+			m_fifoStart = 0;
+		}
+
+		const long overflow = m_fifoFrames + frames - m_fifoCapacity;
+		if (overflow <= 0)
+		{
+			return true;
+		}
+		if (m_offlineMode || frames > m_fifoCapacity)
+		{
+			reportStatus("Error", "Input block of " + std::to_string(frames) + " frames does not fit the resampler queue");
+			return false;
+		}
+
+		// Real time: make room the way the queue limit would
+		dropOldest(overflow);
+		m_fifoStart = 0;
+		for (auto &plane : m_fifo)
+		{
+			std::memmove(plane.data(), plane.data() + overflow, static_cast<size_t>(m_fifoFrames) * sizeof(float));
+		}
+		return true;
+	}
+
+	bool ResamplerNode::convert(const uint8_t *const *input, int frames)
+	{
+		const int space = swr_get_out_samples(m_swrContext, frames);
+		if (space < 0)
+		{
+			reportStatus("Error", "Failed to size resampler output");
+			return false;
+		}
+		if (!makeRoom(space))
+		{
+			return false;
+		}
+
+		for (size_t c = 0; c < m_writePlanes.size(); c++)
+		{
+			m_writePlanes[c] = reinterpret_cast<uint8_t *>(m_fifo[c].data() + m_fifoFrames);
+		}
+
+		const int converted = swr_convert(m_swrContext, m_writePlanes.data(), space,
+										  const_cast<const uint8_t **>(input), frames);
+		if (converted < 0)
+		{
+			char errbuf[AV_ERROR_MAX_STRING_SIZE];
+			av_strerror(converted, errbuf, sizeof(errbuf));
+			reportStatus("Error", "Error resampling audio: " + std::string(errbuf));
+			return false;
+		}
+
+		m_fifoFrames += converted;
+		m_queuedFrames += converted;
+		return true;
+	}
+
+	bool ResamplerNode::append(const std::shared_ptr<AudioBuffer> &input)
+	{
+		// Input at the output rate behind audio that is still queued: keep the order
+		const long frames = input->getFrameCount();
+		if (!makeRoom(frames))
+		{
+			return false;
+		}
+		for (int c = 0; c < m_channels; c++)
+		{
+			std::memcpy(m_fifo[c].data() + m_fifoFrames, input->getPlaneData(c), static_cast<size_t>(frames) * sizeof(float));
+		}
+		m_fifoFrames += frames;
+		m_queuedFrames += frames;
+		return true;
+	}
+
+	void ResamplerNode::flush()
+	{
+		// A null input hands out what the filter still holds
+		if (m_swrContext && m_inputRate > 0)
+		{
+			convert(nullptr, 0);
+		}
+
+		if (!m_compensateDelay)
+		{
+			return;
+		}
+
+		// Trim or pad to the exact converted length of everything that came in
+		const int64_t expected = static_cast<int64_t>(std::llround(m_expectedFrames));
+		const int64_t difference = expected - m_queuedFrames;
+		if (difference < 0)
+		{
+			const long trim = static_cast<long>(std::min<int64_t>(-difference, m_fifoFrames));
+			m_fifoFrames -= trim;
+			m_queuedFrames -= trim;
+		}
+		else if (difference > 0)
+		{
+			makeRoom(0);
+			const long pad = static_cast<long>(std::min<int64_t>(difference, m_fifoCapacity - m_fifoFrames));
+			for (auto &plane : m_fifo)
+			{
+				std::fill(plane.begin() + m_fifoFrames, plane.begin() + m_fifoFrames + pad, 0.0f);
+			}
+			m_fifoFrames += pad;
+			m_queuedFrames += pad;
+		}
+	}
+
+	void ResamplerNode::dropOldest(long frames)
+	{
+		m_fifoStart += frames;
+		m_fifoFrames -= frames;
+		m_overruns.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void ResamplerNode::updateLatency()
+	{
+		const int64_t delay = m_swrContext && m_inputRate > 0 ? swr_get_delay(m_swrContext, m_outputRate) : 0;
+		m_latencyFrames.store(delay + m_fifoFrames, std::memory_order_relaxed);
+		if (!m_latencyReported && m_inputRate > 0)
+		{
+			m_latencyReported = true;
+			const int64_t latency = m_latencyFrames.load(std::memory_order_relaxed);
+			reportStatus("Info", "Resampler latency: " + std::to_string(latency) + " frames (" +
+									 std::to_string(latency * 1000.0 / m_outputRate) + " ms)");
+		}
+	}
+
+	bool ResamplerNode::render(AudioBuffer &output, long frames)
+	{
+		for (int c = 0; c < m_channels; c++)
+		{
+			std::memcpy(outputChannel(output, c), m_fifo[c].data() + m_fifoStart, static_cast<size_t>(frames) * sizeof(float));
+		}
+		m_fifoStart += frames;
+		m_fifoFrames -= frames;
+		return true;
+	}
+
+	std::shared_ptr<AudioBuffer> ResamplerNode::emitBlock(std::shared_ptr<AudioBuffer> previous, long frames)
+	{
+		// Outputs of the usual size reuse the last one
+		if (!previous || previous->getFrameCount() != frames ||
+			!AudioBuffer::prepareForWrite(previous))
+		{
+			previous = AudioBufferPool::shared().acquire(frames, m_sampleRate, m_format, m_outputLayout);
+		}
+		if (!previous)
+		{
+			reportStatus("Error", "Failed to allocate output buffer");
+			return nullptr;
+		}
+
+		render(*previous, frames);
+		previous->publish();
+		return previous;
+	}
+
+	bool ResamplerNode::process()
+	{
+		if (!m_running)
+		{
+			return false;
+		}
+
+		applyPendingReset();
+
+		std::shared_ptr<AudioBuffer> previous = std::move(m_outputBuffer);
+		m_outputBuffer.reset();
+
+		std::shared_ptr<AudioBuffer> input = std::move(m_inputs[0]);
+		const bool hasInput = input && input->getFrameCount() > 0;
+		if (hasInput)
+		{
+			const int bufferRate = static_cast<int>(std::lround(input->getSampleRate()));
+			const int rate = m_fixedInputRate > 0 ? m_fixedInputRate : (bufferRate > 0 ? bufferRate : m_outputRate);
+			const long frames = input->getFrameCount();
+
+			if (rate != m_inputRate && !(rate == m_outputRate && m_inputRate == 0))
+			{
+				// Hand out what the old rate still holds, then retune the same context
+				if (m_swrContext && m_inputRate > 0)
+				{
+					convert(nullptr, 0);
+				}
+				if (rate == m_outputRate)
+				{
+					m_inputRate = 0;
+				}
+				else if (!initResampler(rate))
+				{
+					return false;
+				}
+			}
+
+			m_expectedFrames += static_cast<double>(frames) * m_outputRate / rate;
+
+			if (m_inputRate == 0)
+			{
+				if (m_fifoFrames == 0)
+				{
+					// Already at the output rate
+					m_queuedFrames += frames;
+					m_outputBuffer = std::move(input);
+					m_bypassed = true;
+					return true;
+				}
+				if (!append(input))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				for (int c = 0; c < m_channels; c++)
+				{
+					m_readPlanes[c] = input->getPlaneData(c);
+				}
+				if (!convert(m_readPlanes.data(), static_cast<int>(frames)))
+				{
+					return false;
+				}
+			}
+			input.reset();
+
+			// Real time can't wait: drop the oldest audio once the queue is full
+			const long limit = m_bufferSize * m_maxQueueBlocks;
+			if (!m_offlineMode && m_fifoFrames > limit)
+			{
+				dropOldest(m_fifoFrames - limit);
+			}
+			updateLatency();
+		}
+		else if (m_endOfStream && !m_flushed)
+		{
+			flush();
+			m_flushed = true;
+		}
+
+		// Offline, every complete block goes out at once so the FIFO never
+		// grows; real time plays one block per cycle. Only the end of a
+		// stream may be short.
+		long frames = 0;
+		if (m_flushed)
+		{
+			frames = m_offlineMode ? m_fifoFrames : std::min(m_fifoFrames, m_bufferSize);
+		}
+		else if (m_fifoFrames >= m_bufferSize)
+		{
+			frames = m_offlineMode ? m_fifoFrames - m_fifoFrames % m_bufferSize : m_bufferSize;
+		}
+
+		m_bypassed = false;
+		if (frames > 0)
+		{
+			m_outputBuffer = emitBlock(std::move(previous), frames);
+			return m_outputBuffer != nullptr;
+		}
+
+		if (hasInput && !m_offlineMode)
+		{
+			// The resampler is still filling its delay
+			m_underruns.fetch_add(1, std::memory_order_relaxed);
+			auto silence = AudioBufferPool::shared().acquire(m_bufferSize, m_sampleRate, m_format, m_outputLayout);
+			if (silence)
+			{
+				silence->clear();
+				silence->publish();
+				m_outputBuffer = std::move(silence);
+			}
+		}
+		return true;
+	}
+
+	void ResamplerNode::resetState()
+	{
+		if (m_swrContext && m_inputRate > 0)
+		{
+			// Re-initializing drops the buffered filter state but keeps the settings
+			swr_init(m_swrContext);
+		}
+		m_fifoStart = 0;
+		m_fifoFrames = 0;
+		m_expectedFrames = 0.0;
+		m_queuedFrames = 0;
+		m_endOfStream = false;
+		m_flushed = false;
+		m_latencyFrames.store(0, std::memory_order_relaxed);
+	}
+
+} // namespace AudioEngine
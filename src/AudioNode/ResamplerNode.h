@@ -0,0 +1,151 @@
+#pragma once
+
+#include "DspNodes.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include <libswresample/swresample.h>
+}
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief Sample-rate converter ("resampler")
+	 *
+	 * Converts its input to the graph's sample rate so sources at other rates
+	 * can feed one graph. The input rate is the "input_rate" param or, if
+	 * that is 0, the sample rate carried by each input buffer; input at the
+	 * graph rate is forwarded unchanged.
+	 *
+	 * The SwrContext is kept for the life of the node and only re-initialized
+	 * when the input rate changes (the old rate is drained first). Input and
+	 * output stay planar float with a planar float internal format, so
+	 * swr_convert() reads the input planes and writes straight into the
+	 * node's FIFO with no conversion or temporary frames. The FIFO is sized
+	 * at configuration for "max_queue_blocks" plus the converted size of the
+	 * largest accepted input block (max_queue_blocks x buffer size frames)
+	 * and only grows when a new input rate needs a larger ratio.
+	 *
+	 * Output is re-blocked to the engine buffer size like a streaming
+	 * FfmpegProcessorNode: offline, nothing is emitted until a whole block is
+	 * ready and then every complete block goes out at once, so the FIFO
+	 * never holds more than one block plus one converted input; in real
+	 * time one block plays per cycle, a block the resampler hasn't filled
+	 * yet plays silence, and a FIFO that grows past "max_queue_blocks" drops
+	 * its oldest audio. The resampler delay (swr_get_delay) plus the FIFO
+	 * level is reported through getLatencyFrames() and logged once.
+	 *
+	 * At end of stream the SwrContext is flushed, so the filter delay is
+	 * emitted instead of lost. With "compensate_delay" the stream is then
+	 * trimmed or padded to exactly input frames x output rate / input rate,
+	 * so a converted file keeps its duration.
+	 *
+	 * Params:
+	 * - "input_rate": input sample rate in Hz (default 0 = from the buffers)
+	 * - "quality": "fast" (8 taps, linear interpolation), "balanced"
+	 *   (default, swresample's 32 taps), "high" (64 taps, exact rational
+	 *   ratios) or "best" (soxr very high quality, falling back to "high"
+	 *   when swresample is built without soxr)
+	 * - "compensate_delay": trim the flushed stream to the exact length
+	 *   (default true)
+	 * - "max_queue_blocks": real-time FIFO limit in blocks (default 4)
+	 */
+	class ResamplerNode : public DspNode
+	{
+	public:
+		enum class Quality
+		{
+			FAST,
+			BALANCED,
+			HIGH,
+			BEST
+		};
+
+		ResamplerNode(const std::string &name, AudioEngine *engine);
+		~ResamplerNode() override;
+
+		std::string getDspType() const override { return "resampler"; }
+		bool setParameter(const std::string &param, const std::string &value) override;
+
+		bool process() override;
+		void setOfflineMode(bool offline) override { m_offlineMode = offline; }
+		void endOfStream() override { m_endOfStream = true; }
+		bool isDrained() const override { return m_fifoFrames == 0 && (!m_endOfStream || m_flushed); }
+
+		/**
+		 * @brief Get the current latency in output frames
+		 *
+		 * @return Frames buffered in the SwrContext and the FIFO
+		 */
+		int64_t getLatencyFrames() const { return m_latencyFrames.load(std::memory_order_relaxed); }
+
+		/**
+		 * @brief Get the number of real-time blocks played as silence
+		 */
+		uint64_t getUnderruns() const { return m_underruns.load(std::memory_order_relaxed); }
+
+		/**
+		 * @brief Get the number of real-time blocks whose oldest audio was dropped
+		 */
+		uint64_t getOverruns() const { return m_overruns.load(std::memory_order_relaxed); }
+
+	protected:
+		bool configureParameters(const std::map<std::string, std::string> &params) override;
+		bool render(AudioBuffer &output, long frames) override;
+		void resetState() override;
+
+	private:
+		// Settings
+		int m_fixedInputRate = 0;
+		int m_outputRate = 0;
+		Quality m_quality = Quality::BALANCED;
+		bool m_compensateDelay = true;
+		long m_maxQueueBlocks = 4;
+		bool m_offlineMode = false;
+
+		// Resampler, created for the first input rate that differs from the output
+		SwrContext *m_swrContext = nullptr;
+		int m_inputRate = 0;
+
+		// Converted audio waiting to be re-blocked, one plane per channel
+		std::vector<std::vector<float>> m_fifo;
+		long m_fifoStart = 0;
+		long m_fifoFrames = 0;
+		long m_fifoCapacity = 0;   // Frames per plane, fixed unless a new input rate needs more
+		long m_maxInputFrames = 0; // Largest input block the FIFO is sized for
+		std::vector<uint8_t *> m_writePlanes;
+		std::vector<const uint8_t *> m_readPlanes;
+
+		// Stream length accounting for delay compensation
+		double m_expectedFrames = 0.0;
+		int64_t m_queuedFrames = 0; // Frames ever put in the FIFO (or forwarded)
+		bool m_endOfStream = false;
+		bool m_flushed = false;
+
+		std::atomic<int64_t> m_latencyFrames{0};
+		std::atomic<uint64_t> m_underruns{0};
+		std::atomic<uint64_t> m_overruns{0};
+		bool m_latencyReported = false;
+
+		// Input frames of filter state swr_get_out_samples() is asked to cover on top of a block
+		static constexpr long FILTER_HEADROOM = 1024;
+
+		static bool parseQuality(const std::string &text, Quality &quality);
+		bool initResampler(int inputRate);
+		bool applyQuality(Quality quality);
+		bool convert(const uint8_t *const *input, int frames);
+		bool append(const std::shared_ptr<AudioBuffer> &input);
+		void sizeFifo(long headroom);
+		bool makeRoom(long frames);
+		void flush();
+		void dropOldest(long frames);
+		void updateLatency();
+		std::shared_ptr<AudioBuffer> emitBlock(std::shared_ptr<AudioBuffer> previous, long frames);
+	};
+
+} // namespace AudioEngine
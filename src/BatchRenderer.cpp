@@ -0,0 +1,316 @@
+#include "BatchRenderer.h"
+#include "ConfigurationParser.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace AudioEngine
+{
+    namespace
+    {
+        // Directory part of a path, including the trailing separator
+        std::string directoryOf(const std::string &path)
+        {
+            const size_t slash = path.find_last_of("/\\");
+            return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+        }
+
+        // File name without directory and extension
+        std::string stemOf(const std::string &path)
+        {
+            const size_t slash = path.find_last_of("/\\");
+            std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+            const size_t dot = name.find_last_of('.');
+            return dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+        }
+
+        bool isAbsolute(const std::string &path)
+        {
+            return !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+        }
+
+        // Replace every ${key} in the string values of a JSON document
+        void substitute(nlohmann::json &value, const std::map<std::string, std::string> &variables)
+        {
+            if (value.is_string())
+            {
+                std::string text = value.get<std::string>();
+                for (const auto &variable : variables)
+                {
+                    const std::string placeholder = "${" + variable.first + "}";
+                    size_t pos = 0;
+                    while ((pos = text.find(placeholder, pos)) != std::string::npos)
+                    {
+                        text.replace(pos, placeholder.size(), variable.second);
+                        pos += variable.second.size();
+                    }
+                }
+                value = text;
+            }
+            else if (value.is_object() || value.is_array())
+            {
+                for (auto &element : value)
+                {
+                    substitute(element, variables);
+                }
+            }
+        }
+    }
+
+    bool BatchRenderer::loadJobFile(const std::string &filePath)
+    {
+        nlohmann::json list;
+        try
+        {
+            std::ifstream file(filePath);
+            if (!file.is_open())
+            {
+                std::cerr << "Failed to open job list: " << filePath << std::endl;
+                return false;
+            }
+            file >> list;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error reading job list " << filePath << ": " << e.what() << std::endl;
+            return false;
+        }
+
+        // Relative paths in the list are relative to the list itself
+        const std::string baseDir = directoryOf(filePath);
+        auto resolve = [&baseDir](const std::string &path)
+        {
+            return isAbsolute(path) ? path : baseDir + path;
+        };
+
+        try
+        {
+            if (!list.contains("template"))
+            {
+                std::cerr << "Job list has no 'template'" << std::endl;
+                return false;
+            }
+
+            const auto &graphTemplate = list["template"];
+            if (graphTemplate.is_string())
+            {
+                std::ifstream templateFile(resolve(graphTemplate.get<std::string>()));
+                if (!templateFile.is_open())
+                {
+                    std::cerr << "Failed to open graph template: " << graphTemplate.get<std::string>() << std::endl;
+                    return false;
+                }
+                templateFile >> m_template;
+            }
+            else
+            {
+                m_template = graphTemplate;
+            }
+
+            if (list.contains("threads"))
+                m_threads = list["threads"].get<size_t>();
+
+            if (list.contains("stopOnError"))
+                m_stopOnError = list["stopOnError"].get<bool>();
+
+            if (!list.contains("jobs") || !list["jobs"].is_array())
+            {
+                std::cerr << "Job list has no 'jobs' array" << std::endl;
+                return false;
+            }
+
+            for (const auto &entry : list["jobs"])
+            {
+                BatchJob job;
+                if (entry.contains("vars"))
+                {
+                    for (const auto &variable : entry["vars"].items())
+                    {
+                        job.variables[variable.key()] = variable.value().is_string() ? variable.value().get<std::string>()
+                                                                                     : variable.value().dump();
+                    }
+                }
+                if (entry.contains("input"))
+                    job.variables["input"] = resolve(entry["input"].get<std::string>());
+
+                if (entry.contains("output"))
+                    job.variables["output"] = resolve(entry["output"].get<std::string>());
+
+                // Every job renders a file; an input given only through "vars" counts too
+                auto input = job.variables.find("input");
+                if (input == job.variables.end() || input->second.empty())
+                {
+                    std::cerr << "Job " << m_jobs.size() << " in " << filePath << " has no 'input'" << std::endl;
+                    return false;
+                }
+
+                job.name = entry.contains("name") ? entry["name"].get<std::string>() : stemOf(input->second);
+                m_jobs.push_back(std::move(job));
+            }
+        }
+        catch (const nlohmann::json::exception &e)
+        {
+            std::cerr << "Invalid job list " << filePath << ": " << e.what() << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    size_t BatchRenderer::getEffectiveThreadCount() const
+    {
+        size_t threads = m_threads;
+        if (threads == 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        return std::max<size_t>(1, std::min(threads, m_jobs.size()));
+    }
+
+    BatchSummary BatchRenderer::run()
+    {
+        BatchSummary summary{};
+        summary.results.resize(m_jobs.size());
+        m_cancel.store(false);
+
+        const auto batchStart = std::chrono::steady_clock::now();
+
+        // Workers take the next job index until the list is exhausted
+        std::atomic<size_t> nextJob{0};
+        auto worker = [this, &nextJob, &summary]()
+        {
+            while (!m_cancel.load())
+            {
+                const size_t index = nextJob.fetch_add(1);
+                if (index >= m_jobs.size())
+                {
+                    break;
+                }
+
+                BatchJobResult &result = summary.results[index];
+                renderJob(index, result);
+                if (!result.success && m_stopOnError)
+                {
+                    m_cancel.store(true);
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        const size_t threadCount = getEffectiveThreadCount();
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            threads.emplace_back(worker);
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        summary.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStart).count();
+        for (size_t i = 0; i < summary.results.size(); i++)
+        {
+            BatchJobResult &result = summary.results[i];
+            if (!result.success && result.error.empty())
+            {
+                // Never started because the batch was cancelled
+                result.name = m_jobs[i].name;
+                result.error = "skipped";
+            }
+
+            if (result.success)
+            {
+                summary.succeeded++;
+                summary.audioSeconds += result.render.audioSeconds;
+            }
+            else
+            {
+                summary.failed++;
+            }
+        }
+        summary.realtimeFactor = summary.wallSeconds > 0.0 ? summary.audioSeconds / summary.wallSeconds : 0.0;
+        return summary;
+    }
+
+    bool BatchRenderer::buildConfiguration(size_t index, Configuration &config, std::string &error) const
+    {
+        const BatchJob &job = m_jobs[index];
+
+        std::map<std::string, std::string> variables = job.variables;
+        variables["index"] = std::to_string(index);
+        auto input = variables.find("input");
+        if (input != variables.end())
+        {
+            variables["stem"] = stemOf(input->second);
+        }
+
+        nlohmann::json graph = m_template;
+        substitute(graph, variables);
+
+        // Batch graphs are file graphs: no device, no remote control, serial per job
+        graph.erase("asioDeviceName");
+        graph.erase("targetIp");
+        graph["useAsioAutoConfig"] = false;
+        graph["audioDriver"] = "none";
+        graph["offlineRender"] = true;
+        graph["workerThreads"] = 1;
+        graph["statsInterval"] = 0;
+
+        if (!ConfigurationParser::parseJsonString(graph.dump(), config))
+        {
+            error = "invalid graph template";
+            return false;
+        }
+        return true;
+    }
+
+    void BatchRenderer::renderJob(size_t index, BatchJobResult &result)
+    {
+        result.name = m_jobs[index].name;
+        result.success = false;
+        result.render = RenderStats{};
+
+        Configuration config;
+        if (!buildConfiguration(index, config, result.error))
+        {
+            return;
+        }
+
+        AudioEngine engine;
+        if (!engine.initialize(std::move(config)))
+        {
+            result.error = "failed to build the graph";
+            engine.cleanup();
+            return;
+        }
+
+        if (!engine.run())
+        {
+            result.error = "failed to start the graph";
+            engine.cleanup();
+            return;
+        }
+
+        while (!engine.waitForRender(100))
+        {
+            if (m_cancel.load())
+            {
+                engine.stop();
+            }
+        }
+
+        // Stopping finalizes the sinks
+        engine.stop();
+        result.render = engine.getRenderStats();
+        engine.cleanup();
+
+        result.success = result.render.complete;
+        if (!result.success)
+        {
+            result.error = m_cancel.load() ? "cancelled" : "render did not complete";
+        }
+    }
+
+} // namespace AudioEngine
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "AudioEngine.h"
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief One entry of a batch job list
+	 */
+	struct BatchJob
+	{
+		std::string name;							  // Label used in reports (defaults to the input's file name)
+		std::map<std::string, std::string> variables; // ${key} substitutions for the graph template
+	};
+
+	/**
+	 * @brief Outcome of one batch job
+	 */
+	struct BatchJobResult
+	{
+		std::string name;
+		bool success;
+		std::string error; // Reason for failure
+		RenderStats render;
+	};
+
+	/**
+	 * @brief Outcome of a whole batch
+	 */
+	struct BatchSummary
+	{
+		size_t succeeded;
+		size_t failed;
+		double wallSeconds;
+		double audioSeconds;
+		double realtimeFactor; // Aggregate audio time over wall time
+		std::vector<BatchJobResult> results; // In job list order
+	};
+
+	/**
+	 * @brief Renders many file graphs concurrently
+	 *
+	 * Every job instantiates the graph template (a regular engine configuration
+	 * with ${input}, ${output}, ${stem}, ${index} and job-specific ${key}
+	 * placeholders in any string value) in its own offline AudioEngine. A fixed
+	 * pool of threads takes jobs from the list; each graph runs serially on the
+	 * thread that owns it, so the pool size bounds the cores in use. Sample
+	 * buffers come from the process-wide AudioBufferPool, so jobs reuse each
+	 * other's blocks.
+	 *
+	 * Job list format:
+	 * @code
+	 * {
+	 *   "template": "remaster.json",   // Path relative to the job list, or an inline configuration
+	 *   "threads": 0,                  // 0 = one per core
+	 *   "stopOnError": false,
+	 *   "jobs": [
+	 *     { "input": "in/a.wav", "output": "out/a.flac" },
+	 *     { "input": "in/b.wav", "output": "out/b.flac", "vars": { "gain": "-3dB" } }
+	 *   ]
+	 * }
+	 * @endcode
+	 */
+	class BatchRenderer
+	{
+	public:
+		BatchRenderer() = default;
+
+		BatchRenderer(const BatchRenderer &) = delete;
+		BatchRenderer &operator=(const BatchRenderer &) = delete;
+
+		/**
+		 * @brief Load a job list file
+		 *
+		 * @param filePath Path to the job list JSON
+		 * @return true if the list and its template were loaded
+		 */
+		bool loadJobFile(const std::string &filePath);
+
+		/**
+		 * @brief Set the graph template
+		 *
+		 * @param graphTemplate Engine configuration JSON with placeholders
+		 */
+		void setTemplate(const nlohmann::json &graphTemplate) { m_template = graphTemplate; }
+
+		/**
+		 * @brief Append a job
+		 *
+		 * @param job Job to render
+		 */
+		void addJob(const BatchJob &job) { m_jobs.push_back(job); }
+
+		/**
+		 * @brief Set the number of concurrent jobs
+		 *
+		 * @param threads Thread count (0 = one per core)
+		 */
+		void setThreadCount(size_t threads) { m_threads = threads; }
+
+		/**
+		 * @brief Skip the remaining jobs after the first failure
+		 */
+		void setStopOnError(bool stop) { m_stopOnError = stop; }
+
+		/**
+		 * @brief Render every job and wait for the batch to finish
+		 *
+		 * @return Per-job results and totals
+		 */
+		BatchSummary run();
+
+		/**
+		 * @brief Stop the running jobs and skip the rest
+		 *
+		 * Safe to call from any thread, including a signal handler's watcher.
+		 */
+		void cancel() { m_cancel.store(true); }
+
+		size_t getJobCount() const { return m_jobs.size(); }
+
+		/**
+		 * @brief Get the number of threads run() will use
+		 */
+		size_t getEffectiveThreadCount() const;
+
+	private:
+		nlohmann::json m_template;
+		std::vector<BatchJob> m_jobs;
+		size_t m_threads = 0;
+		bool m_stopOnError = false;
+		std::atomic<bool> m_cancel{false};
+
+		/**
+		 * @brief Build and render one job's graph
+		 *
+		 * @param index Position in the job list
+		 * @param result Filled with the outcome
+		 */
+		void renderJob(size_t index, BatchJobResult &result);
+
+		/**
+		 * @brief Instantiate the template for a job
+		 *
+		 * @param index Position in the job list
+		 * @param config Receives the job's engine configuration
+		 * @param error Filled with a description of the problem on failure
+		 * @return true if the configuration is usable
+		 */
+		bool buildConfiguration(size_t index, Configuration &config, std::string &error) const;
+	};
+
+} // namespace AudioEngine
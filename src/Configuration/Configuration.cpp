@@ -263,6 +263,16 @@ namespace AudioEngine
         j["useAsioAutoConfig"] = m_useAsioAutoConfig;
         j["internalFormat"] = m_internalFormat;
         j["internalLayout"] = m_internalLayout;
+        j["realtimeSafe"] = m_realtimeSafe;
+        j["workerThreads"] = m_workerThreads;
+        j["parallelMinNodes"] = m_parallelMinNodes;
+        j["statsInterval"] = m_statsInterval;
+        j["offlineRender"] = m_offlineRender;
+        j["audioDriver"] = m_audioDriver;
+        j["virtualDevice"] = {{"inputs", m_virtualInputs},
+                              {"outputs", m_virtualOutputs},
+                              {"loopback", m_virtualLoopback},
+                              {"priority", m_virtualPriority}};
 
         // OSC commands
         nlohmann::json cmds = nlohmann::json::array();
@@ -539,7 +549,7 @@ namespace AudioEngine
         }
     }
 
-    bool ConfigurationParser::autoConfigureAsio(Configuration &config, AsioManager *asioManager)
+    bool ConfigurationParser::autoConfigureAsio(Configuration &config, IAudioDriver *asioManager)
     {
         if (!asioManager || !asioManager->isInitialized())
         {
@@ -435,6 +435,139 @@ namespace AudioEngine
 		 */
 		std::string getInternalLayout() const { return m_internalLayout; }
 
+		/**
+		 * @brief Enable or disable real-time safe mode
+		 *
+		 * In real-time safe mode the audio callback never allocates, locks or
+		 * catches exceptions; status events are queued to a reporter thread.
+		 *
+		 * @param value true to enable real-time safe mode
+		 */
+		void setRealtimeSafe(bool value) { m_realtimeSafe = value; }
+
+		/**
+		 * @brief Get whether real-time safe mode is enabled
+		 *
+		 * @return true if real-time safe mode is enabled
+		 */
+		bool isRealtimeSafe() const { return m_realtimeSafe; }
+
+		/**
+		 * @brief Set the number of graph worker threads
+		 *
+		 * @param count Threads used per block including the audio thread (0 = one per core, 1 = serial)
+		 */
+		void setWorkerThreads(int count) { m_workerThreads = count; }
+
+		/**
+		 * @brief Get the number of graph worker threads
+		 *
+		 * @return Worker thread count (0 = one per core)
+		 */
+		int getWorkerThreads() const { return m_workerThreads; }
+
+		/**
+		 * @brief Set the minimum graph size for parallel execution
+		 *
+		 * @param count Graphs with fewer nodes are processed serially
+		 */
+		void setParallelMinNodes(int count) { m_parallelMinNodes = count; }
+
+		/**
+		 * @brief Get the minimum graph size for parallel execution
+		 *
+		 * @return Node count threshold
+		 */
+		int getParallelMinNodes() const { return m_parallelMinNodes; }
+
+		/**
+		 * @brief Set how often performance stats are published
+		 *
+		 * @param milliseconds Interval between /engine/stats/... updates (0 = never)
+		 */
+		void setStatsInterval(int milliseconds) { m_statsInterval = milliseconds; }
+
+		/**
+		 * @brief Get the performance stats publishing interval
+		 *
+		 * @return Interval in milliseconds (0 = disabled)
+		 */
+		int getStatsInterval() const { return m_statsInterval; }
+
+		/**
+		 * @brief Enable offline rendering for graphs without an audio device
+		 *
+		 * Offline, the file processing loop runs blocks as fast as the graph
+		 * allows instead of pacing them to the sample rate, and stops once end
+		 * of stream has propagated through every node.
+		 *
+		 * @param offline true to render offline
+		 */
+		void setOfflineRender(bool offline) { m_offlineRender = offline; }
+
+		/**
+		 * @brief Check whether offline rendering is enabled
+		 *
+		 * @return true if file graphs render faster than real time
+		 */
+		bool isOfflineRender() const { return m_offlineRender; }
+
+		/**
+		 * @brief Set the audio driver backend
+		 *
+		 * @param driver "asio" for ASIO hardware, "virtual" for the timer-clocked virtual device
+		 *               or "none" for file-only graphs without a device
+		 */
+		void setAudioDriver(const std::string &driver) { m_audioDriver = driver; }
+
+		/**
+		 * @brief Get the audio driver backend
+		 *
+		 * @return std::string "asio", "virtual" or "none"
+		 */
+		std::string getAudioDriver() const { return m_audioDriver; }
+
+		/**
+		 * @brief Check whether the virtual device drives the engine
+		 */
+		bool usesVirtualDevice() const { return m_audioDriver == "virtual"; }
+
+		/**
+		 * @brief Check whether the engine runs without any device (file graphs only)
+		 */
+		bool usesNoDevice() const { return m_audioDriver == "none"; }
+
+		/**
+		 * @brief Set the virtual device channel counts
+		 *
+		 * @param inputs Number of device input channels
+		 * @param outputs Number of device output channels
+		 */
+		void setVirtualChannels(long inputs, long outputs)
+		{
+			m_virtualInputs = inputs;
+			m_virtualOutputs = outputs;
+		}
+
+		long getVirtualInputs() const { return m_virtualInputs; }
+		long getVirtualOutputs() const { return m_virtualOutputs; }
+
+		/**
+		 * @brief Route virtual device outputs back to its inputs
+		 *
+		 * @param value true to enable loopback (one period of delay)
+		 */
+		void setVirtualLoopback(bool value) { m_virtualLoopback = value; }
+		bool isVirtualLoopback() const { return m_virtualLoopback; }
+
+		/**
+		 * @brief Set the SCHED_FIFO priority of the virtual device clock thread
+		 *
+		 * @param priority Priority (0 = normal scheduling)
+		 */
+		void setVirtualPriority(int priority) { m_virtualPriority = priority; }
+		int getVirtualPriority() const { return m_virtualPriority; }
+
 		/**
 		 * @brief Create an ASIO input node configuration
 		 *
@@ -495,6 +628,16 @@ namespace AudioEngine
 		bool m_useAsioAutoConfig = false;
 		std::string m_internalFormat = "f32";	 // Default to float
 		std::string m_internalLayout = "stereo"; // Default to stereo
+		bool m_realtimeSafe = false;			 // Audio callback avoids locks/allocations
+		int m_workerThreads = 0;				 // Graph worker threads (0 = one per core)
+		int m_parallelMinNodes = 8;				 // Smaller graphs run serially
+		int m_statsInterval = 1000;				 // Performance stats publishing interval in ms (0 = off)
+		bool m_offlineRender = false;			 // Render file graphs as fast as possible
+		std::string m_audioDriver = "asio";		 // Driver backend ("asio", "virtual" or "none")
+		long m_virtualInputs = 2;				 // Virtual device input channels
+		long m_virtualOutputs = 2;				 // Virtual device output channels
+		bool m_virtualLoopback = false;			 // Virtual device routes outputs to inputs
+		int m_virtualPriority = 0;				 // Virtual clock thread SCHED_FIFO priority
 	};
 
 	/**
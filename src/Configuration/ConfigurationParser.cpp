@@ -1,5 +1,6 @@
 #include "ConfigurationParser.h"
 #include "Configuration.h"
+#include "IAudioDriver.h"
 #include <string>
 #include <nlohmann/json.hpp>
 
@@ -102,6 +103,96 @@ const std::vector<ConfigurationParser::CommandOption> &ConfigurationParser::getC
                  return false;
              }
          }},
+        {"--realtime-safe",
+         false,
+         "Enable real-time safe audio callback (no locks, allocations or logging on the audio thread)",
+         [](Configuration &config, const std::string &)
+         {
+             config.setRealtimeSafe(true);
+             return true;
+         }},
+        {"--worker-threads",
+         true,
+         "Threads used to process the node graph (0 = one per core, 1 = serial)",
+         [](Configuration &config, const std::string &value)
+         {
+             try
+             {
+                 config.setWorkerThreads(std::stoi(value));
+                 return true;
+             }
+             catch (const std::exception &e)
+             {
+                 std::cerr << "Invalid worker thread count: " << value << std::endl;
+                 return false;
+             }
+         }},
+        {"--stats-interval",
+         true,
+         "Milliseconds between /engine/stats/... updates over external control (0 = off)",
+         [](Configuration &config, const std::string &value)
+         {
+             try
+             {
+                 config.setStatsInterval(std::stoi(value));
+                 return true;
+             }
+             catch (const std::exception &e)
+             {
+                 std::cerr << "Invalid stats interval: " << value << std::endl;
+                 return false;
+             }
+         }},
+        {"--offline",
+         false,
+         "Render file graphs as fast as possible and stop at end of stream",
+         [](Configuration &config, const std::string &)
+         {
+             config.setOfflineRender(true);
+             return true;
+         }},
+        {"--audio-driver",
+         true,
+         "Audio driver backend: asio, virtual (timer-clocked, no hardware) or none (file graphs only)",
+         [](Configuration &config, const std::string &value)
+         {
+             if (value != "asio" && value != "virtual" && value != "none")
+             {
+                 std::cerr << "Invalid audio driver: " << value << std::endl;
+                 return false;
+             }
+             config.setAudioDriver(value);
+             return true;
+         }},
+        {"--virtual-channels",
+         true,
+         "Virtual device channel counts as <inputs>,<outputs>",
+         [](Configuration &config, const std::string &value)
+         {
+             try
+             {
+                 size_t comma = value.find(',');
+                 if (comma == std::string::npos)
+                 {
+                     throw std::invalid_argument("missing ','");
+                 }
+                 config.setVirtualChannels(std::stol(value.substr(0, comma)), std::stol(value.substr(comma + 1)));
+                 return true;
+             }
+             catch (const std::exception &e)
+             {
+                 std::cerr << "Invalid virtual channel counts: " << value << std::endl;
+                 return false;
+             }
+         }},
+        {"--virtual-loopback",
+         false,
+         "Route virtual device outputs back to its inputs",
+         [](Configuration &config, const std::string &)
+         {
+             config.setVirtualLoopback(true);
+             return true;
+         }},
         {"--config",
          true,
          "Load configuration from file",
@@ -271,6 +362,34 @@ bool ConfigurationParser::parseBasicSettings(const nlohmann::json &json, Configu
     if (json.contains("internalLayout"))
         config.setInternalLayout(json["internalLayout"].get<std::string>());
 
+    if (json.contains("realtimeSafe"))
+        config.setRealtimeSafe(json["realtimeSafe"].get<bool>());
+
+    if (json.contains("workerThreads"))
+        config.setWorkerThreads(json["workerThreads"].get<int>());
+
+    if (json.contains("parallelMinNodes"))
+        config.setParallelMinNodes(json["parallelMinNodes"].get<int>());
+
+    if (json.contains("statsInterval"))
+        config.setStatsInterval(json["statsInterval"].get<int>());
+
+    if (json.contains("offlineRender"))
+        config.setOfflineRender(json["offlineRender"].get<bool>());
+
+    // Parse driver backend and virtual device settings
+    if (json.contains("audioDriver"))
+        config.setAudioDriver(json["audioDriver"].get<std::string>());
+
+    if (json.contains("virtualDevice"))
+    {
+        const auto &device = json["virtualDevice"];
+        config.setVirtualChannels(device.value("inputs", config.getVirtualInputs()),
+                                  device.value("outputs", config.getVirtualOutputs()));
+        config.setVirtualLoopback(device.value("loopback", config.isVirtualLoopback()));
+        config.setVirtualPriority(device.value("priority", config.getVirtualPriority()));
+    }
+
     return true;
 }
 
@@ -278,10 +397,10 @@ bool ConfigurationParser::parseBasicSettings(const nlohmann::json &json, Configu
  * @brief Auto-configure ASIO settings based on hardware capabilities
  *
  * @param config Configuration to update
- * @param asioManager Instance of AsioManager to query capabilities
+ * @param asioManager Audio driver (ASIO or virtual) to query capabilities
  * @return bool True if auto-configuration succeeded
  */
-bool ConfigurationParser::autoConfigureAsio(Configuration &config, AsioManager *asioManager)
+bool ConfigurationParser::autoConfigureAsio(Configuration &config, IAudioDriver *asioManager)
 {
     if (!asioManager || !asioManager->isInitialized())
     {
@@ -25,7 +25,7 @@ namespace AudioEngine
 {
     // Forward declarations
     class Configuration;
-    class AsioManager;
+    class IAudioDriver;
 
     /**
      * @brief Parser for engine configuration from different sources
@@ -68,10 +68,10 @@ namespace AudioEngine
          * @brief Auto-configure ASIO settings based on hardware capabilities
          *
          * @param config Configuration to update
-         * @param asioManager Instance of AsioManager to query capabilities
+         * @param asioManager Audio driver (ASIO or virtual) to query capabilities
          * @return bool True if auto-configuration succeeded
          */
-        static bool autoConfigureAsio(Configuration &config, AsioManager *asioManager);
+        static bool autoConfigureAsio(Configuration &config, IAudioDriver *asioManager);
 
         /**
          * @brief Parse configuration from JSON content
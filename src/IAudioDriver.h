@@ -0,0 +1,123 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief Interface for clocked audio device drivers
+	 *
+	 * A driver owns the device's double buffers and calls back once per period
+	 * with the half the engine should process, following the ASIO model: the
+	 * callback reads the inputs and writes the outputs of the given buffer index
+	 * while the device streams the other half. AsioManager implements it for
+	 * ASIO hardware and VirtualAudioDriver for hardware-free operation.
+	 *
+	 * Sample types use ASIOSampleType values (e.g. 19 = Float32LSB).
+	 */
+	class IAudioDriver
+	{
+	public:
+		/**
+		 * @brief Callback type for buffer switches
+		 *
+		 * @param doubleBufferIndex The buffer index to process (0 or 1)
+		 */
+		using AsioCallback = std::function<void(long /*doubleBufferIndex*/)>;
+
+		virtual ~IAudioDriver() = default;
+
+		/**
+		 * @brief Load a driver by device name
+		 *
+		 * @param deviceName Device name
+		 * @return true if the driver was loaded
+		 */
+		virtual bool loadDriver(const std::string &deviceName) = 0;
+
+		/**
+		 * @brief Initialize the loaded device
+		 *
+		 * @param preferredSampleRate Preferred sample rate (0 = use default)
+		 * @param preferredBufferSize Preferred buffer size (0 = use default)
+		 * @return true if initialization succeeded
+		 */
+		virtual bool initDevice(double preferredSampleRate = 0.0, long preferredBufferSize = 0) = 0;
+
+		/**
+		 * @brief Create double buffers for the specified channels
+		 *
+		 * @param inputChannels Input channel indices to activate
+		 * @param outputChannels Output channel indices to activate
+		 * @return true if buffer creation succeeded
+		 */
+		virtual bool createBuffers(const std::vector<long> &inputChannels, const std::vector<long> &outputChannels) = 0;
+
+		/**
+		 * @brief Start streaming; callbacks begin after this returns true
+		 */
+		virtual bool start() = 0;
+
+		/**
+		 * @brief Stop streaming; no callback is running once this returns
+		 */
+		virtual void stop() = 0;
+
+		/**
+		 * @brief Release buffers and unload the driver
+		 */
+		virtual void cleanup() = 0;
+
+		/**
+		 * @brief Signal that the outputs of the current block are complete
+		 */
+		virtual void outputReady() = 0;
+
+		/**
+		 * @brief Set the function called on every buffer switch
+		 *
+		 * @param callback Function to call when new buffers are available
+		 */
+		virtual void setCallback(AsioCallback callback) = 0;
+
+		/**
+		 * @brief Get buffer pointers for one half of the double buffers
+		 *
+		 * @param doubleBufferIndex Buffer index (0 or 1)
+		 * @param isInput true to resolve input channels, false for outputs
+		 * @param activeIndices Channel indices to get buffers for
+		 * @param bufferPtrs Output parameter, resized to activeIndices.size()
+		 * @return true if every channel was resolved
+		 */
+		virtual bool getBufferPointers(long doubleBufferIndex, bool isInput,
+									   const std::vector<long> &activeIndices, std::vector<void *> &bufferPtrs) = 0;
+
+		virtual long getBufferSize() const = 0;
+		virtual double getSampleRate() const = 0;
+		virtual long getSampleType() const = 0;
+		virtual long getPreferredBufferSize() const = 0;
+		virtual long getInputChannelCount() const = 0;
+		virtual long getOutputChannelCount() const = 0;
+		virtual std::vector<std::string> getInputChannelNames() const = 0;
+		virtual std::vector<std::string> getOutputChannelNames() const = 0;
+		virtual std::string getDeviceName() const = 0;
+
+		/**
+		 * @brief Get detailed device information as a JSON string
+		 */
+		virtual std::string getDeviceInfo() const = 0;
+
+		/**
+		 * @brief Get the device's default buffer size and sample rate
+		 *
+		 * @return false if the device is not initialized
+		 */
+		virtual bool getDefaultDeviceConfiguration(long &bufferSize, double &sampleRate) const = 0;
+
+		virtual bool isInitialized() const = 0;
+	};
+
+} // namespace AudioEngine
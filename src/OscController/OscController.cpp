@@ -411,6 +411,89 @@ namespace AudioEngine
 		}
 	}
 
+	bool OscController::sendBlob(const std::string &address, const std::vector<std::any> &args, const void *data, size_t size)
+	{
+		if (!m_configured || !m_oscAddress.is_valid())
+		{
+			std::cerr << "OscController: Not configured or no OSC address" << std::endl;
+			return false;
+		}
+
+		try
+		{
+			lo::Message msg;
+			msg.add_from_vector(args);
+
+			lo_blob blob = lo_blob_new(static_cast<int32_t>(size), data);
+			if (!blob)
+			{
+				return false;
+			}
+			// The message keeps its own copy of the payload
+			const int added = lo_message_add_blob(msg.get_raw(), blob);
+			lo_blob_free(blob);
+			if (added < 0)
+			{
+				return false;
+			}
+
+			if (m_oscAddress.send(address, msg) < 0)
+			{
+				std::cerr << "OscController: Failed to send OSC blob to " << address << ": "
+						  << m_oscAddress.errstr() << std::endl;
+				return false;
+			}
+			return true;
+		}
+		catch (const std::exception &e)
+		{
+			std::cerr << "OscController: Exception while sending OSC blob: " << e.what() << std::endl;
+			return false;
+		}
+	}
+
+	bool OscController::sendBundle(const std::vector<std::pair<std::string, std::vector<std::any>>> &messages)
+	{
+		if (!m_configured || !m_oscAddress.is_valid())
+		{
+			std::cerr << "OscController: Not configured or no OSC address" << std::endl;
+			return false;
+		}
+
+		try
+		{
+			// The bundle only references the messages; they are freed with the vector
+			std::vector<std::unique_ptr<lo::Message>> contents;
+			contents.reserve(messages.size());
+			lo_bundle bundle = lo_bundle_new(LO_TT_IMMEDIATE);
+			if (!bundle)
+			{
+				return false;
+			}
+
+			for (const auto &[path, args] : messages)
+			{
+				contents.push_back(std::make_unique<lo::Message>());
+				contents.back()->add_from_vector(args);
+				lo_bundle_add_message(bundle, path.c_str(), contents.back()->get_raw());
+			}
+
+			const int result = lo_send_bundle(m_oscAddress.get_raw(), bundle);
+			lo_bundle_free(bundle);
+			if (result < 0)
+			{
+				std::cerr << "OscController: Failed to send OSC bundle: " << m_oscAddress.errstr() << std::endl;
+				return false;
+			}
+			return true;
+		}
+		catch (const std::exception &e)
+		{
+			std::cerr << "OscController: Exception while sending OSC bundle: " << e.what() << std::endl;
+			return false;
+		}
+	}
+
 	bool OscController::getParameter(const std::string &address,
 									 std::function<void(bool, const std::vector<std::any> &)> callback)
 	{
@@ -104,6 +104,27 @@ namespace AudioEngine
 		bool queryParameter(const std::string &address,
 							std::function<void(bool, const std::vector<std::any> &)> callback) override;
 
+		/**
+		 * @brief Send a message whose last argument is a blob
+		 *
+		 * @param address OSC address
+		 * @param args Arguments preceding the blob
+		 * @param data Blob payload
+		 * @param size Payload size in bytes
+		 * @return true if the message was sent
+		 */
+		bool sendBlob(const std::string &address, const std::vector<std::any> &args, const void *data, size_t size);
+
+		/**
+		 * @brief Send several messages as one bundle
+		 *
+		 * The bundle goes out as a single datagram, so keep it below the path MTU.
+		 *
+		 * @param messages Address and arguments of each message
+		 * @return true if the bundle was sent
+		 */
+		bool sendBundle(const std::vector<std::pair<std::string, std::vector<std::any>>> &messages);
+
 		// Additional OSC-specific methods
 
 		/**
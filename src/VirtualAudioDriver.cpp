@@ -0,0 +1,451 @@
+#include "VirtualAudioDriver.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <nlohmann/json.hpp>
+
+#ifdef __linux__
+#include <cerrno>
+#include <ctime>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace AudioEngine
+{
+
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Sleep until an absolute steady_clock deadline
+         *
+         * On Linux steady_clock is CLOCK_MONOTONIC, so clock_nanosleep with an
+         * absolute time avoids the extra rounding of sleep_until.
+         */
+        void sleepUntil(Clock::time_point deadline)
+        {
+#ifdef __linux__
+            const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+            timespec ts;
+            ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+            ts.tv_nsec = static_cast<long>(ns % 1000000000);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+            {
+            }
+#else
+            std::this_thread::sleep_until(deadline);
+#endif
+        }
+
+        size_t histogramBin(int64_t latencyNs)
+        {
+            uint64_t us = static_cast<uint64_t>(latencyNs / 1000);
+            size_t bin = 0;
+            while (us != 0 && bin < VirtualAudioDriver::HISTOGRAM_BINS - 1)
+            {
+                us >>= 1;
+                bin++;
+            }
+            return bin;
+        }
+    } // namespace
+
+    VirtualAudioDriver::VirtualAudioDriver()
+        : VirtualAudioDriver(Options())
+    {
+    }
+
+    VirtualAudioDriver::VirtualAudioDriver(const Options &options)
+        : m_options(options)
+    {
+        m_options.inputChannels = std::max(0L, m_options.inputChannels);
+        m_options.outputChannels = std::max(0L, m_options.outputChannels);
+        resetTimingStats();
+    }
+
+    VirtualAudioDriver::~VirtualAudioDriver()
+    {
+        cleanup();
+    }
+
+    bool VirtualAudioDriver::loadDriver(const std::string &deviceName)
+    {
+        m_deviceName = deviceName.empty() ? "Virtual Audio Device" : deviceName;
+        return true;
+    }
+
+    bool VirtualAudioDriver::initDevice(double preferredSampleRate, long preferredBufferSize)
+    {
+        if (m_running.load())
+        {
+            std::cerr << "Cannot initialize virtual device while streaming" << std::endl;
+            return false;
+        }
+
+        if (m_deviceName.empty())
+        {
+            loadDriver("");
+        }
+
+        m_sampleRate = preferredSampleRate > 0.0 ? preferredSampleRate : DEFAULT_SAMPLE_RATE;
+        m_bufferSize = preferredBufferSize > 0 ? preferredBufferSize : DEFAULT_BUFFER_SIZE;
+        m_initialized = true;
+
+        std::cout << "Virtual device initialized: " << m_sampleRate << " Hz, " << m_bufferSize << " samples, "
+                  << m_options.inputChannels << " in / " << m_options.outputChannels << " out"
+                  << (m_options.loopback ? ", loopback" : "") << std::endl;
+        return true;
+    }
+
+    bool VirtualAudioDriver::createBuffers(const std::vector<long> &inputChannels, const std::vector<long> &outputChannels)
+    {
+        if (!m_initialized)
+        {
+            std::cerr << "Virtual device not initialized" << std::endl;
+            return false;
+        }
+
+        if (m_running.load())
+        {
+            std::cerr << "Cannot create buffers while streaming" << std::endl;
+            return false;
+        }
+
+        m_activeInputs.assign(m_options.inputChannels, false);
+        m_activeOutputs.assign(m_options.outputChannels, false);
+
+        for (long channel : inputChannels)
+        {
+            if (channel < 0 || channel >= m_options.inputChannels)
+            {
+                std::cerr << "Invalid virtual input channel: " << channel << std::endl;
+                return false;
+            }
+            m_activeInputs[channel] = true;
+        }
+
+        for (long channel : outputChannels)
+        {
+            if (channel < 0 || channel >= m_options.outputChannels)
+            {
+                std::cerr << "Invalid virtual output channel: " << channel << std::endl;
+                return false;
+            }
+            m_activeOutputs[channel] = true;
+        }
+
+        // Every channel gets storage so loopback works for inactive outputs too
+        const size_t channels = static_cast<size_t>(m_options.inputChannels + m_options.outputChannels);
+        m_storage.assign(channels * 2 * static_cast<size_t>(m_bufferSize), 0.0f);
+        m_buffersCreated = true;
+        return true;
+    }
+
+    float *VirtualAudioDriver::channelBuffer(bool isInput, long channel, long doubleBufferIndex)
+    {
+        const long slot = isInput ? channel : m_options.inputChannels + channel;
+        return m_storage.data() + (static_cast<size_t>(slot) * 2 + static_cast<size_t>(doubleBufferIndex)) * m_bufferSize;
+    }
+
+    bool VirtualAudioDriver::start()
+    {
+        if (!m_buffersCreated)
+        {
+            std::cerr << "Virtual device buffers not created" << std::endl;
+            return false;
+        }
+
+        if (m_running.load())
+        {
+            return true;
+        }
+
+        resetTimingStats();
+        m_stopRequested.store(false);
+        m_running.store(true);
+
+        try
+        {
+            m_clockThread = std::thread(&VirtualAudioDriver::runClock, this);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Failed to start virtual device clock: " << e.what() << std::endl;
+            m_running.store(false);
+            return false;
+        }
+
+        return true;
+    }
+
+    void VirtualAudioDriver::stop()
+    {
+        if (!m_running.load())
+        {
+            return;
+        }
+
+        // The clock thread finishes its current period, at most one buffer away
+        m_stopRequested.store(true, std::memory_order_release);
+        if (m_clockThread.joinable())
+        {
+            m_clockThread.join();
+        }
+        m_running.store(false);
+    }
+
+    void VirtualAudioDriver::cleanup()
+    {
+        stop();
+        m_storage.clear();
+        m_storage.shrink_to_fit();
+        m_activeInputs.clear();
+        m_activeOutputs.clear();
+        m_buffersCreated = false;
+        m_initialized = false;
+    }
+
+    void VirtualAudioDriver::setCallback(AsioCallback callback)
+    {
+        if (m_running.load())
+        {
+            std::cerr << "Cannot change the virtual device callback while streaming" << std::endl;
+            return;
+        }
+        m_callback = std::move(callback);
+    }
+
+    bool VirtualAudioDriver::getBufferPointers(long doubleBufferIndex, bool isInput,
+                                               const std::vector<long> &activeIndices, std::vector<void *> &bufferPtrs)
+    {
+        if (!m_buffersCreated || doubleBufferIndex < 0 || doubleBufferIndex > 1)
+        {
+            return false;
+        }
+
+        const std::vector<bool> &active = isInput ? m_activeInputs : m_activeOutputs;
+
+        // Called on the clock thread every block; resize is a no-op after the first call
+        bufferPtrs.resize(activeIndices.size());
+        for (size_t i = 0; i < activeIndices.size(); i++)
+        {
+            const long channel = activeIndices[i];
+            if (channel < 0 || channel >= static_cast<long>(active.size()) || !active[channel])
+            {
+                return false;
+            }
+            bufferPtrs[i] = channelBuffer(isInput, channel, doubleBufferIndex);
+        }
+
+        return true;
+    }
+
+    std::vector<std::string> VirtualAudioDriver::getInputChannelNames() const
+    {
+        std::vector<std::string> names;
+        for (long i = 0; i < m_options.inputChannels; i++)
+        {
+            names.push_back("Virtual In " + std::to_string(i + 1));
+        }
+        return names;
+    }
+
+    std::vector<std::string> VirtualAudioDriver::getOutputChannelNames() const
+    {
+        std::vector<std::string> names;
+        for (long i = 0; i < m_options.outputChannels; i++)
+        {
+            names.push_back("Virtual Out " + std::to_string(i + 1));
+        }
+        return names;
+    }
+
+    bool VirtualAudioDriver::getDefaultDeviceConfiguration(long &bufferSize, double &sampleRate) const
+    {
+        if (!m_initialized)
+        {
+            return false;
+        }
+
+        bufferSize = DEFAULT_BUFFER_SIZE;
+        sampleRate = DEFAULT_SAMPLE_RATE;
+        return true;
+    }
+
+    std::string VirtualAudioDriver::getDeviceInfo() const
+    {
+        if (!m_initialized)
+        {
+            return "{}";
+        }
+
+        nlohmann::json info;
+        info["name"] = m_deviceName;
+        info["inputChannels"] = m_options.inputChannels;
+        info["outputChannels"] = m_options.outputChannels;
+        info["loopback"] = m_options.loopback;
+        info["currentBufferSize"] = m_bufferSize;
+        info["currentSampleRate"] = m_sampleRate;
+        info["sampleType"] = "Float32LSB";
+        info["inputChannelNames"] = getInputChannelNames();
+        info["outputChannelNames"] = getOutputChannelNames();
+
+        const TimingStats stats = getTimingStats();
+        nlohmann::json timing;
+        timing["callbacks"] = stats.callbacks;
+        timing["overruns"] = stats.overruns;
+        timing["missedPeriods"] = stats.missedPeriods;
+        timing["periodUs"] = stats.periodUs;
+        timing["wakeLatencyMinUs"] = stats.wakeLatencyMinUs;
+        timing["wakeLatencyMaxUs"] = stats.wakeLatencyMaxUs;
+        timing["wakeLatencyMeanUs"] = stats.wakeLatencyMeanUs;
+        timing["callbackMinUs"] = stats.callbackMinUs;
+        timing["callbackMaxUs"] = stats.callbackMaxUs;
+        timing["callbackMeanUs"] = stats.callbackMeanUs;
+        timing["realtimeScheduling"] = stats.realtimeScheduling;
+        timing["wakeLatencyHistogram"] = stats.wakeLatencyHistogram;
+        info["timing"] = timing;
+
+        return info.dump(2);
+    }
+
+    VirtualAudioDriver::TimingStats VirtualAudioDriver::getTimingStats() const
+    {
+        TimingStats stats{};
+        stats.callbacks = m_callbacks.load(std::memory_order_relaxed);
+        stats.overruns = m_overruns.load(std::memory_order_relaxed);
+        stats.missedPeriods = m_missedPeriods.load(std::memory_order_relaxed);
+        stats.periodUs = m_sampleRate > 0.0 ? m_bufferSize * 1e6 / m_sampleRate : 0.0;
+        stats.realtimeScheduling = m_realtimeScheduling.load(std::memory_order_relaxed);
+
+        if (stats.callbacks > 0)
+        {
+            const double count = static_cast<double>(stats.callbacks);
+            stats.wakeLatencyMinUs = m_wakeLatencyMinNs.load(std::memory_order_relaxed) / 1000.0;
+            stats.wakeLatencyMaxUs = m_wakeLatencyMaxNs.load(std::memory_order_relaxed) / 1000.0;
+            stats.wakeLatencyMeanUs = m_wakeLatencySumNs.load(std::memory_order_relaxed) / count / 1000.0;
+            stats.callbackMinUs = m_callbackMinNs.load(std::memory_order_relaxed) / 1000.0;
+            stats.callbackMaxUs = m_callbackMaxNs.load(std::memory_order_relaxed) / 1000.0;
+            stats.callbackMeanUs = m_callbackSumNs.load(std::memory_order_relaxed) / count / 1000.0;
+        }
+
+        for (size_t i = 0; i < HISTOGRAM_BINS; i++)
+        {
+            stats.wakeLatencyHistogram[i] = m_histogram[i].load(std::memory_order_relaxed);
+        }
+
+        return stats;
+    }
+
+    void VirtualAudioDriver::resetTimingStats()
+    {
+        m_callbacks.store(0, std::memory_order_relaxed);
+        m_overruns.store(0, std::memory_order_relaxed);
+        m_missedPeriods.store(0, std::memory_order_relaxed);
+        m_wakeLatencyMinNs.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+        m_wakeLatencyMaxNs.store(0, std::memory_order_relaxed);
+        m_wakeLatencySumNs.store(0, std::memory_order_relaxed);
+        m_callbackMinNs.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+        m_callbackMaxNs.store(0, std::memory_order_relaxed);
+        m_callbackSumNs.store(0, std::memory_order_relaxed);
+        for (auto &bin : m_histogram)
+        {
+            bin.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void VirtualAudioDriver::recordPeriod(int64_t wakeLatencyNs, int64_t callbackNs)
+    {
+        // Single writer: plain load/store pairs are enough
+        if (wakeLatencyNs < m_wakeLatencyMinNs.load(std::memory_order_relaxed))
+            m_wakeLatencyMinNs.store(wakeLatencyNs, std::memory_order_relaxed);
+        if (wakeLatencyNs > m_wakeLatencyMaxNs.load(std::memory_order_relaxed))
+            m_wakeLatencyMaxNs.store(wakeLatencyNs, std::memory_order_relaxed);
+        if (callbackNs < m_callbackMinNs.load(std::memory_order_relaxed))
+            m_callbackMinNs.store(callbackNs, std::memory_order_relaxed);
+        if (callbackNs > m_callbackMaxNs.load(std::memory_order_relaxed))
+            m_callbackMaxNs.store(callbackNs, std::memory_order_relaxed);
+
+        m_wakeLatencySumNs.store(m_wakeLatencySumNs.load(std::memory_order_relaxed) + wakeLatencyNs, std::memory_order_relaxed);
+        m_callbackSumNs.store(m_callbackSumNs.load(std::memory_order_relaxed) + callbackNs, std::memory_order_relaxed);
+
+        auto &bin = m_histogram[histogramBin(wakeLatencyNs)];
+        bin.store(bin.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_callbacks.store(m_callbacks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void VirtualAudioDriver::runClock()
+    {
+#ifdef __linux__
+        if (m_options.realtimePriority > 0)
+        {
+            sched_param param{};
+            param.sched_priority = std::min(m_options.realtimePriority, sched_get_priority_max(SCHED_FIFO));
+            m_realtimeScheduling.store(pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0);
+        }
+#endif
+
+        const double periodNs = m_bufferSize * 1e9 / m_sampleRate;
+        const long loopbackChannels = m_options.loopback ? std::min(m_options.inputChannels, m_options.outputChannels) : 0;
+        const size_t blockBytes = static_cast<size_t>(m_bufferSize) * sizeof(float);
+
+        // Deadlines are derived from the block count, so rounding never accumulates
+        auto deadlineOf = [&](uint64_t block)
+        {
+            return std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(block) * periodNs));
+        };
+
+        const Clock::time_point origin = Clock::now();
+        uint64_t block = 0;
+        long index = 0;
+
+        while (!m_stopRequested.load(std::memory_order_acquire))
+        {
+            block++;
+            const Clock::time_point deadline = origin + deadlineOf(block);
+            sleepUntil(deadline);
+
+            if (m_stopRequested.load(std::memory_order_acquire))
+            {
+                break;
+            }
+
+            const Clock::time_point wake = Clock::now();
+            const int64_t wakeLatencyNs = std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(wake - deadline).count());
+
+            // A whole period was lost; skip ahead instead of running a catch-up burst
+            if (wakeLatencyNs >= periodNs)
+            {
+                const uint64_t skipped = static_cast<uint64_t>(wakeLatencyNs / periodNs);
+                m_missedPeriods.store(m_missedPeriods.load(std::memory_order_relaxed) + skipped, std::memory_order_relaxed);
+                block += skipped;
+            }
+
+            if (m_callback)
+            {
+                m_callback(index);
+            }
+
+            const Clock::time_point done = Clock::now();
+            if (done > origin + deadlineOf(block + 1))
+            {
+                m_overruns.store(m_overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+
+            recordPeriod(wakeLatencyNs, std::chrono::duration_cast<std::chrono::nanoseconds>(done - wake).count());
+
+            // What was just written comes back on the inputs of the next block
+            for (long channel = 0; channel < loopbackChannels; channel++)
+            {
+                std::memcpy(channelBuffer(true, channel, index ^ 1), channelBuffer(false, channel, index), blockBytes);
+            }
+
+            index ^= 1;
+        }
+    }
+
+} // namespace AudioEngine
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "IAudioDriver.h"
+
+namespace AudioEngine
+{
+
+	/**
+	 * @brief Hardware-free audio device clocked by a high-resolution timer
+	 *
+	 * Calls the buffer switch callback once per period (bufferSize / sampleRate)
+	 * from its own thread, alternating the double buffer index like an ASIO
+	 * driver. Deadlines are absolute, so timer jitter does not accumulate into
+	 * drift; periods missed entirely are skipped and counted rather than
+	 * replayed in a burst.
+	 *
+	 * Buffers are Float32LSB. Inputs read silence unless loopback is enabled, in
+	 * which case output channel N is delivered to input channel N one period
+	 * later, the way a cable between the device's ports would.
+	 *
+	 * Wake-up lateness and callback duration are recorded for benchmarking the
+	 * graph's real-time behavior without audio hardware.
+	 */
+	class VirtualAudioDriver : public IAudioDriver
+	{
+	public:
+		/**
+		 * @brief Device shape and clock thread settings
+		 */
+		struct Options
+		{
+			long inputChannels = 2;	  // Number of device input channels
+			long outputChannels = 2;  // Number of device output channels
+			bool loopback = false;	  // Route outputs to inputs with one period of delay
+			int realtimePriority = 0; // SCHED_FIFO priority of the clock thread (0 = normal scheduling)
+		};
+
+		static constexpr size_t HISTOGRAM_BINS = 16;
+
+		/**
+		 * @brief Clock timing counters
+		 *
+		 * Wake-up latency is how late the clock thread woke relative to the
+		 * period deadline. Histogram bin 0 counts wake-ups under 1 us; bin i
+		 * counts [2^(i-1), 2^i) us, and the last bin everything above.
+		 */
+		struct TimingStats
+		{
+			uint64_t callbacks;		// Buffer switches delivered
+			uint64_t overruns;		// Callbacks that finished after the next deadline
+			uint64_t missedPeriods; // Periods skipped because the clock thread woke too late
+			double periodUs;		// Nominal period length
+			double wakeLatencyMinUs;
+			double wakeLatencyMaxUs;
+			double wakeLatencyMeanUs;
+			double callbackMinUs;
+			double callbackMaxUs;
+			double callbackMeanUs;
+			bool realtimeScheduling; // Clock thread runs with SCHED_FIFO
+			std::array<uint64_t, HISTOGRAM_BINS> wakeLatencyHistogram;
+		};
+
+		/**
+		 * @brief Float32LSB in ASIOSampleType numbering
+		 */
+		static constexpr long SAMPLE_TYPE_FLOAT32_LSB = 19;
+
+		static constexpr double DEFAULT_SAMPLE_RATE = 48000.0;
+		static constexpr long DEFAULT_BUFFER_SIZE = 256;
+
+		VirtualAudioDriver();
+		explicit VirtualAudioDriver(const Options &options);
+		~VirtualAudioDriver() override;
+
+		VirtualAudioDriver(const VirtualAudioDriver &) = delete;
+		VirtualAudioDriver &operator=(const VirtualAudioDriver &) = delete;
+
+		bool loadDriver(const std::string &deviceName) override;
+		bool initDevice(double preferredSampleRate = 0.0, long preferredBufferSize = 0) override;
+		bool createBuffers(const std::vector<long> &inputChannels, const std::vector<long> &outputChannels) override;
+		bool start() override;
+		void stop() override;
+		void cleanup() override;
+		void outputReady() override {}
+		void setCallback(AsioCallback callback) override;
+		bool getBufferPointers(long doubleBufferIndex, bool isInput,
+							   const std::vector<long> &activeIndices, std::vector<void *> &bufferPtrs) override;
+
+		long getBufferSize() const override { return m_bufferSize; }
+		double getSampleRate() const override { return m_sampleRate; }
+		long getSampleType() const override { return SAMPLE_TYPE_FLOAT32_LSB; }
+		long getPreferredBufferSize() const override { return DEFAULT_BUFFER_SIZE; }
+		long getInputChannelCount() const override { return m_options.inputChannels; }
+		long getOutputChannelCount() const override { return m_options.outputChannels; }
+		std::vector<std::string> getInputChannelNames() const override;
+		std::vector<std::string> getOutputChannelNames() const override;
+		std::string getDeviceName() const override { return m_deviceName; }
+		std::string getDeviceInfo() const override;
+		bool getDefaultDeviceConfiguration(long &bufferSize, double &sampleRate) const override;
+		bool isInitialized() const override { return m_initialized; }
+
+		/**
+		 * @brief Get the clock timing counters
+		 *
+		 * Safe to call while streaming; values are read without locking.
+		 *
+		 * @return Snapshot of the counters
+		 */
+		TimingStats getTimingStats() const;
+
+		/**
+		 * @brief Reset the clock timing counters
+		 */
+		void resetTimingStats();
+
+		/**
+		 * @brief Get the options the device was created with
+		 */
+		const Options &getOptions() const { return m_options; }
+
+	private:
+		/**
+		 * @brief Clock thread body
+		 */
+		void runClock();
+
+		/**
+		 * @brief Record the timing of one period
+		 */
+		void recordPeriod(int64_t wakeLatencyNs, int64_t callbackNs);
+
+		float *channelBuffer(bool isInput, long channel, long doubleBufferIndex);
+
+		Options m_options;
+		std::string m_deviceName;
+		bool m_initialized = false;
+		bool m_buffersCreated = false;
+		double m_sampleRate = 0.0;
+		long m_bufferSize = 0;
+
+		// One slab holding both halves of every input then every output channel
+		std::vector<float> m_storage;
+		std::vector<bool> m_activeInputs;
+		std::vector<bool> m_activeOutputs;
+
+		AsioCallback m_callback;
+		std::thread m_clockThread;
+		std::atomic<bool> m_running{false};
+		std::atomic<bool> m_stopRequested{false};
+
+		// Written by the clock thread only
+		std::atomic<uint64_t> m_callbacks{0};
+		std::atomic<uint64_t> m_overruns{0};
+		std::atomic<uint64_t> m_missedPeriods{0};
+		std::atomic<int64_t> m_wakeLatencyMinNs{0};
+		std::atomic<int64_t> m_wakeLatencyMaxNs{0};
+		std::atomic<int64_t> m_wakeLatencySumNs{0};
+		std::atomic<int64_t> m_callbackMinNs{0};
+		std::atomic<int64_t> m_callbackMaxNs{0};
+		std::atomic<int64_t> m_callbackSumNs{0};
+		std::atomic<bool> m_realtimeScheduling{false};
+		std::array<std::atomic<uint64_t>, HISTOGRAM_BINS> m_histogram{};
+	};
+
+} // namespace AudioEngine
@@ -0,0 +1,120 @@
+/**
+ * @file audioEngine_batch.cpp
+ * @brief Batch front-end: renders a job list of file graphs on all cores
+ *
+ * Each job instantiates a graph template (a regular engine configuration with
+ * ${input}/${output}/${stem}/${index} placeholders) and renders it offline;
+ * jobs run concurrently on a thread pool. See BatchRenderer.h for the job
+ * list format.
+ *
+ * Usage: audioEngine_batch <jobs.json> [--threads N] [--stop-on-error]
+ */
+
+#include "BatchRenderer.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace
+{
+	std::atomic<bool> g_shutdown_requested(false);
+
+	void signal_handler(int)
+	{
+		g_shutdown_requested.store(true);
+	}
+
+	void printUsage(const char *program)
+	{
+		std::cerr << "Usage: " << program << " <jobs.json> [--threads N] [--stop-on-error]\n";
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2)
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	AudioEngine::BatchRenderer renderer;
+	if (!renderer.loadJobFile(argv[1]))
+	{
+		return 1;
+	}
+
+	// Command line options override the job list
+	for (int i = 2; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc)
+		{
+			try
+			{
+				renderer.setThreadCount(static_cast<size_t>(std::stoul(argv[++i])));
+			}
+			catch (const std::exception &)
+			{
+				std::cerr << "Invalid thread count: " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--stop-on-error")
+		{
+			renderer.setStopOnError(true);
+		}
+		else
+		{
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	signal(SIGINT, signal_handler);
+	signal(SIGTERM, signal_handler);
+
+	std::cout << "Rendering " << renderer.getJobCount() << " job(s) on "
+			  << renderer.getEffectiveThreadCount() << " thread(s)\n";
+
+	// The handler only sets a flag; cancelling happens on a normal thread
+	std::atomic<bool> finished(false);
+	std::thread watcher([&]()
+						{
+		while (!finished.load())
+		{
+			if (g_shutdown_requested.load())
+			{
+				renderer.cancel();
+				break;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		} });
+
+	const AudioEngine::BatchSummary summary = renderer.run();
+	finished.store(true);
+	watcher.join();
+
+	std::cout << "\n";
+	for (const auto &result : summary.results)
+	{
+		if (result.success)
+		{
+			std::printf("  ok    %-40s %9.2f s audio %8.2f s %8.1fx\n", result.name.c_str(),
+						result.render.audioSeconds, result.render.wallSeconds, result.render.realtimeFactor);
+		}
+		else
+		{
+			std::printf("  FAIL  %-40s %s\n", result.name.c_str(), result.error.c_str());
+		}
+	}
+
+	std::printf("\n%zu succeeded, %zu failed; %.2f s of audio in %.2f s (%.1fx real time)\n",
+				summary.succeeded, summary.failed, summary.audioSeconds, summary.wallSeconds, summary.realtimeFactor);
+
+	return summary.failed == 0 ? 0 : 1;
+}
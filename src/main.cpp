@@ -191,6 +191,8 @@ int main(int argc, char *argv[])
 			config.setAsioDeviceName(asioDevice);
 		}
 
+		const bool offlineRender = config.isOfflineRender();
+
 		// Initialize the engine
 		if (!engine.initialize(std::move(config)))
 		{
@@ -202,6 +204,25 @@ int main(int argc, char *argv[])
 		// Start the engine
 		engine.run();
 
+		// Offline renders run to the end of their inputs and exit
+		if (offlineRender)
+		{
+			while (!engine.waitForRender(200))
+			{
+				if (g_shutdown_requested.load())
+				{
+					engine.stop();
+				}
+			}
+			engine.stop();
+
+			const AudioEngine::RenderStats stats = engine.getRenderStats();
+			std::cout << "Rendered " << stats.audioSeconds << " s of audio in " << stats.wallSeconds
+					  << " s (" << stats.realtimeFactor << "x real time)\n";
+			engine.cleanup();
+			return stats.complete ? 0 : 1;
+		}
+
 		std::cout << "Engine running. Press Ctrl+C to stop.\n";
 
 		// Set up command processing map for console commands
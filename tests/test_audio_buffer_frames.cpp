@@ -0,0 +1,123 @@
+#include <iostream>
+#include <cassert>
+#include <memory>
+#include "AudioBuffer.h"
+
+extern "C"
+{
+#include <libavutil/frame.h>
+}
+
+// Tests for passing AudioBuffers to and from FFmpeg frames without copying
+
+using AudioEngine::AudioBuffer;
+
+namespace
+{
+    // A published planar float buffer whose samples identify their channel
+    std::shared_ptr<AudioBuffer> makeBuffer(int channels, long frames)
+    {
+        AVChannelLayout layout;
+        av_channel_layout_default(&layout, channels);
+        auto buffer = AudioBuffer::createBuffer(frames, 48000, AV_SAMPLE_FMT_FLTP, layout);
+        av_channel_layout_uninit(&layout);
+        assert(buffer);
+        for (int ch = 0; ch < channels; ch++)
+        {
+            float *samples = reinterpret_cast<float *>(buffer->getPlaneData(ch));
+            for (long i = 0; i < frames; i++)
+            {
+                samples[i] = static_cast<float>(ch);
+            }
+        }
+        buffer->publish();
+        return buffer;
+    }
+}
+
+// Test that every plane gets its own reference, including planes in extended_buf
+void test_attach_planes()
+{
+    std::cout << "Testing per-plane references..." << std::endl;
+
+    const int channels = AV_NUM_DATA_POINTERS + 4;
+    auto buffer = makeBuffer(channels, 256);
+    AVFrame *frame = av_frame_alloc();
+
+    // Unpublished buffers are refused
+    AVChannelLayout layout;
+    av_channel_layout_default(&layout, 2);
+    auto unpublished = AudioBuffer::createBuffer(256, 48000, AV_SAMPLE_FMT_FLTP, layout);
+    av_channel_layout_uninit(&layout);
+    assert(!AudioBuffer::attachToAVFrame(unpublished, frame));
+
+    assert(AudioBuffer::attachToAVFrame(buffer, frame));
+    assert(frame->nb_samples == 256);
+    assert(frame->nb_extended_buf == channels - AV_NUM_DATA_POINTERS);
+    for (int ch = 0; ch < channels; ch++)
+    {
+        AVBufferRef *ref = ch < AV_NUM_DATA_POINTERS ? frame->buf[ch] : frame->extended_buf[ch - AV_NUM_DATA_POINTERS];
+        assert(ref);
+        assert(ref->data == buffer->getPlaneData(ch));
+        assert(frame->extended_data[ch] == buffer->getPlaneData(ch));
+        assert(!av_buffer_is_writable(ref));
+    }
+    assert(buffer.use_count() == 1 + channels);
+
+    // A clone shares the references, and the data stays valid after our handle goes
+    AVFrame *clone = av_frame_clone(frame);
+    assert(clone);
+    av_frame_unref(frame);
+    const uint8_t *last = buffer->getPlaneData(channels - 1);
+    buffer.reset();
+    assert(clone->extended_data[channels - 1] == last);
+    assert(reinterpret_cast<const float *>(clone->extended_data[channels - 1])[255] == channels - 1);
+
+    av_frame_free(&clone);
+    av_frame_free(&frame);
+    std::cout << "Per-plane reference tests passed." << std::endl;
+}
+
+// Test that a buffer wrapping an AVFrame hands out that frame's own references
+void test_attach_wrapped()
+{
+    std::cout << "Testing wrapped frames..." << std::endl;
+
+    AVFrame *source = av_frame_alloc();
+    source->nb_samples = 128;
+    source->format = AV_SAMPLE_FMT_FLTP;
+    source->sample_rate = 48000;
+    av_channel_layout_default(&source->ch_layout, 2);
+    assert(av_frame_get_buffer(source, 0) >= 0);
+    AVBufferRef *original = source->buf[0];
+
+    auto wrapped = AudioBuffer::wrapAVFrame(source);
+    assert(wrapped);
+    assert(!source->buf[0]);
+
+    AVFrame *frame = av_frame_alloc();
+    assert(AudioBuffer::attachToAVFrame(wrapped, frame));
+    assert(frame->buf[0] && frame->buf[0]->buffer == original->buffer);
+    assert(frame->extended_data[1] == wrapped->getPlaneData(1));
+    assert(frame->nb_samples == 128);
+
+    // The frame outlives the wrapper
+    wrapped.reset();
+    assert(av_buffer_get_ref_count(frame->buf[0]) == 1);
+
+    av_frame_free(&frame);
+    av_frame_free(&source);
+    std::cout << "Wrapped frame tests passed." << std::endl;
+}
+
+// Main test function
+int main()
+{
+    std::cout << "Running AudioBuffer frame tests..." << std::endl;
+
+    test_attach_planes();
+    test_attach_wrapped();
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
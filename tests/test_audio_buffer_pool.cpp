@@ -0,0 +1,161 @@
+#include <iostream>
+#include <cassert>
+#include <memory>
+#include <vector>
+#include "AudioBufferPool.h"
+
+// Tests for the pooled AudioBuffer allocator
+
+namespace
+{
+    AVChannelLayout stereoLayout()
+    {
+        AVChannelLayout layout;
+        av_channel_layout_default(&layout, 2);
+        return layout;
+    }
+}
+
+// Test that released buffers are handed out again instead of reallocated
+void test_reuse()
+{
+    std::cout << "Testing buffer reuse..." << std::endl;
+
+    AudioEngine::AudioBufferPool pool(8);
+    const AVChannelLayout layout = stereoLayout();
+
+    auto first = pool.acquire(480, 48000, AV_SAMPLE_FMT_FLTP, layout);
+    assert(first && first->isValid());
+    assert(first->getFrameCount() == 480);
+    const uint8_t *storage = first->getPlaneData(0);
+    first.reset();
+
+    auto second = pool.acquire(480, 44100, AV_SAMPLE_FMT_FLTP, layout);
+    assert(second->getPlaneData(0) == storage);
+    assert(second->getSampleRate() == 44100);
+
+    AudioEngine::AudioBufferPool::Stats stats = pool.getStats();
+    assert(stats.misses == 1);
+    assert(stats.hits == 1);
+    assert(stats.allocated == 1);
+
+    std::cout << "Buffer reuse tests passed." << std::endl;
+}
+
+// Test that nearby sizes share a power-of-two size class
+void test_size_classes()
+{
+    std::cout << "Testing size classes..." << std::endl;
+
+    AudioEngine::AudioBufferPool pool(8);
+    const AVChannelLayout layout = stereoLayout();
+
+    // 300 and 512 frames both land in the 512 class; the frame count is what was asked for
+    auto buffer = pool.acquire(300, 48000, AV_SAMPLE_FMT_FLTP, layout);
+    const uint8_t *storage = buffer->getPlaneData(0);
+    buffer.reset();
+    buffer = pool.acquire(512, 48000, AV_SAMPLE_FMT_FLTP, layout);
+    assert(buffer->getPlaneData(0) == storage);
+    assert(buffer->getFrameCount() == 512);
+    buffer.reset();
+    buffer = pool.acquire(257, 48000, AV_SAMPLE_FMT_FLTP, layout);
+    assert(buffer->getPlaneData(0) == storage);
+    assert(buffer->getFrameCount() == 257);
+    buffer.reset();
+
+    // Tiny requests share the smallest class
+    auto tiny = pool.acquire(1, 48000, AV_SAMPLE_FMT_FLTP, layout);
+    tiny.reset();
+    tiny = pool.acquire(64, 48000, AV_SAMPLE_FMT_FLTP, layout);
+    tiny.reset();
+
+    AudioEngine::AudioBufferPool::Stats stats = pool.getStats();
+    assert(stats.formats == 2);
+    assert(stats.allocated == 2);
+
+    // A different format or layout is a different key
+    AVChannelLayout mono;
+    av_channel_layout_default(&mono, 1);
+    pool.acquire(512, 48000, AV_SAMPLE_FMT_S32, layout).reset();
+    pool.acquire(512, 48000, AV_SAMPLE_FMT_FLTP, mono).reset();
+    assert(pool.getStats().formats == 4);
+
+    std::cout << "Size class tests passed." << std::endl;
+}
+
+// Test that reserve() tops up idle buffers and ignores ones checked out
+void test_reserve()
+{
+    std::cout << "Testing reserve..." << std::endl;
+
+    AudioEngine::AudioBufferPool pool(8);
+    const AVChannelLayout layout = stereoLayout();
+
+    assert(pool.reserve(1024, 48000, AV_SAMPLE_FMT_FLTP, layout, 3));
+    assert(pool.getStats().allocated == 3);
+
+    // Already three idle: nothing to do
+    assert(pool.reserve(1024, 48000, AV_SAMPLE_FMT_FLTP, layout, 3));
+    assert(pool.getStats().allocated == 3);
+
+    // Two checked out leave one idle, so two more are created
+    auto a = pool.acquire(1024, 48000, AV_SAMPLE_FMT_FLTP, layout);
+    auto b = pool.acquire(1000, 48000, AV_SAMPLE_FMT_FLTP, layout);
+    assert(pool.reserve(1024, 48000, AV_SAMPLE_FMT_FLTP, layout, 3));
+    assert(pool.getStats().allocated == 5);
+
+    // Every acquire up to the reserve is served from the free list
+    pool.resetStats();
+    std::vector<std::shared_ptr<AudioEngine::AudioBuffer>> held;
+    for (int i = 0; i < 3; i++)
+    {
+        held.push_back(pool.acquire(1024, 48000, AV_SAMPLE_FMT_FLTP, layout));
+    }
+    assert(pool.getStats().hits == 3);
+    assert(pool.getStats().misses == 0);
+
+    std::cout << "Reserve tests passed." << std::endl;
+}
+
+// Test that an exhausted class falls back to plain heap buffers
+void test_exhaustion()
+{
+    std::cout << "Testing pool exhaustion..." << std::endl;
+
+    AudioEngine::AudioBufferPool pool(2);
+    const AVChannelLayout layout = stereoLayout();
+
+    std::vector<std::shared_ptr<AudioEngine::AudioBuffer>> held;
+    for (int i = 0; i < 4; i++)
+    {
+        held.push_back(pool.acquire(512, 48000, AV_SAMPLE_FMT_FLTP, layout));
+        assert(held.back() && held.back()->isValid());
+        assert(held.back()->getFrameCount() == 512);
+    }
+    assert(pool.getStats().allocated == 2);
+    assert(!pool.reserve(512, 48000, AV_SAMPLE_FMT_FLTP, layout, 3));
+
+    // Heap buffers are not returned to the pool
+    held.clear();
+    pool.resetStats();
+    pool.acquire(512, 48000, AV_SAMPLE_FMT_FLTP, layout).reset();
+    pool.acquire(512, 48000, AV_SAMPLE_FMT_FLTP, layout).reset();
+    assert(pool.getStats().hits == 2);
+    assert(pool.getStats().allocated == 2);
+
+    std::cout << "Pool exhaustion tests passed." << std::endl;
+}
+
+// Main test function
+int main()
+{
+    std::cout << "Running AudioBufferPool tests..." << std::endl;
+
+    test_reuse();
+    test_size_classes();
+    test_reserve();
+    test_exhaustion();
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
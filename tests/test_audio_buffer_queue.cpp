@@ -0,0 +1,237 @@
+#include <iostream>
+#include <cassert>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioBuffer.h"
+#include "AudioBufferQueue.h"
+
+// Tests for the wait-free buffer queue between file threads and the audio thread
+
+namespace
+{
+    using BufferPtr = std::shared_ptr<AudioEngine::AudioBuffer>;
+
+    std::vector<BufferPtr> makeBuffers(size_t count)
+    {
+        AVChannelLayout layout;
+        av_channel_layout_default(&layout, 2);
+        std::vector<BufferPtr> buffers;
+        for (size_t i = 0; i < count; i++)
+        {
+            buffers.push_back(AudioEngine::AudioBuffer::createBuffer(64, 48000, AV_SAMPLE_FMT_FLTP, layout));
+        }
+        return buffers;
+    }
+}
+
+// Test that a full DROP_NEWEST queue rejects the incoming buffer
+void test_drop_newest()
+{
+    std::cout << "Testing DROP_NEWEST..." << std::endl;
+
+    auto buffers = makeBuffers(4);
+    AudioEngine::AudioBufferQueue queue(3, AudioEngine::QueuePolicy::DROP_NEWEST);
+
+    assert(queue.push(buffers[0]));
+    assert(queue.push(buffers[1]));
+    assert(queue.push(buffers[2]));
+    assert(queue.isFull());
+    assert(!queue.push(buffers[3]));
+    assert(queue.depth() == 3);
+
+    assert(queue.pop() == buffers[0]);
+    assert(queue.pop() == buffers[1]);
+    assert(queue.pop() == buffers[2]);
+    assert(queue.pop() == nullptr);
+
+    AudioEngine::AudioBufferQueue::Stats stats = queue.getStats();
+    assert(stats.pushed == 3);
+    assert(stats.popped == 3);
+    assert(stats.overruns == 1);
+    assert(stats.dropped == 1);
+    assert(stats.underruns == 1);
+    assert(stats.depth == 0);
+
+    std::cout << "DROP_NEWEST tests passed." << std::endl;
+}
+
+// Test that a full DROP_OLDEST queue keeps the newest buffers
+void test_drop_oldest()
+{
+    std::cout << "Testing DROP_OLDEST..." << std::endl;
+
+    auto buffers = makeBuffers(5);
+    AudioEngine::AudioBufferQueue queue(3, AudioEngine::QueuePolicy::DROP_OLDEST);
+
+    for (const auto &buffer : buffers)
+    {
+        assert(queue.push(buffer));
+    }
+    assert(queue.depth() == 3);
+
+    // The producer can't move the read index; the consumer discards on its next pop
+    assert(queue.pop() == buffers[2]);
+    assert(queue.pop() == buffers[3]);
+    assert(queue.pop() == buffers[4]);
+    assert(queue.pop() == nullptr);
+
+    AudioEngine::AudioBufferQueue::Stats stats = queue.getStats();
+    assert(stats.overruns == 2);
+    assert(stats.dropped == 2);
+    assert(stats.popped == 3);
+
+    // Discarded buffers are released, not leaked into the ring
+    assert(buffers[0].use_count() == 1);
+    assert(buffers[1].use_count() == 1);
+
+    // With a stalled consumer the headroom runs out and new buffers are dropped after all
+    AudioEngine::AudioBufferQueue stalled(2, AudioEngine::QueuePolicy::DROP_OLDEST);
+    auto more = makeBuffers(5);
+    for (size_t i = 0; i < 4; i++)
+    {
+        assert(stalled.push(more[i]));
+    }
+    assert(!stalled.push(more[4]));
+    assert(stalled.pop() == more[2]);
+
+    std::cout << "DROP_OLDEST tests passed." << std::endl;
+}
+
+// Test underrun accounting and the difference between pop() and tryPop()
+void test_underruns()
+{
+    std::cout << "Testing underruns..." << std::endl;
+
+    AudioEngine::AudioBufferQueue queue(2, AudioEngine::QueuePolicy::SILENCE_FILL);
+    BufferPtr buffer;
+
+    // Worker threads poll with tryPop(); only the audio thread's pop() is an underrun
+    assert(!queue.tryPop(buffer));
+    assert(queue.getStats().underruns == 0);
+    assert(queue.pop() == nullptr);
+    assert(queue.getStats().underruns == 1);
+
+    // Full behaves like DROP_NEWEST
+    auto buffers = makeBuffers(3);
+    assert(queue.push(buffers[0]));
+    assert(queue.push(buffers[1]));
+    assert(!queue.push(buffers[2]));
+
+    queue.resetStats();
+    assert(queue.getStats().underruns == 0);
+    assert(queue.getStats().overruns == 0);
+    assert(queue.getStats().depth == 2);
+
+    std::cout << "Underrun tests passed." << std::endl;
+}
+
+// Test that clear() empties the queue, releases the buffers and forgets pending discards
+void test_clear()
+{
+    std::cout << "Testing clear..." << std::endl;
+
+    auto buffers = makeBuffers(6);
+    AudioEngine::AudioBufferQueue queue(3, AudioEngine::QueuePolicy::DROP_OLDEST);
+    for (size_t i = 0; i < 5; i++)
+    {
+        assert(queue.push(buffers[i]));
+    }
+
+    queue.clear();
+    assert(queue.depth() == 0);
+    for (size_t i = 0; i < 5; i++)
+    {
+        assert(buffers[i].use_count() == 1);
+    }
+
+    // A buffer pushed after the clear is not taken by a stale discard request
+    assert(queue.push(buffers[5]));
+    assert(queue.depth() == 1);
+    assert(queue.pop() == buffers[5]);
+
+    std::cout << "Clear tests passed." << std::endl;
+}
+
+// Test the policy names used in node parameters
+void test_policy_names()
+{
+    std::cout << "Testing policy names..." << std::endl;
+
+    for (auto policy : {AudioEngine::QueuePolicy::DROP_NEWEST, AudioEngine::QueuePolicy::DROP_OLDEST,
+                        AudioEngine::QueuePolicy::SILENCE_FILL})
+    {
+        AudioEngine::QueuePolicy parsed = AudioEngine::QueuePolicy::DROP_NEWEST;
+        assert(AudioEngine::AudioBufferQueue::parsePolicy(AudioEngine::AudioBufferQueue::getPolicyName(policy), parsed));
+        assert(parsed == policy);
+    }
+
+    AudioEngine::QueuePolicy parsed = AudioEngine::QueuePolicy::DROP_OLDEST;
+    assert(!AudioEngine::AudioBufferQueue::parsePolicy("bogus", parsed));
+    assert(parsed == AudioEngine::QueuePolicy::DROP_OLDEST);
+
+    std::cout << "Policy name tests passed." << std::endl;
+}
+
+// Test a producer with back-pressure against a polling consumer
+void test_two_threads()
+{
+    std::cout << "Testing two-threaded queue..." << std::endl;
+
+    const size_t count = 20000;
+    auto buffers = makeBuffers(16);
+    AudioEngine::AudioBufferQueue queue(8, AudioEngine::QueuePolicy::DROP_NEWEST);
+
+    std::thread producer([&]
+                         {
+        for (size_t i = 0; i < count; i++)
+        {
+            while (queue.isFull())
+            {
+                std::this_thread::yield();
+            }
+            bool pushed = queue.push(buffers[i % buffers.size()]);
+            assert(pushed);
+            (void)pushed;
+        } });
+
+    size_t received = 0;
+    BufferPtr buffer;
+    while (received < count)
+    {
+        if (queue.tryPop(buffer))
+        {
+            assert(buffer == buffers[received % buffers.size()]);
+            received++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    AudioEngine::AudioBufferQueue::Stats stats = queue.getStats();
+    assert(stats.dropped == 0);
+    assert(stats.pushed == count);
+    assert(stats.popped == count);
+
+    std::cout << "Two-threaded queue tests passed." << std::endl;
+}
+
+// Main test function
+int main()
+{
+    std::cout << "Running AudioBufferQueue tests..." << std::endl;
+
+    test_drop_newest();
+    test_drop_oldest();
+    test_underruns();
+    test_clear();
+    test_policy_names();
+    test_two_threads();
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
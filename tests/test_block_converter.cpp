@@ -0,0 +1,298 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BlockConverter.h"
+
+// Tests for the decode-to-block stage shared by the file and playlist sources
+
+using AudioEngine::AudioBuffer;
+using AudioEngine::BlockConverter;
+
+namespace
+{
+    const int SAMPLE_RATE = 48000;
+    const long BLOCK = 256;
+
+    // Frame n of the test signal, exact in float; the right channel is negated
+    float sampleValue(int64_t n)
+    {
+        return static_cast<float>(n % 4096 + 1) / 4096.0f;
+    }
+
+    // Interleaved float stereo, as a decoder would produce it
+    std::vector<float> makeInput(int64_t start, int frames)
+    {
+        std::vector<float> samples(static_cast<size_t>(frames) * 2);
+        for (int i = 0; i < frames; i++)
+        {
+            samples[2 * i] = sampleValue(start + i);
+            samples[2 * i + 1] = -sampleValue(start + i);
+        }
+        return samples;
+    }
+
+    // A decoder's output format, for createResampler()
+    struct Decoder
+    {
+        AVCodecContext *codec;
+
+        explicit Decoder(int sampleRate)
+        {
+            codec = avcodec_alloc_context3(nullptr);
+            codec->sample_fmt = AV_SAMPLE_FMT_FLT;
+            codec->sample_rate = sampleRate;
+            av_channel_layout_default(&codec->ch_layout, 2);
+        }
+
+        ~Decoder() { avcodec_free_context(&codec); }
+    };
+
+    // Collects the blocks and checks the signal is continuous across them
+    struct Sink
+    {
+        std::vector<long> sizes;
+        int64_t frames = 0;
+        bool checkSignal = true;
+        size_t accept = SIZE_MAX; // Blocks taken before the handler declines
+
+        BlockConverter::BlockHandler handler()
+        {
+            return [this](const std::shared_ptr<AudioBuffer> &block)
+            {
+                if (sizes.size() >= accept)
+                {
+                    return false;
+                }
+                const long count = block->getFrameCount();
+                assert(block->getFormat() == AV_SAMPLE_FMT_FLTP);
+                if (checkSignal)
+                {
+                    const float *left = reinterpret_cast<const float *>(block->getPlaneData(0));
+                    const float *right = reinterpret_cast<const float *>(block->getPlaneData(1));
+                    for (long i = 0; i < count; i++)
+                    {
+                        assert(left[i] == sampleValue(frames + i));
+                        assert(right[i] == -sampleValue(frames + i));
+                    }
+                }
+                sizes.push_back(count);
+                frames += count;
+                return true;
+            };
+        }
+    };
+
+    AVChannelLayout stereoLayout()
+    {
+        AVChannelLayout layout;
+        av_channel_layout_default(&layout, 2);
+        return layout;
+    }
+}
+
+// Test that a splice between two decoders lands inside a block without a gap
+void test_splice()
+{
+    std::cout << "Testing splice between decoders..." << std::endl;
+
+    Sink sink;
+    BlockConverter converter;
+    assert(converter.configure(SAMPLE_RATE, BLOCK, AV_SAMPLE_FMT_FLTP, stereoLayout(), sink.handler()));
+
+    // Two items of the same format, each with its own resampler, like two playlist entries
+    Decoder decoder(SAMPLE_RATE);
+    std::string error;
+    const int itemSizes[2][3] = {{700, 300, 1}, {37, 1000, 90}};
+    int64_t position = 0;
+    for (const auto &item : itemSizes)
+    {
+        SwrContext *swr = converter.createResampler(decoder.codec, error);
+        assert(swr);
+        for (int size : item)
+        {
+            const std::vector<float> input = makeInput(position, size);
+            const uint8_t *planes[] = {reinterpret_cast<const uint8_t *>(input.data())};
+            assert(converter.convert(swr, planes, size) == size);
+            position += size;
+        }
+
+        // End of the item: nothing left in its resampler, the open block carries over
+        assert(converter.convert(swr, nullptr, 0) == 0);
+        assert(converter.getPendingFrames() == position % BLOCK);
+        swr_free(&swr);
+    }
+
+    // Only the very last block of the stream is short
+    assert(converter.flush());
+    assert(converter.getPendingFrames() == 0);
+    assert(sink.frames == position);
+    for (size_t i = 0; i + 1 < sink.sizes.size(); i++)
+    {
+        assert(sink.sizes[i] == BLOCK);
+    }
+    assert(sink.sizes.back() == position % BLOCK);
+
+    // Flushing again hands over nothing
+    assert(converter.flush());
+    assert(sink.sizes.size() == static_cast<size_t>(position / BLOCK + 1));
+
+    std::cout << "Splice tests passed." << std::endl;
+}
+
+// Test that a limit ends the output on an exact frame, leaving the rest in the resampler
+void test_limit()
+{
+    std::cout << "Testing output limit..." << std::endl;
+
+    Sink sink;
+    BlockConverter converter;
+    assert(converter.configure(SAMPLE_RATE, BLOCK, AV_SAMPLE_FMT_FLTP, stereoLayout(), sink.handler()));
+
+    Decoder decoder(SAMPLE_RATE);
+    std::string error;
+    SwrContext *swr = converter.createResampler(decoder.codec, error);
+    assert(swr);
+
+    // A loop end 300 frames into a 700-frame packet
+    const std::vector<float> input = makeInput(0, 700);
+    const uint8_t *planes[] = {reinterpret_cast<const uint8_t *>(input.data())};
+    assert(converter.convert(swr, planes, 700, 300) == 300);
+    assert(sink.frames == BLOCK);
+    assert(converter.getPendingFrames() == 300 - BLOCK);
+
+    // A limit of zero produces nothing; the held frames come out when collected
+    assert(converter.convert(swr, planes, 0, 0) == 0);
+    assert(converter.convert(swr, nullptr, 0) == 400);
+    assert(converter.flush());
+    assert(sink.frames == 700);
+
+    swr_free(&swr);
+    std::cout << "Output limit tests passed." << std::endl;
+}
+
+// Test blocks mixed from converted and engine-format audio
+void test_append()
+{
+    std::cout << "Testing append..." << std::endl;
+
+    Sink sink;
+    BlockConverter converter;
+    assert(converter.configure(SAMPLE_RATE, BLOCK, AV_SAMPLE_FMT_FLTP, stereoLayout(), sink.handler()));
+
+    Decoder decoder(SAMPLE_RATE);
+    std::string error;
+    SwrContext *swr = converter.createResampler(decoder.codec, error);
+    assert(swr);
+
+    const std::vector<float> input = makeInput(0, 100);
+    const uint8_t *planes[] = {reinterpret_cast<const uint8_t *>(input.data())};
+    assert(converter.convert(swr, planes, 100) == 100);
+
+    // Audio already in the engine format continues the same block
+    auto buffer = AudioBuffer::createBuffer(600, SAMPLE_RATE, AV_SAMPLE_FMT_FLTP, stereoLayout());
+    float *left = reinterpret_cast<float *>(buffer->getPlaneData(0));
+    float *right = reinterpret_cast<float *>(buffer->getPlaneData(1));
+    for (int i = 0; i < 600; i++)
+    {
+        left[i] = sampleValue(100 + i);
+        right[i] = -sampleValue(100 + i);
+    }
+    assert(converter.append(*buffer));
+    assert(sink.frames == 2 * BLOCK);
+    assert(converter.getPendingFrames() == 700 - 2 * BLOCK);
+
+    // reset() drops the open block, as after a seek
+    converter.reset();
+    assert(converter.getPendingFrames() == 0);
+    assert(converter.flush());
+    assert(sink.frames == 2 * BLOCK);
+
+    swr_free(&swr);
+    std::cout << "Append tests passed." << std::endl;
+}
+
+// Test that sample rate conversion still yields whole blocks and the expected length
+void test_resampling()
+{
+    std::cout << "Testing resampling..." << std::endl;
+
+    Sink sink;
+    sink.checkSignal = false;
+    BlockConverter converter;
+    assert(converter.configure(SAMPLE_RATE, BLOCK, AV_SAMPLE_FMT_FLTP, stereoLayout(), sink.handler()));
+
+    Decoder decoder(44100);
+    std::string error;
+    SwrContext *swr = converter.createResampler(decoder.codec, error);
+    assert(swr);
+
+    const int packets = 100;
+    const int packetSize = 1152;
+    int64_t produced = 0;
+    for (int p = 0; p < packets; p++)
+    {
+        const std::vector<float> input = makeInput(p * packetSize, packetSize);
+        const uint8_t *planes[] = {reinterpret_cast<const uint8_t *>(input.data())};
+        const int64_t frames = converter.convert(swr, planes, packetSize);
+        assert(frames >= 0);
+        produced += frames;
+    }
+    produced += converter.convert(swr, nullptr, 0);
+    assert(converter.flush());
+
+    const int64_t expected = static_cast<int64_t>(packets) * packetSize * SAMPLE_RATE / 44100;
+    assert(std::abs(produced - expected) <= 2);
+    assert(sink.frames == produced);
+    for (size_t i = 0; i + 1 < sink.sizes.size(); i++)
+    {
+        assert(sink.sizes[i] == BLOCK);
+    }
+
+    swr_free(&swr);
+    std::cout << "Resampling tests passed (" << produced << " frames)." << std::endl;
+}
+
+// Test that a declining handler stops the conversion
+void test_declined()
+{
+    std::cout << "Testing declined blocks..." << std::endl;
+
+    Sink sink;
+    sink.accept = 1;
+    BlockConverter converter;
+    assert(!converter.configure(SAMPLE_RATE, 0, AV_SAMPLE_FMT_FLTP, stereoLayout(), sink.handler()));
+    assert(converter.configure(SAMPLE_RATE, BLOCK, AV_SAMPLE_FMT_FLTP, stereoLayout(), sink.handler()));
+
+    Decoder decoder(SAMPLE_RATE);
+    std::string error;
+    SwrContext *swr = converter.createResampler(decoder.codec, error);
+    assert(swr);
+
+    const std::vector<float> input = makeInput(0, 1000);
+    const uint8_t *planes[] = {reinterpret_cast<const uint8_t *>(input.data())};
+    assert(converter.convert(swr, planes, 1000) == AVERROR_EXIT);
+    assert(sink.sizes.size() == 1);
+
+    swr_free(&swr);
+    std::cout << "Declined block tests passed." << std::endl;
+}
+
+// Main test function
+int main()
+{
+    std::cout << "Running BlockConverter tests..." << std::endl;
+
+    test_splice();
+    test_limit();
+    test_append();
+    test_resampling();
+    test_declined();
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,261 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include "DspKernels.h"
+
+// Tests for the native DSP kernels at every SIMD level
+
+using AudioEngine::DspKernels;
+
+namespace
+{
+    // Odd length so the vector kernels run their scalar tails too
+    const long FRAMES = 1003;
+
+    const DspKernels::SimdLevel LEVELS[] = {DspKernels::SimdLevel::SSE2, DspKernels::SimdLevel::AVX2};
+
+    std::vector<float> makeSignal(long frames, float frequency, float phase)
+    {
+        std::vector<float> signal(static_cast<size_t>(frames));
+        for (long i = 0; i < frames; i++)
+        {
+            signal[i] = 0.8f * std::sin(frequency * static_cast<float>(i) + phase) +
+                        0.1f * std::sin(0.37f * static_cast<float>(i));
+        }
+        return signal;
+    }
+
+    void assertClose(const std::vector<float> &a, const std::vector<float> &b, float tolerance)
+    {
+        assert(a.size() == b.size());
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            assert(std::fabs(a[i] - b[i]) <= tolerance);
+        }
+    }
+
+    // The SIMD levels this CPU actually has, as selected
+    std::vector<DspKernels> vectorKernels()
+    {
+        std::vector<DspKernels> kernels;
+        for (DspKernels::SimdLevel level : LEVELS)
+        {
+            DspKernels selected = DspKernels::select(level);
+            if (selected.simdLevel == level)
+            {
+                kernels.push_back(selected);
+            }
+        }
+        return kernels;
+    }
+
+    // Low-pass at about fs/8
+    AudioEngine::BiquadCoefficients lowPass()
+    {
+        const double w = 2.0 * M_PI / 8.0;
+        const double alpha = std::sin(w) / (2.0 * 0.707);
+        const double a0 = 1.0 + alpha;
+        AudioEngine::BiquadCoefficients k;
+        k.b0 = static_cast<float>((1.0 - std::cos(w)) / 2.0 / a0);
+        k.b1 = static_cast<float>((1.0 - std::cos(w)) / a0);
+        k.b2 = k.b0;
+        k.a1 = static_cast<float>(-2.0 * std::cos(w) / a0);
+        k.a2 = static_cast<float>((1.0 - alpha) / a0);
+        return k;
+    }
+}
+
+// Test the scalar reference against the definitions
+void test_scalar_reference()
+{
+    std::cout << "Testing scalar reference kernels..." << std::endl;
+
+    const DspKernels scalar = DspKernels::select(DspKernels::SimdLevel::SCALAR);
+    assert(scalar.simdLevel == DspKernels::SimdLevel::SCALAR);
+
+    const std::vector<float> in = makeSignal(FRAMES, 0.05f, 0.0f);
+
+    // Gain ramps linearly from gain by step per sample
+    std::vector<float> out(in.size());
+    scalar.gain(in.data(), out.data(), FRAMES, 0.5f, 0.001f);
+    for (long i = 0; i < FRAMES; i++)
+    {
+        assert(std::fabs(out[i] - in[i] * (0.5f + 0.001f * i)) <= 1e-6f);
+    }
+
+    // Mix accumulates
+    std::vector<float> sum(in.size(), 1.0f);
+    scalar.mix(in.data(), sum.data(), FRAMES, 2.0f, 0.0f);
+    for (long i = 0; i < FRAMES; i++)
+    {
+        assert(std::fabs(sum[i] - (1.0f + 2.0f * in[i])) <= 1e-6f);
+    }
+
+    // Peak and energy
+    float peak = 0.0f;
+    float sumSquares = 0.0f;
+    scalar.level(in.data(), FRAMES, peak, sumSquares);
+    float expectedPeak = 0.0f;
+    double expectedSquares = 0.0;
+    for (float x : in)
+    {
+        expectedPeak = std::fmax(expectedPeak, std::fabs(x));
+        expectedSquares += static_cast<double>(x) * x;
+    }
+    assert(peak == expectedPeak);
+    assert(std::fabs(sumSquares - expectedSquares) <= 1e-3 * expectedSquares);
+
+    // A unity biquad passes the signal through
+    std::vector<float> filtered(in.size());
+    const float *inPlanes[] = {in.data()};
+    float *outPlanes[] = {filtered.data()};
+    std::vector<float> state(2, 0.0f);
+    scalar.biquad(inPlanes, outPlanes, 1, FRAMES, AudioEngine::BiquadCoefficients(), state.data());
+    assertClose(filtered, in, 0.0f);
+
+    std::cout << "Scalar reference tests passed." << std::endl;
+}
+
+// Test the vector gain, mix and level kernels against scalar, in place too
+void test_simd_gain_mix_level()
+{
+    std::cout << "Testing SIMD gain, mix and level..." << std::endl;
+
+    const DspKernels scalar = DspKernels::select(DspKernels::SimdLevel::SCALAR);
+    const std::vector<float> in = makeSignal(FRAMES, 0.05f, 0.3f);
+
+    for (const DspKernels &kernels : vectorKernels())
+    {
+        std::vector<float> expected(in.size());
+        std::vector<float> actual(in.size());
+        scalar.gain(in.data(), expected.data(), FRAMES, 0.25f, 0.0005f);
+        kernels.gain(in.data(), actual.data(), FRAMES, 0.25f, 0.0005f);
+
+        // The vector ramps step their gain per register, so rounding drifts a little
+        assertClose(actual, expected, 1e-4f);
+
+        // In place, starting off alignment
+        std::vector<float> inPlace = in;
+        kernels.gain(inPlace.data() + 1, inPlace.data() + 1, FRAMES - 1, 0.25f, 0.0f);
+        scalar.gain(in.data() + 1, expected.data() + 1, FRAMES - 1, 0.25f, 0.0f);
+        expected[0] = in[0];
+        assertClose(inPlace, expected, 0.0f);
+
+        std::vector<float> expectedMix(in.size(), 0.5f);
+        std::vector<float> actualMix(in.size(), 0.5f);
+        scalar.mix(in.data(), expectedMix.data(), FRAMES, 0.7f, -0.0002f);
+        kernels.mix(in.data(), actualMix.data(), FRAMES, 0.7f, -0.0002f);
+        assertClose(actualMix, expectedMix, 1e-4f);
+
+        float expectedPeak = 0.0f, expectedSquares = 0.0f;
+        float actualPeak = 0.0f, actualSquares = 0.0f;
+        scalar.level(in.data(), FRAMES, expectedPeak, expectedSquares);
+        kernels.level(in.data(), FRAMES, actualPeak, actualSquares);
+        assert(actualPeak == expectedPeak);
+        assert(std::fabs(actualSquares - expectedSquares) <= 1e-4f * expectedSquares);
+    }
+
+    std::cout << "SIMD gain, mix and level tests passed." << std::endl;
+}
+
+// Test the channel-parallel biquads against scalar, across block boundaries
+void test_simd_biquad()
+{
+    std::cout << "Testing SIMD biquad..." << std::endl;
+
+    const DspKernels scalar = DspKernels::select(DspKernels::SimdLevel::SCALAR);
+    const AudioEngine::BiquadCoefficients k = lowPass();
+
+    // Eleven channels: one or two vector groups plus scalar leftovers
+    const int channels = 11;
+    std::vector<std::vector<float>> in;
+    for (int c = 0; c < channels; c++)
+    {
+        in.push_back(makeSignal(FRAMES, 0.02f + 0.03f * c, 0.1f * c));
+    }
+
+    auto run = [&](const DspKernels &kernels, long split)
+    {
+        std::vector<std::vector<float>> out(channels, std::vector<float>(FRAMES));
+        std::vector<float> state(2 * channels, 0.0f);
+        std::vector<const float *> inPlanes(channels);
+        std::vector<float *> outPlanes(channels);
+
+        // Two calls: the state carries the filter across the block boundary
+        for (long begin : {0L, split})
+        {
+            const long end = begin == 0 ? split : FRAMES;
+            for (int c = 0; c < channels; c++)
+            {
+                inPlanes[c] = in[c].data() + begin;
+                outPlanes[c] = out[c].data() + begin;
+            }
+            kernels.biquad(inPlanes.data(), outPlanes.data(), channels, end - begin, k, state.data());
+        }
+        return out;
+    };
+
+    const auto expected = run(scalar, FRAMES);
+    const auto split = run(scalar, 333);
+    for (int c = 0; c < channels; c++)
+    {
+        assertClose(split[c], expected[c], 0.0f);
+    }
+
+    for (const DspKernels &kernels : vectorKernels())
+    {
+        const auto actual = run(kernels, 333);
+        for (int c = 0; c < channels; c++)
+        {
+            assertClose(actual[c], expected[c], 1e-5f);
+        }
+    }
+
+    std::cout << "SIMD biquad tests passed." << std::endl;
+}
+
+// Test that the true peak finds the crest between samples
+void test_true_peak()
+{
+    std::cout << "Testing true peak..." << std::endl;
+
+    const DspKernels scalar = DspKernels::select(DspKernels::SimdLevel::SCALAR);
+    const long history = DspKernels::TRUE_PEAK_TAPS - 1;
+
+    // fs/4 at 45 degrees: every sample is +-0.707, the waveform peaks at 1.0
+    std::vector<float> signal(static_cast<size_t>(history + FRAMES));
+    for (long i = 0; i < history + FRAMES; i++)
+    {
+        signal[i] = static_cast<float>(std::sin(M_PI / 2.0 * i + M_PI / 4.0));
+    }
+    const float *block = signal.data() + history;
+
+    float samplePeak = 0.0f, sumSquares = 0.0f;
+    scalar.level(block, FRAMES, samplePeak, sumSquares);
+    const float expected = scalar.truePeak(block, FRAMES);
+    assert(samplePeak < 0.71f);
+    assert(expected > 0.95f && expected < 1.05f);
+
+    for (const DspKernels &kernels : vectorKernels())
+    {
+        assert(std::fabs(kernels.truePeak(block, FRAMES) - expected) <= 1e-5f);
+        assert(std::fabs(kernels.truePeak(block + 1, FRAMES - 1) - scalar.truePeak(block + 1, FRAMES - 1)) <= 1e-5f);
+    }
+
+    std::cout << "True peak tests passed (" << expected << " vs sample peak " << samplePeak << ")." << std::endl;
+}
+
+// Main test function
+int main()
+{
+    std::cout << "Running DspKernels tests..." << std::endl;
+
+    test_scalar_reference();
+    test_simd_gain_mix_level();
+    test_simd_biquad();
+    test_true_peak();
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include <iostream>
+#include <cassert>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AudioNode.h"
+#include "ExecutionPlan.h"
+
+// Tests for compiling a node graph into an execution plan
+
+namespace
+{
+    // Node that does nothing; the plan only looks at names, types and pads
+    class DummyNode : public AudioEngine::AudioNode
+    {
+    public:
+        explicit DummyNode(const std::string &name) : AudioNode(name, nullptr) {}
+
+        NodeType getType() const override { return NodeType::CUSTOM; }
+        bool configure(const std::string &, double, long, AVSampleFormat, AVChannelLayout) override { return true; }
+        bool start() override { return true; }
+        void stop() override {}
+        bool process() override { return true; }
+        bool isRunning() const override { return false; }
+        bool setInputBuffer(std::shared_ptr<AudioEngine::AudioBuffer>, int) override { return true; }
+        std::shared_ptr<AudioEngine::AudioBuffer> getOutputBuffer(int) override { return nullptr; }
+        int getInputPadCount() const override { return 2; }
+        int getOutputPadCount() const override { return 2; }
+        void reset() override {}
+    };
+
+    std::vector<std::shared_ptr<AudioEngine::AudioNode>> makeNodes(const std::vector<std::string> &names)
+    {
+        std::vector<std::shared_ptr<AudioEngine::AudioNode>> nodes;
+        for (const auto &name : names)
+        {
+            nodes.push_back(std::make_shared<DummyNode>(name));
+        }
+        return nodes;
+    }
+
+    size_t positionOf(const AudioEngine::ExecutionPlan &plan, const AudioEngine::AudioNode *node)
+    {
+        const auto &order = plan.getOrder();
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            if (order[i] == node)
+            {
+                return i;
+            }
+        }
+        assert(false && "node missing from the plan");
+        return order.size();
+    }
+}
+
+// Test that every node runs after the nodes it reads from
+void test_topological_order()
+{
+    std::cout << "Testing topological order..." << std::endl;
+
+    // Listed sink first so the node order alone would be wrong
+    auto nodes = makeNodes({"sink", "mixer", "fx", "source_a", "source_b"});
+    AudioEngine::AudioNode *sink = nodes[0].get();
+    AudioEngine::AudioNode *mixer = nodes[1].get();
+    AudioEngine::AudioNode *fx = nodes[2].get();
+    AudioEngine::AudioNode *sourceA = nodes[3].get();
+    AudioEngine::AudioNode *sourceB = nodes[4].get();
+
+    std::vector<AudioEngine::Connection> connections = {
+        {sourceA, 0, fx, 0},
+        {fx, 0, mixer, 0},
+        {sourceB, 0, mixer, 1},
+        {mixer, 0, sink, 0}};
+
+    AudioEngine::ExecutionPlan plan;
+    std::string error;
+    assert(AudioEngine::ExecutionPlan::build(nodes, connections, plan, error));
+    assert(plan.isValid());
+    assert(plan.getSteps().size() == nodes.size());
+
+    for (const auto &connection : connections)
+    {
+        assert(positionOf(plan, connection.getSourceNode()) < positionOf(plan, connection.getSinkNode()));
+    }
+
+    // Of the ready nodes, the one listed first runs first: fx (index 2) before source_b (index 4)
+    const std::vector<AudioEngine::AudioNode *> expected = {sourceA, fx, sourceB, mixer, sink};
+    assert(plan.getOrder() == expected);
+
+    // The mixer waits for two upstream steps, the sources for none
+    const auto &steps = plan.getSteps();
+    assert(steps[positionOf(plan, mixer)].dependencyCount == 2);
+    assert(steps[positionOf(plan, sourceA)].dependencyCount == 0);
+    assert(steps[positionOf(plan, sourceB)].dependencyCount == 0);
+
+    std::cout << "Topological order tests passed." << std::endl;
+}
+
+// Test that an output pad feeding several inputs gets one slot
+void test_fan_out_slots()
+{
+    std::cout << "Testing fan-out slots..." << std::endl;
+
+    auto nodes = makeNodes({"source", "left", "right"});
+    AudioEngine::AudioNode *source = nodes[0].get();
+    AudioEngine::AudioNode *left = nodes[1].get();
+    AudioEngine::AudioNode *right = nodes[2].get();
+
+    // Pad 0 feeds both sinks, pad 1 feeds the right sink a second time
+    std::vector<AudioEngine::Connection> connections = {
+        {source, 0, left, 0},
+        {source, 0, right, 0},
+        {source, 1, right, 1}};
+
+    AudioEngine::ExecutionPlan plan;
+    std::string error;
+    assert(AudioEngine::ExecutionPlan::build(nodes, connections, plan, error));
+    assert(plan.getSlotCount() == 2);
+
+    const auto &step = plan.getSteps()[positionOf(plan, source)];
+    assert(step.outputEnd - step.outputBegin == 2);
+
+    // Two connections to the right sink are still one dependency
+    assert(step.successorEnd - step.successorBegin == 2);
+    assert(plan.getSteps()[positionOf(plan, right)].dependencyCount == 1);
+    assert(plan.getSteps()[positionOf(plan, right)].inputEnd - plan.getSteps()[positionOf(plan, right)].inputBegin == 2);
+
+    std::cout << "Fan-out slot tests passed." << std::endl;
+}
+
+// Test that cycles and foreign nodes are rejected
+void test_invalid_graphs()
+{
+    std::cout << "Testing invalid graphs..." << std::endl;
+
+    auto nodes = makeNodes({"source", "a", "b", "c"});
+    AudioEngine::AudioNode *source = nodes[0].get();
+    AudioEngine::AudioNode *a = nodes[1].get();
+    AudioEngine::AudioNode *b = nodes[2].get();
+    AudioEngine::AudioNode *c = nodes[3].get();
+
+    // a -> b -> c -> a, fed by the source
+    std::vector<AudioEngine::Connection> cycle = {
+        {source, 0, a, 0},
+        {a, 0, b, 0},
+        {b, 0, c, 0},
+        {c, 0, a, 1}};
+
+    AudioEngine::ExecutionPlan plan;
+    std::string error;
+    assert(!AudioEngine::ExecutionPlan::build(nodes, cycle, plan, error));
+    assert(!plan.isValid());
+    assert(error.find("Cycle") != std::string::npos);
+    assert(error.find(" a") != std::string::npos);
+    assert(error.find(" b") != std::string::npos);
+    assert(error.find(" c") != std::string::npos);
+    assert(error.find("source") == std::string::npos);
+
+    // Self-connection
+    error.clear();
+    assert(!AudioEngine::ExecutionPlan::build(nodes, {{a, 0, a, 0}}, plan, error));
+    assert(!error.empty());
+
+    // A node the engine doesn't own
+    DummyNode stranger("stranger");
+    error.clear();
+    assert(!AudioEngine::ExecutionPlan::build(nodes, {{source, 0, &stranger, 0}}, plan, error));
+    assert(!error.empty());
+
+    std::cout << "Invalid graph tests passed." << std::endl;
+}
+
+// Main test function
+int main()
+{
+    std::cout << "Running ExecutionPlan tests..." << std::endl;
+
+    test_topological_order();
+    test_fan_out_slots();
+    test_invalid_graphs();
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,229 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "FfmpegFilter.h"
+
+// Tests for the FFmpeg filter graph wrapper
+
+namespace
+{
+    const int SAMPLE_RATE = 48000;
+    const long BLOCK = 256;
+
+    AVChannelLayout stereoLayout()
+    {
+        AVChannelLayout layout;
+        av_channel_layout_default(&layout, 2);
+        return layout;
+    }
+
+    // Sample n of the test signal, exact in float; the right channel is negated
+    float rampValue(int64_t n)
+    {
+        return static_cast<float>(n % 4096 + 1) / 4096.0f;
+    }
+
+    AVFrame *makeFrame(int64_t start, int frames)
+    {
+        AVFrame *frame = av_frame_alloc();
+        frame->format = AV_SAMPLE_FMT_FLTP;
+        frame->sample_rate = SAMPLE_RATE;
+        frame->nb_samples = frames;
+        frame->pts = start;
+        av_channel_layout_default(&frame->ch_layout, 2);
+        int ret = av_frame_get_buffer(frame, 0);
+        assert(ret >= 0);
+        (void)ret;
+
+        float *left = reinterpret_cast<float *>(frame->extended_data[0]);
+        float *right = reinterpret_cast<float *>(frame->extended_data[1]);
+        for (int i = 0; i < frames; i++)
+        {
+            left[i] = rampValue(start + i);
+            right[i] = -rampValue(start + i);
+        }
+        return frame;
+    }
+
+    // Append both planes of a frame to the collected output
+    void collect(const AVFrame *frame, std::vector<float> &left, std::vector<float> &right)
+    {
+        const float *l = reinterpret_cast<const float *>(frame->extended_data[0]);
+        const float *r = reinterpret_cast<const float *>(frame->extended_data[1]);
+        left.insert(left.end(), l, l + frame->nb_samples);
+        right.insert(right.end(), r, r + frame->nb_samples);
+    }
+}
+
+// Test that drain() flushes the audio a delaying filter still holds at end of stream
+void test_drain()
+{
+    std::cout << "Testing drain..." << std::endl;
+
+    const int delay = 100;
+    const int blocks = 4;
+    AVFrame *output = av_frame_alloc();
+    AudioEngine::FfmpegFilter filter;
+    assert(!filter.drain(output));
+    assert(filter.initGraph("adelay=delays=" + std::to_string(delay) + "S:all=1", SAMPLE_RATE,
+                            AV_SAMPLE_FMT_FLTP, stereoLayout(), BLOCK));
+
+    std::vector<float> left, right;
+    for (int b = 0; b < blocks; b++)
+    {
+        AVFrame *input = makeFrame(b * BLOCK, BLOCK);
+        assert(filter.process(input, output));
+        collect(output, left, right);
+        av_frame_unref(output);
+        av_frame_free(&input);
+    }
+
+    // adelay emits its silence as a frame of its own, so one-in-one-out falls a block behind
+    const size_t total = static_cast<size_t>(blocks * BLOCK + delay);
+    assert(left.size() < total);
+
+    // The audio still queued in the graph comes out after end of stream, then the graph stays empty
+    int drained = 0;
+    while (filter.drain(output))
+    {
+        drained += output->nb_samples;
+        collect(output, left, right);
+        av_frame_unref(output);
+    }
+    assert(drained > 0);
+    assert(!filter.drain(output));
+
+    // Nothing is lost or reordered: the input follows the delay's silence
+    assert(left.size() == total);
+    for (size_t i = 0; i < left.size(); i++)
+    {
+        const float expected = i < static_cast<size_t>(delay) ? 0.0f : rampValue(static_cast<int64_t>(i) - delay);
+        assert(left[i] == expected);
+        assert(right[i] == -expected);
+    }
+
+    // A closed graph takes no more input until reset() reopens it with fresh state
+    AVFrame *input = makeFrame(0, BLOCK);
+    assert(!filter.process(input, output));
+    assert(filter.reset());
+    assert(filter.process(input, output));
+    assert(output->nb_samples == delay);
+    av_frame_unref(output);
+
+    // adelay doesn't free a frame it still holds when the graph is freed
+    while (filter.drain(output))
+    {
+        av_frame_unref(output);
+    }
+
+    av_frame_free(&input);
+    av_frame_free(&output);
+    std::cout << "Drain tests passed." << std::endl;
+}
+
+// Test that feed() accepts any framing and read() re-blocks it without loss
+void test_streaming_reblock()
+{
+    std::cout << "Testing streaming re-blocking..." << std::endl;
+
+    AudioEngine::FfmpegFilter filter;
+    float left[BLOCK], right[BLOCK];
+    uint8_t *planes[] = {reinterpret_cast<uint8_t *>(left), reinterpret_cast<uint8_t *>(right)};
+    assert(filter.read(planes, BLOCK) == 0);
+    assert(!filter.feed(nullptr));
+    assert(filter.initGraph("anull", SAMPLE_RATE, AV_SAMPLE_FMT_FLTP, stereoLayout(), BLOCK));
+
+    // Several odd-sized inputs per output block
+    const int sizes[] = {100, 37, 500, 1, 1000};
+    int64_t fed = 0;
+    for (int size : sizes)
+    {
+        AVFrame *input = makeFrame(fed, size);
+        assert(filter.feed(input));
+        av_frame_free(&input);
+        fed += size;
+        assert(filter.getBufferedFrames() == fed);
+        assert(filter.getLatency() == fed);
+    }
+
+    // Whole blocks while the FIFO holds them, then the remainder
+    int64_t position = 0;
+    while (position < fed)
+    {
+        const int read = filter.read(planes, BLOCK);
+        assert(read == std::min<int64_t>(BLOCK, fed - position));
+        for (int i = 0; i < read; i++)
+        {
+            assert(left[i] == rampValue(position + i));
+            assert(right[i] == -rampValue(position + i));
+        }
+        position += read;
+        assert(filter.getLatency() == fed - position);
+    }
+    assert(filter.read(planes, BLOCK) == 0);
+    assert(filter.getBufferedFrames() == 0);
+
+    // End of stream on an empty graph is harmless, and repeatable
+    assert(filter.feed(nullptr));
+    assert(filter.feed(nullptr));
+    assert(filter.getBufferedFrames() == 0);
+
+    std::cout << "Streaming re-blocking tests passed." << std::endl;
+}
+
+// Test a filter whose output framing and length differ from its input
+void test_streaming_tempo()
+{
+    std::cout << "Testing streaming tempo change..." << std::endl;
+
+    AudioEngine::FfmpegFilter filter;
+    assert(filter.initGraph("atempo=2.0", SAMPLE_RATE, AV_SAMPLE_FMT_FLTP, stereoLayout(), BLOCK));
+
+    float left[BLOCK], right[BLOCK];
+    uint8_t *planes[] = {reinterpret_cast<uint8_t *>(left), reinterpret_cast<uint8_t *>(right)};
+    const int64_t total = SAMPLE_RATE;
+    int64_t produced = 0;
+    int emptyReads = 0;
+
+    // process() would lose the blocks atempo holds back; the FIFO keeps them
+    for (int64_t fed = 0; fed < total; fed += BLOCK)
+    {
+        AVFrame *input = makeFrame(fed, BLOCK);
+        assert(filter.feed(input));
+        av_frame_free(&input);
+
+        const int read = filter.read(planes, BLOCK);
+        emptyReads += read == 0;
+        produced += read;
+    }
+    assert(emptyReads > 0);
+
+    // Closing the input flushes the tail; everything is read in whole blocks but the last
+    assert(filter.feed(nullptr));
+    int read;
+    while ((read = filter.read(planes, BLOCK)) > 0)
+    {
+        assert(read == BLOCK || filter.getBufferedFrames() == 0);
+        produced += read;
+    }
+
+    // Half the length, give or take atempo's window at the edges
+    assert(std::abs(produced - total / 2) <= BLOCK);
+
+    std::cout << "Streaming tempo tests passed (" << produced << " of " << total << " frames)." << std::endl;
+}
+
+// Main test function
+int main()
+{
+    std::cout << "Running FfmpegFilter tests..." << std::endl;
+
+    test_drain();
+    test_streaming_reblock();
+    test_streaming_tempo();
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioNode.h"
+#include "ExecutionPlan.h"
+#include "GraphScheduler.h"
+
+// Tests for running an execution plan on the work-stealing scheduler
+
+namespace
+{
+    const int FX_COUNT = 16;
+
+    // Node that does nothing; the scheduler only looks at the plan's tables
+    class DummyNode : public AudioEngine::AudioNode
+    {
+    public:
+        explicit DummyNode(const std::string &name) : AudioNode(name, nullptr) {}
+
+        NodeType getType() const override { return NodeType::CUSTOM; }
+        bool configure(const std::string &, double, long, AVSampleFormat, AVChannelLayout) override { return true; }
+        bool start() override { return true; }
+        void stop() override {}
+        bool process() override { return true; }
+        bool isRunning() const override { return false; }
+        bool setInputBuffer(std::shared_ptr<AudioEngine::AudioBuffer>, int) override { return true; }
+        std::shared_ptr<AudioEngine::AudioBuffer> getOutputBuffer(int) override { return nullptr; }
+        int getInputPadCount() const override { return FX_COUNT; }
+        int getOutputPadCount() const override { return 1; }
+        void reset() override {}
+    };
+
+    // source -> FX_COUNT parallel effects -> mixer -> sink
+    struct Graph
+    {
+        std::vector<std::shared_ptr<AudioEngine::AudioNode>> nodes;
+        std::vector<AudioEngine::Connection> connections;
+        AudioEngine::ExecutionPlan plan;
+
+        Graph()
+        {
+            auto source = std::make_shared<DummyNode>("source");
+            auto mixer = std::make_shared<DummyNode>("mixer");
+            auto sink = std::make_shared<DummyNode>("sink");
+            nodes = {source, mixer, sink};
+            connections.emplace_back(mixer.get(), 0, sink.get(), 0);
+            for (int i = 0; i < FX_COUNT; i++)
+            {
+                auto fx = std::make_shared<DummyNode>("fx_" + std::to_string(i));
+                nodes.push_back(fx);
+                connections.emplace_back(source.get(), 0, fx.get(), 0);
+                connections.emplace_back(fx.get(), 0, mixer.get(), i);
+            }
+
+            std::string error;
+            bool built = AudioEngine::ExecutionPlan::build(nodes, connections, plan, error);
+            assert(built);
+            (void)built;
+        }
+    };
+
+    // Start and end ticks of every step in one block
+    struct Trace
+    {
+        std::atomic<uint64_t> clock{0};
+        std::vector<uint64_t> started;
+        std::vector<uint64_t> finished;
+        std::mutex threadMutex;
+        std::set<std::thread::id> threads;
+
+        explicit Trace(size_t steps) : started(steps), finished(steps) {}
+
+        void reset()
+        {
+            clock.store(0);
+            std::fill(started.begin(), started.end(), 0);
+            std::fill(finished.begin(), finished.end(), 0);
+        }
+    };
+
+    // Every step has to start after all of its upstream steps finished
+    void checkDependencies(const AudioEngine::ExecutionPlan &plan, const Trace &trace)
+    {
+        const auto &steps = plan.getSteps();
+        const auto &successors = plan.getSuccessors();
+        for (size_t i = 0; i < steps.size(); i++)
+        {
+            assert(trace.finished[i] > trace.started[i]);
+            for (uint32_t s = steps[i].successorBegin; s < steps[i].successorEnd; s++)
+            {
+                assert(trace.started[successors[s]] > trace.finished[i]);
+            }
+        }
+    }
+
+    AudioEngine::GraphScheduler::StepFunction tracer(const AudioEngine::ExecutionPlan &plan, Trace &trace, long failContext)
+    {
+        return [&plan, &trace, failContext](const AudioEngine::ExecutionPlan::Step &step, long context)
+        {
+            const size_t index = static_cast<size_t>(&step - plan.getSteps().data());
+            trace.started[index] = ++trace.clock;
+            {
+                std::lock_guard<std::mutex> lock(trace.threadMutex);
+                trace.threads.insert(std::this_thread::get_id());
+            }
+
+            // Long enough for idle threads to wake up and steal
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+            trace.finished[index] = ++trace.clock;
+            return !(context == failContext && step.node->getName() == "fx_3");
+        };
+    }
+}
+
+// Test that the serial fallback runs the steps in plan order
+void test_serial()
+{
+    std::cout << "Testing serial execution..." << std::endl;
+
+    Graph graph;
+    Trace trace(graph.plan.getSteps().size());
+    AudioEngine::GraphScheduler scheduler;
+    assert(scheduler.start(graph.plan, 1, 0, tracer(graph.plan, trace, -1)));
+    assert(!scheduler.isParallel());
+    assert(scheduler.getThreadCount() == 1);
+
+    assert(scheduler.runBlock(0) == 0);
+    checkDependencies(graph.plan, trace);
+    for (size_t i = 0; i < graph.plan.getSteps().size(); i++)
+    {
+        assert(trace.started[i] == 2 * i + 1);
+    }
+
+    // Small graphs stay serial whatever the thread count
+    assert(scheduler.start(graph.plan, 4, 100, tracer(graph.plan, trace, -1)));
+    assert(!scheduler.isParallel());
+
+    scheduler.stop();
+    std::cout << "Serial execution tests passed." << std::endl;
+}
+
+// Test that parallel blocks keep every dependency and spread over the pool
+void test_parallel()
+{
+    std::cout << "Testing parallel execution..." << std::endl;
+
+    Graph graph;
+    Trace trace(graph.plan.getSteps().size());
+    AudioEngine::GraphScheduler scheduler;
+    assert(scheduler.start(graph.plan, 4, 2, tracer(graph.plan, trace, 7)));
+    assert(scheduler.isParallel());
+    assert(scheduler.getThreadCount() == 4);
+
+    for (long block = 0; block < 50; block++)
+    {
+        trace.reset();
+        const size_t failures = scheduler.runBlock(block);
+
+        // A failed step is reported but still releases the steps after it
+        assert(failures == (block == 7 ? 1u : 0u));
+        checkDependencies(graph.plan, trace);
+
+        for (size_t i = 0; i < graph.plan.getSteps().size(); i++)
+        {
+            const bool failed = block == 7 && graph.plan.getSteps()[i].node->getName() == "fx_3";
+            assert(scheduler.stepFailed(i) == failed);
+        }
+    }
+
+    // The effects are queued by the thread that ran the source; the others steal them
+    if (std::thread::hardware_concurrency() > 1)
+    {
+        assert(trace.threads.size() > 1);
+    }
+
+    scheduler.stop();
+    assert(!scheduler.isParallel());
+    std::cout << "Parallel execution tests passed (" << trace.threads.size() << " threads)." << std::endl;
+}
+
+// Main test function
+int main()
+{
+    std::cout << "Running GraphScheduler tests..." << std::endl;
+
+    test_serial();
+    test_parallel();
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
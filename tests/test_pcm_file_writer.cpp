@@ -0,0 +1,353 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioBuffer.h"
+#include "MappedPcmFile.h"
+#include "PcmFileWriter.h"
+
+// Tests for the streaming WAV/RF64 writer
+
+using AudioEngine::MappedPcmFile;
+using AudioEngine::PcmFileWriter;
+
+namespace
+{
+    const int SAMPLE_RATE = 48000;
+    const int BLOCK = 1000; // Not a divisor of the write buffer, so blocks straddle buffers
+
+    std::string tempPath(const std::string &name)
+    {
+        return "/tmp/oscmex_test_" + name + ".wav";
+    }
+
+    // Channel c, frame n of the test signal
+    float sampleValue(int c, int64_t n)
+    {
+        return 0.5f * std::sin(0.001f * static_cast<float>(n) * static_cast<float>(c + 1));
+    }
+
+    std::shared_ptr<AudioEngine::AudioBuffer> makeBlock(int channels, int64_t start)
+    {
+        AVChannelLayout layout;
+        av_channel_layout_default(&layout, channels);
+        auto buffer = AudioEngine::AudioBuffer::createBuffer(BLOCK, SAMPLE_RATE, AV_SAMPLE_FMT_FLTP, layout);
+        for (int c = 0; c < channels; c++)
+        {
+            float *plane = reinterpret_cast<float *>(buffer->getPlaneData(c));
+            for (int i = 0; i < BLOCK; i++)
+            {
+                plane[i] = sampleValue(c, start + i);
+            }
+        }
+        return buffer;
+    }
+
+    std::vector<uint8_t> readFile(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    uint32_t get32(const std::vector<uint8_t> &data, size_t offset)
+    {
+        uint32_t value;
+        std::memcpy(&value, data.data() + offset, sizeof(value));
+        return value;
+    }
+
+    uint64_t get64(const std::vector<uint8_t> &data, size_t offset)
+    {
+        uint64_t value;
+        std::memcpy(&value, data.data() + offset, sizeof(value));
+        return value;
+    }
+
+    // Every frame read back through the mapped reader matches the signal
+    void checkAudio(const std::string &path, int channels, int64_t frames, float tolerance, int firstChannel = 0)
+    {
+        MappedPcmFile file;
+        std::string error;
+        assert(file.open(path, error));
+        assert(file.getChannels() == channels);
+        assert(file.getSampleRate() == SAMPLE_RATE);
+        assert(file.getFrameCount() == frames);
+
+        std::vector<std::vector<float>> planes(channels, std::vector<float>(static_cast<size_t>(frames)));
+        std::vector<float *> pointers;
+        for (auto &plane : planes)
+        {
+            pointers.push_back(plane.data());
+        }
+        file.readPlanar(0, static_cast<long>(frames), pointers.data());
+        for (int c = 0; c < channels; c++)
+        {
+            for (int64_t n = 0; n < frames; n++)
+            {
+                assert(std::fabs(planes[c][n] - sampleValue(firstChannel + c, n)) <= tolerance);
+            }
+        }
+    }
+}
+
+// Test the header and data of a plain WAV file
+void test_wav()
+{
+    std::cout << "Testing WAV output..." << std::endl;
+
+    const std::string path = tempPath("wav");
+    const int blocks = 25;
+    PcmFileWriter::Options options;
+    options.bufferBytes = 16384;
+
+    PcmFileWriter writer;
+    std::string error;
+    assert(writer.open(path, SAMPLE_RATE, 2, 0x3, PcmFileWriter::Encoding::PCM16, options, error));
+    assert(writer.getFrameSize() == 4);
+    for (int b = 0; b < blocks; b++)
+    {
+        assert(writer.write(*makeBlock(2, b * BLOCK)));
+    }
+    assert(writer.close(error));
+    assert(!writer.isOpen());
+
+    // RIFF sizes are exact and the preallocated space is gone
+    const int64_t frames = static_cast<int64_t>(blocks) * BLOCK;
+    const std::vector<uint8_t> data = readFile(path);
+    const size_t header = data.size() - static_cast<size_t>(frames * 4);
+    assert(std::memcmp(data.data(), "RIFF", 4) == 0);
+    assert(std::memcmp(data.data() + 8, "WAVE", 4) == 0);
+    assert(get32(data, 4) == data.size() - 8);
+    assert(std::memcmp(data.data() + header - 8, "data", 4) == 0);
+    assert(get32(data, header - 4) == frames * 4);
+
+    MappedPcmFile file;
+    assert(file.open(path, error));
+    assert(file.getContainer() == MappedPcmFile::Container::WAV);
+    assert(file.getBitsPerSample() == 16);
+    assert(!file.isFloat());
+    assert(file.getChannelMask() == 0x3);
+    file.close();
+
+    checkAudio(path, 2, frames, 1.0f / 16384.0f);
+
+    std::remove(path.c_str());
+    std::cout << "WAV output tests passed." << std::endl;
+}
+
+// Test that RF64 carries the sizes in its ds64 chunk
+void test_rf64()
+{
+    std::cout << "Testing RF64 output..." << std::endl;
+
+    const std::string path = tempPath("rf64");
+    const int blocks = 7;
+    PcmFileWriter::Options options;
+    options.rf64 = true;
+
+    PcmFileWriter writer;
+    std::string error;
+    assert(writer.open(path, SAMPLE_RATE, 3, 0, PcmFileWriter::Encoding::FLOAT32, options, error));
+    for (int b = 0; b < blocks; b++)
+    {
+        assert(writer.write(*makeBlock(3, b * BLOCK)));
+    }
+    assert(writer.getFramesWritten() == blocks * BLOCK);
+    assert(writer.close(error));
+
+    const int64_t frames = static_cast<int64_t>(blocks) * BLOCK;
+    const std::vector<uint8_t> data = readFile(path);
+    const size_t header = data.size() - static_cast<size_t>(frames * 12);
+    assert(std::memcmp(data.data(), "RF64", 4) == 0);
+    assert(get32(data, 4) == 0xFFFFFFFF);
+    assert(std::memcmp(data.data() + 12, "ds64", 4) == 0);
+    assert(get64(data, 20) == data.size() - 8);
+    assert(get64(data, 28) == static_cast<uint64_t>(frames * 12));
+    assert(get64(data, 36) == static_cast<uint64_t>(frames));
+    assert(get32(data, header - 4) == 0xFFFFFFFF);
+
+    MappedPcmFile file;
+    assert(file.open(path, error));
+    assert(file.getContainer() == MappedPcmFile::Container::RF64);
+    assert(file.isFloat());
+    file.close();
+
+    // Float samples are stored exactly
+    checkAudio(path, 3, frames, 0.0f);
+
+    std::remove(path.c_str());
+    std::cout << "RF64 output tests passed." << std::endl;
+}
+
+// Test the aligned direct I/O layout, truncated to the audio on close
+void test_direct_io()
+{
+    std::cout << "Testing direct I/O..." << std::endl;
+
+    const std::string path = tempPath("direct");
+    const int blocks = 9;
+    PcmFileWriter::Options options;
+    options.directIo = true;
+    options.bufferBytes = 8192;
+
+    PcmFileWriter writer;
+    std::string error;
+    assert(writer.open(path, SAMPLE_RATE, 2, 0x3, PcmFileWriter::Encoding::PCM24, options, error));
+    for (int b = 0; b < blocks; b++)
+    {
+        assert(writer.write(*makeBlock(2, b * BLOCK)));
+    }
+    const bool direct = writer.isDirectIo();
+    assert(writer.close(error));
+
+    // Some filesystems refuse O_DIRECT; the layout is only aligned when it was used
+    const int64_t frames = static_cast<int64_t>(blocks) * BLOCK;
+    const std::vector<uint8_t> data = readFile(path);
+    const size_t header = data.size() - static_cast<size_t>(frames * 6);
+    if (direct)
+    {
+        assert(header == AudioEngine::PcmWriteService::IO_ALIGNMENT);
+    }
+    assert(get32(data, 4) == data.size() - 8);
+
+    checkAudio(path, 2, frames, 1.0f / 4194304.0f);
+
+    std::remove(path.c_str());
+    std::cout << "Direct I/O tests passed (" << (direct ? "O_DIRECT" : "buffered fallback") << ")." << std::endl;
+}
+
+// Test that the header describes the audio on disk while the file is still open
+void test_header_patch()
+{
+    std::cout << "Testing header patches..." << std::endl;
+
+    const std::string path = tempPath("patch");
+    PcmFileWriter::Options options;
+    options.bufferBytes = 4096;
+    options.headerIntervalSeconds = 1e-6;
+
+    PcmFileWriter writer;
+    std::string error;
+    assert(writer.open(path, SAMPLE_RATE, 2, 0x3, PcmFileWriter::Encoding::PCM16, options, error));
+    for (int b = 0; b < 20; b++)
+    {
+        assert(writer.write(*makeBlock(2, b * BLOCK)));
+    }
+
+    // Wait for the I/O thread to write and patch a few buffers
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (writer.getFileSize() < 8 * 4096 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // As if the recorder had crashed here: the file plays up to the last patch
+    MappedPcmFile file;
+    assert(file.open(path, error));
+    const int64_t frames = file.getFrameCount();
+    assert(frames > 0);
+    assert(frames <= writer.getFramesWritten());
+    file.close();
+    checkAudio(path, 2, frames, 1.0f / 16384.0f);
+
+    assert(writer.close(error));
+    checkAudio(path, 2, 20 * BLOCK, 1.0f / 16384.0f);
+
+    std::remove(path.c_str());
+    std::cout << "Header patch tests passed (" << frames << " frames before close)." << std::endl;
+}
+
+// Test mono writers taking single tracks from one stream on a shared service
+void test_shared_service()
+{
+    std::cout << "Testing shared write service..." << std::endl;
+
+    const int channels = 4;
+    const int blocks = 12;
+    std::vector<std::string> closed;
+    {
+        AudioEngine::PcmWriteService service(4096, 2 * channels);
+        std::vector<std::unique_ptr<PcmFileWriter>> writers;
+        std::string error;
+        for (int c = 0; c < channels; c++)
+        {
+            writers.push_back(std::make_unique<PcmFileWriter>());
+            assert(writers.back()->open(tempPath("track" + std::to_string(c)), SAMPLE_RATE, 1, 0,
+                                        PcmFileWriter::Encoding::FLOAT32, PcmFileWriter::Options(), error, &service));
+        }
+
+        for (int b = 0; b < blocks; b++)
+        {
+            auto block = makeBlock(channels, b * BLOCK);
+            for (int c = 0; c < channels; c++)
+            {
+                assert(writers[c]->write(*block, c));
+            }
+        }
+
+        // Too few channels in the buffer for the requested track
+        assert(!writers[0]->write(*makeBlock(2, 0), 2));
+
+        // Retired writers close on the I/O thread; the service finishes them before it goes
+        for (auto &writer : writers)
+        {
+            service.retire(std::move(writer), [&closed](const std::string &path, bool success, const std::string &)
+                           {
+                assert(success);
+                closed.push_back(path); });
+        }
+    }
+
+    assert(closed.size() == static_cast<size_t>(channels));
+    for (int c = 0; c < channels; c++)
+    {
+        const std::string path = tempPath("track" + std::to_string(c));
+        assert(closed[c] == path);
+        checkAudio(path, 1, static_cast<int64_t>(blocks) * BLOCK, 0.0f, c);
+        std::remove(path.c_str());
+    }
+
+    std::cout << "Shared write service tests passed." << std::endl;
+}
+
+// Test the codec names accepted from the sink configuration
+void test_parse_codec()
+{
+    std::cout << "Testing codec names..." << std::endl;
+
+    PcmFileWriter::Encoding encoding = PcmFileWriter::Encoding::PCM16;
+    assert(PcmFileWriter::parseCodec("pcm_s24le", encoding));
+    assert(encoding == PcmFileWriter::Encoding::PCM24);
+    assert(PcmFileWriter::parseCodec("pcm_f64le", encoding));
+    assert(encoding == PcmFileWriter::Encoding::FLOAT64);
+    assert(!PcmFileWriter::parseCodec("flac", encoding));
+    assert(encoding == PcmFileWriter::Encoding::FLOAT64);
+
+    std::cout << "Codec name tests passed." << std::endl;
+}
+
+// Main test function
+int main()
+{
+    std::cout << "Running PcmFileWriter tests..." << std::endl;
+
+    test_wav();
+    test_rf64();
+    test_direct_io();
+    test_header_patch();
+    test_shared_service();
+    test_parse_codec();
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,230 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "SampleConverter.h"
+
+// Tests for the ASIO sample conversion kernels
+
+using AudioEngine::SampleConverter;
+
+namespace
+{
+    const long ASIO_TYPES[] = {16, 17, 18, 19, 20}; // Int16, Int24, Int32, Float32, Float64 (LSB)
+    const AVSampleFormat ENGINE_FORMATS[] = {AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_DBLP, AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_S16P};
+    const SampleConverter::SimdLevel LEVELS[] = {SampleConverter::SimdLevel::SSE2, SampleConverter::SimdLevel::AVX2};
+
+    // Odd length so the vector kernels run their scalar tails too
+    const long FRAMES = 509;
+
+    // A sine slightly above full scale in the engine format, so clipping paths run
+    std::vector<uint8_t> makeEngineSignal(AVSampleFormat format, ptrdiff_t stride)
+    {
+        const int size = av_get_bytes_per_sample(format);
+        std::vector<uint8_t> data(static_cast<size_t>(FRAMES * stride * size), 0);
+        for (long i = 0; i < FRAMES; i++)
+        {
+            const double x = 1.05 * std::sin(0.01 * i);
+            uint8_t *p = data.data() + i * stride * size;
+            switch (format)
+            {
+            case AV_SAMPLE_FMT_FLTP:
+            {
+                float v = static_cast<float>(x);
+                std::memcpy(p, &v, sizeof(v));
+                break;
+            }
+            case AV_SAMPLE_FMT_DBLP:
+                std::memcpy(p, &x, sizeof(x));
+                break;
+            case AV_SAMPLE_FMT_S32P:
+            {
+                int32_t v = static_cast<int32_t>(std::fmax(-1.0, std::fmin(x, 0.999)) * 2147483647.0);
+                std::memcpy(p, &v, sizeof(v));
+                break;
+            }
+            default:
+            {
+                int16_t v = static_cast<int16_t>(std::fmax(-1.0, std::fmin(x, 0.999)) * 32767.0);
+                std::memcpy(p, &v, sizeof(v));
+                break;
+            }
+            }
+        }
+        return data;
+    }
+
+    // Arbitrary ASIO bytes with in-range floats, so every code path sees real values
+    std::vector<uint8_t> makeAsioSignal(long asioType)
+    {
+        const int size = SampleConverter::getAsioSampleSize(asioType);
+        std::vector<uint8_t> data(static_cast<size_t>(FRAMES * size));
+        for (long i = 0; i < FRAMES; i++)
+        {
+            const double x = 0.99 * std::sin(0.013 * i + 0.3);
+            uint8_t *p = data.data() + i * size;
+            if (asioType == 19)
+            {
+                float v = static_cast<float>(x);
+                std::memcpy(p, &v, sizeof(v));
+            }
+            else if (asioType == 20)
+            {
+                std::memcpy(p, &x, sizeof(x));
+            }
+            else
+            {
+                const int64_t v = static_cast<int64_t>(x * 2147483647.0);
+                std::memcpy(p, reinterpret_cast<const uint8_t *>(&v) + (4 - size), size);
+            }
+        }
+        return data;
+    }
+}
+
+// Test that every vector kernel produces the scalar kernel's exact bytes
+void test_simd_matches_scalar()
+{
+    std::cout << "Testing SIMD kernels against scalar..." << std::endl;
+
+    const SampleConverter::SimdLevel best = SampleConverter::detectSimdLevel();
+    int compared = 0;
+
+    for (long asioType : ASIO_TYPES)
+    {
+        const int asioSize = SampleConverter::getAsioSampleSize(asioType);
+        for (AVSampleFormat format : ENGINE_FORMATS)
+        {
+            // Planar (stride 1) and interleaved stereo (stride 2)
+            for (ptrdiff_t stride = 1; stride <= 2; stride++)
+            {
+                const std::vector<uint8_t> engine = makeEngineSignal(format, stride);
+                const std::vector<uint8_t> asio = makeAsioSignal(asioType);
+
+                SampleConverter scalar;
+                assert(scalar.selectOutput(asioType, format, SampleConverter::Options(), SampleConverter::SimdLevel::SCALAR));
+                assert(scalar.selectInput(asioType, format, SampleConverter::SimdLevel::SCALAR));
+
+                std::vector<uint8_t> asioReference(static_cast<size_t>(FRAMES * asioSize));
+                std::vector<uint8_t> engineReference(engine.size(), 0);
+                uint32_t seed = 1;
+                scalar.toAsio(engine.data(), stride, asioReference.data(), FRAMES, seed);
+                scalar.toEngine(asio.data(), engineReference.data(), FRAMES, stride);
+
+                for (SampleConverter::SimdLevel level : LEVELS)
+                {
+                    if (level > best)
+                    {
+                        continue;
+                    }
+
+                    SampleConverter converter;
+                    assert(converter.selectOutput(asioType, format, SampleConverter::Options(), level));
+                    std::vector<uint8_t> asioOut(asioReference.size(), 0xAA);
+                    seed = 1;
+                    converter.toAsio(engine.data(), stride, asioOut.data(), FRAMES, seed);
+                    assert(asioOut == asioReference);
+
+                    assert(converter.selectInput(asioType, format, level));
+                    std::vector<uint8_t> engineOut(engine.size(), 0);
+                    converter.toEngine(asio.data(), engineOut.data(), FRAMES, stride);
+                    assert(engineOut == engineReference);
+                    compared++;
+                }
+            }
+        }
+    }
+
+    std::cout << "SIMD kernel tests passed (" << compared << " comparisons at "
+              << SampleConverter::getSimdLevelName(best) << ")." << std::endl;
+}
+
+// Test full-scale mapping and clipping of the scalar reference
+void test_scalar_reference()
+{
+    std::cout << "Testing scalar reference conversions..." << std::endl;
+
+    SampleConverter converter;
+    const float engine[4] = {1.5f, -1.5f, 0.5f, 0.0f};
+
+    // Int16: clipped to the format's range
+    assert(converter.selectOutput(16, AV_SAMPLE_FMT_FLTP, SampleConverter::Options(), SampleConverter::SimdLevel::SCALAR));
+    int16_t i16[4];
+    uint32_t seed = 1;
+    converter.toAsio(reinterpret_cast<const uint8_t *>(engine), 1, i16, 4, seed);
+    assert(i16[0] == 32767 && i16[1] == -32768 && i16[2] == 16384 && i16[3] == 0);
+
+    // Float32: clipped only when asked to
+    float f32[4];
+    assert(converter.selectOutput(19, AV_SAMPLE_FMT_FLTP, SampleConverter::Options(), SampleConverter::SimdLevel::SCALAR));
+    converter.toAsio(reinterpret_cast<const uint8_t *>(engine), 1, f32, 4, seed);
+    assert(f32[0] == 1.0f && f32[1] == -1.0f && f32[2] == 0.5f);
+
+    SampleConverter::Options noClip;
+    noClip.clip = false;
+    assert(converter.selectOutput(19, AV_SAMPLE_FMT_FLTP, noClip, SampleConverter::SimdLevel::SCALAR));
+    converter.toAsio(reinterpret_cast<const uint8_t *>(engine), 1, f32, 4, seed);
+    assert(f32[0] == 1.5f && f32[1] == -1.5f);
+
+    // Int24 back to float is exact for representable values
+    const uint8_t i24[6] = {0x00, 0x00, 0x40, 0x00, 0x00, 0x80}; // 0.5, -1.0
+    float back[2];
+    assert(converter.selectInput(17, AV_SAMPLE_FMT_FLTP, SampleConverter::SimdLevel::SCALAR));
+    converter.toEngine(i24, reinterpret_cast<uint8_t *>(back), 2, 1);
+    assert(back[0] == 0.5f && back[1] == -1.0f);
+
+    // Unknown ASIO types are rejected
+    assert(!converter.selectInput(99, AV_SAMPLE_FMT_FLTP));
+    assert(!converter.isInputValid());
+
+    std::cout << "Scalar reference tests passed." << std::endl;
+}
+
+// Test that TPDF dither stays within one LSB of the undithered value
+void test_dither()
+{
+    std::cout << "Testing dither..." << std::endl;
+
+    const std::vector<uint8_t> engine = makeEngineSignal(AV_SAMPLE_FMT_FLTP, 1);
+
+    SampleConverter plain;
+    assert(plain.selectOutput(16, AV_SAMPLE_FMT_FLTP, SampleConverter::Options(), SampleConverter::SimdLevel::SCALAR));
+    std::vector<int16_t> reference(FRAMES);
+    uint32_t seed = 1;
+    plain.toAsio(engine.data(), 1, reference.data(), FRAMES, seed);
+
+    SampleConverter::Options options;
+    options.dither = true;
+    SampleConverter dithered;
+    assert(dithered.selectOutput(16, AV_SAMPLE_FMT_FLTP, options));
+    std::vector<int16_t> output(FRAMES);
+    seed = 12345;
+    dithered.toAsio(engine.data(), 1, output.data(), FRAMES, seed);
+
+    int changed = 0;
+    for (long i = 0; i < FRAMES; i++)
+    {
+        assert(std::abs(output[i] - reference[i]) <= 1);
+        changed += output[i] != reference[i];
+    }
+    assert(changed > 0);
+    assert(seed != 12345); // The state carries over to the next block
+
+    std::cout << "Dither tests passed." << std::endl;
+}
+
+// Main test function
+int main()
+{
+    std::cout << "Running SampleConverter tests..." << std::endl;
+
+    test_simd_matches_scalar();
+    test_scalar_reference();
+    test_dither();
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <thread>
+#include "SpscRing.h"
+
+// Tests for the lock-free single-producer/single-consumer ring
+
+// Test capacity rounding, full and empty behavior and wrap-around
+void test_single_thread()
+{
+    std::cout << "Testing single-threaded ring..." << std::endl;
+
+    AudioEngine::SpscRing<int> ring(5);
+    assert(ring.capacity() == 8);
+    assert(ring.empty());
+
+    int value = 0;
+    assert(!ring.tryPop(value));
+
+    for (int i = 0; i < 8; i++)
+    {
+        assert(ring.tryPush(i));
+    }
+    assert(!ring.tryPush(8));
+    assert(ring.size() == 8);
+
+    // Indices keep counting past the capacity; order survives the wrap
+    for (int round = 0; round < 100; round++)
+    {
+        assert(ring.tryPop(value));
+        assert(value == round);
+        assert(ring.tryPush(round + 8));
+        assert(!ring.tryPush(-1));
+    }
+
+    ring.clear();
+    assert(ring.empty());
+    assert(!ring.tryPop(value));
+    assert(ring.tryPush(42));
+    assert(ring.tryPop(value) && value == 42);
+
+    std::cout << "Single-threaded ring tests passed." << std::endl;
+}
+
+// Test that every element crosses threads exactly once and in order
+void test_two_threads()
+{
+    std::cout << "Testing two-threaded ring..." << std::endl;
+
+    const uint64_t count = 1000000;
+    AudioEngine::SpscRing<uint64_t> ring(64);
+
+    std::thread producer([&]
+                         {
+        for (uint64_t i = 0; i < count; i++)
+        {
+            while (!ring.tryPush(i))
+            {
+                std::this_thread::yield();
+            }
+        } });
+
+    uint64_t expected = 0;
+    uint64_t value = 0;
+    while (expected < count)
+    {
+        if (ring.tryPop(value))
+        {
+            assert(value == expected);
+            expected++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    assert(ring.empty());
+
+    std::cout << "Two-threaded ring tests passed." << std::endl;
+}
+
+// Main test function
+int main()
+{
+    std::cout << "Running SpscRing tests..." << std::endl;
+
+    test_single_thread();
+    test_two_threads();
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
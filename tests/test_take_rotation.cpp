@@ -0,0 +1,209 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AudioBuffer.h"
+#include "MappedPcmFile.h"
+#include "PcmFileWriter.h"
+
+// Tests for split recording with gapless take rotation on a shared write service
+
+using AudioEngine::MappedPcmFile;
+using AudioEngine::PcmFileWriter;
+using AudioEngine::PcmWriteService;
+
+namespace
+{
+    const int SAMPLE_RATE = 48000;
+    const int CHANNELS = 3;
+    const long BLOCK_SIZES[] = {480, 512, 333};
+
+    // Channel c, frame n of the test signal
+    float sampleValue(int c, int64_t n)
+    {
+        return 0.25f * std::sin(0.003f * static_cast<float>(n) + static_cast<float>(c));
+    }
+
+    std::shared_ptr<AudioEngine::AudioBuffer> makeBlock(long frames, int64_t start)
+    {
+        AVChannelLayout layout;
+        av_channel_layout_default(&layout, CHANNELS);
+        auto buffer = AudioEngine::AudioBuffer::createBuffer(frames, SAMPLE_RATE, AV_SAMPLE_FMT_FLTP, layout);
+        for (int c = 0; c < CHANNELS; c++)
+        {
+            float *plane = reinterpret_cast<float *>(buffer->getPlaneData(c));
+            for (long i = 0; i < frames; i++)
+            {
+                plane[i] = sampleValue(c, start + i);
+            }
+        }
+        return buffer;
+    }
+
+    std::string takePath(int take, int channel)
+    {
+        char name[64];
+        std::snprintf(name, sizeof(name), "/tmp/oscmex_test_take_%03d_%02d.wav", take + 1, channel + 1);
+        return name;
+    }
+
+    // The sink's split mode: one mono file per channel, rotated by size between blocks
+    struct Recorder
+    {
+        PcmWriteService &service;
+        int64_t rotateBytes;
+        int take = 0;
+        int64_t takeFrames = 0;
+        std::vector<std::unique_ptr<PcmFileWriter>> writers;
+        std::vector<int64_t> takeLengths;
+        std::vector<std::string> &closed; // Filled on the I/O thread
+
+        Recorder(PcmWriteService &s, int64_t bytes, std::vector<std::string> &c) : service(s), rotateBytes(bytes), closed(c)
+        {
+            open();
+        }
+
+        void open()
+        {
+            std::string error;
+            writers.clear();
+            for (int c = 0; c < CHANNELS; c++)
+            {
+                writers.push_back(std::make_unique<PcmFileWriter>());
+                bool opened = writers.back()->open(takePath(take, c), SAMPLE_RATE, 1, 0,
+                                                   PcmFileWriter::Encoding::FLOAT32, PcmFileWriter::Options(), error, &service);
+                assert(opened);
+                (void)opened;
+            }
+        }
+
+        // Next take opened first, previous one closed on the I/O thread
+        void rotate()
+        {
+            std::vector<std::unique_ptr<PcmFileWriter>> previous = std::move(writers);
+            takeLengths.push_back(takeFrames);
+            take++;
+            takeFrames = 0;
+            open();
+            for (auto &writer : previous)
+            {
+                service.retire(std::move(writer), [&closed = closed](const std::string &path, bool success, const std::string &)
+                               {
+                    assert(success);
+                    closed.push_back(path); });
+            }
+        }
+
+        void write(const AudioEngine::AudioBuffer &buffer)
+        {
+            const long frames = buffer.getFrameCount();
+            if ((takeFrames + frames) * static_cast<int64_t>(sizeof(float)) > rotateBytes && takeFrames > 0)
+            {
+                rotate();
+            }
+            for (int c = 0; c < CHANNELS; c++)
+            {
+                bool written = writers[c]->write(buffer, c);
+                assert(written);
+                (void)written;
+            }
+            takeFrames += frames;
+        }
+
+        void finish()
+        {
+            takeLengths.push_back(takeFrames);
+            std::string error;
+            for (auto &writer : writers)
+            {
+                bool done = writer->close(error);
+                assert(done);
+                (void)done;
+            }
+        }
+    };
+}
+
+// Test that the takes split between blocks and join back sample-exact
+void test_gapless_rotation()
+{
+    std::cout << "Testing gapless take rotation..." << std::endl;
+
+    const int64_t rotateBytes = 20000; // 5000 float frames per mono file
+    const int blocks = 60;
+    int64_t total = 0;
+    std::vector<std::string> closed;
+    std::vector<int64_t> takeLengths;
+    {
+        // A small pool, so retiring writers and the next take compete for buffers
+        PcmWriteService service(4096, CHANNELS);
+        Recorder recorder(service, rotateBytes, closed);
+        for (int b = 0; b < blocks; b++)
+        {
+            const long frames = BLOCK_SIZES[b % 3];
+            recorder.write(*makeBlock(frames, total));
+            total += frames;
+        }
+        recorder.finish();
+        takeLengths = recorder.takeLengths;
+    }
+
+    // Every take but the last is as full as whole blocks allow
+    assert(takeLengths.size() > 3);
+    for (size_t t = 0; t + 1 < takeLengths.size(); t++)
+    {
+        assert(takeLengths[t] * static_cast<int64_t>(sizeof(float)) <= rotateBytes);
+        assert((takeLengths[t] + 512) * static_cast<int64_t>(sizeof(float)) > rotateBytes);
+    }
+
+    // Retired takes closed in the order they were handed over
+    assert(closed.size() == (takeLengths.size() - 1) * CHANNELS);
+    for (size_t i = 0; i < closed.size(); i++)
+    {
+        assert(closed[i] == takePath(static_cast<int>(i / CHANNELS), static_cast<int>(i % CHANNELS)));
+    }
+
+    // Joined back together, every track is the uninterrupted signal
+    for (int c = 0; c < CHANNELS; c++)
+    {
+        int64_t position = 0;
+        for (size_t t = 0; t < takeLengths.size(); t++)
+        {
+            const std::string path = takePath(static_cast<int>(t), c);
+            MappedPcmFile file;
+            std::string error;
+            assert(file.open(path, error));
+            assert(file.getChannels() == 1);
+            assert(file.getFrameCount() == takeLengths[t]);
+
+            std::vector<float> samples(static_cast<size_t>(takeLengths[t]));
+            float *plane = samples.data();
+            file.readPlanar(0, static_cast<long>(takeLengths[t]), &plane);
+            for (int64_t n = 0; n < takeLengths[t]; n++)
+            {
+                assert(samples[n] == sampleValue(c, position + n));
+            }
+            position += takeLengths[t];
+            file.close();
+            std::remove(path.c_str());
+        }
+        assert(position == total);
+    }
+
+    std::cout << "Gapless take rotation tests passed (" << takeLengths.size() << " takes)." << std::endl;
+}
+
+// Main test function
+int main()
+{
+    std::cout << "Running take rotation tests..." << std::endl;
+
+    test_gapless_rotation();
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "SpscRing.h"
+#include "WakeEvent.h"
+
+// Tests for the lock-free wake event between pipeline stages
+
+using AudioEngine::SpscRing;
+using AudioEngine::WakeEvent;
+
+// Test a producer and a consumer that both sleep on a small ring
+void test_handoff()
+{
+    std::cout << "Testing handoff..." << std::endl;
+
+    const int count = 200000;
+    SpscRing<int> ring(4);
+    WakeEvent space, data;
+    long long sum = 0;
+
+    std::thread consumer([&]
+                         {
+        for (int i = 0; i < count; i++)
+        {
+            int value = 0;
+            data.waitUntil([&]
+                           { return ring.tryPop(value); });
+            space.notify();
+            assert(value == i);
+            sum += value;
+
+            // Stalls long enough for the producer to go to sleep
+            if (i % 5000 == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        } });
+
+    for (int i = 0; i < count; i++)
+    {
+        space.waitUntil([&]
+                        { return ring.tryPush(i); });
+        data.notify();
+    }
+    consumer.join();
+
+    assert(sum == static_cast<long long>(count) * (count - 1) / 2);
+    std::cout << "Handoff tests passed." << std::endl;
+}
+
+// Test a consumer that only notifies once the ring is half empty, as the audio thread does
+void test_watermark()
+{
+    std::cout << "Testing watermark wakeups..." << std::endl;
+
+    const int count = 20000;
+    const size_t capacity = 16;
+    SpscRing<int> ring(capacity);
+    WakeEvent space;
+    std::atomic<bool> stop{false};
+    std::atomic<int> produced{0};
+
+    std::thread producer([&]
+                         {
+        for (int i = 0; i < count; i++)
+        {
+            space.waitUntil([&]
+                            { return stop.load() || ring.tryPush(i); });
+            if (stop.load())
+            {
+                break;
+            }
+            produced++;
+        } });
+
+    int received = 0;
+    int notifies = 0;
+    while (received < count)
+    {
+        int value = 0;
+        if (!ring.tryPop(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        assert(value == received);
+        received++;
+        if (ring.size() <= capacity / 2)
+        {
+            space.notify();
+            notifies++;
+        }
+    }
+    producer.join();
+    assert(produced == count);
+
+    // A stop flag wakes a sleeping waiter through its own notify()
+    std::thread waiter([&]
+                       { space.waitUntil([&]
+                                         { return stop.load(); }); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    stop = true;
+    space.notify();
+    waiter.join();
+
+    std::cout << "Watermark tests passed (" << notifies << " notifies for " << count << " items)." << std::endl;
+}
+
+// Test that a timed wait gives up at its deadline and still sees a notify before it
+void test_deadline()
+{
+    std::cout << "Testing deadlines..." << std::endl;
+
+    WakeEvent event;
+    std::atomic<bool> ready{false};
+
+    const auto start = std::chrono::steady_clock::now();
+    assert(!event.waitUntil([&]
+                            { return ready.load(); },
+                            start + std::chrono::milliseconds(20)));
+    assert(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+
+    std::thread notifier([&]
+                         {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ready = true;
+        event.notify(); });
+    assert(event.waitUntil([&]
+                           { return ready.load(); },
+                           std::chrono::steady_clock::now() + std::chrono::seconds(10)));
+    notifier.join();
+
+    std::cout << "Deadline tests passed." << std::endl;
+}
+
+// Main test function
+int main()
+{
+    std::cout << "Running WakeEvent tests..." << std::endl;
+
+    test_handoff();
+    test_watermark();
+    test_deadline();
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}